@@ -24,10 +24,22 @@ extern "C"
 
 DEFINE_ENUM(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_RESULT_VALUES);
 
+/** @brief Maximum number of concurrent invocations of IoTHubDeviceMethod_InvokeOnDevicesAsync
+*/
+#define IOTHUB_DEVICE_METHOD_MAX_CONCURRENT_INVOCATIONS 16
+
 /** @brief Handle to hide struct and use it in consequent APIs
 */
 typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_TAG* IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE;
 
+/** @brief Called once per device by IoTHubDeviceMethod_InvokeAsync and IoTHubDeviceMethod_InvokeOnDevicesAsync.
+*
+*          Runs on a worker thread. Callbacks of the same call never run concurrently and
+*          responsePayload is only valid during the callback. The callback shall not call
+*          IoTHubDeviceMethod_Destroy.
+*/
+typedef void(*IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK)(void* context, const char* deviceId, IOTHUB_DEVICE_METHOD_RESULT result, int responseStatus, const unsigned char* responsePayload, size_t responsePayloadSize);
+
 /** @brief    Creates a IoT Hub Service Client DeviceMethod handle for use it in consequent APIs.
 *
 * @param    serviceClientHandle    Service client handle.
@@ -75,6 +87,39 @@ MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_Invoke, IOTH
 */
 MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_InvokeModule, IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, serviceClientDeviceMethodHandle, const char*, deviceId, const char*, moduleId, const char*, methodName, const char*, methodPayload, unsigned int, timeout, int*, responseStatus, unsigned char**, responsePayload, size_t*, responsePayloadSize);
 
+/** @brief    Call a method on a device without waiting for the response.
+*
+* @param    serviceClientDeviceMethodHandle    The handle created by a call to the create function.
+* @param    deviceId                        The device name (id) to call a method on.
+* @param    methodName                      The method name to call.
+* @param    methodPayload                   The message payload to send.
+* @param    timeout                         Time in seconds the service waits for the device.
+* @param    invokeCallback                  Receives the result of the call.
+* @param    context                         User context passed to invokeCallback.
+*
+* @return    IOTHUB_DEVICE_METHOD_OK when the call is started, invokeCallback is then always called.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_InvokeAsync, IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, serviceClientDeviceMethodHandle, const char*, deviceId, const char*, methodName, const char*, methodPayload, unsigned int, timeout, IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK, invokeCallback, void*, context);
+
+/** @brief    Call the same method on many devices without waiting for the responses.
+*
+*           Up to maxConcurrentInvocations calls are in flight at the same time, each on a
+*           pooled connection that is abandoned 10 seconds after the method timeout.
+*           IoTHubDeviceMethod_Destroy waits for the calls that have not completed.
+*
+* @param    serviceClientDeviceMethodHandle    The handle created by a call to the create function.
+* @param    deviceIds                       Array of deviceCount device ids.
+* @param    deviceCount                     Number of devices in the array.
+* @param    methodName                      The method name to call.
+* @param    methodPayload                   The message payload to send.
+* @param    timeout                         Time in seconds the service waits for each device.
+* @param    maxConcurrentInvocations        Maximum number of calls in flight, between 1 and 16.
+* @param    invokeCallback                  Receives the result of every device, in completion order.
+* @param    context                         User context passed to invokeCallback.
+*
+* @return    IOTHUB_DEVICE_METHOD_OK when the calls are started, invokeCallback is then called for every device.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_InvokeOnDevicesAsync, IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, serviceClientDeviceMethodHandle, const char* const*, deviceIds, size_t, deviceCount, const char*, methodName, const char*, methodPayload, unsigned int, timeout, size_t, maxConcurrentInvocations, IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK, invokeCallback, void*, context);
 
 #ifdef __cplusplus
 }
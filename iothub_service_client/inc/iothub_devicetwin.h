@@ -28,6 +28,8 @@ extern "C"
 
 DEFINE_ENUM(IOTHUB_DEVICE_TWIN_RESULT, IOTHUB_DEVICE_TWIN_RESULT_VALUES);
 
+#define IOTHUB_DEVICE_TWIN_QUERY_MAX_PAGE_SIZE 1000
+
 /** @brief Handle to hide struct and use it in consequent APIs
 */
 typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_TAG* IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE;
@@ -92,6 +94,27 @@ MOCKABLE_FUNCTION(, char*,  IoTHubDeviceTwin_GetModuleTwin, IOTHUB_SERVICE_CLIEN
 */
 MOCKABLE_FUNCTION(, char*,  IoTHubDeviceTwin_UpdateModuleTwin, IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, serviceClientDeviceTwinHandle, const char*, deviceId, const char*, moduleId, const char*, moduleTwinJson);
 
+/** @brief  Called once for every result of a twin query. @p resultJson is the JSON text of one result
+*           object and is only valid during the call. Return 0 to continue, any other value stops the query.
+*/
+typedef int(*IOTHUB_DEVICE_TWIN_QUERY_CALLBACK)(void* context, const char* resultJson);
+
+/** @brief  Runs an IoT Hub query (e.g. SELECT * FROM devices WHERE properties.reported.fwVersion = '1.2') one page at a time.
+*
+*           Continuation tokens are followed until the last page and every page is requested on the
+*           same pooled connection. Results are handed to the callback as they are found in the page,
+*           only one page of the response is held in memory.
+*
+* @param    serviceClientDeviceTwinHandle   The handle created by a call to the create function.
+* @param    query                           The IoT Hub query language statement.
+* @param    pageSize                        Number of results requested per page, between 1 and IOTHUB_DEVICE_TWIN_QUERY_MAX_PAGE_SIZE.
+* @param    resultCallback                  Callback called for every result.
+* @param    context                         User context passed to the callback.
+*
+* @return   IOTHUB_DEVICE_TWIN_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_TWIN_RESULT, IoTHubDeviceTwin_Query, IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, serviceClientDeviceTwinHandle, const char*, query, size_t, pageSize, IOTHUB_DEVICE_TWIN_QUERY_CALLBACK, resultCallback, void*, context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,181 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// This file is under development and it is subject to change
+
+#ifndef IOTHUB_JOBCLIENT_H
+#define IOTHUB_JOBCLIENT_H
+
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include <time.h>
+#include "iothub_service_client_auth.h"
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define IOTHUB_JOB_CLIENT_RESULT_VALUES         \
+    IOTHUB_JOB_CLIENT_OK,                       \
+    IOTHUB_JOB_CLIENT_INVALID_ARG,              \
+    IOTHUB_JOB_CLIENT_ERROR,                    \
+    IOTHUB_JOB_CLIENT_HTTPAPI_ERROR,            \
+    IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR,        \
+    IOTHUB_JOB_CLIENT_JSON_ERROR                \
+
+DEFINE_ENUM(IOTHUB_JOB_CLIENT_RESULT, IOTHUB_JOB_CLIENT_RESULT_VALUES);
+
+#define IOTHUB_JOB_TYPE_VALUES                  \
+    IOTHUB_JOB_TYPE_UNKNOWN,                    \
+    IOTHUB_JOB_TYPE_SCHEDULE_UPDATE_TWIN,       \
+    IOTHUB_JOB_TYPE_SCHEDULE_DEVICE_METHOD      \
+
+DEFINE_ENUM(IOTHUB_JOB_TYPE, IOTHUB_JOB_TYPE_VALUES);
+
+#define IOTHUB_JOB_STATUS_VALUES                \
+    IOTHUB_JOB_STATUS_UNKNOWN,                  \
+    IOTHUB_JOB_STATUS_ENQUEUED,                 \
+    IOTHUB_JOB_STATUS_QUEUED,                   \
+    IOTHUB_JOB_STATUS_SCHEDULED,                \
+    IOTHUB_JOB_STATUS_RUNNING,                  \
+    IOTHUB_JOB_STATUS_COMPLETED,                \
+    IOTHUB_JOB_STATUS_FAILED,                   \
+    IOTHUB_JOB_STATUS_CANCELLED                 \
+
+DEFINE_ENUM(IOTHUB_JOB_STATUS, IOTHUB_JOB_STATUS_VALUES);
+
+#define IOTHUB_JOB_CLIENT_QUERY_MAX_PAGE_SIZE 100
+
+/** @brief  Counters of the devices a job runs on.
+*/
+typedef struct IOTHUB_JOB_DEVICE_STATISTICS_TAG
+{
+    size_t deviceCount;
+    size_t failedCount;
+    size_t succeededCount;
+    size_t runningCount;
+    size_t pendingCount;
+} IOTHUB_JOB_DEVICE_STATISTICS;
+
+/** @brief  A job as returned by IoT Hub. Members are owned by the structure and released by IoTHubJobClient_FreeJobMembers.
+*/
+typedef struct IOTHUB_JOB_TAG
+{
+    const char* jobId;
+    IOTHUB_JOB_TYPE type;
+    IOTHUB_JOB_STATUS status;
+    const char* queryCondition;
+    const char* createdTime;
+    const char* startTime;
+    const char* endTime;
+    const char* failureReason;
+    const char* statusMessage;
+    IOTHUB_JOB_DEVICE_STATISTICS deviceJobStatistics;
+} IOTHUB_JOB;
+
+/** @brief  When and where a job runs.
+*/
+typedef struct IOTHUB_JOB_SCHEDULE_TAG
+{
+    const char* jobId;                          // unique id of the new job
+    const char* queryCondition;                 // devices the job runs on, e.g. "deviceId IN ['d1','d2']" or "tags.building = '43'"
+    time_t startTime;                           // 0 starts the job immediately
+    unsigned int maxExecutionTimeInSeconds;     // 0 leaves the limit to the service
+} IOTHUB_JOB_SCHEDULE;
+
+/** @brief  Called once for every job of a query. The structure and its members are only valid during the call.
+*           Return 0 to continue, any other value stops the query.
+*/
+typedef int(*IOTHUB_JOB_CLIENT_QUERY_CALLBACK)(void* context, const IOTHUB_JOB* job);
+
+/** @brief Handle to hide struct and use it in consequent APIs
+*/
+typedef struct IOTHUB_SERVICE_CLIENT_JOB_CLIENT_TAG* IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE;
+
+
+/** @brief  Creates a IoT Hub Service Client JobClient handle for use it in consequent APIs.
+*
+* @param    serviceClientHandle    Service client handle.
+*
+* @return   A non-NULL @c IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE value that is used when
+*           invoking other functions for IoT Hub jobs and @c NULL on failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IoTHubJobClient_Create, IOTHUB_SERVICE_CLIENT_AUTH_HANDLE, serviceClientHandle);
+
+/** @brief  Disposes of resources allocated by the IoT Hub IoTHubJobClient_Create.
+*
+* @param    serviceClientJobClientHandle    The handle created by a call to the create function.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubJobClient_Destroy, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, serviceClientJobClientHandle);
+
+/** @brief  Schedules a job that applies a twin patch to every device matching the query condition.
+*
+* @param    serviceClientJobClientHandle    The handle created by a call to the create function.
+* @param    schedule                        Id, query condition and start time of the job.
+* @param    twinPatchJson                   Twin JSON (tags, desired properties) applied to every device.
+* @param    job                             Output parameter, if it is not NULL will contain the created job.
+*
+* @return   IOTHUB_JOB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_JOB_CLIENT_RESULT, IoTHubJobClient_ScheduleTwinUpdate, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, serviceClientJobClientHandle, const IOTHUB_JOB_SCHEDULE*, schedule, const char*, twinPatchJson, IOTHUB_JOB*, job);
+
+/** @brief  Schedules a job that invokes a direct method on every device matching the query condition.
+*
+* @param    serviceClientJobClientHandle    The handle created by a call to the create function.
+* @param    schedule                        Id, query condition and start time of the job.
+* @param    methodName                      The name of the method.
+* @param    methodPayload                   JSON payload of the method.
+* @param    responseTimeoutInSeconds        Time each device has to respond, 0 uses the service default.
+* @param    job                             Output parameter, if it is not NULL will contain the created job.
+*
+* @return   IOTHUB_JOB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_JOB_CLIENT_RESULT, IoTHubJobClient_ScheduleDeviceMethod, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, serviceClientJobClientHandle, const IOTHUB_JOB_SCHEDULE*, schedule, const char*, methodName, const char*, methodPayload, unsigned int, responseTimeoutInSeconds, IOTHUB_JOB*, job);
+
+/** @brief  Retrieves a job.
+*
+* @param    serviceClientJobClientHandle    The handle created by a call to the create function.
+* @param    jobId                           The id of the job.
+* @param    job                             Output parameter, contains the job upon success.
+*
+* @return   IOTHUB_JOB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_JOB_CLIENT_RESULT, IoTHubJobClient_GetJob, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, serviceClientJobClientHandle, const char*, jobId, IOTHUB_JOB*, job);
+
+/** @brief  Cancels a scheduled or running job.
+*
+* @param    serviceClientJobClientHandle    The handle created by a call to the create function.
+* @param    jobId                           The id of the job.
+* @param    job                             Output parameter, if it is not NULL will contain the cancelled job.
+*
+* @return   IOTHUB_JOB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_JOB_CLIENT_RESULT, IoTHubJobClient_CancelJob, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, serviceClientJobClientHandle, const char*, jobId, IOTHUB_JOB*, job);
+
+/** @brief  Lists the jobs of the IoT Hub one page at a time, following continuation tokens until the last page.
+*
+* @param    serviceClientJobClientHandle    The handle created by a call to the create function.
+* @param    jobType                         Only jobs of this type are listed, IOTHUB_JOB_TYPE_UNKNOWN lists every type.
+* @param    jobStatus                       Only jobs in this status are listed, IOTHUB_JOB_STATUS_UNKNOWN lists every status.
+* @param    pageSize                        Number of jobs requested per page, between 1 and IOTHUB_JOB_CLIENT_QUERY_MAX_PAGE_SIZE.
+* @param    jobCallback                     Callback called for every job.
+* @param    context                         User context passed to the callback.
+*
+* @return   IOTHUB_JOB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_JOB_CLIENT_RESULT, IoTHubJobClient_QueryJobs, IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, serviceClientJobClientHandle, IOTHUB_JOB_TYPE, jobType, IOTHUB_JOB_STATUS, jobStatus, size_t, pageSize, IOTHUB_JOB_CLIENT_QUERY_CALLBACK, jobCallback, void*, context);
+
+/**
+* @brief    Free members of the IOTHUB_JOB structure (NOT the structure itself)
+*
+* @param    job      The structure to have its members freed.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubJobClient_FreeJobMembers, IOTHUB_JOB*, job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_JOBCLIENT_H
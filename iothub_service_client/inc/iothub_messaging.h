@@ -66,6 +66,14 @@ MOCKABLE_FUNCTION(, void, IoTHubMessaging_Close, IOTHUB_MESSAGING_CLIENT_HANDLE,
 * @param    userContextCallback            User specified context that will be provided to the
 *                                         callback. This can be @c NULL.
 *
+*            The message is cloned and queued for the worker thread, the call does not wait
+*            for the connection. Like IoTHubMessaging_LL_Send it fails without queuing when the
+*            client is not open or when the sends queued and in flight already reach the limit
+*            set by IoTHubMessaging_SetMaxInFlightSends. Once it has returned IOTHUB_MESSAGING_OK,
+*            failures detected when the worker hands the send to the connection, and sends still
+*            queued when IoTHubMessaging_Close is called, are only reported through
+*            @p sendCompleteCallback.
+*
 *            @b NOTE: The application behavior is undefined if the user calls
 *            the ::IoTHubMessaging_Destroy or IoTHubMessaging_Close function from within any callback.
 *
@@ -73,6 +81,17 @@ MOCKABLE_FUNCTION(, void, IoTHubMessaging_Close, IOTHUB_MESSAGING_CLIENT_HANDLE,
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_SendAsync, IOTHUB_MESSAGING_CLIENT_HANDLE, messagingClientHandle, const char*, deviceId, IOTHUB_MESSAGE_HANDLE, message, IOTHUB_SEND_COMPLETE_CALLBACK, sendCompleteCallback, void*, userContextCallback);
 
+/**
+* @brief    Asynchronous call to send the same message to every device in @p deviceIds.
+*
+*           The lock of the client is taken once for the whole batch, see
+*           IoTHubMessaging_LL_SendBatch for the meaning of the parameters and of the result.
+*
+*            @b NOTE: The application behavior is undefined if the user calls
+*            the ::IoTHubMessaging_Destroy or IoTHubMessaging_Close function from within any callback.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_SendBatchAsync, IOTHUB_MESSAGING_CLIENT_HANDLE, messagingClientHandle, const char* const*, deviceIds, size_t, deviceIdCount, IOTHUB_MESSAGE_HANDLE, message, IOTHUB_SEND_BATCH_COMPLETE_CALLBACK, sendBatchCompleteCallback, void*, userContextCallback);
+
 /**
 * @brief    This API specifies a callback to be used when the device receives the message.
 *
@@ -90,6 +109,32 @@ MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_SendAsync, IOTHUB_M
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_SetFeedbackMessageCallback, IOTHUB_MESSAGING_CLIENT_HANDLE, messagingClientHandle, IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, feedbackMessageReceivedCallback, void*, userContextCallback);
 
+/**
+* @brief    This API specifies a callback that receives the records of every feedback message one at a time.
+*
+* @param    messagingClientHandle                The handle created by a call to the create function.
+* @param    feedbackRecordReceivedCallback       Called once for every record, @c NULL goes back to delivering whole batches.
+* @param    userContextCallback                  User specified context that will be provided to the
+*                                                callback. This can be @c NULL.
+*
+*            While a record callback is set the feedback message callback is not called.
+*            The record and its strings are only valid during the call.
+*
+* @return    IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_SetFeedbackRecordCallback, IOTHUB_MESSAGING_CLIENT_HANDLE, messagingClientHandle, IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, feedbackRecordReceivedCallback, void*, userContextCallback);
+
+/**
+* @brief    Limits the number of IoTHubMessaging_SendAsync calls waiting for their send complete callback.
+*
+* @param    messagingClientHandle   The handle created by a call to the create function.
+* @param    maxInFlightSends        Once this many sends are queued or in flight IoTHubMessaging_SendAsync
+*                                   fails until one of them completes. 0 (the default) means no limit.
+*
+* @return   IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_SetMaxInFlightSends, IOTHUB_MESSAGING_CLIENT_HANDLE, messagingClientHandle, size_t, maxInFlightSends);
+
 /**
 * @brief    This function is meant to be called by the user when to
 *           set the trusted certificate on the tls connection.
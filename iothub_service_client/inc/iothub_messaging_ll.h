@@ -69,7 +69,9 @@ typedef struct IOTHUB_MESSAGING_TAG* IOTHUB_MESSAGING_HANDLE;
 
 typedef void(*IOTHUB_OPEN_COMPLETE_CALLBACK)(void* context);
 typedef void(*IOTHUB_SEND_COMPLETE_CALLBACK)(void* context, IOTHUB_MESSAGING_RESULT messagingResult);
+typedef void(*IOTHUB_SEND_BATCH_COMPLETE_CALLBACK)(void* context, const IOTHUB_MESSAGING_RESULT* messagingResults, size_t deviceIdCount);
 typedef void(*IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK)(void* context, IOTHUB_SERVICE_FEEDBACK_BATCH* feedbackBatch);
+typedef void(*IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK)(void* context, const IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord);
 
 /** @brief    Creates a IoT Hub Service Client Messaging handle for use it in consequent APIs.
 *
@@ -119,6 +121,10 @@ MOCKABLE_FUNCTION(, void, IoTHubMessaging_LL_Close, IOTHUB_MESSAGING_HANDLE, mes
 * @param    userContextCallback            User specified context that will be provided to the
 *                                         callback. This can be @c NULL.
 *
+*            Any number of sends can be in flight at the same time, each one completes
+*            with its own sendCompleteCallback and userContextCallback. Messages beyond
+*            the link credit granted by the hub are queued by the AMQP message sender.
+*
 *            @b NOTE: The application behavior is undefined if the user calls
 *            the ::IoTHubMessaging_Destroy or IoTHubMessaging_Close function from within any callback.
 *
@@ -126,6 +132,29 @@ MOCKABLE_FUNCTION(, void, IoTHubMessaging_LL_Close, IOTHUB_MESSAGING_HANDLE, mes
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_Send, IOTHUB_MESSAGING_HANDLE, messagingHandle, const char*, deviceId, IOTHUB_MESSAGE_HANDLE, message, IOTHUB_SEND_COMPLETE_CALLBACK, sendCompleteCallback, void*, userContextCallback);
 
+/**
+* @brief    Sends the same message to every device in @p deviceIds.
+*
+* @param    messagingHandle               The handle created by a call to the create function.
+* @param    deviceIds                     The names (Ids) of the devices to send the message to.
+* @param    deviceIdCount                 The number of entries in @p deviceIds.
+* @param    message                       The message to send.
+* @param    sendBatchCompleteCallback     Called once, after every send of the batch completed, with
+*                                         one result per device in the order of @p deviceIds.
+*                                         The user can specify a @c NULL value here to
+*                                         indicate that no callback is required.
+* @param    userContextCallback           User specified context that will be provided to the
+*                                         callback. This can be @c NULL.
+*
+*            The body, message id, correlation id and application properties are built once
+*            for the whole batch, only the destination address differs from device to device.
+*            Every device counts as one send in flight towards IoTHubMessaging_LL_SetMaxInFlightSends.
+*
+* @return    IOTHUB_MESSAGING_OK if at least one send was started, an error code otherwise
+*            (in which case the callback is not called).
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SendBatch, IOTHUB_MESSAGING_HANDLE, messagingHandle, const char* const*, deviceIds, size_t, deviceIdCount, IOTHUB_MESSAGE_HANDLE, message, IOTHUB_SEND_BATCH_COMPLETE_CALLBACK, sendBatchCompleteCallback, void*, userContextCallback);
+
 /**
 * @brief    This API specifies a callback to be used when the device receives the message.
 *
@@ -143,6 +172,23 @@ MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_Send, IOTHUB_MES
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetFeedbackMessageCallback, IOTHUB_MESSAGING_HANDLE, messagingHandle, IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, feedbackMessageReceivedCallback, void*, userContextCallback);
 
+/**
+* @brief    This API specifies a callback that receives the records of every feedback message one at a time.
+*
+* @param    messagingHandle                      The handle created by a call to the create function.
+* @param    feedbackRecordReceivedCallback       Called once for every record, in the order of the message.
+*                                                @c NULL goes back to delivering whole batches.
+* @param    userContextCallback                  User specified context that will be provided to the
+*                                                callback. This can be @c NULL.
+*
+*            While a record callback is set the records are handed out as they are parsed and
+*            the callback set by IoTHubMessaging_LL_SetFeedbackMessageCallback is not called, so
+*            no batch or list is built. The record and its strings are only valid during the call.
+*
+* @return    IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetFeedbackRecordCallback, IOTHUB_MESSAGING_HANDLE, messagingHandle, IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, feedbackRecordReceivedCallback, void*, userContextCallback);
+
 /**
 * @brief    This function is meant to be called by the user when work
 *             (sending/receiving) can be done by the IoTHubServiceClient.
@@ -155,6 +201,31 @@ MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetFeedbackMessa
 */
 MOCKABLE_FUNCTION(, void, IoTHubMessaging_LL_DoWork, IOTHUB_MESSAGING_HANDLE, messagingHandle);
 
+/**
+* @brief    Limits the number of IoTHubMessaging_LL_Send calls waiting for their send complete callback.
+*
+* @param    messagingHandle     The handle created by a call to the create function.
+* @param    maxInFlightSends    Once this many sends are in flight IoTHubMessaging_LL_Send fails
+*                               until one of them completes. 0 (the default) means no limit.
+*
+* @return   IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetMaxInFlightSends, IOTHUB_MESSAGING_HANDLE, messagingHandle, size_t, maxInFlightSends);
+
+/**
+* @brief    Reports how many sends are waiting for their send complete callback.
+*
+* @param    messagingHandle     The handle created by a call to the create function.
+* @param    inFlightSendCount   Receives the number of sends in flight. Every device of a
+*                               batch counts as one send.
+*
+*            A caller pumping IoTHubMessaging_LL_DoWork can use it to call it often while
+*            sends are in flight and back off when nothing is outstanding.
+*
+* @return   IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_GetInFlightSendCount, IOTHUB_MESSAGING_HANDLE, messagingHandle, size_t*, inFlightSendCount);
+
 /**
 * @brief    This function is meant to be called by the user when to
 *           set the trusted certificate on the tls connection.
@@ -165,6 +165,64 @@ typedef struct IOTHUB_REGISTRY_MODULE_UPDATE_TAG
     const char* managedBy;                          //version 1+
 } IOTHUB_REGISTRY_MODULE_UPDATE;
 
+#define IOTHUB_REGISTRY_BULK_MODE_VALUES                \
+    IOTHUB_REGISTRY_BULK_CREATE,                        \
+    IOTHUB_REGISTRY_BULK_UPDATE,                        \
+    IOTHUB_REGISTRY_BULK_UPDATE_IF_MATCH_ETAG,          \
+    IOTHUB_REGISTRY_BULK_DELETE,                        \
+    IOTHUB_REGISTRY_BULK_DELETE_IF_MATCH_ETAG           \
+
+DEFINE_ENUM(IOTHUB_REGISTRY_BULK_MODE, IOTHUB_REGISTRY_BULK_MODE_VALUES);
+
+#define IOTHUB_REGISTRY_BULK_DEVICE_VERSION_1 1
+typedef struct IOTHUB_REGISTRY_BULK_DEVICE_TAG
+{
+    int version;
+    IOTHUB_REGISTRY_BULK_MODE mode;                 //version 1+
+    const char* deviceId;                           //version 1+
+    const char* eTag;                               //version 1+, only used by the _IF_MATCH_ETAG modes
+    const char* primaryKey;                         //version 1+
+    const char* secondaryKey;                       //version 1+
+    IOTHUB_DEVICE_STATUS status;                    //version 1+
+    IOTHUB_REGISTRYMANAGER_AUTH_METHOD authMethod;  //version 1+
+    bool iotEdge_capable;                           //version 1+
+} IOTHUB_REGISTRY_BULK_DEVICE;
+
+#define IOTHUB_REGISTRY_JOB_TYPE_VALUES     \
+    IOTHUB_REGISTRY_JOB_TYPE_UNKNOWN,       \
+    IOTHUB_REGISTRY_JOB_TYPE_EXPORT,        \
+    IOTHUB_REGISTRY_JOB_TYPE_IMPORT         \
+
+DEFINE_ENUM(IOTHUB_REGISTRY_JOB_TYPE, IOTHUB_REGISTRY_JOB_TYPE_VALUES);
+
+#define IOTHUB_REGISTRY_JOB_STATUS_VALUES   \
+    IOTHUB_REGISTRY_JOB_STATUS_UNKNOWN,     \
+    IOTHUB_REGISTRY_JOB_STATUS_ENQUEUED,    \
+    IOTHUB_REGISTRY_JOB_STATUS_RUNNING,     \
+    IOTHUB_REGISTRY_JOB_STATUS_COMPLETED,   \
+    IOTHUB_REGISTRY_JOB_STATUS_FAILED,      \
+    IOTHUB_REGISTRY_JOB_STATUS_CANCELLED    \
+
+DEFINE_ENUM(IOTHUB_REGISTRY_JOB_STATUS, IOTHUB_REGISTRY_JOB_STATUS_VALUES);
+
+typedef struct IOTHUB_REGISTRY_JOB_TAG
+{
+    const char* jobId;
+    IOTHUB_REGISTRY_JOB_TYPE type;
+    IOTHUB_REGISTRY_JOB_STATUS status;
+    int progress;
+    const char* startTimeUtc;
+    const char* endTimeUtc;
+    const char* failureReason;
+} IOTHUB_REGISTRY_JOB;
+
+/**
+* @brief    Free members of the IOTHUB_REGISTRY_JOB structure (NOT the structure itself)
+*
+* @param    job      The structure to have its members freed.
+*/
+extern void IoTHubRegistryManager_FreeJobMembers(IOTHUB_REGISTRY_JOB* job);
+
 /** @brief Structure to store IoTHub authentication information
 */
 typedef struct IOTHUB_REGISTRYMANAGER_TAG
@@ -175,6 +233,7 @@ typedef struct IOTHUB_REGISTRYMANAGER_TAG
     char* sharedAccessKey;
     char* keyName;
     char* deviceId;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
 } IOTHUB_REGISTRYMANAGER;
 
 /** @brief Handle to hide struct and use it in consequent APIs
@@ -313,6 +372,118 @@ extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_DeleteModule(IOTHUB_R
 */
 extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetModuleList(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* deviceId, SINGLYLINKEDLIST_HANDLE moduleList, int module_version);
 
+/** @brief  Called once for every device of an enumeration. The structure and its members are only valid during the call.
+*           Return 0 to continue, any other value stops the enumeration.
+*/
+typedef int(*IOTHUB_REGISTRYMANAGER_DEVICE_ENUM_CALLBACK)(void* context, const IOTHUB_DEVICE_EX* device);
+
+/** @brief  Called once for every module of an enumeration. The structure and its members are only valid during the call.
+*           Return 0 to continue, any other value stops the enumeration.
+*/
+typedef int(*IOTHUB_REGISTRYMANAGER_MODULE_ENUM_CALLBACK)(void* context, const IOTHUB_MODULE* module);
+
+/**
+* @brief    Enumerates all the devices registered on the IoT Hub, one page at a time.
+*
+*           Pages are requested with the device query API (POST /devices/query, SELECT * FROM devices)
+*           and continuation tokens are followed until the last page, so there is no limit on the
+*           number of devices. Records are handed to the callback as they are parsed, only one page
+*           of the response is held in memory.
+*
+*           The records are device twins returned by the query, not the device identities returned by
+*           IoTHubRegistryManager_GetDevice. They never carry authentication data: primaryKey and
+*           secondaryKey are always NULL and authMethod is taken from the authenticationType of the twin.
+*           Use IoTHubRegistryManager_GetDevice to read the keys of a device.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    pageSize                Number of devices requested per page, between 1 and 1000.
+* @param    deviceCallback          Callback called for every device.
+* @param    context                 User context passed to the callback.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK upon success or an error code upon failure.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_EnumerateDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, size_t pageSize, IOTHUB_REGISTRYMANAGER_DEVICE_ENUM_CALLBACK deviceCallback, void* context);
+
+/**
+* @brief    Enumerates all the modules of all the devices registered on the IoT Hub, one page at a time.
+*
+*           Pages are requested exactly as IoTHubRegistryManager_EnumerateDevices does, with the query
+*           SELECT * FROM devices.modules. The records are module twins, not the module identities returned
+*           by IoTHubRegistryManager_GetModule: primaryKey and secondaryKey are always NULL.
+*           Use IoTHubRegistryManager_GetModule to read the keys of a module.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    pageSize                Number of modules requested per page, between 1 and 1000.
+* @param    module_version          The version of the module structure handed to the callback
+* @param    moduleCallback          Callback called for every module.
+* @param    context                 User context passed to the callback.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK upon success or an error code upon failure.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_EnumerateModules(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, size_t pageSize, int module_version, IOTHUB_REGISTRYMANAGER_MODULE_ENUM_CALLBACK moduleCallback, void* context);
+
+/**
+* @brief    Creates, updates or deletes many devices, up to 100 per request.
+*
+*           The devices are split in requests of at most 100 devices each and up to
+*           maxConcurrentRequests of them are in flight at the same time. The call returns
+*           when every request has completed.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    devices                 Array of deviceCount devices, every one with its own mode.
+* @param    deviceCount             Number of devices in the array.
+* @param    maxConcurrentRequests   Maximum number of requests in flight, between 1 and 16.
+* @param    results                 Array of deviceCount results, receives the outcome of every device.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK when every device succeeded, otherwise the result of the first device that failed.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_BulkDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const IOTHUB_REGISTRY_BULK_DEVICE* devices, size_t deviceCount, size_t maxConcurrentRequests, IOTHUB_REGISTRYMANAGER_RESULT* results);
+
+/**
+* @brief    Starts a job that exports the whole device registry to a blob container.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    outputBlobContainerUri  SAS URI of the blob container that receives devices.txt.
+* @param    excludeKeys             Export the devices without their keys.
+* @param    job                     Receives the job as accepted by the IoT Hub, free with IoTHubRegistryManager_FreeJobMembers.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK upon success or an error code upon failure.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_ExportDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* outputBlobContainerUri, bool excludeKeys, IOTHUB_REGISTRY_JOB* job);
+
+/**
+* @brief    Starts a job that imports devices.txt from a blob container into the device registry.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    inputBlobContainerUri   SAS URI of the blob container holding devices.txt.
+* @param    outputBlobContainerUri  SAS URI of the blob container that receives the import log.
+* @param    job                     Receives the job as accepted by the IoT Hub, free with IoTHubRegistryManager_FreeJobMembers.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK upon success or an error code upon failure.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_ImportDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* inputBlobContainerUri, const char* outputBlobContainerUri, IOTHUB_REGISTRY_JOB* job);
+
+/**
+* @brief    Gets the status of an import or export job.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    jobId                   The id of the job.
+* @param    job                     Receives the job, free with IoTHubRegistryManager_FreeJobMembers.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK upon success or an error code upon failure.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetJob(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* jobId, IOTHUB_REGISTRY_JOB* job);
+
+/**
+* @brief    Cancels an import or export job.
+*
+* @param    registryManagerHandle   The handle created by a call to the create function.
+* @param    jobId                   The id of the job.
+*
+* @return   IOTHUB_REGISTRYMANAGER_RESULT_OK upon success or an error code upon failure.
+*/
+extern IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_CancelJob(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* jobId);
+
 
 /* DEPRECATED: THE FOLLOWING APIS ARE DEPRECATED, AND ARE ONLY BEING KEPT FOR BACK COMPAT. PLEASE USE _EX EQUIVALENT ABOVE */
 /* DEPRECATED: THE FOLLOWING APIS ARE DEPRECATED, AND ARE ONLY BEING KEPT FOR BACK COMPAT. PLEASE USE _EX EQUIVALENT ABOVE */
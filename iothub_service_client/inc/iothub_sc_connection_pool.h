@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file iothub_sc_connection_pool.h
+*    @brief   HTTPS connections and SAS token shared by the service client modules.
+*
+*    @details The pool is created by IoTHubServiceClientAuth_CreateFromConnectionString
+*             and every registry manager, device twin, device method and device
+*             configuration handle created from the same IOTHUB_SERVICE_CLIENT_AUTH_HANDLE
+*             holds a reference to it. Idle HTTPAPIEX handles are kept open between
+*             requests so consecutive calls do not pay a new TCP connect and TLS
+*             handshake, and the SAS token is reused until it is close to expiry.
+*/
+
+#ifndef IOTHUB_SC_CONNECTION_POOL_H
+#define IOTHUB_SC_CONNECTION_POOL_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/httpapiex.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct IOTHUB_SC_CONNECTION_POOL_TAG* IOTHUB_SC_CONNECTION_POOL_HANDLE;
+
+/**
+* @brief    Creates a connection pool for the given IoT Hub credentials.
+*
+* @param    hostname           IoT Hub host name.
+* @param    sharedAccessKey    The shared access key used to sign the SAS token.
+* @param    keyName            Shared access key name, NULL when deviceId is used.
+* @param    deviceId           Device id the key belongs to, NULL when keyName is used.
+*
+* @return   A non-NULL @c IOTHUB_SC_CONNECTION_POOL_HANDLE having a reference count of 1, @c NULL on failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_SC_CONNECTION_POOL_HANDLE, IoTHubScConnectionPool_Create, const char*, hostname, const char*, sharedAccessKey, const char*, keyName, const char*, deviceId);
+
+/**
+* @brief    Takes a new reference to the pool.
+*
+* @return   @p connectionPool or @c NULL if @p connectionPool is @c NULL.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_SC_CONNECTION_POOL_HANDLE, IoTHubScConnectionPool_Clone, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool);
+
+/**
+* @brief    Releases a reference to the pool. The last reference closes all the idle connections.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubScConnectionPool_Destroy, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool);
+
+/**
+* @brief    Executes an HTTP request on a pooled connection, with the Authorization header set to the cached SAS token.
+*
+*           Same contract as HTTPAPIEX_ExecuteRequest. @p requestHttpHeadersHandle must already
+*           contain an Authorization header, its value is replaced.
+*/
+MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, IoTHubScConnectionPool_ExecuteRequest, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath, HTTP_HEADERS_HANDLE, requestHttpHeadersHandle, BUFFER_HANDLE, requestContent, unsigned int*, statusCode, HTTP_HEADERS_HANDLE, responseHttpHeadersHandle, BUFFER_HANDLE, responseContent);
+
+/**
+* @brief    Same as IoTHubScConnectionPool_ExecuteRequest, with the connection's HTTP timeout set to @p timeoutInMilliseconds.
+*
+*           Idle connections remember the timeout they were last used with. Requests without
+*           timeout never reuse them.
+*/
+MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, IoTHubScConnectionPool_ExecuteRequestWithTimeout, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath, HTTP_HEADERS_HANDLE, requestHttpHeadersHandle, BUFFER_HANDLE, requestContent, unsigned int*, statusCode, HTTP_HEADERS_HANDLE, responseHttpHeadersHandle, BUFFER_HANDLE, responseContent, unsigned int, timeoutInMilliseconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_SC_CONNECTION_POOL_H
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file iothub_sc_feedback_parser.h
+*    @brief   Single pass parser for the JSON body of cloud-to-device feedback messages.
+*
+*    @details The body is a JSON array of feedback records. The parser walks it once,
+*             unescaping the strings in place, and hands every record to a handler as
+*             soon as its closing brace is reached. It does not allocate: the strings of
+*             a record point into the parsed text and the record itself lives on the
+*             parser's stack, so a handler that needs to keep it copies the structure.
+*/
+
+#ifndef IOTHUB_SC_FEEDBACK_PARSER_H
+#define IOTHUB_SC_FEEDBACK_PARSER_H
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "iothub_messaging_ll.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#endif
+
+/**
+* @brief    Called for every feedback record. Return 0 to continue, any other value stops the parser with a failure.
+*/
+typedef int(*IOTHUB_SC_FEEDBACK_RECORD_HANDLER)(void* context, IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord);
+
+/**
+* @brief    Parses a feedback batch.
+*
+* @param    feedbackJson    The JSON text. It is modified: strings are unescaped and NUL terminated in place.
+* @param    length          Number of bytes of feedbackJson, which does not need to be NUL terminated.
+* @param    recordHandler   Called for every record, in order.
+* @param    context         Passed to recordHandler.
+* @param    recordCount     Receives the number of records handed to recordHandler.
+*
+* @return   0 when the whole text is a JSON array of objects and recordHandler accepted every record, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, IoTHubScFeedbackParser_Parse, char*, feedbackJson, size_t, length, IOTHUB_SC_FEEDBACK_RECORD_HANDLER, recordHandler, void*, context, size_t*, recordCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_SC_FEEDBACK_PARSER_H
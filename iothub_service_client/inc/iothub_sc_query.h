@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file iothub_sc_query.h
+*    @brief   Paged IoT Hub queries shared by the service client modules.
+*
+*    @details Internal to the service client. The registry manager, device twin and
+*             job client all read query results the same way: one request per page on
+*             the connection pool, the x-ms-max-item-count and x-ms-continuation headers,
+*             and a page that is a JSON array of objects. The page is walked in place and
+*             every object is handed to a callback as NUL terminated JSON text, so only one
+*             page is ever held in memory and no JSON tree is built for the whole page.
+*/
+
+#ifndef IOTHUB_SC_QUERY_H
+#define IOTHUB_SC_QUERY_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "iothub_sc_connection_pool.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+#define IOTHUB_SC_QUERY_RESULT_VALUES       \
+    IOTHUB_SC_QUERY_OK,                     \
+    IOTHUB_SC_QUERY_INVALID_ARG,            \
+    IOTHUB_SC_QUERY_ERROR,                  \
+    IOTHUB_SC_QUERY_JSON_ERROR,             \
+    IOTHUB_SC_QUERY_HTTPAPI_ERROR,          \
+    IOTHUB_SC_QUERY_HTTP_STATUS_ERROR       \
+
+DEFINE_ENUM(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_RESULT_VALUES);
+
+/**
+* @brief    Creates the headers of one page request, without the paging headers. Called once per page.
+*/
+typedef HTTP_HEADERS_HANDLE(*IOTHUB_SC_QUERY_CREATE_HEADERS)(void);
+
+/**
+* @brief    Called for every object of a page with its JSON text, which is only valid during the call.
+*           Return 0 to continue, any other value stops the query without requesting further pages.
+*/
+typedef int(*IOTHUB_SC_QUERY_RESULT_CALLBACK)(void* context, const char* resultJson);
+
+/**
+* @brief    Runs a paged query until the last page or until @p resultCallback stops it.
+*
+* @param    connectionPool          The pool the requests are executed on.
+* @param    requestType             HTTP verb of every page request.
+* @param    relativePath            Relative path of every page request.
+* @param    createRequestHeaders    Creates the headers of a page request; x-ms-max-item-count and x-ms-continuation are added to them.
+* @param    requestBody             Body of every page request, can be @c NULL.
+* @param    pageSize                Value of the x-ms-max-item-count header.
+* @param    resultCallback          Called for every object of every page.
+* @param    context                 Passed to @p resultCallback.
+*
+* @return   @c IOTHUB_SC_QUERY_OK when every page was read or the callback stopped the query,
+*           @c IOTHUB_SC_QUERY_HTTPAPI_ERROR if a request could not be executed,
+*           @c IOTHUB_SC_QUERY_HTTP_STATUS_ERROR if the status code of a page is 300 or above,
+*           @c IOTHUB_SC_QUERY_JSON_ERROR if a page is not a JSON array of objects.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_SC_QUERY_RESULT, IoTHubScQuery_Execute, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath, IOTHUB_SC_QUERY_CREATE_HEADERS, createRequestHeaders, BUFFER_HANDLE, requestBody, size_t, pageSize, IOTHUB_SC_QUERY_RESULT_CALLBACK, resultCallback, void*, context);
+
+/**
+* @brief    Hands every object of one page to @p resultCallback.
+*
+*           The byte that follows each object is overwritten with a NUL while the callback
+*           runs and restored afterwards, the page is otherwise left unchanged.
+*
+* @param    pageBuffer      The page, a JSON array of objects.
+* @param    resultCallback  Called for every object of the page.
+* @param    context         Passed to @p resultCallback.
+* @param    isStopped       Set to true when @p resultCallback returns a non-zero value.
+*
+* @return   @c IOTHUB_SC_QUERY_OK or @c IOTHUB_SC_QUERY_JSON_ERROR if the page is not a JSON array of objects.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_SC_QUERY_RESULT, IoTHubScQuery_ParsePage, BUFFER_HANDLE, pageBuffer, IOTHUB_SC_QUERY_RESULT_CALLBACK, resultCallback, void*, context, bool*, isStopped);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_SC_QUERY_H
@@ -21,6 +21,7 @@
 
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
+#include "iothub_sc_connection_pool.h"
 
 #define IOTHUB_DEVICE_STATUS_VALUES       \
     IOTHUB_DEVICE_STATUS_ENABLED,         \
@@ -52,6 +53,7 @@ typedef struct IOTHUB_SERVICE_CLIENT_AUTH_TAG
     char* sharedAccessKey;
     char* keyName;
     char* deviceId;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
 } IOTHUB_SERVICE_CLIENT_AUTH;
 
 /** @brief Handle to hide struct and use it in consequent APIs
@@ -10,10 +10,11 @@
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
 
 #include "parson.h"
 #include "iothub_devicemethod.h"
@@ -38,6 +39,11 @@ DEFINE_ENUM(IOTHUB_DEVICEMETHOD_REQUEST_MODE, IOTHUB_DEVICE_METHOD_REQUEST_MODE_
 #define  HTTP_HEADER_VAL_CONTENT_TYPE  "application/json; charset=utf-8"
 #define UID_LENGTH 37
 
+/*the service waits 30 seconds for the device when the request has no timeout*/
+#define INVOKE_DEFAULT_TIMEOUT_IN_SECONDS 30
+/*time allowed to the service on top of the method timeout before the HTTP request is abandoned*/
+#define INVOKE_HTTP_TIMEOUT_MARGIN_IN_SECONDS 10
+
 static const char* const URL_API_VERSION = "?api-version=2017-11-08-preview";
 static const char* const RELATIVE_PATH_FMT_DEVICEMETHOD = "/twins/%s/methods%s";
 static const char* const RELATIVE_PATH_FMT_DEVICEMETHOD_MODULE = "/twins/%s/modules/%s/methods%s";
@@ -50,8 +56,30 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
+    LOCK_HANDLE lock;
+    SINGLYLINKEDLIST_HANDLE invokeBatches;
 } IOTHUB_SERVICE_CLIENT_DEVICE_METHOD;
 
+/** @brief Devices of one IoTHubDeviceMethod_InvokeOnDevicesAsync call and the worker threads invoking them
+*/
+typedef struct DEVICE_METHOD_INVOKE_BATCH_TAG
+{
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle;
+    char** deviceIds;
+    size_t deviceCount;
+    char* methodName;
+    char* methodPayload;
+    unsigned int timeout;
+    IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK invokeCallback;
+    void* context;
+    LOCK_HANDLE lock;
+    size_t nextDevice;
+    size_t runningThreadCount;
+    THREAD_HANDLE workerThreads[IOTHUB_DEVICE_METHOD_MAX_CONCURRENT_INVOCATIONS];
+    size_t workerThreadCount;
+} DEVICE_METHOD_INVOKE_BATCH;
+
 static IOTHUB_DEVICE_METHOD_RESULT parseResponseJson(BUFFER_HANDLE responseJson, int* responseStatus, unsigned char** responsePayload, size_t* responsePayloadSize)
 {
     IOTHUB_DEVICE_METHOD_RESULT result;
@@ -243,62 +271,33 @@ static HTTP_HEADERS_HANDLE createHttpHeader()
     return httpHeader;
 }
 
-static IOTHUB_DEVICE_METHOD_RESULT sendHttpRequestDeviceMethod(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, IOTHUB_DEVICEMETHOD_REQUEST_MODE iotHubDeviceMethodRequestMode, const char* deviceId, const char* moduleId, BUFFER_HANDLE deviceJsonBuffer, BUFFER_HANDLE responseBuffer)
+static HTTPAPIEX_RESULT executeDeviceMethodRequest(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, HTTPAPI_REQUEST_TYPE httpApiRequestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeader, BUFFER_HANDLE deviceJsonBuffer, unsigned int* statusCode, BUFFER_HANDLE responseBuffer, unsigned int httpTimeoutInMilliseconds)
 {
-    IOTHUB_DEVICE_METHOD_RESULT result;
-
-    STRING_HANDLE uriResource;
-    STRING_HANDLE accessKey;
-    STRING_HANDLE keyName;
-    HTTPAPIEX_SAS_HANDLE httpExApiSasHandle;
-    HTTPAPIEX_HANDLE httpExApiHandle;
-    HTTP_HEADERS_HANDLE httpHeader;
+    HTTPAPIEX_RESULT result;
 
-    if ((uriResource = STRING_construct(serviceClientDeviceMethodHandle->hostname)) == NULL)
+    if (httpTimeoutInMilliseconds == 0)
     {
-        LogError("STRING_construct failed for uriResource");
-        result = IOTHUB_DEVICE_METHOD_ERROR;
+        result = IoTHubScConnectionPool_ExecuteRequest(serviceClientDeviceMethodHandle->connectionPool, httpApiRequestType, relativePath, httpHeader, deviceJsonBuffer, statusCode, NULL, responseBuffer);
     }
-    else if ((accessKey = STRING_construct(serviceClientDeviceMethodHandle->sharedAccessKey)) == NULL)
+    else
     {
-        LogError("STRING_construct failed for accessKey");
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_METHOD_ERROR;
+        result = IoTHubScConnectionPool_ExecuteRequestWithTimeout(serviceClientDeviceMethodHandle->connectionPool, httpApiRequestType, relativePath, httpHeader, deviceJsonBuffer, statusCode, NULL, responseBuffer, httpTimeoutInMilliseconds);
     }
-    else if ((keyName = STRING_construct(serviceClientDeviceMethodHandle->keyName)) == NULL)
-    {
-        LogError("STRING_construct failed for keyName");
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_METHOD_ERROR;
-    }
-    else if ((httpHeader = createHttpHeader()) == NULL)
+
+    return result;
+}
+
+static IOTHUB_DEVICE_METHOD_RESULT sendHttpRequestDeviceMethod(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, IOTHUB_DEVICEMETHOD_REQUEST_MODE iotHubDeviceMethodRequestMode, const char* deviceId, const char* moduleId, BUFFER_HANDLE deviceJsonBuffer, BUFFER_HANDLE responseBuffer, unsigned int httpTimeoutInMilliseconds)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+
+    HTTP_HEADERS_HANDLE httpHeader;
+
+    if ((httpHeader = createHttpHeader()) == NULL)
     {
         LogError("HttpHeader creation failed");
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
         result = IOTHUB_DEVICE_METHOD_ERROR;
     }
-    else if ((httpExApiSasHandle = HTTPAPIEX_SAS_Create(accessKey, uriResource, keyName)) == NULL)
-    {
-        LogError("HTTPAPIEX_SAS_Create failed");
-        HTTPHeaders_Free(httpHeader);
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_METHOD_HTTPAPI_ERROR;
-    }
-    else if ((httpExApiHandle = HTTPAPIEX_Create(serviceClientDeviceMethodHandle->hostname)) == NULL)
-    {
-        LogError("HTTPAPIEX_Create failed");
-        HTTPAPIEX_SAS_Destroy(httpExApiSasHandle);
-        HTTPHeaders_Free(httpHeader);
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_METHOD_HTTPAPI_ERROR;
-    }
     else
     {
         HTTPAPI_REQUEST_TYPE httpApiRequestType = HTTPAPI_REQUEST_GET;
@@ -327,9 +326,9 @@ static IOTHUB_DEVICE_METHOD_RESULT sendHttpRequestDeviceMethod(IOTHUB_SERVICE_CL
                 LogError("Failure creating relative path");
                 result = IOTHUB_DEVICE_METHOD_ERROR;
             }
-            else if (HTTPAPIEX_SAS_ExecuteRequest(httpExApiSasHandle, httpExApiHandle, httpApiRequestType, STRING_c_str(relativePath), httpHeader, deviceJsonBuffer, &statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
+            else if (executeDeviceMethodRequest(serviceClientDeviceMethodHandle, httpApiRequestType, STRING_c_str(relativePath), httpHeader, deviceJsonBuffer, &statusCode, responseBuffer, httpTimeoutInMilliseconds) != HTTPAPIEX_OK)
             {
-                LogError("HTTPAPIEX_SAS_ExecuteRequest failed");
+                LogError("IoTHubScConnectionPool_ExecuteRequest failed");
                 STRING_delete(relativePath);
                 result = IOTHUB_DEVICE_METHOD_HTTPAPI_ERROR;
             }
@@ -347,16 +346,82 @@ static IOTHUB_DEVICE_METHOD_RESULT sendHttpRequestDeviceMethod(IOTHUB_SERVICE_CL
                 }
             }
         }
-        HTTPAPIEX_Destroy(httpExApiHandle);
-        HTTPAPIEX_SAS_Destroy(httpExApiSasHandle);
         HTTPHeaders_Free(httpHeader);
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
     }
     return result;
 }
 
+static void destroyInvokeBatch(DEVICE_METHOD_INVOKE_BATCH* batch)
+{
+    size_t i;
+
+    for (i = 0; i < batch->deviceCount; i++)
+    {
+        free(batch->deviceIds[i]);
+    }
+    free(batch->deviceIds);
+    free(batch->methodName);
+    free(batch->methodPayload);
+    if (batch->lock != NULL)
+    {
+        (void)Lock_Deinit(batch->lock);
+    }
+    free(batch);
+}
+
+static void joinInvokeBatchThreads(DEVICE_METHOD_INVOKE_BATCH* batch)
+{
+    size_t i;
+
+    for (i = 0; i < batch->workerThreadCount; i++)
+    {
+        int threadResult;
+        if (ThreadAPI_Join(batch->workerThreads[i], &threadResult) != THREADAPI_OK)
+        {
+            LogError("ThreadAPI_Join failed");
+        }
+    }
+    batch->workerThreadCount = 0;
+}
+
+static bool isInvokeBatchFinished(DEVICE_METHOD_INVOKE_BATCH* batch)
+{
+    bool result;
+
+    if (Lock(batch->lock) != LOCK_OK)
+    {
+        LogError("Lock failed");
+        result = false;
+    }
+    else
+    {
+        result = (batch->runningThreadCount == 0);
+        (void)Unlock(batch->lock);
+    }
+
+    return result;
+}
+
+/*must be called with serviceClientDeviceMethod->lock held, or from IoTHubDeviceMethod_Destroy*/
+static void removeInvokeBatches(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD* serviceClientDeviceMethod, bool finishedOnly)
+{
+    LIST_ITEM_HANDLE item = singlylinkedlist_get_head_item(serviceClientDeviceMethod->invokeBatches);
+
+    while (item != NULL)
+    {
+        DEVICE_METHOD_INVOKE_BATCH* batch = (DEVICE_METHOD_INVOKE_BATCH*)singlylinkedlist_item_get_value(item);
+        LIST_ITEM_HANDLE nextItem = singlylinkedlist_get_next_item(item);
+
+        if (!finishedOnly || isInvokeBatchFinished(batch))
+        {
+            joinInvokeBatchThreads(batch);
+            (void)singlylinkedlist_remove(serviceClientDeviceMethod->invokeBatches, item);
+            destroyInvokeBatch(batch);
+        }
+        item = nextItem;
+    }
+}
+
 IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE IoTHubDeviceMethod_Create(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE serviceClientHandle)
 {
     IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE result;
@@ -436,6 +501,41 @@ IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE IoTHubDeviceMethod_Create(IOTHUB_SERV
                     free(result);
                     result = NULL;
                 }
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_02_001: [ IoTHubDeviceMethod_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ]*/
+                else if ((result->connectionPool = IoTHubScConnectionPool_Clone(serviceClientAuth->connectionPool)) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBDEVICEMETHOD_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
+                    LogError("IoTHubScConnectionPool_Clone failed");
+                    free(result->hostname);
+                    free(result->sharedAccessKey);
+                    free(result->keyName);
+                    free(result);
+                    result = NULL;
+                }
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_02_004: [ IoTHubDeviceMethod_Create shall create a lock by calling Lock_Init and an empty list of asynchronous invocation batches by calling singlylinkedlist_create. ]*/
+                else if ((result->lock = Lock_Init()) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBDEVICEMETHOD_02_005: [ If Lock_Init or singlylinkedlist_create fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
+                    LogError("Lock_Init failed");
+                    IoTHubScConnectionPool_Destroy(result->connectionPool);
+                    free(result->hostname);
+                    free(result->sharedAccessKey);
+                    free(result->keyName);
+                    free(result);
+                    result = NULL;
+                }
+                else if ((result->invokeBatches = singlylinkedlist_create()) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBDEVICEMETHOD_02_005: [ If Lock_Init or singlylinkedlist_create fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
+                    LogError("singlylinkedlist_create failed");
+                    (void)Lock_Deinit(result->lock);
+                    IoTHubScConnectionPool_Destroy(result->connectionPool);
+                    free(result->hostname);
+                    free(result->sharedAccessKey);
+                    free(result->keyName);
+                    free(result);
+                    result = NULL;
+                }
             }
         }
     }
@@ -450,14 +550,21 @@ void IoTHubDeviceMethod_Destroy(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE servi
         /*Codes_SRS_IOTHUBDEVICEMETHOD_12_017: [ If the serviceClientDeviceMethodHandle input parameter is not NULL IoTHubDeviceMethod_Destroy shall free the memory of it and return ]*/
         IOTHUB_SERVICE_CLIENT_DEVICE_METHOD* serviceClientDeviceMethod = (IOTHUB_SERVICE_CLIENT_DEVICE_METHOD*)serviceClientDeviceMethodHandle;
 
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_02_006: [ IoTHubDeviceMethod_Destroy shall wait for the worker threads of every asynchronous invocation by calling ThreadAPI_Join and free the invocations before releasing anything else. ]*/
+        removeInvokeBatches(serviceClientDeviceMethod, false);
+        singlylinkedlist_destroy(serviceClientDeviceMethod->invokeBatches);
+        (void)Lock_Deinit(serviceClientDeviceMethod->lock);
+
         free(serviceClientDeviceMethod->hostname);
         free(serviceClientDeviceMethod->sharedAccessKey);
         free(serviceClientDeviceMethod->keyName);
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_02_003: [ IoTHubDeviceMethod_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ]*/
+        IoTHubScConnectionPool_Destroy(serviceClientDeviceMethod->connectionPool);
         free(serviceClientDeviceMethod);
     }
 }
 
-static IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_DeviceOrModuleInvoke(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* deviceId, const char* moduleId,  const char* methodName, const char* methodPayload, unsigned int timeout, int* responseStatus, unsigned char** responsePayload, size_t* responsePayloadSize)
+static IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_DeviceOrModuleInvoke(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* deviceId, const char* moduleId,  const char* methodName, const char* methodPayload, unsigned int timeout, unsigned int httpTimeoutInMilliseconds, int* responseStatus, unsigned char** responsePayload, size_t* responsePayloadSize)
 {
     IOTHUB_DEVICE_METHOD_RESULT result;
 
@@ -489,10 +596,10 @@ static IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_DeviceOrModuleInvoke(IOTHU
         }
         /*Codes_SRS_IOTHUBDEVICEMETHOD_12_039: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTP POST request using methodPayloadBuffer ]*/
         /*Codes_SRS_IOTHUBDEVICEMETHOD_12_040: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTP POST request using the following HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-        /*Codes_SRS_IOTHUBDEVICEMETHOD_12_041: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-        /*Codes_SRS_IOTHUBDEVICEMETHOD_12_042: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-        /*Codes_SRS_IOTHUBDEVICEMETHOD_12_043: [ IoTHubDeviceMethod_Invoke(Module) shall execute the HTTP POST request by calling HTTPAPIEX_ExecuteRequest ]*/
-        else if (sendHttpRequestDeviceMethod(serviceClientDeviceMethodHandle, IOTHUB_DEVICEMETHOD_REQUEST_INVOKE, deviceId, moduleId, httpPayloadBuffer, responseBuffer) != IOTHUB_DEVICE_METHOD_OK)
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_12_041: [ IoTHubDeviceMethod_Invoke(Module) shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_12_042: [ IoTHubDeviceMethod_Invoke(Module) shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_12_043: [ IoTHubDeviceMethod_Invoke(Module) shall execute the HTTP POST request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
+        else if (sendHttpRequestDeviceMethod(serviceClientDeviceMethodHandle, IOTHUB_DEVICEMETHOD_REQUEST_INVOKE, deviceId, moduleId, httpPayloadBuffer, responseBuffer, httpTimeoutInMilliseconds) != IOTHUB_DEVICE_METHOD_OK)
         {
             /*Codes_SRS_IOTHUBDEVICEMETHOD_12_044: [ If any of the call fails during the HTTP creation IoTHubDeviceMethod_Invoke(Module) shall fail and return IOTHUB_DEVICE_METHOD_HTTPAPI_ERROR ]*/
             /*Codes_SRS_IOTHUBDEVICEMETHOD_12_045: [ If any of the HTTPAPI call fails IoTHubDeviceMethod_Invoke(Module) shall fail and return IOTHUB_DEVICE_METHOD_HTTPAPI_ERROR ]*/
@@ -526,7 +633,7 @@ static IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_DeviceOrModuleInvoke(IOTHU
 
 IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_Invoke(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* deviceId, const char* methodName, const char* methodPayload, unsigned int timeout, int* responseStatus, unsigned char** responsePayload, size_t* responsePayloadSize)
 {
-    return IoTHubDeviceMethod_DeviceOrModuleInvoke(serviceClientDeviceMethodHandle, deviceId, NULL, methodName, methodPayload, timeout, responseStatus, responsePayload, responsePayloadSize);
+    return IoTHubDeviceMethod_DeviceOrModuleInvoke(serviceClientDeviceMethodHandle, deviceId, NULL, methodName, methodPayload, timeout, 0, responseStatus, responsePayload, responsePayloadSize);
 }
 
 IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_InvokeModule(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* deviceId, const char* moduleId,  const char* methodName, const char* methodPayload, unsigned int timeout, int* responseStatus, unsigned char** responsePayload, size_t* responsePayloadSize)
@@ -541,9 +648,274 @@ IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_InvokeModule(IOTHUB_SERVICE_CLIEN
     }
     else
     {
-        result = IoTHubDeviceMethod_DeviceOrModuleInvoke(serviceClientDeviceMethodHandle, deviceId, moduleId, methodName, methodPayload, timeout, responseStatus, responsePayload, responsePayloadSize);
+        result = IoTHubDeviceMethod_DeviceOrModuleInvoke(serviceClientDeviceMethodHandle, deviceId, moduleId, methodName, methodPayload, timeout, 0, responseStatus, responsePayload, responsePayloadSize);
+    }
+
+    return result;
+}
+
+static bool takeNextInvokeDevice(DEVICE_METHOD_INVOKE_BATCH* batch, size_t* deviceIndex)
+{
+    bool result;
+
+    if (Lock(batch->lock) != LOCK_OK)
+    {
+        LogError("Lock failed");
+        result = false;
+    }
+    else
+    {
+        if (batch->nextDevice >= batch->deviceCount)
+        {
+            result = false;
+        }
+        else
+        {
+            *deviceIndex = batch->nextDevice;
+            batch->nextDevice++;
+            result = true;
+        }
+        (void)Unlock(batch->lock);
     }
 
     return result;
 }
 
+static int invokeBatchWorkerThread(void* context)
+{
+    DEVICE_METHOD_INVOKE_BATCH* batch = (DEVICE_METHOD_INVOKE_BATCH*)context;
+    /*Codes_SRS_IOTHUBDEVICEMETHOD_02_011: [ Every invocation shall be done as IoTHubDeviceMethod_Invoke does it, on a pooled connection by calling IoTHubScConnectionPool_ExecuteRequestWithTimeout with a timeout of timeout seconds, or 30 seconds when timeout is 0, plus 10 seconds. ]*/
+    unsigned int httpTimeoutInMilliseconds = (((batch->timeout == 0) ? INVOKE_DEFAULT_TIMEOUT_IN_SECONDS : batch->timeout) + INVOKE_HTTP_TIMEOUT_MARGIN_IN_SECONDS) * 1000;
+    size_t deviceIndex;
+
+    while (takeNextInvokeDevice(batch, &deviceIndex))
+    {
+        int responseStatus = 0;
+        unsigned char* responsePayload = NULL;
+        size_t responsePayloadSize = 0;
+        IOTHUB_DEVICE_METHOD_RESULT invokeResult = IoTHubDeviceMethod_DeviceOrModuleInvoke(batch->serviceClientDeviceMethodHandle, batch->deviceIds[deviceIndex], NULL, batch->methodName, batch->methodPayload, batch->timeout, httpTimeoutInMilliseconds, &responseStatus, &responsePayload, &responsePayloadSize);
+
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_02_012: [ After every invocation the worker thread shall call invokeCallback with the device id, the result, the response status and the response payload. Callbacks of the same call shall not run concurrently and the payload shall only be valid during the callback. ]*/
+        if (Lock(batch->lock) != LOCK_OK)
+        {
+            LogError("Lock failed, the callback for %s is not serialized", batch->deviceIds[deviceIndex]);
+            batch->invokeCallback(batch->context, batch->deviceIds[deviceIndex], invokeResult, responseStatus, responsePayload, responsePayloadSize);
+        }
+        else
+        {
+            batch->invokeCallback(batch->context, batch->deviceIds[deviceIndex], invokeResult, responseStatus, responsePayload, responsePayloadSize);
+            (void)Unlock(batch->lock);
+        }
+        free(responsePayload);
+    }
+
+    if (Lock(batch->lock) != LOCK_OK)
+    {
+        LogError("Lock failed, the invocation is released by IoTHubDeviceMethod_Destroy");
+    }
+    else
+    {
+        batch->runningThreadCount--;
+        (void)Unlock(batch->lock);
+    }
+
+    return 0;
+}
+
+static DEVICE_METHOD_INVOKE_BATCH* createInvokeBatch(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* const* deviceIds, size_t deviceCount, const char* methodName, const char* methodPayload, unsigned int timeout, IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK invokeCallback, void* context)
+{
+    DEVICE_METHOD_INVOKE_BATCH* result;
+
+    if ((result = (DEVICE_METHOD_INVOKE_BATCH*)malloc(sizeof(DEVICE_METHOD_INVOKE_BATCH))) == NULL)
+    {
+        LogError("malloc failed for DEVICE_METHOD_INVOKE_BATCH");
+    }
+    else
+    {
+        (void)memset(result, 0, sizeof(DEVICE_METHOD_INVOKE_BATCH));
+        result->serviceClientDeviceMethodHandle = serviceClientDeviceMethodHandle;
+        result->timeout = timeout;
+        result->invokeCallback = invokeCallback;
+        result->context = context;
+
+        if ((result->deviceIds = (char**)malloc(deviceCount * sizeof(char*))) == NULL)
+        {
+            LogError("malloc failed for the device ids");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            size_t i;
+
+            for (i = 0; i < deviceCount; i++)
+            {
+                if (mallocAndStrcpy_s(&result->deviceIds[i], deviceIds[i]) != 0)
+                {
+                    LogError("mallocAndStrcpy_s failed for device %lu", (unsigned long)i);
+                    break;
+                }
+            }
+            result->deviceCount = i;
+
+            if (i != deviceCount)
+            {
+                destroyInvokeBatch(result);
+                result = NULL;
+            }
+            else if (mallocAndStrcpy_s(&result->methodName, methodName) != 0)
+            {
+                LogError("mallocAndStrcpy_s failed for methodName");
+                destroyInvokeBatch(result);
+                result = NULL;
+            }
+            else if (mallocAndStrcpy_s(&result->methodPayload, methodPayload) != 0)
+            {
+                LogError("mallocAndStrcpy_s failed for methodPayload");
+                destroyInvokeBatch(result);
+                result = NULL;
+            }
+            else if ((result->lock = Lock_Init()) == NULL)
+            {
+                LogError("Lock_Init failed");
+                destroyInvokeBatch(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+static IOTHUB_DEVICE_METHOD_RESULT startInvokeBatch(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD* serviceClientDeviceMethod, DEVICE_METHOD_INVOKE_BATCH* batch, size_t maxConcurrentInvocations)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+    LIST_ITEM_HANDLE batchItem;
+
+    if ((batchItem = singlylinkedlist_add(serviceClientDeviceMethod->invokeBatches, batch)) == NULL)
+    {
+        LogError("singlylinkedlist_add failed");
+        result = IOTHUB_DEVICE_METHOD_ERROR;
+    }
+    else
+    {
+        size_t threadCount = (maxConcurrentInvocations < batch->deviceCount) ? maxConcurrentInvocations : batch->deviceCount;
+        size_t i;
+
+        /*the count only goes down as threads finish or fail to start, so the batch cannot look finished before every thread is accounted for*/
+        batch->runningThreadCount = threadCount;
+
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_02_010: [ IoTHubDeviceMethod_InvokeOnDevicesAsync shall start the smaller of maxConcurrentInvocations and deviceCount worker threads by calling ThreadAPI_Create, every worker thread shall take the next device that has not been invoked until all the devices are invoked. If a thread cannot be created its devices shall be invoked by the other threads. ]*/
+        for (i = 0; i < threadCount; i++)
+        {
+            if (ThreadAPI_Create(&batch->workerThreads[batch->workerThreadCount], invokeBatchWorkerThread, batch) != THREADAPI_OK)
+            {
+                LogError("ThreadAPI_Create failed, continuing with %lu threads", (unsigned long)batch->workerThreadCount);
+                if (Lock(batch->lock) != LOCK_OK)
+                {
+                    LogError("Lock failed");
+                }
+                else
+                {
+                    batch->runningThreadCount--;
+                    (void)Unlock(batch->lock);
+                }
+            }
+            else
+            {
+                batch->workerThreadCount++;
+            }
+        }
+
+        if (batch->workerThreadCount == 0)
+        {
+            LogError("no worker thread could be started");
+            (void)singlylinkedlist_remove(serviceClientDeviceMethod->invokeBatches, batchItem);
+            result = IOTHUB_DEVICE_METHOD_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_DEVICE_METHOD_OK;
+        }
+    }
+
+    return result;
+}
+
+IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_InvokeOnDevicesAsync(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* const* deviceIds, size_t deviceCount, const char* methodName, const char* methodPayload, unsigned int timeout, size_t maxConcurrentInvocations, IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK invokeCallback, void* context)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+    size_t i;
+
+    /*Codes_SRS_IOTHUBDEVICEMETHOD_02_007: [ If serviceClientDeviceMethodHandle, deviceIds, any of the device ids, methodName, methodPayload or invokeCallback is NULL, deviceCount is 0 or maxConcurrentInvocations is not between 1 and 16 then IoTHubDeviceMethod_InvokeOnDevicesAsync shall fail and return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+    if ((serviceClientDeviceMethodHandle == NULL) || (deviceIds == NULL) || (deviceCount == 0) || (methodName == NULL) || (methodPayload == NULL) || (invokeCallback == NULL) ||
+        (maxConcurrentInvocations == 0) || (maxConcurrentInvocations > IOTHUB_DEVICE_METHOD_MAX_CONCURRENT_INVOCATIONS))
+    {
+        LogError("Invalid argument serviceClientDeviceMethodHandle=%p deviceIds=%p deviceCount=%lu methodName=%p methodPayload=%p invokeCallback=%p maxConcurrentInvocations=%lu",
+            serviceClientDeviceMethodHandle, deviceIds, (unsigned long)deviceCount, methodName, methodPayload, invokeCallback, (unsigned long)maxConcurrentInvocations);
+        result = IOTHUB_DEVICE_METHOD_INVALID_ARG;
+    }
+    else
+    {
+        for (i = 0; (i < deviceCount) && (deviceIds[i] != NULL); i++)
+        {
+        }
+
+        if (i != deviceCount)
+        {
+            LogError("device id %lu is NULL", (unsigned long)i);
+            result = IOTHUB_DEVICE_METHOD_INVALID_ARG;
+        }
+        else
+        {
+            IOTHUB_SERVICE_CLIENT_DEVICE_METHOD* serviceClientDeviceMethod = (IOTHUB_SERVICE_CLIENT_DEVICE_METHOD*)serviceClientDeviceMethodHandle;
+            DEVICE_METHOD_INVOKE_BATCH* batch;
+
+            /*Codes_SRS_IOTHUBDEVICEMETHOD_02_008: [ IoTHubDeviceMethod_InvokeOnDevicesAsync shall copy the device ids, methodName and methodPayload. ]*/
+            if ((batch = createInvokeBatch(serviceClientDeviceMethodHandle, deviceIds, deviceCount, methodName, methodPayload, timeout, invokeCallback, context)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_02_013: [ If any call fails, IoTHubDeviceMethod_InvokeOnDevicesAsync shall fail and return IOTHUB_DEVICE_METHOD_ERROR, otherwise it shall return IOTHUB_DEVICE_METHOD_OK without waiting for the invocations. ]*/
+                LogError("failure copying the invocation");
+                result = IOTHUB_DEVICE_METHOD_ERROR;
+            }
+            else if (Lock(serviceClientDeviceMethod->lock) != LOCK_OK)
+            {
+                LogError("Lock failed");
+                destroyInvokeBatch(batch);
+                result = IOTHUB_DEVICE_METHOD_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_02_009: [ IoTHubDeviceMethod_InvokeOnDevicesAsync shall first wait for the worker threads of previous calls that have finished by calling ThreadAPI_Join and free them. ]*/
+                removeInvokeBatches(serviceClientDeviceMethod, true);
+
+                if ((result = startInvokeBatch(serviceClientDeviceMethod, batch, maxConcurrentInvocations)) != IOTHUB_DEVICE_METHOD_OK)
+                {
+                    LogError("failure starting the invocation");
+                    destroyInvokeBatch(batch);
+                }
+                (void)Unlock(serviceClientDeviceMethod->lock);
+            }
+        }
+    }
+
+    return result;
+}
+
+IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_InvokeAsync(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* deviceId, const char* methodName, const char* methodPayload, unsigned int timeout, IOTHUB_DEVICE_METHOD_INVOKE_CALLBACK invokeCallback, void* context)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+
+    /*Codes_SRS_IOTHUBDEVICEMETHOD_02_014: [ IoTHubDeviceMethod_InvokeAsync shall call IoTHubDeviceMethod_InvokeOnDevicesAsync with deviceId as the only device and maxConcurrentInvocations set to 1. ]*/
+    if (deviceId == NULL)
+    {
+        LogError("deviceId input parameter cannot be NULL");
+        result = IOTHUB_DEVICE_METHOD_INVALID_ARG;
+    }
+    else
+    {
+        result = IoTHubDeviceMethod_InvokeOnDevicesAsync(serviceClientDeviceMethodHandle, &deviceId, 1, methodName, methodPayload, timeout, 1, invokeCallback, context);
+    }
+
+    return result;
+}
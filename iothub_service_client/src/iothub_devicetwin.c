@@ -11,7 +11,6 @@
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
@@ -19,6 +18,7 @@
 #include "parson.h"
 #include "iothub_devicetwin.h"
 #include "iothub_sc_version.h"
+#include "iothub_sc_query.h"
 
 #define IOTHUB_TWIN_REQUEST_MODE_VALUES    \
     IOTHUB_TWIN_REQUEST_GET,               \
@@ -47,6 +47,10 @@ static const char* URL_API_VERSION = "?api-version=2017-11-08-preview";
 
 static const char* RELATIVE_PATH_FMT_TWIN = "/twins/%s%s";
 static const char* RELATIVE_PATH_FMT_TWIN_MODULE = "/twins/%s/modules/%s%s";
+static const char* RELATIVE_PATH_FMT_QUERY = "/devices/query%s";
+
+static const char QUERY_BODY_PREFIX[] = "{\"query\":\"";
+static const char QUERY_BODY_SUFFIX[] = "\"}";
 
 
 /** @brief Structure to store IoTHub authentication information
@@ -56,6 +60,7 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
 } IOTHUB_SERVICE_CLIENT_DEVICE_TWIN;
 
 static const char* generateGuid(void)
@@ -160,67 +165,17 @@ static IOTHUB_DEVICE_TWIN_RESULT sendHttpRequestTwin(IOTHUB_SERVICE_CLIENT_DEVIC
 {
     IOTHUB_DEVICE_TWIN_RESULT result;
 
-    STRING_HANDLE uriResource = NULL;
-    STRING_HANDLE accessKey = NULL;
-    STRING_HANDLE keyName = NULL;
-    HTTPAPIEX_SAS_HANDLE httpExApiSasHandle;
-    HTTPAPIEX_HANDLE httpExApiHandle;
     HTTP_HEADERS_HANDLE httpHeader;
 
-    if ((uriResource = STRING_construct(serviceClientDeviceTwinHandle->hostname)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_024: [ If any of the HTTPAPI call fails IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
-        LogError("STRING_construct failed for uriResource");
-        result = IOTHUB_DEVICE_TWIN_ERROR;
-    }
-    else if ((accessKey = STRING_construct(serviceClientDeviceTwinHandle->sharedAccessKey)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_024: [ If any of the call fails during the HTTP creation IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
-        LogError("STRING_construct failed for accessKey");
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_TWIN_ERROR;
-    }
-    else if ((keyName = STRING_construct(serviceClientDeviceTwinHandle->keyName)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_024: [ If any of the call fails during the HTTP creation IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
-        LogError("STRING_construct failed for keyName");
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_TWIN_ERROR;
-    }
     /*Codes_SRS_IOTHUBDEVICETWIN_12_020: [ IoTHubDeviceTwin_GetTwin shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-    else if ((httpHeader = createHttpHeader(iotHubTwinRequestMode)) == NULL)
+    if ((httpHeader = createHttpHeader(iotHubTwinRequestMode)) == NULL)
     {
         /*Codes_SRS_IOTHUBDEVICETWIN_12_024: [ If any of the call fails during the HTTP creation IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
         LogError("HttpHeader creation failed");
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
         result = IOTHUB_DEVICE_TWIN_ERROR;
     }
-    /*Codes_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-    else if ((httpExApiSasHandle = HTTPAPIEX_SAS_Create(accessKey, uriResource, keyName)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_025: [ If any of the HTTPAPI call fails IoTHubDeviceTwin_GetTwin shall fail and return IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR ]*/
-        LogError("HTTPAPIEX_SAS_Create failed");
-        HTTPHeaders_Free(httpHeader);
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR;
-    }
-    /*Codes_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-    else if ((httpExApiHandle = HTTPAPIEX_Create(serviceClientDeviceTwinHandle->hostname)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_025: [ If any of the HTTPAPI call fails IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
-        LogError("HTTPAPIEX_Create failed");
-        HTTPAPIEX_SAS_Destroy(httpExApiSasHandle);
-        HTTPHeaders_Free(httpHeader);
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
-        result = IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR;
-    }
+    /*Codes_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+    /*Codes_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
     else
     {
         HTTPAPI_REQUEST_TYPE httpApiRequestType = HTTPAPI_REQUEST_GET;
@@ -265,11 +220,11 @@ static IOTHUB_DEVICE_TWIN_RESULT sendHttpRequestTwin(IOTHUB_SERVICE_CLIENT_DEVIC
                 LogError("Failure creating relative path");
                 result = IOTHUB_DEVICE_TWIN_ERROR;
             }
-            /*Codes_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
-            else if (HTTPAPIEX_SAS_ExecuteRequest(httpExApiSasHandle, httpExApiHandle, httpApiRequestType, STRING_c_str(relativePath), httpHeader, deviceJsonBuffer, &statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
+            /*Codes_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
+            else if (IoTHubScConnectionPool_ExecuteRequest(serviceClientDeviceTwinHandle->connectionPool, httpApiRequestType, STRING_c_str(relativePath), httpHeader, deviceJsonBuffer, &statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
             {
                 /*Codes_SRS_IOTHUBDEVICETWIN_12_025: [ If any of the HTTPAPI call fails IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
-                LogError("HTTPAPIEX_SAS_ExecuteRequest failed");
+                LogError("IoTHubScConnectionPool_ExecuteRequest failed");
                 STRING_delete(relativePath);
                 result = IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR;
             }
@@ -289,12 +244,7 @@ static IOTHUB_DEVICE_TWIN_RESULT sendHttpRequestTwin(IOTHUB_SERVICE_CLIENT_DEVIC
                 }
             }
         }
-        HTTPAPIEX_Destroy(httpExApiHandle);
-        HTTPAPIEX_SAS_Destroy(httpExApiSasHandle);
         HTTPHeaders_Free(httpHeader);
-        STRING_delete(keyName);
-        STRING_delete(accessKey);
-        STRING_delete(uriResource);
     }
     return result;
 }
@@ -304,6 +254,7 @@ static void free_devicetwin_handle(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN* deviceTwin
     free(deviceTwin->hostname);
     free(deviceTwin->sharedAccessKey);
     free(deviceTwin->keyName);
+    IoTHubScConnectionPool_Destroy(deviceTwin->connectionPool);
     free(deviceTwin);
 }
 
@@ -385,6 +336,14 @@ IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE IoTHubDeviceTwin_Create(IOTHUB_SERVICE_
                     free_devicetwin_handle(result);
                     result = NULL;
                 }
+                /*Codes_SRS_IOTHUBDEVICETWIN_02_001: [ IoTHubDeviceTwin_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ]*/
+                else if ((result->connectionPool = IoTHubScConnectionPool_Clone(serviceClientAuth->connectionPool)) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBDEVICETWIN_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubDeviceTwin_Create shall do clean up and return NULL. ]*/
+                    LogError("IoTHubScConnectionPool_Clone failed");
+                    free_devicetwin_handle(result);
+                    result = NULL;
+                }
             }
         }
     }
@@ -397,6 +356,7 @@ void IoTHubDeviceTwin_Destroy(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE serviceCl
     if (serviceClientDeviceTwinHandle != NULL)
     {
         /*Codes_SRS_IOTHUBDEVICETWIN_12_017: [ If the serviceClientDeviceTwinHandle input parameter is not NULL IoTHubDeviceTwin_Destroy shall free the memory of it and return ]*/
+        /*Codes_SRS_IOTHUBDEVICETWIN_02_003: [ IoTHubDeviceTwin_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ]*/
         free_devicetwin_handle((IOTHUB_SERVICE_CLIENT_DEVICE_TWIN*)serviceClientDeviceTwinHandle);
     }
 }
@@ -450,9 +410,9 @@ char* IoTHubDeviceTwin_GetDeviceOrModuleTwin(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_H
         }
         /*Codes_SRS_IOTHUBDEVICETWIN_12_019: [ IoTHubDeviceTwin_GetTwin shall create HTTP GET request URL using the given deviceId using the following format: url/twins/[deviceId] ]*/
         /*Codes_SRS_IOTHUBDEVICETWIN_12_020: [ IoTHubDeviceTwin_GetTwin shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-        /*Codes_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+        /*Codes_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+        /*Codes_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+        /*Codes_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
         else if (sendHttpRequestTwin(serviceClientDeviceTwinHandle, IOTHUB_TWIN_REQUEST_GET, deviceId, moduleId, NULL, responseBuffer) != IOTHUB_DEVICE_TWIN_OK)
         {
             /*Codes_SRS_IOTHUBDEVICETWIN_12_024: [ If any of the call fails during the HTTP creation IoTHubDeviceTwin_GetTwin shall fail and return NULL ]*/
@@ -530,9 +490,9 @@ char* IoTHubDeviceTwin_UpdateDeviceOrModuleTwin(IOTHUB_SERVICE_CLIENT_DEVICE_TWI
         }
         /*CodesSRS_IOTHUBDEVICETWIN_12_039: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTP PATCH request using deviceTwinJson ]*/
         /*CodesSRS_IOTHUBDEVICETWIN_12_040: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTP PATCH request using the createdfollowing HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-        /*CodesSRS_IOTHUBDEVICETWIN_12_041: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-        /*CodesSRS_IOTHUBDEVICETWIN_12_042: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-        /*CodesSRS_IOTHUBDEVICETWIN_12_043: [ IoTHubDeviceTwin_UpdateTwin shall execute the HTTP PATCH request by calling HTTPAPIEX_ExecuteRequest ]*/
+        /*CodesSRS_IOTHUBDEVICETWIN_12_041: [ IoTHubDeviceTwin_UpdateTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+        /*CodesSRS_IOTHUBDEVICETWIN_12_042: [ IoTHubDeviceTwin_UpdateTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+        /*CodesSRS_IOTHUBDEVICETWIN_12_043: [ IoTHubDeviceTwin_UpdateTwin shall execute the HTTP PATCH request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
         else if (sendHttpRequestTwin(serviceClientDeviceTwinHandle, IOTHUB_TWIN_REQUEST_UPDATE, deviceId, moduleId, updateJson, responseBuffer) != IOTHUB_DEVICE_TWIN_OK)
         {
             /*CodesSRS_IOTHUBDEVICETWIN_12_044: [ If any of the call fails during the HTTP creation IoTHubDeviceTwin_UpdateTwin shall fail and return NULL ]*/
@@ -583,3 +543,132 @@ char* IoTHubDeviceTwin_UpdateModuleTwin(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE
 
 
 
+
+/*builds {"query":"<query>"} with the query escaped as a JSON string*/
+static BUFFER_HANDLE createQueryBody(const char* query)
+{
+    BUFFER_HANDLE result;
+    size_t bodyLength = (sizeof(QUERY_BODY_PREFIX) - 1) + (sizeof(QUERY_BODY_SUFFIX) - 1);
+    const char* source;
+    char* body;
+
+    for (source = query; *source != '\0'; source++)
+    {
+        if ((*source == '"') || (*source == '\\'))
+        {
+            bodyLength += 2;
+        }
+        else if ((unsigned char)*source < 0x20)
+        {
+            bodyLength += 6;
+        }
+        else
+        {
+            bodyLength++;
+        }
+    }
+
+    if ((body = malloc(bodyLength + 1)) == NULL)
+    {
+        LogError("malloc failed for query body");
+        result = NULL;
+    }
+    else
+    {
+        char* destination = body;
+
+        (void)memcpy(destination, QUERY_BODY_PREFIX, sizeof(QUERY_BODY_PREFIX) - 1);
+        destination += sizeof(QUERY_BODY_PREFIX) - 1;
+        for (source = query; *source != '\0'; source++)
+        {
+            if ((*source == '"') || (*source == '\\'))
+            {
+                *destination++ = '\\';
+                *destination++ = *source;
+            }
+            else if ((unsigned char)*source < 0x20)
+            {
+                (void)sprintf(destination, "\\u%04x", (unsigned int)(unsigned char)*source);
+                destination += 6;
+            }
+            else
+            {
+                *destination++ = *source;
+            }
+        }
+        (void)memcpy(destination, QUERY_BODY_SUFFIX, sizeof(QUERY_BODY_SUFFIX) - 1);
+
+        if ((result = BUFFER_create((const unsigned char*)body, bodyLength)) == NULL)
+        {
+            LogError("BUFFER_create failed for query body");
+        }
+        free(body);
+    }
+
+    return result;
+}
+
+static HTTP_HEADERS_HANDLE createQueryHttpHeader(void)
+{
+    return createHttpHeader(IOTHUB_TWIN_REQUEST_GET);
+}
+
+IOTHUB_DEVICE_TWIN_RESULT IoTHubDeviceTwin_Query(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE serviceClientDeviceTwinHandle, const char* query, size_t pageSize, IOTHUB_DEVICE_TWIN_QUERY_CALLBACK resultCallback, void* context)
+{
+    IOTHUB_DEVICE_TWIN_RESULT result;
+
+    /*Codes_SRS_IOTHUBDEVICETWIN_02_004: [ If serviceClientDeviceTwinHandle, query or resultCallback is NULL, or pageSize is not between 1 and IOTHUB_DEVICE_TWIN_QUERY_MAX_PAGE_SIZE, IoTHubDeviceTwin_Query shall fail and return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+    if ((serviceClientDeviceTwinHandle == NULL) || (query == NULL) || (resultCallback == NULL) || (pageSize == 0) || (pageSize > IOTHUB_DEVICE_TWIN_QUERY_MAX_PAGE_SIZE))
+    {
+        LogError("Invalid argument serviceClientDeviceTwinHandle=%p query=%p resultCallback=%p pageSize=%lu", serviceClientDeviceTwinHandle, query, resultCallback, (unsigned long)pageSize);
+        result = IOTHUB_DEVICE_TWIN_INVALID_ARG;
+    }
+    else
+    {
+        BUFFER_HANDLE queryBuffer;
+        char relativePath[64];
+
+        /*Codes_SRS_IOTHUBDEVICETWIN_02_005: [ IoTHubDeviceTwin_Query shall create the body {"query":"<query>"}, with the query escaped as a JSON string, and a single response buffer that is reused for every page. ]*/
+        if ((queryBuffer = createQueryBody(query)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBDEVICETWIN_02_012: [ If any other call fails IoTHubDeviceTwin_Query shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+            result = IOTHUB_DEVICE_TWIN_ERROR;
+        }
+        else
+        {
+            if (snprintf(relativePath, sizeof(relativePath), RELATIVE_PATH_FMT_QUERY, URL_API_VERSION) <= 0)
+            {
+                /*Codes_SRS_IOTHUBDEVICETWIN_02_012: [ If any other call fails IoTHubDeviceTwin_Query shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+                LogError("Failure creating relative path");
+                result = IOTHUB_DEVICE_TWIN_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBDEVICETWIN_02_006: [ For every page IoTHubDeviceTwin_Query shall POST the query to url/devices/query?api-version by calling IoTHubScConnectionPool_ExecuteRequest, with the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. ]*/
+                /*Codes_SRS_IOTHUBDEVICETWIN_02_008: [ IoTHubDeviceTwin_Query shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+                /*Codes_SRS_IOTHUBDEVICETWIN_02_009: [ IoTHubDeviceTwin_Query shall call resultCallback with the JSON text of every object of the page as soon as it is found, the text is only valid during the call. ]*/
+                /*Codes_SRS_IOTHUBDEVICETWIN_02_011: [ If resultCallback returns a non-zero value IoTHubDeviceTwin_Query shall stop without requesting further pages and return IOTHUB_DEVICE_TWIN_OK. ]*/
+                switch (IoTHubScQuery_Execute(serviceClientDeviceTwinHandle->connectionPool, HTTPAPI_REQUEST_POST, relativePath, createQueryHttpHeader, queryBuffer, pageSize, resultCallback, context))
+                {
+                case IOTHUB_SC_QUERY_OK:
+                    result = IOTHUB_DEVICE_TWIN_OK;
+                    break;
+                case IOTHUB_SC_QUERY_HTTPAPI_ERROR:
+                    /*Codes_SRS_IOTHUBDEVICETWIN_02_007: [ If the request fails IoTHubDeviceTwin_Query shall return IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+                    LogError("IoTHubScQuery_Execute failed to execute a request");
+                    result = IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR;
+                    break;
+                default:
+                    /*Codes_SRS_IOTHUBDEVICETWIN_02_007: [ If the request fails IoTHubDeviceTwin_Query shall return IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+                    /*Codes_SRS_IOTHUBDEVICETWIN_02_010: [ If a page is not a JSON array of objects IoTHubDeviceTwin_Query shall stop and return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+                    LogError("IoTHubScQuery_Execute failed");
+                    result = IOTHUB_DEVICE_TWIN_ERROR;
+                    break;
+                }
+            }
+            BUFFER_delete(queryBuffer);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,831 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <time.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "azure_c_shared_utility/uniqueid.h"
+#include "azure_c_shared_utility/agenttime.h"
+
+#include "parson.h"
+#include "iothub_jobclient.h"
+#include "iothub_sc_connection_pool.h"
+#include "iothub_sc_version.h"
+#include "iothub_sc_query.h"
+
+DEFINE_ENUM_STRINGS(IOTHUB_JOB_CLIENT_RESULT, IOTHUB_JOB_CLIENT_RESULT_VALUES);
+DEFINE_ENUM_STRINGS(IOTHUB_JOB_TYPE, IOTHUB_JOB_TYPE_VALUES);
+DEFINE_ENUM_STRINGS(IOTHUB_JOB_STATUS, IOTHUB_JOB_STATUS_VALUES);
+
+#define  HTTP_HEADER_KEY_AUTHORIZATION  "Authorization"
+#define  HTTP_HEADER_VAL_AUTHORIZATION  " "
+#define  HTTP_HEADER_KEY_REQUEST_ID  "Request-Id"
+#define  HTTP_HEADER_KEY_USER_AGENT  "User-Agent"
+#define  HTTP_HEADER_VAL_USER_AGENT  IOTHUB_SERVICE_CLIENT_TYPE_PREFIX IOTHUB_SERVICE_CLIENT_BACKSLASH IOTHUB_SERVICE_CLIENT_VERSION
+#define  HTTP_HEADER_KEY_ACCEPT  "Accept"
+#define  HTTP_HEADER_VAL_ACCEPT  "application/json"
+#define  HTTP_HEADER_KEY_CONTENT_TYPE  "Content-Type"
+#define  HTTP_HEADER_VAL_CONTENT_TYPE  "application/json; charset=utf-8"
+#define UID_LENGTH 37
+#define JOB_TIME_LENGTH 21
+#define INDEFINITE_TIME ((time_t)(-1))
+
+static const char* const URL_API_VERSION = "?api-version=2017-11-08-preview";
+static const char* const RELATIVE_PATH_FMT_JOB = "/jobs/v2/%s%s";
+static const char* const RELATIVE_PATH_FMT_JOB_CANCEL = "/jobs/v2/%s/cancel%s";
+static const char* const RELATIVE_PATH_FMT_JOB_QUERY = "/jobs/v2/query%s%s%s%s%s";
+static const char* const QUERY_PARAMETER_JOB_TYPE = "&jobType=";
+static const char* const QUERY_PARAMETER_JOB_STATUS = "&jobStatus=";
+
+static const char* const JOB_JSON_KEY_JOB_ID = "jobId";
+static const char* const JOB_JSON_KEY_TYPE = "type";
+static const char* const JOB_JSON_KEY_STATUS = "status";
+static const char* const JOB_JSON_KEY_QUERY_CONDITION = "queryCondition";
+static const char* const JOB_JSON_KEY_CREATED_TIME = "createdTime";
+static const char* const JOB_JSON_KEY_START_TIME = "startTime";
+static const char* const JOB_JSON_KEY_END_TIME = "endTime";
+static const char* const JOB_JSON_KEY_FAILURE_REASON = "failureReason";
+static const char* const JOB_JSON_KEY_STATUS_MESSAGE = "statusMessage";
+static const char* const JOB_JSON_KEY_MAX_EXECUTION_TIME = "maxExecutionTimeInSeconds";
+static const char* const JOB_JSON_KEY_UPDATE_TWIN = "updateTwin";
+static const char* const JOB_JSON_KEY_METHOD_NAME = "cloudToDeviceMethod.methodName";
+static const char* const JOB_JSON_KEY_METHOD_PAYLOAD = "cloudToDeviceMethod.payload";
+static const char* const JOB_JSON_KEY_METHOD_RESPONSE_TIMEOUT = "cloudToDeviceMethod.responseTimeoutInSeconds";
+static const char* const JOB_JSON_KEY_DEVICE_COUNT = "deviceJobStatistics.deviceCount";
+static const char* const JOB_JSON_KEY_FAILED_COUNT = "deviceJobStatistics.failedCount";
+static const char* const JOB_JSON_KEY_SUCCEEDED_COUNT = "deviceJobStatistics.succeededCount";
+static const char* const JOB_JSON_KEY_RUNNING_COUNT = "deviceJobStatistics.runningCount";
+static const char* const JOB_JSON_KEY_PENDING_COUNT = "deviceJobStatistics.pendingCount";
+
+/*service names of IOTHUB_JOB_TYPE, in the order of IOTHUB_JOB_TYPE_VALUES*/
+static const char* const JOB_TYPE_NAMES[] = { "unknown", "scheduleUpdateTwin", "scheduleDeviceMethod" };
+/*service names of IOTHUB_JOB_STATUS, in the order of IOTHUB_JOB_STATUS_VALUES*/
+static const char* const JOB_STATUS_NAMES[] = { "unknown", "enqueued", "queued", "scheduled", "running", "completed", "failed", "cancelled" };
+
+/** @brief Structure to store IoTHub authentication information
+*/
+typedef struct IOTHUB_SERVICE_CLIENT_JOB_CLIENT_TAG
+{
+    char* hostname;
+    char* sharedAccessKey;
+    char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
+} IOTHUB_SERVICE_CLIENT_JOB_CLIENT;
+
+static const char* generateGuid(void)
+{
+    char* result;
+
+    if ((result = malloc(UID_LENGTH)) != NULL)
+    {
+        result[0] = '\0';
+        if (UniqueId_Generate(result, UID_LENGTH) != UNIQUEID_OK)
+        {
+            free((void*)result);
+            result = NULL;
+        }
+    }
+    return (const char*)result;
+}
+
+static HTTP_HEADERS_HANDLE createHttpHeader(void)
+{
+    HTTP_HEADERS_HANDLE httpHeader;
+    const char* guid = NULL;
+
+    if ((httpHeader = HTTPHeaders_Alloc()) == NULL)
+    {
+        LogError("HTTPHeaders_Alloc failed");
+    }
+    else if (HTTPHeaders_AddHeaderNameValuePair(httpHeader, HTTP_HEADER_KEY_AUTHORIZATION, HTTP_HEADER_VAL_AUTHORIZATION) != HTTP_HEADERS_OK)
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for Authorization header");
+        HTTPHeaders_Free(httpHeader);
+        httpHeader = NULL;
+    }
+    else if ((guid = generateGuid()) == NULL)
+    {
+        LogError("GUID creation failed");
+        HTTPHeaders_Free(httpHeader);
+        httpHeader = NULL;
+    }
+    else if (HTTPHeaders_AddHeaderNameValuePair(httpHeader, HTTP_HEADER_KEY_REQUEST_ID, guid) != HTTP_HEADERS_OK)
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for RequestId header");
+        HTTPHeaders_Free(httpHeader);
+        httpHeader = NULL;
+    }
+    else if (HTTPHeaders_AddHeaderNameValuePair(httpHeader, HTTP_HEADER_KEY_USER_AGENT, HTTP_HEADER_VAL_USER_AGENT) != HTTP_HEADERS_OK)
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for User-Agent header");
+        HTTPHeaders_Free(httpHeader);
+        httpHeader = NULL;
+    }
+    else if (HTTPHeaders_AddHeaderNameValuePair(httpHeader, HTTP_HEADER_KEY_ACCEPT, HTTP_HEADER_VAL_ACCEPT) != HTTP_HEADERS_OK)
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for Accept header");
+        HTTPHeaders_Free(httpHeader);
+        httpHeader = NULL;
+    }
+    else if (HTTPHeaders_AddHeaderNameValuePair(httpHeader, HTTP_HEADER_KEY_CONTENT_TYPE, HTTP_HEADER_VAL_CONTENT_TYPE) != HTTP_HEADERS_OK)
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for Content-Type header");
+        HTTPHeaders_Free(httpHeader);
+        httpHeader = NULL;
+    }
+    free((void*)guid);
+
+    return httpHeader;
+}
+
+/*executes one request on the connection pool*/
+static IOTHUB_JOB_CLIENT_RESULT sendHttpRequestJob(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, HTTPAPI_REQUEST_TYPE requestType, STRING_HANDLE relativePath, BUFFER_HANDLE requestBody, BUFFER_HANDLE responseBuffer)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+    HTTP_HEADERS_HANDLE requestHeaders;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_008: [ Every request shall carry the headers Authorization, Request-Id, User-Agent, Accept=application/json and Content-Type=application/json; charset=utf-8 and shall be executed by calling IoTHubScConnectionPool_ExecuteRequest on the connection pool of the handle. ]*/
+    if ((requestHeaders = createHttpHeader()) == NULL)
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_011: [ If any other call fails the function shall return IOTHUB_JOB_CLIENT_ERROR. ]*/
+        LogError("HttpHeader creation failed");
+        result = IOTHUB_JOB_CLIENT_ERROR;
+    }
+    else
+    {
+        unsigned int statusCode = 0;
+
+        if (IoTHubScConnectionPool_ExecuteRequest(serviceClientJobClientHandle->connectionPool, requestType, STRING_c_str(relativePath), requestHeaders, requestBody, &statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_009: [ If the request fails the function shall return IOTHUB_JOB_CLIENT_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR. ]*/
+            LogError("IoTHubScConnectionPool_ExecuteRequest failed");
+            result = IOTHUB_JOB_CLIENT_HTTPAPI_ERROR;
+        }
+        else if (statusCode >= 300)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_009: [ If the request fails the function shall return IOTHUB_JOB_CLIENT_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR. ]*/
+            LogError("Http Failure status code %u.", statusCode);
+            result = IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_JOB_CLIENT_OK;
+        }
+        HTTPHeaders_Free(requestHeaders);
+    }
+
+    return result;
+}
+
+static IOTHUB_JOB_TYPE getJobTypeFromString(const char* typeName)
+{
+    IOTHUB_JOB_TYPE result = IOTHUB_JOB_TYPE_UNKNOWN;
+    size_t i;
+
+    for (i = 0; (typeName != NULL) && (i < sizeof(JOB_TYPE_NAMES) / sizeof(JOB_TYPE_NAMES[0])); i++)
+    {
+        if (strcmp(typeName, JOB_TYPE_NAMES[i]) == 0)
+        {
+            result = (IOTHUB_JOB_TYPE)i;
+            break;
+        }
+    }
+    return result;
+}
+
+static IOTHUB_JOB_STATUS getJobStatusFromString(const char* statusName)
+{
+    IOTHUB_JOB_STATUS result = IOTHUB_JOB_STATUS_UNKNOWN;
+    size_t i;
+
+    for (i = 0; (statusName != NULL) && (i < sizeof(JOB_STATUS_NAMES) / sizeof(JOB_STATUS_NAMES[0])); i++)
+    {
+        if (strcmp(statusName, JOB_STATUS_NAMES[i]) == 0)
+        {
+            result = (IOTHUB_JOB_STATUS)i;
+            break;
+        }
+    }
+    return result;
+}
+
+static int copyJsonString(const JSON_Object* jsonObject, const char* name, const char** destination)
+{
+    int result;
+    const char* value = json_object_get_string(jsonObject, name);
+
+    if (value == NULL)
+    {
+        *destination = NULL;
+        result = 0;
+    }
+    else if (mallocAndStrcpy_s((char**)destination, value) != 0)
+    {
+        LogError("mallocAndStrcpy_s failed for %s", name);
+        *destination = NULL;
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static IOTHUB_JOB_CLIENT_RESULT parseJobJsonObject(const JSON_Object* jobObject, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+
+    memset(job, 0, sizeof(*job));
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_010: [ The job returned by the service shall be copied to the job structure, the job type and status shall be mapped to IOTHUB_JOB_TYPE and IOTHUB_JOB_STATUS, unknown values mapping to IOTHUB_JOB_TYPE_UNKNOWN and IOTHUB_JOB_STATUS_UNKNOWN. ]*/
+    if ((copyJsonString(jobObject, JOB_JSON_KEY_JOB_ID, &job->jobId) != 0) ||
+        (copyJsonString(jobObject, JOB_JSON_KEY_QUERY_CONDITION, &job->queryCondition) != 0) ||
+        (copyJsonString(jobObject, JOB_JSON_KEY_CREATED_TIME, &job->createdTime) != 0) ||
+        (copyJsonString(jobObject, JOB_JSON_KEY_START_TIME, &job->startTime) != 0) ||
+        (copyJsonString(jobObject, JOB_JSON_KEY_END_TIME, &job->endTime) != 0) ||
+        (copyJsonString(jobObject, JOB_JSON_KEY_FAILURE_REASON, &job->failureReason) != 0) ||
+        (copyJsonString(jobObject, JOB_JSON_KEY_STATUS_MESSAGE, &job->statusMessage) != 0))
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_011: [ If any other call fails the function shall return IOTHUB_JOB_CLIENT_ERROR. ]*/
+        IoTHubJobClient_FreeJobMembers(job);
+        result = IOTHUB_JOB_CLIENT_ERROR;
+    }
+    else
+    {
+        job->type = getJobTypeFromString(json_object_get_string(jobObject, JOB_JSON_KEY_TYPE));
+        job->status = getJobStatusFromString(json_object_get_string(jobObject, JOB_JSON_KEY_STATUS));
+        job->deviceJobStatistics.deviceCount = (size_t)json_object_dotget_number(jobObject, JOB_JSON_KEY_DEVICE_COUNT);
+        job->deviceJobStatistics.failedCount = (size_t)json_object_dotget_number(jobObject, JOB_JSON_KEY_FAILED_COUNT);
+        job->deviceJobStatistics.succeededCount = (size_t)json_object_dotget_number(jobObject, JOB_JSON_KEY_SUCCEEDED_COUNT);
+        job->deviceJobStatistics.runningCount = (size_t)json_object_dotget_number(jobObject, JOB_JSON_KEY_RUNNING_COUNT);
+        job->deviceJobStatistics.pendingCount = (size_t)json_object_dotget_number(jobObject, JOB_JSON_KEY_PENDING_COUNT);
+        result = IOTHUB_JOB_CLIENT_OK;
+    }
+
+    return result;
+}
+
+/*parses the response body, which is not NUL terminated in the BUFFER*/
+static JSON_Value* parseResponseBuffer(BUFFER_HANDLE responseBuffer)
+{
+    JSON_Value* result;
+    size_t length = BUFFER_length(responseBuffer);
+    char* json;
+
+    if ((json = malloc(length + 1)) == NULL)
+    {
+        LogError("malloc failed for response");
+        result = NULL;
+    }
+    else
+    {
+        if (length != 0)
+        {
+            (void)memcpy(json, BUFFER_u_char(responseBuffer), length);
+        }
+        json[length] = '\0';
+
+        if ((result = json_parse_string(json)) == NULL)
+        {
+            LogError("json_parse_string failed");
+        }
+        free(json);
+    }
+
+    return result;
+}
+
+static IOTHUB_JOB_CLIENT_RESULT parseJobResponse(BUFFER_HANDLE responseBuffer, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+    JSON_Value* root_value;
+    JSON_Object* root_object;
+
+    if ((root_value = parseResponseBuffer(responseBuffer)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_012: [ If the response is not a JSON job the function shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+        result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+    }
+    else
+    {
+        if ((root_object = json_value_get_object(root_value)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_012: [ If the response is not a JSON job the function shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+            LogError("json_value_get_object failed");
+            result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+        }
+        else
+        {
+            result = parseJobJsonObject(root_object, job);
+        }
+        json_value_free(root_value);
+    }
+
+    return result;
+}
+
+/*formats startTime as ISO 8601 UTC, 0 meaning now*/
+static int formatJobStartTime(time_t startTime, char* destination, size_t destinationSize)
+{
+    int result;
+    time_t jobTime = (startTime == 0) ? get_time(NULL) : startTime;
+    struct tm* utcTime;
+
+    if (jobTime == INDEFINITE_TIME)
+    {
+        LogError("get_time failed");
+        result = __FAILURE__;
+    }
+    else if (((utcTime = get_gmtime(&jobTime)) == NULL) ||
+        (strftime(destination, destinationSize, "%Y-%m-%dT%H:%M:%SZ", utcTime) == 0))
+    {
+        LogError("Failed formatting the job start time");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*creates the common members of a job request, the caller adds the twin patch or the method*/
+static JSON_Value* createJobRequestJson(const IOTHUB_JOB_SCHEDULE* schedule, IOTHUB_JOB_TYPE jobType)
+{
+    JSON_Value* result;
+    JSON_Object* root_object;
+    char startTime[JOB_TIME_LENGTH];
+
+    if (formatJobStartTime(schedule->startTime, startTime, sizeof(startTime)) != 0)
+    {
+        result = NULL;
+    }
+    else if ((result = json_value_init_object()) == NULL)
+    {
+        LogError("json_value_init_object failed");
+    }
+    else if (((root_object = json_value_get_object(result)) == NULL) ||
+        (json_object_set_string(root_object, JOB_JSON_KEY_JOB_ID, schedule->jobId) != JSONSuccess) ||
+        (json_object_set_string(root_object, JOB_JSON_KEY_TYPE, JOB_TYPE_NAMES[jobType]) != JSONSuccess) ||
+        (json_object_set_string(root_object, JOB_JSON_KEY_QUERY_CONDITION, schedule->queryCondition) != JSONSuccess) ||
+        (json_object_set_string(root_object, JOB_JSON_KEY_START_TIME, startTime) != JSONSuccess) ||
+        ((schedule->maxExecutionTimeInSeconds != 0) && (json_object_set_number(root_object, JOB_JSON_KEY_MAX_EXECUTION_TIME, schedule->maxExecutionTimeInSeconds) != JSONSuccess)))
+    {
+        LogError("Failed building the job request");
+        json_value_free(result);
+        result = NULL;
+    }
+
+    return result;
+}
+
+static IOTHUB_JOB_CLIENT_RESULT sendScheduleJobRequest(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, const char* jobId, JSON_Value* requestJson, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+    char* requestString;
+    BUFFER_HANDLE requestBuffer;
+    BUFFER_HANDLE responseBuffer;
+    STRING_HANDLE relativePath;
+
+    if ((requestString = json_serialize_to_string(requestJson)) == NULL)
+    {
+        LogError("json_serialize_to_string failed");
+        result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+    }
+    else
+    {
+        if ((requestBuffer = BUFFER_create((const unsigned char*)requestString, strlen(requestString))) == NULL)
+        {
+            LogError("BUFFER_create failed for the request");
+            result = IOTHUB_JOB_CLIENT_ERROR;
+        }
+        else
+        {
+            if ((responseBuffer = BUFFER_new()) == NULL)
+            {
+                LogError("BUFFER_new failed for the response");
+                result = IOTHUB_JOB_CLIENT_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_007: [ The job shall be created by a PUT of the request to url/jobs/v2/[jobId]. ]*/
+                if ((relativePath = STRING_construct_sprintf(RELATIVE_PATH_FMT_JOB, jobId, URL_API_VERSION)) == NULL)
+                {
+                    LogError("Failure creating relative path");
+                    result = IOTHUB_JOB_CLIENT_ERROR;
+                }
+                else
+                {
+                    if (((result = sendHttpRequestJob(serviceClientJobClientHandle, HTTPAPI_REQUEST_PUT, relativePath, requestBuffer, responseBuffer)) == IOTHUB_JOB_CLIENT_OK) &&
+                        (job != NULL))
+                    {
+                        result = parseJobResponse(responseBuffer, job);
+                    }
+                    STRING_delete(relativePath);
+                }
+                BUFFER_delete(responseBuffer);
+            }
+            BUFFER_delete(requestBuffer);
+        }
+        json_free_serialized_string(requestString);
+    }
+
+    return result;
+}
+
+static void free_jobclient_handle(IOTHUB_SERVICE_CLIENT_JOB_CLIENT* jobClient)
+{
+    free(jobClient->hostname);
+    free(jobClient->sharedAccessKey);
+    free(jobClient->keyName);
+    IoTHubScConnectionPool_Destroy(jobClient->connectionPool);
+    free(jobClient);
+}
+
+IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE IoTHubJobClient_Create(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE serviceClientHandle)
+{
+    IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE result;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_001: [ If serviceClientHandle or any of its hostname, keyName and sharedAccessKey members is NULL IoTHubJobClient_Create shall return NULL. ]*/
+    if (serviceClientHandle == NULL)
+    {
+        LogError("serviceClientHandle input parameter cannot be NULL");
+        result = NULL;
+    }
+    else
+    {
+        IOTHUB_SERVICE_CLIENT_AUTH* serviceClientAuth = (IOTHUB_SERVICE_CLIENT_AUTH*)serviceClientHandle;
+
+        if (serviceClientAuth->hostname == NULL)
+        {
+            LogError("authInfo->hostName input parameter cannot be NULL");
+            result = NULL;
+        }
+        else if (serviceClientAuth->keyName == NULL)
+        {
+            LogError("authInfo->keyName input parameter cannot be NULL");
+            result = NULL;
+        }
+        else if (serviceClientAuth->sharedAccessKey == NULL)
+        {
+            LogError("authInfo->sharedAccessKey input parameter cannot be NULL");
+            result = NULL;
+        }
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_002: [ IoTHubJobClient_Create shall allocate a new handle, copy hostname, sharedAccessKey and keyName and take a reference to the connection pool of serviceClientHandle by calling IoTHubScConnectionPool_Clone. ]*/
+        else if ((result = malloc(sizeof(IOTHUB_SERVICE_CLIENT_JOB_CLIENT))) == NULL)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_003: [ If any of these calls fails IoTHubJobClient_Create shall do clean up and return NULL. ]*/
+            LogError("Malloc failed for IOTHUB_SERVICE_CLIENT_JOB_CLIENT");
+        }
+        else
+        {
+            memset(result, 0, sizeof(*result));
+
+            if (mallocAndStrcpy_s(&result->hostname, serviceClientAuth->hostname) != 0)
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_003: [ If any of these calls fails IoTHubJobClient_Create shall do clean up and return NULL. ]*/
+                LogError("mallocAndStrcpy_s failed for hostName");
+                free_jobclient_handle(result);
+                result = NULL;
+            }
+            else if (mallocAndStrcpy_s(&result->sharedAccessKey, serviceClientAuth->sharedAccessKey) != 0)
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_003: [ If any of these calls fails IoTHubJobClient_Create shall do clean up and return NULL. ]*/
+                LogError("mallocAndStrcpy_s failed for sharedAccessKey");
+                free_jobclient_handle(result);
+                result = NULL;
+            }
+            else if (mallocAndStrcpy_s(&result->keyName, serviceClientAuth->keyName) != 0)
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_003: [ If any of these calls fails IoTHubJobClient_Create shall do clean up and return NULL. ]*/
+                LogError("mallocAndStrcpy_s failed for keyName");
+                free_jobclient_handle(result);
+                result = NULL;
+            }
+            else if ((result->connectionPool = IoTHubScConnectionPool_Clone(serviceClientAuth->connectionPool)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_003: [ If any of these calls fails IoTHubJobClient_Create shall do clean up and return NULL. ]*/
+                LogError("IoTHubScConnectionPool_Clone failed");
+                free_jobclient_handle(result);
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
+void IoTHubJobClient_Destroy(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle)
+{
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_004: [ If serviceClientJobClientHandle is NULL IoTHubJobClient_Destroy shall return. ]*/
+    if (serviceClientJobClientHandle != NULL)
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_005: [ Otherwise IoTHubJobClient_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy and free the handle. ]*/
+        free_jobclient_handle((IOTHUB_SERVICE_CLIENT_JOB_CLIENT*)serviceClientJobClientHandle);
+    }
+}
+
+IOTHUB_JOB_CLIENT_RESULT IoTHubJobClient_ScheduleTwinUpdate(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, const IOTHUB_JOB_SCHEDULE* schedule, const char* twinPatchJson, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_013: [ If serviceClientJobClientHandle, schedule, schedule->jobId, schedule->queryCondition or twinPatchJson is NULL IoTHubJobClient_ScheduleTwinUpdate shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+    if ((serviceClientJobClientHandle == NULL) || (schedule == NULL) || (schedule->jobId == NULL) || (schedule->queryCondition == NULL) || (twinPatchJson == NULL))
+    {
+        LogError("Invalid argument serviceClientJobClientHandle=%p schedule=%p twinPatchJson=%p", serviceClientJobClientHandle, schedule, twinPatchJson);
+        result = IOTHUB_JOB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        JSON_Value* requestJson;
+        JSON_Value* twinPatch;
+
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_006: [ The job request shall be a JSON object with jobId, type, queryCondition, startTime as ISO 8601 UTC (the current time when schedule->startTime is 0) and, when not 0, maxExecutionTimeInSeconds. ]*/
+        if ((requestJson = createJobRequestJson(schedule, IOTHUB_JOB_TYPE_SCHEDULE_UPDATE_TWIN)) == NULL)
+        {
+            result = IOTHUB_JOB_CLIENT_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_014: [ IoTHubJobClient_ScheduleTwinUpdate shall add twinPatchJson to the request as updateTwin, if twinPatchJson is not valid JSON it shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+            if ((twinPatch = json_parse_string(twinPatchJson)) == NULL)
+            {
+                LogError("twinPatchJson is not valid JSON");
+                result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+            }
+            else if (json_object_set_value(json_value_get_object(requestJson), JOB_JSON_KEY_UPDATE_TWIN, twinPatch) != JSONSuccess)
+            {
+                LogError("json_object_set_value failed for updateTwin");
+                json_value_free(twinPatch);
+                result = IOTHUB_JOB_CLIENT_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_007: [ The job shall be created by a PUT of the request to url/jobs/v2/[jobId]. ]*/
+                result = sendScheduleJobRequest(serviceClientJobClientHandle, schedule->jobId, requestJson, job);
+            }
+            json_value_free(requestJson);
+        }
+    }
+    return result;
+}
+
+IOTHUB_JOB_CLIENT_RESULT IoTHubJobClient_ScheduleDeviceMethod(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, const IOTHUB_JOB_SCHEDULE* schedule, const char* methodName, const char* methodPayload, unsigned int responseTimeoutInSeconds, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_015: [ If serviceClientJobClientHandle, schedule, schedule->jobId, schedule->queryCondition, methodName or methodPayload is NULL IoTHubJobClient_ScheduleDeviceMethod shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+    if ((serviceClientJobClientHandle == NULL) || (schedule == NULL) || (schedule->jobId == NULL) || (schedule->queryCondition == NULL) || (methodName == NULL) || (methodPayload == NULL))
+    {
+        LogError("Invalid argument serviceClientJobClientHandle=%p schedule=%p methodName=%p methodPayload=%p", serviceClientJobClientHandle, schedule, methodName, methodPayload);
+        result = IOTHUB_JOB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        JSON_Value* requestJson;
+        JSON_Value* payload;
+
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_006: [ The job request shall be a JSON object with jobId, type, queryCondition, startTime as ISO 8601 UTC (the current time when schedule->startTime is 0) and, when not 0, maxExecutionTimeInSeconds. ]*/
+        if ((requestJson = createJobRequestJson(schedule, IOTHUB_JOB_TYPE_SCHEDULE_DEVICE_METHOD)) == NULL)
+        {
+            result = IOTHUB_JOB_CLIENT_ERROR;
+        }
+        else
+        {
+            JSON_Object* root_object = json_value_get_object(requestJson);
+
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_016: [ IoTHubJobClient_ScheduleDeviceMethod shall add cloudToDeviceMethod with methodName, methodPayload as payload and, when not 0, responseTimeoutInSeconds to the request, if methodPayload is not valid JSON it shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+            if ((payload = json_parse_string(methodPayload)) == NULL)
+            {
+                LogError("methodPayload is not valid JSON");
+                result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+            }
+            else if (json_object_dotset_value(root_object, JOB_JSON_KEY_METHOD_PAYLOAD, payload) != JSONSuccess)
+            {
+                LogError("json_object_dotset_value failed for payload");
+                json_value_free(payload);
+                result = IOTHUB_JOB_CLIENT_ERROR;
+            }
+            else if ((json_object_dotset_string(root_object, JOB_JSON_KEY_METHOD_NAME, methodName) != JSONSuccess) ||
+                ((responseTimeoutInSeconds != 0) && (json_object_dotset_number(root_object, JOB_JSON_KEY_METHOD_RESPONSE_TIMEOUT, responseTimeoutInSeconds) != JSONSuccess)))
+            {
+                LogError("Failed adding the method to the job request");
+                result = IOTHUB_JOB_CLIENT_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_007: [ The job shall be created by a PUT of the request to url/jobs/v2/[jobId]. ]*/
+                result = sendScheduleJobRequest(serviceClientJobClientHandle, schedule->jobId, requestJson, job);
+            }
+            json_value_free(requestJson);
+        }
+    }
+    return result;
+}
+
+static IOTHUB_JOB_CLIENT_RESULT getOrCancelJob(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePathFormat, const char* jobId, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+    BUFFER_HANDLE responseBuffer;
+    STRING_HANDLE relativePath;
+
+    if ((responseBuffer = BUFFER_new()) == NULL)
+    {
+        LogError("BUFFER_new failed for the response");
+        result = IOTHUB_JOB_CLIENT_ERROR;
+    }
+    else
+    {
+        if ((relativePath = STRING_construct_sprintf(relativePathFormat, jobId, URL_API_VERSION)) == NULL)
+        {
+            LogError("Failure creating relative path");
+            result = IOTHUB_JOB_CLIENT_ERROR;
+        }
+        else
+        {
+            if (((result = sendHttpRequestJob(serviceClientJobClientHandle, requestType, relativePath, NULL, responseBuffer)) == IOTHUB_JOB_CLIENT_OK) &&
+                (job != NULL))
+            {
+                result = parseJobResponse(responseBuffer, job);
+            }
+            STRING_delete(relativePath);
+        }
+        BUFFER_delete(responseBuffer);
+    }
+
+    return result;
+}
+
+IOTHUB_JOB_CLIENT_RESULT IoTHubJobClient_GetJob(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, const char* jobId, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_017: [ If serviceClientJobClientHandle, jobId or job is NULL IoTHubJobClient_GetJob shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+    if ((serviceClientJobClientHandle == NULL) || (jobId == NULL) || (job == NULL))
+    {
+        LogError("Invalid argument serviceClientJobClientHandle=%p jobId=%p job=%p", serviceClientJobClientHandle, jobId, job);
+        result = IOTHUB_JOB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_018: [ IoTHubJobClient_GetJob shall GET url/jobs/v2/[jobId] and return the job in job. ]*/
+        result = getOrCancelJob(serviceClientJobClientHandle, HTTPAPI_REQUEST_GET, RELATIVE_PATH_FMT_JOB, jobId, job);
+    }
+    return result;
+}
+
+IOTHUB_JOB_CLIENT_RESULT IoTHubJobClient_CancelJob(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, const char* jobId, IOTHUB_JOB* job)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_019: [ If serviceClientJobClientHandle or jobId is NULL IoTHubJobClient_CancelJob shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+    if ((serviceClientJobClientHandle == NULL) || (jobId == NULL))
+    {
+        LogError("Invalid argument serviceClientJobClientHandle=%p jobId=%p", serviceClientJobClientHandle, jobId);
+        result = IOTHUB_JOB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_020: [ IoTHubJobClient_CancelJob shall POST to url/jobs/v2/[jobId]/cancel and, if job is not NULL, return the cancelled job in job. ]*/
+        result = getOrCancelJob(serviceClientJobClientHandle, HTTPAPI_REQUEST_POST, RELATIVE_PATH_FMT_JOB_CANCEL, jobId, job);
+    }
+    return result;
+}
+
+typedef struct JOB_QUERY_TAG
+{
+    IOTHUB_JOB_CLIENT_QUERY_CALLBACK jobCallback;
+    void* context;
+    IOTHUB_JOB_CLIENT_RESULT result;
+} JOB_QUERY;
+
+/*called by IoTHubScQuery_Execute for every job of a page, so only one job is ever held as a JSON tree*/
+static int onJobQueryResult(void* context, const char* resultJson)
+{
+    JOB_QUERY* jobQuery = (JOB_QUERY*)context;
+    bool isStopped = false;
+    JSON_Value* root_value;
+    JSON_Object* jobObject;
+
+    if ((root_value = json_parse_string(resultJson)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_024: [ If a page is not a JSON array of jobs IoTHubJobClient_QueryJobs shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+        LogError("json_parse_string failed");
+        jobQuery->result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+    }
+    else
+    {
+        IOTHUB_JOB job;
+
+        if ((jobObject = json_value_get_object(root_value)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_024: [ If a page is not a JSON array of jobs IoTHubJobClient_QueryJobs shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+            LogError("query result is not a JSON object");
+            jobQuery->result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+        }
+        else if ((jobQuery->result = parseJobJsonObject(jobObject, &job)) == IOTHUB_JOB_CLIENT_OK)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_025: [ IoTHubJobClient_QueryJobs shall call jobCallback for every job of a page, the job is only valid during the call. ]*/
+            isStopped = (jobQuery->jobCallback(jobQuery->context, &job) != 0);
+            IoTHubJobClient_FreeJobMembers(&job);
+        }
+        json_value_free(root_value);
+    }
+
+    return ((jobQuery->result != IOTHUB_JOB_CLIENT_OK) || isStopped) ? 1 : 0;
+}
+
+IOTHUB_JOB_CLIENT_RESULT IoTHubJobClient_QueryJobs(IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE serviceClientJobClientHandle, IOTHUB_JOB_TYPE jobType, IOTHUB_JOB_STATUS jobStatus, size_t pageSize, IOTHUB_JOB_CLIENT_QUERY_CALLBACK jobCallback, void* context)
+{
+    IOTHUB_JOB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_021: [ If serviceClientJobClientHandle or jobCallback is NULL, jobType or jobStatus is out of range, or pageSize is not between 1 and IOTHUB_JOB_CLIENT_QUERY_MAX_PAGE_SIZE, IoTHubJobClient_QueryJobs shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+    if ((serviceClientJobClientHandle == NULL) || (jobCallback == NULL) || (pageSize == 0) || (pageSize > IOTHUB_JOB_CLIENT_QUERY_MAX_PAGE_SIZE) ||
+        ((size_t)jobType >= sizeof(JOB_TYPE_NAMES) / sizeof(JOB_TYPE_NAMES[0])) || ((size_t)jobStatus >= sizeof(JOB_STATUS_NAMES) / sizeof(JOB_STATUS_NAMES[0])))
+    {
+        LogError("Invalid argument serviceClientJobClientHandle=%p jobCallback=%p pageSize=%lu jobType=%d jobStatus=%d", serviceClientJobClientHandle, jobCallback, (unsigned long)pageSize, (int)jobType, (int)jobStatus);
+        result = IOTHUB_JOB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        STRING_HANDLE relativePath;
+
+        /*Codes_SRS_IOTHUBJOBCLIENT_02_022: [ IoTHubJobClient_QueryJobs shall GET url/jobs/v2/query, with jobType and jobStatus query parameters unless they are UNKNOWN, the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. All pages shall be received in the same response buffer. ]*/
+        if ((relativePath = STRING_construct_sprintf(RELATIVE_PATH_FMT_JOB_QUERY, URL_API_VERSION,
+            (jobType == IOTHUB_JOB_TYPE_UNKNOWN) ? "" : QUERY_PARAMETER_JOB_TYPE, (jobType == IOTHUB_JOB_TYPE_UNKNOWN) ? "" : JOB_TYPE_NAMES[jobType],
+            (jobStatus == IOTHUB_JOB_STATUS_UNKNOWN) ? "" : QUERY_PARAMETER_JOB_STATUS, (jobStatus == IOTHUB_JOB_STATUS_UNKNOWN) ? "" : JOB_STATUS_NAMES[jobStatus])) == NULL)
+        {
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_011: [ If any other call fails the function shall return IOTHUB_JOB_CLIENT_ERROR. ]*/
+            LogError("Failure creating relative path");
+            result = IOTHUB_JOB_CLIENT_ERROR;
+        }
+        else
+        {
+            JOB_QUERY jobQuery;
+            jobQuery.jobCallback = jobCallback;
+            jobQuery.context = context;
+            jobQuery.result = IOTHUB_JOB_CLIENT_OK;
+
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_008: [ Every request shall carry the headers Authorization, Request-Id, User-Agent, Accept=application/json and Content-Type=application/json; charset=utf-8 and shall be executed by calling IoTHubScConnectionPool_ExecuteRequest on the connection pool of the handle. ]*/
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_023: [ IoTHubJobClient_QueryJobs shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+            /*Codes_SRS_IOTHUBJOBCLIENT_02_026: [ If jobCallback returns a non-zero value IoTHubJobClient_QueryJobs shall stop without requesting further pages and return IOTHUB_JOB_CLIENT_OK. ]*/
+            switch (IoTHubScQuery_Execute(serviceClientJobClientHandle->connectionPool, HTTPAPI_REQUEST_GET, STRING_c_str(relativePath), createHttpHeader, NULL, pageSize, onJobQueryResult, &jobQuery))
+            {
+            case IOTHUB_SC_QUERY_OK:
+                /*a job that could not be parsed stops the query the same way the callback does*/
+                result = jobQuery.result;
+                break;
+            case IOTHUB_SC_QUERY_HTTPAPI_ERROR:
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_009: [ If the request fails the function shall return IOTHUB_JOB_CLIENT_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR. ]*/
+                LogError("IoTHubScQuery_Execute failed to execute a request");
+                result = IOTHUB_JOB_CLIENT_HTTPAPI_ERROR;
+                break;
+            case IOTHUB_SC_QUERY_HTTP_STATUS_ERROR:
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_009: [ If the request fails the function shall return IOTHUB_JOB_CLIENT_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR. ]*/
+                LogError("IoTHubScQuery_Execute received a failure status code");
+                result = IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR;
+                break;
+            case IOTHUB_SC_QUERY_JSON_ERROR:
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_024: [ If a page is not a JSON array of jobs IoTHubJobClient_QueryJobs shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+                LogError("query response is not a JSON array of objects");
+                result = IOTHUB_JOB_CLIENT_JSON_ERROR;
+                break;
+            default:
+                /*Codes_SRS_IOTHUBJOBCLIENT_02_011: [ If any other call fails the function shall return IOTHUB_JOB_CLIENT_ERROR. ]*/
+                LogError("IoTHubScQuery_Execute failed");
+                result = IOTHUB_JOB_CLIENT_ERROR;
+                break;
+            }
+            STRING_delete(relativePath);
+        }
+    }
+    return result;
+}
+
+void IoTHubJobClient_FreeJobMembers(IOTHUB_JOB* job)
+{
+    /*Codes_SRS_IOTHUBJOBCLIENT_02_027: [ IoTHubJobClient_FreeJobMembers shall free the strings of job and set them to NULL, it shall do nothing if job is NULL. ]*/
+    if (job != NULL)
+    {
+        free((void*)job->jobId);
+        free((void*)job->queryCondition);
+        free((void*)job->createdTime);
+        free((void*)job->startTime);
+        free((void*)job->endTime);
+        free((void*)job->failureReason);
+        free((void*)job->statusMessage);
+        job->jobId = NULL;
+        job->queryCondition = NULL;
+        job->createdTime = NULL;
+        job->startTime = NULL;
+        job->endTime = NULL;
+        job->failureReason = NULL;
+        job->statusMessage = NULL;
+    }
+}
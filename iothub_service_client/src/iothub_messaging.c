@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -21,54 +22,165 @@
 #include <signal.h>
 #include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
 
 #include "parson.h"
 
 #include "iothub_messaging_ll.h"
 #include "iothub_messaging.h"
 
+/*while sends are in flight the worker keeps the 1 ms cadence it always had, otherwise it only wakes up to service the connection (feedback, keep alive) or when work is submitted*/
+#define WORKER_ACTIVE_WAIT_MILLISECONDS 1
+#define WORKER_IDLE_WAIT_MILLISECONDS 100
+
+/*a send queued by IoTHubMessaging_SendAsync for the worker thread, deviceId is stored right after the structure*/
+typedef struct PENDING_SEND_TAG
+{
+    struct PENDING_SEND_TAG* next;
+    char* deviceId;
+    IOTHUB_MESSAGE_HANDLE message;
+    IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback;
+    void* userContextCallback;
+} PENDING_SEND;
+
 typedef struct IOTHUB_MESSAGING_CLIENT_INSTANCE_TAG
 {
     IOTHUB_MESSAGING_HANDLE IoTHubMessagingHandle;
     THREAD_HANDLE ThreadHandle;
     LOCK_HANDLE LockHandle;
     sig_atomic_t StopThread;
+    /*SubmitLock only guards the queue of pending sends, ThreadHandle and StopThread so that callers never wait for IoTHubMessaging_LL_DoWork*/
+    LOCK_HANDLE SubmitLock;
+    COND_HANDLE WorkAvailable;
+    PENDING_SEND* PendingSendsHead;
+    PENDING_SEND* PendingSendsTail;
+    /*also guarded by SubmitLock, they let IoTHubMessaging_SendAsync fail the way IoTHubMessaging_LL_Send would without waiting for LockHandle*/
+    int IsOpened;
+    size_t MaxInFlightSends;
+    size_t QueuedSendCount;
+    size_t InFlightSendCount;
 } IOTHUB_MESSAGING_CLIENT_INSTANCE;
 
+static void DestroyPendingSend(PENDING_SEND* pendingSend)
+{
+    IoTHubMessage_Destroy(pendingSend->message);
+    free(pendingSend);
+}
+
+/*reports result to the callers of sends that never reached IoTHubMessaging_LL_Send*/
+static void CompletePendingSends(PENDING_SEND* pendingSends, IOTHUB_MESSAGING_RESULT result)
+{
+    while (pendingSends != NULL)
+    {
+        PENDING_SEND* next = pendingSends->next;
+        if (pendingSends->sendCompleteCallback != NULL)
+        {
+            pendingSends->sendCompleteCallback(pendingSends->userContextCallback, result);
+        }
+        DestroyPendingSend(pendingSends);
+        pendingSends = next;
+    }
+}
+
+static void SubmitPendingSends(IOTHUB_MESSAGING_HANDLE messagingHandle, PENDING_SEND* pendingSends)
+{
+    while (pendingSends != NULL)
+    {
+        PENDING_SEND* next = pendingSends->next;
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_051: [ The worker thread shall pass every queued send, in the order they were queued, to IoTHubMessaging_LL_Send. ]*/
+        IOTHUB_MESSAGING_RESULT sendResult = IoTHubMessaging_LL_Send(messagingHandle, pendingSends->deviceId, pendingSends->message, pendingSends->sendCompleteCallback, pendingSends->userContextCallback);
+        if (sendResult != IOTHUB_MESSAGING_OK)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_052: [ If IoTHubMessaging_LL_Send fails, the worker thread shall call sendCompleteCallback with the result of IoTHubMessaging_LL_Send. ]*/
+            LogError("IoTHubMessaging_LL_Send failed for device %s", pendingSends->deviceId);
+            if (pendingSends->sendCompleteCallback != NULL)
+            {
+                pendingSends->sendCompleteCallback(pendingSends->userContextCallback, sendResult);
+            }
+        }
+        DestroyPendingSend(pendingSends);
+        pendingSends = next;
+    }
+}
+
 static int ScheduleWork_Thread(void* threadArgument)
 {
     IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)threadArgument;
+    int waitMilliseconds = WORKER_ACTIVE_WAIT_MILLISECONDS;
 
     while (1)
     {
-        if (Lock(iotHubMessagingClientInstance->LockHandle) == LOCK_OK)
+        if (Lock(iotHubMessagingClientInstance->SubmitLock) != LOCK_OK)
+        {
+            LogError("Lock failed, shall retry");
+            (void)ThreadAPI_Sleep(waitMilliseconds);
+        }
+        else
         {
+            PENDING_SEND* pendingSends;
+
+            /*Codes_SRS_IOTHUBMESSAGING_02_053: [ Unless sends are queued or the thread is asked to stop, the worker thread shall wait on the condition created in IoTHubMessaging_Create instead of sleeping. ]*/
+            if ((iotHubMessagingClientInstance->PendingSendsHead == NULL) && !iotHubMessagingClientInstance->StopThread)
+            {
+                (void)Condition_Wait(iotHubMessagingClientInstance->WorkAvailable, iotHubMessagingClientInstance->SubmitLock, waitMilliseconds);
+            }
+
             /*Codes_SRS_IOTHUBMESSAGING_12_041: [ The thread shall exit when all IoTHubServiceClients using the thread have had IoTHubMessaging_Destroy called. ]*/
             if (iotHubMessagingClientInstance->StopThread)
             {
-                (void)Unlock(iotHubMessagingClientInstance->LockHandle);
+                (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
                 break; /*gets out of the thread*/
             }
-            else
+
+            /*until the worker publishes the count reported by IoTHubMessaging_LL_GetInFlightSendCount the sends it takes are counted as in flight*/
+            pendingSends = iotHubMessagingClientInstance->PendingSendsHead;
+            iotHubMessagingClientInstance->PendingSendsHead = NULL;
+            iotHubMessagingClientInstance->PendingSendsTail = NULL;
+            iotHubMessagingClientInstance->InFlightSendCount += iotHubMessagingClientInstance->QueuedSendCount;
+            iotHubMessagingClientInstance->QueuedSendCount = 0;
+            (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
+
+            /*Codes_SRS_IOTHUBMESSAGING_12_043: [ All calls to IoTHubMessaging_LL_DoWork shall be protected by the lock created in IoTHubMessaging_Create. ]*/
+            if (Lock(iotHubMessagingClientInstance->LockHandle) == LOCK_OK)
             {
-                /*Codes_SRS_IOTHUBMESSAGING_12_042: [ The thread created by IoTHubMessaging_SendAsync shall call IoTHubMessaging_LL_DoWork every 1 ms. ]*/
-                /*Codes_SRS_IOTHUBMESSAGING_12_043: [ All calls to IoTHubMessaging_LL_DoWork shall be protected by the lock created in IoTHubMessaging_Create. ]*/
+                size_t inFlightSendCount;
+
+                SubmitPendingSends(iotHubMessagingClientInstance->IoTHubMessagingHandle, pendingSends);
                 IoTHubMessaging_LL_DoWork(iotHubMessagingClientInstance->IoTHubMessagingHandle);
+
+                /*Codes_SRS_IOTHUBMESSAGING_02_054: [ The wait shall time out after 1 ms while IoTHubMessaging_LL_GetInFlightSendCount reports sends in flight and after 100 ms otherwise. ]*/
+                if (IoTHubMessaging_LL_GetInFlightSendCount(iotHubMessagingClientInstance->IoTHubMessagingHandle, &inFlightSendCount) != IOTHUB_MESSAGING_OK)
+                {
+                    waitMilliseconds = WORKER_ACTIVE_WAIT_MILLISECONDS;
+                }
+                else
+                {
+                    waitMilliseconds = (inFlightSendCount > 0) ? WORKER_ACTIVE_WAIT_MILLISECONDS : WORKER_IDLE_WAIT_MILLISECONDS;
+
+                    /*Codes_SRS_IOTHUBMESSAGING_02_061: [ After IoTHubMessaging_LL_DoWork the worker thread shall record, under the lock that guards the queue of sends, the count returned by IoTHubMessaging_LL_GetInFlightSendCount for IoTHubMessaging_SendAsync. ]*/
+                    if (Lock(iotHubMessagingClientInstance->SubmitLock) == LOCK_OK)
+                    {
+                        iotHubMessagingClientInstance->InFlightSendCount = inFlightSendCount;
+                        (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
+                    }
+                }
                 (void)Unlock(iotHubMessagingClientInstance->LockHandle);
             }
+            else
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_12_044: [ If acquiring the lock fails, `IoTHubMessaging_LL_DoWork` shall not be called. ]*/
+                LogError("Lock failed, shall retry");
+                CompletePendingSends(pendingSends, IOTHUB_MESSAGING_ERROR);
+            }
         }
-        else
-        {
-            /*Codes_SRS_IOTHUBMESSAGING_12_044: [ If acquiring the lock fails, `IoTHubMessaging_LL_DoWork` shall not be called. ]*/
-            LogError("Lock failed, shall retry");
-        }
-        (void)ThreadAPI_Sleep(1);
     }
 
     ThreadAPI_Exit(0);
     return 0;
 }
 
+/*needs SubmitLock to be held*/
 static IOTHUB_MESSAGING_RESULT StartWorkerThreadIfNeeded(IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance)
 {
     IOTHUB_MESSAGING_RESULT result;
@@ -78,6 +190,7 @@ static IOTHUB_MESSAGING_RESULT StartWorkerThreadIfNeeded(IOTHUB_MESSAGING_CLIENT
         if (ThreadAPI_Create(&iotHubMessagingClientInstance->ThreadHandle, ScheduleWork_Thread, iotHubMessagingClientInstance) != THREADAPI_OK)
         {
             LogError("ThreadAPI_Create failed");
+            iotHubMessagingClientInstance->ThreadHandle = NULL;
             result = IOTHUB_MESSAGING_ERROR;
         }
         else
@@ -123,6 +236,26 @@ IOTHUB_MESSAGING_CLIENT_HANDLE IoTHubMessaging_Create(IOTHUB_SERVICE_CLIENT_AUTH
                 free(result);
                 result = NULL;
             }
+            /*Codes_SRS_IOTHUBMESSAGING_02_045: [ IoTHubMessaging_Create shall create a second lock that guards the queue of sends and a condition the worker thread waits on. ]*/
+            else if ((result->SubmitLock = Lock_Init()) == NULL)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_046: [ If creating the second lock or the condition fails, then IoTHubMessaging_Create shall return NULL. ]*/
+                /*Codes_SRS_IOTHUBMESSAGING_12_008: [If IoTHubMessaging_Create fails, all resources allocated by it shall be freed. ]*/
+                LogError("Lock_Init failed");
+                Lock_Deinit(result->LockHandle);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->WorkAvailable = Condition_Init()) == NULL)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_046: [ If creating the second lock or the condition fails, then IoTHubMessaging_Create shall return NULL. ]*/
+                /*Codes_SRS_IOTHUBMESSAGING_12_008: [If IoTHubMessaging_Create fails, all resources allocated by it shall be freed. ]*/
+                LogError("Condition_Init failed");
+                Lock_Deinit(result->SubmitLock);
+                Lock_Deinit(result->LockHandle);
+                free(result);
+                result = NULL;
+            }
             else
             {
                 /*Codes_SRS_IOTHUBMESSAGING_12_006: [IoTHubMessaging_Create shall instantiate a new IoTHubMessaging_LL instance by calling IoTHubMessaging_LL_Create and passing the serviceClientHandle argument. ]*/
@@ -132,6 +265,8 @@ IOTHUB_MESSAGING_CLIENT_HANDLE IoTHubMessaging_Create(IOTHUB_SERVICE_CLIENT_AUTH
                     /*Codes_SRS_IOTHUBMESSAGING_12_007: [ If IoTHubMessaging_LL_Create fails, then IoTHubMessaging_Create shall return NULL. ]*/
                     /*Codes_SRS_IOTHUBMESSAGING_12_008: [If IoTHubMessaging_Create fails, all resources allocated by it shall be freed. ]*/
                     LogError("IoTHubMessaging_LL_Create failed");
+                    Condition_Deinit(result->WorkAvailable);
+                    Lock_Deinit(result->SubmitLock);
                     Lock_Deinit(result->LockHandle);
                     free(result);
                     result = NULL;
@@ -140,6 +275,12 @@ IOTHUB_MESSAGING_CLIENT_HANDLE IoTHubMessaging_Create(IOTHUB_SERVICE_CLIENT_AUTH
                 {
                     result->StopThread = 0;
                     result->ThreadHandle = NULL;
+                    result->PendingSendsHead = NULL;
+                    result->PendingSendsTail = NULL;
+                    result->IsOpened = 0;
+                    result->MaxInFlightSends = 0;
+                    result->QueuedSendCount = 0;
+                    result->InFlightSendCount = 0;
                 }
             }
         }
@@ -158,10 +299,15 @@ void IoTHubMessaging_Destroy(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandl
     {
         IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
 
+        /*Codes_SRS_IOTHUBMESSAGING_02_047: [ IoTHubMessaging_Destroy shall call the sendCompleteCallback of every send still queued with IOTHUB_MESSAGING_ERROR. ]*/
+        CompletePendingSends(messagingClientInstance->PendingSendsHead, IOTHUB_MESSAGING_ERROR);
+
         /*Codes_SRS_IOTHUBMESSAGING_12_011: [ IoTHubMessaging_Destroy shall destroy IoTHubMessagingHandle by call IoTHubMessaging_LL_Destroy. ]*/
         IoTHubMessaging_LL_Destroy(messagingClientInstance->IoTHubMessagingHandle);
 
         /*Codes_SRS_IOTHUBMESSAGING_12_014: [ If the lock was allocated in IoTHubMessaging_Create, it shall be also freed. ]*/
+        Condition_Deinit(messagingClientInstance->WorkAvailable);
+        Lock_Deinit(messagingClientInstance->SubmitLock);
         Lock_Deinit(messagingClientInstance->LockHandle);
 
         free(messagingClientInstance);
@@ -191,9 +337,21 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_Open(IOTHUB_MESSAGING_CLIENT_HANDLE mess
         }
         else
         {
-            /*Codes_SRS_IOTHUBMESSAGING_12_018: [ IoTHubMessaging_Open shall call IoTHubMessaging_LL_Open, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubMessaging_Create and the parameters openCompleteCallback and userContextCallback. ]*/
-            /*Codes_SRS_IOTHUBMESSAGING_12_019: [ When IoTHubMessaging_LL_Open is called, IoTHubMessaging_Open shall return the result of IoTHubMessaging_LL_Open. ]*/
-            result = IoTHubMessaging_LL_Open(messagingClientHandle->IoTHubMessagingHandle, openCompleteCallback, userContextCallback);
+            /*Codes_SRS_IOTHUBMESSAGING_02_058: [ IoTHubMessaging_Open shall also acquire the lock that guards the queue of sends and record whether IoTHubMessaging_LL_Open succeeded, IoTHubMessaging_Close shall record that the client is closed. ]*/
+            if (Lock(iotHubMessagingClientInstance->SubmitLock) != LOCK_OK)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_12_017: [ If acquiring the lock fails, IoTHubMessaging_Open shall return IOTHUB_MESSAGING_ERROR. ]*/
+                LogError("Could not acquire lock");
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_12_018: [ IoTHubMessaging_Open shall call IoTHubMessaging_LL_Open, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubMessaging_Create and the parameters openCompleteCallback and userContextCallback. ]*/
+                /*Codes_SRS_IOTHUBMESSAGING_12_019: [ When IoTHubMessaging_LL_Open is called, IoTHubMessaging_Open shall return the result of IoTHubMessaging_LL_Open. ]*/
+                result = IoTHubMessaging_LL_Open(messagingClientHandle->IoTHubMessagingHandle, openCompleteCallback, userContextCallback);
+                iotHubMessagingClientInstance->IsOpened = (result == IOTHUB_MESSAGING_OK);
+                (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
+            }
 
             /*Codes_SRS_IOTHUBMESSAGING_12_016: [ IoTHubMessaging_Open shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
             (void)Unlock(iotHubMessagingClientInstance->LockHandle);
@@ -214,18 +372,26 @@ void IoTHubMessaging_Close(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle)
     {
         IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
 
+        PENDING_SEND* pendingSends;
+
         /*Codes_SRS_IOTHUBMESSAGING_12_022: [ IoTHubMessaging_Close shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
-        if (Lock(iotHubMessagingClientInstance->LockHandle) != LOCK_OK)
+        if (Lock(iotHubMessagingClientInstance->SubmitLock) != LOCK_OK)
         {
             LogError("Could not acquire lock");
             iotHubMessagingClientInstance->StopThread = 1; /*setting it even when Lock fails*/
+            iotHubMessagingClientInstance->IsOpened = 0;
+            (void)Condition_Post(iotHubMessagingClientInstance->WorkAvailable);
         }
         else
         {
+            /*Codes_SRS_IOTHUBMESSAGING_02_048: [ IoTHubMessaging_Close shall signal the condition so that a waiting worker thread exits without waiting for its timeout. ]*/
             iotHubMessagingClientInstance->StopThread = 1;
+            /*Codes_SRS_IOTHUBMESSAGING_02_058: [ IoTHubMessaging_Open shall also acquire the lock that guards the queue of sends and record whether IoTHubMessaging_LL_Open succeeded, IoTHubMessaging_Close shall record that the client is closed. ]*/
+            iotHubMessagingClientInstance->IsOpened = 0;
+            (void)Condition_Post(iotHubMessagingClientInstance->WorkAvailable);
 
             /*Codes_SRS_IOTHUBMESSAGING_12_022: [ IoTHubMessaging_Close shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
-            (void)Unlock(iotHubMessagingClientInstance->LockHandle);
+            (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
         }
 
         if (iotHubMessagingClientInstance->ThreadHandle != NULL)
@@ -236,8 +402,17 @@ void IoTHubMessaging_Close(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle)
             {
                 LogError("ThreadAPI_Join failed");
             }
+            iotHubMessagingClientInstance->ThreadHandle = NULL;
         }
 
+        /*Codes_SRS_IOTHUBMESSAGING_02_049: [ After the thread is joined, IoTHubMessaging_Close shall call the sendCompleteCallback of every send still queued with IOTHUB_MESSAGING_ERROR. ]*/
+        pendingSends = iotHubMessagingClientInstance->PendingSendsHead;
+        iotHubMessagingClientInstance->PendingSendsHead = NULL;
+        iotHubMessagingClientInstance->PendingSendsTail = NULL;
+        iotHubMessagingClientInstance->QueuedSendCount = 0;
+        iotHubMessagingClientInstance->InFlightSendCount = 0;
+        CompletePendingSends(pendingSends, IOTHUB_MESSAGING_ERROR);
+
         /*Codes_SRS_IOTHUBMESSAGING_12_024: [ IoTHubMessaging_Close shall call IoTHubMessaging_LL_Close, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubMessaging_Create ]*/
         IoTHubMessaging_LL_Close(messagingClientHandle->IoTHubMessagingHandle);
     }
@@ -278,6 +453,39 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_SetFeedbackMessageCallback(IOTHUB_MESSAG
     return result;
 }
 
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_SetFeedbackRecordCallback(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle, IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK feedbackRecordReceivedCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    if (messagingClientHandle == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_041: [ If messagingClientHandle is NULL, IoTHubMessaging_SetFeedbackRecordCallback shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+        LogError("NULL messagingClientHandle");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_042: [ IoTHubMessaging_SetFeedbackRecordCallback shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
+        if (Lock(iotHubMessagingClientInstance->LockHandle) != LOCK_OK)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_043: [ If acquiring the lock fails, IoTHubMessaging_SetFeedbackRecordCallback shall return IOTHUB_MESSAGING_ERROR. ]*/
+            LogError("Could not acquire lock");
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_044: [ IoTHubMessaging_SetFeedbackRecordCallback shall call IoTHubMessaging_LL_SetFeedbackRecordCallback and return its result. ]*/
+            result = IoTHubMessaging_LL_SetFeedbackRecordCallback(messagingClientHandle->IoTHubMessagingHandle, feedbackRecordReceivedCallback, userContextCallback);
+
+            (void)Unlock(iotHubMessagingClientInstance->LockHandle);
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_MESSAGING_RESULT IoTHubMessaging_SendAsync(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle, const char* deviceId, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback, void* userContextCallback)
 {
     IOTHUB_MESSAGING_RESULT result;
@@ -288,34 +496,146 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_SendAsync(IOTHUB_MESSAGING_CLIENT_HANDLE
         LogError("NULL iothubClientHandle");
         result = IOTHUB_MESSAGING_INVALID_ARG;
     }
+    else if ((deviceId == NULL) || (message == NULL))
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_050: [ If deviceId or message is NULL, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+        LogError("Invalid argument deviceId: %p message: %p", deviceId, message);
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
     else
     {
         IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
 
-        /*Codes_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_SendAsync shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
-        if (Lock(iotHubMessagingClientInstance->LockHandle) != LOCK_OK)
+        /*Codes_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_SendAsync shall be made thread-safe by using the lock that guards the queue of sends, it shall not wait for the lock held by the worker thread around IoTHubMessaging_LL_DoWork. ]*/
+        if (Lock(iotHubMessagingClientInstance->SubmitLock) != LOCK_OK)
         {
             /*Codes_SRS_IOTHUBMESSAGING_12_035: [ If acquiring the lock fails, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
             LogError("Could not acquire lock");
-            result = IOTHUB_MESSAGING_INVALID_ARG;
+            result = IOTHUB_MESSAGING_ERROR;
         }
         else
         {
+            size_t deviceIdLength = strlen(deviceId);
+            PENDING_SEND* pendingSend;
+
+            if (!iotHubMessagingClientInstance->IsOpened)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_059: [ If IoTHubMessaging_Open has not succeeded since the client was created or closed, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR without queuing the send. ]*/
+                LogError("Messaging is not opened - call IoTHubMessaging_Open to open");
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else if ((iotHubMessagingClientInstance->MaxInFlightSends != 0) &&
+                (iotHubMessagingClientInstance->QueuedSendCount + iotHubMessagingClientInstance->InFlightSendCount >= iotHubMessagingClientInstance->MaxInFlightSends))
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_060: [ If maxInFlightSends is not 0 and the sends already queued plus the sends in flight reach it, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR without queuing the send. ]*/
+                LogError("there are already %lu sends queued or in flight", (unsigned long)(iotHubMessagingClientInstance->QueuedSendCount + iotHubMessagingClientInstance->InFlightSendCount));
+                result = IOTHUB_MESSAGING_ERROR;
+            }
             /*Codes_SRS_IOTHUBMESSAGING_12_036: [ IoTHubClient_SendEventAsync shall start the worker thread if it was not previously started. ]*/
-            if ((result = StartWorkerThreadIfNeeded(iotHubMessagingClientInstance)) != IOTHUB_MESSAGING_OK)
+            else if (StartWorkerThreadIfNeeded(iotHubMessagingClientInstance) != IOTHUB_MESSAGING_OK)
             {
                 /*Codes_SRS_IOTHUBMESSAGING_12_037: [ If starting the thread fails, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_ERROR. ]*/
                 LogError("Could not start worker thread");
                 result = IOTHUB_MESSAGING_ERROR;
             }
+            /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_SendAsync shall queue a copy of deviceId and a clone of message, made by IoTHubMessage_Clone, together with sendCompleteCallback and userContextCallback for the worker thread. ]*/
+            else if ((pendingSend = (PENDING_SEND*)malloc(sizeof(PENDING_SEND) + deviceIdLength + 1)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_12_039: [ If queuing the send fails, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+                LogError("malloc failed");
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else if ((pendingSend->message = IoTHubMessage_Clone(message)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_12_039: [ If queuing the send fails, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+                LogError("IoTHubMessage_Clone failed");
+                free(pendingSend);
+                result = IOTHUB_MESSAGING_ERROR;
+            }
             else
             {
-                /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_SendAsync shall call IoTHubMessaging_LL_Send, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubClient_Create and the parameters deviceId, message, sendCompleteCallback and userContextCallback.*/
-                /*Codes_SRS_IOTHUBMESSAGING_12_039: [ When IoTHubMessaging_LL_Send is called, IoTHubMessaging_SendAsync shall return the result of IoTHubMessaging_LL_Send. ]*/
-                result = IoTHubMessaging_LL_Send(iotHubMessagingClientInstance->IoTHubMessagingHandle, deviceId, message, sendCompleteCallback, userContextCallback);
+                pendingSend->next = NULL;
+                pendingSend->deviceId = (char*)(pendingSend + 1);
+                (void)memcpy(pendingSend->deviceId, deviceId, deviceIdLength + 1);
+                pendingSend->sendCompleteCallback = sendCompleteCallback;
+                pendingSend->userContextCallback = userContextCallback;
+
+                /*Codes_SRS_IOTHUBMESSAGING_02_051: [ The worker thread shall pass every queued send, in the order they were queued, to IoTHubMessaging_LL_Send. ]*/
+                if (iotHubMessagingClientInstance->PendingSendsTail == NULL)
+                {
+                    iotHubMessagingClientInstance->PendingSendsHead = pendingSend;
+                }
+                else
+                {
+                    iotHubMessagingClientInstance->PendingSendsTail->next = pendingSend;
+                }
+                iotHubMessagingClientInstance->PendingSendsTail = pendingSend;
+                iotHubMessagingClientInstance->QueuedSendCount++;
+
+                /*Codes_SRS_IOTHUBMESSAGING_02_053: [ Unless sends are queued or the thread is asked to stop, the worker thread shall wait on the condition created in IoTHubMessaging_Create instead of sleeping. ]*/
+                (void)Condition_Post(iotHubMessagingClientInstance->WorkAvailable);
+                result = IOTHUB_MESSAGING_OK;
             }
 
             /*Codes_SRS_IOTHUBMESSAGING_12_040: [ IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create. ]*/
+            (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
+        }
+    }
+
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_SendBatchAsync(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle, const char* const* deviceIds, size_t deviceIdCount, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_BATCH_COMPLETE_CALLBACK sendBatchCompleteCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    if (messagingClientHandle == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_030: [ If messagingClientHandle is NULL, IoTHubMessaging_SendBatchAsync shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+        LogError("NULL iothubClientHandle");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_031: [ IoTHubMessaging_SendBatchAsync shall acquire the lock created in IoTHubMessaging_Create once for the whole batch. ]*/
+        if (Lock(iotHubMessagingClientInstance->LockHandle) != LOCK_OK)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_032: [ If acquiring the lock fails, IoTHubMessaging_SendBatchAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+            LogError("Could not acquire lock");
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_033: [ IoTHubMessaging_SendBatchAsync shall start the worker thread if it was not previously started. ]*/
+            if (Lock(iotHubMessagingClientInstance->SubmitLock) != LOCK_OK)
+            {
+                LogError("Could not acquire lock");
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else
+            {
+                if ((result = StartWorkerThreadIfNeeded(iotHubMessagingClientInstance)) == IOTHUB_MESSAGING_OK)
+                {
+                    /*Codes_SRS_IOTHUBMESSAGING_02_057: [ IoTHubMessaging_SendBatchAsync shall signal the condition so that a waiting worker thread services the batch as soon as it is queued. ]*/
+                    (void)Condition_Post(iotHubMessagingClientInstance->WorkAvailable);
+                }
+                (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
+            }
+
+            if (result != IOTHUB_MESSAGING_OK)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_034: [ If starting the thread fails, IoTHubMessaging_SendBatchAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+                LogError("Could not start worker thread");
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_035: [ IoTHubMessaging_SendBatchAsync shall call IoTHubMessaging_LL_SendBatch with all its parameters and return its result. ]*/
+                result = IoTHubMessaging_LL_SendBatch(iotHubMessagingClientInstance->IoTHubMessagingHandle, deviceIds, deviceIdCount, message, sendBatchCompleteCallback, userContextCallback);
+            }
+
             (void)Unlock(iotHubMessagingClientInstance->LockHandle);
         }
     }
@@ -323,6 +643,46 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_SendAsync(IOTHUB_MESSAGING_CLIENT_HANDLE
     return result;
 }
 
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_SetMaxInFlightSends(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle, size_t maxInFlightSends)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    if (messagingClientHandle == NULL)
+    {
+        LogError("NULL iothubClientHandle");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_MESSAGING_CLIENT_INSTANCE* iotHubMessagingClientInstance = (IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+
+        if (Lock(iotHubMessagingClientInstance->LockHandle) != LOCK_OK)
+        {
+            LogError("Could not acquire lock");
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_062: [ IoTHubMessaging_SetMaxInFlightSends shall also acquire the lock that guards the queue of sends, call IoTHubMessaging_LL_SetMaxInFlightSends and, if it succeeds, keep maxInFlightSends for IoTHubMessaging_SendAsync. ]*/
+            if (Lock(iotHubMessagingClientInstance->SubmitLock) != LOCK_OK)
+            {
+                LogError("Could not acquire lock");
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else
+            {
+                if ((result = IoTHubMessaging_LL_SetMaxInFlightSends(iotHubMessagingClientInstance->IoTHubMessagingHandle, maxInFlightSends)) == IOTHUB_MESSAGING_OK)
+                {
+                    iotHubMessagingClientInstance->MaxInFlightSends = maxInFlightSends;
+                }
+                (void)Unlock(iotHubMessagingClientInstance->SubmitLock);
+            }
+            (void)Unlock(iotHubMessagingClientInstance->LockHandle);
+        }
+    }
+    return result;
+}
+
 IOTHUB_MESSAGING_RESULT IoTHubMessaging_SetTrustedCert(IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle, const char* trusted_cert)
 {
     IOTHUB_MESSAGING_RESULT result;
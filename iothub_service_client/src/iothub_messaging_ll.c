@@ -2,7 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
-#include <ctype.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -21,10 +21,9 @@
 #include "azure_uamqp_c/sasl_plain.h"
 #include "azure_uamqp_c/cbs.h"
 
-#include "parson.h"
-
 #include "iothub_messaging_ll.h"
 #include "iothub_sc_version.h"
+#include "iothub_sc_feedback_parser.h"
 
 DEFINE_ENUM_STRINGS(IOTHUB_FEEDBACK_STATUS_CODE, IOTHUB_FEEDBACK_STATUS_CODE_VALUES);
 DEFINE_ENUM_STRINGS(IOTHUB_MESSAGE_SEND_STATE, IOTHUB_MESSAGE_SEND_STATE_VALUES);
@@ -33,11 +32,11 @@ DEFINE_ENUM_STRINGS(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_RESULT_VALUES);
 typedef struct CALLBACK_DATA_TAG
 {
     IOTHUB_OPEN_COMPLETE_CALLBACK openCompleteCompleteCallback;
-    IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback;
     IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK feedbackMessageCallback;
+    IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK feedbackRecordCallback;
     void* openUserContext;
-    void* sendUserContext;
     void* feedbackUserContext;
+    void* feedbackRecordUserContext;
 } CALLBACK_DATA;
 
 typedef struct IOTHUB_MESSAGING_TAG
@@ -66,14 +65,48 @@ typedef struct IOTHUB_MESSAGING_TAG
 
     CALLBACK_DATA* callback_data;
 
+    size_t inFlightSendCount;
+    size_t maxInFlightSends;
+
+    /*feedback messages are parsed in place in feedbackBuffer and their records collected in feedbackRecords, both are reused by the next message*/
+    char* feedbackBuffer;
+    size_t feedbackBufferSize;
+    IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecords;
+    size_t feedbackRecordCount;
+    size_t feedbackRecordCapacity;
+
 } IOTHUB_MESSAGING;
 
+/*every IoTHubMessaging_LL_Send owns one of these until its IoTHubMessaging_LL_SendMessageComplete runs*/
+typedef struct SEND_COMPLETE_CONTEXT_TAG
+{
+    IOTHUB_MESSAGING* messagingData;
+    IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback;
+    void* sendUserContext;
+} SEND_COMPLETE_CONTEXT;
+
+typedef struct SEND_BATCH_CONTEXT_TAG* SEND_BATCH_CONTEXT_HANDLE;
+
+/*the context of one device of a batch, its index in the batch is its position in the items array*/
+typedef struct SEND_BATCH_ITEM_TAG
+{
+    SEND_BATCH_CONTEXT_HANDLE batch;
+} SEND_BATCH_ITEM;
+
+typedef struct SEND_BATCH_CONTEXT_TAG
+{
+    IOTHUB_MESSAGING* messagingData;
+    IOTHUB_SEND_BATCH_COMPLETE_CALLBACK sendBatchCompleteCallback;
+    void* sendBatchUserContext;
+    size_t deviceIdCount;
+    size_t pendingCount;
+    SEND_BATCH_ITEM* items;
+    IOTHUB_MESSAGING_RESULT* results;
+} SEND_BATCH_CONTEXT;
+
+
+#define FEEDBACK_RECORD_ARENA_INITIAL_CAPACITY 64
 
-static const char* const FEEDBACK_RECORD_KEY_DEVICE_ID = "deviceId";
-static const char* const FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID = "deviceGenerationId";
-static const char* const FEEDBACK_RECORD_KEY_DESCRIPTION = "description";
-static const char* const FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC = "enqueuedTimeUtc";
-static const char* const FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID = "originalMessageId";
 static const char* const AMQP_ADDRESS_PATH_FMT = "/devices/%s/messages/deviceBound";
 static const char* const AMQP_ADDRESS_PATH_MODULE_FMT = "/devices/%s/modules/%s/messages/deviceBound";
 
@@ -642,33 +675,173 @@ static void IoTHubMessaging_LL_ReceiverStateChanged(const void* context, MESSAGE
     }
 }
 
+static IOTHUB_MESSAGING_RESULT sendResultToMessagingResult(MESSAGE_SEND_RESULT send_result)
+{
+    IOTHUB_MESSAGING_RESULT result;
+    switch (send_result)
+    {
+        case MESSAGE_SEND_OK:
+            result = IOTHUB_MESSAGING_OK;
+            break;
+        case MESSAGE_SEND_ERROR:
+        case MESSAGE_SEND_TIMEOUT:
+        case MESSAGE_SEND_CANCELLED:
+        default:
+            result = IOTHUB_MESSAGING_ERROR;
+            break;
+    }
+    return result;
+}
+
 static void IoTHubMessaging_LL_SendMessageComplete(void* context, MESSAGE_SEND_RESULT send_result, AMQP_VALUE delivery_state)
 {
     (void)delivery_state;
     /*Codes_SRS_IOTHUBMESSAGING_12_056: [ If context is NULL IoTHubMessaging_LL_SendMessageComplete shall return ] */
     if (context != NULL)
     {
+        SEND_COMPLETE_CONTEXT* sendContext = (SEND_COMPLETE_CONTEXT*)context;
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_005: [ IoTHubMessaging_LL_SendMessageComplete shall decrement the number of sends in flight. ]*/
+        sendContext->messagingData->inFlightSendCount--;
+
         /*Codes_SRS_IOTHUBMESSAGING_12_055: [ If context is not NULL and IoTHubMessaging_LL_SendMessageComplete shall call user callback with user context and messaging result ] */
-        IOTHUB_MESSAGING* messagingData = (IOTHUB_MESSAGING*)context;
-        if (messagingData->callback_data->sendCompleteCallback != NULL)
+        if (sendContext->sendCompleteCallback != NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_006: [ IoTHubMessaging_LL_SendMessageComplete shall call the sendCompleteCallback and userContextCallback that were passed to the IoTHubMessaging_LL_Send which produced context. ]*/
+            (sendContext->sendCompleteCallback)(sendContext->sendUserContext, sendResultToMessagingResult(send_result));
+        }
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_007: [ IoTHubMessaging_LL_SendMessageComplete shall free context. ]*/
+        free(sendContext);
+    }
+}
+
+static void destroySendBatch(SEND_BATCH_CONTEXT* batch)
+{
+    free(batch->items);
+    free(batch->results);
+    free(batch);
+}
+
+static void releaseSendBatch(SEND_BATCH_CONTEXT* batch)
+{
+    batch->pendingCount--;
+    if (batch->pendingCount == 0)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_021: [ When the last send of the batch completes, sendBatchCompleteCallback shall be called once with userContextCallback, the results indexed like deviceIds and deviceIdCount, then the batch shall be freed. ]*/
+        if (batch->sendBatchCompleteCallback != NULL)
+        {
+            batch->sendBatchCompleteCallback(batch->sendBatchUserContext, batch->results, batch->deviceIdCount);
+        }
+        destroySendBatch(batch);
+    }
+}
+
+static void IoTHubMessaging_LL_SendBatchMessageComplete(void* context, MESSAGE_SEND_RESULT send_result, AMQP_VALUE delivery_state)
+{
+    (void)delivery_state;
+    if (context != NULL)
+    {
+        SEND_BATCH_ITEM* item = (SEND_BATCH_ITEM*)context;
+        SEND_BATCH_CONTEXT* batch = item->batch;
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_020: [ IoTHubMessaging_LL_SendBatchMessageComplete shall store the result of the send in the position of its device and decrement the number of sends in flight. ]*/
+        batch->results[item - batch->items] = sendResultToMessagingResult(send_result);
+        batch->messagingData->inFlightSendCount--;
+        releaseSendBatch(batch);
+    }
+}
+
+/*feedbackRecords is kept by the messaging instance and reused by every batch, it only grows*/
+static int addFeedbackRecordToArena(void* context, IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    int result;
+    IOTHUB_MESSAGING* messagingData = (IOTHUB_MESSAGING*)context;
+
+    if (messagingData->feedbackRecordCount == messagingData->feedbackRecordCapacity)
+    {
+        size_t newCapacity = (messagingData->feedbackRecordCapacity == 0) ? FEEDBACK_RECORD_ARENA_INITIAL_CAPACITY : (2 * messagingData->feedbackRecordCapacity);
+        IOTHUB_SERVICE_FEEDBACK_RECORD* newRecords;
+
+        if ((newCapacity <= messagingData->feedbackRecordCapacity) ||
+            (newCapacity > SIZE_MAX / sizeof(IOTHUB_SERVICE_FEEDBACK_RECORD)) ||
+            ((newRecords = (IOTHUB_SERVICE_FEEDBACK_RECORD*)realloc(messagingData->feedbackRecords, newCapacity * sizeof(IOTHUB_SERVICE_FEEDBACK_RECORD))) == NULL))
+        {
+            LogError("Failure growing the feedback record arena to %lu records", (unsigned long)newCapacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            messagingData->feedbackRecords = newRecords;
+            messagingData->feedbackRecordCapacity = newCapacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        messagingData->feedbackRecords[messagingData->feedbackRecordCount++] = *feedbackRecord;
+    }
+    return result;
+}
+
+static int deliverFeedbackRecord(void* context, IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    IOTHUB_MESSAGING* messagingData = (IOTHUB_MESSAGING*)context;
+
+    /*Codes_SRS_IOTHUBMESSAGING_02_038: [ If a record callback is set, IoTHubMessaging_LL_FeedbackMessageReceived shall call it for every record as soon as the record is parsed and shall not call the IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK. ]*/
+    if (messagingData->callback_data->feedbackRecordCallback != NULL)
+    {
+        messagingData->callback_data->feedbackRecordCallback(messagingData->callback_data->feedbackRecordUserContext, feedbackRecord);
+    }
+    return 0;
+}
+
+static AMQP_VALUE deliverFeedbackBatch(IOTHUB_MESSAGING* messagingData)
+{
+    AMQP_VALUE result;
+    IOTHUB_SERVICE_FEEDBACK_BATCH feedbackBatch;
+
+    feedbackBatch.lockToken = "";
+    feedbackBatch.userId = "";
+
+    if ((feedbackBatch.feedbackRecordList = singlylinkedlist_create()) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
+        LogError("singlylinkedlist_create failed");
+        result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "singlylinkedlist_create failed");
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < messagingData->feedbackRecordCount; i++)
         {
-            // Convert a send result to an
-            IOTHUB_MESSAGING_RESULT msg_result;
-            switch (send_result)
+            if (singlylinkedlist_add(feedbackBatch.feedbackRecordList, &messagingData->feedbackRecords[i]) == NULL)
             {
-                case MESSAGE_SEND_OK:
-                    msg_result = IOTHUB_MESSAGING_OK;
-                    break;
-                case MESSAGE_SEND_ERROR:
-                case MESSAGE_SEND_TIMEOUT:
-                case MESSAGE_SEND_CANCELLED:
-                default:
-                    msg_result = IOTHUB_MESSAGING_ERROR;
-                    break;
+                LogError("singlylinkedlist_add failed");
+                break;
             }
-            (messagingData->callback_data->sendCompleteCallback)(messagingData->callback_data->sendUserContext, msg_result);
         }
+
+        if (i < messagingData->feedbackRecordCount)
+        {
+            result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed to read feedback records");
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
+            messagingData->callback_data->feedbackMessageCallback(messagingData->callback_data->feedbackUserContext, &feedbackBatch);
+            result = messaging_delivery_accepted();
+        }
+
+        /*Codes_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
+        singlylinkedlist_destroy(feedbackBatch.feedbackRecordList);
     }
+    return result;
 }
 
 static AMQP_VALUE IoTHubMessaging_LL_FeedbackMessageReceived(const void* context, MESSAGE_HANDLE message)
@@ -683,167 +856,74 @@ static AMQP_VALUE IoTHubMessaging_LL_FeedbackMessageReceived(const void* context
     else
     {
         IOTHUB_MESSAGING* messagingData = (IOTHUB_MESSAGING*)context;
-
         BINARY_DATA binary_data;
-        JSON_Value* root_value = NULL;
-        JSON_Object* feedback_object = NULL;
-        JSON_Array* feedback_array = NULL;
 
         /*Codes_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data ] */
-        /*Codes_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-        /*Codes_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
         if (message_get_body_amqp_data_in_place(message, 0, &binary_data) != 0)
         {
             /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
             LogError("Cannot get message data");
             result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed reading message body");
         }
-        else if ((root_value = json_parse_string((const char*)binary_data.bytes)) == NULL)
-        {
-            /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
-            LogError("json_parse_string failed");
-            result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed parsing json root");
-        }
-        else if ((feedback_array = json_value_get_array(root_value)) == NULL)
-        {
-            /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
-            LogError("json_parse_string failed");
-            result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed parsing json array");
-        }
-        else if (json_array_get_count(feedback_array) == 0)
+        else if ((binary_data.bytes == NULL) || (binary_data.length == 0))
         {
-            /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
-            LogError("json_array_get_count failed");
-            result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "json_array_get_count failed");
+            LogError("Feedback message has no body");
+            result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Empty message body");
         }
         else
         {
-            IOTHUB_SERVICE_FEEDBACK_BATCH* feedbackBatch;
+            /*Codes_SRS_IOTHUBMESSAGING_02_036: [ IoTHubMessaging_LL_FeedbackMessageReceived shall copy the body into a buffer owned by the messaging instance, growing it only when the body does not fit. ]*/
+            if (binary_data.length > messagingData->feedbackBufferSize)
+            {
+                char* newBuffer;
+                if ((newBuffer = (char*)realloc(messagingData->feedbackBuffer, binary_data.length)) == NULL)
+                {
+                    LogError("Failure allocating %lu bytes for the feedback message", (unsigned long)binary_data.length);
+                }
+                else
+                {
+                    messagingData->feedbackBuffer = newBuffer;
+                    messagingData->feedbackBufferSize = binary_data.length;
+                }
+            }
 
-            if ((feedbackBatch = (IOTHUB_SERVICE_FEEDBACK_BATCH*)malloc(sizeof(IOTHUB_SERVICE_FEEDBACK_BATCH))) == NULL)
+            if (binary_data.length > messagingData->feedbackBufferSize)
             {
-                /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
-                LogError("json_parse_string failed");
                 result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed to allocate memory for feedback batch");
             }
             else
             {
-                size_t array_count = 0;
-                if ((array_count = json_array_get_count(feedback_array)) <= 0)
+                size_t recordCount;
+                /*without a batch callback there is nothing to collect the records for*/
+                bool isStreaming = (messagingData->callback_data->feedbackRecordCallback != NULL) || (messagingData->callback_data->feedbackMessageCallback == NULL);
+
+                (void)memcpy(messagingData->feedbackBuffer, binary_data.bytes, binary_data.length);
+                messagingData->feedbackRecordCount = 0;
+
+                /*Codes_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
+                /*Codes_SRS_IOTHUBMESSAGING_02_037: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the body by calling IoTHubScFeedbackParser_Parse; the records of a batch shall be stored in an array owned by the messaging instance that is reused by the following batches. ]*/
+                if (IoTHubScFeedbackParser_Parse(messagingData->feedbackBuffer, binary_data.length, isStreaming ? deliverFeedbackRecord : addFeedbackRecordToArena, messagingData, &recordCount) != 0)
                 {
                     /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
-                    LogError("json_array_get_count failed");
-                    free(feedbackBatch);
-                    result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "json_array_get_count failed");
+                    LogError("IoTHubScFeedbackParser_Parse failed");
+                    result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed to read feedback records");
                 }
-                else if ((feedbackBatch->feedbackRecordList = singlylinkedlist_create()) == NULL)
+                else if (recordCount == 0)
                 {
                     /*Codes_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
-                    LogError("singlylinkedlist_create failed");
-                    free(feedbackBatch);
-                    result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "singlylinkedlist_create failed");
+                    LogError("Feedback message has no records");
+                    result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Feedback message has no records");
+                }
+                else if (isStreaming)
+                {
+                    result = messaging_delivery_accepted();
                 }
                 else
                 {
-                    bool isLoopFailed = false;
-                    for (size_t i = 0; i < array_count; i++)
-                    {
-                        if ((feedback_object = json_array_get_object(feedback_array, i)) == NULL)
-                        {
-                            isLoopFailed = true;
-                            break;
-                        }
-                        else
-                        {
-                            IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord;
-                            if ((feedbackRecord = (IOTHUB_SERVICE_FEEDBACK_RECORD*)malloc(sizeof(IOTHUB_SERVICE_FEEDBACK_RECORD))) == NULL)
-                            {
-                                isLoopFailed = true;
-                                break;
-                            }
-                            else
-                            {
-                                feedbackRecord->deviceId = (char*)json_object_get_string(feedback_object, FEEDBACK_RECORD_KEY_DEVICE_ID);
-                                feedbackRecord->generationId = (char*)json_object_get_string(feedback_object, FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID);
-                                feedbackRecord->description = (char*)json_object_get_string(feedback_object, FEEDBACK_RECORD_KEY_DESCRIPTION);
-                                feedbackRecord->enqueuedTimeUtc = (char*)json_object_get_string(feedback_object, FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC);
-                                feedbackRecord->originalMessageId = (char*)json_object_get_string(feedback_object, FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID);
-                                feedbackRecord->correlationId = "";
-
-                                if (feedbackRecord->description == NULL)
-                                {
-                                    feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
-                                }
-                                else
-                                {
-                                    size_t j;
-                                    for (j = 0; feedbackRecord->description[j]; j++)
-                                    {
-                                        feedbackRecord->description[j] = (char)tolower(feedbackRecord->description[j]);
-                                    }
-
-                                    if (strcmp(feedbackRecord->description, "success") == 0)
-                                    {
-                                        feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS;
-                                    }
-                                    else if (strcmp(feedbackRecord->description, "expired") == 0)
-                                    {
-                                        feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED;
-                                    }
-                                    else if (strcmp(feedbackRecord->description, "deliverycountexceeded") == 0)
-                                    {
-                                        feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_DELIVER_COUNT_EXCEEDED;
-                                    }
-                                    else if (strcmp(feedbackRecord->description, "rejected") == 0)
-                                    {
-                                        feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_REJECTED;
-                                    }
-                                    else
-                                    {
-                                        feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
-                                    }
-                                }
-                                if (singlylinkedlist_add(feedbackBatch->feedbackRecordList, feedbackRecord) == NULL)
-                                {
-                                    LogError("singlylinkedlist_add failed");
-                                    free(feedbackRecord);
-                                }
-                            }
-                        }
-                    }
-                    feedbackBatch->lockToken = "";
-                    feedbackBatch->userId = "";
-
-                    if (isLoopFailed)
-                    {
-                        LogError("Failed to read feedback records");
-                        result = messaging_delivery_rejected("Rejected due to failure reading AMQP message", "Failed to read feedback records");
-                    }
-                    else
-                    {
-                        if (messagingData->callback_data->feedbackMessageCallback != NULL)
-                        {
-                            /*Codes_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-                            (messagingData->callback_data->feedbackMessageCallback)(messagingData->callback_data->feedbackUserContext, feedbackBatch);
-                        }
-                        result = messaging_delivery_accepted();
-                    }
-
-                    /*Codes_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-                    LIST_ITEM_HANDLE feedbackRecord = singlylinkedlist_get_head_item(feedbackBatch->feedbackRecordList);
-                    while (feedbackRecord != NULL)
-                    {
-                        IOTHUB_SERVICE_FEEDBACK_RECORD* feedback = (IOTHUB_SERVICE_FEEDBACK_RECORD*)singlylinkedlist_item_get_value(feedbackRecord);
-                        feedbackRecord = singlylinkedlist_get_next_item(feedbackRecord);
-                        free(feedback);
-                    }
-                    singlylinkedlist_destroy(feedbackBatch->feedbackRecordList);
-                    free(feedbackBatch);
+                    result = deliverFeedbackBatch(messagingData);
                 }
             }
         }
-        json_array_clear(feedback_array);
-        json_value_free(root_value);
     }
     return result;
 }
@@ -967,11 +1047,11 @@ IOTHUB_MESSAGING_HANDLE IoTHubMessaging_LL_Create(IOTHUB_SERVICE_CLIENT_AUTH_HAN
             {
                 /*Codes_SRS_IOTHUBMESSAGING_12_076: [ If create successfull IoTHubMessaging_LL_Create shall save the callback data return the valid messaging handle ] */
                 callback_data->openCompleteCompleteCallback = NULL;
-                callback_data->sendCompleteCallback = NULL;
                 callback_data->feedbackMessageCallback = NULL;
+                callback_data->feedbackRecordCallback = NULL;
                 callback_data->openUserContext = NULL;
-                callback_data->sendUserContext = NULL;
                 callback_data->feedbackUserContext = NULL;
+                callback_data->feedbackRecordUserContext = NULL;
 
                 result->callback_data = callback_data;
             }
@@ -995,6 +1075,8 @@ void IoTHubMessaging_LL_Destroy(IOTHUB_MESSAGING_HANDLE messagingHandle)
         free(messHandle->sharedAccessKey);
         free(messHandle->keyName);
         free(messHandle->trusted_cert);
+        free(messHandle->feedbackBuffer);
+        free(messHandle->feedbackRecords);
         free(messHandle);
     }
 }
@@ -1449,6 +1531,26 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetFeedbackMessageCallback(IOTHUB_MES
     return result;
 }
 
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetFeedbackRecordCallback(IOTHUB_MESSAGING_HANDLE messagingHandle, IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK feedbackRecordReceivedCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    /*Codes_SRS_IOTHUBMESSAGING_02_039: [ If messagingHandle is NULL then IoTHubMessaging_LL_SetFeedbackRecordCallback shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    if (messagingHandle == NULL)
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_040: [ IoTHubMessaging_LL_SetFeedbackRecordCallback shall save feedbackRecordReceivedCallback and userContextCallback and return IOTHUB_MESSAGING_OK. ]*/
+        messagingHandle->callback_data->feedbackRecordCallback = feedbackRecordReceivedCallback;
+        messagingHandle->callback_data->feedbackRecordUserContext = userContextCallback;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
+
 
 IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* deviceId, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback, void* userContextCallback)
 {
@@ -1483,6 +1585,12 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagin
         LogError("Messaging is not opened - call IoTHubMessaging_LL_Open to open");
         result = IOTHUB_MESSAGING_ERROR;
     }
+    /*Codes_SRS_IOTHUBMESSAGING_02_002: [ If maxInFlightSends is not 0 and maxInFlightSends sends are already waiting for their IoTHubMessaging_LL_SendMessageComplete then IoTHubMessaging_LL_Send shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    else if ((messagingHandle->maxInFlightSends != 0) && (messagingHandle->inFlightSendCount >= messagingHandle->maxInFlightSends))
+    {
+        LogError("there are already %lu sends in flight", (unsigned long)messagingHandle->inFlightSendCount);
+        result = IOTHUB_MESSAGING_ERROR;
+    }
     /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message properties to the given message properties by calling message_set_properties ] */
     else if ((deviceDestinationString = createDeviceDestinationString(deviceId, moduleId)) == NULL)
     {
@@ -1551,21 +1659,38 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagin
                 }
                 else
                 {
-                    messagingHandle->callback_data->sendCompleteCallback = sendCompleteCallback;
-                    messagingHandle->callback_data->sendUserContext = userContextCallback;
+                    SEND_COMPLETE_CONTEXT* sendContext;
 
-                    /*Codes_SRS_IOTHUBMESSAGING_12_039: [ IoTHubMessaging_LL_SendMessage shall call uAMQP messagesender_send with the created message with IoTHubMessaging_LL_SendMessageComplete callback by which IoTHubMessaging is notified of completition of send ] */
-                    if (messagesender_send_async(messagingHandle->message_sender, amqpMessage, IoTHubMessaging_LL_SendMessageComplete, messagingHandle, 0) == NULL)
+                    /*Codes_SRS_IOTHUBMESSAGING_02_003: [ IoTHubMessaging_LL_Send shall allocate a context holding messagingHandle, sendCompleteCallback and userContextCallback and pass it to messagesender_send_async, so sends that are in flight at the same time each complete with their own callback and context. ]*/
+                    if ((sendContext = (SEND_COMPLETE_CONTEXT*)malloc(sizeof(SEND_COMPLETE_CONTEXT))) == NULL)
                     {
-                        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                        LogError("Could not set outgoing window.");
-                        message_destroy(amqpMessage);
+                        /*Codes_SRS_IOTHUBMESSAGING_02_004: [ If allocating the context fails then IoTHubMessaging_LL_Send shall return IOTHUB_MESSAGING_ERROR. ]*/
+                        LogError("Could not allocate the send complete context.");
                         result = IOTHUB_MESSAGING_ERROR;
                     }
                     else
                     {
-                        /*Codes_SRS_IOTHUBMESSAGING_12_041: [ If all uAMQP call return 0 then IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_OK  ] */
-                        result = IOTHUB_MESSAGING_OK;
+                        sendContext->messagingData = messagingHandle;
+                        sendContext->sendCompleteCallback = sendCompleteCallback;
+                        sendContext->sendUserContext = userContextCallback;
+
+                        /*counted before the call, uAMQP is allowed to complete the send from within messagesender_send_async*/
+                        messagingHandle->inFlightSendCount++;
+
+                        /*Codes_SRS_IOTHUBMESSAGING_12_039: [ IoTHubMessaging_LL_SendMessage shall call uAMQP messagesender_send with the created message with IoTHubMessaging_LL_SendMessageComplete callback by which IoTHubMessaging is notified of completition of send ] */
+                        if (messagesender_send_async(messagingHandle->message_sender, amqpMessage, IoTHubMessaging_LL_SendMessageComplete, sendContext, 0) == NULL)
+                        {
+                            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+                            LogError("Could not send the message.");
+                            messagingHandle->inFlightSendCount--;
+                            free(sendContext);
+                            result = IOTHUB_MESSAGING_ERROR;
+                        }
+                        else
+                        {
+                            /*Codes_SRS_IOTHUBMESSAGING_12_041: [ If all uAMQP call return 0 then IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_OK  ] */
+                            result = IOTHUB_MESSAGING_OK;
+                        }
                     }
                 }
                 message_destroy(amqpMessage);
@@ -1578,6 +1703,267 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagin
 }
 
 
+static int createBatchTemplateMessage(IOTHUB_MESSAGE_HANDLE message, MESSAGE_HANDLE* amqpMessage, PROPERTIES_HANDLE* amqpProperties)
+{
+    int result;
+    unsigned const char* messageContent;
+    size_t messageContentSize;
+    BINARY_DATA binary_data;
+
+    *amqpProperties = NULL;
+
+    if (getMessageContentAndSize(message, &messageContent, &messageContentSize) != 0)
+    {
+        LogError("Failed getting the message content and message size from IOTHUB_MESSAGE_HANDLE instance.");
+        result = __FAILURE__;
+    }
+    else if ((*amqpMessage = message_create()) == NULL)
+    {
+        LogError("Could not create a message.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        binary_data.bytes = messageContent;
+        binary_data.length = messageContentSize;
+
+        if (message_add_body_amqp_data(*amqpMessage, binary_data) != 0)
+        {
+            LogError("Failed setting the body of the uAMQP message.");
+            result = __FAILURE__;
+        }
+        else if (message_get_properties(*amqpMessage, amqpProperties) != 0)
+        {
+            LogError("Failed to get properties map from uAMQP message.");
+            result = __FAILURE__;
+        }
+        else if (*amqpProperties == NULL && (*amqpProperties = properties_create()) == NULL)
+        {
+            LogError("Failed to create properties map for uAMQP message.");
+            result = __FAILURE__;
+        }
+        else if (setMessageId(message, *amqpProperties) != 0)
+        {
+            LogError("Failed to set uampq messageId.");
+            result = __FAILURE__;
+        }
+        else if (setCorrelationId(message, *amqpProperties) != 0)
+        {
+            LogError("Failed to set uampq correlationId.");
+            result = __FAILURE__;
+        }
+        else if (addApplicationPropertiesToAMQPMessage(message, *amqpMessage) != 0)
+        {
+            LogError("Failed setting application properties of the uAMQP message.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        if (result != 0)
+        {
+            if (*amqpProperties != NULL)
+            {
+                properties_destroy(*amqpProperties);
+                *amqpProperties = NULL;
+            }
+            message_destroy(*amqpMessage);
+        }
+    }
+    return result;
+}
+
+static int sendBatchItem(SEND_BATCH_CONTEXT* batch, size_t index, MESSAGE_HANDLE amqpMessage, PROPERTIES_HANDLE amqpProperties, const char* deviceDestinationString)
+{
+    int result;
+    AMQP_VALUE to_amqp_value;
+
+    if ((to_amqp_value = amqpvalue_create_string(deviceDestinationString)) == NULL)
+    {
+        LogError("Could not create properties for message - amqpvalue_create_string");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_016: [ For every device IoTHubMessaging_LL_SendBatch shall only replace the TO property of the shared message by calling properties_set_to and message_set_properties. ]*/
+        if (properties_set_to(amqpProperties, to_amqp_value) != 0)
+        {
+            LogError("Could not create properties for message - properties_set_to failed");
+            result = __FAILURE__;
+        }
+        else if (message_set_properties(amqpMessage, amqpProperties) != 0)
+        {
+            LogError("Failed to set properties map on uAMQP message.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            batch->items[index].batch = batch;
+            batch->pendingCount++;
+            batch->messagingData->inFlightSendCount++;
+
+            /*Codes_SRS_IOTHUBMESSAGING_02_017: [ IoTHubMessaging_LL_SendBatch shall call messagesender_send_async with the shared message, IoTHubMessaging_LL_SendBatchMessageComplete and the context of the device. ]*/
+            if (messagesender_send_async(batch->messagingData->message_sender, amqpMessage, IoTHubMessaging_LL_SendBatchMessageComplete, &batch->items[index], 0) == NULL)
+            {
+                LogError("Could not send the message.");
+                batch->pendingCount--;
+                batch->messagingData->inFlightSendCount--;
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+        amqpvalue_destroy(to_amqp_value);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SendBatch(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* const* deviceIds, size_t deviceIdCount, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_BATCH_COMPLETE_CALLBACK sendBatchCompleteCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+    size_t maxDeviceIdLength = 0;
+    size_t i = 0;
+
+    if (deviceIds != NULL)
+    {
+        for (i = 0; i < deviceIdCount; i++)
+        {
+            if (deviceIds[i] == NULL)
+            {
+                break;
+            }
+            else if (strlen(deviceIds[i]) > maxDeviceIdLength)
+            {
+                maxDeviceIdLength = strlen(deviceIds[i]);
+            }
+        }
+    }
+
+    /*Codes_SRS_IOTHUBMESSAGING_02_010: [ If messagingHandle, deviceIds or message is NULL, deviceIdCount is 0 or any of the deviceIds is NULL then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    if ((messagingHandle == NULL) || (deviceIds == NULL) || (deviceIdCount == 0) || (message == NULL))
+    {
+        LogError("Invalid argument messagingHandle: %p deviceIds: %p deviceIdCount: %lu message: %p", messagingHandle, deviceIds, (unsigned long)deviceIdCount, message);
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else if (i != deviceIdCount)
+    {
+        LogError("deviceIds[%lu] is NULL", (unsigned long)i);
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    /*Codes_SRS_IOTHUBMESSAGING_02_011: [ If the messaging is not opened then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    else if (messagingHandle->isOpened == 0)
+    {
+        LogError("Messaging is not opened - call IoTHubMessaging_LL_Open to open");
+        result = IOTHUB_MESSAGING_ERROR;
+    }
+    /*Codes_SRS_IOTHUBMESSAGING_02_012: [ If maxInFlightSends is not 0 and the batch would take the number of sends in flight over it then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    else if ((messagingHandle->maxInFlightSends != 0) && ((messagingHandle->inFlightSendCount >= messagingHandle->maxInFlightSends) || (deviceIdCount > messagingHandle->maxInFlightSends - messagingHandle->inFlightSendCount)))
+    {
+        LogError("a batch of %lu sends does not fit, %lu sends are already in flight", (unsigned long)deviceIdCount, (unsigned long)messagingHandle->inFlightSendCount);
+        result = IOTHUB_MESSAGING_ERROR;
+    }
+    else
+    {
+        SEND_BATCH_CONTEXT* batch;
+        size_t deviceDestinationLength = strlen(AMQP_ADDRESS_PATH_FMT) + maxDeviceIdLength + 1;
+        char* deviceDestinationString;
+
+        /*Codes_SRS_IOTHUBMESSAGING_02_013: [ IoTHubMessaging_LL_SendBatch shall allocate the batch context, one context and one result per device and a single buffer large enough for the address of any of the devices. ]*/
+        if ((batch = (SEND_BATCH_CONTEXT*)malloc(sizeof(SEND_BATCH_CONTEXT))) == NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_02_014: [ If any allocation fails then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+            LogError("Could not allocate the batch context.");
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else if ((batch->items = (SEND_BATCH_ITEM*)malloc(deviceIdCount * sizeof(SEND_BATCH_ITEM))) == NULL)
+        {
+            LogError("Could not allocate the batch items.");
+            free(batch);
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else if ((batch->results = (IOTHUB_MESSAGING_RESULT*)malloc(deviceIdCount * sizeof(IOTHUB_MESSAGING_RESULT))) == NULL)
+        {
+            LogError("Could not allocate the batch results.");
+            free(batch->items);
+            free(batch);
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else if ((deviceDestinationString = (char*)malloc(deviceDestinationLength)) == NULL)
+        {
+            LogError("Could not create device destination string.");
+            destroySendBatch(batch);
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else
+        {
+            MESSAGE_HANDLE amqpMessage;
+            PROPERTIES_HANDLE amqpProperties;
+
+            /*Codes_SRS_IOTHUBMESSAGING_02_015: [ IoTHubMessaging_LL_SendBatch shall build the uAMQP message body, message id, correlation id and application properties once for the whole batch. ]*/
+            if (createBatchTemplateMessage(message, &amqpMessage, &amqpProperties) != 0)
+            {
+                /*Codes_SRS_IOTHUBMESSAGING_02_014: [ If any allocation fails then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+                LogError("Could not create the message shared by the batch.");
+                destroySendBatch(batch);
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else
+            {
+                size_t sentCount = 0;
+
+                batch->messagingData = messagingHandle;
+                batch->sendBatchCompleteCallback = sendBatchCompleteCallback;
+                batch->sendBatchUserContext = userContextCallback;
+                batch->deviceIdCount = deviceIdCount;
+                /*held by IoTHubMessaging_LL_SendBatch so the batch cannot complete while the sends are still being queued*/
+                batch->pendingCount = 1;
+
+                for (i = 0; i < deviceIdCount; i++)
+                {
+                    batch->results[i] = IOTHUB_MESSAGING_ERROR;
+
+                    if (snprintf(deviceDestinationString, deviceDestinationLength, AMQP_ADDRESS_PATH_FMT, deviceIds[i]) < 0)
+                    {
+                        /*Codes_SRS_IOTHUBMESSAGING_02_018: [ If sending to a device fails then its result shall be IOTHUB_MESSAGING_ERROR and IoTHubMessaging_LL_SendBatch shall continue with the next device. ]*/
+                        LogError("snprintf failed for the destination of %s", deviceIds[i]);
+                    }
+                    else if (sendBatchItem(batch, i, amqpMessage, amqpProperties, deviceDestinationString) != 0)
+                    {
+                        /*Codes_SRS_IOTHUBMESSAGING_02_018: [ If sending to a device fails then its result shall be IOTHUB_MESSAGING_ERROR and IoTHubMessaging_LL_SendBatch shall continue with the next device. ]*/
+                        LogError("Could not send to %s", deviceIds[i]);
+                    }
+                    else
+                    {
+                        sentCount++;
+                    }
+                }
+
+                if (sentCount == 0)
+                {
+                    /*Codes_SRS_IOTHUBMESSAGING_02_019: [ If no device could be sent to then IoTHubMessaging_LL_SendBatch shall free the batch, shall not call sendBatchCompleteCallback and shall return IOTHUB_MESSAGING_ERROR. Otherwise it shall return IOTHUB_MESSAGING_OK. ]*/
+                    LogError("None of the %lu sends of the batch could be started", (unsigned long)deviceIdCount);
+                    destroySendBatch(batch);
+                    result = IOTHUB_MESSAGING_ERROR;
+                }
+                else
+                {
+                    releaseSendBatch(batch);
+                    result = IOTHUB_MESSAGING_OK;
+                }
+
+                properties_destroy(amqpProperties);
+                message_destroy(amqpMessage);
+            }
+            free(deviceDestinationString);
+        }
+    }
+    return result;
+}
+
 void IoTHubMessaging_LL_DoWork(IOTHUB_MESSAGING_HANDLE messagingHandle)
 {
     /*Codes_SRS_IOTHUBMESSAGING_12_045: [ IoTHubMessaging_LL_DoWork shall verify if uAMQP transport has been initialized and if it is not then return immediately ] */
@@ -1590,6 +1976,44 @@ void IoTHubMessaging_LL_DoWork(IOTHUB_MESSAGING_HANDLE messagingHandle)
     }
 }
 
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetMaxInFlightSends(IOTHUB_MESSAGING_HANDLE messagingHandle, size_t maxInFlightSends)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    /*Codes_SRS_IOTHUBMESSAGING_02_001: [ If messagingHandle is NULL then IoTHubMessaging_LL_SetMaxInFlightSends shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    if (messagingHandle == NULL)
+    {
+        LogError("Input parameter messagingHandle cannot be NULL");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_008: [ IoTHubMessaging_LL_SetMaxInFlightSends shall save maxInFlightSends and return IOTHUB_MESSAGING_OK. 0 means there is no limit, which is the default. ]*/
+        messagingHandle->maxInFlightSends = maxInFlightSends;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_GetInFlightSendCount(IOTHUB_MESSAGING_HANDLE messagingHandle, size_t* inFlightSendCount)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    /*Codes_SRS_IOTHUBMESSAGING_02_055: [ If messagingHandle or inFlightSendCount is NULL then IoTHubMessaging_LL_GetInFlightSendCount shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    if ((messagingHandle == NULL) || (inFlightSendCount == NULL))
+    {
+        LogError("Invalid argument messagingHandle: %p inFlightSendCount: %p", messagingHandle, inFlightSendCount);
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_02_056: [ IoTHubMessaging_LL_GetInFlightSendCount shall set inFlightSendCount to the number of sends waiting for IoTHubMessaging_LL_SendMessageComplete and return IOTHUB_MESSAGING_OK. ]*/
+        *inFlightSendCount = messagingHandle->inFlightSendCount;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
+
 IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetTrustedCert(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* trusted_cert)
 {
     IOTHUB_MESSAGING_RESULT result;
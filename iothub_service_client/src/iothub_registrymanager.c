@@ -10,12 +10,14 @@
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
 
 #include "parson.h"
 #include "iothub_registrymanager.h"
 #include "iothub_sc_version.h"
+#include "iothub_sc_query.h"
 
 #define IOTHUB_DEVICE_EX_VERSION_LATEST IOTHUB_DEVICE_EX_VERSION_1
 #define IOTHUB_REGISTRY_DEVICE_CREATE_EX_VERSION_LATEST IOTHUB_REGISTRY_DEVICE_CREATE_EX_VERSION_1
@@ -31,7 +33,10 @@
     IOTHUB_REQUEST_UPDATE,            \
     IOTHUB_REQUEST_DELETE,            \
     IOTHUB_REQUEST_GET_DEVICE_LIST,   \
-    IOTHUB_REQUEST_GET_STATISTICS     \
+    IOTHUB_REQUEST_GET_STATISTICS,    \
+    IOTHUB_REQUEST_QUERY,             \
+    IOTHUB_REQUEST_BULK,              \
+    IOTHUB_REQUEST_JOB                \
 
 DEFINE_ENUM(IOTHUB_REQUEST_MODE, IOTHUB_REQUEST_MODE_VALUES);
 
@@ -52,10 +57,13 @@ DEFINE_ENUM_STRINGS(IOTHUB_REGISTRYMANAGER_AUTH_METHOD, IOTHUB_REGISTRYMANAGER_A
 #define  HTTP_HEADER_VAL_IFMATCH  "*"
 
 static size_t IOTHUB_DEVICES_MAX_REQUEST = 1000;
+static size_t IOTHUB_BULK_DEVICES_MAX_REQUEST = 100;
+#define IOTHUB_BULK_DEVICES_MAX_CONCURRENT_REQUESTS 16
 
 static const char* DEVICE_JSON_KEY_DEVICE_NAME = "deviceId";
 static const char* DEVICE_JSON_KEY_MODULE_NAME = "moduleId";
 static const char* DEVICE_JSON_KEY_DEVICE_AUTH_TYPE = "authentication.type";
+static const char* DEVICE_JSON_KEY_DEVICE_QUERY_AUTH_TYPE = "authenticationType";
 static const char* DEVICE_JSON_KEY_DEVICE_AUTH_SAS = "sas";
 static const char* DEVICE_JSON_KEY_DEVICE_AUTH_SELF_SIGNED = "selfSigned";
 static const char* DEVICE_JSON_KEY_DEVICE_AUTH_CERTIFICATE_AUTHORITY = "certificateAuthority";
@@ -101,6 +109,39 @@ static const char* RELATIVE_PATH_MODULE_FMT_CRUD = "/devices/%s/modules/%s?%s";
 static const char* RELATIVE_PATH_FMT_LIST = "/devices/?top=%s&%s";
 static const char* RELATIVE_PATH_FMT_STAT = "/statistics/devices?%s";
 static const char* RELATIVE_PATH_FMT_MODULE_LIST = "/devices/%s/modules?%s";
+static const char* RELATIVE_PATH_FMT_QUERY = "/devices/query?%s";
+static const char* RELATIVE_PATH_FMT_BULK = "/devices?%s";
+static const char* RELATIVE_PATH_FMT_JOB_CREATE = "/jobs/create?%s";
+static const char* RELATIVE_PATH_FMT_JOB = "/jobs/%s?%s";
+
+static const char* QUERY_BODY_DEVICES = "{\"query\":\"SELECT * FROM devices\"}";
+static const char* QUERY_BODY_MODULES = "{\"query\":\"SELECT * FROM devices.modules\"}";
+
+static const char* BULK_IMPORT_MODE_CREATE = "create";
+static const char* BULK_IMPORT_MODE_UPDATE = "update";
+static const char* BULK_IMPORT_MODE_UPDATE_IF_MATCH_ETAG = "updateIfMatchETag";
+static const char* BULK_IMPORT_MODE_DELETE = "delete";
+static const char* BULK_IMPORT_MODE_DELETE_IF_MATCH_ETAG = "deleteIfMatchETag";
+static const char* BULK_JSON_KEY_ERRORS = "errors";
+static const char* BULK_JSON_KEY_DEVICE_ID = "deviceId";
+static const char* BULK_JSON_KEY_ERROR_CODE = "errorCode";
+static const char* BULK_ERROR_CODE_DEVICE_EXISTS = "DeviceAlreadyExists";
+static const char* BULK_ERROR_CODE_DEVICE_NOT_FOUND = "DeviceNotFound";
+
+static const char* JOB_JSON_KEY_JOB_ID = "jobId";
+static const char* JOB_JSON_KEY_TYPE = "type";
+static const char* JOB_JSON_KEY_STATUS = "status";
+static const char* JOB_JSON_KEY_PROGRESS = "progress";
+static const char* JOB_JSON_KEY_START_TIME = "startTimeUtc";
+static const char* JOB_JSON_KEY_END_TIME = "endTimeUtc";
+static const char* JOB_JSON_KEY_FAILURE_REASON = "failureReason";
+static const char* JOB_JSON_VALUE_EXPORT = "export";
+static const char* JOB_JSON_VALUE_IMPORT = "import";
+static const char* JOB_JSON_VALUE_ENQUEUED = "enqueued";
+static const char* JOB_JSON_VALUE_RUNNING = "running";
+static const char* JOB_JSON_VALUE_COMPLETED = "completed";
+static const char* JOB_JSON_VALUE_FAILED = "failed";
+static const char* JOB_JSON_VALUE_CANCELLED = "cancelled";
 
 typedef enum {IOTHUB_REGISTRYMANAGER_MODEL_TYPE_DEVICE, IOTHUB_REGISTRYMANAGER_MODEL_TYPE_MODULE} IOTHUB_REGISTRYMANAGER_MODEL_TYPE;
 
@@ -135,6 +176,16 @@ typedef struct IOTHUB_DEVICE_OR_MODULE_TAG
     const char* managedBy;
 } IOTHUB_DEVICE_OR_MODULE;
 
+typedef struct DEVICE_OR_MODULE_ENUMERATION_TAG
+{
+    IOTHUB_REGISTRYMANAGER_MODEL_TYPE type;
+    int struct_version;
+    IOTHUB_REGISTRYMANAGER_DEVICE_ENUM_CALLBACK deviceCallback;
+    IOTHUB_REGISTRYMANAGER_MODULE_ENUM_CALLBACK moduleCallback;
+    void* context;
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+} DEVICE_OR_MODULE_ENUMERATION;
+
 typedef struct IOTHUB_REGISTRY_DEVICE_OR_MODULE_CREATE_TAG
 {
     IOTHUB_REGISTRYMANAGER_MODEL_TYPE type;
@@ -1219,84 +1270,32 @@ static HTTP_HEADERS_HANDLE createHttpHeader(IOTHUB_REQUEST_MODE iotHubRequestMod
     return httpHeader;
 }
 
-static STRING_HANDLE createUriPath(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle)
-{
-    if (registryManagerHandle->deviceId != NULL)
-    {
-        return STRING_construct_sprintf("%s%%2Fdevices%%2F%s", registryManagerHandle->hostname, registryManagerHandle->deviceId);
-    }
-    else
-    {
-        return STRING_construct(registryManagerHandle->hostname);
-    }
-}
-
 static IOTHUB_REGISTRYMANAGER_RESULT sendHttpRequestCRUD(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, IOTHUB_REQUEST_MODE iotHubRequestMode, const char* deviceName, const char* moduleId, BUFFER_HANDLE deviceJsonBuffer, size_t numberOfDevices, BUFFER_HANDLE responseBuffer)
 {
     IOTHUB_REGISTRYMANAGER_RESULT result;
 
-    STRING_HANDLE uriResource = NULL;
-    STRING_HANDLE accessKey = NULL;
-    STRING_HANDLE keyName = NULL;
-    HTTPAPIEX_SAS_HANDLE httpExApiSasHandle = NULL;
-    HTTPAPIEX_HANDLE httpExApiHandle = NULL;
     HTTP_HEADERS_HANDLE httpHeader = NULL;
 
-    if ((uriResource = createUriPath(registryManagerHandle)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_099: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_103: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
-        LogError("STRING_construct failed for uriResource");
-        result = IOTHUB_REGISTRYMANAGER_ERROR;
-    }
-    else if ((accessKey = STRING_construct(registryManagerHandle->sharedAccessKey)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_099: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_103: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
-        LogError("STRING_construct failed for accessKey");
-        result = IOTHUB_REGISTRYMANAGER_ERROR;
-    }
-    else if ((registryManagerHandle->keyName != NULL) && ((keyName = STRING_construct(registryManagerHandle->keyName)) == NULL))
-    {
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_099: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_103: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
-        LogError("STRING_construct failed for keyName");
-        result = IOTHUB_REGISTRYMANAGER_ERROR;
-    }
     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_015: [ IoTHubRegistryManager_CreateDevice shall create an HTTP PUT request using the following HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_027: [ IoTHubRegistryManager_GetDevice shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_043: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the created JSON ] */
     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_044: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the createdfollowing HTTP headers : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_054: [ IoTHubRegistryManager_DeleteDevice shall add the following headers to the created HTTP GET request : authorization=sasToken, Request-Id=1001, Accept=application/json, Content-Type=application/json, charset=utf-8 ] */
-    else if ((httpHeader = createHttpHeader(iotHubRequestMode)) == NULL)
+    if ((httpHeader = createHttpHeader(iotHubRequestMode)) == NULL)
     {
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_019: [ If any of the HTTPAPI call fails IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_104: [ If any of the HTTPAPI call fails IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
         LogError("HttpHeader creation failed");
         result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
     }
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_016: [ IoTHubRegistryManager_CreateDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_028: [ IoTHubRegistryManager_GetDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    else if ((httpExApiSasHandle = HTTPAPIEX_SAS_Create(accessKey, uriResource, keyName)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_019: [ If any of the HTTPAPI call fails IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_104: [ If any of the HTTPAPI call fails IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
-        LogError("HTTPAPIEX_SAS_Create failed");
-        result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
-    }
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_017: [ IoTHubRegistryManager_CreateDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_029: [ IoTHubRegistryManager_GetDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    else if ((httpExApiHandle = HTTPAPIEX_Create(registryManagerHandle->hostname)) == NULL)
-    {
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_019: [ If any of the HTTPAPI call fails IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_104: [ If any of the HTTPAPI call fails IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
-        LogError("HTTPAPIEX_Create failed");
-        result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
-    }
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_016: [ IoTHubRegistryManager_CreateDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_028: [ IoTHubRegistryManager_GetDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_017: [ IoTHubRegistryManager_CreateDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_029: [ IoTHubRegistryManager_GetDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
     else
     {
         HTTPAPI_REQUEST_TYPE httpApiRequestType = HTTPAPI_REQUEST_GET;
@@ -1336,14 +1335,14 @@ static IOTHUB_REGISTRYMANAGER_RESULT sendHttpRequestCRUD(IOTHUB_REGISTRYMANAGER_
                 result = IOTHUB_REGISTRYMANAGER_ERROR;
             }
             /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_014: [ IoTHubRegistryManager_CreateDevice shall create an HTTP PUT request using the created JSON ] */
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_018: [ IoTHubRegistryManager_CreateDevice shall execute the HTTP PUT request by calling HTTPAPIEX_ExecuteRequest ] */
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_030: [ IoTHubRegistryManager_GetDevice shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ] */
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling HTTPAPIEX_ExecuteRequest ] */
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
-            else if (HTTPAPIEX_SAS_ExecuteRequest(httpExApiSasHandle, httpExApiHandle, httpApiRequestType, relativePath, httpHeader, deviceJsonBuffer, &statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_018: [ IoTHubRegistryManager_CreateDevice shall execute the HTTP PUT request by calling IoTHubScConnectionPool_ExecuteRequest ] */
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_030: [ IoTHubRegistryManager_GetDevice shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ] */
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling IoTHubScConnectionPool_ExecuteRequest ] */
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
+            else if (IoTHubScConnectionPool_ExecuteRequest(registryManagerHandle->connectionPool, httpApiRequestType, relativePath, httpHeader, deviceJsonBuffer, &statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
             {
                 /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_019: [ If any of the HTTPAPI call fails IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
-                LogError("HTTPAPIEX_SAS_ExecuteRequest failed");
+                LogError("IoTHubScConnectionPool_ExecuteRequest failed");
                 result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
             }
             else
@@ -1382,11 +1381,6 @@ static IOTHUB_REGISTRYMANAGER_RESULT sendHttpRequestCRUD(IOTHUB_REGISTRYMANAGER_
     }
 
     HTTPHeaders_Free(httpHeader);
-    HTTPAPIEX_Destroy(httpExApiHandle);
-    HTTPAPIEX_SAS_Destroy(httpExApiSasHandle);
-    STRING_delete(keyName);
-    STRING_delete(accessKey);
-    STRING_delete(uriResource);
     return result;
 }
 
@@ -1397,6 +1391,7 @@ static void free_registrymanager_handle(IOTHUB_REGISTRYMANAGER *registryManager)
     free(registryManager->iothubSuffix);
     free(registryManager->sharedAccessKey);
     free(registryManager->deviceId);
+    IoTHubScConnectionPool_Destroy(registryManager->connectionPool);
     free(registryManager);
 }
 
@@ -1501,6 +1496,14 @@ IOTHUB_REGISTRYMANAGER_HANDLE IoTHubRegistryManager_Create(IOTHUB_SERVICE_CLIENT
                     free_registrymanager_handle(result);
                     result = NULL;
                 }
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_001: [ IoTHubRegistryManager_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ] */
+                else if ((result->connectionPool = IoTHubScConnectionPool_Clone(serviceClientAuth->connectionPool)) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubRegistryManager_Create shall do clean up and return NULL. ] */
+                    LogError("IoTHubScConnectionPool_Clone failed");
+                    free_registrymanager_handle(result);
+                    result = NULL;
+                }
             }
         }
     }
@@ -1521,6 +1524,8 @@ void IoTHubRegistryManager_Destroy(IOTHUB_REGISTRYMANAGER_HANDLE registryManager
         free(regManHandle->sharedAccessKey);
         free(regManHandle->keyName);
         free(regManHandle->deviceId);
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_003: [ IoTHubRegistryManager_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ] */
+        IoTHubScConnectionPool_Destroy(regManHandle->connectionPool);
         free(regManHandle);
     }
 }
@@ -1601,9 +1606,9 @@ static IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_CreateDeviceOrModule(
                 }
                 /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_014: [ IoTHubRegistryManager_CreateDevice shall create an HTTP PUT request using the created JSON ] */
                 /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_015: [ IoTHubRegistryManager_CreateDevice shall create an HTTP PUT request using the following HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
-                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_016: [ IoTHubRegistryManager_CreateDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_017: [ IoTHubRegistryManager_CreateDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_018: [ IoTHubRegistryManager_CreateDevice shall execute the HTTP PUT request by calling HTTPAPIEX_ExecuteRequest ] */
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_016: [ IoTHubRegistryManager_CreateDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_017: [ IoTHubRegistryManager_CreateDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_018: [ IoTHubRegistryManager_CreateDevice shall execute the HTTP PUT request by calling IoTHubScConnectionPool_ExecuteRequest ] */
                 else if ((result = sendHttpRequestCRUD(registryManagerHandle, IOTHUB_REQUEST_CREATE, deviceOrModuleCreateInfo->deviceId, deviceOrModuleCreateInfo->moduleId, deviceJsonBuffer, 0, responseBuffer)) == IOTHUB_REGISTRYMANAGER_ERROR)
                 {
                     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_019: [ If any of the HTTPAPI call fails IoTHubRegistryManager_CreateDevice shall fail and return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR ] */
@@ -1745,9 +1750,9 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetDeviceOrModule(IOTHUB_REG
         }
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_026: [ IoTHubRegistryManager_GetDevice shall create HTTP GET request URL using the given deviceId using the following format: url/devices/[deviceId]?api-version=2017-06-30  ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_027: [ IoTHubRegistryManager_GetDevice shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_028: [ IoTHubRegistryManager_GetDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_029: [ IoTHubRegistryManager_GetDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_030: [ IoTHubRegistryManager_GetDevice shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_028: [ IoTHubRegistryManager_GetDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_029: [ IoTHubRegistryManager_GetDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_030: [ IoTHubRegistryManager_GetDevice shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ] */
         else if ((result = sendHttpRequestCRUD(registryManagerHandle, IOTHUB_REQUEST_GET, deviceId, moduleId, NULL, 0, responseBuffer)) == IOTHUB_REGISTRYMANAGER_ERROR)
         {
             /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_031: [ If any of the HTTPAPI call fails IoTHubRegistryManager_GetDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
@@ -1901,9 +1906,9 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_UpdateDeviceOrModule(IOTHUB_
                 }
                 /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_043: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the created JSON ] */
                 /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_044: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the createdfollowing HTTP headers : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling HTTPAPIEX_ExecuteRequest ] */
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling IoTHubScConnectionPool_ExecuteRequest ] */
                 else if ((result = sendHttpRequestCRUD(registryManagerHandle, IOTHUB_REQUEST_UPDATE, deviceOrModuleUpdate->deviceId, deviceOrModuleUpdate->moduleId, deviceJsonBuffer, 0, responseBuffer)) == IOTHUB_REGISTRYMANAGER_ERROR)
                 {
                     /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_103: [ If any of the call fails during the HTTP creation IoTHubRegistryManager_UpdateDevice shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ] */
@@ -2009,9 +2014,9 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_DeleteDevice(IOTHUB_REGISTRY
     {
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_053: [ IoTHubRegistryManager_DeleteDevice shall create HTTP DELETE request URL using the given deviceId using the following format : url / devices / [deviceId] ? api - version  ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_054: [ IoTHubRegistryManager_DeleteDevice shall add the following headers to the created HTTP GET request : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_058: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_059: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is less or equal than 300 then return IOTHUB_REGISTRYMANAGER_OK ] */
         result = sendHttpRequestCRUD(registryManagerHandle, IOTHUB_REQUEST_DELETE, deviceId, NULL, NULL, 0, NULL);
@@ -2053,9 +2058,9 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetModuleOrDeviceList(IOTHUB
         }
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_062: [ IoTHubRegistryManager_GetDeviceList shall create HTTP GET request for numberOfDevices using the follwoing format: url/devices/?top=[numberOfDevices]&api-version ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_063: [ IoTHubRegistryManager_GetDeviceList shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_064: [ IoTHubRegistryManager_GetDeviceList shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_065: [ IoTHubRegistryManager_GetDeviceList shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_066: [ IoTHubRegistryManager_GetDeviceList shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_064: [ IoTHubRegistryManager_GetDeviceList shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_065: [ IoTHubRegistryManager_GetDeviceList shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_066: [ IoTHubRegistryManager_GetDeviceList shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_067: [ IoTHubRegistryManager_GetDeviceList shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_ERROR ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_068: [ IoTHubRegistryManager_GetDeviceList shall verify the received HTTP status code and if it is less or equal than 300 then try to parse the response JSON to deviceList ] */
         else if ((result = sendHttpRequestCRUD(registryManagerHandle, IOTHUB_REQUEST_GET_DEVICE_LIST, deviceId, NULL, NULL, numberOfDevices, responseBuffer)) == IOTHUB_REGISTRYMANAGER_ERROR)
@@ -2111,9 +2116,9 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetStatistics(IOTHUB_REGISTR
         }
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_075: [ IoTHubRegistryManager_GetStatistics shall create HTTP GET request for statistics using the following format: url/statistics/devices?api-version ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_076: [ IoTHubRegistryManager_GetStatistics shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_077: [ IoTHubRegistryManager_GetStatistics shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_078: [ IoTHubRegistryManager_GetStatistics shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_079: [ IoTHubRegistryManager_GetStatistics shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_077: [ IoTHubRegistryManager_GetStatistics shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_078: [ IoTHubRegistryManager_GetStatistics shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_079: [ IoTHubRegistryManager_GetStatistics shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_080: [ IoTHubRegistryManager_GetStatistics shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_ERROR ] */
         /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_081: [ IoTHubRegistryManager_GetStatistics shall verify the received HTTP status code and if it is less or equal than 300 then use the following parson APIs to parse the response JSON to registry statistics structure: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string ] */
         else if ((result = sendHttpRequestCRUD(registryManagerHandle, IOTHUB_REQUEST_GET_STATISTICS, NULL, NULL, NULL, 0, responseBuffer)) == IOTHUB_REGISTRYMANAGER_ERROR)
@@ -2286,3 +2291,1111 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetModuleList(IOTHUB_REGISTR
     return IoTHubRegistryManager_GetModuleOrDeviceList(registryManagerHandle, deviceId, IOTHUB_DEVICES_MAX_REQUEST, moduleList, IOTHUB_REGISTRYMANAGER_MODEL_TYPE_MODULE, module_version);
 }
 
+static IOTHUB_REGISTRYMANAGER_AUTH_METHOD getAuthMethodFromQueryString(const char* authType)
+{
+    IOTHUB_REGISTRYMANAGER_AUTH_METHOD result;
+
+    if (authType == NULL)
+    {
+        result = IOTHUB_REGISTRYMANAGER_AUTH_UNKNOWN;
+    }
+    else if (strcmp(authType, DEVICE_JSON_KEY_DEVICE_AUTH_SAS) == 0)
+    {
+        result = IOTHUB_REGISTRYMANAGER_AUTH_SPK;
+    }
+    else if (strcmp(authType, DEVICE_JSON_KEY_DEVICE_AUTH_SELF_SIGNED) == 0)
+    {
+        result = IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT;
+    }
+    else if (strcmp(authType, DEVICE_JSON_KEY_DEVICE_AUTH_CERTIFICATE_AUTHORITY) == 0)
+    {
+        result = IOTHUB_REGISTRYMANAGER_AUTH_X509_CERTIFICATE_AUTHORITY;
+    }
+    else if (strcmp(authType, DEVICE_JSON_KEY_DEVICE_AUTH_NONE) == 0)
+    {
+        result = IOTHUB_REGISTRYMANAGER_AUTH_NONE;
+    }
+    else
+    {
+        result = IOTHUB_REGISTRYMANAGER_AUTH_UNKNOWN;
+    }
+
+    return result;
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT deliverDeviceOrModuleJsonObject(JSON_Object* root_object, DEVICE_OR_MODULE_ENUMERATION* enumeration, bool* isStopped)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    IOTHUB_DEVICE_OR_MODULE deviceOrModule;
+
+    initializeDeviceOrModuleInfoMembers(&deviceOrModule);
+
+    if ((result = parseDeviceOrModuleJsonObject(root_object, &deviceOrModule)) == IOTHUB_REGISTRYMANAGER_OK)
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_010: [ Query results carry authenticationType instead of authentication.type, if authentication.type is missing the authentication method shall be taken from authenticationType. ]*/
+        if (deviceOrModule.authMethod == IOTHUB_REGISTRYMANAGER_AUTH_UNKNOWN)
+        {
+            deviceOrModule.authMethod = getAuthMethodFromQueryString(json_object_get_string(root_object, DEVICE_JSON_KEY_DEVICE_QUERY_AUTH_TYPE));
+        }
+
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_011: [ Every record shall be handed to the callback as soon as it is parsed, the structure and its members are only valid during the call and shall be freed when the callback returns. ]*/
+        if (enumeration->type == IOTHUB_REGISTRYMANAGER_MODEL_TYPE_DEVICE)
+        {
+            IOTHUB_DEVICE_EX device;
+            memset(&device, 0, sizeof(device));
+            device.version = IOTHUB_DEVICE_EX_VERSION_LATEST;
+            move_deviceOrModule_members_to_deviceEx(&deviceOrModule, &device);
+            *isStopped = (enumeration->deviceCallback(enumeration->context, &device) != 0);
+        }
+        else
+        {
+            IOTHUB_MODULE module;
+            memset(&module, 0, sizeof(module));
+            module.version = enumeration->struct_version;
+            move_deviceOrModule_members_to_module(&deviceOrModule, &module);
+            *isStopped = (enumeration->moduleCallback(enumeration->context, &module) != 0);
+        }
+    }
+
+    free_deviceOrModule_members(&deviceOrModule);
+    return result;
+}
+
+/*called by IoTHubScQuery_Execute for every record of a page, so only one record is ever held as a JSON tree*/
+static int onDeviceOrModuleQueryResult(void* context, const char* resultJson)
+{
+    DEVICE_OR_MODULE_ENUMERATION* enumeration = (DEVICE_OR_MODULE_ENUMERATION*)context;
+    bool isStopped = false;
+    JSON_Value* root_value;
+    JSON_Object* root_object;
+
+    if ((root_value = json_parse_string(resultJson)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_012: [ If a page is not a JSON array of objects then the enumeration shall stop and return IOTHUB_REGISTRYMANAGER_JSON_ERROR. ]*/
+        LogError("json_parse_string failed");
+        enumeration->result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+    }
+    else
+    {
+        if ((root_object = json_value_get_object(root_value)) == NULL)
+        {
+            LogError("json_value_get_object failed");
+            enumeration->result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+        }
+        else
+        {
+            enumeration->result = deliverDeviceOrModuleJsonObject(root_object, enumeration, &isStopped);
+        }
+        json_value_free(root_value);
+    }
+
+    return ((enumeration->result != IOTHUB_REGISTRYMANAGER_OK) || isStopped) ? 1 : 0;
+}
+
+static HTTP_HEADERS_HANDLE createQueryHttpHeader(void)
+{
+    return createHttpHeader(IOTHUB_REQUEST_QUERY);
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT enumerateDevicesOrModules(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, size_t pageSize, DEVICE_OR_MODULE_ENUMERATION* enumeration)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    const char* query = (enumeration->type == IOTHUB_REGISTRYMANAGER_MODEL_TYPE_DEVICE) ? QUERY_BODY_DEVICES : QUERY_BODY_MODULES;
+    BUFFER_HANDLE queryBuffer;
+    char relativePath[256];
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_005: [ IoTHubRegistryManager_EnumerateDevices shall create the query body and a single response buffer that is reused for every page. ]*/
+    if ((queryBuffer = BUFFER_create((const unsigned char*)query, strlen(query))) == NULL)
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_009: [ If any other call fails IoTHubRegistryManager_EnumerateDevices shall return IOTHUB_REGISTRYMANAGER_ERROR. ]*/
+        LogError("BUFFER_create failed for query");
+        result = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else
+    {
+        if (snprintf(relativePath, sizeof(relativePath), RELATIVE_PATH_FMT_QUERY, URL_API_VERSION) <= 0)
+        {
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_009: [ If any other call fails IoTHubRegistryManager_EnumerateDevices shall return IOTHUB_REGISTRYMANAGER_ERROR. ]*/
+            LogError("Failure creating relative path");
+            result = IOTHUB_REGISTRYMANAGER_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_006: [ For every page IoTHubRegistryManager_EnumerateDevices shall POST the query to url/devices/query?api-version by calling IoTHubScConnectionPool_ExecuteRequest, with the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. ]*/
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_008: [ IoTHubRegistryManager_EnumerateDevices shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_013: [ If the callback returns a non-zero value then IoTHubRegistryManager_EnumerateDevices shall stop without requesting further pages and return IOTHUB_REGISTRYMANAGER_OK. ]*/
+            switch (IoTHubScQuery_Execute(registryManagerHandle->connectionPool, HTTPAPI_REQUEST_POST, relativePath, createQueryHttpHeader, queryBuffer, pageSize, onDeviceOrModuleQueryResult, enumeration))
+            {
+            case IOTHUB_SC_QUERY_OK:
+                /*a record that could not be parsed stops the query the same way the callback does*/
+                result = enumeration->result;
+                break;
+            case IOTHUB_SC_QUERY_HTTPAPI_ERROR:
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_007: [ If the request fails IoTHubRegistryManager_EnumerateDevices shall return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR. ]*/
+                LogError("IoTHubScQuery_Execute failed to execute a request");
+                result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
+                break;
+            case IOTHUB_SC_QUERY_HTTP_STATUS_ERROR:
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_007: [ If the request fails IoTHubRegistryManager_EnumerateDevices shall return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR. ]*/
+                LogError("IoTHubScQuery_Execute received a failure status code");
+                result = IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR;
+                break;
+            case IOTHUB_SC_QUERY_JSON_ERROR:
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_012: [ If a page is not a JSON array of objects then the enumeration shall stop and return IOTHUB_REGISTRYMANAGER_JSON_ERROR. ]*/
+                LogError("query response is not a JSON array of objects");
+                result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+                break;
+            default:
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_009: [ If any other call fails IoTHubRegistryManager_EnumerateDevices shall return IOTHUB_REGISTRYMANAGER_ERROR. ]*/
+                LogError("IoTHubScQuery_Execute failed");
+                result = IOTHUB_REGISTRYMANAGER_ERROR;
+                break;
+            }
+        }
+        BUFFER_delete(queryBuffer);
+    }
+
+    return result;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_EnumerateDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, size_t pageSize, IOTHUB_REGISTRYMANAGER_DEVICE_ENUM_CALLBACK deviceCallback, void* context)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_004: [ If registryManagerHandle or deviceCallback is NULL, or pageSize is not between 1 and 1000, IoTHubRegistryManager_EnumerateDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (deviceCallback == NULL) || (pageSize == 0) || (pageSize > IOTHUB_DEVICES_MAX_REQUEST))
+    {
+        LogError("Invalid argument registryManagerHandle=%p deviceCallback=%p pageSize=%lu", registryManagerHandle, deviceCallback, (unsigned long)pageSize);
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    else
+    {
+        DEVICE_OR_MODULE_ENUMERATION enumeration;
+        enumeration.type = IOTHUB_REGISTRYMANAGER_MODEL_TYPE_DEVICE;
+        enumeration.struct_version = IOTHUB_DEVICE_EX_VERSION_LATEST;
+        enumeration.deviceCallback = deviceCallback;
+        enumeration.moduleCallback = NULL;
+        enumeration.context = context;
+        enumeration.result = IOTHUB_REGISTRYMANAGER_OK;
+
+        result = enumerateDevicesOrModules(registryManagerHandle, pageSize, &enumeration);
+    }
+    return result;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_EnumerateModules(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, size_t pageSize, int module_version, IOTHUB_REGISTRYMANAGER_MODULE_ENUM_CALLBACK moduleCallback, void* context)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_014: [ If registryManagerHandle or moduleCallback is NULL, or pageSize is not between 1 and 1000, IoTHubRegistryManager_EnumerateModules shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (moduleCallback == NULL) || (pageSize == 0) || (pageSize > IOTHUB_DEVICES_MAX_REQUEST))
+    {
+        LogError("Invalid argument registryManagerHandle=%p moduleCallback=%p pageSize=%lu", registryManagerHandle, moduleCallback, (unsigned long)pageSize);
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_015: [ If module_version is not a supported IOTHUB_MODULE version IoTHubRegistryManager_EnumerateModules shall return IOTHUB_REGISTRYMANAGER_INVALID_VERSION. ]*/
+    else if ((module_version < IOTHUB_MODULE_VERSION_1) || (module_version > IOTHUB_MODULE_VERSION_LATEST))
+    {
+        LogError("Invalid module version");
+        result = IOTHUB_REGISTRYMANAGER_INVALID_VERSION;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_016: [ IoTHubRegistryManager_EnumerateModules shall enumerate the query SELECT * FROM devices.modules exactly as IoTHubRegistryManager_EnumerateDevices enumerates SELECT * FROM devices. ]*/
+        DEVICE_OR_MODULE_ENUMERATION enumeration;
+        enumeration.type = IOTHUB_REGISTRYMANAGER_MODEL_TYPE_MODULE;
+        enumeration.struct_version = module_version;
+        enumeration.deviceCallback = NULL;
+        enumeration.moduleCallback = moduleCallback;
+        enumeration.context = context;
+        enumeration.result = IOTHUB_REGISTRYMANAGER_OK;
+
+        result = enumerateDevicesOrModules(registryManagerHandle, pageSize, &enumeration);
+    }
+    return result;
+}
+
+/*bodies of bulk and job requests are written straight into one buffer instead of going through a parson tree.
+  The writer runs twice: first with a NULL buffer to measure the body, then to fill it*/
+typedef struct JSON_WRITER_TAG
+{
+    char* buffer;
+    size_t length;
+} JSON_WRITER;
+
+typedef void(*JSON_WRITE_FUNCTION)(JSON_WRITER* writer, const void* context);
+
+static void writeJsonChars(JSON_WRITER* writer, const char* chars, size_t count)
+{
+    if (writer->buffer != NULL)
+    {
+        (void)memcpy(writer->buffer + writer->length, chars, count);
+    }
+    writer->length += count;
+}
+
+static void writeJsonRaw(JSON_WRITER* writer, const char* text)
+{
+    writeJsonChars(writer, text, strlen(text));
+}
+
+static void writeJsonString(JSON_WRITER* writer, const char* value)
+{
+    writeJsonChars(writer, "\"", 1);
+    while (*value != '\0')
+    {
+        if ((*value == '"') || (*value == '\\'))
+        {
+            writeJsonChars(writer, "\\", 1);
+            writeJsonChars(writer, value, 1);
+        }
+        else if ((unsigned char)*value < 0x20)
+        {
+            char escaped[7];
+            (void)snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)(unsigned char)*value);
+            writeJsonChars(writer, escaped, 6);
+        }
+        else
+        {
+            writeJsonChars(writer, value, 1);
+        }
+        value++;
+    }
+    writeJsonChars(writer, "\"", 1);
+}
+
+/*writes ,"name":"value" */
+static void writeJsonMember(JSON_WRITER* writer, const char* name, const char* value)
+{
+    writeJsonChars(writer, ",", 1);
+    writeJsonString(writer, name);
+    writeJsonChars(writer, ":", 1);
+    writeJsonString(writer, value);
+}
+
+static BUFFER_HANDLE createJsonBuffer(JSON_WRITE_FUNCTION writeFunction, const void* context)
+{
+    BUFFER_HANDLE result;
+    JSON_WRITER writer;
+
+    writer.buffer = NULL;
+    writer.length = 0;
+    writeFunction(&writer, context);
+
+    if ((writer.buffer = (char*)malloc(writer.length + 1)) == NULL)
+    {
+        LogError("Malloc failed for request body");
+        result = NULL;
+    }
+    else
+    {
+        writer.length = 0;
+        writeFunction(&writer, context);
+        writer.buffer[writer.length] = '\0';
+
+        if ((result = BUFFER_create((const unsigned char*)writer.buffer, writer.length)) == NULL)
+        {
+            LogError("BUFFER_create failed for request body");
+        }
+        free(writer.buffer);
+    }
+
+    return result;
+}
+
+/*sends a request whose outcome is decided by the caller from the status code*/
+static IOTHUB_REGISTRYMANAGER_RESULT sendRegistryHttpRequest(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, IOTHUB_REQUEST_MODE iotHubRequestMode, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, BUFFER_HANDLE requestBuffer, unsigned int* statusCode, BUFFER_HANDLE responseBuffer)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    HTTP_HEADERS_HANDLE httpHeader;
+
+    if ((httpHeader = createHttpHeader(iotHubRequestMode)) == NULL)
+    {
+        LogError("HttpHeader creation failed");
+        result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
+    }
+    else
+    {
+        if (IoTHubScConnectionPool_ExecuteRequest(registryManagerHandle->connectionPool, requestType, relativePath, httpHeader, requestBuffer, statusCode, NULL, responseBuffer) != HTTPAPIEX_OK)
+        {
+            LogError("IoTHubScConnectionPool_ExecuteRequest failed");
+            result = IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_REGISTRYMANAGER_OK;
+        }
+        HTTPHeaders_Free(httpHeader);
+    }
+
+    return result;
+}
+
+typedef struct BULK_DEVICES_CHUNK_TAG
+{
+    const IOTHUB_REGISTRY_BULK_DEVICE* devices;
+    size_t deviceCount;
+} BULK_DEVICES_CHUNK;
+
+typedef struct BULK_DEVICES_OPERATION_TAG
+{
+    IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle;
+    const IOTHUB_REGISTRY_BULK_DEVICE* devices;
+    size_t deviceCount;
+    IOTHUB_REGISTRYMANAGER_RESULT* results;
+    LOCK_HANDLE lock;
+    size_t nextChunkStart;
+} BULK_DEVICES_OPERATION;
+
+static const char* getBulkImportModeString(IOTHUB_REGISTRY_BULK_MODE mode)
+{
+    const char* result;
+
+    switch (mode)
+    {
+        case IOTHUB_REGISTRY_BULK_CREATE:
+            result = BULK_IMPORT_MODE_CREATE;
+            break;
+        case IOTHUB_REGISTRY_BULK_UPDATE:
+            result = BULK_IMPORT_MODE_UPDATE;
+            break;
+        case IOTHUB_REGISTRY_BULK_UPDATE_IF_MATCH_ETAG:
+            result = BULK_IMPORT_MODE_UPDATE_IF_MATCH_ETAG;
+            break;
+        case IOTHUB_REGISTRY_BULK_DELETE:
+            result = BULK_IMPORT_MODE_DELETE;
+            break;
+        case IOTHUB_REGISTRY_BULK_DELETE_IF_MATCH_ETAG:
+            result = BULK_IMPORT_MODE_DELETE_IF_MATCH_ETAG;
+            break;
+        default:
+            result = NULL;
+            break;
+    }
+
+    return result;
+}
+
+static bool isBulkDeleteMode(IOTHUB_REGISTRY_BULK_MODE mode)
+{
+    return (mode == IOTHUB_REGISTRY_BULK_DELETE) || (mode == IOTHUB_REGISTRY_BULK_DELETE_IF_MATCH_ETAG);
+}
+
+static bool isBulkIfMatchEtagMode(IOTHUB_REGISTRY_BULK_MODE mode)
+{
+    return (mode == IOTHUB_REGISTRY_BULK_UPDATE_IF_MATCH_ETAG) || (mode == IOTHUB_REGISTRY_BULK_DELETE_IF_MATCH_ETAG);
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT validateBulkDevices(const IOTHUB_REGISTRY_BULK_DEVICE* devices, size_t deviceCount)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result = IOTHUB_REGISTRYMANAGER_OK;
+    size_t i;
+
+    for (i = 0; (i < deviceCount) && (result == IOTHUB_REGISTRYMANAGER_OK); i++)
+    {
+        const IOTHUB_REGISTRY_BULK_DEVICE* device = &devices[i];
+
+        if (device->version != IOTHUB_REGISTRY_BULK_DEVICE_VERSION_1)
+        {
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_019: [ If the version of any device is not IOTHUB_REGISTRY_BULK_DEVICE_VERSION_1 then IoTHubRegistryManager_BulkDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_VERSION. ]*/
+            LogError("Invalid version for device %lu", (unsigned long)i);
+            result = IOTHUB_REGISTRYMANAGER_INVALID_VERSION;
+        }
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_018: [ If any device has a NULL or whitespace deviceId, an unknown mode, a NULL eTag with an _IF_MATCH_ETAG mode or, for a create or update, an authentication method that cannot be set, then IoTHubRegistryManager_BulkDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG without sending any request. ]*/
+        else if ((device->deviceId == NULL) || (strHasNoWhitespace(device->deviceId) != 0))
+        {
+            LogError("Invalid deviceId for device %lu", (unsigned long)i);
+            result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+        }
+        else if (getBulkImportModeString(device->mode) == NULL)
+        {
+            LogError("Invalid mode for device %lu", (unsigned long)i);
+            result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+        }
+        else if (isBulkIfMatchEtagMode(device->mode) && (device->eTag == NULL))
+        {
+            LogError("eTag is required by the mode of device %lu", (unsigned long)i);
+            result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+        }
+        else if ((!isBulkDeleteMode(device->mode)) && (!isAuthTypeAllowed(device->authMethod)))
+        {
+            LogError("Invalid authentication type for device %lu", (unsigned long)i);
+            result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+        }
+    }
+
+    return result;
+}
+
+static void writeJsonCredentials(JSON_WRITER* writer, const char* objectName, const char* primaryName, const char* primaryValue, const char* secondaryName, const char* secondaryValue)
+{
+    if ((primaryValue != NULL) || (secondaryValue != NULL))
+    {
+        bool isFirst = true;
+
+        writeJsonChars(writer, ",", 1);
+        writeJsonString(writer, objectName);
+        writeJsonRaw(writer, ":{");
+        if (primaryValue != NULL)
+        {
+            writeJsonString(writer, primaryName);
+            writeJsonChars(writer, ":", 1);
+            writeJsonString(writer, primaryValue);
+            isFirst = false;
+        }
+        if (secondaryValue != NULL)
+        {
+            if (!isFirst)
+            {
+                writeJsonChars(writer, ",", 1);
+            }
+            writeJsonString(writer, secondaryName);
+            writeJsonChars(writer, ":", 1);
+            writeJsonString(writer, secondaryValue);
+        }
+        writeJsonChars(writer, "}", 1);
+    }
+}
+
+static void writeBulkDeviceJson(JSON_WRITER* writer, const IOTHUB_REGISTRY_BULK_DEVICE* device)
+{
+    writeJsonRaw(writer, "{\"id\":");
+    writeJsonString(writer, device->deviceId);
+    writeJsonMember(writer, "importMode", getBulkImportModeString(device->mode));
+    if (isBulkIfMatchEtagMode(device->mode))
+    {
+        writeJsonMember(writer, "eTag", device->eTag);
+    }
+
+    if (!isBulkDeleteMode(device->mode))
+    {
+        writeJsonMember(writer, DEVICE_JSON_KEY_DEVICE_STATUS, getStatusStringForJson(device->status));
+        writeJsonRaw(writer, ",\"authentication\":{\"type\":");
+        writeJsonString(writer, getAuthTypeStringForJson(device->authMethod));
+        if (device->authMethod == IOTHUB_REGISTRYMANAGER_AUTH_SPK)
+        {
+            writeJsonCredentials(writer, "symmetricKey", "primaryKey", device->primaryKey, "secondaryKey", device->secondaryKey);
+        }
+        else if (device->authMethod == IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT)
+        {
+            writeJsonCredentials(writer, "x509Thumbprint", "primaryThumbprint", device->primaryKey, "secondaryThumbprint", device->secondaryKey);
+        }
+        writeJsonRaw(writer, "},\"capabilities\":{\"iotEdge\":");
+        writeJsonRaw(writer, device->iotEdge_capable ? "true" : "false");
+        writeJsonChars(writer, "}", 1);
+    }
+    writeJsonChars(writer, "}", 1);
+}
+
+static void writeBulkDevicesChunkJson(JSON_WRITER* writer, const void* context)
+{
+    const BULK_DEVICES_CHUNK* chunk = (const BULK_DEVICES_CHUNK*)context;
+    size_t i;
+
+    writeJsonChars(writer, "[", 1);
+    for (i = 0; i < chunk->deviceCount; i++)
+    {
+        if (i > 0)
+        {
+            writeJsonChars(writer, ",", 1);
+        }
+        writeBulkDeviceJson(writer, &chunk->devices[i]);
+    }
+    writeJsonChars(writer, "]", 1);
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT getBulkErrorResult(const char* errorCode)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    if ((errorCode != NULL) && (strcmp(errorCode, BULK_ERROR_CODE_DEVICE_EXISTS) == 0))
+    {
+        result = IOTHUB_REGISTRYMANAGER_DEVICE_EXIST;
+    }
+    else if ((errorCode != NULL) && (strcmp(errorCode, BULK_ERROR_CODE_DEVICE_NOT_FOUND) == 0))
+    {
+        result = IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST;
+    }
+    else
+    {
+        result = IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR;
+    }
+
+    return result;
+}
+
+/*sets the result of every device of the chunk from the errors array of a 400 response*/
+static IOTHUB_REGISTRYMANAGER_RESULT parseBulkDevicesErrors(BUFFER_HANDLE responseBuffer, const BULK_DEVICES_CHUNK* chunk, IOTHUB_REGISTRYMANAGER_RESULT* results)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    const char* bufferStr;
+    JSON_Value* root_value;
+    JSON_Object* root_object;
+    JSON_Array* errors;
+
+    if ((bufferStr = (const char*)BUFFER_u_char(responseBuffer)) == NULL)
+    {
+        LogError("BUFFER_u_char failed");
+        result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+    }
+    else if ((root_value = json_parse_string(bufferStr)) == NULL)
+    {
+        LogError("json_parse_string failed");
+        result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+    }
+    else
+    {
+        if (((root_object = json_value_get_object(root_value)) == NULL) ||
+            ((errors = json_object_get_array(root_object, BULK_JSON_KEY_ERRORS)) == NULL))
+        {
+            LogError("bulk response does not carry an errors array");
+            result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+        }
+        else
+        {
+            size_t errorCount = json_array_get_count(errors);
+            size_t i;
+
+            for (i = 0; i < chunk->deviceCount; i++)
+            {
+                results[i] = IOTHUB_REGISTRYMANAGER_OK;
+            }
+
+            for (i = 0; i < errorCount; i++)
+            {
+                JSON_Object* error = json_array_get_object(errors, i);
+                const char* deviceId = (error == NULL) ? NULL : json_object_get_string(error, BULK_JSON_KEY_DEVICE_ID);
+
+                if (deviceId != NULL)
+                {
+                    const char* errorCode = json_object_get_string(error, BULK_JSON_KEY_ERROR_CODE);
+                    size_t j;
+
+                    for (j = 0; j < chunk->deviceCount; j++)
+                    {
+                        if (strcmp(chunk->devices[j].deviceId, deviceId) == 0)
+                        {
+                            results[j] = getBulkErrorResult(errorCode);
+                        }
+                    }
+                }
+            }
+            result = IOTHUB_REGISTRYMANAGER_OK;
+        }
+        json_value_free(root_value);
+    }
+
+    return result;
+}
+
+static void sendBulkDevicesChunk(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const BULK_DEVICES_CHUNK* chunk, IOTHUB_REGISTRYMANAGER_RESULT* results)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT chunkResult;
+    bool perDeviceResults = false;
+    BUFFER_HANDLE requestBuffer;
+    char relativePath[256];
+
+    if (snprintf(relativePath, sizeof(relativePath), RELATIVE_PATH_FMT_BULK, URL_API_VERSION) <= 0)
+    {
+        LogError("Failure creating relative path");
+        chunkResult = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_021: [ The body of every request shall be the JSON array of the devices of the chunk, written directly into one buffer without building a parson tree. ]*/
+    else if ((requestBuffer = createJsonBuffer(writeBulkDevicesChunkJson, chunk)) == NULL)
+    {
+        chunkResult = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else
+    {
+        BUFFER_HANDLE responseBuffer;
+        unsigned int statusCode;
+
+        if ((responseBuffer = BUFFER_new()) == NULL)
+        {
+            LogError("BUFFER_new failed for responseBuffer");
+            chunkResult = IOTHUB_REGISTRYMANAGER_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_022: [ Every chunk shall be POSTed to url/devices?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+            if ((chunkResult = sendRegistryHttpRequest(registryManagerHandle, IOTHUB_REQUEST_BULK, HTTPAPI_REQUEST_POST, relativePath, requestBuffer, &statusCode, responseBuffer)) != IOTHUB_REGISTRYMANAGER_OK)
+            {
+                LogError("Failure sending bulk devices request");
+            }
+            else if (statusCode <= 300)
+            {
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_024: [ If the status code is less or equal than 300 every device of the chunk shall get IOTHUB_REGISTRYMANAGER_OK. ]*/
+                chunkResult = IOTHUB_REGISTRYMANAGER_OK;
+            }
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_025: [ If the status code is 400 and the response carries an errors array, every device listed there shall get IOTHUB_REGISTRYMANAGER_DEVICE_EXIST for DeviceAlreadyExists, IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST for DeviceNotFound and IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR otherwise, the other devices of the chunk shall get IOTHUB_REGISTRYMANAGER_OK. ]*/
+            else if ((statusCode == 400) && (parseBulkDevicesErrors(responseBuffer, chunk, results) == IOTHUB_REGISTRYMANAGER_OK))
+            {
+                chunkResult = IOTHUB_REGISTRYMANAGER_OK;
+                perDeviceResults = true;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_026: [ If the request cannot be sent every device of the chunk shall get IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, for any other status code greater than 300 IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR and for any other failure IOTHUB_REGISTRYMANAGER_ERROR. ]*/
+                LogError("Http Failure status code %u.", statusCode);
+                chunkResult = IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR;
+            }
+            BUFFER_delete(responseBuffer);
+        }
+        BUFFER_delete(requestBuffer);
+    }
+
+    if (!perDeviceResults)
+    {
+        size_t i;
+        for (i = 0; i < chunk->deviceCount; i++)
+        {
+            results[i] = chunkResult;
+        }
+    }
+}
+
+static bool takeNextBulkDevicesChunk(BULK_DEVICES_OPERATION* operation, BULK_DEVICES_CHUNK* chunk, IOTHUB_REGISTRYMANAGER_RESULT** results)
+{
+    bool result;
+
+    if (Lock(operation->lock) != LOCK_OK)
+    {
+        LogError("Lock failed");
+        result = false;
+    }
+    else
+    {
+        if (operation->nextChunkStart >= operation->deviceCount)
+        {
+            result = false;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_020: [ IoTHubRegistryManager_BulkDevices shall split the devices in chunks of at most 100 consecutive devices. ]*/
+            size_t remaining = operation->deviceCount - operation->nextChunkStart;
+            chunk->devices = operation->devices + operation->nextChunkStart;
+            chunk->deviceCount = (remaining < IOTHUB_BULK_DEVICES_MAX_REQUEST) ? remaining : IOTHUB_BULK_DEVICES_MAX_REQUEST;
+            *results = operation->results + operation->nextChunkStart;
+            operation->nextChunkStart += chunk->deviceCount;
+            result = true;
+        }
+        (void)Unlock(operation->lock);
+    }
+
+    return result;
+}
+
+static void sendBulkDevicesChunks(BULK_DEVICES_OPERATION* operation)
+{
+    BULK_DEVICES_CHUNK chunk;
+    IOTHUB_REGISTRYMANAGER_RESULT* results;
+
+    while (takeNextBulkDevicesChunk(operation, &chunk, &results))
+    {
+        sendBulkDevicesChunk(operation->registryManagerHandle, &chunk, results);
+    }
+}
+
+static int bulkDevicesWorkerThread(void* context)
+{
+    sendBulkDevicesChunks((BULK_DEVICES_OPERATION*)context);
+    return 0;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_BulkDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const IOTHUB_REGISTRY_BULK_DEVICE* devices, size_t deviceCount, size_t maxConcurrentRequests, IOTHUB_REGISTRYMANAGER_RESULT* results)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_017: [ If registryManagerHandle, devices or results is NULL, deviceCount is 0 or maxConcurrentRequests is not between 1 and 16 then IoTHubRegistryManager_BulkDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (devices == NULL) || (results == NULL) || (deviceCount == 0) ||
+        (maxConcurrentRequests == 0) || (maxConcurrentRequests > IOTHUB_BULK_DEVICES_MAX_CONCURRENT_REQUESTS))
+    {
+        LogError("Invalid argument registryManagerHandle=%p devices=%p results=%p deviceCount=%lu maxConcurrentRequests=%lu", registryManagerHandle, devices, results, (unsigned long)deviceCount, (unsigned long)maxConcurrentRequests);
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    else if ((result = validateBulkDevices(devices, deviceCount)) != IOTHUB_REGISTRYMANAGER_OK)
+    {
+        LogError("Invalid device in the bulk operation");
+    }
+    else
+    {
+        BULK_DEVICES_OPERATION operation;
+        size_t i;
+
+        /*devices of chunks that are never sent keep this result*/
+        for (i = 0; i < deviceCount; i++)
+        {
+            results[i] = IOTHUB_REGISTRYMANAGER_ERROR;
+        }
+
+        operation.registryManagerHandle = registryManagerHandle;
+        operation.devices = devices;
+        operation.deviceCount = deviceCount;
+        operation.results = results;
+        operation.nextChunkStart = 0;
+
+        if ((operation.lock = Lock_Init()) == NULL)
+        {
+            LogError("Lock_Init failed");
+            result = IOTHUB_REGISTRYMANAGER_ERROR;
+        }
+        else
+        {
+            THREAD_HANDLE workerThreads[IOTHUB_BULK_DEVICES_MAX_CONCURRENT_REQUESTS - 1];
+            size_t chunkCount = (deviceCount + IOTHUB_BULK_DEVICES_MAX_REQUEST - 1) / IOTHUB_BULK_DEVICES_MAX_REQUEST;
+            size_t workerThreadCount = ((maxConcurrentRequests < chunkCount) ? maxConcurrentRequests : chunkCount) - 1;
+            size_t startedThreadCount = 0;
+
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_023: [ IoTHubRegistryManager_BulkDevices shall start the smaller of maxConcurrentRequests and the number of chunks, minus one, worker threads by calling ThreadAPI_Create, the calling thread and the worker threads shall each take the next chunk that has not been sent until all the chunks are sent. If a thread cannot be created its chunks shall be sent by the other threads. ]*/
+            for (i = 0; i < workerThreadCount; i++)
+            {
+                if (ThreadAPI_Create(&workerThreads[startedThreadCount], bulkDevicesWorkerThread, &operation) != THREADAPI_OK)
+                {
+                    LogError("ThreadAPI_Create failed, continuing with %lu threads", (unsigned long)(startedThreadCount + 1));
+                }
+                else
+                {
+                    startedThreadCount++;
+                }
+            }
+
+            sendBulkDevicesChunks(&operation);
+
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_027: [ IoTHubRegistryManager_BulkDevices shall wait for the worker threads by calling ThreadAPI_Join and return IOTHUB_REGISTRYMANAGER_OK if every device succeeded, otherwise the result of the first device in the array that did not succeed. ]*/
+            for (i = 0; i < startedThreadCount; i++)
+            {
+                int threadResult;
+                if (ThreadAPI_Join(workerThreads[i], &threadResult) != THREADAPI_OK)
+                {
+                    LogError("ThreadAPI_Join failed");
+                }
+            }
+            (void)Lock_Deinit(operation.lock);
+
+            for (i = 0; (i < deviceCount) && (result == IOTHUB_REGISTRYMANAGER_OK); i++)
+            {
+                result = results[i];
+            }
+        }
+    }
+
+    return result;
+}
+
+typedef struct REGISTRY_JOB_REQUEST_TAG
+{
+    const char* inputBlobContainerUri;
+    const char* outputBlobContainerUri;
+    bool excludeKeys;
+} REGISTRY_JOB_REQUEST;
+
+static void writeRegistryJobJson(JSON_WRITER* writer, const void* context)
+{
+    const REGISTRY_JOB_REQUEST* request = (const REGISTRY_JOB_REQUEST*)context;
+
+    writeJsonRaw(writer, "{\"type\":");
+    if (request->inputBlobContainerUri == NULL)
+    {
+        writeJsonString(writer, JOB_JSON_VALUE_EXPORT);
+        writeJsonMember(writer, "outputBlobContainerUri", request->outputBlobContainerUri);
+        writeJsonRaw(writer, ",\"excludeKeysInExport\":");
+        writeJsonRaw(writer, request->excludeKeys ? "true" : "false");
+    }
+    else
+    {
+        writeJsonString(writer, JOB_JSON_VALUE_IMPORT);
+        writeJsonMember(writer, "inputBlobContainerUri", request->inputBlobContainerUri);
+        writeJsonMember(writer, "outputBlobContainerUri", request->outputBlobContainerUri);
+    }
+    writeJsonChars(writer, "}", 1);
+}
+
+static IOTHUB_REGISTRY_JOB_TYPE getJobTypeFromString(const char* type)
+{
+    IOTHUB_REGISTRY_JOB_TYPE result;
+
+    if ((type != NULL) && (strcmp(type, JOB_JSON_VALUE_EXPORT) == 0))
+    {
+        result = IOTHUB_REGISTRY_JOB_TYPE_EXPORT;
+    }
+    else if ((type != NULL) && (strcmp(type, JOB_JSON_VALUE_IMPORT) == 0))
+    {
+        result = IOTHUB_REGISTRY_JOB_TYPE_IMPORT;
+    }
+    else
+    {
+        result = IOTHUB_REGISTRY_JOB_TYPE_UNKNOWN;
+    }
+
+    return result;
+}
+
+static IOTHUB_REGISTRY_JOB_STATUS getJobStatusFromString(const char* status)
+{
+    IOTHUB_REGISTRY_JOB_STATUS result;
+
+    if (status == NULL)
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_UNKNOWN;
+    }
+    else if (strcmp(status, JOB_JSON_VALUE_ENQUEUED) == 0)
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_ENQUEUED;
+    }
+    else if (strcmp(status, JOB_JSON_VALUE_RUNNING) == 0)
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_RUNNING;
+    }
+    else if (strcmp(status, JOB_JSON_VALUE_COMPLETED) == 0)
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_COMPLETED;
+    }
+    else if (strcmp(status, JOB_JSON_VALUE_FAILED) == 0)
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_FAILED;
+    }
+    else if (strcmp(status, JOB_JSON_VALUE_CANCELLED) == 0)
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_CANCELLED;
+    }
+    else
+    {
+        result = IOTHUB_REGISTRY_JOB_STATUS_UNKNOWN;
+    }
+
+    return result;
+}
+
+void IoTHubRegistryManager_FreeJobMembers(IOTHUB_REGISTRY_JOB* job)
+{
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_038: [ IoTHubRegistryManager_FreeJobMembers shall free the strings of job and set them to NULL, if job is NULL it shall do nothing. ]*/
+    if (job != NULL)
+    {
+        free((void*)job->jobId);
+        free((void*)job->startTimeUtc);
+        free((void*)job->endTimeUtc);
+        free((void*)job->failureReason);
+        job->jobId = NULL;
+        job->startTimeUtc = NULL;
+        job->endTimeUtc = NULL;
+        job->failureReason = NULL;
+    }
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT parseRegistryJobJson(BUFFER_HANDLE responseBuffer, IOTHUB_REGISTRY_JOB* job)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    const char* bufferStr;
+    JSON_Value* root_value;
+    JSON_Object* root_object;
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_035: [ The response shall be parsed into job, jobId, startTimeUtc, endTimeUtc and failureReason are copied and have to be freed with IoTHubRegistryManager_FreeJobMembers. If the parsing fails the function shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR. ]*/
+    if ((bufferStr = (const char*)BUFFER_u_char(responseBuffer)) == NULL)
+    {
+        LogError("BUFFER_u_char failed");
+        result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+    }
+    else if ((root_value = json_parse_string(bufferStr)) == NULL)
+    {
+        LogError("json_parse_string failed");
+        result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+    }
+    else
+    {
+        if ((root_object = json_value_get_object(root_value)) == NULL)
+        {
+            LogError("json_value_get_object failed");
+            result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+        }
+        else
+        {
+            const char* jobId = json_object_get_string(root_object, JOB_JSON_KEY_JOB_ID);
+            const char* startTimeUtc = json_object_get_string(root_object, JOB_JSON_KEY_START_TIME);
+            const char* endTimeUtc = json_object_get_string(root_object, JOB_JSON_KEY_END_TIME);
+            const char* failureReason = json_object_get_string(root_object, JOB_JSON_KEY_FAILURE_REASON);
+
+            memset(job, 0, sizeof(*job));
+            job->type = getJobTypeFromString(json_object_get_string(root_object, JOB_JSON_KEY_TYPE));
+            job->status = getJobStatusFromString(json_object_get_string(root_object, JOB_JSON_KEY_STATUS));
+            job->progress = (int)json_object_get_number(root_object, JOB_JSON_KEY_PROGRESS);
+
+            if ((jobId == NULL) || (mallocAndStrcpy_s((char**)&job->jobId, jobId) != 0))
+            {
+                LogError("jobId is missing or cannot be copied");
+                result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+            }
+            else if (((startTimeUtc != NULL) && (mallocAndStrcpy_s((char**)&job->startTimeUtc, startTimeUtc) != 0)) ||
+                ((endTimeUtc != NULL) && (mallocAndStrcpy_s((char**)&job->endTimeUtc, endTimeUtc) != 0)) ||
+                ((failureReason != NULL) && (mallocAndStrcpy_s((char**)&job->failureReason, failureReason) != 0)))
+            {
+                LogError("mallocAndStrcpy_s failed for job");
+                IoTHubRegistryManager_FreeJobMembers(job);
+                result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_REGISTRYMANAGER_OK;
+            }
+        }
+        json_value_free(root_value);
+    }
+
+    return result;
+}
+
+/*sends a job request and parses the job of the response when job is not NULL*/
+static IOTHUB_REGISTRYMANAGER_RESULT sendRegistryJobRequest(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, BUFFER_HANDLE requestBuffer, IOTHUB_REGISTRY_JOB* job)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    BUFFER_HANDLE responseBuffer;
+    unsigned int statusCode;
+
+    if ((responseBuffer = BUFFER_new()) == NULL)
+    {
+        LogError("BUFFER_new failed for responseBuffer");
+        result = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_034: [ If the request fails the job functions shall return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, if the status code is 404 IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST and if it is any other status code greater than 300 IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR. ]*/
+        if ((result = sendRegistryHttpRequest(registryManagerHandle, IOTHUB_REQUEST_JOB, requestType, relativePath, requestBuffer, &statusCode, responseBuffer)) != IOTHUB_REGISTRYMANAGER_OK)
+        {
+            LogError("Failure sending job request");
+        }
+        else if (statusCode == 404)
+        {
+            LogError("Job not found");
+            result = IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST;
+        }
+        else if (statusCode > 300)
+        {
+            LogError("Http Failure status code %u.", statusCode);
+            result = IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR;
+        }
+        else if (job != NULL)
+        {
+            result = parseRegistryJobJson(responseBuffer, job);
+        }
+        BUFFER_delete(responseBuffer);
+    }
+
+    return result;
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT createRegistryJob(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const REGISTRY_JOB_REQUEST* request, IOTHUB_REGISTRY_JOB* job)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    BUFFER_HANDLE requestBuffer;
+    char relativePath[256];
+
+    if (snprintf(relativePath, sizeof(relativePath), RELATIVE_PATH_FMT_JOB_CREATE, URL_API_VERSION) <= 0)
+    {
+        LogError("Failure creating relative path");
+        result = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else if ((requestBuffer = createJsonBuffer(writeRegistryJobJson, request)) == NULL)
+    {
+        result = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else
+    {
+        result = sendRegistryJobRequest(registryManagerHandle, HTTPAPI_REQUEST_POST, relativePath, requestBuffer, job);
+        BUFFER_delete(requestBuffer);
+    }
+
+    return result;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_ExportDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* outputBlobContainerUri, bool excludeKeys, IOTHUB_REGISTRY_JOB* job)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_028: [ If registryManagerHandle, outputBlobContainerUri or job is NULL then IoTHubRegistryManager_ExportDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (outputBlobContainerUri == NULL) || (job == NULL))
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_029: [ IoTHubRegistryManager_ExportDevices shall POST {"type":"export","outputBlobContainerUri":...,"excludeKeysInExport":...} to url/jobs/create?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+        REGISTRY_JOB_REQUEST request;
+        request.inputBlobContainerUri = NULL;
+        request.outputBlobContainerUri = outputBlobContainerUri;
+        request.excludeKeys = excludeKeys;
+
+        result = createRegistryJob(registryManagerHandle, &request, job);
+    }
+    return result;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_ImportDevices(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* inputBlobContainerUri, const char* outputBlobContainerUri, IOTHUB_REGISTRY_JOB* job)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_030: [ If registryManagerHandle, inputBlobContainerUri, outputBlobContainerUri or job is NULL then IoTHubRegistryManager_ImportDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (inputBlobContainerUri == NULL) || (outputBlobContainerUri == NULL) || (job == NULL))
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_031: [ IoTHubRegistryManager_ImportDevices shall POST {"type":"import","inputBlobContainerUri":...,"outputBlobContainerUri":...} to url/jobs/create?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+        REGISTRY_JOB_REQUEST request;
+        request.inputBlobContainerUri = inputBlobContainerUri;
+        request.outputBlobContainerUri = outputBlobContainerUri;
+        request.excludeKeys = false;
+
+        result = createRegistryJob(registryManagerHandle, &request, job);
+    }
+    return result;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetJob(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* jobId, IOTHUB_REGISTRY_JOB* job)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    char relativePath[256];
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_032: [ If registryManagerHandle, jobId or job is NULL then IoTHubRegistryManager_GetJob shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (jobId == NULL) || (job == NULL))
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    else if (snprintf(relativePath, sizeof(relativePath), RELATIVE_PATH_FMT_JOB, jobId, URL_API_VERSION) <= 0)
+    {
+        LogError("Failure creating relative path");
+        result = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_033: [ IoTHubRegistryManager_GetJob shall GET url/jobs/[jobId]?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+        result = sendRegistryJobRequest(registryManagerHandle, HTTPAPI_REQUEST_GET, relativePath, NULL, job);
+    }
+    return result;
+}
+
+IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_CancelJob(IOTHUB_REGISTRYMANAGER_HANDLE registryManagerHandle, const char* jobId)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+    char relativePath[256];
+
+    /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_036: [ If registryManagerHandle or jobId is NULL then IoTHubRegistryManager_CancelJob shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    if ((registryManagerHandle == NULL) || (jobId == NULL))
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_REGISTRYMANAGER_INVALID_ARG;
+    }
+    else if (snprintf(relativePath, sizeof(relativePath), RELATIVE_PATH_FMT_JOB, jobId, URL_API_VERSION) <= 0)
+    {
+        LogError("Failure creating relative path");
+        result = IOTHUB_REGISTRYMANAGER_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBREGISTRYMANAGER_02_037: [ IoTHubRegistryManager_CancelJob shall DELETE url/jobs/[jobId]?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+        result = sendRegistryJobRequest(registryManagerHandle, HTTPAPI_REQUEST_DELETE, relativePath, NULL, NULL);
+    }
+    return result;
+}
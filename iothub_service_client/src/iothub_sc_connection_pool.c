@@ -0,0 +1,379 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+
+#include "iothub_sc_connection_pool.h"
+
+#define IOTHUB_SC_CONNECTION_POOL_MAX_IDLE  16
+#define SAS_TOKEN_LIFETIME_SECONDS          3600
+#define SAS_TOKEN_REFRESH_MARGIN_SECONDS    300
+#define HTTP_STATUS_CODE_UNAUTHORIZED       401
+#define EPOCH_TIME_T_VALUE                  (time_t)0
+
+static const char* HTTP_HEADER_KEY_AUTHORIZATION = "Authorization";
+
+typedef struct IOTHUB_SC_CONNECTION_POOL_TAG
+{
+    LOCK_HANDLE lock;
+    size_t refCount;
+    char* hostname;
+    char* sharedAccessKey;
+    char* keyName;
+    STRING_HANDLE scope;
+    STRING_HANDLE sasToken;
+    size_t sasTokenExpiry;
+    HTTPAPIEX_HANDLE idleConnections[IOTHUB_SC_CONNECTION_POOL_MAX_IDLE];
+    /*timeout last set on each idle connection, 0 when the HTTP stack default is still in use*/
+    unsigned int idleTimeouts[IOTHUB_SC_CONNECTION_POOL_MAX_IDLE];
+    size_t idleCount;
+} IOTHUB_SC_CONNECTION_POOL;
+
+static void free_connection_pool(IOTHUB_SC_CONNECTION_POOL* connectionPool)
+{
+    size_t i;
+    for (i = 0; i < connectionPool->idleCount; i++)
+    {
+        HTTPAPIEX_Destroy(connectionPool->idleConnections[i]);
+    }
+    STRING_delete(connectionPool->sasToken);
+    STRING_delete(connectionPool->scope);
+    free(connectionPool->hostname);
+    free(connectionPool->sharedAccessKey);
+    free(connectionPool->keyName);
+    if (connectionPool->lock != NULL)
+    {
+        (void)Lock_Deinit(connectionPool->lock);
+    }
+    free(connectionPool);
+}
+
+/*called with the lock held*/
+static int refresh_sas_token(IOTHUB_SC_CONNECTION_POOL* connectionPool)
+{
+    int result;
+    time_t currentTime = get_time(NULL);
+
+    if (currentTime == (time_t)(-1))
+    {
+        LogError("get_time failed");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t secondsSinceEpoch = (size_t)(difftime(currentTime, EPOCH_TIME_T_VALUE) + 0);
+
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_012: [ If the cached SAS token expires in more than 300 seconds then IoTHubScConnectionPool_ExecuteRequest shall reuse it. ]*/
+        if ((connectionPool->sasToken != NULL) &&
+            (secondsSinceEpoch + SAS_TOKEN_REFRESH_MARGIN_SECONDS < connectionPool->sasTokenExpiry))
+        {
+            result = 0;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_013: [ Otherwise IoTHubScConnectionPool_ExecuteRequest shall create a new SAS token valid for 3600 seconds by calling SASToken_CreateString and cache it. ]*/
+            size_t expiry = secondsSinceEpoch + SAS_TOKEN_LIFETIME_SECONDS;
+            STRING_HANDLE sasToken = SASToken_CreateString(connectionPool->sharedAccessKey, STRING_c_str(connectionPool->scope), connectionPool->keyName, expiry);
+            if (sasToken == NULL)
+            {
+                LogError("SASToken_CreateString failed");
+                result = __FAILURE__;
+            }
+            else
+            {
+                STRING_delete(connectionPool->sasToken);
+                connectionPool->sasToken = sasToken;
+                connectionPool->sasTokenExpiry = expiry;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*called with the lock held, a request without timeout never reuses a connection that had one set*/
+static HTTPAPIEX_HANDLE take_idle_connection(IOTHUB_SC_CONNECTION_POOL* connectionPool, unsigned int timeoutInMilliseconds, unsigned int* connectionTimeout)
+{
+    HTTPAPIEX_HANDLE result = NULL;
+    size_t i = connectionPool->idleCount;
+
+    while ((i > 0) && (connectionPool->idleTimeouts[i - 1] != timeoutInMilliseconds))
+    {
+        i--;
+    }
+
+    if ((i == 0) && (timeoutInMilliseconds != 0) && (connectionPool->idleCount > 0))
+    {
+        i = connectionPool->idleCount;
+    }
+
+    if (i > 0)
+    {
+        result = connectionPool->idleConnections[i - 1];
+        *connectionTimeout = connectionPool->idleTimeouts[i - 1];
+        connectionPool->idleCount--;
+        connectionPool->idleConnections[i - 1] = connectionPool->idleConnections[connectionPool->idleCount];
+        connectionPool->idleTimeouts[i - 1] = connectionPool->idleTimeouts[connectionPool->idleCount];
+    }
+
+    return result;
+}
+
+static void release_connection(IOTHUB_SC_CONNECTION_POOL* connectionPool, HTTPAPIEX_HANDLE connection, unsigned int connectionTimeout, bool invalidateSasToken)
+{
+    if (Lock(connectionPool->lock) != LOCK_OK)
+    {
+        LogError("failed to lock the connection pool");
+        HTTPAPIEX_Destroy(connection);
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_019: [ If the service answered 401 then IoTHubScConnectionPool_ExecuteRequest shall discard the cached SAS token. ]*/
+        if (invalidateSasToken)
+        {
+            connectionPool->sasTokenExpiry = 0;
+        }
+
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_017: [ After the request IoTHubScConnectionPool_ExecuteRequest shall return the connection to the pool, keeping it open. ]*/
+        if (connectionPool->idleCount < IOTHUB_SC_CONNECTION_POOL_MAX_IDLE)
+        {
+            connectionPool->idleConnections[connectionPool->idleCount] = connection;
+            connectionPool->idleTimeouts[connectionPool->idleCount] = connectionTimeout;
+            connectionPool->idleCount++;
+            connection = NULL;
+        }
+        (void)Unlock(connectionPool->lock);
+
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_018: [ If the pool already holds 16 idle connections then IoTHubScConnectionPool_ExecuteRequest shall destroy the connection by calling HTTPAPIEX_Destroy. ]*/
+        if (connection != NULL)
+        {
+            HTTPAPIEX_Destroy(connection);
+        }
+    }
+}
+
+IOTHUB_SC_CONNECTION_POOL_HANDLE IoTHubScConnectionPool_Create(const char* hostname, const char* sharedAccessKey, const char* keyName, const char* deviceId)
+{
+    IOTHUB_SC_CONNECTION_POOL* result;
+
+    /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_001: [ If hostname or sharedAccessKey is NULL, or keyName and deviceId are both NULL, then IoTHubScConnectionPool_Create shall fail and return NULL. ]*/
+    if ((hostname == NULL) ||
+        (sharedAccessKey == NULL) ||
+        ((keyName == NULL) && (deviceId == NULL)))
+    {
+        LogError("invalid argument const char* hostname=%p, const char* sharedAccessKey=%p, const char* keyName=%p, const char* deviceId=%p", hostname, sharedAccessKey, keyName, deviceId);
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_002: [ IoTHubScConnectionPool_Create shall allocate memory for a new connection pool having a reference count of 1. ]*/
+    else if ((result = (IOTHUB_SC_CONNECTION_POOL*)malloc(sizeof(IOTHUB_SC_CONNECTION_POOL))) == NULL)
+    {
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_004: [ If any call fails, IoTHubScConnectionPool_Create shall do clean up and return NULL. ]*/
+        LogError("malloc failed for IOTHUB_SC_CONNECTION_POOL");
+    }
+    else
+    {
+        (void)memset(result, 0, sizeof(IOTHUB_SC_CONNECTION_POOL));
+        result->refCount = 1;
+
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_003: [ IoTHubScConnectionPool_Create shall copy hostname, sharedAccessKey and keyName, create the SAS token scope (hostname, or hostname%2Fdevices%2FdeviceId when deviceId is not NULL) and create a lock by calling Lock_Init. ]*/
+        if (mallocAndStrcpy_s(&result->hostname, hostname) != 0)
+        {
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_004: [ If any call fails, IoTHubScConnectionPool_Create shall do clean up and return NULL. ]*/
+            LogError("mallocAndStrcpy_s failed for hostname");
+            free_connection_pool(result);
+            result = NULL;
+        }
+        else if (mallocAndStrcpy_s(&result->sharedAccessKey, sharedAccessKey) != 0)
+        {
+            LogError("mallocAndStrcpy_s failed for sharedAccessKey");
+            free_connection_pool(result);
+            result = NULL;
+        }
+        else if ((keyName != NULL) && (mallocAndStrcpy_s(&result->keyName, keyName) != 0))
+        {
+            LogError("mallocAndStrcpy_s failed for keyName");
+            free_connection_pool(result);
+            result = NULL;
+        }
+        else if ((result->scope = ((deviceId != NULL) ? STRING_construct_sprintf("%s%%2Fdevices%%2F%s", hostname, deviceId) : STRING_construct(hostname))) == NULL)
+        {
+            LogError("failed to construct the SAS token scope");
+            free_connection_pool(result);
+            result = NULL;
+        }
+        else if ((result->lock = Lock_Init()) == NULL)
+        {
+            LogError("Lock_Init failed");
+            free_connection_pool(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+IOTHUB_SC_CONNECTION_POOL_HANDLE IoTHubScConnectionPool_Clone(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool)
+{
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result;
+
+    /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_005: [ If connectionPool is NULL then IoTHubScConnectionPool_Clone shall return NULL. ]*/
+    if (connectionPool == NULL)
+    {
+        LogError("invalid argument IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool=%p", connectionPool);
+        result = NULL;
+    }
+    else if (Lock(connectionPool->lock) != LOCK_OK)
+    {
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_007: [ If Lock fails then IoTHubScConnectionPool_Clone shall return NULL. ]*/
+        LogError("failed to lock the connection pool");
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_006: [ Otherwise IoTHubScConnectionPool_Clone shall increment the reference count under the lock and return connectionPool. ]*/
+        connectionPool->refCount++;
+        (void)Unlock(connectionPool->lock);
+        result = connectionPool;
+    }
+
+    return result;
+}
+
+void IoTHubScConnectionPool_Destroy(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool)
+{
+    /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_008: [ If connectionPool is NULL then IoTHubScConnectionPool_Destroy shall return. ]*/
+    if (connectionPool != NULL)
+    {
+        if (Lock(connectionPool->lock) != LOCK_OK)
+        {
+            LogError("failed to lock the connection pool, the pool is leaked");
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_009: [ IoTHubScConnectionPool_Destroy shall decrement the reference count under the lock. ]*/
+            size_t refCount = --connectionPool->refCount;
+            (void)Unlock(connectionPool->lock);
+
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_010: [ When the reference count reaches 0 IoTHubScConnectionPool_Destroy shall destroy all the idle connections by calling HTTPAPIEX_Destroy and free all the resources. ]*/
+            if (refCount == 0)
+            {
+                free_connection_pool(connectionPool);
+            }
+        }
+    }
+}
+
+static HTTPAPIEX_RESULT execute_request(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent, unsigned int timeoutInMilliseconds)
+{
+    HTTPAPIEX_RESULT result;
+
+    /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_011: [ If connectionPool or requestHttpHeadersHandle is NULL then IoTHubScConnectionPool_ExecuteRequest shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+    if ((connectionPool == NULL) ||
+        (requestHttpHeadersHandle == NULL))
+    {
+        LogError("invalid argument IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool=%p, HTTP_HEADERS_HANDLE requestHttpHeadersHandle=%p", connectionPool, requestHttpHeadersHandle);
+        result = HTTPAPIEX_INVALID_ARG;
+    }
+    else if (Lock(connectionPool->lock) != LOCK_OK)
+    {
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_020: [ If any call fails, IoTHubScConnectionPool_ExecuteRequest shall return HTTPAPIEX_ERROR. ]*/
+        LogError("failed to lock the connection pool");
+        result = HTTPAPIEX_ERROR;
+    }
+    else
+    {
+        HTTPAPIEX_HANDLE connection = NULL;
+        unsigned int connectionTimeout = 0;
+        bool authorized;
+
+        if (refresh_sas_token(connectionPool) != 0)
+        {
+            authorized = false;
+        }
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_014: [ IoTHubScConnectionPool_ExecuteRequest shall set the Authorization header of requestHttpHeadersHandle to the SAS token by calling HTTPHeaders_ReplaceHeaderNameValuePair. ]*/
+        else if (HTTPHeaders_ReplaceHeaderNameValuePair(requestHttpHeadersHandle, HTTP_HEADER_KEY_AUTHORIZATION, STRING_c_str(connectionPool->sasToken)) != HTTP_HEADERS_OK)
+        {
+            LogError("HTTPHeaders_ReplaceHeaderNameValuePair failed for the Authorization header");
+            authorized = false;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_015: [ IoTHubScConnectionPool_ExecuteRequest shall take an idle connection from the pool, or create one by calling HTTPAPIEX_Create when the pool has none. ]*/
+            connection = take_idle_connection(connectionPool, timeoutInMilliseconds, &connectionTimeout);
+            authorized = true;
+        }
+        (void)Unlock(connectionPool->lock);
+
+        if (!authorized)
+        {
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_020: [ If any call fails, IoTHubScConnectionPool_ExecuteRequest shall return HTTPAPIEX_ERROR. ]*/
+            result = HTTPAPIEX_ERROR;
+        }
+        else if ((connection == NULL) &&
+            ((connection = HTTPAPIEX_Create(connectionPool->hostname)) == NULL))
+        {
+            LogError("HTTPAPIEX_Create failed");
+            result = HTTPAPIEX_ERROR;
+        }
+        /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_022: [ If timeoutInMilliseconds is not 0 and differs from the timeout last set on the connection, IoTHubScConnectionPool_ExecuteRequestWithTimeout shall set it by calling HTTPAPIEX_SetOption with OPTION_HTTP_TIMEOUT. ]*/
+        else if ((timeoutInMilliseconds != 0) && (connectionTimeout != timeoutInMilliseconds) &&
+            (HTTPAPIEX_SetOption(connection, OPTION_HTTP_TIMEOUT, &timeoutInMilliseconds) != HTTPAPIEX_OK))
+        {
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_023: [ If HTTPAPIEX_SetOption fails, IoTHubScConnectionPool_ExecuteRequestWithTimeout shall destroy the connection and return HTTPAPIEX_ERROR. ]*/
+            LogError("HTTPAPIEX_SetOption failed for the timeout");
+            HTTPAPIEX_Destroy(connection);
+            result = HTTPAPIEX_ERROR;
+        }
+        else
+        {
+            unsigned int httpStatusCode = 0;
+
+            /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_016: [ IoTHubScConnectionPool_ExecuteRequest shall execute the request by calling HTTPAPIEX_ExecuteRequest and return what HTTPAPIEX_ExecuteRequest returns. ]*/
+            result = HTTPAPIEX_ExecuteRequest(connection, requestType, relativePath, requestHttpHeadersHandle, requestContent, &httpStatusCode, responseHttpHeadersHandle, responseContent);
+            if (statusCode != NULL)
+            {
+                *statusCode = httpStatusCode;
+            }
+
+            if (result != HTTPAPIEX_OK)
+            {
+                /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_024: [ If HTTPAPIEX_ExecuteRequest fails, IoTHubScConnectionPool_ExecuteRequest shall destroy the connection by calling HTTPAPIEX_Destroy instead of returning it to the pool. ]*/
+                LogError("HTTPAPIEX_ExecuteRequest failed, discarding the connection");
+                HTTPAPIEX_Destroy(connection);
+            }
+            else
+            {
+                if (timeoutInMilliseconds != 0)
+                {
+                    connectionTimeout = timeoutInMilliseconds;
+                }
+                release_connection(connectionPool, connection, connectionTimeout, (httpStatusCode == HTTP_STATUS_CODE_UNAUTHORIZED));
+            }
+        }
+    }
+
+    return result;
+}
+
+HTTPAPIEX_RESULT IoTHubScConnectionPool_ExecuteRequest(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    return execute_request(connectionPool, requestType, relativePath, requestHttpHeadersHandle, requestContent, statusCode, responseHttpHeadersHandle, responseContent, 0);
+}
+
+HTTPAPIEX_RESULT IoTHubScConnectionPool_ExecuteRequestWithTimeout(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent, unsigned int timeoutInMilliseconds)
+{
+    /*Codes_SRS_IOTHUB_SC_CONNECTION_POOL_02_021: [ IoTHubScConnectionPool_ExecuteRequestWithTimeout shall behave as IoTHubScConnectionPool_ExecuteRequest, preferring an idle connection whose timeout is already timeoutInMilliseconds. A request without timeout shall never reuse a connection that had a timeout set. ]*/
+    return execute_request(connectionPool, requestType, relativePath, requestHttpHeadersHandle, requestContent, statusCode, responseHttpHeadersHandle, responseContent, timeoutInMilliseconds);
+}
@@ -0,0 +1,572 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "iothub_sc_feedback_parser.h"
+
+static const char* const FEEDBACK_RECORD_KEY_DEVICE_ID = "deviceId";
+static const char* const FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID = "deviceGenerationId";
+static const char* const FEEDBACK_RECORD_KEY_DESCRIPTION = "description";
+static const char* const FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC = "enqueuedTimeUtc";
+static const char* const FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID = "originalMessageId";
+
+#define FEEDBACK_PARSER_MAX_NESTING 32
+
+typedef struct FEEDBACK_PARSER_TAG
+{
+    char* current;
+    char* end;
+} FEEDBACK_PARSER;
+
+static void skipWhitespace(FEEDBACK_PARSER* parser)
+{
+    while ((parser->current < parser->end) &&
+        ((*parser->current == ' ') || (*parser->current == '\t') || (*parser->current == '\r') || (*parser->current == '\n')))
+    {
+        parser->current++;
+    }
+}
+
+static bool consumeChar(FEEDBACK_PARSER* parser, char expected)
+{
+    bool result;
+    skipWhitespace(parser);
+    if ((parser->current < parser->end) && (*parser->current == expected))
+    {
+        parser->current++;
+        result = true;
+    }
+    else
+    {
+        result = false;
+    }
+    return result;
+}
+
+static int hexValue(char c)
+{
+    int result;
+    if ((c >= '0') && (c <= '9'))
+    {
+        result = c - '0';
+    }
+    else if ((c >= 'a') && (c <= 'f'))
+    {
+        result = c - 'a' + 10;
+    }
+    else if ((c >= 'A') && (c <= 'F'))
+    {
+        result = c - 'A' + 10;
+    }
+    else
+    {
+        result = -1;
+    }
+    return result;
+}
+
+static bool readHex4(FEEDBACK_PARSER* parser, unsigned long* codePoint)
+{
+    bool result = true;
+    size_t i;
+
+    *codePoint = 0;
+    if (parser->end - parser->current < 4)
+    {
+        result = false;
+    }
+    else
+    {
+        for (i = 0; i < 4; i++)
+        {
+            int digit = hexValue(parser->current[i]);
+            if (digit < 0)
+            {
+                result = false;
+                break;
+            }
+            *codePoint = (*codePoint << 4) | (unsigned long)digit;
+        }
+        if (result)
+        {
+            parser->current += 4;
+        }
+    }
+    return result;
+}
+
+/*writes the UTF-8 encoding of codePoint at destination, the encoding is never longer than the escape it replaces*/
+static char* writeUtf8(char* destination, unsigned long codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        *destination++ = (char)codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+        *destination++ = (char)(0xC0 | (codePoint >> 6));
+        *destination++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        *destination++ = (char)(0xE0 | (codePoint >> 12));
+        *destination++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        *destination++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        *destination++ = (char)(0xF0 | (codePoint >> 18));
+        *destination++ = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        *destination++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        *destination++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+    return destination;
+}
+
+/*parses the string starting at the current position (which must be the opening quote), unescapes it in place and NUL terminates it. The terminator
+always fits because it overwrites at the latest the closing quote*/
+static char* parseString(FEEDBACK_PARSER* parser)
+{
+    char* result;
+
+    skipWhitespace(parser);
+    if ((parser->current >= parser->end) || (*parser->current != '"'))
+    {
+        result = NULL;
+    }
+    else
+    {
+        char* destination;
+        bool isTerminated = false;
+        bool isValid = true;
+
+        parser->current++;
+        result = parser->current;
+        destination = parser->current;
+
+        while (isValid && (parser->current < parser->end))
+        {
+            char c = *parser->current++;
+            if (c == '"')
+            {
+                isTerminated = true;
+                break;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                isValid = false;
+            }
+            else if (c != '\\')
+            {
+                *destination++ = c;
+            }
+            else if (parser->current >= parser->end)
+            {
+                isValid = false;
+            }
+            else
+            {
+                c = *parser->current++;
+                switch (c)
+                {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        *destination++ = c;
+                        break;
+                    case 'b':
+                        *destination++ = '\b';
+                        break;
+                    case 'f':
+                        *destination++ = '\f';
+                        break;
+                    case 'n':
+                        *destination++ = '\n';
+                        break;
+                    case 'r':
+                        *destination++ = '\r';
+                        break;
+                    case 't':
+                        *destination++ = '\t';
+                        break;
+                    case 'u':
+                    {
+                        unsigned long codePoint;
+                        if (!readHex4(parser, &codePoint))
+                        {
+                            isValid = false;
+                        }
+                        else if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF))
+                        {
+                            unsigned long lowSurrogate;
+                            if ((parser->end - parser->current < 2) ||
+                                (parser->current[0] != '\\') ||
+                                (parser->current[1] != 'u'))
+                            {
+                                isValid = false;
+                            }
+                            else
+                            {
+                                parser->current += 2;
+                                if (!readHex4(parser, &lowSurrogate) || (lowSurrogate < 0xDC00) || (lowSurrogate > 0xDFFF))
+                                {
+                                    isValid = false;
+                                }
+                                else
+                                {
+                                    destination = writeUtf8(destination, 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00));
+                                }
+                            }
+                        }
+                        else if ((codePoint >= 0xDC00) && (codePoint <= 0xDFFF))
+                        {
+                            isValid = false;
+                        }
+                        else
+                        {
+                            destination = writeUtf8(destination, codePoint);
+                        }
+                        break;
+                    }
+                    default:
+                        isValid = false;
+                        break;
+                }
+            }
+        }
+
+        if (!isValid || !isTerminated)
+        {
+            LogError("Malformed JSON string in feedback message");
+            result = NULL;
+        }
+        else
+        {
+            *destination = '\0';
+        }
+    }
+    return result;
+}
+
+static bool matchLiteral(FEEDBACK_PARSER* parser, const char* literal)
+{
+    bool result;
+    size_t literalLength = strlen(literal);
+    if (((size_t)(parser->end - parser->current) >= literalLength) && (memcmp(parser->current, literal, literalLength) == 0))
+    {
+        parser->current += literalLength;
+        result = true;
+    }
+    else
+    {
+        result = false;
+    }
+    return result;
+}
+
+static bool skipNumber(FEEDBACK_PARSER* parser)
+{
+    char* start = parser->current;
+    while ((parser->current < parser->end) &&
+        (((*parser->current >= '0') && (*parser->current <= '9')) ||
+        (*parser->current == '-') || (*parser->current == '+') ||
+        (*parser->current == '.') || (*parser->current == 'e') || (*parser->current == 'E')))
+    {
+        parser->current++;
+    }
+    return parser->current != start;
+}
+
+/*skips a value the feedback record does not use (numbers, booleans, nested objects and arrays). Nesting is tracked with a small stack of the
+expected closing characters instead of recursion*/
+static bool skipValue(FEEDBACK_PARSER* parser)
+{
+    bool result = true;
+    char closers[FEEDBACK_PARSER_MAX_NESTING];
+    size_t depth = 0;
+    bool expectValue = true;
+
+    do
+    {
+        skipWhitespace(parser);
+        if (parser->current >= parser->end)
+        {
+            result = false;
+        }
+        else if (expectValue)
+        {
+            char c = *parser->current;
+            if ((c == '{') || (c == '['))
+            {
+                if (depth == FEEDBACK_PARSER_MAX_NESTING)
+                {
+                    LogError("Feedback message nesting deeper than %d", FEEDBACK_PARSER_MAX_NESTING);
+                    result = false;
+                }
+                else
+                {
+                    closers[depth++] = (c == '{') ? '}' : ']';
+                    parser->current++;
+                    skipWhitespace(parser);
+                    if ((parser->current < parser->end) && (*parser->current == closers[depth - 1]))
+                    {
+                        parser->current++;
+                        depth--;
+                        expectValue = false;
+                    }
+                    else if (c == '{')
+                    {
+                        result = (parseString(parser) != NULL) && consumeChar(parser, ':');
+                    }
+                }
+            }
+            else if (c == '"')
+            {
+                result = (parseString(parser) != NULL);
+                expectValue = false;
+            }
+            else if (matchLiteral(parser, "true") || matchLiteral(parser, "false") || matchLiteral(parser, "null") || skipNumber(parser))
+            {
+                expectValue = false;
+            }
+            else
+            {
+                result = false;
+            }
+        }
+        else if (depth > 0)
+        {
+            if (*parser->current == closers[depth - 1])
+            {
+                parser->current++;
+                depth--;
+            }
+            else if (*parser->current == ',')
+            {
+                parser->current++;
+                expectValue = true;
+                if (closers[depth - 1] == '}')
+                {
+                    result = (parseString(parser) != NULL) && consumeChar(parser, ':');
+                }
+            }
+            else
+            {
+                result = false;
+            }
+        }
+    } while (result && ((depth > 0) || expectValue));
+
+    return result;
+}
+
+static void mapStatusCode(IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_008: [ The description shall be converted to lower case in place and the statusCode shall be set from it: "success" to IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS, "expired" to IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, "deliverycountexceeded" to IOTHUB_FEEDBACK_STATUS_CODE_DELIVER_COUNT_EXCEEDED, "rejected" to IOTHUB_FEEDBACK_STATUS_CODE_REJECTED and anything else, including a missing description, to IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN. ]*/
+    if (feedbackRecord->description == NULL)
+    {
+        feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
+    }
+    else
+    {
+        char* c;
+        for (c = feedbackRecord->description; *c != '\0'; c++)
+        {
+            if ((*c >= 'A') && (*c <= 'Z'))
+            {
+                *c = (char)(*c - 'A' + 'a');
+            }
+        }
+
+        if (strcmp(feedbackRecord->description, "success") == 0)
+        {
+            feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS;
+        }
+        else if (strcmp(feedbackRecord->description, "expired") == 0)
+        {
+            feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED;
+        }
+        else if (strcmp(feedbackRecord->description, "deliverycountexceeded") == 0)
+        {
+            feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_DELIVER_COUNT_EXCEEDED;
+        }
+        else if (strcmp(feedbackRecord->description, "rejected") == 0)
+        {
+            feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_REJECTED;
+        }
+        else
+        {
+            feedbackRecord->statusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
+        }
+    }
+}
+
+/*parses the value of a known key: a string, or null which leaves the field NULL*/
+static bool parseStringOrNull(FEEDBACK_PARSER* parser, char** value)
+{
+    bool result;
+    skipWhitespace(parser);
+    if (matchLiteral(parser, "null"))
+    {
+        *value = NULL;
+        result = true;
+    }
+    else
+    {
+        *value = parseString(parser);
+        result = (*value != NULL);
+    }
+    return result;
+}
+
+static bool parseRecord(FEEDBACK_PARSER* parser, IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    bool result;
+
+    /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_007: [ Fields that are not present in the record shall be NULL, correlationId shall be set to an empty string. ]*/
+    (void)memset(feedbackRecord, 0, sizeof(IOTHUB_SERVICE_FEEDBACK_RECORD));
+    feedbackRecord->correlationId = "";
+
+    if (!consumeChar(parser, '{'))
+    {
+        result = false;
+    }
+    else if (consumeChar(parser, '}'))
+    {
+        result = true;
+    }
+    else
+    {
+        do
+        {
+            char* key = parseString(parser);
+            char* value;
+            if ((key == NULL) || !consumeChar(parser, ':'))
+            {
+                result = false;
+            }
+            /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_006: [ The values of deviceId, deviceGenerationId, description, enqueuedTimeUtc and originalMessageId shall be set in the record, pointing into feedbackJson; any other member shall be skipped. ]*/
+            else if (strcmp(key, FEEDBACK_RECORD_KEY_DEVICE_ID) == 0)
+            {
+                result = parseStringOrNull(parser, &value);
+                feedbackRecord->deviceId = value;
+            }
+            else if (strcmp(key, FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID) == 0)
+            {
+                result = parseStringOrNull(parser, &value);
+                feedbackRecord->generationId = value;
+            }
+            else if (strcmp(key, FEEDBACK_RECORD_KEY_DESCRIPTION) == 0)
+            {
+                result = parseStringOrNull(parser, &value);
+                feedbackRecord->description = value;
+            }
+            else if (strcmp(key, FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC) == 0)
+            {
+                result = parseStringOrNull(parser, &value);
+                feedbackRecord->enqueuedTimeUtc = value;
+            }
+            else if (strcmp(key, FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID) == 0)
+            {
+                result = parseStringOrNull(parser, &value);
+                feedbackRecord->originalMessageId = value;
+            }
+            else
+            {
+                result = skipValue(parser);
+            }
+        } while (result && consumeChar(parser, ','));
+
+        result = result && consumeChar(parser, '}');
+    }
+
+    if (result)
+    {
+        mapStatusCode(feedbackRecord);
+    }
+    return result;
+}
+
+int IoTHubScFeedbackParser_Parse(char* feedbackJson, size_t length, IOTHUB_SC_FEEDBACK_RECORD_HANDLER recordHandler, void* context, size_t* recordCount)
+{
+    int result;
+
+    /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_001: [ If feedbackJson, recordHandler or recordCount is NULL then IoTHubScFeedbackParser_Parse shall fail and return a non-zero value. ]*/
+    if ((feedbackJson == NULL) || (recordHandler == NULL) || (recordCount == NULL))
+    {
+        LogError("Invalid argument feedbackJson=%p, recordHandler=%p, recordCount=%p", feedbackJson, recordHandler, recordCount);
+        result = __FAILURE__;
+    }
+    else
+    {
+        FEEDBACK_PARSER parser;
+        parser.current = feedbackJson;
+        parser.end = feedbackJson + length;
+        *recordCount = 0;
+
+        /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_002: [ IoTHubScFeedbackParser_Parse shall read feedbackJson once, without reading past length bytes and without allocating memory. ]*/
+        /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_003: [ If feedbackJson is not a JSON array of objects, optionally surrounded by whitespace, then IoTHubScFeedbackParser_Parse shall fail and return a non-zero value. ]*/
+        if (!consumeChar(&parser, '['))
+        {
+            LogError("Feedback message is not a JSON array");
+            result = __FAILURE__;
+        }
+        else
+        {
+            bool isValid = true;
+
+            if (!consumeChar(&parser, ']'))
+            {
+                do
+                {
+                    IOTHUB_SERVICE_FEEDBACK_RECORD feedbackRecord;
+                    if (!parseRecord(&parser, &feedbackRecord))
+                    {
+                        LogError("Malformed feedback record at index %lu", (unsigned long)*recordCount);
+                        isValid = false;
+                    }
+                    /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_004: [ IoTHubScFeedbackParser_Parse shall call recordHandler for every record, in order, as soon as the record is parsed. ]*/
+                    /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_005: [ If recordHandler returns a non-zero value then IoTHubScFeedbackParser_Parse shall stop and return a non-zero value. ]*/
+                    else if (recordHandler(context, &feedbackRecord) != 0)
+                    {
+                        LogError("Feedback record handler failed at index %lu", (unsigned long)*recordCount);
+                        isValid = false;
+                    }
+                    else
+                    {
+                        (*recordCount)++;
+                    }
+                } while (isValid && consumeChar(&parser, ','));
+
+                isValid = isValid && consumeChar(&parser, ']');
+            }
+
+            if (isValid)
+            {
+                /*senders that NUL terminate the body leave the terminator inside length*/
+                skipWhitespace(&parser);
+                while ((parser.current < parser.end) && (*parser.current == '\0'))
+                {
+                    parser.current++;
+                }
+                isValid = (parser.current == parser.end);
+            }
+
+            if (!isValid)
+            {
+                LogError("Failure parsing feedback message");
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_009: [ Otherwise IoTHubScFeedbackParser_Parse shall succeed and return 0. ]*/
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
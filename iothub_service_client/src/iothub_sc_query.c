@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "iothub_sc_query.h"
+
+#define  HTTP_HEADER_KEY_MAX_ITEM_COUNT  "x-ms-max-item-count"
+#define  HTTP_HEADER_KEY_CONTINUATION  "x-ms-continuation"
+
+static const unsigned char* skipJsonWhitespace(const unsigned char* position, const unsigned char* end)
+{
+    while ((position < end) && isspace(*position))
+    {
+        position++;
+    }
+    return position;
+}
+
+/*finds the end of the JSON object starting at objectStart, returns NULL if the object is not complete before end*/
+static unsigned char* findJsonObjectEnd(unsigned char* objectStart, const unsigned char* end)
+{
+    unsigned char* result = NULL;
+    unsigned char* position = objectStart;
+    size_t depth = 0;
+    bool isInString = false;
+
+    while ((result == NULL) && (position < end))
+    {
+        if (isInString)
+        {
+            if (*position == '\\')
+            {
+                position++;
+            }
+            else if (*position == '"')
+            {
+                isInString = false;
+            }
+        }
+        else if (*position == '"')
+        {
+            isInString = true;
+        }
+        else if ((*position == '{') || (*position == '['))
+        {
+            depth++;
+        }
+        else if ((*position == '}') || (*position == ']'))
+        {
+            depth--;
+            if (depth == 0)
+            {
+                result = position + 1;
+            }
+        }
+        position++;
+    }
+
+    return result;
+}
+
+IOTHUB_SC_QUERY_RESULT IoTHubScQuery_ParsePage(BUFFER_HANDLE pageBuffer, IOTHUB_SC_QUERY_RESULT_CALLBACK resultCallback, void* context, bool* isStopped)
+{
+    IOTHUB_SC_QUERY_RESULT result;
+
+    /*Codes_SRS_IOTHUB_SC_QUERY_02_009: [ If pageBuffer, resultCallback or isStopped is NULL then IoTHubScQuery_ParsePage shall fail and return IOTHUB_SC_QUERY_INVALID_ARG. ]*/
+    if ((pageBuffer == NULL) || (resultCallback == NULL) || (isStopped == NULL))
+    {
+        LogError("Invalid argument pageBuffer=%p resultCallback=%p isStopped=%p", pageBuffer, resultCallback, isStopped);
+        result = IOTHUB_SC_QUERY_INVALID_ARG;
+    }
+    else
+    {
+        unsigned char* page = BUFFER_u_char(pageBuffer);
+        size_t pageLength = BUFFER_length(pageBuffer);
+
+        if ((page == NULL) || (pageLength == 0))
+        {
+            /*Codes_SRS_IOTHUB_SC_QUERY_02_010: [ If the page is not a JSON array of objects, optionally surrounded by whitespace, IoTHubScQuery_ParsePage shall return IOTHUB_SC_QUERY_JSON_ERROR. ]*/
+            LogError("query response is empty");
+            result = IOTHUB_SC_QUERY_JSON_ERROR;
+        }
+        else
+        {
+            const unsigned char* end = page + pageLength;
+            unsigned char* position = (unsigned char*)skipJsonWhitespace(page, end);
+
+            if ((position == end) || (*position != '['))
+            {
+                /*Codes_SRS_IOTHUB_SC_QUERY_02_010: [ If the page is not a JSON array of objects, optionally surrounded by whitespace, IoTHubScQuery_ParsePage shall return IOTHUB_SC_QUERY_JSON_ERROR. ]*/
+                LogError("query response is not a JSON array");
+                result = IOTHUB_SC_QUERY_JSON_ERROR;
+            }
+            else
+            {
+                bool isFirst = true;
+                bool isDone = false;
+
+                result = IOTHUB_SC_QUERY_OK;
+                position++;
+
+                while ((result == IOTHUB_SC_QUERY_OK) && (!isDone) && (!*isStopped))
+                {
+                    unsigned char* objectEnd;
+
+                    position = (unsigned char*)skipJsonWhitespace(position, end);
+                    if (position == end)
+                    {
+                        /*Codes_SRS_IOTHUB_SC_QUERY_02_010: [ If the page is not a JSON array of objects, optionally surrounded by whitespace, IoTHubScQuery_ParsePage shall return IOTHUB_SC_QUERY_JSON_ERROR. ]*/
+                        LogError("query response array is not terminated");
+                        result = IOTHUB_SC_QUERY_JSON_ERROR;
+                    }
+                    else if (*position == ']')
+                    {
+                        isDone = true;
+                    }
+                    else if ((!isFirst) && (*position != ','))
+                    {
+                        /*Codes_SRS_IOTHUB_SC_QUERY_02_010: [ If the page is not a JSON array of objects, optionally surrounded by whitespace, IoTHubScQuery_ParsePage shall return IOTHUB_SC_QUERY_JSON_ERROR. ]*/
+                        LogError("missing separator between query results");
+                        result = IOTHUB_SC_QUERY_JSON_ERROR;
+                    }
+                    else if (((position = (unsigned char*)skipJsonWhitespace(isFirst ? position : position + 1, end)) == end) || (*position != '{') ||
+                        ((objectEnd = findJsonObjectEnd(position, end)) == NULL) || (objectEnd == end))
+                    {
+                        /*Codes_SRS_IOTHUB_SC_QUERY_02_010: [ If the page is not a JSON array of objects, optionally surrounded by whitespace, IoTHubScQuery_ParsePage shall return IOTHUB_SC_QUERY_JSON_ERROR. ]*/
+                        LogError("query result is not a complete JSON object");
+                        result = IOTHUB_SC_QUERY_JSON_ERROR;
+                    }
+                    else
+                    {
+                        /*the byte after the object is a separator or the closing bracket, it is borrowed to terminate the object*/
+                        unsigned char separator = *objectEnd;
+
+                        /*Codes_SRS_IOTHUB_SC_QUERY_02_011: [ IoTHubScQuery_ParsePage shall call resultCallback with the NUL terminated JSON text of every object of the page, in order, as soon as the object is found. ]*/
+                        /*Codes_SRS_IOTHUB_SC_QUERY_02_012: [ If resultCallback returns a non-zero value IoTHubScQuery_ParsePage shall set *isStopped to true and return IOTHUB_SC_QUERY_OK without reading the rest of the page. ]*/
+                        *objectEnd = '\0';
+                        *isStopped = (resultCallback(context, (const char*)position) != 0);
+                        *objectEnd = separator;
+
+                        position = objectEnd;
+                        isFirst = false;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static HTTP_HEADERS_HANDLE createQueryHttpHeader(IOTHUB_SC_QUERY_CREATE_HEADERS createRequestHeaders, size_t pageSize, const char* continuationToken)
+{
+    HTTP_HEADERS_HANDLE result;
+    char pageSizeString[32];
+
+    if ((result = createRequestHeaders()) == NULL)
+    {
+        LogError("HttpHeader creation failed");
+    }
+    else if ((snprintf(pageSizeString, sizeof(pageSizeString), "%lu", (unsigned long)pageSize) <= 0) ||
+        (HTTPHeaders_AddHeaderNameValuePair(result, HTTP_HEADER_KEY_MAX_ITEM_COUNT, pageSizeString) != HTTP_HEADERS_OK))
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for max item count header");
+        HTTPHeaders_Free(result);
+        result = NULL;
+    }
+    else if ((continuationToken != NULL) && (HTTPHeaders_AddHeaderNameValuePair(result, HTTP_HEADER_KEY_CONTINUATION, continuationToken) != HTTP_HEADERS_OK))
+    {
+        LogError("HTTPHeaders_AddHeaderNameValuePair failed for continuation header");
+        HTTPHeaders_Free(result);
+        result = NULL;
+    }
+
+    return result;
+}
+
+/*sends one page request and replaces *continuationToken with the token of the next page, NULL when this was the last page*/
+static IOTHUB_SC_QUERY_RESULT sendQueryPageRequest(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, IOTHUB_SC_QUERY_CREATE_HEADERS createRequestHeaders, BUFFER_HANDLE requestBody, size_t pageSize, char** continuationToken, BUFFER_HANDLE pageBuffer)
+{
+    IOTHUB_SC_QUERY_RESULT result;
+    HTTP_HEADERS_HANDLE requestHeaders;
+    HTTP_HEADERS_HANDLE responseHeaders;
+    unsigned int statusCode = 0;
+
+    /*Codes_SRS_IOTHUB_SC_QUERY_02_003: [ For every page IoTHubScQuery_Execute shall create the request headers by calling createRequestHeaders and add the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. ]*/
+    if ((requestHeaders = createQueryHttpHeader(createRequestHeaders, pageSize, *continuationToken)) == NULL)
+    {
+        /*Codes_SRS_IOTHUB_SC_QUERY_02_008: [ If any other call fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_ERROR. ]*/
+        result = IOTHUB_SC_QUERY_ERROR;
+    }
+    else
+    {
+        if ((responseHeaders = HTTPHeaders_Alloc()) == NULL)
+        {
+            /*Codes_SRS_IOTHUB_SC_QUERY_02_008: [ If any other call fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_ERROR. ]*/
+            LogError("HTTPHeaders_Alloc failed for response headers");
+            result = IOTHUB_SC_QUERY_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUB_SC_QUERY_02_004: [ IoTHubScQuery_Execute shall execute every page request by calling IoTHubScConnectionPool_ExecuteRequest with requestType, relativePath and requestBody, receiving every page in the same buffer. ]*/
+            if (IoTHubScConnectionPool_ExecuteRequest(connectionPool, requestType, relativePath, requestHeaders, requestBody, &statusCode, responseHeaders, pageBuffer) != HTTPAPIEX_OK)
+            {
+                /*Codes_SRS_IOTHUB_SC_QUERY_02_005: [ If a request fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_HTTPAPI_ERROR, if its status code is 300 or above it shall return IOTHUB_SC_QUERY_HTTP_STATUS_ERROR. ]*/
+                LogError("IoTHubScConnectionPool_ExecuteRequest failed");
+                result = IOTHUB_SC_QUERY_HTTPAPI_ERROR;
+            }
+            else if (statusCode >= 300)
+            {
+                /*Codes_SRS_IOTHUB_SC_QUERY_02_005: [ If a request fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_HTTPAPI_ERROR, if its status code is 300 or above it shall return IOTHUB_SC_QUERY_HTTP_STATUS_ERROR. ]*/
+                LogError("Http Failure status code %u.", statusCode);
+                result = IOTHUB_SC_QUERY_HTTP_STATUS_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUB_SC_QUERY_02_006: [ IoTHubScQuery_Execute shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+                const char* nextToken = HTTPHeaders_FindHeaderValue(responseHeaders, HTTP_HEADER_KEY_CONTINUATION);
+
+                free(*continuationToken);
+                *continuationToken = NULL;
+
+                if ((nextToken != NULL) && (*nextToken != '\0') && (mallocAndStrcpy_s(continuationToken, nextToken) != 0))
+                {
+                    /*Codes_SRS_IOTHUB_SC_QUERY_02_008: [ If any other call fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_ERROR. ]*/
+                    LogError("Failed to copy continuation token");
+                    result = IOTHUB_SC_QUERY_ERROR;
+                }
+                else
+                {
+                    result = IOTHUB_SC_QUERY_OK;
+                }
+            }
+            HTTPHeaders_Free(responseHeaders);
+        }
+        HTTPHeaders_Free(requestHeaders);
+    }
+
+    return result;
+}
+
+IOTHUB_SC_QUERY_RESULT IoTHubScQuery_Execute(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, IOTHUB_SC_QUERY_CREATE_HEADERS createRequestHeaders, BUFFER_HANDLE requestBody, size_t pageSize, IOTHUB_SC_QUERY_RESULT_CALLBACK resultCallback, void* context)
+{
+    IOTHUB_SC_QUERY_RESULT result;
+
+    /*Codes_SRS_IOTHUB_SC_QUERY_02_001: [ If connectionPool, relativePath, createRequestHeaders or resultCallback is NULL, or pageSize is 0, IoTHubScQuery_Execute shall fail and return IOTHUB_SC_QUERY_INVALID_ARG. ]*/
+    if ((connectionPool == NULL) || (relativePath == NULL) || (createRequestHeaders == NULL) || (resultCallback == NULL) || (pageSize == 0))
+    {
+        LogError("Invalid argument connectionPool=%p relativePath=%p createRequestHeaders=%p resultCallback=%p pageSize=%lu", connectionPool, relativePath, createRequestHeaders, resultCallback, (unsigned long)pageSize);
+        result = IOTHUB_SC_QUERY_INVALID_ARG;
+    }
+    else
+    {
+        BUFFER_HANDLE pageBuffer;
+
+        /*Codes_SRS_IOTHUB_SC_QUERY_02_002: [ IoTHubScQuery_Execute shall create a single response buffer that is reused for every page. ]*/
+        if ((pageBuffer = BUFFER_new()) == NULL)
+        {
+            /*Codes_SRS_IOTHUB_SC_QUERY_02_008: [ If any other call fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_ERROR. ]*/
+            LogError("BUFFER_new failed for response");
+            result = IOTHUB_SC_QUERY_ERROR;
+        }
+        else
+        {
+            char* continuationToken = NULL;
+            bool isStopped = false;
+
+            do
+            {
+                if ((result = sendQueryPageRequest(connectionPool, requestType, relativePath, createRequestHeaders, requestBody, pageSize, &continuationToken, pageBuffer)) == IOTHUB_SC_QUERY_OK)
+                {
+                    /*Codes_SRS_IOTHUB_SC_QUERY_02_007: [ IoTHubScQuery_Execute shall hand every page to IoTHubScQuery_ParsePage and, if resultCallback stops it, return IOTHUB_SC_QUERY_OK without requesting further pages. ]*/
+                    result = IoTHubScQuery_ParsePage(pageBuffer, resultCallback, context, &isStopped);
+                }
+            } while ((result == IOTHUB_SC_QUERY_OK) && (continuationToken != NULL) && (!isStopped));
+
+            free(continuationToken);
+            BUFFER_delete(pageBuffer);
+        }
+    }
+
+    return result;
+}
@@ -24,6 +24,7 @@ static void free_service_client_auth(IOTHUB_SERVICE_CLIENT_AUTH* authInfo)
     free(authInfo->sharedAccessKey);
     free(authInfo->keyName);
     free(authInfo->deviceId);
+    IoTHubScConnectionPool_Destroy(authInfo->connectionPool);
     free(authInfo);
 }
 
@@ -230,6 +231,14 @@ IOTHUB_SERVICE_CLIENT_AUTH_HANDLE IoTHubServiceClientAuth_CreateFromConnectionSt
                         free_service_client_auth(result);
                         result = NULL;
                     }
+                    /*Codes_SRS_IOTHUBSERVICECLIENT_02_001: [** IoTHubServiceClientAuth_CreateFromConnectionString shall create the connection pool shared by all the service client handles created from it by calling IoTHubScConnectionPool_Create. **] */
+                    else if ((result->connectionPool = IoTHubScConnectionPool_Create(result->hostname, result->sharedAccessKey, result->keyName, result->deviceId)) == NULL)
+                    {
+                        /*Codes_SRS_IOTHUBSERVICECLIENT_02_002: [** If the IoTHubScConnectionPool_Create fails, IoTHubServiceClientAuth_CreateFromConnectionString shall do clean up and return NULL. **] */
+                        LogError("IoTHubScConnectionPool_Create failed");
+                        free_service_client_auth(result);
+                        result = NULL;
+                    }
                     /*Codes_SRS_IOTHUBSERVICECLIENT_12_006: [** If the IOTHUB_SERVICE_CLIENT_AUTH has been populated IoTHubServiceClientAuth_CreateFromConnectionString shall do clean up and return with a IOTHUB_SERVICE_CLIENT_AUTH_HANDLE to it **] */
                     STRING_delete(token_key_string);
                     STRING_delete(token_value_string);
@@ -250,6 +259,7 @@ void IoTHubServiceClientAuth_Destroy(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE serviceCl
     if (serviceClientHandle != NULL)
     {
         /*Codes_SRS_IOTHUBSERVICECLIENT_12_008: [** If the serviceClientHandle input parameter is not NULL IoTHubServiceClient_Destroy shall free the memory of it and return **]*/
+        /*Codes_SRS_IOTHUBSERVICECLIENT_02_003: [** IoTHubServiceClient_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. **]*/
         free_service_client_auth((IOTHUB_SERVICE_CLIENT_AUTH*)serviceClientHandle);
     }
 }
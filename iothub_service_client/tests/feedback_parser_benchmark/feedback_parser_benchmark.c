@@ -0,0 +1,163 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*parses synthetic feedback batches with IoTHubScFeedbackParser_Parse and with parson and prints the throughput of both*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "parson.h"
+#include "iothub_sc_feedback_parser.h"
+
+#define MIN_MEASURE_SECONDS 1.0
+#define CLOCK_SAMPLING_ITERATIONS 4
+
+static const size_t recordCounts[] = { 10, 1000, 10000 };
+
+static const char* const descriptions[] = { "Success", "Expired", "DeliveryCountExceeded", "Rejected" };
+
+/*builds the body the service sends on the feedback endpoint, one object per record*/
+static char* createFeedbackBatch(size_t recordCount, size_t* length)
+{
+    size_t capacity = 256 * recordCount + 3;
+    char* result = (char*)malloc(capacity);
+    if (result != NULL)
+    {
+        size_t position = 0;
+        size_t i;
+
+        result[position++] = '[';
+        for (i = 0; i < recordCount; i++)
+        {
+            position += (size_t)sprintf(result + position,
+                "%s{\"originalMessageId\":\"%08lx-4d4b-4c1e-9a2f-6c1b0e5f%04lx\",\"description\":\"%s\",\"deviceGenerationId\":\"6364%08lu\",\"deviceId\":\"device%lu\",\"enqueuedTimeUtc\":\"2017-11-%02luT10:%02lu:00.0000000Z\"}",
+                (i == 0) ? "" : ",",
+                (unsigned long)i, (unsigned long)(i % 0x10000),
+                descriptions[i % (sizeof(descriptions) / sizeof(descriptions[0]))],
+                (unsigned long)i, (unsigned long)(i % 500),
+                (unsigned long)(1 + (i % 28)), (unsigned long)(i % 60));
+        }
+        result[position++] = ']';
+        result[position] = '\0';
+        *length = position;
+    }
+    return result;
+}
+
+static int countRecord(void* context, IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    *(size_t*)context += (size_t)feedbackRecord->statusCode;
+    return 0;
+}
+
+static int parseWithFeedbackParser(char* scratch, const char* batch, size_t length, size_t* checksum)
+{
+    size_t recordCount;
+    /*the parser works in place, so every iteration parses a fresh copy, as the messaging client does*/
+    (void)memcpy(scratch, batch, length);
+    return IoTHubScFeedbackParser_Parse(scratch, length, countRecord, checksum, &recordCount);
+}
+
+/*what the messaging client did before: build the whole DOM, then look every member up*/
+static int parseWithParson(char* scratch, const char* batch, size_t length, size_t* checksum)
+{
+    int result;
+    JSON_Value* root;
+
+    (void)memcpy(scratch, batch, length + 1);
+    if ((root = json_parse_string(scratch)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        JSON_Array* records = json_value_get_array(root);
+        size_t count = json_array_get_count(records);
+        size_t i;
+
+        for (i = 0; i < count; i++)
+        {
+            JSON_Object* record = json_array_get_object(records, i);
+            const char* description = json_object_get_string(record, "description");
+            *checksum += (json_object_get_string(record, "deviceId") != NULL) ? 1 : 0;
+            *checksum += (json_object_get_string(record, "deviceGenerationId") != NULL) ? 1 : 0;
+            *checksum += (json_object_get_string(record, "enqueuedTimeUtc") != NULL) ? 1 : 0;
+            *checksum += (json_object_get_string(record, "originalMessageId") != NULL) ? 1 : 0;
+            *checksum += (description != NULL) ? strlen(description) : 0;
+        }
+        json_value_free(root);
+        result = 0;
+    }
+    return result;
+}
+
+typedef int(*PARSE_FUNCTION)(char* scratch, const char* batch, size_t length, size_t* checksum);
+
+static int measure(const char* name, PARSE_FUNCTION parse, char* scratch, const char* batch, size_t length, size_t recordCount)
+{
+    int result = 0;
+    unsigned long iterations = 0;
+    size_t checksum = 0;
+    clock_t start = clock();
+    double seconds = 0.0;
+
+    do
+    {
+        if (parse(scratch, batch, length, &checksum) != 0)
+        {
+            (void)printf("%s failed parsing a batch of %lu records\n", name, (unsigned long)recordCount);
+            result = __LINE__;
+            break;
+        }
+        iterations++;
+        /*clock() is not free, look at it only every few batches*/
+        if ((iterations % CLOCK_SAMPLING_ITERATIONS) == 0)
+        {
+            seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        }
+    } while (seconds < MIN_MEASURE_SECONDS);
+
+    if (result == 0)
+    {
+        (void)printf("%-16s %10lu %12lu %12.1f %12.3f %12.1f\n",
+            name,
+            (unsigned long)recordCount,
+            iterations,
+            seconds * 1000000.0 / iterations,
+            seconds * 1000000000.0 / ((double)iterations * recordCount),
+            ((double)length * iterations) / (seconds * 1024.0 * 1024.0));
+    }
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+    size_t i;
+
+    (void)printf("%-16s %10s %12s %12s %12s %12s\n", "parser", "records", "iterations", "us/batch", "ns/record", "MB/s");
+
+    for (i = 0; (result == 0) && (i < sizeof(recordCounts) / sizeof(recordCounts[0])); i++)
+    {
+        size_t length = 0;
+        char* batch = createFeedbackBatch(recordCounts[i], &length);
+        char* scratch = (batch == NULL) ? NULL : (char*)malloc(length + 1);
+
+        if ((batch == NULL) || (scratch == NULL))
+        {
+            (void)printf("failure allocating a batch of %lu records\n", (unsigned long)recordCounts[i]);
+            result = __LINE__;
+        }
+        else if ((result = measure("feedback_parser", parseWithFeedbackParser, scratch, batch, length, recordCounts[i])) == 0)
+        {
+            result = measure("parson", parseWithParson, scratch, batch, length, recordCounts[i]);
+        }
+
+        free(scratch);
+        free(batch);
+    }
+
+    return result;
+}
@@ -58,7 +58,7 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
 
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
+#include "iothub_sc_connection_pool.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/singlylinkedlist.h"
 #include "parson.h"
@@ -156,30 +156,6 @@ void my_BUFFER_delete(BUFFER_HANDLE handle)
     my_gballoc_free(handle);
 }
 
-HTTPAPIEX_HANDLE my_HTTPAPIEX_Create(const char* hostName)
-{
-    (void)hostName;
-    return (HTTPAPIEX_HANDLE)my_gballoc_malloc(1);
-}
-
-void my_HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
-{
-    my_gballoc_free(handle);
-}
-
-HTTPAPIEX_SAS_HANDLE my_HTTPAPIEX_SAS_Create(STRING_HANDLE key, STRING_HANDLE uriResource, STRING_HANDLE keyName)
-{
-    (void)key;
-    (void)uriResource;
-    (void)keyName;
-    return (HTTPAPIEX_SAS_HANDLE)my_gballoc_malloc(1);
-}
-
-void my_HTTPAPIEX_SAS_Destroy(HTTPAPIEX_SAS_HANDLE handle)
-{
-    my_gballoc_free(handle);
-}
-
 
 typedef struct LIST_ITEM_INSTANCE_TAG
 {
@@ -201,10 +177,12 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
 } IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION;
 
 static IOTHUB_SERVICE_CLIENT_AUTH TEST_IOTHUB_SERVICE_CLIENT_AUTH;
 static IOTHUB_SERVICE_CLIENT_AUTH_HANDLE TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_AUTH;
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4242;
 
 static IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION TEST_IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION;
 static IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION_HANDLE TEST_IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION;
@@ -465,7 +443,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_CONNECTION_POOL_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(JSON_Value_Type, int);
     REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
@@ -504,18 +482,11 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_ERROR);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
-
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Destroy, my_HTTPAPIEX_Destroy);
-
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Create, my_HTTPAPIEX_SAS_Create);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_Clone, TEST_CONNECTION_POOL_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_Clone, NULL);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Destroy, my_HTTPAPIEX_SAS_Destroy);
-
-    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_OK);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_ERROR);
 
     REGISTER_GLOBAL_MOCK_RETURN(json_value_init_object, TEST_JSON_VALUE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_init_object, NULL);
@@ -614,6 +585,7 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubName = TEST_IOTHUBNAME;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubSuffix = TEST_IOTHUBSUFFIX;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.connectionPool = TEST_CONNECTION_POOL_HANDLE;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
 }
 
@@ -709,6 +681,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Create_return_null_if_input_parameter_se
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_010: [ IoTHubDeviceConfiguration_Create shall allocate memory and copy iothubSuffix to result->iothubSuffix by calling mallocAndStrcpy_s. ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_012: [ IoTHubDeviceConfiguration_Create shall allocate memory and copy sharedAccessKey to result->sharedAccessKey by calling mallocAndStrcpy_s. ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_014: [ IoTHubDeviceConfiguration_Create shall allocate memory and copy keyName to `result->keyName` by calling mallocAndStrcpy_s. ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_02_001: [ IoTHubDeviceConfiguration_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_Create_happy_path)
 {
     ///arrange
@@ -716,6 +689,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Create_happy_path)
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
 
     ///act
     IOTHUB_SERVICE_CLIENT_DEVICE_CONFIGURATION_HANDLE result = IoTHubDeviceConfiguration_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
@@ -727,6 +701,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Create_happy_path)
     ASSERT_ARE_EQUAL(char_ptr, result->hostname, TEST_HOSTNAME);
     ASSERT_ARE_EQUAL(char_ptr, result->sharedAccessKey, TEST_SHAREDACCESSKEY);
     ASSERT_ARE_EQUAL(char_ptr, result->keyName, TEST_SHAREDACCESSKEYNAME);
+    ASSERT_ARE_EQUAL(void_ptr, result->connectionPool, TEST_CONNECTION_POOL_HANDLE);
 
     ///cleanup
     if (result != NULL)
@@ -745,6 +720,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Create_happy_path)
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_011: [ If the mallocAndStrcpy_s fails, IoTHubDeviceConfiguration_Create shall do clean up and return NULL. ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_013: [ If the mallocAndStrcpy_s fails, IoTHubDeviceConfiguration_Create shall do clean up and return NULL. ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_015: [ If the mallocAndStrcpy_s fails, IoTHubDeviceConfiguration_Create shall do clean up and return NULL. ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubDeviceConfiguration_Create shall do clean up and return NULL. ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_Create_non_happy_path)
 {
     ///arrange
@@ -755,6 +731,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Create_non_happy_path)
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, (const char*)(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE->hostname)));
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, (const char*)(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE->iothubName)));
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, (const char*)(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE->keyName)));
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
 
     umock_c_negative_tests_snapshot();
 
@@ -789,6 +766,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Destroy_return_if_input_parameter_servic
 }
 
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_017: [ If the serviceClientDeviceConfigurationHandle input parameter is not NULL IoTHubDeviceConfiguration_Destroy shall free the memory of it and return ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_02_003: [ IoTHubDeviceConfiguration_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_Destroy_do_clean_up_and_return_if_input_parameter_serviceClientDeviceConfigurationHandle_is_not_NULL)
 {
     ///arrange
@@ -800,6 +778,7 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_Destroy_do_clean_up_and_return_if_input_
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Destroy(TEST_CONNECTION_POOL_HANDLE));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     ///act
@@ -890,10 +869,6 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_AddConfiguration_return_NULL_if_input_pa
 
 static void set_expected_calls_for_sendHttpRequestDeviceConfiguration(const unsigned int httpStatusCode, HTTPAPI_REQUEST_TYPE requestType, IOTHUB_DEVICECONFIGURATION_REQUEST_MODE hubRequestType)
 {
-    EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEY));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEYNAME));
-
     EXPECTED_CALL(HTTPHeaders_Alloc());
     EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION));
     EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
@@ -911,25 +886,15 @@ static void set_expected_calls_for_sendHttpRequestDeviceConfiguration(const unsi
 
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
-
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, requestType, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+    EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, requestType, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments()
         .CopyOutArgumentBuffer_statusCode(&httpStatusCode, sizeof(httpStatusCode))
         .SetReturn(HTTPAPIEX_OK);
 
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(HTTPAPIEX_SAS_Destroy(IGNORED_PTR_ARG));
     EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 }
 
 static void set_expected_calls_for_parseDeviceConfigurationJsonObject()
@@ -1085,9 +1050,9 @@ static void set_expected_calls_for_AddConfiguration_UpdateConfiguration_processi
 
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_019: [ IoTHubDeviceConfiguration_AddConfiguration shall create HTTP PUT request URL using the given configurationId using the following format: url/configurations/[configurationId] ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_020: [ IoTHubDeviceConfiguration_AddConfiguration shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=<generatedGuid>,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_AddConfiguration shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_AddConfiguration shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_AddConfiguration shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_AddConfiguration shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_AddConfiguration shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_AddConfiguration shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_030: [ Otherwise IoTHubDeviceConfiguration_AddConfiguration shall save the received configuration to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_AddConfiguration_happy_path_status_code_200)
 {
@@ -1179,41 +1144,36 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_AddConfiguration_non_happy_path)
             (i != 27) && //json_free_serialized_string
             (i != 28) && //json_object_clear
             (i != 29) && //json_value_free
-            (i != 37) && //UniqueId_Generate
-            (i != 42) && //gballoc_free
-            (i != 45) && //STRING_c_str
-            (i != 47) && //STRING_c_str
-            (i != 48) && //HTTPAPIEX_Destroy
-            (i != 49) && //STRING_c_str
-            (i != 50) && //HTTPAPIEX_Destroy
-            (i != 51) && //HTTPAPIEX_SAS_Destroy
-            (i != 52) && //HTTPHeaders_Free
-            (i != 53) && //STRING_delete
-            (i != 57) && //STRING_delete
-            (i != 58) && //STRING_delete
-            (i != 59) && //json_serialize_to_string
-            (i != 60) && //json_object_dotget_value
-            (i != 61) && //json_serialize_to_string
-            (i != 62) && //json_object_get_string
-            (i != 63) && //json_object_get_string
-            (i != 64) && //json_object_get_string
-            (i != 65) && //json_object_get_string
-            (i != 66) && //json_object_get_string
-            (i != 67) && //json_object_dotget_object
-            (i != 72) && //json_object_dotget_object
-            (i != 81) && //json_object_get_number
-            (i != 82) && //json_object_get_count
-            (i != 83) && //json_object_get_count
-            (i != 84) && //json_object_get_count
-            (i != 85) && //json_object_get_count
-            (i != 86) && //json_object_get_count
-            (i != 87) && //STRING_delete
-            (i != 88) && //STRING_delete
-            (i != 89) && //json_object_clear
-            (i != 90) && //json_value_free
-            (i != 91) && //BUFFER_delete
-            (i != 92) && //BUFFER_delete
-            (i != 93)    //gballoc_free
+            (i != 34) && //UniqueId_Generate
+            (i != 39) && //gballoc_free
+            (i != 40) && //STRING_c_str
+            (i != 42) && //STRING_delete
+            (i != 43) && //HTTPHeaders_Free
+            (i != 47) && //STRING_delete
+            (i != 48) && //STRING_delete
+            (i != 49) && //json_serialize_to_string
+            (i != 50) && //json_object_dotget_value
+            (i != 51) && //json_serialize_to_string
+            (i != 52) && //json_object_get_string
+            (i != 53) && //json_object_get_string
+            (i != 54) && //json_object_get_string
+            (i != 55) && //json_object_get_string
+            (i != 56) && //json_object_get_string
+            (i != 57) && //json_object_dotget_object
+            (i != 62) && //json_object_dotget_object
+            (i != 71) && //json_object_get_number
+            (i != 72) && //json_object_get_count
+            (i != 73) && //json_object_get_count
+            (i != 74) && //json_object_get_count
+            (i != 75) && //json_object_get_count
+            (i != 76) && //json_object_get_count
+            (i != 77) && //STRING_delete
+            (i != 78) && //STRING_delete
+            (i != 79) && //json_object_clear
+            (i != 80) && //json_value_free
+            (i != 81) && //BUFFER_delete
+            (i != 82) && //BUFFER_delete
+            (i != 83)    //gballoc_free
             )
         {
             IOTHUB_DEVICE_CONFIGURATION_RESULT result = IoTHubDeviceConfiguration_AddConfiguration(handle, &deviceConfigurationAddInfo, &deviceConfiguration);
@@ -1268,9 +1228,9 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_GetConfiguration_return_NULL_if_input_pa
 
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_019: [ IoTHubDeviceConfiguration_GetConfiguration shall create HTTP GET request URL using the given configurationId using the following format: url/configurations/[configurationId] ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_020: [ IoTHubDeviceConfiguration_GetConfiguration shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=<generatedGuid>,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_GetConfiguration shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_GetConfiguration shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_GetConfiguration shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_GetConfiguration shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_GetConfiguration shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_GetConfiguration shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_030: [ Otherwise IoTHubDeviceConfiguration_GetConfiguration shall save the received configuration to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_GetConfiguration_happy_path_status_code_200)
 {
@@ -1361,9 +1321,9 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_GetConfigurations_return_NULL_if_input_p
 
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_019: [ IoTHubDeviceConfiguration_GetConfigurations shall create HTTP GET request URL using the given configurationId using the following format: url/configurations?top=<n> ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_020: [ IoTHubDeviceConfiguration_GetConfigurations shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=<generatedGuid>,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_GetConfigurations shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_GetConfigurations shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_GetConfigurations shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_GetConfigurations shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_GetConfigurations shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_GetConfigurations shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_030: [ Otherwise IoTHubDeviceConfiguration_GetConfigurations shall save the received configuration to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_GetConfigurations_happy_path_status_code_200)
 {
@@ -1442,56 +1402,51 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_GetConfigurations_non_happy_path)
 
         ////act
         if (
-            (i != 7) && //UniqueId_Generate
-            (i != 12) && //gballoc_free
-            (i != 15) && //STRING_c_str
-            (i != 17) && //STRING_delete
-            (i != 18) && //HTTPAPIEX_Destroy
-            (i != 19) && //HTTPAPIEX_SAS_Destroy
-            (i != 20) && //HTTPHeaders_Free
-            (i != 21) && //STRING_delete
-            (i != 22) && //STRING_delete
-            (i != 23) && //STRING_delete
-            (i != 27) && //json_value_get_array
-            (i != 28) && //json_array_get_count
-            (i != 29) && //json_array_get_object
+            (i != 4) && //UniqueId_Generate
+            (i != 9) && //gballoc_free
+            (i != 10) && //STRING_c_str
+            (i != 12) && //STRING_delete
+            (i != 13) && //HTTPHeaders_Free
+            (i != 17) && //json_value_get_array
+            (i != 18) && //json_array_get_count
+            (i != 19) && //json_array_get_object
+            (i != 20) && //json_object_get_string
+            (i != 21) && //json_object_get_string
+            (i != 22) && //json_object_dotget_value
+            (i != 23) && //json_serialize_to_string
+            (i != 24) && //json_object_dotget_value
+            (i != 25) && //json_serialize_to_string
+            (i != 26) && //json_object_get_string
+            (i != 27) && //json_object_get_string
+            (i != 28) && //json_object_get_string
+            (i != 29) && //json_object_get_string
             (i != 30) && //json_object_get_string
-            (i != 31) && //json_object_get_string
-            (i != 32) && //json_object_dotget_value
-            (i != 33) && //json_serialize_to_string
-            (i != 34) && //json_object_dotget_value
-            (i != 35) && //json_serialize_to_string
-            (i != 36) && //json_object_get_string
-            (i != 37) && //json_object_get_string
-            (i != 38) && //json_object_get_string
-            (i != 39) && //json_object_get_string
-            (i != 40) && //json_object_get_string
-            (i != 41) && //json_object_dotget_object
-            (i != 42) && //json_object_dotget_object
-            (i != 43) && //json_object_dotget_object
-            (i != 44) && //json_object_dotget_object
-            (i != 45) && //json_object_dotget_object
-            (i != 53) && //json_object_get_number
-            (i != 54) && //json_object_get_count
-            (i != 55) && //json_object_get_count
-            (i != 56) && //json_object_get_count
-            (i != 57) && //json_object_get_count
-            (i != 58) && //json_object_get_count
-            (i != 59) && //STRING_delete
-            (i != 60) && //STRING_delete
-            (i != 71) && //json_object_clear
-            (i != 72) && //gballoc_free
-            (i != 73) && //gballoc_free
-            (i != 74) && //gballoc_free
-            (i != 75) && //gballoc_free
-            (i != 76) && //gballoc_free
-            (i != 77) && //gballoc_free
-            (i != 78) && //gballoc_free
-            (i != 79) && //gballoc_free
-            (i != 80) && //json_array_clear
-            (i != 81) && //json_value_free
-            (i != 82) && //BUFFER_delete
-            (i != 83)    //BUFFER_delete
+            (i != 31) && //json_object_dotget_object
+            (i != 32) && //json_object_dotget_object
+            (i != 33) && //json_object_dotget_object
+            (i != 34) && //json_object_dotget_object
+            (i != 35) && //json_object_dotget_object
+            (i != 43) && //json_object_get_number
+            (i != 44) && //json_object_get_count
+            (i != 45) && //json_object_get_count
+            (i != 46) && //json_object_get_count
+            (i != 47) && //json_object_get_count
+            (i != 48) && //json_object_get_count
+            (i != 49) && //STRING_delete
+            (i != 50) && //STRING_delete
+            (i != 61) && //json_object_clear
+            (i != 62) && //gballoc_free
+            (i != 63) && //gballoc_free
+            (i != 64) && //gballoc_free
+            (i != 65) && //gballoc_free
+            (i != 66) && //gballoc_free
+            (i != 67) && //gballoc_free
+            (i != 68) && //gballoc_free
+            (i != 69) && //gballoc_free
+            (i != 70) && //json_array_clear
+            (i != 71) && //json_value_free
+            (i != 72) && //BUFFER_delete
+            (i != 73)    //BUFFER_delete
             )
         {
             IOTHUB_DEVICE_CONFIGURATION_RESULT result = IoTHubDeviceConfiguration_GetConfigurations(handle, 20, temp_list);
@@ -1556,9 +1511,9 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_UpdateConfiguration_return_NULL_if_input
 
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_019: [ IoTHubDeviceConfiguration_UpdateConfiguration shall create HTTP PUT request URL using the given configurationId using the following format: url/configurations/[configurationId] ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_020: [ IoTHubDeviceConfiguration_UpdateConfiguration shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=<generatedGuid>,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_UpdateConfiguration shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_UpdateConfiguration shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_UpdateConfiguration shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_021: [ IoTHubDeviceConfiguration_UpdateConfiguration shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_022: [ IoTHubDeviceConfiguration_UpdateConfiguration shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_023: [ IoTHubDeviceConfiguration_UpdateConfiguration shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICECONFIGURATION_38_030: [ Otherwise IoTHubDeviceConfiguration_UpdateConfiguration shall save the received configuration to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceConfiguration_UpdateConfiguration_happy_path_status_code_200)
 {
@@ -1637,19 +1592,14 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_UpdateConfiguration_non_happy_path)
             (i != 26) && // json_free_serialized_string
             (i != 27) && // json_object_clear
             (i != 28) && // json_value_free
-            (i != 36) && // UniqueId_Generate
-            (i != 42) && // gballoc_free
-            (i != 45) && // STRING_c_str
-            (i != 47) && // STRING_c_str
-            (i != 48) && // HTTPAPIEX_Destroy
-            (i != 49) && // STRING_c_str
-            (i != 50) && // HTTPAPIEX_Destroy
-            (i != 51) && // HTTPAPIEX_SAS_Destroy
-            (i != 52) && // HTTPHeaders_Free
-            (i != 53) && // STRING_delete
-            (i != 54) && // STRING_delete
-            (i != 55) && // STRING_delete
-            (i != 57)    // BUFFER_delete
+            (i != 33) && // UniqueId_Generate
+            (i != 39) && // gballoc_free
+            (i != 40) && // STRING_c_str
+            (i != 42) && // STRING_delete
+            (i != 43) && // HTTPHeaders_Free
+            (i != 44) && // STRING_delete
+            (i != 45) && // STRING_delete
+            (i != 47)    // BUFFER_delete
             )
         {
             IOTHUB_DEVICE_CONFIGURATION_RESULT result = IoTHubDeviceConfiguration_UpdateConfiguration(handle, &deviceConfiguration);
@@ -1700,9 +1650,9 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_DeleteConfiguration_return_IOTHUB_DEVICE
 
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_053: [ IoTHubDeviceConfiguration_DeleteConfiguration shall create HTTP DELETE request URL using the given configurationId using the following format : url/configurations/[configurationId]  ] */
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_054: [ IoTHubDeviceConfiguration_DeleteConfiguration shall add the following headers to the created HTTP GET request : authorization=sasToken,Request-Id=<generatedGuid>,Accept=application/json,Content-Type=application/json,charset=utf-8 ] */
-/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_055: [ IoTHubDeviceConfiguration_DeleteConfiguration shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_056: [ IoTHubDeviceConfiguration_DeleteConfiguration shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_057: [ IoTHubDeviceConfiguration_DeleteConfiguration shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
+/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_055: [ IoTHubDeviceConfiguration_DeleteConfiguration shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_056: [ IoTHubDeviceConfiguration_DeleteConfiguration shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_057: [ IoTHubDeviceConfiguration_DeleteConfiguration shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_058: [ IoTHubDeviceConfiguration_DeleteConfiguration shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_DEVICE_CONFIGURATION_HTTP_STATUS_ERROR ] */
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_059: [ IoTHubDeviceConfiguration_DeleteConfiguration shall verify the received HTTP status code and if it is less or equal than 300 then return IOTHUB_DEVICE_CONFIGURATION_OK ] */
 TEST_FUNCTION(IoTHubDeviceConfiguration_DeleteConfiguration_happy_path)
@@ -1728,9 +1678,9 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_DeleteConfiguration_happy_path)
 
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_053: [ IoTHubDeviceConfiguration_DeleteConfiguration shall create HTTP DELETE request URL using the given configurationId using the following format : url/configurations/[configurationId ] */
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_054: [ IoTHubDeviceConfiguration_DeleteConfiguration shall add the following headers to the created HTTP GET request : authorization=sasToken,Request-Id=<generatedGuid>,Accept=application/json,Content-Type=application/json,charset=utf-8  ] */
-/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_055: [ IoTHubDeviceConfiguration_DeleteConfiguration shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_056: [ IoTHubDeviceConfiguration_DeleteConfiguration shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_057: [ IoTHubDeviceConfiguration_DeleteConfiguration shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
+/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_055: [ IoTHubDeviceConfiguration_DeleteConfiguration shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_056: [ IoTHubDeviceConfiguration_DeleteConfiguration shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+/* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_057: [ IoTHubDeviceConfiguration_DeleteConfiguration shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_058: [ IoTHubDeviceConfiguration_DeleteConfiguration shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_DEVICE_CONFIGURATION_HTTP_STATUS_ERROR ] */
 /* Tests_SRS_IOTHUBDEVICECONFIGURATION_38_059: [ IoTHubDeviceConfiguration_DeleteConfiguration shall verify the received HTTP status code and if it is less or equal than 300 then return IOTHUB_DEVICE_CONFIGURATION_OK ] */
 TEST_FUNCTION(IoTHubDeviceConfiguration_DeleteConfiguration_non_happy_path)
@@ -1757,17 +1707,11 @@ TEST_FUNCTION(IoTHubDeviceConfiguration_DeleteConfiguration_non_happy_path)
 
         ////act
         if (
-            (i != 6) && /*UniqueId_Generate*/
-            (i != 11) && /*gballoc_free*/
-            (i != 14) && /*STRING_c_str*/
-            (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-            (i != 16) && /*STRING_delete*/
-            (i != 17) && /*HTTPAPIEX_Destroy*/
-            (i != 18) && /*HTTPAPIEX_SAS_Destroy*/
-            (i != 19) && /*HTTPHeaders_Free*/
-            (i != 20) && /*STRING_delete*/
-            (i != 21) && /*STRING_delete*/
-            (i != 22)    /*STRING_delete*/
+            (i != 3) && /*UniqueId_Generate*/
+            (i != 9) && /*gballoc_free*/
+            (i != 10) && /*STRING_c_str*/
+            (i != 12) && /*STRING_delete*/
+            (i != 13)    /*HTTPHeaders_Free*/
             )
         {
             IOTHUB_DEVICE_CONFIGURATION_RESULT result = IoTHubDeviceConfiguration_DeleteConfiguration(handle, TEST_CONST_CHAR_PTR);
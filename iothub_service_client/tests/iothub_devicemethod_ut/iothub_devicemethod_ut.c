@@ -59,8 +59,11 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
 
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
+#include "iothub_sc_connection_pool.h"
 #include "azure_c_shared_utility/uniqueid.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
 #include "parson.h"
 
 MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
@@ -151,49 +154,164 @@ void my_BUFFER_delete(BUFFER_HANDLE handle)
     my_gballoc_free(handle);
 }
 
-HTTPAPIEX_HANDLE my_HTTPAPIEX_Create(const char* hostName)
+char* my_json_serialize_to_string(const JSON_Value *value)
 {
-    (void)hostName;
-    return (HTTPAPIEX_HANDLE)my_gballoc_malloc(1);
+    (void)value;
+    char* s = (char*)my_gballoc_malloc(1);
+    *s=0;
+    return s;
 }
 
-void my_HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
+JSON_Value *my_json_parse_string(const char *string)
 {
-    my_gballoc_free(handle);
+    (void)string;
+    return (JSON_Value*)my_gballoc_malloc(1);
 }
 
-HTTPAPIEX_SAS_HANDLE my_HTTPAPIEX_SAS_Create(STRING_HANDLE key, STRING_HANDLE uriResource, STRING_HANDLE keyName)
+void my_json_value_free(JSON_Value *value)
 {
-    (void)key;
-    (void)uriResource;
-    (void)keyName;
-    return (HTTPAPIEX_SAS_HANDLE)my_gballoc_malloc(1);
+    my_gballoc_free(value);
 }
 
-void my_HTTPAPIEX_SAS_Destroy(HTTPAPIEX_SAS_HANDLE handle)
+typedef struct LIST_ITEM_INSTANCE_TAG
 {
-    my_gballoc_free(handle);
+    const void* item;
+    void* next;
+} LIST_ITEM_INSTANCE;
+
+typedef struct SINGLYLINKEDLIST_INSTANCE_TAG
+{
+    LIST_ITEM_INSTANCE* head;
+} LIST_INSTANCE;
+
+static SINGLYLINKEDLIST_HANDLE my_list_create(void)
+{
+    LIST_INSTANCE* result = (LIST_INSTANCE*)my_gballoc_malloc(sizeof(LIST_INSTANCE));
+    if (result != NULL)
+    {
+        result->head = NULL;
+    }
+    return result;
 }
 
-char* my_json_serialize_to_string(const JSON_Value *value)
+static void my_list_destroy(SINGLYLINKEDLIST_HANDLE list)
 {
-    (void)value;
-    char* s = (char*)my_gballoc_malloc(1);
-    *s=0;
-    return s;
+    LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
+    while (list_instance->head != NULL)
+    {
+        LIST_ITEM_INSTANCE* current_item = list_instance->head;
+        list_instance->head = (LIST_ITEM_INSTANCE*)current_item->next;
+        my_gballoc_free(current_item);
+    }
+    my_gballoc_free(list_instance);
 }
 
-JSON_Value *my_json_parse_string(const char *string)
+static LIST_ITEM_HANDLE my_list_add(SINGLYLINKEDLIST_HANDLE list, const void* item)
 {
-    (void)string;
-    return (JSON_Value*)my_gballoc_malloc(1);
+    LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
+    LIST_ITEM_INSTANCE* result = (LIST_ITEM_INSTANCE*)my_gballoc_malloc(sizeof(LIST_ITEM_INSTANCE));
+    if (result != NULL)
+    {
+        result->item = item;
+        result->next = list_instance->head;
+        list_instance->head = result;
+    }
+    return result;
 }
 
-void my_json_value_free(JSON_Value *value)
+static int my_list_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
 {
-    my_gballoc_free(value);
+    LIST_INSTANCE* list_instance = (LIST_INSTANCE*)list;
+    LIST_ITEM_INSTANCE** current_item = &list_instance->head;
+    while ((*current_item != NULL) && (*current_item != (LIST_ITEM_INSTANCE*)item))
+    {
+        current_item = (LIST_ITEM_INSTANCE**)&(*current_item)->next;
+    }
+    if (*current_item != NULL)
+    {
+        *current_item = (LIST_ITEM_INSTANCE*)(*current_item)->next;
+        my_gballoc_free(item);
+    }
+    return 0;
+}
+
+static LIST_ITEM_HANDLE my_list_get_head_item(SINGLYLINKEDLIST_HANDLE list)
+{
+    return ((LIST_INSTANCE*)list)->head;
+}
+
+static LIST_ITEM_HANDLE my_list_get_next_item(LIST_ITEM_HANDLE item_handle)
+{
+    return (LIST_ITEM_HANDLE)((LIST_ITEM_INSTANCE*)item_handle)->next;
+}
+
+static const void* my_list_item_get_value(LIST_ITEM_HANDLE item_handle)
+{
+    return ((LIST_ITEM_INSTANCE*)item_handle)->item;
+}
+
+static size_t threadCreateCount;
+static size_t threadJoinCount;
+
+/*worker threads run to completion inside ThreadAPI_Create, in the order they are started*/
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+    *threadHandle = (THREAD_HANDLE)0x4747;
+    threadCreateCount++;
+    (void)func(arg);
+    return THREADAPI_OK;
 }
 
+static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int* res)
+{
+    (void)threadHandle;
+    *res = 0;
+    threadJoinCount++;
+    return THREADAPI_OK;
+}
+
+/*stands in for the service: the slowDeviceRequest-th request is for a device that does not answer before the HTTP timeout*/
+static size_t slowDeviceRequest;
+static size_t invokeRequestCount;
+static unsigned int invokeHttpTimeout;
+
+static HTTPAPIEX_RESULT my_IoTHubScConnectionPool_ExecuteRequestWithTimeout(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent, unsigned int timeoutInMilliseconds)
+{
+    HTTPAPIEX_RESULT result;
+    (void)connectionPool;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHttpHeadersHandle;
+    (void)requestContent;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+
+    invokeRequestCount++;
+    invokeHttpTimeout = timeoutInMilliseconds;
+    if (invokeRequestCount == slowDeviceRequest)
+    {
+        result = HTTPAPIEX_ERROR;
+    }
+    else
+    {
+        *statusCode = 200;
+        result = HTTPAPIEX_OK;
+    }
+    return result;
+}
+
+#define TEST_MAX_INVOKE_RESULTS 8
+
+typedef struct TEST_INVOKE_RESULT_TAG
+{
+    char deviceId[32];
+    IOTHUB_DEVICE_METHOD_RESULT result;
+    int responseStatus;
+} TEST_INVOKE_RESULT;
+
+static TEST_INVOKE_RESULT invokeResults[TEST_MAX_INVOKE_RESULTS];
+static size_t invokeResultCount;
+
 
 #include "iothub_devicemethod.h"
 #include "iothub_service_client_auth.h"
@@ -203,10 +321,14 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
+    LOCK_HANDLE lock;
+    SINGLYLINKEDLIST_HANDLE invokeBatches;
 } IOTHUB_SERVICE_CLIENT_DEVICE_METHOD;
 
 static IOTHUB_SERVICE_CLIENT_AUTH TEST_IOTHUB_SERVICE_CLIENT_AUTH;
 static IOTHUB_SERVICE_CLIENT_AUTH_HANDLE TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_AUTH;
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4242;
 
 static IOTHUB_SERVICE_CLIENT_DEVICE_METHOD TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD;
 static IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD;
@@ -240,6 +362,20 @@ static const char* TEST_HTTP_HEADER_VAL_IFMATCH = "*";
 static JSON_Value* TEST_JSON_VALUE = (JSON_Value*)0x5050;
 static JSON_Object* TEST_JSON_OBJECT = (JSON_Object*)0x5151;
 static JSON_Status TEST_JSON_STATUS = 0;
+static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4646;
+
+static void test_invoke_callback(void* context, const char* deviceId, IOTHUB_DEVICE_METHOD_RESULT result, int responseStatus, const unsigned char* responsePayload, size_t responsePayloadSize)
+{
+    (void)responsePayload;
+    (void)responsePayloadSize;
+    ASSERT_ARE_EQUAL(void_ptr, (void*)invokeResults, context);
+    ASSERT_IS_TRUE(invokeResultCount < TEST_MAX_INVOKE_RESULTS);
+
+    (void)strcpy(invokeResults[invokeResultCount].deviceId, deviceId);
+    invokeResults[invokeResultCount].result = result;
+    invokeResults[invokeResultCount].responseStatus = responseStatus;
+    invokeResultCount++;
+}
 
 #ifdef __cplusplus
 extern "C"
@@ -296,8 +432,15 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_CONNECTION_POOL_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(JSON_Value_Type, int);
+    REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
 
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
@@ -337,18 +480,35 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_ERROR);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_Clone, TEST_CONNECTION_POOL_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_Clone, NULL);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Destroy, my_HTTPAPIEX_Destroy);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_ERROR);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Create, my_HTTPAPIEX_SAS_Create);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_Create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubScConnectionPool_ExecuteRequestWithTimeout, my_IoTHubScConnectionPool_ExecuteRequestWithTimeout);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequestWithTimeout, HTTPAPIEX_ERROR);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Destroy, my_HTTPAPIEX_SAS_Destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_create, my_list_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_destroy, my_list_destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, my_list_add);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_add, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_remove, my_list_remove);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_head_item, my_list_get_head_item);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_next_item, my_list_get_next_item);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_item_get_value, my_list_item_get_value);
 
-    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_OK);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock, LOCK_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Create, THREADAPI_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
 
     REGISTER_GLOBAL_MOCK_HOOK(json_parse_string, my_json_parse_string);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string, NULL);
@@ -395,7 +555,14 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubSuffix = TEST_IOTHUBSUFFIX;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.connectionPool = TEST_CONNECTION_POOL_HANDLE;
 
+    threadCreateCount = 0;
+    threadJoinCount = 0;
+    slowDeviceRequest = 0;
+    invokeRequestCount = 0;
+    invokeHttpTimeout = 0;
+    invokeResultCount = 0;
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -494,6 +661,8 @@ TEST_FUNCTION(IoTHubDeviceMethod_Create_return_null_if_input_parameter_serviceCl
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_010: [ IoTHubDeviceMethod_Create shall allocate memory and copy iothubSuffix to result->iothubSuffix by calling mallocAndStrcpy_s. ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_012: [ IoTHubDeviceMethod_Create shall allocate memory and copy sharedAccessKey to result->sharedAccessKey by calling mallocAndStrcpy_s. ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_014: [ IoTHubDeviceMethod_Create shall allocate memory and copy keyName to `result->keyName` by calling mallocAndStrcpy_s. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_001: [ IoTHubDeviceMethod_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_004: [ IoTHubDeviceMethod_Create shall create a lock by calling Lock_Init and an empty list of asynchronous invocation batches by calling singlylinkedlist_create. ]*/
 TEST_FUNCTION(IoTHubDeviceMethod_Create_happy_path)
 {
     // arrange
@@ -509,6 +678,10 @@ TEST_FUNCTION(IoTHubDeviceMethod_Create_happy_path)
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(singlylinkedlist_create());
+
     // act
     IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE result = IoTHubDeviceMethod_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
 
@@ -519,6 +692,7 @@ TEST_FUNCTION(IoTHubDeviceMethod_Create_happy_path)
     ///cleanup
     if (result != NULL)
     {
+        my_list_destroy(result->invokeBatches);
         free(result->hostname);
         free(result->keyName);
         free(result->sharedAccessKey);
@@ -533,6 +707,8 @@ TEST_FUNCTION(IoTHubDeviceMethod_Create_happy_path)
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_011: [ If the mallocAndStrcpy_s fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_013: [ If the mallocAndStrcpy_s fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_015: [ If the mallocAndStrcpy_s fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_005: [ If Lock_Init or singlylinkedlist_create fails, IoTHubDeviceMethod_Create shall do clean up and return NULL. ]*/
 TEST_FUNCTION(IoTHubDeviceMethod_Create_non_happy_path)
 {
     // arrange
@@ -551,6 +727,9 @@ TEST_FUNCTION(IoTHubDeviceMethod_Create_non_happy_path)
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, (const char*)(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE->keyName)))
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(singlylinkedlist_create());
 
     umock_c_negative_tests_snapshot();
 
@@ -586,6 +765,7 @@ TEST_FUNCTION(IoTHubDeviceMethod_Destroy_return_if_input_parameter_serviceClient
 }
 
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_017: [ If the serviceClientdevicemethodHandle input parameter is not NULL IoTHubDeviceMethod_Destroy shall free the memory of it and return ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_003: [ IoTHubDeviceMethod_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ]*/
 TEST_FUNCTION(IoTHubDeviceMethod_Destroy_do_clean_up_and_return_if_input_parameter_serviceClientdevicemethodHandle_is_not_NULL)
 
 {
@@ -594,12 +774,16 @@ TEST_FUNCTION(IoTHubDeviceMethod_Destroy_do_clean_up_and_return_if_input_paramet
 
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Destroy(TEST_CONNECTION_POOL_HANDLE));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -898,9 +1082,9 @@ TEST_FUNCTION(IoTHubDeviceMethod_InvokeModule_return_NULL_if_input_parameter_res
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_034: [ IoTHubDeviceMethod_Invoke(Module) shall allocate memory for response buffer by calling BUFFER_new ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_039: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTP POST request using methodPayloadBuffer ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_040: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTP POST request using the following HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICEMETHOD_12_041: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICEMETHOD_12_042: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICEMETHOD_12_043: [ IoTHubDeviceMethod_Invoke(Module) shall execute the HTTP POST request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_12_041: [ IoTHubDeviceMethod_Invoke(Module) shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_12_042: [ IoTHubDeviceMethod_Invoke(Module) shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_12_043: [ IoTHubDeviceMethod_Invoke(Module) shall execute the HTTP POST request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_049: [ Otherwise IoTHubDeviceMethod_Invoke(Module) shall save the received status and payload to the corresponding out parameter and return with IOTHUB_DEVICE_METHOD_OK ]*/
 static void IoTHubDeviceMethod_InvokeDeviceOrModule_happy_path_impl(bool testing_module)
 {
@@ -913,10 +1097,6 @@ static void IoTHubDeviceMethod_InvokeDeviceOrModule_happy_path_impl(bool testing
 
     EXPECTED_CALL(BUFFER_new());
 
-    EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEY));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEYNAME));
-
     EXPECTED_CALL(HTTPHeaders_Alloc());
     EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
         .IgnoreArgument(1);
@@ -932,13 +1112,9 @@ static void IoTHubDeviceMethod_InvokeDeviceOrModule_happy_path_impl(bool testing
 
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
-
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, HTTPAPI_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+    EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments()
         .CopyOutArgumentBuffer_statusCode(&httpStatusCodeOk, sizeof(httpStatusCodeOk))
         .SetReturn(HTTPAPIEX_OK);
@@ -946,20 +1122,9 @@ static void IoTHubDeviceMethod_InvokeDeviceOrModule_happy_path_impl(bool testing
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(HTTPAPIEX_SAS_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
     EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .SetReturn(TEST_UNSIGNED_CHAR_PTR);
@@ -1033,9 +1198,9 @@ TEST_FUNCTION(IoTHubDeviceMethod_InvokeModule_happy_path)
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_034: [ IoTHubDeviceMethod_Invoke(Module) shall allocate memory for response buffer by calling BUFFER_new ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_039: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTP POST request using methodPayloadBuffer ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_040: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTP POST request using the following HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICEMETHOD_12_041: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICEMETHOD_12_042: [ IoTHubDeviceMethod_Invoke(Module) shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICEMETHOD_12_043: [ IoTHubDeviceMethod_Invoke(Module) shall execute the HTTP POST request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_12_041: [ IoTHubDeviceMethod_Invoke(Module) shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_12_042: [ IoTHubDeviceMethod_Invoke(Module) shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_12_043: [ IoTHubDeviceMethod_Invoke(Module) shall execute the HTTP POST request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICEMETHOD_12_049: [ Otherwise IoTHubDeviceMethod_Invoke(Module) shall save the received status and payload to the corresponding out parameter and return with IOTHUB_DEVICE_METHOD_OK ]*/
 static void IoTHubDeviceMethod_Invoke_happy_path_http_return_not_equal_200_impl(bool testing_module)
 {
@@ -1048,10 +1213,6 @@ static void IoTHubDeviceMethod_Invoke_happy_path_http_return_not_equal_200_impl(
 
     EXPECTED_CALL(BUFFER_new());
 
-    EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEY));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEYNAME));
-
     EXPECTED_CALL(HTTPHeaders_Alloc());
     EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
         .IgnoreArgument(1);
@@ -1067,13 +1228,9 @@ static void IoTHubDeviceMethod_Invoke_happy_path_http_return_not_equal_200_impl(
 
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
-
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, HTTPAPI_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+    EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments()
         .CopyOutArgumentBuffer_statusCode(&httpStatusCodeBadRequest, sizeof(httpStatusCodeBadRequest))
         .SetReturn(HTTPAPIEX_OK);
@@ -1081,20 +1238,9 @@ static void IoTHubDeviceMethod_Invoke_happy_path_http_return_not_equal_200_impl(
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(HTTPAPIEX_SAS_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
     EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
@@ -1155,10 +1301,6 @@ static void IoTHubDeviceMethod_Invoke_non_happy_path_impl(bool testing_module)
 
     EXPECTED_CALL(BUFFER_new());
 
-    EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEY));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEYNAME));
-
     EXPECTED_CALL(HTTPHeaders_Alloc());
     EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
         .IgnoreArgument(1);
@@ -1174,13 +1316,9 @@ static void IoTHubDeviceMethod_Invoke_non_happy_path_impl(bool testing_module)
 
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
-
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, HTTPAPI_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+    EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments()
         .CopyOutArgumentBuffer_statusCode(&httpStatusCodeOk, sizeof(httpStatusCodeOk))
         .SetReturn(HTTPAPIEX_OK);
@@ -1188,20 +1326,9 @@ static void IoTHubDeviceMethod_Invoke_non_happy_path_impl(bool testing_module)
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(HTTPAPIEX_SAS_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
     EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
     EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .SetReturn(TEST_UNSIGNED_CHAR_PTR);
@@ -1260,22 +1387,17 @@ static void IoTHubDeviceMethod_Invoke_non_happy_path_impl(bool testing_module)
         /// act
         if (
             (i != 2)  && /*STRING_delete*/
-            (i != 10) && /*UniqueId_Generate*/
-            (i != 14) && /*gballoc_free*/
-            (i != 17) && /*STRING_c_str*/
-            (i != 19) && /*STRING_delete*/
-            (i != 20) && /*HTTPAPIEX_Destroy*/
-            (i != 21) && /*HTTPAPIEX_SAS_Destroy*/
-            (i != 22) && /*HTTPHeaders_Free*/
-            (i != 23) && /*STRING_delete*/
-            (i != 24) && /*STRING_delete*/
-            (i != 25) && /*STRING_delete*/
-            (i != 27) && /*BUFFER_length*/
-            (i != 35) && /*json_value_get_number*/
-            (i != 36) && /*STRING_delete*/
-            (i != 37) && /*json_value_free*/
-            (i != 38) && /*BUFFER_delete*/
-            (i != 39)    /*BUFFER_delete*/
+            (i != 7)  && /*UniqueId_Generate*/
+            (i != 11) && /*gballoc_free*/
+            (i != 12) && /*STRING_c_str*/
+            (i != 14) && /*STRING_delete*/
+            (i != 15) && /*HTTPHeaders_Free*/
+            (i != 17) && /*BUFFER_length*/
+            (i != 25) && /*json_value_get_number*/
+            (i != 26) && /*STRING_delete*/
+            (i != 27) && /*json_value_free*/
+            (i != 28) && /*BUFFER_delete*/
+            (i != 29)    /*BUFFER_delete*/
             )
         {
             if (testing_module == false)
@@ -1305,4 +1427,150 @@ TEST_FUNCTION(IoTHubDeviceMethod_InvokeModule_non_happy_path)
     IoTHubDeviceMethod_Invoke_non_happy_path_impl(true);
 }
 
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_007: [ If serviceClientDeviceMethodHandle, deviceIds, any of the device ids, methodName, methodPayload or invokeCallback is NULL, deviceCount is 0 or maxConcurrentInvocations is not between 1 and 16 then IoTHubDeviceMethod_InvokeOnDevicesAsync shall fail and return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeOnDevicesAsync_with_invalid_arguments_fails)
+{
+    // arrange
+    const char* deviceIds[] = { "device1", "device2" };
+    const char* deviceIdsWithNull[] = { "device1", NULL };
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT nullHandle = IoTHubDeviceMethod_InvokeOnDevicesAsync(NULL, deviceIds, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT nullDeviceIds = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, NULL, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT noDevice = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT nullDeviceId = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIdsWithNull, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT nullMethodName = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 2, NULL, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT nullMethodPayload = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 2, TEST_METHOD_NAME, NULL, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT nullCallback = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, NULL, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT noConcurrency = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 0, test_invoke_callback, invokeResults);
+    IOTHUB_DEVICE_METHOD_RESULT tooMuchConcurrency = IoTHubDeviceMethod_InvokeOnDevicesAsync(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, IOTHUB_DEVICE_METHOD_MAX_CONCURRENT_INVOCATIONS + 1, test_invoke_callback, invokeResults);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, nullHandle);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, nullDeviceIds);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, noDevice);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, nullDeviceId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, nullMethodName);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, nullMethodPayload);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, nullCallback);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, noConcurrency);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, tooMuchConcurrency);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_008: [ IoTHubDeviceMethod_InvokeOnDevicesAsync shall copy the device ids, methodName and methodPayload. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_010: [ IoTHubDeviceMethod_InvokeOnDevicesAsync shall start the smaller of maxConcurrentInvocations and deviceCount worker threads by calling ThreadAPI_Create, every worker thread shall take the next device that has not been invoked until all the devices are invoked. If a thread cannot be created its devices shall be invoked by the other threads. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_011: [ Every invocation shall be done as IoTHubDeviceMethod_Invoke does it, on a pooled connection by calling IoTHubScConnectionPool_ExecuteRequestWithTimeout with a timeout of timeout seconds, or 30 seconds when timeout is 0, plus 10 seconds. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_012: [ After every invocation the worker thread shall call invokeCallback with the device id, the result, the response status and the response payload. Callbacks of the same call shall not run concurrently and the payload shall only be valid during the callback. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_013: [ If any call fails, IoTHubDeviceMethod_InvokeOnDevicesAsync shall fail and return IOTHUB_DEVICE_METHOD_ERROR, otherwise it shall return IOTHUB_DEVICE_METHOD_OK without waiting for the invocations. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeOnDevicesAsync_calls_back_for_every_device_and_reports_the_slow_device)
+{
+    // arrange
+    const char* deviceIds[] = { "device1", "slowDevice", "device3", "device4" };
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE handle = IoTHubDeviceMethod_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    umock_c_reset_all_calls();
+    slowDeviceRequest = 2;
+
+    /*the slow device never gets a response to parse*/
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(TEST_UNSIGNED_CHAR_PTR);
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(TEST_UNSIGNED_CHAR_PTR);
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(TEST_UNSIGNED_CHAR_PTR);
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeOnDevicesAsync(handle, deviceIds, 4, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 3, test_invoke_callback, invokeResults);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 3, threadCreateCount);
+    ASSERT_ARE_EQUAL(size_t, 4, invokeRequestCount);
+    ASSERT_ARE_EQUAL(int, (int)((TEST_TIMEOUT + 10) * 1000), (int)invokeHttpTimeout);
+    ASSERT_ARE_EQUAL(size_t, 4, invokeResultCount);
+    ASSERT_ARE_EQUAL(char_ptr, "device1", invokeResults[0].deviceId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, invokeResults[0].result);
+    ASSERT_ARE_EQUAL(int, 42, invokeResults[0].responseStatus);
+    ASSERT_ARE_EQUAL(char_ptr, "slowDevice", invokeResults[1].deviceId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_ERROR, invokeResults[1].result);
+    ASSERT_ARE_EQUAL(char_ptr, "device3", invokeResults[2].deviceId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, invokeResults[2].result);
+    ASSERT_ARE_EQUAL(char_ptr, "device4", invokeResults[3].deviceId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, invokeResults[3].result);
+
+    // cleanup
+    IoTHubDeviceMethod_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_011: [ Every invocation shall be done as IoTHubDeviceMethod_Invoke does it, on a pooled connection by calling IoTHubScConnectionPool_ExecuteRequestWithTimeout with a timeout of timeout seconds, or 30 seconds when timeout is 0, plus 10 seconds. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_014: [ IoTHubDeviceMethod_InvokeAsync shall call IoTHubDeviceMethod_InvokeOnDevicesAsync with deviceId as the only device and maxConcurrentInvocations set to 1. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeAsync_invokes_the_device_on_one_worker_thread)
+{
+    // arrange
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE handle = IoTHubDeviceMethod_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(TEST_UNSIGNED_CHAR_PTR);
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeAsync(handle, TEST_DEVICE_ID, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, 0, test_invoke_callback, invokeResults);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 1, threadCreateCount);
+    ASSERT_ARE_EQUAL(int, (30 + 10) * 1000, (int)invokeHttpTimeout);
+    ASSERT_ARE_EQUAL(size_t, 1, invokeResultCount);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DEVICE_ID, invokeResults[0].deviceId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, invokeResults[0].result);
+
+    // cleanup
+    IoTHubDeviceMethod_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_006: [ IoTHubDeviceMethod_Destroy shall wait for the worker threads of every asynchronous invocation by calling ThreadAPI_Join and free the invocations before releasing anything else. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_009: [ IoTHubDeviceMethod_InvokeOnDevicesAsync shall first wait for the worker threads of previous calls that have finished by calling ThreadAPI_Join and free them. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeOnDevicesAsync_joins_the_threads_of_finished_calls)
+{
+    // arrange
+    const char* deviceIds[] = { "device1", "device2" };
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE handle = IoTHubDeviceMethod_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    (void)IoTHubDeviceMethod_InvokeOnDevicesAsync(handle, deviceIds, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, 2, test_invoke_callback, invokeResults);
+    ASSERT_ARE_EQUAL(size_t, 0, threadJoinCount);
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeAsync(handle, TEST_DEVICE_ID, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_callback, invokeResults);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, threadJoinCount);
+    ASSERT_ARE_EQUAL(size_t, 3, invokeResultCount);
+
+    // cleanup
+    IoTHubDeviceMethod_Destroy(handle);
+    ASSERT_ARE_EQUAL(size_t, 3, threadJoinCount);
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_02_013: [ If any call fails, IoTHubDeviceMethod_InvokeOnDevicesAsync shall fail and return IOTHUB_DEVICE_METHOD_ERROR, otherwise it shall return IOTHUB_DEVICE_METHOD_OK without waiting for the invocations. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeOnDevicesAsync_fails_when_no_worker_thread_starts)
+{
+    // arrange
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE handle = IoTHubDeviceMethod_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(THREADAPI_ERROR);
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeAsync(handle, TEST_DEVICE_ID, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_callback, invokeResults);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 0, invokeResultCount);
+
+    // cleanup
+    IoTHubDeviceMethod_Destroy(handle);
+    ASSERT_ARE_EQUAL(size_t, 0, threadJoinCount);
+}
+
 END_TEST_SUITE(iothub_devicemethod_ut)
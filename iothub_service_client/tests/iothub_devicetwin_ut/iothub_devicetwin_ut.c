@@ -53,7 +53,7 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
 
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
+#include "iothub_sc_connection_pool.h"
 #include "azure_c_shared_utility/uniqueid.h"
 
 #undef ENABLE_MOCKS
@@ -118,30 +118,6 @@ void my_BUFFER_delete(BUFFER_HANDLE handle)
     my_gballoc_free(handle);
 }
 
-HTTPAPIEX_HANDLE my_HTTPAPIEX_Create(const char* hostName)
-{
-    (void)hostName;
-    return (HTTPAPIEX_HANDLE)my_gballoc_malloc(1);
-}
-
-void my_HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
-{
-    my_gballoc_free(handle);
-}
-
-HTTPAPIEX_SAS_HANDLE my_HTTPAPIEX_SAS_Create(STRING_HANDLE key, STRING_HANDLE uriResource, STRING_HANDLE keyName)
-{
-    (void)key;
-    (void)uriResource;
-    (void)keyName;
-    return (HTTPAPIEX_SAS_HANDLE)my_gballoc_malloc(1);
-}
-
-void my_HTTPAPIEX_SAS_Destroy(HTTPAPIEX_SAS_HANDLE handle)
-{
-    my_gballoc_free(handle);
-}
-
 #include "iothub_devicetwin.h"
 #include "iothub_service_client_auth.h"
 
@@ -150,10 +126,12 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
 } IOTHUB_SERVICE_CLIENT_DEVICE_TWIN;
 
 static IOTHUB_SERVICE_CLIENT_AUTH TEST_IOTHUB_SERVICE_CLIENT_AUTH;
 static IOTHUB_SERVICE_CLIENT_AUTH_HANDLE TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_AUTH;
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4242;
 
 static IOTHUB_SERVICE_CLIENT_DEVICE_TWIN TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN;
 static IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN;
@@ -182,6 +160,24 @@ static const char* TEST_HTTP_HEADER_KEY_CONTENT_TYPE = "Content-Type";
 static const char* TEST_HTTP_HEADER_VAL_CONTENT_TYPE = "application/json; charset=utf-8";
 static const char* TEST_HTTP_HEADER_KEY_IFMATCH = "If-Match";
 static const char* TEST_HTTP_HEADER_VAL_IFMATCH = "*";
+static const char* TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT = "x-ms-max-item-count";
+static const char* TEST_HTTP_HEADER_KEY_CONTINUATION = "x-ms-continuation";
+
+static const char* TEST_QUERY = "SELECT * FROM devices WHERE properties.reported.fwVersion = '1.2'";
+static const char* TEST_QUERY_RELATIVE_PATH = "/devices/query?api-version=2017-11-08-preview";
+static const char* TEST_CONTINUATION_TOKEN = "theContinuationToken";
+
+static size_t queryResultCount;
+static size_t queryResultStopAt;
+static char queryLastResult[128];
+
+static int testQueryCallback(void* context, const char* resultJson)
+{
+    (void)context;
+    queryResultCount++;
+    (void)snprintf(queryLastResult, sizeof(queryLastResult), "%s", resultJson);
+    return (queryResultCount == queryResultStopAt) ? 1 : 0;
+}
 
 #ifdef __cplusplus
 extern "C"
@@ -238,7 +234,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_CONNECTION_POOL_HANDLE, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -268,20 +264,14 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_ERROR);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
-
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Destroy, my_HTTPAPIEX_Destroy);
-
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Create, my_HTTPAPIEX_SAS_Create);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_Clone, TEST_CONNECTION_POOL_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_Clone, NULL);
 
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Destroy, my_HTTPAPIEX_SAS_Destroy);
-
-    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_OK);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_ERROR);
 
     REGISTER_GLOBAL_MOCK_RETURN(UniqueId_Generate, UNIQUEID_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_FindHeaderValue, NULL);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(UniqueId_Generate, UNIQUEID_ERROR);
 }
 
@@ -306,7 +296,11 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubSuffix = TEST_IOTHUBSUFFIX;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.connectionPool = TEST_CONNECTION_POOL_HANDLE;
 
+    queryResultCount = 0;
+    queryResultStopAt = 0;
+    queryLastResult[0] = '\0';
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -405,6 +399,7 @@ TEST_FUNCTION(IoTHubDeviceTwin_Create_return_null_if_input_parameter_serviceClie
 /*Tests_SRS_IOTHUBDEVICETWIN_12_010: [ IoTHubDeviceTwin_Create shall allocate memory and copy iothubSuffix to result->iothubSuffix by calling mallocAndStrcpy_s. ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_012: [ IoTHubDeviceTwin_Create shall allocate memory and copy sharedAccessKey to result->sharedAccessKey by calling mallocAndStrcpy_s. ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_014: [ IoTHubDeviceTwin_Create shall allocate memory and copy keyName to `result->keyName` by calling mallocAndStrcpy_s. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_02_001: [ IoTHubDeviceTwin_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_Create_happy_path)
 {
     // arrange
@@ -420,6 +415,8 @@ TEST_FUNCTION(IoTHubDeviceTwin_Create_happy_path)
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
+
     // act
     IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE result = IoTHubDeviceTwin_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
 
@@ -444,6 +441,7 @@ TEST_FUNCTION(IoTHubDeviceTwin_Create_happy_path)
 /*Tests_SRS_IOTHUBDEVICETWIN_12_011: [ If the mallocAndStrcpy_s fails, IoTHubDeviceTwin_Create shall do clean up and return NULL. ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_013: [ If the mallocAndStrcpy_s fails, IoTHubDeviceTwin_Create shall do clean up and return NULL. ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_015: [ If the mallocAndStrcpy_s fails, IoTHubDeviceTwin_Create shall do clean up and return NULL. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubDeviceTwin_Create shall do clean up and return NULL. ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_Create_non_happy_path)
 {
     // arrange
@@ -462,6 +460,7 @@ TEST_FUNCTION(IoTHubDeviceTwin_Create_non_happy_path)
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, (const char*)(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE->keyName)))
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
 
     umock_c_negative_tests_snapshot();
 
@@ -497,6 +496,7 @@ TEST_FUNCTION(IoTHubDeviceTwin_Destroy_return_if_input_parameter_serviceClientDe
 }
 
 /*Tests_SRS_IOTHUBDEVICETWIN_12_017: [ If the serviceClientDeviceTwinHandle input parameter is not NULL IoTHubDeviceTwin_Destroy shall free the memory of it and return ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_02_003: [ IoTHubDeviceTwin_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_Destroy_do_clean_up_and_return_if_input_parameter_serviceClientDeviceTwinHandle_is_not_NULL)
 {
     // arrange
@@ -510,6 +510,7 @@ TEST_FUNCTION(IoTHubDeviceTwin_Destroy_do_clean_up_and_return_if_input_parameter
         .IgnoreArgument(1);
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Destroy(TEST_CONNECTION_POOL_HANDLE));
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -549,10 +550,6 @@ TEST_FUNCTION(IoTHubDeviceTwin_GetTwin_return_NULL_if_input_parameter_deviceId_i
 
 static void set_expected_calls_for_sendHttpRequestTwin(const unsigned int httpStatusCode, bool update_twin)
 {
-    EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEY));
-    EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEYNAME));
-
     EXPECTED_CALL(HTTPHeaders_Alloc());
     EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
         .IgnoreArgument(1);
@@ -574,32 +571,17 @@ static void set_expected_calls_for_sendHttpRequestTwin(const unsigned int httpSt
 
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
-
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
 
-    EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, HTTPAPI_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+    EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments()
         .CopyOutArgumentBuffer_statusCode(&httpStatusCode, sizeof(httpStatusCode))
         .SetReturn(HTTPAPIEX_OK);
 
     EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-    EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(HTTPAPIEX_SAS_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
     EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
 }
 
 static void set_expected_calls_for_GetDeviceOrModuleTwin_processing()
@@ -620,9 +602,9 @@ static void set_expected_calls_for_GetDeviceOrModuleTwin_processing()
 
 /*Tests_SRS_IOTHUBDEVICETWIN_12_019: [ IoTHubDeviceTwin_GetTwin shall create HTTP GET request URL using the given deviceId using the following format: url/twins/[deviceId] ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_020: [ IoTHubDeviceTwin_GetTwin shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_030: [ Otherwise IoTHubDeviceTwin_GetTwin shall save the received deviceTwin to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_GetTwin_happy_path_status_code_200)
 {
@@ -646,9 +628,9 @@ TEST_FUNCTION(IoTHubDeviceTwin_GetTwin_happy_path_status_code_200)
 
 /*Tests_SRS_IOTHUBDEVICETWIN_12_019: [ IoTHubDeviceTwin_GetTwin shall create HTTP GET request URL using the given deviceId using the following format: url/twins/[deviceId] ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_020: [ IoTHubDeviceTwin_GetTwin shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_021: [ IoTHubDeviceTwin_GetTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_022: [ IoTHubDeviceTwin_GetTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_023: [ IoTHubDeviceTwin_GetTwin shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_030: [ Otherwise IoTHubDeviceTwin_GetTwin shall save the received deviceTwin to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_GetTwin_happy_path_status_code_400)
 {
@@ -695,18 +677,13 @@ TEST_FUNCTION(IoTHubDeviceTwin_GetTwin_non_happy_path)
 
         /// act
         if (
-            (i != 11) && /*gballoc_free*/
-            (i != 14) && /*STRING_c_str*/
-            (i != 16) && /*STRING_delete*/
-            (i != 17) && /*HTTPAPIEX_Destroy*/
-            (i != 18) && /*HTTPAPIEX_SAS_Destroy*/
-            (i != 19) && /*HTTPHeaders_Free*/
-            (i != 20) && /*STRING_delete*/
-            (i != 21) && /*STRING_delete*/
-            (i != 22) && /*STRING_delete*/
-            (i != 23) && /*BUFFER_length*/
-            (i != 25) && /*BUFFER_u_char*/
-            (i != 26)    /*BUFFER_delete*/
+            (i != 8) && /*gballoc_free*/
+            (i != 9) && /*STRING_c_str*/
+            (i != 11) && /*STRING_delete*/
+            (i != 12) && /*HTTPHeaders_Free*/
+            (i != 13) && /*BUFFER_length*/
+            (i != 15) && /*BUFFER_u_char*/
+            (i != 16)    /*BUFFER_delete*/
             )
         {
             char message_on_error[64];
@@ -850,9 +827,9 @@ static void set_expected_calls_for_UpdateDeviceOrModuleTwin_processing()
 /*Tests_SRS_IOTHUBDEVICETWIN_12_034: [ IoTHubDeviceTwin_UpdateTwin shall allocate memory for response buffer by calling BUFFER_new ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_039: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTP PATCH request using deviceTwinJson ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_040: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTP PATCH request using the createdfollowing HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_041: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_042: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_043: [ IoTHubDeviceTwin_UpdateTwin shall execute the HTTP PATCH request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_041: [ IoTHubDeviceTwin_UpdateTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_042: [ IoTHubDeviceTwin_UpdateTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_043: [ IoTHubDeviceTwin_UpdateTwin shall execute the HTTP PATCH request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_047: [ Otherwise IoTHubDeviceTwin_UpdateTwin shall save the received updated device twin to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_UpdateTwin_happy_path_status_code_200)
 {
@@ -881,9 +858,9 @@ TEST_FUNCTION(IoTHubDeviceTwin_UpdateTwin_happy_path_status_code_200)
 /*Tests_SRS_IOTHUBDEVICETWIN_12_034: [ IoTHubDeviceTwin_UpdateTwin shall allocate memory for response buffer by calling BUFFER_new ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_039: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTP PATCH request using deviceTwinJson ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_040: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTP PATCH request using the createdfollowing HTTP headers: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_041: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_042: [ IoTHubDeviceTwin_UpdateTwin shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-/*Tests_SRS_IOTHUBDEVICETWIN_12_043: [ IoTHubDeviceTwin_UpdateTwin shall execute the HTTP PATCH request by calling HTTPAPIEX_ExecuteRequest ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_041: [ IoTHubDeviceTwin_UpdateTwin shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_042: [ IoTHubDeviceTwin_UpdateTwin shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_12_043: [ IoTHubDeviceTwin_UpdateTwin shall execute the HTTP PATCH request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
 /*Tests_SRS_IOTHUBDEVICETWIN_12_047: [ Otherwise IoTHubDeviceTwin_UpdateTwin shall save the received updated device twin to the out parameter and return with it ]*/
 TEST_FUNCTION(IoTHubDeviceTwin_UpdateTwin_happy_path_status_code_400)
 {
@@ -942,19 +919,14 @@ TEST_FUNCTION(IoTHubDeviceTwin_UpdateTwin_non_happy_path)
 
         /// act
         if (
-            (i != 13) && /*gballoc_free*/
-            (i != 16) && /*STRING_c_str*/
-            (i != 18) && /*STRING_delete*/
-            (i != 19) && /*HTTPAPIEX_Destroy*/
-            (i != 20) && /*HTTPAPIEX_SAS_Destroy*/
-            (i != 21) && /*HTTPHeaders_Free*/
-            (i != 22) && /*STRING_delete*/
-            (i != 23) && /*STRING_delete*/
-            (i != 24) && /*STRING_delete*/
-            (i != 25) && /*BUFFER_length*/
-            (i != 27) && /*BUFFER_u_char*/
-            (i != 28) && /*BUFFER_delete*/
-            (i != 29)    /*BUFFER_delete*/
+            (i != 10) && /*gballoc_free*/
+            (i != 11) && /*STRING_c_str*/
+            (i != 13) && /*STRING_delete*/
+            (i != 14) && /*HTTPHeaders_Free*/
+            (i != 15) && /*BUFFER_length*/
+            (i != 17) && /*BUFFER_u_char*/
+            (i != 18) && /*BUFFER_delete*/
+            (i != 19)    /*BUFFER_delete*/
             )
         {
             char message_on_error[64];
@@ -1058,4 +1030,229 @@ TEST_FUNCTION(IoTHubDeviceTwin_UpdateModuleTwin_happy_path_status_code_200)
     free((void*)result);
 }
 
+/*Tests_SRS_IOTHUBDEVICETWIN_02_004: [ If serviceClientDeviceTwinHandle, query or resultCallback is NULL, or pageSize is not between 1 and IOTHUB_DEVICE_TWIN_QUERY_MAX_PAGE_SIZE, IoTHubDeviceTwin_Query shall fail and return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Query_return_INVALID_ARG_if_input_parameter_is_invalid)
+{
+    // arrange
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT nullHandle = IoTHubDeviceTwin_Query(NULL, TEST_QUERY, 10, testQueryCallback, NULL);
+    IOTHUB_DEVICE_TWIN_RESULT nullQuery = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, NULL, 10, testQueryCallback, NULL);
+    IOTHUB_DEVICE_TWIN_RESULT nullCallback = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 10, NULL, NULL);
+    IOTHUB_DEVICE_TWIN_RESULT zeroPageSize = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 0, testQueryCallback, NULL);
+    IOTHUB_DEVICE_TWIN_RESULT largePageSize = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, IOTHUB_DEVICE_TWIN_QUERY_MAX_PAGE_SIZE + 1, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, nullHandle);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, nullQuery);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, nullCallback);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, zeroPageSize);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, largePageSize);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+static void set_expected_calls_for_query_page(const unsigned int* httpStatusCode, const char* requestToken, const char* nextToken, unsigned char* page, size_t pageLength)
+{
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_REQUEST_ID, TEST_HTTP_HEADER_VAL_REQUEST_ID));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_USER_AGENT, IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTENT_TYPE, TEST_HTTP_HEADER_VAL_CONTENT_TYPE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT, "10"))
+        .IgnoreArgument(1);
+    if (requestToken != NULL)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTINUATION, requestToken))
+            .IgnoreArgument(1);
+    }
+
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_POST, TEST_QUERY_RELATIVE_PATH, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .IgnoreArgument(4)
+        .IgnoreArgument(5)
+        .IgnoreArgument(6)
+        .IgnoreArgument(7)
+        .IgnoreArgument(8)
+        .CopyOutArgumentBuffer_statusCode(httpStatusCode, sizeof(*httpStatusCode))
+        .SetReturn(HTTPAPIEX_OK);
+
+    if (*httpStatusCode == httpStatusCodeOk)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTINUATION))
+            .IgnoreArgument(1)
+            .SetReturn(nextToken);
+        EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        if (nextToken != NULL)
+        {
+            STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, nextToken))
+                .IgnoreArgument(1);
+        }
+    }
+
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+
+    if (*httpStatusCode == httpStatusCodeOk)
+    {
+        EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+            .SetReturn(page);
+        EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+            .SetReturn(pageLength);
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_02_005: [ IoTHubDeviceTwin_Query shall create the body {"query":"<query>"}, with the query escaped as a JSON string, and a single response buffer that is reused for every page. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_02_006: [ For every page IoTHubDeviceTwin_Query shall POST the query to url/devices/query?api-version by calling IoTHubScConnectionPool_ExecuteRequest, with the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_02_008: [ IoTHubDeviceTwin_Query shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_02_009: [ IoTHubDeviceTwin_Query shall call resultCallback with the JSON text of every object of the page as soon as it is found, the text is only valid during the call. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Query_happy_path_requests_pages_with_continuation_token)
+{
+    // arrange
+    unsigned char firstPage[] = "[{\"deviceId\":\"d1\",\"tags\":{\"a\":\"}\"}}, {\"deviceId\":\"d2\"}]";
+    unsigned char lastPage[] = " [ {\"deviceId\":\"d3\",\"properties\":{\"reported\":{\"fw\":[1,2]}}} ] ";
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(&httpStatusCodeOk, NULL, TEST_CONTINUATION_TOKEN, firstPage, sizeof(firstPage) - 1);
+    set_expected_calls_for_query_page(&httpStatusCodeOk, TEST_CONTINUATION_TOKEN, NULL, lastPage, sizeof(lastPage) - 1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 3, queryResultCount);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"deviceId\":\"d3\",\"properties\":{\"reported\":{\"fw\":[1,2]}}}", queryLastResult);
+    ASSERT_ARE_EQUAL(char_ptr, "[{\"deviceId\":\"d1\",\"tags\":{\"a\":\"}\"}}, {\"deviceId\":\"d2\"}]", (const char*)firstPage);
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_02_005: [ IoTHubDeviceTwin_Query shall create the body {"query":"<query>"}, with the query escaped as a JSON string, and a single response buffer that is reused for every page. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Query_escapes_the_query_in_the_request_body)
+{
+    // arrange
+    static const char* query = "SELECT * FROM devices WHERE tags.path = \"c:\\dir\"\n";
+    static const char* expectedBody = "{\"query\":\"SELECT * FROM devices WHERE tags.path = \\\"c:\\\\dir\\\"\\u000a\"}";
+    unsigned char page[] = "[]";
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, strlen(expectedBody)))
+        .ValidateArgumentBuffer(1, expectedBody, strlen(expectedBody));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(&httpStatusCodeOk, NULL, NULL, page, sizeof(page) - 1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, query, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, queryResultCount);
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_02_011: [ If resultCallback returns a non-zero value IoTHubDeviceTwin_Query shall stop without requesting further pages and return IOTHUB_DEVICE_TWIN_OK. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Query_stops_when_the_callback_returns_non_zero)
+{
+    // arrange
+    unsigned char page[] = "[{\"deviceId\":\"d1\"},{\"deviceId\":\"d2\"},{\"deviceId\":\"d3\"}]";
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(&httpStatusCodeOk, NULL, TEST_CONTINUATION_TOKEN, page, sizeof(page) - 1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    queryResultStopAt = 2;
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, queryResultCount);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"deviceId\":\"d2\"}", queryLastResult);
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_02_010: [ If a page is not a JSON array of objects IoTHubDeviceTwin_Query shall stop and return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Query_return_ERROR_if_page_is_malformed)
+{
+    const char* malformedPages[] = { "{\"deviceId\":\"d1\"}", "[{\"deviceId\":\"d1\"}", "[{\"deviceId\":\"d1\"} {\"deviceId\":\"d2\"}]", "[1]", "" };
+    size_t i;
+
+    for (i = 0; i < sizeof(malformedPages) / sizeof(malformedPages[0]); i++)
+    {
+        // arrange
+        unsigned char page[64];
+        (void)strcpy((char*)page, malformedPages[i]);
+
+        umock_c_reset_all_calls();
+        EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        EXPECTED_CALL(BUFFER_new());
+        set_expected_calls_for_query_page(&httpStatusCodeOk, NULL, NULL, page, strlen(malformedPages[i]));
+        EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+        // act
+        IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 10, testQueryCallback, NULL);
+
+        // assert
+        ASSERT_ARE_EQUAL_WITH_MSG(int, IOTHUB_DEVICE_TWIN_ERROR, result, malformedPages[i]);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_02_007: [ If the request fails IoTHubDeviceTwin_Query shall return IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Query_return_error_if_the_request_fails)
+{
+    // arrange
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(&httpStatusCodeBadRequest, NULL, NULL, NULL, 0);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT statusResult = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_ERROR, statusResult);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // arrange
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments()
+        .SetReturn(HTTPAPIEX_ERROR);
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT requestResult = IoTHubDeviceTwin_Query(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_QUERY, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR, requestResult);
+    ASSERT_ARE_EQUAL(size_t, 0, queryResultCount);
+}
+
 END_TEST_SUITE(iothub_devicetwin_ut)
@@ -0,0 +1,1076 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#endif
+
+static const char* TEST_JOB_ID = "TEST_JOB_ID";
+static const char* TEST_QUERY_CONDITION = "deviceId IN ['d1','d2']";
+static const char* TEST_TWIN_PATCH = "{\"tags\":{\"building\":\"43\"}}";
+static const char* TEST_METHOD_NAME = "TEST_METHOD_NAME";
+static const char* TEST_METHOD_PAYLOAD = "{\"level\":3}";
+static const char* TEST_CONTINUATION_TOKEN = "TEST_CONTINUATION_TOKEN";
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t l = strlen(source);
+    *destination = (char*)my_gballoc_malloc(l + 1);
+    strcpy(*destination, source);
+    return 0;
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "iothub_sc_connection_pool.h"
+#include "azure_c_shared_utility/uniqueid.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "parson.h"
+
+MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Value*, json_value_init_object);
+MOCKABLE_FUNCTION(, JSON_Object*, json_value_get_object, const JSON_Value *, value);
+MOCKABLE_FUNCTION(, const char*, json_object_get_string, const JSON_Object*, object, const char *, name);
+MOCKABLE_FUNCTION(, double, json_object_dotget_number, const JSON_Object *, object, const char *, name);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_string, JSON_Object *, object, const char *, name, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_number, JSON_Object *, object, const char *, name, double, number);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_value, JSON_Object *, object, const char *, name, JSON_Value *, value);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_dotset_value, JSON_Object *, object, const char *, name, JSON_Value *, value);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_dotset_string, JSON_Object *, object, const char *, name, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_dotset_number, JSON_Object *, object, const char *, name, double, number);
+MOCKABLE_FUNCTION(, char*, json_serialize_to_string, const JSON_Value*, value);
+MOCKABLE_FUNCTION(, void, json_free_serialized_string, char*, string);
+MOCKABLE_FUNCTION(, void, json_value_free, JSON_Value *, value);
+
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/strings.h"
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+
+static unsigned char* TEST_UNSIGNED_CHAR_PTR = (unsigned char*)"TestString";
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+void my_STRING_delete(STRING_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
+{
+    return (HTTP_HEADERS_HANDLE)my_gballoc_malloc(1);
+}
+
+void my_HTTPHeaders_Free(HTTP_HEADERS_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+BUFFER_HANDLE my_BUFFER_new(void)
+{
+    return (BUFFER_HANDLE)my_gballoc_malloc(1);
+}
+
+BUFFER_HANDLE my_BUFFER_create(const unsigned char* source, size_t size)
+{
+    (void)source;
+    (void)size;
+    return (BUFFER_HANDLE)my_gballoc_malloc(1);
+}
+
+void my_BUFFER_delete(BUFFER_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static struct tm TEST_GMTIME;
+
+struct tm* my_get_gmtime(time_t* currentTime)
+{
+    (void)currentTime;
+    return &TEST_GMTIME;
+}
+
+char* my_json_serialize_to_string(const JSON_Value *value)
+{
+    (void)value;
+    char* s = (char*)my_gballoc_malloc(1);
+    *s = 0;
+    return s;
+}
+
+void my_json_free_serialized_string(char* string)
+{
+    my_gballoc_free(string);
+}
+
+JSON_Value* my_json_parse_string(const char *string)
+{
+    (void)string;
+    return (JSON_Value*)my_gballoc_malloc(1);
+}
+
+JSON_Value* my_json_value_init_object(void)
+{
+    return (JSON_Value*)my_gballoc_malloc(1);
+}
+
+void my_json_value_free(JSON_Value *value)
+{
+    my_gballoc_free(value);
+}
+
+/*values attached to the request by json_object_set_value / json_object_dotset_value are owned by the request*/
+JSON_Status my_json_object_set_value(JSON_Object *object, const char *name, JSON_Value *value)
+{
+    (void)object;
+    (void)name;
+    my_gballoc_free(value);
+    return JSONSuccess;
+}
+
+#include "iothub_jobclient.h"
+#include "iothub_service_client_auth.h"
+
+typedef struct IOTHUB_SERVICE_CLIENT_JOB_CLIENT_TAG
+{
+    char* hostname;
+    char* sharedAccessKey;
+    char* keyName;
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool;
+} IOTHUB_SERVICE_CLIENT_JOB_CLIENT;
+
+static IOTHUB_SERVICE_CLIENT_AUTH TEST_IOTHUB_SERVICE_CLIENT_AUTH;
+static IOTHUB_SERVICE_CLIENT_AUTH_HANDLE TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_AUTH;
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4242;
+
+static IOTHUB_SERVICE_CLIENT_JOB_CLIENT TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT;
+static IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE = &TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT;
+
+static const char* TEST_STRING_VALUE = "Test string value";
+
+static char* TEST_HOSTNAME = "theHostName";
+static char* TEST_IOTHUBNAME = "theIotHubName";
+static char* TEST_IOTHUBSUFFIX = "theIotHubSuffix";
+static char* TEST_SHAREDACCESSKEY = "theSharedAccessKey";
+static char* TEST_SHAREDACCESSKEYNAME = "theSharedAccessKeyName";
+
+static const unsigned int httpStatusCodeOk = 200;
+static const unsigned int httpStatusCodeBadRequest = 400;
+
+static const char* TEST_HTTP_HEADER_KEY_AUTHORIZATION = "Authorization";
+static const char* TEST_HTTP_HEADER_VAL_AUTHORIZATION = " ";
+static const char* TEST_HTTP_HEADER_KEY_REQUEST_ID = "Request-Id";
+static const char* TEST_HTTP_HEADER_KEY_USER_AGENT = "User-Agent";
+static const char* TEST_HTTP_HEADER_KEY_ACCEPT = "Accept";
+static const char* TEST_HTTP_HEADER_VAL_ACCEPT = "application/json";
+static const char* TEST_HTTP_HEADER_KEY_CONTENT_TYPE = "Content-Type";
+static const char* TEST_HTTP_HEADER_VAL_CONTENT_TYPE = "application/json; charset=utf-8";
+static const char* TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT = "x-ms-max-item-count";
+static const char* TEST_HTTP_HEADER_KEY_CONTINUATION = "x-ms-continuation";
+
+static JSON_Value* TEST_JSON_VALUE = (JSON_Value*)0x5050;
+static JSON_Object* TEST_JSON_OBJECT = (JSON_Object*)0x5151;
+static const time_t TEST_TIME = (time_t)1500000000;
+
+/*relative path of the last STRING_construct_sprintf call*/
+static char lastRelativePath[256];
+
+static size_t queryJobCount;
+static size_t queryJobStopAt;
+static IOTHUB_JOB_STATUS queryLastJobStatus;
+
+static int testQueryCallback(void* context, const IOTHUB_JOB* job)
+{
+    ASSERT_IS_NULL(context);
+    ASSERT_IS_NOT_NULL(job);
+
+    queryJobCount++;
+    queryLastJobStatus = job->status;
+    return (queryJobCount == queryJobStopAt) ? 1 : 0;
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    STRING_HANDLE STRING_construct_sprintf(const char* format, ...);
+
+    STRING_HANDLE STRING_construct_sprintf(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        (void)vsnprintf(lastRelativePath, sizeof(lastRelativePath), format, args);
+        va_end(args);
+        return (STRING_HANDLE)my_gballoc_malloc(1);
+    }
+
+    const char* my_STRING_c_str(STRING_HANDLE handle)
+    {
+        (void)handle;
+        return TEST_STRING_VALUE;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+BEGIN_TEST_SUITE(iothub_jobclient_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    int result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT);
+    REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_CONNECTION_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(UNIQUEID_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(JSON_Status, int);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, 42);
+
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_c_str, my_STRING_c_str);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_c_str, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
+
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_new, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_create, my_BUFFER_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_create, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
+
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_length, 10);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_u_char, TEST_UNSIGNED_CHAR_PTR);
+
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_Alloc, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_FindHeaderValue, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(UniqueId_Generate, UNIQUEID_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(UniqueId_Generate, UNIQUEID_ERROR);
+
+    REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, (time_t)(-1));
+    REGISTER_GLOBAL_MOCK_HOOK(get_gmtime, my_get_gmtime);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_gmtime, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_Clone, TEST_CONNECTION_POOL_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_Clone, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_ERROR);
+
+    REGISTER_GLOBAL_MOCK_HOOK(json_parse_string, my_json_parse_string);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(json_value_init_object, my_json_value_init_object);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_init_object, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(json_value_free, my_json_value_free);
+
+    REGISTER_GLOBAL_MOCK_RETURN(json_value_get_object, TEST_JSON_OBJECT);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_get_object, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_get_string, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_dotget_number, 0);
+
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_set_string, JSONSuccess);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_string, JSONFailure);
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_set_number, JSONSuccess);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_number, JSONFailure);
+    REGISTER_GLOBAL_MOCK_HOOK(json_object_set_value, my_json_object_set_value);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_value, JSONFailure);
+    REGISTER_GLOBAL_MOCK_HOOK(json_object_dotset_value, my_json_object_set_value);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_dotset_value, JSONFailure);
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_dotset_string, JSONSuccess);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_dotset_string, JSONFailure);
+    REGISTER_GLOBAL_MOCK_RETURN(json_object_dotset_number, JSONSuccess);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_dotset_number, JSONFailure);
+
+    REGISTER_GLOBAL_MOCK_HOOK(json_serialize_to_string, my_json_serialize_to_string);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_serialize_to_string, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(json_free_serialized_string, my_json_free_serialized_string);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.hostname = TEST_HOSTNAME;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubName = TEST_IOTHUBNAME;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubSuffix = TEST_IOTHUBSUFFIX;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.connectionPool = TEST_CONNECTION_POOL_HANDLE;
+
+    TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT.connectionPool = TEST_CONNECTION_POOL_HANDLE;
+
+    lastRelativePath[0] = '\0';
+    queryJobCount = 0;
+    queryJobStopAt = 0;
+    queryLastJobStatus = IOTHUB_JOB_STATUS_UNKNOWN;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    umock_c_negative_tests_deinit();
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+static void set_expected_calls_for_createHttpHeader(void)
+{
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_REQUEST_ID, IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_USER_AGENT, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_ACCEPT, TEST_HTTP_HEADER_VAL_ACCEPT))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTENT_TYPE, TEST_HTTP_HEADER_VAL_CONTENT_TYPE))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+}
+
+static void set_expected_calls_for_sendHttpRequestJob(HTTPAPI_REQUEST_TYPE requestType, const unsigned int* httpStatusCode)
+{
+    set_expected_calls_for_createHttpHeader();
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, requestType, TEST_STRING_VALUE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(4)
+        .IgnoreArgument(5)
+        .IgnoreArgument(6)
+        .IgnoreArgument(7)
+        .IgnoreArgument(8)
+        .CopyOutArgumentBuffer_statusCode(httpStatusCode, sizeof(*httpStatusCode))
+        .SetReturn(HTTPAPIEX_OK);
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+}
+
+static void set_expected_calls_for_parseResponseBuffer(void)
+{
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+}
+
+/*a job with an id and a status, the other strings are absent*/
+static void set_expected_calls_for_parseJobJsonObject(const char* status)
+{
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "jobId"))
+        .SetReturn(TEST_JOB_ID);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_JOB_ID))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "queryCondition"));
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "createdTime"));
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "startTime"));
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "endTime"));
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "failureReason"));
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "statusMessage"));
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "type"))
+        .SetReturn("scheduleDeviceMethod");
+    STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "status"))
+        .SetReturn(status);
+    STRICT_EXPECTED_CALL(json_object_dotget_number(TEST_JSON_OBJECT, "deviceJobStatistics.deviceCount"))
+        .SetReturn(2);
+    STRICT_EXPECTED_CALL(json_object_dotget_number(TEST_JSON_OBJECT, "deviceJobStatistics.failedCount"));
+    STRICT_EXPECTED_CALL(json_object_dotget_number(TEST_JSON_OBJECT, "deviceJobStatistics.succeededCount"))
+        .SetReturn(2);
+    STRICT_EXPECTED_CALL(json_object_dotget_number(TEST_JSON_OBJECT, "deviceJobStatistics.runningCount"));
+    STRICT_EXPECTED_CALL(json_object_dotget_number(TEST_JSON_OBJECT, "deviceJobStatistics.pendingCount"));
+}
+
+static void set_expected_calls_for_FreeJobMembers(void)
+{
+    size_t i;
+    for (i = 0; i < 7; i++)
+    {
+        EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+}
+
+static void set_expected_calls_for_createJobRequestJson(const char* jobType, bool hasMaxExecutionTime)
+{
+    EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    EXPECTED_CALL(get_gmtime(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_value_init_object());
+    EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_string(TEST_JSON_OBJECT, "jobId", TEST_JOB_ID));
+    STRICT_EXPECTED_CALL(json_object_set_string(TEST_JSON_OBJECT, "type", jobType));
+    STRICT_EXPECTED_CALL(json_object_set_string(TEST_JSON_OBJECT, "queryCondition", TEST_QUERY_CONDITION));
+    STRICT_EXPECTED_CALL(json_object_set_string(TEST_JSON_OBJECT, "startTime", "2017-07-14T02:40:00Z"));
+    if (hasMaxExecutionTime)
+    {
+        STRICT_EXPECTED_CALL(json_object_set_number(TEST_JSON_OBJECT, "maxExecutionTimeInSeconds", 3600));
+    }
+}
+
+static void set_expected_calls_for_sendScheduleJobRequest(void)
+{
+    EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_sendHttpRequestJob(HTTPAPI_REQUEST_PUT, &httpStatusCodeOk);
+    set_expected_calls_for_parseResponseBuffer();
+    EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    set_expected_calls_for_parseJobJsonObject("scheduled");
+    EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+}
+
+static void set_schedule(IOTHUB_JOB_SCHEDULE* schedule)
+{
+    TEST_GMTIME.tm_year = 117;
+    TEST_GMTIME.tm_mon = 6;
+    TEST_GMTIME.tm_mday = 14;
+    TEST_GMTIME.tm_hour = 2;
+    TEST_GMTIME.tm_min = 40;
+    TEST_GMTIME.tm_sec = 0;
+
+    schedule->jobId = TEST_JOB_ID;
+    schedule->queryCondition = TEST_QUERY_CONDITION;
+    schedule->startTime = 0;
+    schedule->maxExecutionTimeInSeconds = 3600;
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_001: [ If serviceClientHandle or any of its hostname, keyName and sharedAccessKey members is NULL IoTHubJobClient_Create shall return NULL. ]*/
+TEST_FUNCTION(IoTHubJobClient_Create_return_null_if_input_parameter_serviceClientHandle_is_NULL)
+{
+    // arrange
+
+    // act
+    IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE result = IoTHubJobClient_Create(NULL);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_001: [ If serviceClientHandle or any of its hostname, keyName and sharedAccessKey members is NULL IoTHubJobClient_Create shall return NULL. ]*/
+TEST_FUNCTION(IoTHubJobClient_Create_return_null_if_input_parameter_serviceClientHandle_sharedAccessKey_is_NULL)
+{
+    // arrange
+    TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = NULL;
+
+    // act
+    IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE result = IoTHubJobClient_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_002: [ IoTHubJobClient_Create shall allocate a new handle, copy hostname, sharedAccessKey and keyName and take a reference to the connection pool of serviceClientHandle by calling IoTHubScConnectionPool_Clone. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_005: [ Otherwise IoTHubJobClient_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy and free the handle. ]*/
+TEST_FUNCTION(IoTHubJobClient_Create_and_Destroy_happy_path)
+{
+    // arrange
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_HOSTNAME))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SHAREDACCESSKEY))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SHAREDACCESSKEYNAME))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
+
+    // act
+    IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE result = IoTHubJobClient_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_HOSTNAME, result->hostname);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SHAREDACCESSKEY, result->sharedAccessKey);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SHAREDACCESSKEYNAME, result->keyName);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_CONNECTION_POOL_HANDLE, result->connectionPool);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // arrange
+    umock_c_reset_all_calls();
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Destroy(TEST_CONNECTION_POOL_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    IoTHubJobClient_Destroy(result);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_003: [ If any of these calls fails IoTHubJobClient_Create shall do clean up and return NULL. ]*/
+TEST_FUNCTION(IoTHubJobClient_Create_non_happy_path)
+{
+    // arrange
+    int umockc_result = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, umockc_result);
+
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_HOSTNAME))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SHAREDACCESSKEY))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SHAREDACCESSKEYNAME))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
+
+    umock_c_negative_tests_snapshot();
+
+    for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+    {
+        // arrange
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(i);
+
+        // act
+        IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE result = IoTHubJobClient_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+        // assert
+        ASSERT_IS_NULL(result);
+    }
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_004: [ If serviceClientJobClientHandle is NULL IoTHubJobClient_Destroy shall return. ]*/
+TEST_FUNCTION(IoTHubJobClient_Destroy_return_if_input_parameter_serviceClientJobClientHandle_is_NULL)
+{
+    // arrange
+
+    // act
+    IoTHubJobClient_Destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_013: [ If serviceClientJobClientHandle, schedule, schedule->jobId, schedule->queryCondition or twinPatchJson is NULL IoTHubJobClient_ScheduleTwinUpdate shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubJobClient_ScheduleTwinUpdate_return_INVALID_ARG_if_input_parameters_are_NULL)
+{
+    // arrange
+    IOTHUB_JOB_SCHEDULE schedule;
+    IOTHUB_JOB_SCHEDULE scheduleWithoutQuery;
+    set_schedule(&schedule);
+    set_schedule(&scheduleWithoutQuery);
+    scheduleWithoutQuery.queryCondition = NULL;
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result1 = IoTHubJobClient_ScheduleTwinUpdate(NULL, &schedule, TEST_TWIN_PATCH, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result2 = IoTHubJobClient_ScheduleTwinUpdate(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, NULL, TEST_TWIN_PATCH, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result3 = IoTHubJobClient_ScheduleTwinUpdate(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &scheduleWithoutQuery, TEST_TWIN_PATCH, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result4 = IoTHubJobClient_ScheduleTwinUpdate(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &schedule, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result4);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_006: [ The job request shall be a JSON object with jobId, type, queryCondition, startTime as ISO 8601 UTC (the current time when schedule->startTime is 0) and, when not 0, maxExecutionTimeInSeconds. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_007: [ The job shall be created by a PUT of the request to url/jobs/v2/[jobId]. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_008: [ Every request shall carry the headers Authorization, Request-Id, User-Agent, Accept=application/json and Content-Type=application/json; charset=utf-8 and shall be executed by calling IoTHubScConnectionPool_ExecuteRequest on the connection pool of the handle. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_010: [ The job returned by the service shall be copied to the job structure, the job type and status shall be mapped to IOTHUB_JOB_TYPE and IOTHUB_JOB_STATUS, unknown values mapping to IOTHUB_JOB_TYPE_UNKNOWN and IOTHUB_JOB_STATUS_UNKNOWN. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_014: [ IoTHubJobClient_ScheduleTwinUpdate shall add twinPatchJson to the request as updateTwin, if twinPatchJson is not valid JSON it shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+TEST_FUNCTION(IoTHubJobClient_ScheduleTwinUpdate_happy_path)
+{
+    // arrange
+    IOTHUB_JOB_SCHEDULE schedule;
+    IOTHUB_JOB job;
+    set_schedule(&schedule);
+
+    set_expected_calls_for_createJobRequestJson("scheduleUpdateTwin", true);
+    STRICT_EXPECTED_CALL(json_parse_string(TEST_TWIN_PATCH));
+    EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_object_set_value(TEST_JSON_OBJECT, "updateTwin", IGNORED_PTR_ARG))
+        .IgnoreArgument(3);
+    set_expected_calls_for_sendScheduleJobRequest();
+    EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_ScheduleTwinUpdate(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &schedule, TEST_TWIN_PATCH, &job);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "/jobs/v2/TEST_JOB_ID?api-version=2017-11-08-preview", lastRelativePath);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_JOB_ID, job.jobId);
+    ASSERT_IS_NULL(job.queryCondition);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_TYPE_SCHEDULE_DEVICE_METHOD, job.type);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_STATUS_SCHEDULED, job.status);
+    ASSERT_ARE_EQUAL(size_t, 2, job.deviceJobStatistics.deviceCount);
+    ASSERT_ARE_EQUAL(size_t, 2, job.deviceJobStatistics.succeededCount);
+
+    // cleanup
+    IoTHubJobClient_FreeJobMembers(&job);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_014: [ IoTHubJobClient_ScheduleTwinUpdate shall add twinPatchJson to the request as updateTwin, if twinPatchJson is not valid JSON it shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+TEST_FUNCTION(IoTHubJobClient_ScheduleTwinUpdate_return_JSON_ERROR_if_twinPatchJson_is_not_JSON)
+{
+    // arrange
+    IOTHUB_JOB_SCHEDULE schedule;
+    set_schedule(&schedule);
+
+    set_expected_calls_for_createJobRequestJson("scheduleUpdateTwin", true);
+    STRICT_EXPECTED_CALL(json_parse_string("not json"))
+        .SetReturn(NULL);
+    EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_ScheduleTwinUpdate(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &schedule, "not json", NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_JSON_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_015: [ If serviceClientJobClientHandle, schedule, schedule->jobId, schedule->queryCondition, methodName or methodPayload is NULL IoTHubJobClient_ScheduleDeviceMethod shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubJobClient_ScheduleDeviceMethod_return_INVALID_ARG_if_input_parameters_are_NULL)
+{
+    // arrange
+    IOTHUB_JOB_SCHEDULE schedule;
+    IOTHUB_JOB_SCHEDULE scheduleWithoutId;
+    set_schedule(&schedule);
+    set_schedule(&scheduleWithoutId);
+    scheduleWithoutId.jobId = NULL;
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result1 = IoTHubJobClient_ScheduleDeviceMethod(NULL, &schedule, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, 0, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result2 = IoTHubJobClient_ScheduleDeviceMethod(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &scheduleWithoutId, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, 0, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result3 = IoTHubJobClient_ScheduleDeviceMethod(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &schedule, NULL, TEST_METHOD_PAYLOAD, 0, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result4 = IoTHubJobClient_ScheduleDeviceMethod(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &schedule, TEST_METHOD_NAME, NULL, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result4);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_006: [ The job request shall be a JSON object with jobId, type, queryCondition, startTime as ISO 8601 UTC (the current time when schedule->startTime is 0) and, when not 0, maxExecutionTimeInSeconds. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_016: [ IoTHubJobClient_ScheduleDeviceMethod shall add cloudToDeviceMethod with methodName, methodPayload as payload and, when not 0, responseTimeoutInSeconds to the request, if methodPayload is not valid JSON it shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+TEST_FUNCTION(IoTHubJobClient_ScheduleDeviceMethod_happy_path)
+{
+    // arrange
+    IOTHUB_JOB_SCHEDULE schedule;
+    set_schedule(&schedule);
+    schedule.maxExecutionTimeInSeconds = 0;
+
+    set_expected_calls_for_createJobRequestJson("scheduleDeviceMethod", false);
+    EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(json_parse_string(TEST_METHOD_PAYLOAD));
+    STRICT_EXPECTED_CALL(json_object_dotset_value(TEST_JSON_OBJECT, "cloudToDeviceMethod.payload", IGNORED_PTR_ARG))
+        .IgnoreArgument(3);
+    STRICT_EXPECTED_CALL(json_object_dotset_string(TEST_JSON_OBJECT, "cloudToDeviceMethod.methodName", TEST_METHOD_NAME));
+    STRICT_EXPECTED_CALL(json_object_dotset_number(TEST_JSON_OBJECT, "cloudToDeviceMethod.responseTimeoutInSeconds", 30));
+    EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_sendHttpRequestJob(HTTPAPI_REQUEST_PUT, &httpStatusCodeOk);
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_ScheduleDeviceMethod(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, &schedule, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, 30, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_017: [ If serviceClientJobClientHandle, jobId or job is NULL IoTHubJobClient_GetJob shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubJobClient_GetJob_return_INVALID_ARG_if_input_parameters_are_NULL)
+{
+    // arrange
+    IOTHUB_JOB job;
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result1 = IoTHubJobClient_GetJob(NULL, TEST_JOB_ID, &job);
+    IOTHUB_JOB_CLIENT_RESULT result2 = IoTHubJobClient_GetJob(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, NULL, &job);
+    IOTHUB_JOB_CLIENT_RESULT result3 = IoTHubJobClient_GetJob(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, TEST_JOB_ID, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_018: [ IoTHubJobClient_GetJob shall GET url/jobs/v2/[jobId] and return the job in job. ]*/
+TEST_FUNCTION(IoTHubJobClient_GetJob_happy_path)
+{
+    // arrange
+    IOTHUB_JOB job;
+
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_sendHttpRequestJob(HTTPAPI_REQUEST_GET, &httpStatusCodeOk);
+    set_expected_calls_for_parseResponseBuffer();
+    EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+    set_expected_calls_for_parseJobJsonObject("completed");
+    EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_GetJob(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, TEST_JOB_ID, &job);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "/jobs/v2/TEST_JOB_ID?api-version=2017-11-08-preview", lastRelativePath);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_JOB_ID, job.jobId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_STATUS_COMPLETED, job.status);
+
+    // arrange
+    umock_c_reset_all_calls();
+    set_expected_calls_for_FreeJobMembers();
+
+    // act
+    IoTHubJobClient_FreeJobMembers(&job);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(job.jobId);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_009: [ If the request fails the function shall return IOTHUB_JOB_CLIENT_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR. ]*/
+TEST_FUNCTION(IoTHubJobClient_GetJob_return_HTTP_STATUS_ERROR_if_status_code_is_400)
+{
+    // arrange
+    IOTHUB_JOB job;
+
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_sendHttpRequestJob(HTTPAPI_REQUEST_GET, &httpStatusCodeBadRequest);
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_GetJob(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, TEST_JOB_ID, &job);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_019: [ If serviceClientJobClientHandle or jobId is NULL IoTHubJobClient_CancelJob shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubJobClient_CancelJob_return_INVALID_ARG_if_input_parameters_are_NULL)
+{
+    // arrange
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result1 = IoTHubJobClient_CancelJob(NULL, TEST_JOB_ID, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result2 = IoTHubJobClient_CancelJob(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_020: [ IoTHubJobClient_CancelJob shall POST to url/jobs/v2/[jobId]/cancel and, if job is not NULL, return the cancelled job in job. ]*/
+TEST_FUNCTION(IoTHubJobClient_CancelJob_happy_path_without_job)
+{
+    // arrange
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_sendHttpRequestJob(HTTPAPI_REQUEST_POST, &httpStatusCodeOk);
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_CancelJob(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, TEST_JOB_ID, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "/jobs/v2/TEST_JOB_ID/cancel?api-version=2017-11-08-preview", lastRelativePath);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_021: [ If serviceClientJobClientHandle or jobCallback is NULL, jobType or jobStatus is out of range, or pageSize is not between 1 and IOTHUB_JOB_CLIENT_QUERY_MAX_PAGE_SIZE, IoTHubJobClient_QueryJobs shall return IOTHUB_JOB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubJobClient_QueryJobs_return_INVALID_ARG_if_input_parameters_are_invalid)
+{
+    // arrange
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result1 = IoTHubJobClient_QueryJobs(NULL, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_UNKNOWN, 10, testQueryCallback, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result2 = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_UNKNOWN, 10, NULL, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result3 = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_UNKNOWN, 0, testQueryCallback, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result4 = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_UNKNOWN, IOTHUB_JOB_CLIENT_QUERY_MAX_PAGE_SIZE + 1, testQueryCallback, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result5 = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, (IOTHUB_JOB_TYPE)42, IOTHUB_JOB_STATUS_UNKNOWN, 10, testQueryCallback, NULL);
+    IOTHUB_JOB_CLIENT_RESULT result6 = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, (IOTHUB_JOB_STATUS)42, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result4);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result5);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_INVALID_ARG, result6);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+static void set_expected_calls_for_query_page(const char* requestToken, const char* nextToken, unsigned char* page, size_t pageLength, size_t parsedJobCount)
+{
+    size_t i;
+
+    set_expected_calls_for_createHttpHeader();
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT, "10"))
+        .IgnoreArgument(1);
+    if (requestToken != NULL)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTINUATION, requestToken))
+            .IgnoreArgument(1);
+    }
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_GET, TEST_STRING_VALUE, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(4)
+        .IgnoreArgument(6)
+        .IgnoreArgument(7)
+        .IgnoreArgument(8)
+        .CopyOutArgumentBuffer_statusCode(&httpStatusCodeOk, sizeof(httpStatusCodeOk))
+        .SetReturn(HTTPAPIEX_OK);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTINUATION))
+        .IgnoreArgument(1)
+        .SetReturn(nextToken);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    if (nextToken != NULL)
+    {
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, nextToken))
+            .IgnoreArgument(1);
+    }
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(page);
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .SetReturn(pageLength);
+    for (i = 0; i < parsedJobCount; i++)
+    {
+        EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+        EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+        set_expected_calls_for_parseJobJsonObject("running");
+        set_expected_calls_for_FreeJobMembers();
+        EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    }
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_022: [ IoTHubJobClient_QueryJobs shall GET url/jobs/v2/query, with jobType and jobStatus query parameters unless they are UNKNOWN, the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. All pages shall be received in the same response buffer. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_023: [ IoTHubJobClient_QueryJobs shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+/*Tests_SRS_IOTHUBJOBCLIENT_02_025: [ IoTHubJobClient_QueryJobs shall call jobCallback for every job of a page, the job is only valid during the call. ]*/
+TEST_FUNCTION(IoTHubJobClient_QueryJobs_happy_path_requests_pages_with_continuation_token)
+{
+    // arrange
+    unsigned char firstPage[] = "[{\"jobId\":\"j1\"}, {\"jobId\":\"j2\"}]";
+    unsigned char lastPage[] = "[{\"jobId\":\"j3\"}]";
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(NULL, TEST_CONTINUATION_TOKEN, firstPage, sizeof(firstPage) - 1, 2);
+    set_expected_calls_for_query_page(TEST_CONTINUATION_TOKEN, NULL, lastPage, sizeof(lastPage) - 1, 1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_SCHEDULE_DEVICE_METHOD, IOTHUB_JOB_STATUS_UNKNOWN, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "/jobs/v2/query?api-version=2017-11-08-preview&jobType=scheduleDeviceMethod", lastRelativePath);
+    ASSERT_ARE_EQUAL(size_t, 3, queryJobCount);
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_STATUS_RUNNING, queryLastJobStatus);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_026: [ If jobCallback returns a non-zero value IoTHubJobClient_QueryJobs shall stop without requesting further pages and return IOTHUB_JOB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubJobClient_QueryJobs_stops_when_the_callback_returns_non_zero)
+{
+    // arrange
+    unsigned char page[] = "[{\"jobId\":\"j1\"}, {\"jobId\":\"j2\"}]";
+    queryJobStopAt = 1;
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(NULL, TEST_CONTINUATION_TOKEN, page, sizeof(page) - 1, 1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_FAILED, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "/jobs/v2/query?api-version=2017-11-08-preview&jobStatus=failed", lastRelativePath);
+    ASSERT_ARE_EQUAL(size_t, 1, queryJobCount);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_024: [ If a page is not a JSON array of jobs IoTHubJobClient_QueryJobs shall return IOTHUB_JOB_CLIENT_JSON_ERROR. ]*/
+TEST_FUNCTION(IoTHubJobClient_QueryJobs_return_JSON_ERROR_if_the_page_is_not_an_array)
+{
+    // arrange
+    unsigned char page[] = "{\"jobId\":\"j1\"}";
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_query_page(NULL, TEST_CONTINUATION_TOKEN, page, sizeof(page) - 1, 0);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_UNKNOWN, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_JSON_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, queryJobCount);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_009: [ If the request fails the function shall return IOTHUB_JOB_CLIENT_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR. ]*/
+TEST_FUNCTION(IoTHubJobClient_QueryJobs_return_HTTP_STATUS_ERROR_if_a_page_fails)
+{
+    // arrange
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_createHttpHeader();
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT, "10"));
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_GET, TEST_STRING_VALUE, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(4)
+        .IgnoreArgument(6)
+        .IgnoreArgument(7)
+        .IgnoreArgument(8)
+        .CopyOutArgumentBuffer_statusCode(&httpStatusCodeBadRequest, sizeof(httpStatusCodeBadRequest))
+        .SetReturn(HTTPAPIEX_OK);
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_JOB_CLIENT_RESULT result = IoTHubJobClient_QueryJobs(TEST_IOTHUB_SERVICE_CLIENT_JOB_CLIENT_HANDLE, IOTHUB_JOB_TYPE_UNKNOWN, IOTHUB_JOB_STATUS_UNKNOWN, 10, testQueryCallback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_JOB_CLIENT_HTTP_STATUS_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, queryJobCount);
+}
+
+/*Tests_SRS_IOTHUBJOBCLIENT_02_027: [ IoTHubJobClient_FreeJobMembers shall free the strings of job and set them to NULL, it shall do nothing if job is NULL. ]*/
+TEST_FUNCTION(IoTHubJobClient_FreeJobMembers_do_nothing_if_job_is_NULL)
+{
+    // arrange
+
+    // act
+    IoTHubJobClient_FreeJobMembers(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+END_TEST_SUITE(iothub_jobclient_ut)
@@ -3,9 +3,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -36,17 +38,7 @@
 #include "azure_uamqp_c/cbs.h"
 #include "azure_uamqp_c/link.h"
 
-#include "parson.h"
 #include "iothub_message.h"
-
-MOCKABLE_FUNCTION(, JSON_Array*, json_array_get_array, const JSON_Array*, array, size_t, index);
-MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
-MOCKABLE_FUNCTION(, const char*, json_object_get_string, const JSON_Object *, object, const char *, name);
-MOCKABLE_FUNCTION(, JSON_Object*, json_array_get_object, const JSON_Array*, array, size_t, index);
-MOCKABLE_FUNCTION(, JSON_Array*, json_value_get_array, const JSON_Value*, value);
-MOCKABLE_FUNCTION(, size_t, json_array_get_count, const JSON_Array*, array);
-MOCKABLE_FUNCTION(, JSON_Status, json_array_clear, JSON_Array*, array);
-MOCKABLE_FUNCTION(, void, json_value_free, JSON_Value *, value);
 #undef ENABLE_MOCKS
 
 #include "iothub_messaging_ll.h"
@@ -59,6 +51,8 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_RESULT_VAL
 MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, void*, context);
 MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, void*, context, IOTHUB_MESSAGING_RESULT, messagingResult);
 MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, void*, context, IOTHUB_SERVICE_FEEDBACK_BATCH*, feedbackBatch);
+MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, void*, context, const IOTHUB_SERVICE_FEEDBACK_RECORD*, feedbackRecord);
+#include "iothub_sc_feedback_parser.h"
 #undef ENABLE_MOCKS
 
 
@@ -85,6 +79,11 @@ static void* my_gballoc_malloc(size_t size)
     return (void*)malloc(size);
 }
 
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
 static void my_gballoc_free(void* ptr)
 {
     if (ptr != NULL)
@@ -235,15 +234,43 @@ static const void* my_list_item_get_value(LIST_ITEM_HANDLE item_handle)
     return result;
 }
 
+static const char TEST_FEEDBACK_BODY[] = "[{\"description\":\"Success\"},{\"description\":\"Expired\"}]";
 static int my_message_get_body_amqp_data_in_place(MESSAGE_HANDLE message, size_t index, BINARY_DATA* binary_data)
 {
     (void)index;
     (void)message;
-    binary_data->bytes = NULL;
-    binary_data->length = 1;
+    binary_data->bytes = (const unsigned char*)TEST_FEEDBACK_BODY;
+    binary_data->length = sizeof(TEST_FEEDBACK_BODY) - 1;
     return 0;
 }
 
+/*the parser is mocked: every call hands out the first testFeedbackRecordCount records of TEST_FEEDBACK_RECORDS*/
+static char TEST_DESCRIPTION_SUCCESS[] = "success";
+static char TEST_DESCRIPTION_EXPIRED[] = "expired";
+static IOTHUB_SERVICE_FEEDBACK_RECORD TEST_FEEDBACK_RECORDS[2];
+static size_t testFeedbackRecordCount;
+static int my_IoTHubScFeedbackParser_Parse(char* feedbackJson, size_t length, IOTHUB_SC_FEEDBACK_RECORD_HANDLER recordHandler, void* context, size_t* recordCount)
+{
+    int result = 0;
+    size_t i;
+
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_FEEDBACK_BODY) - 1, length);
+    ASSERT_IS_TRUE(memcmp(feedbackJson, TEST_FEEDBACK_BODY, length) == 0);
+
+    *recordCount = 0;
+    for (i = 0; i < testFeedbackRecordCount; i++)
+    {
+        IOTHUB_SERVICE_FEEDBACK_RECORD feedbackRecord = TEST_FEEDBACK_RECORDS[i];
+        if (recordHandler(context, &feedbackRecord) != 0)
+        {
+            result = __LINE__;
+            break;
+        }
+        (*recordCount)++;
+    }
+    return result;
+}
+
 static STRING_HANDLE my_SASToken_Create(STRING_HANDLE key, STRING_HANDLE scope, STRING_HANDLE keyName, size_t expiry)
 {
     (void)key;
@@ -294,17 +321,48 @@ void my_messagereceiver_destroy(MESSAGE_RECEIVER_HANDLE message_receiver)
     }
 }
 
+#define TEST_CONCURRENT_SEND_COUNT 1000
 static ON_MESSAGE_SEND_COMPLETE onMessageSendCompleteCallback;
+static void* onMessageSendCompleteContext;
+static void* onMessageSendCompleteContexts[TEST_CONCURRENT_SEND_COUNT];
+static size_t onMessageSendCompleteContextCount;
 static ASYNC_OPERATION_HANDLE my_messagesender_send_async(MESSAGE_SENDER_HANDLE message_sender, MESSAGE_HANDLE message, ON_MESSAGE_SEND_COMPLETE on_message_send_complete, void* callback_context, tickcounter_ms_t timeout)
 {
     (void)timeout;
     (void)message;
     (void)message_sender;
-    (void)callback_context;
     onMessageSendCompleteCallback = on_message_send_complete;
+    onMessageSendCompleteContext = callback_context;
+    if (onMessageSendCompleteContextCount < TEST_CONCURRENT_SEND_COUNT)
+    {
+        onMessageSendCompleteContexts[onMessageSendCompleteContextCount++] = callback_context;
+    }
     return TEST_ASYNC_HANDLE;
 }
 
+/*not a mock: keeps what the batch completion reported*/
+static size_t sendBatchCompleteCallCount;
+static IOTHUB_MESSAGING_RESULT sendBatchCompleteResults[2];
+static void recordingSendBatchCompleteCallback(void* context, const IOTHUB_MESSAGING_RESULT* messagingResults, size_t deviceIdCount)
+{
+    size_t i;
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x4242, context);
+    ASSERT_ARE_EQUAL(size_t, sizeof(sendBatchCompleteResults) / sizeof(sendBatchCompleteResults[0]), deviceIdCount);
+    for (i = 0; i < deviceIdCount; i++)
+    {
+        sendBatchCompleteResults[i] = messagingResults[i];
+    }
+    sendBatchCompleteCallCount++;
+}
+
+/*not a mock: counts how many times each user context has been called back*/
+static size_t sendCompleteCallCount[TEST_CONCURRENT_SEND_COUNT];
+static void countingSendCompleteCallback(void* context, IOTHUB_MESSAGING_RESULT messagingResult)
+{
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, messagingResult);
+    (*(size_t*)context)++;
+}
+
 static ON_MESSAGE_RECEIVED onMessageReceivedCallback;
 static int my_messagereceiver_open(MESSAGE_RECEIVER_HANDLE message_receiver, ON_MESSAGE_RECEIVED on_message_received, void* callback_context)
 {
@@ -317,6 +375,7 @@ static int my_messagereceiver_open(MESSAGE_RECEIVER_HANDLE message_receiver, ON_
 //static IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK on_feedback_message_received;
 
 static IOTHUB_FEEDBACK_STATUS_CODE receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
+static size_t receivedFeedbackRecordCount;
 void my_on_feedback_message_received(void* context, IOTHUB_SERVICE_FEEDBACK_BATCH* feedbackBatch)
 {
     (void)context;
@@ -325,10 +384,18 @@ void my_on_feedback_message_received(void* context, IOTHUB_SERVICE_FEEDBACK_BATC
     {
         IOTHUB_SERVICE_FEEDBACK_RECORD* feedback = (IOTHUB_SERVICE_FEEDBACK_RECORD*)my_list_item_get_value(feedbackRecord);
         receivedFeedbackStatusCode = feedback->statusCode;
+        receivedFeedbackRecordCount++;
         feedbackRecord = my_list_get_next_item(feedbackRecord);
     }
 }
 
+void my_on_feedback_record_received(void* context, const IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    (void)context;
+    receivedFeedbackStatusCode = feedbackRecord->statusCode;
+    receivedFeedbackRecordCount++;
+}
+
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/gballoc.h"
 #undef ENABLE_MOCKS
@@ -349,12 +416,6 @@ static char* TEST_TRUSTED_CERT = "Test_trusted_cert";
 
 static int TEST_ISOPENED = false;
 
-static const char* TEST_FEEDBACK_RECORD_KEY_DEVICE_ID = "deviceId";
-static const char* TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID = "deviceGenerationId";
-static const char* TEST_FEEDBACK_RECORD_KEY_DESCRIPTION = "description";
-static const char* TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC = "enqueuedTimeUtc";
-static const char* TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID = "originalMessageId";
-
 static const char* TEST_MAP_KEYS[] = { "Key1" };
 static const char* TEST_MAP_VALUES[] = { "Val1" };
 const char* const ** pTEST_MAP_KEYS = (const char* const **)&TEST_MAP_KEYS;
@@ -402,10 +463,6 @@ static IOTHUB_OPEN_COMPLETE_CALLBACK TEST_IOTHUB_OPEN_COMPLETE_CALLBACK;
 static IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK TEST_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK = (IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK)0x6060;
 static MESSAGE_SENDER_STATE TEST_MESSAGE_SENDER_STATE = (MESSAGE_SENDER_STATE)0x6161;
 static IOTHUB_MESSAGING_RESULT TEST_IOTHUB_MESSAGING_RESULT = (IOTHUB_MESSAGING_RESULT)0x6767;
-static JSON_Value* TEST_JSON_VALUE = (JSON_Value*)0x5050;
-static JSON_Object* TEST_JSON_OBJECT = (JSON_Object*)0x5151;
-static JSON_Array* TEST_JSON_ARRAY = (JSON_Array*)0x5252;
-static JSON_Status TEST_JSON_STATUS = 0;
 static AMQP_VALUE TEST_AMQP_MAP = ((AMQP_VALUE)0x6258);
 static MAP_HANDLE TEST_MAP_HANDLE = (MAP_HANDLE)0x103;
 static IOTHUB_MESSAGE_HANDLE TEST_IOTHUB_MESSAGE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x4242;
@@ -452,9 +509,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_SEND_COMPLETE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(BINARY_DATA, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SASL_MECHANISM_HANDLE, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(JSON_Value, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(JSON_Object, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(JSON_Status, int);
+        REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_FEEDBACK_RECORD_HANDLER, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
@@ -482,6 +537,8 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
 
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
 
         REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
@@ -593,20 +650,8 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         REGISTER_GLOBAL_MOCK_RETURN(messagesender_send_async, (ASYNC_OPERATION_HANDLE)0x64);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(messagesender_send_async, NULL);
 
-        REGISTER_GLOBAL_MOCK_RETURN(json_parse_string, TEST_JSON_VALUE);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string, NULL);
-
-        REGISTER_GLOBAL_MOCK_RETURN(json_value_get_array, TEST_JSON_ARRAY);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_get_array, NULL);
-
-        REGISTER_GLOBAL_MOCK_RETURN(json_array_get_object, TEST_JSON_OBJECT);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_array_get_object, NULL);
-
-        REGISTER_GLOBAL_MOCK_RETURN(json_array_get_count, 42);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_array_get_count, 0);
-
-        REGISTER_GLOBAL_MOCK_RETURN(json_object_get_string, TEST_CONST_CHAR_PTR);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_string, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(IoTHubScFeedbackParser_Parse, my_IoTHubScFeedbackParser_Parse);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScFeedbackParser_Parse, 1);
 
         REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_create, my_list_create);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_create, NULL);
@@ -649,6 +694,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_GetCorrelationId, NULL);
 
         REGISTER_GLOBAL_MOCK_HOOK(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, my_on_feedback_message_received);
+        REGISTER_GLOBAL_MOCK_HOOK(TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, my_on_feedback_record_received);
     }
 
     TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -676,11 +722,25 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         onMessageSenderStateChangedCallback = NULL;
         onMessageReceiverStateChangedCallback = NULL;
         onMessageSendCompleteCallback = NULL;
+        onMessageSendCompleteContext = NULL;
+        onMessageSendCompleteContextCount = 0;
+        memset(sendCompleteCallCount, 0, sizeof(sendCompleteCallCount));
+        sendBatchCompleteCallCount = 0;
         onMessageReceivedCallback = NULL;
         messagereceiver_create_return = NULL;
         messagesender_create_return = NULL;
 
         receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
+        receivedFeedbackRecordCount = 0;
+
+        memset(TEST_FEEDBACK_RECORDS, 0, sizeof(TEST_FEEDBACK_RECORDS));
+        TEST_FEEDBACK_RECORDS[0].description = TEST_DESCRIPTION_SUCCESS;
+        TEST_FEEDBACK_RECORDS[0].statusCode = IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS;
+        TEST_FEEDBACK_RECORDS[0].correlationId = "";
+        TEST_FEEDBACK_RECORDS[1].description = TEST_DESCRIPTION_EXPIRED;
+        TEST_FEEDBACK_RECORDS[1].statusCode = IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED;
+        TEST_FEEDBACK_RECORDS[1].correlationId = "";
+        testFeedbackRecordCount = 2;
     }
 
     TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -882,6 +942,8 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         // act
         IoTHubMessaging_LL_Destroy(handle);
@@ -1336,6 +1398,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
             .IgnoreAllArguments();
 
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
             .IgnoreAllArguments();
 
@@ -1387,7 +1450,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
             26, /*amqpvalue_destroy*/
             27, /*amqpvalue_destroy*/
             28, /*amqpvalue_destroy*/
-            30  /*gballoc_free*/
+            31  /*gballoc_free*/
         };
 
         size_t number_of_arguments = 1;
@@ -1467,6 +1530,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
             .IgnoreAllArguments();
 
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
             .IgnoreAllArguments();
 
@@ -1623,6 +1687,35 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
+    /*Tests_SRS_IOTHUBMESSAGING_02_039: [ If messagingHandle is NULL then IoTHubMessaging_LL_SetFeedbackRecordCallback shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SetFeedbackRecordCallback_with_NULL_messagingHandle_fails)
+    {
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetFeedbackRecordCallback(NULL, TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_02_040: [ IoTHubMessaging_LL_SetFeedbackRecordCallback shall save feedbackRecordReceivedCallback and userContextCallback and return IOTHUB_MESSAGING_OK. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SetFeedbackRecordCallback_succeeds)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        umock_c_reset_all_calls();
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetFeedbackRecordCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
     /*Tests_SRS_IOTHUBMESSAGING_12_045: [ IoTHubMessaging_LL_DoWork shall verify if uAMQP transport has been initialized and if it is not then return immediately ] */
     TEST_FUNCTION(IoTHubMessaging_LL_DoWork_return_if_input_parameter_messagingHandle_is_NULL)
     {
@@ -1844,11 +1937,13 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
 
         umock_c_reset_all_calls();
 
+        STRICT_EXPECTED_CALL(gballoc_free(onMessageSendCompleteContext));
+
         MESSAGE_SEND_RESULT send_result = MESSAGE_SEND_OK;
 
 
         //act
-        onMessageSendCompleteCallback(iothub_messaging_handle, send_result, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContext, send_result, TEST_AMQP_VALUE);
 
         //assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1874,12 +1969,13 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK(IGNORED_PTR_ARG, IOTHUB_MESSAGING_OK));
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK((void*)1, IOTHUB_MESSAGING_OK));
+        STRICT_EXPECTED_CALL(gballoc_free(onMessageSendCompleteContext));
 
         MESSAGE_SEND_RESULT send_result = MESSAGE_SEND_OK;
 
         //act
-        onMessageSendCompleteCallback((void*)iothub_messaging_handle, send_result, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContext, send_result, TEST_AMQP_VALUE);
 
         //assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1889,300 +1985,446 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-#if 0
-    // Modules message sending not available
-    TEST_FUNCTION(IoTHubMessaging_LL_SendModuleMessageComplete_call_to_user_callback)
+    /*Tests_SRS_IOTHUBMESSAGING_02_003: [ IoTHubMessaging_LL_Send shall allocate a context holding messagingHandle, sendCompleteCallback and userContextCallback and pass it to messagesender_send_async, so sends that are in flight at the same time each complete with their own callback and context. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_006: [ IoTHubMessaging_LL_SendMessageComplete shall call the sendCompleteCallback and userContextCallback that were passed to the IoTHubMessaging_LL_Send which produced context. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_007: [ IoTHubMessaging_LL_SendMessageComplete shall free context. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_Send_concurrent_sends_each_complete_once_with_their_own_context)
     {
-        IoTHubMessaging_LL_SendMessageCompleteDevice_call_to_user_callback(true);
-    }
-#endif
+        //arrange
+        size_t i;
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        for (i = 0; i < TEST_CONCURRENT_SEND_COUNT; i++)
+        {
+            ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, countingSendCompleteCallback, &sendCompleteCallCount[i]));
+            umock_c_reset_all_calls();
+        }
+        ASSERT_ARE_EQUAL(size_t, TEST_CONCURRENT_SEND_COUNT, onMessageSendCompleteContextCount);
 
+        //act
+        /*the hub settles deliveries in any order, complete them last to first*/
+        for (i = TEST_CONCURRENT_SEND_COUNT; i > 0; i--)
+        {
+            onMessageSendCompleteCallback(onMessageSendCompleteContexts[i - 1], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
+        }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_057: [ If context is NULL IoTHubMessaging_LL_FeedbackMessageReceived shall do nothing and return delivery_accepted ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_context_is_null)
+        //assert
+        for (i = 0; i < TEST_CONCURRENT_SEND_COUNT; i++)
+        {
+            ASSERT_ARE_EQUAL(size_t, 1, sendCompleteCallCount[i]);
+        }
+
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_02_002: [ If maxInFlightSends is not 0 and maxInFlightSends sends are already waiting for their IoTHubMessaging_LL_SendMessageComplete then IoTHubMessaging_LL_Send shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_005: [ IoTHubMessaging_LL_SendMessageComplete shall decrement the number of sends in flight. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_Send_fails_when_maxInFlightSends_are_in_flight)
     {
         //arrange
         IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxInFlightSends(iothub_messaging_handle, 2);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, countingSendCompleteCallback, &sendCompleteCallCount[0]);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, countingSendCompleteCallback, &sendCompleteCallCount[1]);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
-
         //act
-        void* amqp_result = (void*)onMessageReceivedCallback(NULL, TEST_MESSAGE_HANDLE);
+        IOTHUB_MESSAGING_RESULT thirdWhileFull = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, countingSendCompleteCallback, &sendCompleteCallCount[2]);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[0], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
+        IOTHUB_MESSAGING_RESULT thirdAfterCompletion = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, countingSendCompleteCallback, &sendCompleteCallCount[2]);
 
         //assert
-        ASSERT_IS_NOT_NULL(amqp_result);
-        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, thirdWhileFull);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, thirdAfterCompletion);
 
-        ///cleanup
+        //cleanup
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[1], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[2], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_feedback_success)
+    /*Tests_SRS_IOTHUBMESSAGING_02_001: [ If messagingHandle is NULL then IoTHubMessaging_LL_SetMaxInFlightSends shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SetMaxInFlightSends_with_NULL_messagingHandle_fails)
     {
         //arrange
-        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
 
-        receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetMaxInFlightSends(NULL, 2);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
 
+    /*Tests_SRS_IOTHUBMESSAGING_02_008: [ IoTHubMessaging_LL_SetMaxInFlightSends shall save maxInFlightSends and return IOTHUB_MESSAGING_OK. 0 means there is no limit, which is the default. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SetMaxInFlightSends_succeeds)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetMaxInFlightSends(iothub_messaging_handle, 2);
 
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
+    /*Tests_SRS_IOTHUBMESSAGING_02_055: [ If messagingHandle or inFlightSendCount is NULL then IoTHubMessaging_LL_GetInFlightSendCount shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_GetInFlightSendCount_with_NULL_messagingHandle_fails)
+    {
+        //arrange
+        size_t inFlightSendCount;
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_GetInFlightSendCount(NULL, &inFlightSendCount);
 
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
+    /*Tests_SRS_IOTHUBMESSAGING_02_055: [ If messagingHandle or inFlightSendCount is NULL then IoTHubMessaging_LL_GetInFlightSendCount shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_GetInFlightSendCount_with_NULL_inFlightSendCount_fails)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_GetInFlightSendCount(iothub_messaging_handle, NULL);
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn("SuCcEsS");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
+    /*Tests_SRS_IOTHUBMESSAGING_02_056: [ IoTHubMessaging_LL_GetInFlightSendCount shall set inFlightSendCount to the number of sends waiting for IoTHubMessaging_LL_SendMessageComplete and return IOTHUB_MESSAGING_OK. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_GetInFlightSendCount_succeeds)
+    {
+        //arrange
+        size_t inFlightSendCount = 42;
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_GetInFlightSendCount(iothub_messaging_handle, &inFlightSendCount);
 
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 0, inFlightSendCount);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    static void set_expected_calls_for_SendBatch(size_t deviceIdCount)
+    {
+        size_t i;
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*batch*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*items*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*results*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*destination*/
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_IOTHUB_MESSAGE_HANDLE));
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_IOTHUB_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(message_create());
+        STRICT_EXPECTED_CALL(message_add_body_amqp_data(IGNORED_PTR_ARG, TEST_BINARY_DATA_INST))
+            .IgnoreArgument_amqp_data();
+        STRICT_EXPECTED_CALL(message_get_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_properties(&TEST_PROPERTIES_HANDLE_NULL, sizeof(TEST_PROPERTIES_HANDLE_NULL));
+        STRICT_EXPECTED_CALL(properties_create());
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(TEST_IOTHUB_MESSAGE_HANDLE))
+            .SetReturn(TEST_CONST_CHAR_PTR);
+        STRICT_EXPECTED_CALL(amqpvalue_create_string(TEST_CONST_CHAR_PTR));
+        STRICT_EXPECTED_CALL(properties_set_message_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(TEST_IOTHUB_MESSAGE_HANDLE))
+            .SetReturn(TEST_CONST_CHAR_PTR);
+        STRICT_EXPECTED_CALL(amqpvalue_create_string(TEST_CONST_CHAR_PTR));
+        STRICT_EXPECTED_CALL(properties_set_correlation_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_IOTHUB_MESSAGE_HANDLE));
+        STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG));
+        for (i = 0; i < deviceIdCount; i++)
+        {
+            STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(properties_set_to(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(message_set_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+            STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+        }
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(properties_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(message_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*destination*/
+    }
 
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG));
+    /*Tests_SRS_IOTHUBMESSAGING_02_010: [ If messagingHandle, deviceIds or message is NULL, deviceIdCount is 0 or any of the deviceIds is NULL then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_with_invalid_arguments_fails)
+    {
+        //arrange
+        const char* deviceIds[] = { "d1", "d2" };
+        const char* deviceIdsWithNull[] = { "d1", NULL };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
 
         //act
-        onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+        IOTHUB_MESSAGING_RESULT nullHandle = IoTHubMessaging_LL_SendBatch(NULL, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
+        IOTHUB_MESSAGING_RESULT nullDeviceIds = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, NULL, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
+        IOTHUB_MESSAGING_RESULT zeroDevices = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 0, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
+        IOTHUB_MESSAGING_RESULT nullMessage = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 2, NULL, recordingSendBatchCompleteCallback, (void*)0x4242);
+        IOTHUB_MESSAGING_RESULT nullDeviceId = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIdsWithNull, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS, receivedFeedbackStatusCode);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, nullHandle);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, nullDeviceIds);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, zeroDevices);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, nullMessage);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, nullDeviceId);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, sendBatchCompleteCallCount);
 
-        ///cleanup
+        //cleanup
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_feedback_expired)
+    /*Tests_SRS_IOTHUBMESSAGING_02_011: [ If the messaging is not opened then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_fails_if_messaging_is_not_opened)
     {
         //arrange
+        const char* deviceIds[] = { "d1", "d2" };
         IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
-        receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
-
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
 
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
+    /*Tests_SRS_IOTHUBMESSAGING_02_012: [ If maxInFlightSends is not 0 and the batch would take the number of sends in flight over it then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_fails_if_the_batch_exceeds_maxInFlightSends)
+    {
+        //arrange
+        const char* deviceIds[] = { "d1", "d2" };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxInFlightSends(iothub_messaging_handle, 1);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
 
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn("ExPiReD");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    /*Tests_SRS_IOTHUBMESSAGING_02_013: [ IoTHubMessaging_LL_SendBatch shall allocate the batch context, one context and one result per device and a single buffer large enough for the address of any of the devices. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_015: [ IoTHubMessaging_LL_SendBatch shall build the uAMQP message body, message id, correlation id and application properties once for the whole batch. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_016: [ For every device IoTHubMessaging_LL_SendBatch shall only replace the TO property of the shared message by calling properties_set_to and message_set_properties. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_017: [ IoTHubMessaging_LL_SendBatch shall call messagesender_send_async with the shared message, IoTHubMessaging_LL_SendBatchMessageComplete and the context of the device. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_019: [ If no device could be sent to then IoTHubMessaging_LL_SendBatch shall free the batch, shall not call sendBatchCompleteCallback and shall return IOTHUB_MESSAGING_ERROR. Otherwise it shall return IOTHUB_MESSAGING_OK. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_builds_the_message_once_and_sends_it_to_every_device)
+    {
+        //arrange
+        const char* deviceIds[] = { "d1", "a_longer_device_id" };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        set_expected_calls_for_SendBatch(2);
 
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, onMessageSendCompleteContextCount);
+        ASSERT_ARE_EQUAL(size_t, 0, sendBatchCompleteCallCount);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+        //cleanup
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[0], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[1], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    /*Tests_SRS_IOTHUBMESSAGING_02_020: [ IoTHubMessaging_LL_SendBatchMessageComplete shall store the result of the send in the position of its device and decrement the number of sends in flight. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_021: [ When the last send of the batch completes, sendBatchCompleteCallback shall be called once with userContextCallback, the results indexed like deviceIds and deviceIdCount, then the batch shall be freed. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_reports_every_device_once_when_the_last_send_completes)
+    {
+        //arrange
+        const char* deviceIds[] = { "d1", "d2" };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxInFlightSends(iothub_messaging_handle, 2);
+        (void)IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
+        umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG));
-
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         //act
-        onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[1], MESSAGE_SEND_ERROR, TEST_AMQP_VALUE);
+        ASSERT_ARE_EQUAL(size_t, 0, sendBatchCompleteCallCount);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[0], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, receivedFeedbackStatusCode);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sendBatchCompleteCallCount);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, sendBatchCompleteResults[0]);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, sendBatchCompleteResults[1]);
+        /*both sends left the in flight count*/
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, NULL, NULL));
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, NULL, NULL));
 
-        ///cleanup
+        //cleanup
+        onMessageSendCompleteCallback(onMessageSendCompleteContext, MESSAGE_SEND_OK, TEST_AMQP_VALUE);
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_feedback_deliverycountexceeded)
+    /*Tests_SRS_IOTHUBMESSAGING_02_018: [ If sending to a device fails then its result shall be IOTHUB_MESSAGING_ERROR and IoTHubMessaging_LL_SendBatch shall continue with the next device. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_reports_a_device_that_could_not_be_sent_to_as_an_error)
     {
         //arrange
+        const char* deviceIds[] = { "d1", "d2" };
         IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
-        receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
-
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        int umockc_result = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, umockc_result);
+        set_expected_calls_for_SendBatch(2);
+        umock_c_negative_tests_snapshot();
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(23); /*messagesender_send_async of d1*/
 
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
+        umock_c_negative_tests_deinit();
+        onMessageSendCompleteCallback(onMessageSendCompleteContext, MESSAGE_SEND_OK, TEST_AMQP_VALUE);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 1, sendBatchCompleteCallCount);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, sendBatchCompleteResults[0]);
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, sendBatchCompleteResults[1]);
 
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+    /*Tests_SRS_IOTHUBMESSAGING_02_014: [ If any allocation fails then IoTHubMessaging_LL_SendBatch shall fail and return IOTHUB_MESSAGING_ERROR. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_019: [ If no device could be sent to then IoTHubMessaging_LL_SendBatch shall free the batch, shall not call sendBatchCompleteCallback and shall return IOTHUB_MESSAGING_ERROR. Otherwise it shall return IOTHUB_MESSAGING_OK. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_SendBatch_of_one_device_unhappy_paths)
+    {
+        //arrange
+        const char* deviceIds[] = { "d1" };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn("DeLiVeRyCoUnTeXcEeDeD");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
+        int umockc_result = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        set_expected_calls_for_SendBatch(1);
+        umock_c_negative_tests_snapshot();
 
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            if (
+                (i != 8) && /*message_get_properties*/
+                (i != 10) && /*IoTHubMessage_GetMessageId*/
+                (i != 12) && /*properties_set_message_id*/
+                (i != 13) && /*amqpvalue_destroy*/
+                (i != 14) && /*IoTHubMessage_GetCorrelationId*/
+                (i != 16) && /*properties_set_correlation_id*/
+                (i != 17) && /*amqpvalue_destroy*/
+                (i != 18) && /*IoTHubMessage_Properties*/
+                (i != 19) && /*Map_GetInternals*/
+                (i != 24) && /*amqpvalue_destroy*/
+                (i != 25) && /*properties_destroy*/
+                (i != 26) && /*message_destroy*/
+                (i != 27) /*gballoc_free*/
+                )
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(i);
 
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
+                //act
+                IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendBatch(iothub_messaging_handle, deviceIds, 1, TEST_IOTHUB_MESSAGE_HANDLE, recordingSendBatchCompleteCallback, (void*)0x4242);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+                //assert
+                ASSERT_ARE_NOT_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+                ASSERT_ARE_EQUAL(size_t, 0, sendBatchCompleteCallCount);
+            }
+        }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //cleanup
+        umock_c_negative_tests_deinit();
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+#if 0
+    // Modules message sending not available
+    TEST_FUNCTION(IoTHubMessaging_LL_SendModuleMessageComplete_call_to_user_callback)
+    {
+        IoTHubMessaging_LL_SendMessageCompleteDevice_call_to_user_callback(true);
+    }
+#endif
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+    /*Tests_SRS_IOTHUBMESSAGING_12_057: [ If context is NULL IoTHubMessaging_LL_FeedbackMessageReceived shall do nothing and return delivery_accepted ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_context_is_null)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
 
         //act
-        onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+        void* amqp_result = (void*)onMessageReceivedCallback(NULL, TEST_MESSAGE_HANDLE);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_DELIVER_COUNT_EXCEEDED, receivedFeedbackStatusCode);
+        ASSERT_IS_NOT_NULL(amqp_result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
@@ -2190,285 +2432,184 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_feedback_rejected)
+    static IOTHUB_MESSAGING_HANDLE create_messaging_for_feedback(bool recordCallback)
     {
-        //arrange
-        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
-        receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN;
-
+        IOTHUB_MESSAGING_HANDLE result = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(result, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(result, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
+        if (recordCallback)
+        {
+            (void)IoTHubMessaging_LL_SetFeedbackRecordCallback(result, TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, (void*)1);
+        }
         umock_c_reset_all_calls();
+        return result;
+    }
 
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
-
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn("ReJeCtEd");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
-
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
+    static void set_expected_calls_for_feedback_batch(bool growBuffers)
+    {
+        size_t i;
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG))
+        if (growBuffers)
+        {
+            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+                .IgnoreAllArguments();
+        }
+        STRICT_EXPECTED_CALL(IoTHubScFeedbackParser_Parse(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG))
+        if (growBuffers)
+        {
+            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+                .IgnoreAllArguments();
+        }
+        STRICT_EXPECTED_CALL(singlylinkedlist_create());
+        for (i = 0; i < testFeedbackRecordCount; i++)
+        {
+            STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreAllArguments();
+        }
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
+        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
         STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG))
             .IgnoreAllArguments();
+    }
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
+    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
+    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
+    /*Tests_SRS_IOTHUBMESSAGING_02_036: [ IoTHubMessaging_LL_FeedbackMessageReceived shall copy the body into a buffer owned by the messaging instance, growing it only when the body does not fit. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_037: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the body by calling IoTHubScFeedbackParser_Parse; the records of a batch shall be stored in an array owned by the messaging instance that is reused by the following batches. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
+    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_delivers_the_batch)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = create_messaging_for_feedback(false);
 
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        set_expected_calls_for_feedback_batch(true);
 
         //act
-        onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+        AMQP_VALUE amqp_result = onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_REJECTED, receivedFeedbackStatusCode);
+        ASSERT_ARE_EQUAL(void_ptr, TEST_AMQP_VALUE, amqp_result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, receivedFeedbackRecordCount);
+        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, receivedFeedbackStatusCode);
 
         ///cleanup
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-
-    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_feedback_unknown)
+    /*Tests_SRS_IOTHUBMESSAGING_02_036: [ IoTHubMessaging_LL_FeedbackMessageReceived shall copy the body into a buffer owned by the messaging instance, growing it only when the body does not fit. ]*/
+    /*Tests_SRS_IOTHUBMESSAGING_02_037: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the body by calling IoTHubScFeedbackParser_Parse; the records of a batch shall be stored in an array owned by the messaging instance that is reused by the following batches. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_reuses_the_buffers_of_the_previous_batch)
     {
         //arrange
-        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
-        receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS;
-
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = create_messaging_for_feedback(false);
+        (void)onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
         umock_c_reset_all_calls();
+        receivedFeedbackRecordCount = 0;
 
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
-
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn("XxX");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
+        set_expected_calls_for_feedback_batch(false);
 
+        //act
+        AMQP_VALUE amqp_result = onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //assert
+        ASSERT_ARE_EQUAL(void_ptr, TEST_AMQP_VALUE, amqp_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, receivedFeedbackRecordCount);
 
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
+        ///cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+    /*Tests_SRS_IOTHUBMESSAGING_02_038: [ If a record callback is set, IoTHubMessaging_LL_FeedbackMessageReceived shall call it for every record as soon as the record is parsed and shall not call the IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK. ]*/
+    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_with_record_callback_delivers_records_one_at_a_time)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = create_messaging_for_feedback(true);
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(IoTHubScFeedbackParser_Parse(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK((void*)1, IGNORED_PTR_ARG))
+            .IgnoreArgument(2);
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK((void*)1, IGNORED_PTR_ARG))
+            .IgnoreArgument(2);
+        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
 
         //act
-        onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+        AMQP_VALUE amqp_result = onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN, receivedFeedbackStatusCode);
+        ASSERT_ARE_EQUAL(void_ptr, TEST_AMQP_VALUE, amqp_result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, receivedFeedbackRecordCount);
+        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, receivedFeedbackStatusCode);
 
         ///cleanup
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_058: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall get the content string of the message by calling message_get_body_amqp_data_in_place ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_059: [ IoTHubMessaging_LL_FeedbackMessageReceived shall parse the response JSON to IOTHUB_SERVICE_FEEDBACK_BATCH struct ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_060: [ IoTHubMessaging_LL_FeedbackMessageReceived shall use the following parson APIs to parse the response string: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_062: [ If context is not NULL IoTHubMessaging_LL_FeedbackMessageReceived shall call IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK with the received IOTHUB_SERVICE_FEEDBACK_BATCH ] */
-    /*Tests_SRS_IOTHUBMESSAGING_12_078: [** IoTHubMessaging_LL_FeedbackMessageReceived shall do clean up before exits ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_happy_path_feedback_null)
+    /*Tests_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_rejects_a_batch_the_parser_fails_on)
     {
         //arrange
-        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
-        receivedFeedbackStatusCode = IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS;
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = create_messaging_for_feedback(false);
 
-        umock_c_reset_all_calls();
-
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
+        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(IoTHubScFeedbackParser_Parse(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments()
             .SetReturn(1);
+        STRICT_EXPECTED_CALL(messaging_delivery_rejected(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
+        //act
+        (void)onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
 
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, receivedFeedbackRecordCount);
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        ///cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn(NULL);
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
+    /*Tests_SRS_IOTHUBMESSAGING_12_061: [ If any of the parson API fails, IoTHubMessaging_LL_FeedbackMessageReceived shall return IOTHUB_MESSAGING_INVALID_JSON ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_FeedbackMessageReceived_rejects_an_empty_batch)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = create_messaging_for_feedback(false);
+        testFeedbackRecordCount = 0;
 
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(IoTHubScFeedbackParser_Parse(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(messaging_delivery_rejected(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
         //act
-        onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+        (void)onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN, receivedFeedbackStatusCode);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, receivedFeedbackRecordCount);
 
         ///cleanup
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
@@ -2483,83 +2624,33 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         int umockc_result = umock_c_negative_tests_init();
         ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
-        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
-        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)1);
-        (void)IoTHubMessaging_LL_SetFeedbackMessageCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, (void*)1);
-
-        umock_c_reset_all_calls();
-
-        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_create());
-
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_ID))
-            .SetReturn("deviceId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DEVICE_GENERATION_ID))
-            .SetReturn("generationId");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_DESCRIPTION))
-            .SetReturn("success");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ENQUED_TIME_UTC))
-            .SetReturn("time");
-        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_FEEDBACK_RECORD_KEY_ORIGINAL_MESSAGE_ID))
-            .SetReturn("originalMessageId");
-
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-
-        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
-
+        set_expected_calls_for_feedback_batch(true);
         umock_c_negative_tests_snapshot();
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
         {
-            /// arrange
-            umock_c_negative_tests_reset();
-            umock_c_negative_tests_fail_call(i);
-
-            if (i <= 9)
+            /*only the calls that can fail*/
+            if (i <= 6)
             {
+                /// arrange
+                umock_c_negative_tests_reset();
+                IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = create_messaging_for_feedback(false);
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(i);
+                receivedFeedbackRecordCount = 0;
+
                 //act
-                AMQP_VALUE amqp_result = onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
+                (void)onMessageReceivedCallback(iothub_messaging_handle, TEST_MESSAGE_HANDLE);
 
                 //assert
-                if (i < 7)
-                {
-                    if (amqp_result != NULL)
-                    {
-                        ASSERT_ARE_EQUAL(int, 0, 1);
-                    }
-                }
+                ASSERT_ARE_EQUAL(size_t, 0, receivedFeedbackRecordCount, "On failed call %lu", (unsigned long)i);
+
+                ///cleanup
+                IoTHubMessaging_LL_Close(iothub_messaging_handle);
+                IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
             }
         }
         umock_c_negative_tests_deinit();
-
-        ///cleanup
-        IoTHubMessaging_LL_Close(iothub_messaging_handle);
-        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
     TEST_FUNCTION(IoTHubMessaging_LL_SetTrustedCert_success)
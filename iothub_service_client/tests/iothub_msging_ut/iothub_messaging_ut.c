@@ -21,6 +21,7 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
 #include "parson.h"
 #ifdef __cplusplus
 #include <csignal>
@@ -88,6 +89,7 @@ static IOTHUB_MESSAGING_RESULT TEST_IOTHUB_MESSAGING_RESULT = (IOTHUB_MESSAGING_
 //static const char* TEST_MODULE_ID = "TestModuleId"; // Modules are not supported for sending messages.
 static IOTHUB_OPEN_COMPLETE_CALLBACK TEST_IOTHUB_OPEN_COMPLETE_CALLBACK;
 static IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK TEST_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK;
+static IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK TEST_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK = (IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK)0x4545;
 static IOTHUB_SEND_COMPLETE_CALLBACK TEST_IOTHUB_SEND_COMPLETE_CALLBACK;
 
 static char* TEST_TRUSTED_CERT = "Test_trusted_cert";
@@ -98,11 +100,21 @@ typedef struct TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE_TAG
     THREAD_HANDLE ThreadHandle;
     LOCK_HANDLE LockHandle;
     sig_atomic_t StopThread;
+    LOCK_HANDLE SubmitLock;
+    COND_HANDLE WorkAvailable;
+    void* PendingSendsHead;
+    void* PendingSendsTail;
+    int IsOpened;
+    size_t MaxInFlightSends;
+    size_t QueuedSendCount;
+    size_t InFlightSendCount;
 } TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE;
 
 static TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE TEST_IOTHUB_MESSAGING_CLIENT;
 
 static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x1212;
+static COND_HANDLE TEST_COND_HANDLE = (COND_HANDLE)0x1313;
+static IOTHUB_MESSAGE_HANDLE TEST_IOTHUB_MESSAGE_CLONE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x5353;
 static LOCK_HANDLE my_Lock_Init(void)
 {
     return TEST_LOCK_HANDLE;
@@ -126,6 +138,26 @@ static LOCK_RESULT my_Unlock(LOCK_HANDLE handle)
     return LOCK_OK;
 }
 
+static THREAD_START_FUNC g_workerThreadFunc;
+static void* g_workerThreadArg;
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+    (void)threadHandle;
+    g_workerThreadFunc = func;
+    g_workerThreadArg = arg;
+    return THREADAPI_OK;
+}
+
+/*the worker thread runs until StopThread is set, the first wait of a test stops it*/
+static COND_RESULT my_Condition_Wait(COND_HANDLE handle, LOCK_HANDLE lock, int timeout_milliseconds)
+{
+    (void)handle;
+    (void)lock;
+    (void)timeout_milliseconds;
+    ((TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)g_workerThreadArg)->StopThread = 1;
+    return COND_OK;
+}
+
 static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int *res)
 {
     (void)threadHandle;
@@ -190,10 +222,15 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_OPEN_COMPLETE_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SEND_COMPLETE_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SEND_BATCH_COMPLETE_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const char* const*, void*);
     REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
     REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_RESULT, int);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -215,9 +252,18 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(Unlock, my_Unlock);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Unlock, LOCK_ERROR);
 
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
     REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Join, THREADAPI_ERROR);
 
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Init, TEST_COND_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Condition_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Post, COND_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(Condition_Wait, my_Condition_Wait);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_Clone, TEST_IOTHUB_MESSAGE_CLONE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_Clone, NULL);
+
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessaging_LL_Create, my_IoTHubMessaging_LL_Create);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessaging_LL_Create, NULL);
 
@@ -231,7 +277,12 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessaging_LL_SetFeedbackMessageCallback, my_IoTHubMessaging_LL_SetFeedbackMessageCallback);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessaging_LL_SetFeedbackMessageCallback, IOTHUB_MESSAGING_ERROR);
 
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessaging_LL_SetFeedbackRecordCallback, IOTHUB_MESSAGING_OK);
+
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessaging_LL_SetTrustedCert, IOTHUB_MESSAGING_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessaging_LL_SetMaxInFlightSends, IOTHUB_MESSAGING_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessaging_LL_Send, IOTHUB_MESSAGING_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessaging_LL_GetInFlightSendCount, IOTHUB_MESSAGING_OK);
 }
 
 TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -255,6 +306,8 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     TEST_IOTHUB_MESSAGING_CLIENT.ThreadHandle = (THREAD_HANDLE)0x3535;
     TEST_IOTHUB_MESSAGING_CLIENT.LockHandle = (LOCK_HANDLE)0x3636;
     TEST_IOTHUB_MESSAGING_CLIENT.StopThread = (sig_atomic_t)0x3737;
+    g_workerThreadFunc = NULL;
+    g_workerThreadArg = NULL;
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -277,6 +330,7 @@ TEST_FUNCTION(IoTHubMessaging_Create_return_null_if_input_parameter_serviceClien
 
 /*Tests_SRS_IOTHUBMESSAGING_12_002: [ IoTHubMessaging_Create shall allocate a new IoTHubMessagingClient instance. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_004: [ IoTHubMessaging_Create shall create a lock object to be used later for serializing IoTHubMessagingClient calls. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_045: [ IoTHubMessaging_Create shall create a second lock that guards the queue of sends and a condition the worker thread waits on. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_006: [ IoTHubMessaging_Create shall instantiate a new IoTHubMessaging_LL instance by calling IoTHubMessaging_LL_Create and passing the serviceClientHandle argument. ]*/
 TEST_FUNCTION(IoTHubMessaging_Create_happy_path)
 {
@@ -285,6 +339,8 @@ TEST_FUNCTION(IoTHubMessaging_Create_happy_path)
         .IgnoreArgument(1);
 
     STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
     STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Create(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -306,6 +362,7 @@ TEST_FUNCTION(IoTHubMessaging_Create_happy_path)
 /*Tests_SRS_IOTHUBMESSAGING_12_005 : [ If creating the lock fails, then IoTHubMessaging_Create shall return NULL. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_007 : [ If IoTHubMessaging_LL_Create fails, then IoTHubMessaging_Create shall return NULL. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_008 : [ If IoTHubMessaging_Create fails, all resources allocated by it shall be freed. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_046: [ If creating the second lock or the condition fails, then IoTHubMessaging_Create shall return NULL. ]*/
 TEST_FUNCTION(IoTHubMessaging_Create_non_happy_path)
 {
     // arrange
@@ -316,6 +373,8 @@ TEST_FUNCTION(IoTHubMessaging_Create_non_happy_path)
         .IgnoreArgument(1);
 
     STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
     STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Create(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -352,6 +411,7 @@ TEST_FUNCTION(IoTHubMessaging_Destroy_return_if_input_parameter_messagingHandle_
 /*Tests_SRS_IOTHUBMESSAGING_12_012: [ IoTHubMessaging_Destroy shall unlock the serializing lock. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_013: [ The thread created as part of executing IoTHubMessaging_SendAsync shall be joined. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_014: [ If the lock was allocated in IoTHubMessaging_Create, it shall be also freed. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_047: [ IoTHubMessaging_Destroy shall call the sendCompleteCallback of every send still queued with IOTHUB_MESSAGING_ERROR. ]*/
 TEST_FUNCTION(IoTHubMessaging_Destroy_happy_path)
 {
     // arrange
@@ -362,6 +422,9 @@ TEST_FUNCTION(IoTHubMessaging_Destroy_happy_path)
     STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Destroy(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(Condition_Deinit(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -402,11 +465,15 @@ TEST_FUNCTION(IoTHubMessaging_Open_happy_path)
 
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Open((IOTHUB_MESSAGING_HANDLE)0X3333, TEST_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)0x4242));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
 
     // act
     IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_Open(messagingClientHandle, TEST_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)0x4242);
@@ -414,6 +481,7 @@ TEST_FUNCTION(IoTHubMessaging_Open_happy_path)
     // assert
     ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(messagingClientInstance->IsOpened);
 
     // cleanup
     free(messagingClientHandle);
@@ -442,6 +510,59 @@ TEST_FUNCTION(IoTHubMessaging_Open_Lock_fails)
     free(messagingClientHandle);
 }
 
+/*Tests_SRS_IOTHUBMESSAGING_02_058: [ IoTHubMessaging_Open shall also acquire the lock that guards the queue of sends and record whether IoTHubMessaging_LL_Open succeeded, IoTHubMessaging_Close shall record that the client is closed. ]*/
+TEST_FUNCTION(IoTHubMessaging_Open_when_IoTHubMessaging_LL_Open_fails_leaves_the_client_closed)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Open((IOTHUB_MESSAGING_HANDLE)0X3333, TEST_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)0x4242))
+        .SetReturn(IOTHUB_MESSAGING_ERROR);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_Open(messagingClientHandle, TEST_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(messagingClientInstance->IsOpened);
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_12_017: [ If acquiring the lock fails, IoTHubMessaging_Open shall return IOTHUB_MESSAGING_ERROR. ]*/
+TEST_FUNCTION(IoTHubMessaging_Open_second_Lock_fails)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .SetReturn(LOCK_ERROR);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_Open(messagingClientHandle, TEST_IOTHUB_OPEN_COMPLETE_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
 /*Tests_SRS_IOTHUBMESSAGING_12_021: [ If messagingClientHandle is NULL, IoTHubMessaging_Close shall do nothing. ]*/
 TEST_FUNCTION(IoTHubMessaging_Close_do_nothing_if_input_parameter_messagingClientHandle_is_NULL)
 {
@@ -458,6 +579,7 @@ TEST_FUNCTION(IoTHubMessaging_Close_do_nothing_if_input_parameter_messagingClien
 /*Tests_SRS_IOTHUBMESSAGING_12_024: [ IoTHubMessaging_Close shall call IoTHubMessaging_LL_Close, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubMessaging_Create ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_025: [ When IoTHubMessaging_LL_Close is called, IoTHubMessaging_Close shall return the result of IoTHubMessaging_LL_Close. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_026: [ IoTHubMessaging_Close shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_048: [ IoTHubMessaging_Close shall signal the condition so that a waiting worker thread exits without waiting for its timeout. ]*/
 TEST_FUNCTION(IoTHubMessaging_Close_happy_path_thread_handle_null)
 {
     // arrange
@@ -470,6 +592,7 @@ TEST_FUNCTION(IoTHubMessaging_Close_happy_path_thread_handle_null)
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -489,6 +612,8 @@ TEST_FUNCTION(IoTHubMessaging_Close_happy_path_thread_handle_null)
 /*Tests_SRS_IOTHUBMESSAGING_12_024: [ IoTHubMessaging_Close shall call IoTHubMessaging_LL_Close, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubMessaging_Create ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_025: [ When IoTHubMessaging_LL_Close is called, IoTHubMessaging_Close shall return the result of IoTHubMessaging_LL_Close. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_026: [ IoTHubMessaging_Close shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_048: [ IoTHubMessaging_Close shall signal the condition so that a waiting worker thread exits without waiting for its timeout. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_058: [ IoTHubMessaging_Open shall also acquire the lock that guards the queue of sends and record whether IoTHubMessaging_LL_Open succeeded, IoTHubMessaging_Close shall record that the client is closed. ]*/
 TEST_FUNCTION(IoTHubMessaging_Close_happy_path_thread_handle_not_null)
 {
     // arrange
@@ -496,11 +621,14 @@ TEST_FUNCTION(IoTHubMessaging_Close_happy_path_thread_handle_not_null)
     TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
     messagingClientInstance->IoTHubMessagingHandle = TEST_IOTHUB_MESSAGING_HANDLE;
     messagingClientInstance->ThreadHandle = (THREAD_HANDLE)0X3333;
+    messagingClientInstance->IsOpened = 1;
+    messagingClientInstance->InFlightSendCount = 2;
 
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -513,6 +641,8 @@ TEST_FUNCTION(IoTHubMessaging_Close_happy_path_thread_handle_not_null)
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(messagingClientInstance->IsOpened);
+    ASSERT_ARE_EQUAL(size_t, 0, messagingClientInstance->InFlightSendCount);
 
     // cleanup
     free(messagingClientHandle);
@@ -532,6 +662,7 @@ TEST_FUNCTION(IoTHubMessaging_Close_Lock_fails)
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .SetReturn(LOCK_ERROR);
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
 
     STRICT_EXPECTED_CALL(ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
         .IgnoreAllArguments();
@@ -612,6 +743,69 @@ TEST_FUNCTION(IoTHubMessaging_SetFeedbackMessageCallback_Lock_fails)
     free(messagingClientHandle);
 }
 
+/*Tests_SRS_IOTHUBMESSAGING_02_041: [ If messagingClientHandle is NULL, IoTHubMessaging_SetFeedbackRecordCallback shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubMessaging_SetFeedbackRecordCallback_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingClientHandle_is_NULL)
+{
+    ///arrange
+
+    ///act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SetFeedbackRecordCallback(NULL, TEST_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, (void*)0x4242);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_042: [ IoTHubMessaging_SetFeedbackRecordCallback shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_044: [ IoTHubMessaging_SetFeedbackRecordCallback shall call IoTHubMessaging_LL_SetFeedbackRecordCallback and return its result. ]*/
+TEST_FUNCTION(IoTHubMessaging_SetFeedbackRecordCallback_happy_path)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_SetFeedbackRecordCallback((IOTHUB_MESSAGING_HANDLE)0X3333, TEST_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, (void*)0x4242));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SetFeedbackRecordCallback(messagingClientHandle, TEST_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_043: [ If acquiring the lock fails, IoTHubMessaging_SetFeedbackRecordCallback shall return IOTHUB_MESSAGING_ERROR. ]*/
+TEST_FUNCTION(IoTHubMessaging_SetFeedbackRecordCallback_Lock_fails)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(LOCK_ERROR);
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SetFeedbackRecordCallback(messagingClientHandle, TEST_IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
 /*Tests_SRS_IOTHUBMESSAGING_12_033: [ If messagingClientHandle is NULL, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
 TEST_FUNCTION(IoTHubMessaging_SendAsync_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingClientHandle_is_NULL)
 {
@@ -624,10 +818,9 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_return_IOTHUB_MESSAGING_INVALID_ARG_if_i
     ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
 }
 
-/*Tests_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_SendAsync shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_SendAsync shall be made thread-safe by using the lock that guards the queue of sends, it shall not wait for the lock held by the worker thread around IoTHubMessaging_LL_DoWork. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_036: [ IoTHubMessaging_SendAsync shall start the worker thread if it was not previously started. ]*/
-/*Tests_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_SendAsync shall call IoTHubMessaging_LL_Send, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubClient_Create and the parameters deviceId, message, sendCompleteCallback and userContextCallback.*/
-/*Tests_SRS_IOTHUBMESSAGING_12_039: [ When IoTHubMessaging_LL_Send is called, IoTHubMessaging_SendAsync shall return the result of IoTHubMessaging_LL_Send. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_SendAsync shall queue a copy of deviceId and a clone of message, made by IoTHubMessage_Clone, together with sendCompleteCallback and userContextCallback for the worker thread. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_040: [ IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create. ]*/
 TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path)
 {
@@ -637,6 +830,7 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path)
     IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
     TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
     messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+    messagingClientInstance->IsOpened = 1;
 
     umock_c_reset_all_calls();
 
@@ -645,6 +839,8 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path)
 
     STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_IOTHUB_MESSAGE_HANDLE));
 
     /* If modules are re-enabled, re-enable this code and add testing_module paramater to this function
     if (testing_module == true)
@@ -653,7 +849,7 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path)
     }
     */
 
-    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Send((IOTHUB_MESSAGING_HANDLE)0X3333, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242));
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
 
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -672,17 +868,16 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path)
     // assert
     ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(messagingClientInstance->PendingSendsHead);
+    ASSERT_ARE_EQUAL(size_t, 1, messagingClientInstance->QueuedSendCount);
 
     // cleanup
-    free(messagingClientHandle);
-
-
+    IoTHubMessaging_Destroy(messagingClientHandle);
 }
 
-/*Tests_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_SendAsync shall be made thread-safe by using the lock created in IoTHubMessaging_Create. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_SendAsync shall be made thread-safe by using the lock that guards the queue of sends, it shall not wait for the lock held by the worker thread around IoTHubMessaging_LL_DoWork. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_036: [ IoTHubMessaging_SendAsync shall start the worker thread if it was not previously started. ]*/
-/*Tests_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_SendAsync shall call IoTHubMessaging_LL_Send, while passing the IOTHUB_MESSAGING_HANDLE handle created by IoTHubClient_Create and the parameters deviceId, message, sendCompleteCallback and userContextCallback.*/
-/*Tests_SRS_IOTHUBMESSAGING_12_039: [ When IoTHubMessaging_LL_Send is called, IoTHubMessaging_SendAsync shall return the result of IoTHubMessaging_LL_Send. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_SendAsync shall queue a copy of deviceId and a clone of message, made by IoTHubMessage_Clone, together with sendCompleteCallback and userContextCallback for the worker thread. ]*/
 /*Tests_SRS_IOTHUBMESSAGING_12_040: [ IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create. ]*/
 TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path_threadhandle_not_null)
 {
@@ -693,11 +888,14 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path_threadhandle_not_null)
     TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
     messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
     messagingClientInstance->ThreadHandle = (IOTHUB_MESSAGING_HANDLE)0x4444;
+    messagingClientInstance->IsOpened = 1;
 
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_IOTHUB_MESSAGE_HANDLE));
 
     /* If modules are re-enabled, re-enable this code and add testing_module paramater to this function
     if (testing_module)
@@ -705,7 +903,7 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path_threadhandle_not_null)
         STRICT_EXPECTED_CALL(IoTHubMessaging_LL_SendModule((IOTHUB_MESSAGING_HANDLE)0X3333, deviceId, TEST_MODULE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242));
     }
     */
-    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Send((IOTHUB_MESSAGING_HANDLE)0X3333, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242));
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
 
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -723,9 +921,11 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_happy_path_threadhandle_not_null)
     // assert
     ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(messagingClientInstance->PendingSendsHead);
+    ASSERT_ARE_EQUAL(size_t, 1, messagingClientInstance->QueuedSendCount);
 
     // cleanup
-    free(messagingClientHandle);
+    IoTHubMessaging_Destroy(messagingClientHandle);
 }
 
 /*Tests_SRS_IOTHUBMESSAGING_12_035: [ If acquiring the lock fails, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
@@ -762,6 +962,318 @@ TEST_FUNCTION(IoTHubMessaging_SendAsync_Lock_fails)
     free(messagingClientHandle);
 }
 
+/*Tests_SRS_IOTHUBMESSAGING_02_050: [ If deviceId or message is NULL, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_with_NULL_deviceId_fails)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, NULL, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_050: [ If deviceId or message is NULL, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_with_NULL_message_fails)
+{
+    // arrange
+    const char* deviceId = "42";
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, NULL, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_12_039: [ If queuing the send fails, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_malloc_fails)
+{
+    // arrange
+    const char* deviceId = "42";
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IsOpened = 1;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_12_039: [ If queuing the send fails, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_IoTHubMessage_Clone_fails)
+{
+    // arrange
+    const char* deviceId = "42";
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IsOpened = 1;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_059: [ If IoTHubMessaging_Open has not succeeded since the client was created or closed, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR without queuing the send. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_when_not_open_fails)
+{
+    // arrange
+    const char* deviceId = "42";
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(messagingClientInstance->PendingSendsHead);
+    ASSERT_ARE_EQUAL(size_t, 0, messagingClientInstance->QueuedSendCount);
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_060: [ If maxInFlightSends is not 0 and the sends already queued plus the sends in flight reach it, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR without queuing the send. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_when_queued_and_in_flight_sends_reach_the_limit_fails)
+{
+    // arrange
+    const char* deviceId = "42";
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IsOpened = 1;
+    messagingClientInstance->MaxInFlightSends = 2;
+    messagingClientInstance->QueuedSendCount = 1;
+    messagingClientInstance->InFlightSendCount = 1;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(messagingClientInstance->PendingSendsHead);
+    ASSERT_ARE_EQUAL(size_t, 1, messagingClientInstance->QueuedSendCount);
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_060: [ If maxInFlightSends is not 0 and the sends already queued plus the sends in flight reach it, IoTHubMessaging_SendAsync shall return IOTHUB_MESSAGING_ERROR without queuing the send. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendAsync_below_the_limit_queues_the_send)
+{
+    // arrange
+    const char* deviceId = "42";
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->ThreadHandle = (THREAD_HANDLE)0x4444;
+    messagingClientInstance->IsOpened = 1;
+    messagingClientInstance->MaxInFlightSends = 2;
+    messagingClientInstance->InFlightSendCount = 1;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_IOTHUB_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, messagingClientInstance->QueuedSendCount);
+
+    // cleanup
+    IoTHubMessaging_Destroy(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_051: [ The worker thread shall pass every queued send, in the order they were queued, to IoTHubMessaging_LL_Send. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_061: [ After IoTHubMessaging_LL_DoWork the worker thread shall record, under the lock that guards the queue of sends, the count returned by IoTHubMessaging_LL_GetInFlightSendCount for IoTHubMessaging_SendAsync. ]*/
+TEST_FUNCTION(IoTHubMessaging_worker_thread_records_the_in_flight_count_for_SendAsync)
+{
+    // arrange
+    const char* deviceId = "42";
+    size_t inFlightSendCount = 5;
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+    messagingClientInstance->IsOpened = 1;
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, IoTHubMessaging_SendAsync(messagingClientHandle, deviceId, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242));
+    ASSERT_IS_NOT_NULL(g_workerThreadFunc);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_Send((IOTHUB_MESSAGING_HANDLE)0X3333, deviceId, TEST_IOTHUB_MESSAGE_CLONE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)0x4242));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(TEST_IOTHUB_MESSAGE_CLONE_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_DoWork((IOTHUB_MESSAGING_HANDLE)0X3333));
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_GetInFlightSendCount((IOTHUB_MESSAGING_HANDLE)0X3333, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_inFlightSendCount(&inFlightSendCount, sizeof(inFlightSendCount));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Exit(0));
+
+    // act
+    (void)g_workerThreadFunc(g_workerThreadArg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(messagingClientInstance->PendingSendsHead);
+    ASSERT_ARE_EQUAL(size_t, 0, messagingClientInstance->QueuedSendCount);
+    ASSERT_ARE_EQUAL(size_t, 5, messagingClientInstance->InFlightSendCount);
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_030: [ If messagingClientHandle is NULL, IoTHubMessaging_SendBatchAsync shall return IOTHUB_MESSAGING_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendBatchAsync_with_NULL_messagingClientHandle_fails)
+{
+    ///arrange
+    const char* deviceIds[] = { "42", "43" };
+
+    ///act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendBatchAsync(NULL, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, NULL, (void*)0x4242);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_031: [ IoTHubMessaging_SendBatchAsync shall acquire the lock created in IoTHubMessaging_Create once for the whole batch. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_033: [ IoTHubMessaging_SendBatchAsync shall start the worker thread if it was not previously started. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_057: [ IoTHubMessaging_SendBatchAsync shall signal the condition so that a waiting worker thread services the batch as soon as it is queued. ]*/
+/*Tests_SRS_IOTHUBMESSAGING_02_035: [ IoTHubMessaging_SendBatchAsync shall call IoTHubMessaging_LL_SendBatch with all its parameters and return its result. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendBatchAsync_happy_path)
+{
+    // arrange
+    const char* deviceIds[] = { "42", "43" };
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_SendBatch((IOTHUB_MESSAGING_HANDLE)0X3333, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, NULL, (void*)0x4242));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendBatchAsync(messagingClientHandle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, NULL, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_032: [ If acquiring the lock fails, IoTHubMessaging_SendBatchAsync shall return IOTHUB_MESSAGING_ERROR. ]*/
+TEST_FUNCTION(IoTHubMessaging_SendBatchAsync_Lock_fails)
+{
+    // arrange
+    const char* deviceIds[] = { "42", "43" };
+
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
+    messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .SetReturn(LOCK_ERROR);
+
+    // act
+    IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_SendBatchAsync(messagingClientHandle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, NULL, (void*)0x4242);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    free(messagingClientHandle);
+}
+
 
 /*Tests_SRS_IOTHUBMESSAGING_12_037: [ If starting the thread fails, IoTHubMessaging_SendAsync shall return IOTHUB_CLIENT_ERROR. ]*/
 TEST_FUNCTION(IoTHubMessaging_ThreadAPI_Create_fails)
@@ -772,6 +1284,7 @@ TEST_FUNCTION(IoTHubMessaging_ThreadAPI_Create_fails)
     IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
     TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE* messagingClientInstance = (TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle;
     messagingClientInstance->IoTHubMessagingHandle = (IOTHUB_MESSAGING_HANDLE)0X3333;
+    messagingClientInstance->IsOpened = 1;
 
     umock_c_reset_all_calls();
 
@@ -842,6 +1355,91 @@ TEST_FUNCTION(IoTHubMessaging_SendAsyncModule_Lock_fails)
     IoTHubMessaging_SendAsync_Lock_fails(true);
 }
 */
+TEST_FUNCTION(IoTHubMessaging_SetMaxInFlightSends_handle_NULL_fail)
+{
+    // arrange
+
+    // act
+    IOTHUB_MESSAGING_RESULT result;
+    result = IoTHubMessaging_SetMaxInFlightSends(NULL, 10);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_062: [ IoTHubMessaging_SetMaxInFlightSends shall also acquire the lock that guards the queue of sends, call IoTHubMessaging_LL_SetMaxInFlightSends and, if it succeeds, keep maxInFlightSends for IoTHubMessaging_SendAsync. ]*/
+TEST_FUNCTION(IoTHubMessaging_SetMaxInFlightSends_success)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessaging_LL_SetMaxInFlightSends(IGNORED_PTR_ARG, 10));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result;
+    result = IoTHubMessaging_SetMaxInFlightSends(messagingClientHandle, 10);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 10, ((TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle)->MaxInFlightSends);
+
+    // cleanup
+    IoTHubMessaging_Destroy(messagingClientHandle);
+}
+
+TEST_FUNCTION(IoTHubMessaging_SetMaxInFlightSends_Lock_fails)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)).SetReturn(LOCK_ERROR);
+
+    // act
+    IOTHUB_MESSAGING_RESULT result;
+    result = IoTHubMessaging_SetMaxInFlightSends(messagingClientHandle, 10);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubMessaging_Destroy(messagingClientHandle);
+}
+
+/*Tests_SRS_IOTHUBMESSAGING_02_062: [ IoTHubMessaging_SetMaxInFlightSends shall also acquire the lock that guards the queue of sends, call IoTHubMessaging_LL_SetMaxInFlightSends and, if it succeeds, keep maxInFlightSends for IoTHubMessaging_SendAsync. ]*/
+TEST_FUNCTION(IoTHubMessaging_SetMaxInFlightSends_second_Lock_fails)
+{
+    // arrange
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClientHandle = IoTHubMessaging_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)).SetReturn(LOCK_ERROR);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_MESSAGING_RESULT result;
+    result = IoTHubMessaging_SetMaxInFlightSends(messagingClientHandle, 10);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, ((TEST_IOTHUB_MESSAGING_CLIENT_INSTANCE*)messagingClientHandle)->MaxInFlightSends);
+
+    // cleanup
+    IoTHubMessaging_Destroy(messagingClientHandle);
+}
+
 TEST_FUNCTION(IoTHubMessaging_SetTrustedCert_handle_NULL_fail)
 {
     // arrange
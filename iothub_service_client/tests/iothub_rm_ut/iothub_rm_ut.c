@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -18,9 +20,11 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/httpapiex.h"
-#include "azure_c_shared_utility/httpapiexsas.h"
+#include "iothub_sc_connection_pool.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
 #include "parson.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 
@@ -37,6 +41,7 @@ MOCKABLE_FUNCTION(, JSON_Value*, json_value_init_object);
 MOCKABLE_FUNCTION(, JSON_Array*, json_array_get_array, const JSON_Array*, array, size_t, index);
 MOCKABLE_FUNCTION(, JSON_Object*, json_array_get_object, const JSON_Array*, array, size_t, index);
 MOCKABLE_FUNCTION(, JSON_Array*, json_value_get_array, const JSON_Value*, value);
+MOCKABLE_FUNCTION(, JSON_Array*, json_object_get_array, const JSON_Object*, object, const char*, name);
 MOCKABLE_FUNCTION(, size_t, json_array_get_count, const JSON_Array*, array);
 MOCKABLE_FUNCTION(, JSON_Status, json_array_clear, JSON_Array*, array);
 MOCKABLE_FUNCTION(, JSON_Status, json_object_clear, JSON_Object*, object);
@@ -82,10 +87,15 @@ BUFFER_HANDLE my_BUFFER_new(void)
     return (BUFFER_HANDLE)malloc(1);
 }
 
+static char capturedRequestBody[1024];
+
 BUFFER_HANDLE my_BUFFER_create(const unsigned char* source, size_t size)
 {
-    (void)source;
-    (void)size;
+    if ((source != NULL) && (size < sizeof(capturedRequestBody)))
+    {
+        (void)memcpy(capturedRequestBody, source, size);
+        capturedRequestBody[size] = '\0';
+    }
     return (BUFFER_HANDLE)malloc(1);
 }
 
@@ -94,37 +104,63 @@ void my_BUFFER_delete(BUFFER_HANDLE handle)
     free(handle);
 }
 
-HTTPAPIEX_HANDLE my_HTTPAPIEX_Create(const char* hostName)
-{
-    (void)hostName;
-    return (HTTPAPIEX_HANDLE)malloc(1);
-}
+static int liveAllocationCount;
+static int peakLiveAllocationCount;
+
+static size_t syntheticPageCount;
+static size_t syntheticPagesServed;
+static size_t syntheticRecordsParsed;
+static size_t syntheticRecordsMatched;
+static unsigned int syntheticStatusCode;
+static HTTPAPIEX_RESULT syntheticExecuteResult;
+static const char* syntheticPageOverride;
+static char syntheticPage[4096];
 
-void my_HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
+static size_t enumeratedCount;
+static size_t enumerationStopAfter;
+
+static size_t threadCreateCount;
+static size_t threadJoinCount;
+
+/*worker threads are never started, the calling thread sends all the chunks*/
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
 {
-    free(handle);
+    (void)func;
+    (void)arg;
+    *threadHandle = (THREAD_HANDLE)0x4747;
+    threadCreateCount++;
+    return THREADAPI_OK;
 }
 
-HTTPAPIEX_SAS_HANDLE my_HTTPAPIEX_SAS_Create(STRING_HANDLE key, STRING_HANDLE uriResource, STRING_HANDLE keyName)
+static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int* res)
 {
-    (void)key;
-    (void)uriResource;
-    (void)keyName;
-    return (HTTPAPIEX_SAS_HANDLE)malloc(1);
+    (void)threadHandle;
+    *res = 0;
+    threadJoinCount++;
+    return THREADAPI_OK;
 }
 
-void my_HTTPAPIEX_SAS_Destroy(HTTPAPIEX_SAS_HANDLE handle)
+static void countAllocation(void)
 {
-    free(handle);
+    liveAllocationCount++;
+    if (liveAllocationCount > peakLiveAllocationCount)
+    {
+        peakLiveAllocationCount = liveAllocationCount;
+    }
 }
 
 static void* my_gballoc_malloc(size_t size)
 {
+    countAllocation();
     return malloc(size);
 }
 
 static void my_gballoc_free(void* ptr)
 {
+    if (ptr != NULL)
+    {
+        liveAllocationCount--;
+    }
     free(ptr);
 }
 
@@ -134,6 +170,7 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
     p[0] = source[0];
     p[1] = '\0';
     *destination = p;
+    countAllocation();
     return 0;
 }
 
@@ -436,7 +473,8 @@ static const unsigned int httpStatusCodeBadRequest = 400;
 static const unsigned int httpStatusCodeDeviceExists = 409;
 static const unsigned int httpStatusCodeDeviceNotExists = 404;
 static const HTTPAPIEX_HANDLE TEST_HTTPAPIEX_HANDLE = (HTTPAPIEX_HANDLE)0x4343;
-static HTTPAPIEX_SAS_HANDLE TEST_HTTPAPIEX_SAS_HANDLE = (HTTPAPIEX_SAS_HANDLE)0x4444;
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4444;
+static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4646;
 static const HTTP_HEADERS_HANDLE TEST_HTTP_HEADERS_HANDLE = (HTTP_HEADERS_HANDLE)0x4545;
 static const HTTP_HEADERS_RESULT TEST_HTTP_HEADERS_RESULT = (HTTP_HEADERS_RESULT)0x1;
 static HTTPAPIEX_RESULT TEST_HTTPAPIEX_RESULT = (HTTPAPIEX_RESULT)0x1;
@@ -600,10 +638,6 @@ static void setupHttpMockCalls(bool updateIfMatch, const unsigned int httpStatus
         STRICT_EXPECTED_CALL(BUFFER_new());
     }
 
-    STRICT_EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
-    STRICT_EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEY));
-    STRICT_EXPECTED_CALL(STRING_construct(TEST_SHAREDACCESSKEYNAME));
-
     STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
     STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
         .IgnoreArgument(1);
@@ -621,35 +655,18 @@ static void setupHttpMockCalls(bool updateIfMatch, const unsigned int httpStatus
             .IgnoreArgument(1);
     }
 
-    STRICT_EXPECTED_CALL(HTTPAPIEX_SAS_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
-
-    STRICT_EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, requestType, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(1)
-        .IgnoreArgument(2)
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, requestType, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(3)
         .IgnoreArgument(4)
         .IgnoreArgument(5)
         .IgnoreArgument(6)
         .IgnoreArgument(7)
         .IgnoreArgument(8)
-        .IgnoreArgument(9)
         .CopyOutArgumentBuffer_statusCode(&httpStatusCode, sizeof(httpStatusCode))
         .SetReturn(HTTPAPIEX_OK);
 
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPAPIEX_SAS_Destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
 }
 
 static void setupJsonParseDeviceMockCalls(bool fromDeviceList, IOTHUB_REGISTRYMANAGER_AUTH_METHOD authMethod, bool isModule, const char* managedBy)
@@ -821,6 +838,141 @@ static void setupJsonParseDeviceMockCalls(bool fromDeviceList, IOTHUB_REGISTRYMA
         .IgnoreArgument(1);
 }
 
+#define TEST_SYNTHETIC_PAGE_SIZE 10
+
+/*every synthetic record contains a nested object and braces inside a string, so the page scanner cannot take shortcuts*/
+static int formatSyntheticRecord(char* destination, size_t destinationSize, size_t recordIndex)
+{
+    return snprintf(destination, destinationSize, "{\"deviceId\":\"device%lu\",\"tags\":{\"note\":\"a } in a \\\"string\\\"\"},\"capabilities\":{\"iotEdge\":false}}", (unsigned long)recordIndex);
+}
+
+static HTTPAPIEX_RESULT my_IoTHubScConnectionPool_ExecuteRequest(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    HTTPAPIEX_RESULT result = HTTPAPIEX_OK;
+
+    (void)connectionPool;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHttpHeadersHandle;
+    (void)requestContent;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+
+    if (syntheticPageCount > 0)
+    {
+        if (syntheticPageOverride != NULL)
+        {
+            (void)snprintf(syntheticPage, sizeof(syntheticPage), "%s", syntheticPageOverride);
+        }
+        else
+        {
+            size_t length = 0;
+            size_t i;
+
+            syntheticPage[length++] = '[';
+            for (i = 0; i < TEST_SYNTHETIC_PAGE_SIZE; i++)
+            {
+                if (i > 0)
+                {
+                    syntheticPage[length++] = ',';
+                    syntheticPage[length++] = '\n';
+                }
+                length += formatSyntheticRecord(syntheticPage + length, sizeof(syntheticPage) - length, syntheticPagesServed * TEST_SYNTHETIC_PAGE_SIZE + i);
+            }
+            syntheticPage[length++] = ']';
+            syntheticPage[length] = '\0';
+        }
+        *statusCode = syntheticStatusCode;
+        syntheticPagesServed++;
+        result = syntheticExecuteResult;
+    }
+    return result;
+}
+
+static const char* my_HTTPHeaders_FindHeaderValue(HTTP_HEADERS_HANDLE httpHeadersHandle, const char* name)
+{
+    (void)httpHeadersHandle;
+    (void)name;
+    return ((syntheticPageCount > 0) && (syntheticPagesServed < syntheticPageCount)) ? "nextPage" : NULL;
+}
+
+static unsigned char* my_BUFFER_u_char(BUFFER_HANDLE handle)
+{
+    (void)handle;
+    return (syntheticPageCount > 0) ? (unsigned char*)syntheticPage : NULL;
+}
+
+static size_t my_BUFFER_length(BUFFER_HANDLE handle)
+{
+    (void)handle;
+    return (syntheticPageCount > 0) ? strlen(syntheticPage) : 0;
+}
+
+static JSON_Value* my_json_parse_string(const char* string)
+{
+    if ((syntheticPageCount > 0) && (syntheticPageOverride == NULL))
+    {
+        char expected[256];
+        (void)formatSyntheticRecord(expected, sizeof(expected), syntheticRecordsParsed);
+        if (strcmp(expected, string) == 0)
+        {
+            syntheticRecordsMatched++;
+        }
+        syntheticRecordsParsed++;
+    }
+    return TEST_JSON_VALUE;
+}
+
+/*serves pageCount pages of TEST_SYNTHETIC_PAGE_SIZE records through the hooks above*/
+static void startSyntheticPageServer(size_t pageCount)
+{
+    syntheticPageCount = pageCount;
+    syntheticPagesServed = 0;
+    syntheticRecordsParsed = 0;
+    syntheticRecordsMatched = 0;
+    syntheticStatusCode = httpStatusCodeOk;
+    syntheticExecuteResult = HTTPAPIEX_OK;
+    syntheticPageOverride = NULL;
+    enumeratedCount = 0;
+    enumerationStopAfter = 0;
+    liveAllocationCount = 0;
+    peakLiveAllocationCount = 0;
+}
+
+static void stopSyntheticPageServer(void)
+{
+    syntheticPageCount = 0;
+    syntheticPageOverride = NULL;
+}
+
+static int countingDeviceEnumCallback(void* context, const IOTHUB_DEVICE_EX* device)
+{
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x4242, context);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_EX_VERSION_1, device->version);
+    ASSERT_IS_NOT_NULL(device->deviceId);
+    enumeratedCount++;
+    return (enumeratedCount == enumerationStopAfter) ? 1 : 0;
+}
+
+static int countingModuleEnumCallback(void* context, const IOTHUB_MODULE* module)
+{
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x4242, context);
+    ASSERT_ARE_EQUAL(int, IOTHUB_MODULE_VERSION_1, module->version);
+    ASSERT_IS_NOT_NULL(module->deviceId);
+    enumeratedCount++;
+    return (enumeratedCount == enumerationStopAfter) ? 1 : 0;
+}
+
+static void setBulkDevice(IOTHUB_REGISTRY_BULK_DEVICE* device, const char* deviceId, IOTHUB_REGISTRY_BULK_MODE mode)
+{
+    memset(device, 0, sizeof(*device));
+    device->version = IOTHUB_REGISTRY_BULK_DEVICE_VERSION_1;
+    device->mode = mode;
+    device->deviceId = deviceId;
+    device->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_SPK;
+    device->status = IOTHUB_DEVICE_STATUS_ENABLED;
+}
+
 BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
     TEST_SUITE_INITIALIZE(TestClassInitialize)
@@ -846,13 +998,18 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_CONNECTION_POOL_HANDLE, void*);
 
         REGISTER_UMOCK_ALIAS_TYPE(JSON_Value, void*);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_Object, void*);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_Status, int);
         REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -904,18 +1061,11 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_ERROR);
 
-        REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
-
-        REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Destroy, my_HTTPAPIEX_Destroy);
-
-        REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Create, my_HTTPAPIEX_SAS_Create);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_Create, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_Clone, TEST_CONNECTION_POOL_HANDLE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_Clone, NULL);
 
-        REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Destroy, my_HTTPAPIEX_SAS_Destroy);
-
-        REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_OK);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SAS_ExecuteRequest, HTTPAPIEX_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_OK);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_ERROR);
 
         REGISTER_GLOBAL_MOCK_RETURN(json_value_init_object, TEST_JSON_VALUE);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_init_object, NULL);
@@ -964,6 +1114,24 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
         REGISTER_GLOBAL_MOCK_RETURN(json_object_dotget_boolean, JSONSuccess);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_dotget_boolean, -1);
+
+        REGISTER_GLOBAL_MOCK_HOOK(IoTHubScConnectionPool_ExecuteRequest, my_IoTHubScConnectionPool_ExecuteRequest);
+        REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_FindHeaderValue, my_HTTPHeaders_FindHeaderValue);
+        REGISTER_GLOBAL_MOCK_HOOK(BUFFER_u_char, my_BUFFER_u_char);
+        REGISTER_GLOBAL_MOCK_HOOK(BUFFER_length, my_BUFFER_length);
+        REGISTER_GLOBAL_MOCK_HOOK(json_parse_string, my_json_parse_string);
+
+        REGISTER_GLOBAL_MOCK_RETURN(json_object_get_array, TEST_JSON_ARRAY);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_array, NULL);
+
+        REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+        REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+        REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+        REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+        REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
     }
 
     TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -987,12 +1155,14 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         TEST_IOTHUB_SERVICE_CLIENT_AUTH.iothubSuffix = TEST_IOTHUBSUFFIX;
         TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
         TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
+        TEST_IOTHUB_SERVICE_CLIENT_AUTH.connectionPool = TEST_CONNECTION_POOL_HANDLE;
 
         TEST_IOTHUB_REGISTRYMANAGER.hostname = TEST_HOSTNAME;
         TEST_IOTHUB_REGISTRYMANAGER.iothubName = TEST_IOTHUBNAME;
         TEST_IOTHUB_REGISTRYMANAGER.iothubSuffix = TEST_IOTHUBSUFFIX;
         TEST_IOTHUB_REGISTRYMANAGER.keyName = TEST_SHAREDACCESSKEYNAME;
         TEST_IOTHUB_REGISTRYMANAGER.sharedAccessKey = TEST_SHAREDACCESSKEY;
+        TEST_IOTHUB_REGISTRYMANAGER.connectionPool = TEST_CONNECTION_POOL_HANDLE;
 
         TEST_IOTHUB_REGISTRY_DEVICE_CREATE.deviceId = TEST_DEVICE_ID;
         TEST_IOTHUB_REGISTRY_DEVICE_CREATE.primaryKey = TEST_PRIMARYKEY;
@@ -1149,6 +1319,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_089: [ IoTHubRegistryManager_Create shall allocate memory and copy iothubSuffix to result->iothubSuffix by calling mallocAndStrcpy_s. ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_091: [ IoTHubRegistryManager_Create shall allocate memory and copy sharedAccessKey to result->sharedAccessKey by calling mallocAndStrcpy_s. ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_093: [ IoTHubRegistryManager_Create shall allocate memory and copy keyName to result->keyName by calling mallocAndStrcpy_s. ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_02_001: [ IoTHubRegistryManager_Create shall take a reference to the connection pool of the service client auth handle by calling IoTHubScConnectionPool_Clone. ]*/
     TEST_FUNCTION(IoTHubRegistryManager_Create_happy_path)
     {
         // arrange
@@ -1170,12 +1341,15 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreAllArguments();
 
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
+
         // act
         IOTHUB_REGISTRYMANAGER_HANDLE result = IoTHubRegistryManager_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
 
         // assert
         ASSERT_IS_NOT_NULL(result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, TEST_CONNECTION_POOL_HANDLE, result->connectionPool);
 
         ///cleanup
         if (result != NULL)
@@ -1196,6 +1370,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_090: [ If the mallocAndStrcpy_s fails, IoTHubRegistryManager_Create shall do clean up and return NULL. ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_092: [ If the mallocAndStrcpy_s fails, IoTHubRegistryManager_Create shall do clean up and return NULL. ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_094: [ If the mallocAndStrcpy_s fails, IoTHubRegistryManager_Create shall do clean up and return NULL. ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_02_002: [ If IoTHubScConnectionPool_Clone fails, IoTHubRegistryManager_Create shall do clean up and return NULL. ]*/
     TEST_FUNCTION(IoTHubRegistryManager_Create_non_happy_path)
     {
         // arrange
@@ -1220,6 +1395,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, (const char*)(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE->keyName)))
             .IgnoreArgument(1);
 
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Clone(TEST_CONNECTION_POOL_HANDLE));
 
         umock_c_negative_tests_snapshot();
 
@@ -1254,6 +1430,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     }
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_006 : [ If the registryManagerHandle input parameter is not NULL IoTHubRegistryManager_Destroy shall free the memory of it and return ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_02_003: [ IoTHubRegistryManager_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. ] */
     TEST_FUNCTION(IoTHubRegistryManager_Destroy_do_clean_up_and_return_if_input_parameter_registryManagerHandle_is_not_NULL)
     {
         // arrange
@@ -1273,6 +1450,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_Destroy(TEST_CONNECTION_POOL_HANDLE));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
 
@@ -2295,15 +2473,10 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
             if (
                 (i != 11) && /*json_free_serialized_string*/
                 (i != 13) && /*json_value_free*/
-                (i != 27) && /*HTTPHeaders_Free*/
-                (i != 28) && /*HTTPAPIEX_Destroy*/
-                (i != 29) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 30) && /*STRING_delete*/
-                (i != 31) && /*STRING_delete*/
-                (i != 32) && /*STRING_delete*/
-                (i != 33) && /*BUFFER_delete*/
-                (i != 34) && /*BUFFER_delete*/
-                (i != 35) /*gballoc_free*/
+                (i != 22) && /*HTTPHeaders_Free*/
+                (i != 23) && /*BUFFER_delete*/
+                (i != 24) && /*BUFFER_delete*/
+                (i != 25) /*gballoc_free*/
                 )
             {
                 IOTHUB_DEVICE deviceInfo;
@@ -2376,15 +2549,10 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
             if (
                 (i != 11) && /*json_free_serialized_string*/
                 (i != 13) && /*json_value_free*/
-                (i != 27) && /*HTTPHeaders_Free*/
-                (i != 28) && /*HTTPAPIEX_Destroy*/
-                (i != 29) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 30) && /*STRING_delete*/
-                (i != 31) && /*STRING_delete*/
-                (i != 32) && /*STRING_delete*/
-                (i != 33) && /*BUFFER_delete*/
-                (i != 34) && /*BUFFER_delete*/
-                (i != 35) /*gballoc_free*/
+                (i != 22) && /*HTTPHeaders_Free*/
+                (i != 23) && /*BUFFER_delete*/
+                (i != 24) && /*BUFFER_delete*/
+                (i != 25) /*gballoc_free*/
                 )
             {
                 IOTHUB_DEVICE_EX deviceInfo;
@@ -2557,9 +2725,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_026: [ IoTHubRegistryManager_GetDevice shall create HTTP GET request URL using the given deviceId using the following format: url/devices/[deviceId]?api-version=2017-06-30  ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_027: [ IoTHubRegistryManager_GetDevice shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_028: [ IoTHubRegistryManager_GetDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_029: [ IoTHubRegistryManager_GetDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_030: [ IoTHubRegistryManager_GetDevice shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_028: [ IoTHubRegistryManager_GetDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_029: [ IoTHubRegistryManager_GetDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_030: [ IoTHubRegistryManager_GetDevice shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_06_008: [ IoTHubRegistryManager_GetDevice shall, if json was found for authorization.symetricKey.primaryKey, set the device info authMethod to "IOTHUB_REGISTRYMANAGER_AUTH_SPK" ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_06_012: [ IoTHubRegistryManager_GetDevice shall, if json was found for authorization.x509Thumbprint.secondaryThumbprint, set the device info authMethod to "IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT" ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_06_010: [ IoTHubRegistryManager_GetDevice shall, if json was found for authorization.symetricKey.secondaryKey, set the device info authMethod to "IOTHUB_REGISTRYMANAGER_AUTH_SPK" ] */
@@ -2736,34 +2904,29 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
             umock_c_negative_tests_fail_call(i);
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) && /*STRING_delete*/
-                (i != 19) && /*BUFFER_u_char*/
+                (i != 8) && /*HTTPHeaders_Free*/
+                (i != 9) && /*BUFFER_u_char*/
+                (i != 13) && /*json_object_get_string*/
+                (i != 14) && /*json_object_get_string*/
+                (i != 15) && /*json_object_dotget_string*/
+                (i != 16) && /*json_object_dotget_string*/
+                (i != 17) && /*json_object_get_string*/
+                (i != 18) && /*json_object_get_string*/
+                (i != 19) && /*json_object_get_string*/
+                (i != 20) && /*json_object_get_string*/
+                (i != 21) && /*json_object_get_string*/
+                (i != 22) && /*json_object_get_string*/
                 (i != 23) && /*json_object_get_string*/
                 (i != 24) && /*json_object_get_string*/
-                (i != 25) && /*json_object_dotget_string*/
-                (i != 26) && /*json_object_dotget_string*/
+                (i != 25) && /*json_object_get_string*/
+                (i != 26) && /*json_object_get_string*/
                 (i != 27) && /*json_object_get_string*/
                 (i != 28) && /*json_object_get_string*/
                 (i != 29) && /*json_object_get_string*/
                 (i != 30) && /*json_object_get_string*/
                 (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_get_string*/
-                (i != 41) && /*json_object_get_string*/
-                (i != 55) && /*json_value_free*/
-                (i != 56) /*BUFFER_delete*/
+                (i != 45) && /*json_value_free*/
+                (i != 46) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDevice(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID, deviceInfo);
@@ -2809,35 +2972,30 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
             umock_c_negative_tests_fail_call(i);
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) && /*STRING_delete*/
-                (i != 19) && /*BUFFER_u_char*/
+                (i != 8) && /*HTTPHeaders_Free*/
+                (i != 9) && /*BUFFER_u_char*/
+                (i != 13) && /*json_object_get_string*/
+                (i != 14) && /*json_object_get_string*/
+                (i != 15) && /*json_object_dotget_string*/
+                (i != 16) && /*json_object_dotget_string*/
+                (i != 17) && /*json_object_get_string*/
+                (i != 18) && /*json_object_get_string*/
+                (i != 19) && /*json_object_get_string*/
+                (i != 20) && /*json_object_get_string*/
+                (i != 21) && /*json_object_get_string*/
+                (i != 22) && /*json_object_get_string*/
                 (i != 23) && /*json_object_get_string*/
                 (i != 24) && /*json_object_get_string*/
-                (i != 25) && /*json_object_dotget_string*/
-                (i != 26) && /*json_object_dotget_string*/
+                (i != 25) && /*json_object_get_string*/
+                (i != 26) && /*json_object_get_string*/
                 (i != 27) && /*json_object_get_string*/
                 (i != 28) && /*json_object_get_string*/
                 (i != 29) && /*json_object_get_string*/
                 (i != 30) && /*json_object_get_string*/
                 (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_get_string*/
-                (i != 41) && /*json_object_get_string*/
-                (i != 54) && /*json_object_clear*/
-                (i != 55) && /*json_value_free*/
-                (i != 56) /*BUFFER_delete*/
+                (i != 44) && /*json_object_clear*/
+                (i != 45) && /*json_value_free*/
+                (i != 46) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDevice_Ex(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID, deviceInfo);
@@ -3127,9 +3285,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_101: [ IoTHubRegistryManager_UpdateDevice shall allocate memory for response buffer by calling BUFFER_new ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_043: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the created JSON ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_044: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the createdfollowing HTTP headers : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling HTTPAPIEX_ExecuteRequest ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling IoTHubScConnectionPool_ExecuteRequest ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_105: [ IoTHubRegistryManager_UpdateDevice shall do clean up before return ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_118: [ IoTHubRegistryManager_CreateDevice shall set the "status" value to the deviceCreateInfo->status ] */
     TEST_FUNCTION(IoTHubRegistryManager_UpdateDevice_happy_path_with_sas_token)
@@ -3179,9 +3337,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_101: [ IoTHubRegistryManager_UpdateDevice shall allocate memory for response buffer by calling BUFFER_new ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_043: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the created JSON ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_044: [ IoTHubRegistryManager_UpdateDevice shall create an HTTP PUT request using the createdfollowing HTTP headers : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling HTTPAPIEX_ExecuteRequest ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_045: [ IoTHubRegistryManager_UpdateDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_046: [ IoTHubRegistryManager_UpdateDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_047: [ IoTHubRegistryManager_UpdateDevice shall execute the HTTP PUT request by calling IoTHubScConnectionPool_ExecuteRequest ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_105: [ IoTHubRegistryManager_UpdateDevice shall do clean up before return ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_118: [ IoTHubRegistryManager_CreateDevice shall set the "status" value to the deviceCreateInfo->status ] */
     TEST_FUNCTION(IoTHubRegistryManager_UpdateDevice_happy_path_with_thumbprint)
@@ -3376,15 +3534,10 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
                 (i != 10) && /*json_free_serialized_string*/
                 (i != 11) && /*json_object_clear*/
                 (i != 13) && /*json_value_free*/
-                (i != 28) && /*HTTPHeaders_Free*/
-                (i != 29) && /*HTTPAPIEX_Destroy*/
-                (i != 30) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 31) && /*STRING_delete*/
-                (i != 32) && /*STRING_delete*/
-                (i != 33) && /*STRING_delete*/
-                (i != 34) && /*BUFFER_delete*/
-                (i != 35) && /*BUFFER_delete*/
-                (i != 36) /*gballoc_free*/
+                (i != 23) && /*HTTPHeaders_Free*/
+                (i != 24) && /*BUFFER_delete*/
+                (i != 25) && /*BUFFER_delete*/
+                (i != 26) /*gballoc_free*/
                 )
             {
                 printf("i is = %zu\n", i);
@@ -3457,15 +3610,10 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
                 (i != 10) && /*json_free_serialized_string*/
                 (i != 11) && /*json_object_clear*/
                 (i != 13) && /*json_value_free*/
-                (i != 28) && /*HTTPHeaders_Free*/
-                (i != 29) && /*HTTPAPIEX_Destroy*/
-                (i != 30) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 31) && /*STRING_delete*/
-                (i != 32) && /*STRING_delete*/
-                (i != 33) && /*STRING_delete*/
-                (i != 34) && /*BUFFER_delete*/
-                (i != 35) && /*BUFFER_delete*/
-                (i != 36) /*gballoc_free*/
+                (i != 23) && /*HTTPHeaders_Free*/
+                (i != 24) && /*BUFFER_delete*/
+                (i != 25) && /*BUFFER_delete*/
+                (i != 26) /*gballoc_free*/
                 )
             {
                 printf("i is = %zu\n", i);
@@ -3547,9 +3695,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_053: [ IoTHubRegistryManager_DeleteDevice shall create HTTP DELETE request URL using the given deviceId using the following format : url / devices / [deviceId] ? api - version  ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_054: [ IoTHubRegistryManager_DeleteDevice shall add the following headers to the created HTTP GET request : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_058: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_059: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is less or equal than 300 then return IOTHUB_REGISTRYMANAGER_OK ] */
     TEST_FUNCTION(IoTHubRegistryManager_DeleteModule_happy_path)
@@ -3568,9 +3716,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_053: [ IoTHubRegistryManager_DeleteDevice shall create HTTP DELETE request URL using the given deviceId using the following format : url / devices / [deviceId] ? api - version  ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_054: [ IoTHubRegistryManager_DeleteDevice shall add the following headers to the created HTTP GET request : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_058: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_059: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is less or equal than 300 then return IOTHUB_REGISTRYMANAGER_OK ] */
     TEST_FUNCTION(IoTHubRegistryManager_DeleteDevice_happy_path)
@@ -3588,9 +3736,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_053: [ IoTHubRegistryManager_DeleteDevice shall create HTTP DELETE request URL using the given deviceId using the following format : url / devices / [deviceId] ? api - version  ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_054: [ IoTHubRegistryManager_DeleteDevice shall add the following headers to the created HTTP GET request : authorization = sasToken, Request - Id = 1001, Accept = application / json, Content - Type = application / json, charset = utf - 8 ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ] */
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling HTTPAPIEX_ExecuteRequest ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_055: [ IoTHubRegistryManager_DeleteDevice shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_056: [ IoTHubRegistryManager_DeleteDevice shall get a connection from the IoTHubScConnectionPool of the service client auth handle ] */
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_057: [ IoTHubRegistryManager_DeleteDevice shall execute the HTTP DELETE request by calling IoTHubScConnectionPool_ExecuteRequest ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_058: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR ] */
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_059: [ IoTHubRegistryManager_DeleteDevice shall verify the received HTTP status code and if it is less or equal than 300 then return IOTHUB_REGISTRYMANAGER_OK ] */
     TEST_FUNCTION(IoTHubRegistryManager_DeleteDevice_non_happy_path)
@@ -3612,12 +3760,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) /*STRING_delete*/
+                (i != 8) /*HTTPHeaders_Free*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_DeleteDevice(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID);
@@ -3791,9 +3934,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_062: [ IoTHubRegistryManager_GetDeviceList shall create HTTP GET request for numberOfDevices using the follwoing format: url/devices/?top=[numberOfDevices]&api-version ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_063: [ IoTHubRegistryManager_GetDeviceList shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_064: [ IoTHubRegistryManager_GetDeviceList shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_065: [ IoTHubRegistryManager_GetDeviceList shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_066: [ IoTHubRegistryManager_GetDeviceList shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_064: [ IoTHubRegistryManager_GetDeviceList shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_065: [ IoTHubRegistryManager_GetDeviceList shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_066: [ IoTHubRegistryManager_GetDeviceList shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_067: [ IoTHubRegistryManager_GetDeviceList shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_068: [ IoTHubRegistryManager_GetDeviceList shall verify the received HTTP status code and if it is less or equal than 300 then try to parse the response JSON to deviceList ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_069: [ IoTHubRegistryManager_GetDeviceList shall use the following parson APIs to parse the response JSON: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ]*/
@@ -3883,39 +4026,34 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_array_get_count*/
+                (i != 8) && /*HTTPHeaders_Free*/
+                (i != 12) && /*json_array_get_count*/
+                (i != 14) && /*json_object_get_string*/
+                (i != 15) && /*json_object_get_string*/
+                (i != 16) && /*json_object_dotget_string*/
+                (i != 17) && /*json_object_get_string*/
+                (i != 18) && /*json_object_get_string*/
+                (i != 19) && /*json_object_get_string*/
+                (i != 20) && /*json_object_get_string*/
+                (i != 21) && /*json_object_get_string*/
+                (i != 22) && /*json_object_get_string*/
+                (i != 23) && /*json_object_get_string*/
                 (i != 24) && /*json_object_get_string*/
                 (i != 25) && /*json_object_get_string*/
-                (i != 26) && /*json_object_dotget_string*/
+                (i != 26) && /*json_object_get_string*/
                 (i != 27) && /*json_object_get_string*/
                 (i != 28) && /*json_object_get_string*/
                 (i != 29) && /*json_object_get_string*/
-                (i != 30) && /*json_object_get_string*/
-                (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_dotget_string*/
-                (i != 41) && /*json_object_dotget_string*/
-                (i != 42) && /*json_object_dotget_string*/
-                (i != 43) && /*json_object_dotget_boolean*/
-                (i != 58) && /*free*/
-                (i != 59) && /*free*/
-                (i != 60) && /*json_object_clear*/
-                (i != 61) && /*json_array_clear*/
-                (i != 62) && /*json_value_free*/
-                (i != 63) /*BUFFER_delete*/
+                (i != 30) && /*json_object_dotget_string*/
+                (i != 31) && /*json_object_dotget_string*/
+                (i != 32) && /*json_object_dotget_string*/
+                (i != 33) && /*json_object_dotget_boolean*/
+                (i != 48) && /*free*/
+                (i != 49) && /*free*/
+                (i != 50) && /*json_object_clear*/
+                (i != 51) && /*json_array_clear*/
+                (i != 52) && /*json_value_free*/
+                (i != 53) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
@@ -3962,35 +4100,30 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_array_get_count*/
+                (i != 8) && /*HTTPHeaders_Free*/
+                (i != 12) && /*json_array_get_count*/
+                (i != 14) && /*json_object_get_string*/
+                (i != 15) && /*json_object_get_string*/
+                (i != 16) && /*json_object_dotget_string*/
+                (i != 17) && /*json_object_get_string*/
+                (i != 18) && /*json_object_get_string*/
+                (i != 19) && /*json_object_get_string*/
+                (i != 20) && /*json_object_get_string*/
+                (i != 21) && /*json_object_get_string*/
+                (i != 22) && /*json_object_get_string*/
+                (i != 23) && /*json_object_get_string*/
                 (i != 24) && /*json_object_get_string*/
                 (i != 25) && /*json_object_get_string*/
-                (i != 26) && /*json_object_dotget_string*/
+                (i != 26) && /*json_object_get_string*/
                 (i != 27) && /*json_object_get_string*/
                 (i != 28) && /*json_object_get_string*/
                 (i != 29) && /*json_object_get_string*/
-                (i != 30) && /*json_object_get_string*/
-                (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_dotget_string*/
-                (i != 41) && /*json_object_dotget_string*/
-                (i != 42) && /*json_object_dotget_string*/
-                (i != 43) && /*json_object_dotget_boolean*/
-                (i != 61) && /*json_value_free*/
-                (i != 62) /*BUFFER_delete*/
+                (i != 30) && /*json_object_dotget_string*/
+                (i != 31) && /*json_object_dotget_string*/
+                (i != 32) && /*json_object_dotget_string*/
+                (i != 33) && /*json_object_dotget_boolean*/
+                (i != 51) && /*json_value_free*/
+                (i != 52) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetModuleList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID, moduleList, IOTHUB_MODULE_VERSION_1);
@@ -4038,36 +4171,31 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_array_get_count*/
+                (i != 8) && /*HTTPHeaders_Free*/
+                (i != 12) && /*json_array_get_count*/
+                (i != 14) && /*json_object_get_string*/
+                (i != 15) && /*json_object_get_string*/
+                (i != 15) && /*json_object_get_string*/
+                (i != 16) && /*json_object_dotget_string*/
+                (i != 17) && /*json_object_get_string*/
+                (i != 18) && /*json_object_get_string*/
+                (i != 19) && /*json_object_get_string*/
+                (i != 20) && /*json_object_get_string*/
+                (i != 21) && /*json_object_get_string*/
+                (i != 22) && /*json_object_get_string*/
+                (i != 23) && /*json_object_get_string*/
                 (i != 24) && /*json_object_get_string*/
                 (i != 25) && /*json_object_get_string*/
-                (i != 25) && /*json_object_get_string*/
-                (i != 26) && /*json_object_dotget_string*/
+                (i != 26) && /*json_object_get_string*/
                 (i != 27) && /*json_object_get_string*/
                 (i != 28) && /*json_object_get_string*/
                 (i != 29) && /*json_object_get_string*/
-                (i != 30) && /*json_object_get_string*/
-                (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_dotget_string*/
-                (i != 41) && /*json_object_dotget_string*/
-                (i != 42) && /*json_object_dotget_string*/
-                (i != 43) && /*json_object_dotget_boolean*/
-                (i != 62) && /*json_value_free*/
-                (i != 63) /*BUFFER_delete*/
+                (i != 30) && /*json_object_dotget_string*/
+                (i != 31) && /*json_object_dotget_string*/
+                (i != 32) && /*json_object_dotget_string*/
+                (i != 33) && /*json_object_dotget_boolean*/
+                (i != 52) && /*json_value_free*/
+                (i != 53) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetModuleList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID, moduleList, IOTHUB_MODULE_VERSION_1);
@@ -4088,6 +4216,615 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
 
 
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_004: [ If registryManagerHandle or deviceCallback is NULL, or pageSize is not between 1 and 1000, IoTHubRegistryManager_EnumerateDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_return_IOTHUB_REGISTRYMANAGER_INVALID_ARG_if_input_parameter_is_invalid)
+    {
+        ///arrange
+        umock_c_reset_all_calls();
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT nullHandle = IoTHubRegistryManager_EnumerateDevices(NULL, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+        IOTHUB_REGISTRYMANAGER_RESULT nullCallback = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, NULL, (void*)0x4242);
+        IOTHUB_REGISTRYMANAGER_RESULT zeroPageSize = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 0, countingDeviceEnumCallback, (void*)0x4242);
+        IOTHUB_REGISTRYMANAGER_RESULT largePageSize = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 1001, countingDeviceEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullHandle);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullCallback);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, zeroPageSize);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, largePageSize);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_014: [ If registryManagerHandle or moduleCallback is NULL, or pageSize is not between 1 and 1000, IoTHubRegistryManager_EnumerateModules shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_015: [ If module_version is not a supported IOTHUB_MODULE version IoTHubRegistryManager_EnumerateModules shall return IOTHUB_REGISTRYMANAGER_INVALID_VERSION. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateModules_return_error_if_input_parameter_is_invalid)
+    {
+        ///arrange
+        umock_c_reset_all_calls();
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT nullHandle = IoTHubRegistryManager_EnumerateModules(NULL, TEST_SYNTHETIC_PAGE_SIZE, IOTHUB_MODULE_VERSION_1, countingModuleEnumCallback, (void*)0x4242);
+        IOTHUB_REGISTRYMANAGER_RESULT nullCallback = IoTHubRegistryManager_EnumerateModules(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, IOTHUB_MODULE_VERSION_1, NULL, (void*)0x4242);
+        IOTHUB_REGISTRYMANAGER_RESULT zeroPageSize = IoTHubRegistryManager_EnumerateModules(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 0, IOTHUB_MODULE_VERSION_1, countingModuleEnumCallback, (void*)0x4242);
+        IOTHUB_REGISTRYMANAGER_RESULT badVersion = IoTHubRegistryManager_EnumerateModules(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, 0, countingModuleEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullHandle);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullCallback);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, zeroPageSize);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_VERSION, badVersion);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_005: [ IoTHubRegistryManager_EnumerateDevices shall create the query body and a single response buffer that is reused for every page. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_006: [ For every page IoTHubRegistryManager_EnumerateDevices shall POST the query to url/devices/query?api-version by calling IoTHubScConnectionPool_ExecuteRequest, with the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_008: [ IoTHubRegistryManager_EnumerateDevices shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_happy_path_requests_pages_with_continuation_token)
+    {
+        ///arrange
+        unsigned char emptyPages[2][3] = { "[]", "[]" };
+        size_t page;
+
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(BUFFER_new());
+        for (page = 0; page < 2; page++)
+        {
+            STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+            STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_REQUEST_ID, TEST_HTTP_HEADER_VAL_REQUEST_ID))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_USER_AGENT, TEST_HTTP_HEADER_VAL_USER_AGENT))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_ACCEPT, TEST_HTTP_HEADER_VAL_ACCEPT))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_CONTENT_TYPE, TEST_HTTP_HEADER_VAL_CONTENT_TYPE))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "x-ms-max-item-count", "10"))
+                .IgnoreArgument(1);
+            if (page > 0)
+            {
+                STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "x-ms-continuation", IGNORED_PTR_ARG))
+                    .IgnoreArgument(1)
+                    .IgnoreArgument(3);
+            }
+            STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+            STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, "/devices/query?api-version=2017-11-08-preview", IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument(4)
+                .IgnoreArgument(5)
+                .IgnoreArgument(6)
+                .IgnoreArgument(7)
+                .IgnoreArgument(8)
+                .CopyOutArgumentBuffer_statusCode(&httpStatusCodeOk, sizeof(httpStatusCodeOk))
+                .SetReturn(HTTPAPIEX_OK);
+            STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, "x-ms-continuation"))
+                .IgnoreArgument(1)
+                .SetReturn((page == 0) ? "theToken" : NULL);
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            if (page == 0)
+            {
+                STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "theToken"))
+                    .IgnoreArgument(1);
+            }
+            STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
+                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+                .IgnoreArgument(1)
+                .SetReturn(emptyPages[page]);
+            STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+                .IgnoreArgument(1)
+                .SetReturn(2);
+        }
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_011: [ Every record shall be handed to the callback as soon as it is parsed, the structure and its members are only valid during the call and shall be freed when the callback returns. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_012: [ If a page is not a JSON array of objects then the enumeration shall stop and return IOTHUB_REGISTRYMANAGER_JSON_ERROR. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_delivers_every_record_of_every_page)
+    {
+        ///arrange
+        startSyntheticPageServer(100);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 100, syntheticPagesServed);
+        ASSERT_ARE_EQUAL(size_t, 1000, enumeratedCount);
+        ASSERT_ARE_EQUAL(size_t, 1000, syntheticRecordsMatched);
+        ASSERT_ARE_EQUAL(int, 0, liveAllocationCount);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_011: [ Every record shall be handed to the callback as soon as it is parsed, the structure and its members are only valid during the call and shall be freed when the callback returns. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_peak_memory_does_not_depend_on_the_number_of_devices)
+    {
+        ///arrange
+        int peakForTwoPages;
+        startSyntheticPageServer(2);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242));
+        peakForTwoPages = peakLiveAllocationCount;
+        startSyntheticPageServer(100);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 1000, enumeratedCount);
+        ASSERT_ARE_EQUAL(int, peakForTwoPages, peakLiveAllocationCount);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_013: [ If the callback returns a non-zero value then IoTHubRegistryManager_EnumerateDevices shall stop without requesting further pages and return IOTHUB_REGISTRYMANAGER_OK. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_stops_when_the_callback_returns_non_zero)
+    {
+        ///arrange
+        startSyntheticPageServer(100);
+        enumerationStopAfter = 3;
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 1, syntheticPagesServed);
+        ASSERT_ARE_EQUAL(size_t, 3, enumeratedCount);
+        ASSERT_ARE_EQUAL(int, 0, liveAllocationCount);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_012: [ If a page is not a JSON array of objects then the enumeration shall stop and return IOTHUB_REGISTRYMANAGER_JSON_ERROR. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_return_IOTHUB_REGISTRYMANAGER_JSON_ERROR_if_page_is_malformed)
+    {
+        ///arrange
+        const char* malformedPages[] =
+        {
+            "{\"deviceId\":\"a\"}",
+            "[{\"deviceId\":\"a\"} {\"deviceId\":\"b\"}]",
+            "[{\"deviceId\":\"a\"}",
+            "[\"a\"]",
+            ""
+        };
+        size_t i;
+
+        for (i = 0; i < sizeof(malformedPages) / sizeof(malformedPages[0]); i++)
+        {
+            startSyntheticPageServer(1);
+            syntheticPageOverride = malformedPages[i];
+
+            ///act
+            IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+            ///assert
+            ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_JSON_ERROR, result);
+            ASSERT_ARE_EQUAL(int, 0, liveAllocationCount);
+        }
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_007: [ If the request fails IoTHubRegistryManager_EnumerateDevices shall return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, if the status code is 300 or above it shall return IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_return_error_if_the_request_fails)
+    {
+        ///arrange
+        IOTHUB_REGISTRYMANAGER_RESULT statusResult;
+        IOTHUB_REGISTRYMANAGER_RESULT requestResult;
+
+        startSyntheticPageServer(1);
+        syntheticStatusCode = httpStatusCodeBadRequest;
+        statusResult = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+        startSyntheticPageServer(1);
+        syntheticExecuteResult = HTTPAPIEX_ERROR;
+
+        ///act
+        requestResult = IoTHubRegistryManager_EnumerateDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, countingDeviceEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR, statusResult);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, requestResult);
+        ASSERT_ARE_EQUAL(size_t, 0, enumeratedCount);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_016: [ IoTHubRegistryManager_EnumerateModules shall enumerate the query SELECT * FROM devices.modules exactly as IoTHubRegistryManager_EnumerateDevices enumerates SELECT * FROM devices. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_EnumerateModules_delivers_every_record_of_every_page)
+    {
+        ///arrange
+        startSyntheticPageServer(3);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_EnumerateModules(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_SYNTHETIC_PAGE_SIZE, IOTHUB_MODULE_VERSION_1, countingModuleEnumCallback, (void*)0x4242);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 3, syntheticPagesServed);
+        ASSERT_ARE_EQUAL(size_t, 30, enumeratedCount);
+        ASSERT_ARE_EQUAL(size_t, 30, syntheticRecordsMatched);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_017: [ If registryManagerHandle, devices or results is NULL, deviceCount is 0 or maxConcurrentRequests is not between 1 and 16 then IoTHubRegistryManager_BulkDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_BulkDevices_return_IOTHUB_REGISTRYMANAGER_INVALID_ARG_if_input_parameter_is_invalid)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_BULK_DEVICE device;
+        IOTHUB_REGISTRYMANAGER_RESULT results[1];
+        setBulkDevice(&device, TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_CREATE);
+        umock_c_reset_all_calls();
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT nullHandle = IoTHubRegistryManager_BulkDevices(NULL, &device, 1, 1, results);
+        IOTHUB_REGISTRYMANAGER_RESULT nullDevices = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, NULL, 1, 1, results);
+        IOTHUB_REGISTRYMANAGER_RESULT nullResults = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, &device, 1, 1, NULL);
+        IOTHUB_REGISTRYMANAGER_RESULT zeroCount = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, &device, 0, 1, results);
+        IOTHUB_REGISTRYMANAGER_RESULT zeroConcurrency = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, &device, 1, 0, results);
+        IOTHUB_REGISTRYMANAGER_RESULT largeConcurrency = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, &device, 1, 17, results);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullHandle);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullDevices);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, nullResults);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, zeroCount);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, zeroConcurrency);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, largeConcurrency);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_018: [ If any device has a NULL or whitespace deviceId, an unknown mode, a NULL eTag with an _IF_MATCH_ETAG mode or, for a create or update, an authentication method that cannot be set, then IoTHubRegistryManager_BulkDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG without sending any request. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_019: [ If the version of any device is not IOTHUB_REGISTRY_BULK_DEVICE_VERSION_1 then IoTHubRegistryManager_BulkDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_VERSION. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_BulkDevices_return_error_if_a_device_is_invalid)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_BULK_DEVICE devices[2];
+        IOTHUB_REGISTRYMANAGER_RESULT results[2];
+        IOTHUB_REGISTRYMANAGER_RESULT badVersion;
+        IOTHUB_REGISTRYMANAGER_RESULT whitespaceId;
+        IOTHUB_REGISTRYMANAGER_RESULT missingEtag;
+        IOTHUB_REGISTRYMANAGER_RESULT badAuth;
+        umock_c_reset_all_calls();
+
+        ///act
+        setBulkDevice(&devices[0], TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_CREATE);
+        setBulkDevice(&devices[1], TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_CREATE);
+        devices[1].version = IOTHUB_REGISTRY_BULK_DEVICE_VERSION_1 + 1;
+        badVersion = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 1, results);
+
+        setBulkDevice(&devices[1], "the device", IOTHUB_REGISTRY_BULK_DELETE);
+        whitespaceId = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 1, results);
+
+        setBulkDevice(&devices[1], TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_DELETE_IF_MATCH_ETAG);
+        missingEtag = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 1, results);
+
+        setBulkDevice(&devices[1], TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_UPDATE);
+        devices[1].authMethod = IOTHUB_REGISTRYMANAGER_AUTH_UNKNOWN;
+        badAuth = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 1, results);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_VERSION, badVersion);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, whitespaceId);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, missingEtag);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, badAuth);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_021: [ The body of every request shall be the JSON array of the devices of the chunk, written directly into one buffer without building a parson tree. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_022: [ Every chunk shall be POSTed to url/devices?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_024: [ If the status code is less or equal than 300 every device of the chunk shall get IOTHUB_REGISTRYMANAGER_OK. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_BulkDevices_happy_path_posts_the_devices_as_one_json_array)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_BULK_DEVICE devices[2];
+        IOTHUB_REGISTRYMANAGER_RESULT results[2];
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+
+        setBulkDevice(&devices[0], "a\"b", IOTHUB_REGISTRY_BULK_CREATE);
+        devices[0].primaryKey = TEST_PRIMARYKEY;
+        devices[0].secondaryKey = TEST_SECONDARYKEY;
+        devices[0].iotEdge_capable = true;
+        setBulkDevice(&devices[1], TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_DELETE_IF_MATCH_ETAG);
+        devices[1].eTag = TEST_ETAG;
+
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        capturedRequestBody[0] = '\0';
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, "/devices?api-version=2017-11-08-preview", IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument(4)
+            .IgnoreArgument(5)
+            .IgnoreArgument(6)
+            .IgnoreArgument(7)
+            .IgnoreArgument(8);
+
+        ///act
+        result = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 4, results);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, results[0]);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, results[1]);
+        ASSERT_ARE_EQUAL(size_t, 1, syntheticPagesServed);
+        ASSERT_ARE_EQUAL(char_ptr,
+            "[{\"id\":\"a\\\"b\",\"importMode\":\"create\",\"status\":\"enabled\",\"authentication\":{\"type\":\"sas\",\"symmetricKey\":{\"primaryKey\":\"thePrimaryKey\",\"secondaryKey\":\"theSecondaryKey\"}},\"capabilities\":{\"iotEdge\":true}},"
+            "{\"id\":\"theDeviceId\",\"importMode\":\"deleteIfMatchETag\",\"eTag\":\"theEtag\"}]",
+            capturedRequestBody);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_020: [ IoTHubRegistryManager_BulkDevices shall split the devices in chunks of at most 100 consecutive devices. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_023: [ IoTHubRegistryManager_BulkDevices shall start the smaller of maxConcurrentRequests and the number of chunks, minus one, worker threads by calling ThreadAPI_Create, the calling thread and the worker threads shall each take the next chunk that has not been sent until all the chunks are sent. If a thread cannot be created its chunks shall be sent by the other threads. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_027: [ IoTHubRegistryManager_BulkDevices shall wait for the worker threads by calling ThreadAPI_Join and return IOTHUB_REGISTRYMANAGER_OK if every device succeeded, otherwise the result of the first device in the array that did not succeed. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_BulkDevices_sends_chunks_of_100_devices_on_concurrent_threads)
+    {
+        ///arrange
+        static IOTHUB_REGISTRY_BULK_DEVICE devices[250];
+        static IOTHUB_REGISTRYMANAGER_RESULT results[250];
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+        size_t i;
+
+        for (i = 0; i < 250; i++)
+        {
+            setBulkDevice(&devices[i], TEST_DEVICE_ID, IOTHUB_REGISTRY_BULK_DELETE);
+        }
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        threadCreateCount = 0;
+        threadJoinCount = 0;
+        umock_c_reset_all_calls();
+
+        ///act
+        result = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 250, 4, results);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 3, syntheticPagesServed);
+        ASSERT_ARE_EQUAL(size_t, 2, threadCreateCount);
+        ASSERT_ARE_EQUAL(size_t, 2, threadJoinCount);
+        for (i = 0; i < 250; i++)
+        {
+            ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, results[i]);
+        }
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_025: [ If the status code is 400 and the response carries an errors array, every device listed there shall get IOTHUB_REGISTRYMANAGER_DEVICE_EXIST for DeviceAlreadyExists, IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST for DeviceNotFound and IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR otherwise, the other devices of the chunk shall get IOTHUB_REGISTRYMANAGER_OK. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_027: [ IoTHubRegistryManager_BulkDevices shall wait for the worker threads by calling ThreadAPI_Join and return IOTHUB_REGISTRYMANAGER_OK if every device succeeded, otherwise the result of the first device in the array that did not succeed. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_BulkDevices_maps_the_errors_of_a_400_response_to_devices)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_BULK_DEVICE devices[2];
+        IOTHUB_REGISTRYMANAGER_RESULT results[2];
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+
+        setBulkDevice(&devices[0], "d1", IOTHUB_REGISTRY_BULK_CREATE);
+        setBulkDevice(&devices[1], "d2", IOTHUB_REGISTRY_BULK_CREATE);
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        syntheticStatusCode = httpStatusCodeBadRequest;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(json_object_get_array(TEST_JSON_OBJECT, "errors"));
+        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
+            .SetReturn(1);
+        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0));
+        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "deviceId"))
+            .SetReturn("d2");
+        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "errorCode"))
+            .SetReturn("DeviceAlreadyExists");
+
+        ///act
+        result = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 1, results);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_DEVICE_EXIST, result);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, results[0]);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_DEVICE_EXIST, results[1]);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_026: [ If the request cannot be sent every device of the chunk shall get IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, for any other status code greater than 300 IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR and for any other failure IOTHUB_REGISTRYMANAGER_ERROR. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_BulkDevices_return_IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR_if_the_request_fails)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_BULK_DEVICE devices[2];
+        IOTHUB_REGISTRYMANAGER_RESULT results[2];
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+
+        setBulkDevice(&devices[0], "d1", IOTHUB_REGISTRY_BULK_DELETE);
+        setBulkDevice(&devices[1], "d2", IOTHUB_REGISTRY_BULK_DELETE);
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        syntheticExecuteResult = HTTPAPIEX_ERROR;
+        umock_c_reset_all_calls();
+
+        ///act
+        result = IoTHubRegistryManager_BulkDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, devices, 2, 1, results);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, result);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, results[0]);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, results[1]);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_028: [ If registryManagerHandle, outputBlobContainerUri or job is NULL then IoTHubRegistryManager_ExportDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_030: [ If registryManagerHandle, inputBlobContainerUri, outputBlobContainerUri or job is NULL then IoTHubRegistryManager_ImportDevices shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_032: [ If registryManagerHandle, jobId or job is NULL then IoTHubRegistryManager_GetJob shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_036: [ If registryManagerHandle or jobId is NULL then IoTHubRegistryManager_CancelJob shall fail and return IOTHUB_REGISTRYMANAGER_INVALID_ARG. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_038: [ IoTHubRegistryManager_FreeJobMembers shall free the strings of job and set them to NULL, if job is NULL it shall do nothing. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_job_functions_return_IOTHUB_REGISTRYMANAGER_INVALID_ARG_if_input_parameter_is_NULL)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_JOB job;
+        umock_c_reset_all_calls();
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT exportNullHandle = IoTHubRegistryManager_ExportDevices(NULL, "uri", false, &job);
+        IOTHUB_REGISTRYMANAGER_RESULT exportNullUri = IoTHubRegistryManager_ExportDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, NULL, false, &job);
+        IOTHUB_REGISTRYMANAGER_RESULT exportNullJob = IoTHubRegistryManager_ExportDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, "uri", false, NULL);
+        IOTHUB_REGISTRYMANAGER_RESULT importNullInputUri = IoTHubRegistryManager_ImportDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, NULL, "uri", &job);
+        IOTHUB_REGISTRYMANAGER_RESULT importNullOutputUri = IoTHubRegistryManager_ImportDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, "uri", NULL, &job);
+        IOTHUB_REGISTRYMANAGER_RESULT getNullJobId = IoTHubRegistryManager_GetJob(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, NULL, &job);
+        IOTHUB_REGISTRYMANAGER_RESULT getNullJob = IoTHubRegistryManager_GetJob(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, "job1", NULL);
+        IOTHUB_REGISTRYMANAGER_RESULT cancelNullHandle = IoTHubRegistryManager_CancelJob(NULL, "job1");
+        IOTHUB_REGISTRYMANAGER_RESULT cancelNullJobId = IoTHubRegistryManager_CancelJob(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, NULL);
+        IoTHubRegistryManager_FreeJobMembers(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, exportNullHandle);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, exportNullUri);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, exportNullJob);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, importNullInputUri);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, importNullOutputUri);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, getNullJobId);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, getNullJob);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, cancelNullHandle);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_INVALID_ARG, cancelNullJobId);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_029: [ IoTHubRegistryManager_ExportDevices shall POST {"type":"export","outputBlobContainerUri":...,"excludeKeysInExport":...} to url/jobs/create?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_035: [ The response shall be parsed into job, jobId, startTimeUtc, endTimeUtc and failureReason are copied and have to be freed with IoTHubRegistryManager_FreeJobMembers. If the parsing fails the function shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_038: [ IoTHubRegistryManager_FreeJobMembers shall free the strings of job and set them to NULL, if job is NULL it shall do nothing. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_ExportDevices_happy_path_creates_the_job_and_parses_it)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_JOB job;
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        capturedRequestBody[0] = '\0';
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, "/jobs/create?api-version=2017-11-08-preview", IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument(4)
+            .IgnoreArgument(5)
+            .IgnoreArgument(6)
+            .IgnoreArgument(7)
+            .IgnoreArgument(8);
+        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "type"))
+            .SetReturn("export");
+        STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, "status"))
+            .SetReturn("running");
+
+        ///act
+        result = IoTHubRegistryManager_ExportDevices(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, "https://theAccount/theContainer", true, &job);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "{\"type\":\"export\",\"outputBlobContainerUri\":\"https://theAccount/theContainer\",\"excludeKeysInExport\":true}", capturedRequestBody);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRY_JOB_TYPE_EXPORT, job.type);
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRY_JOB_STATUS_RUNNING, job.status);
+        ASSERT_ARE_EQUAL(int, 42, job.progress);
+        ASSERT_IS_NOT_NULL(job.jobId);
+
+        IoTHubRegistryManager_FreeJobMembers(&job);
+        ASSERT_IS_NULL(job.jobId);
+        ASSERT_IS_NULL(job.failureReason);
+        ASSERT_ARE_EQUAL(int, 0, liveAllocationCount);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_033: [ IoTHubRegistryManager_GetJob shall GET url/jobs/[jobId]?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_034: [ If the request fails the job functions shall return IOTHUB_REGISTRYMANAGER_HTTPAPI_ERROR, if the status code is 404 IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST and if it is any other status code greater than 300 IOTHUB_REGISTRYMANAGER_HTTP_STATUS_ERROR. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_GetJob_return_IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST_if_the_job_is_not_found)
+    {
+        ///arrange
+        IOTHUB_REGISTRY_JOB job;
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        syntheticStatusCode = 404;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_GET, "/jobs/job1?api-version=2017-11-08-preview", IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+            .IgnoreArgument(4)
+            .IgnoreArgument(6)
+            .IgnoreArgument(8);
+
+        ///act
+        result = IoTHubRegistryManager_GetJob(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, "job1", &job);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_DEVICE_NOT_EXIST, result);
+        ASSERT_ARE_EQUAL(size_t, 1, syntheticPagesServed);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
+    /*Tests_SRS_IOTHUBREGISTRYMANAGER_02_037: [ IoTHubRegistryManager_CancelJob shall DELETE url/jobs/[jobId]?api-version by calling IoTHubScConnectionPool_ExecuteRequest. ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_CancelJob_happy_path)
+    {
+        ///arrange
+        IOTHUB_REGISTRYMANAGER_RESULT result;
+
+        startSyntheticPageServer(1);
+        syntheticPageOverride = "{}";
+        syntheticStatusCode = 204;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_DELETE, "/jobs/job1?api-version=2017-11-08-preview", IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+            .IgnoreArgument(4)
+            .IgnoreArgument(6)
+            .IgnoreArgument(8);
+
+        ///act
+        result = IoTHubRegistryManager_CancelJob(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, "job1");
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 1, syntheticPagesServed);
+
+        ///cleanup
+        stopSyntheticPageServer();
+    }
+
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_074: [ IoTHubRegistryManager_GetStatistics shall verify the input parameters and if any of them are NULL then return IOTHUB_REGISTRYMANAGER_INVALID_ARG ]*/
     TEST_FUNCTION(IoTHubRegistryManager_GetStatistics_return_IOTHUB_REGISTRYMANAGER_INVALID_ARG_if_input_parameter_registryManagerHandle_is_NULL)
     {
@@ -4119,9 +4856,9 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_112: [ IoTHubRegistryManager_GetStatistics shall allocate memory for response buffer by calling BUFFER_new ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_075: [ IoTHubRegistryManager_GetStatistics shall create HTTP GET request for statistics using the following format: url/statistics/devices?api-version ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_076: [ IoTHubRegistryManager_GetStatistics shall add the following headers to the created HTTP GET request: authorization=sasToken,Request-Id=1001,Accept=application/json,Content-Type=application/json,charset=utf-8 ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_077: [ IoTHubRegistryManager_GetStatistics shall create an HTTPAPIEX_SAS_HANDLE handle by calling HTTPAPIEX_SAS_Create ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_078: [ IoTHubRegistryManager_GetStatistics shall create an HTTPAPIEX_HANDLE handle by calling HTTPAPIEX_Create ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_079: [ IoTHubRegistryManager_GetStatistics shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_077: [ IoTHubRegistryManager_GetStatistics shall authorize the request with the SAS token cached by the IoTHubScConnectionPool ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_078: [ IoTHubRegistryManager_GetStatistics shall get a connection from the IoTHubScConnectionPool of the service client auth handle ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_079: [ IoTHubRegistryManager_GetStatistics shall execute the HTTP GET request by calling IoTHubScConnectionPool_ExecuteRequest ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_080: [ IoTHubRegistryManager_GetStatistics shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_081: [ IoTHubRegistryManager_GetStatistics shall verify the received HTTP status code and if it is less or equal than 300 then use the following parson APIs to parse the response JSON to registry statistics structure: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_083: [ IoTHubRegistryManager_GetStatistics shall save the registry statistics to the out value and return IOTHUB_REGISTRYMANAGER_OK ]*/
@@ -4209,17 +4946,12 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
 
             /// act
             if (
-                (i != 13) && /*HTTPHeaders_Free*/
-                (i != 14) && /*HTTPAPIEX_Destroy*/
-                (i != 15) && /*HTTPAPIEX_SAS_Destroy*/
-                (i != 16) && /*STRING_delete*/
-                (i != 17) && /*STRING_delete*/
-                (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_object_get_number*/
-                (i != 23) && /*json_object_get_number*/
-                (i != 24) && /*json_object_get_number*/
-                (i != 26) && /*json_value_free*/
-                (i != 27) /*BUFFER_delete*/
+                (i != 8) && /*HTTPHeaders_Free*/
+                (i != 12) && /*json_object_get_number*/
+                (i != 13) && /*json_object_get_number*/
+                (i != 14) && /*json_object_get_number*/
+                (i != 16) && /*json_value_free*/
+                (i != 17) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetStatistics(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, &TEST_IOTHUB_REGISTRY_STATISTICS);
@@ -0,0 +1,725 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t l = strlen(source);
+    *destination = (char*)my_gballoc_malloc(l + 1);
+    strcpy(*destination, source);
+    return 0;
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#undef ENABLE_MOCKS
+
+#include "iothub_sc_connection_pool.h"
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+TEST_DEFINE_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static const char* TEST_HOSTNAME = "theHostName";
+static const char* TEST_SHAREDACCESSKEY = "theSharedAccessKey";
+static const char* TEST_SHAREDACCESSKEYNAME = "theSharedAccessKeyName";
+static const char* TEST_DEVICE_ID = "theDeviceId";
+static const char* TEST_RELATIVE_PATH = "/devices/theDeviceId?api-version=2017-11-08-preview";
+static const char* TEST_SAS_TOKEN_STRING = "SharedAccessSignature sr=theHostName&sig=theSignature&se=3600&skn=theSharedAccessKeyName";
+
+static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4141;
+static STRING_HANDLE TEST_SCOPE = (STRING_HANDLE)0x4242;
+static STRING_HANDLE TEST_SAS_TOKEN = (STRING_HANDLE)0x4343;
+static HTTPAPIEX_HANDLE TEST_HTTPAPIEX_HANDLE = (HTTPAPIEX_HANDLE)0x4444;
+static HTTP_HEADERS_HANDLE TEST_HTTP_HEADERS_HANDLE = (HTTP_HEADERS_HANDLE)0x4545;
+static const time_t TEST_TIME = (time_t)1000000;
+
+static const unsigned int httpStatusCodeOk = 200;
+static const unsigned int httpStatusCodeUnauthorized = 401;
+
+static size_t g_STRING_construct_sprintf_call_count;
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+STRING_HANDLE STRING_construct_sprintf(const char* format, ...)
+{
+    (void)format;
+    g_STRING_construct_sprintf_call_count++;
+    return TEST_SCOPE;
+}
+
+static IOTHUB_SC_CONNECTION_POOL_HANDLE create_connection_pool(void)
+{
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Create(TEST_HOSTNAME, TEST_SHAREDACCESSKEY, TEST_SHAREDACCESSKEYNAME, NULL);
+    ASSERT_IS_NOT_NULL(result);
+    umock_c_reset_all_calls();
+    return result;
+}
+
+static void set_expected_calls_for_Create(const char* keyName)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SHAREDACCESSKEY));
+    if (keyName != NULL)
+    {
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, keyName));
+        STRICT_EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
+    }
+    STRICT_EXPECTED_CALL(Lock_Init());
+}
+
+static void set_expected_calls_for_ExecuteRequest(time_t currentTime, STRING_HANDLE previousSasToken, bool createSasToken, bool createConnection, const unsigned int* httpStatusCode)
+{
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG))
+        .SetReturn(currentTime);
+    if (createSasToken)
+    {
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE));
+        STRICT_EXPECTED_CALL(SASToken_CreateString(TEST_SHAREDACCESSKEY, IGNORED_PTR_ARG, TEST_SHAREDACCESSKEYNAME, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(previousSasToken));
+    }
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SAS_TOKEN));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, "Authorization", TEST_SAS_TOKEN_STRING));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    if (createConnection)
+    {
+        STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
+    }
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(TEST_HTTPAPIEX_HANDLE, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, NULL, IGNORED_PTR_ARG, NULL, NULL))
+        .CopyOutArgumentBuffer_statusCode(httpStatusCode, sizeof(*httpStatusCode));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+}
+
+static HTTPAPIEX_RESULT execute_request(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, unsigned int* statusCode)
+{
+    return IoTHubScConnectionPool_ExecuteRequest(connectionPool, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, NULL, statusCode, NULL, NULL);
+}
+
+static HTTPAPIEX_RESULT execute_request_with_timeout(IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool, unsigned int timeoutInMilliseconds, unsigned int* statusCode)
+{
+    return IoTHubScConnectionPool_ExecuteRequestWithTimeout(connectionPool, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, NULL, statusCode, NULL, NULL, timeoutInMilliseconds);
+}
+
+BEGIN_TEST_SUITE(iothub_sc_connection_pool_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    int result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, 42);
+
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock, LOCK_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Unlock, LOCK_ERROR);
+
+    REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, (time_t)(-1));
+
+    REGISTER_GLOBAL_MOCK_RETURN(STRING_construct, TEST_SCOPE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_construct, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, TEST_SAS_TOKEN_STRING);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_c_str, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(SASToken_CreateString, TEST_SAS_TOKEN);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_CreateString, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_ReplaceHeaderNameValuePair, HTTP_HEADERS_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_ReplaceHeaderNameValuePair, HTTP_HEADERS_ERROR);
+
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_Create, TEST_HTTPAPIEX_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_ExecuteRequest, HTTPAPIEX_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_SetOption, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_SetOption, HTTPAPIEX_ERROR);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_STRING_construct_sprintf_call_count = 0;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_001: [ If hostname or sharedAccessKey is NULL, or keyName and deviceId are both NULL, then IoTHubScConnectionPool_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Create_with_invalid_arguments_fails)
+{
+    ///act
+    IOTHUB_SC_CONNECTION_POOL_HANDLE nullHostname = IoTHubScConnectionPool_Create(NULL, TEST_SHAREDACCESSKEY, TEST_SHAREDACCESSKEYNAME, NULL);
+    IOTHUB_SC_CONNECTION_POOL_HANDLE nullKey = IoTHubScConnectionPool_Create(TEST_HOSTNAME, NULL, TEST_SHAREDACCESSKEYNAME, NULL);
+    IOTHUB_SC_CONNECTION_POOL_HANDLE nullKeyNameAndDeviceId = IoTHubScConnectionPool_Create(TEST_HOSTNAME, TEST_SHAREDACCESSKEY, NULL, NULL);
+
+    ///assert
+    ASSERT_IS_NULL(nullHostname);
+    ASSERT_IS_NULL(nullKey);
+    ASSERT_IS_NULL(nullKeyNameAndDeviceId);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_002: [ IoTHubScConnectionPool_Create shall allocate memory for a new connection pool having a reference count of 1. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_003: [ IoTHubScConnectionPool_Create shall copy hostname, sharedAccessKey and keyName, create the SAS token scope (hostname, or hostname%2Fdevices%2FdeviceId when deviceId is not NULL) and create a lock by calling Lock_Init. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Create_with_keyName_succeeds)
+{
+    ///arrange
+    set_expected_calls_for_Create(TEST_SHAREDACCESSKEYNAME);
+
+    ///act
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Create(TEST_HOSTNAME, TEST_SHAREDACCESSKEY, TEST_SHAREDACCESSKEYNAME, NULL);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(result);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_003: [ IoTHubScConnectionPool_Create shall copy hostname, sharedAccessKey and keyName, create the SAS token scope (hostname, or hostname%2Fdevices%2FdeviceId when deviceId is not NULL) and create a lock by calling Lock_Init. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Create_with_deviceId_scopes_the_SAS_token_to_the_device)
+{
+    ///arrange
+    set_expected_calls_for_Create(NULL);
+
+    ///act
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Create(TEST_HOSTNAME, TEST_SHAREDACCESSKEY, NULL, TEST_DEVICE_ID);
+
+    ///assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_STRING_construct_sprintf_call_count);
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(result);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_004: [ If any call fails, IoTHubScConnectionPool_Create shall do clean up and return NULL. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Create_non_happy_path)
+{
+    ///arrange
+    int umockc_result = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, umockc_result);
+
+    set_expected_calls_for_Create(TEST_SHAREDACCESSKEYNAME);
+
+    umock_c_negative_tests_snapshot();
+
+    for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+    {
+        ///arrange
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(i);
+
+        ///act
+        IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Create(TEST_HOSTNAME, TEST_SHAREDACCESSKEY, TEST_SHAREDACCESSKEYNAME, NULL);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+    }
+
+    ///cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_005: [ If connectionPool is NULL then IoTHubScConnectionPool_Clone shall return NULL. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Clone_with_NULL_connectionPool_returns_NULL)
+{
+    ///act
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Clone(NULL);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_006: [ Otherwise IoTHubScConnectionPool_Clone shall increment the reference count under the lock and return connectionPool. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_009: [ IoTHubScConnectionPool_Destroy shall decrement the reference count under the lock. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Clone_keeps_the_pool_alive_until_the_last_Destroy)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Clone(connectionPool);
+    IoTHubScConnectionPool_Destroy(connectionPool);
+
+    ///assert
+    ASSERT_ARE_EQUAL(void_ptr, connectionPool, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(result);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_007: [ If Lock fails then IoTHubScConnectionPool_Clone shall return NULL. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Clone_fails_when_Lock_fails)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE))
+        .SetReturn(LOCK_ERROR);
+
+    ///act
+    IOTHUB_SC_CONNECTION_POOL_HANDLE result = IoTHubScConnectionPool_Clone(connectionPool);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_008: [ If connectionPool is NULL then IoTHubScConnectionPool_Destroy shall return. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Destroy_with_NULL_connectionPool_returns)
+{
+    ///act
+    IoTHubScConnectionPool_Destroy(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_010: [ When the reference count reaches 0 IoTHubScConnectionPool_Destroy shall destroy all the idle connections by calling HTTPAPIEX_Destroy and free all the resources. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_Destroy_closes_the_idle_connections)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode;
+    (void)execute_request(connectionPool, &statusCode);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(TEST_HTTPAPIEX_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_SAS_TOKEN));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_SCOPE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    ///act
+    IoTHubScConnectionPool_Destroy(connectionPool);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_011: [ If connectionPool or requestHttpHeadersHandle is NULL then IoTHubScConnectionPool_ExecuteRequest shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_with_invalid_arguments_fails)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode;
+
+    ///act
+    HTTPAPIEX_RESULT nullPool = execute_request(NULL, &statusCode);
+    HTTPAPIEX_RESULT nullHeaders = IoTHubScConnectionPool_ExecuteRequest(connectionPool, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, &statusCode, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, nullPool);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, nullHeaders);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_013: [ Otherwise IoTHubScConnectionPool_ExecuteRequest shall create a new SAS token valid for 3600 seconds by calling SASToken_CreateString and cache it. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_014: [ IoTHubScConnectionPool_ExecuteRequest shall set the Authorization header of requestHttpHeadersHandle to the SAS token by calling HTTPHeaders_ReplaceHeaderNameValuePair. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_015: [ IoTHubScConnectionPool_ExecuteRequest shall take an idle connection from the pool, or create one by calling HTTPAPIEX_Create when the pool has none. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_016: [ IoTHubScConnectionPool_ExecuteRequest shall execute the request by calling HTTPAPIEX_ExecuteRequest and return what HTTPAPIEX_ExecuteRequest returns. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_017: [ After the request IoTHubScConnectionPool_ExecuteRequest shall return the connection to the pool, keeping it open. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_first_request_creates_the_SAS_token_and_the_connection)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, true, true, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(int, (int)httpStatusCodeOk, (int)statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_012: [ If the cached SAS token expires in more than 300 seconds then IoTHubScConnectionPool_ExecuteRequest shall reuse it. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_015: [ IoTHubScConnectionPool_ExecuteRequest shall take an idle connection from the pool, or create one by calling HTTPAPIEX_Create when the pool has none. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_second_request_reuses_the_SAS_token_and_the_connection)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+    (void)execute_request(connectionPool, &statusCode);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, false, false, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_013: [ Otherwise IoTHubScConnectionPool_ExecuteRequest shall create a new SAS token valid for 3600 seconds by calling SASToken_CreateString and cache it. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_refreshes_the_SAS_token_300_seconds_before_expiry)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+    (void)execute_request(connectionPool, &statusCode);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME + 3600 - 300, TEST_SAS_TOKEN, true, false, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_019: [ If the service answered 401 then IoTHubScConnectionPool_ExecuteRequest shall discard the cached SAS token. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_after_401_creates_a_new_SAS_token)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, true, true, &httpStatusCodeUnauthorized);
+    (void)execute_request(connectionPool, &statusCode);
+    ASSERT_ARE_EQUAL(int, (int)httpStatusCodeUnauthorized, (int)statusCode);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, TEST_SAS_TOKEN, true, false, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_020: [ If any call fails, IoTHubScConnectionPool_ExecuteRequest shall return HTTPAPIEX_ERROR. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_non_happy_path)
+{
+    ///arrange
+    int umockc_result = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, umockc_result);
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, true, true, &httpStatusCodeOk);
+
+    umock_c_negative_tests_snapshot();
+
+    for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+    {
+        ///arrange
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(i);
+
+        if (
+            (i != 2) && /*STRING_c_str*/
+            (i != 4) && /*STRING_delete*/
+            (i != 5) && /*STRING_c_str*/
+            (i != 7) && /*Unlock*/
+            (i != 10) && /*Lock*/
+            (i != 11)    /*Unlock*/
+            )
+        {
+            IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = IoTHubScConnectionPool_Create(TEST_HOSTNAME, TEST_SHAREDACCESSKEY, TEST_SHAREDACCESSKEYNAME, NULL);
+            unsigned int statusCode;
+
+            ///act
+            HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+
+            ///cleanup
+            IoTHubScConnectionPool_Destroy(connectionPool);
+        }
+    }
+
+    ///cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_022: [ If timeoutInMilliseconds is not 0 and differs from the timeout last set on the connection, IoTHubScConnectionPool_ExecuteRequestWithTimeout shall set it by calling HTTPAPIEX_SetOption with OPTION_HTTP_TIMEOUT. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequestWithTimeout_sets_the_timeout_on_a_new_connection)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE));
+    STRICT_EXPECTED_CALL(SASToken_CreateString(TEST_SHAREDACCESSKEY, IGNORED_PTR_ARG, TEST_SHAREDACCESSKEYNAME, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(NULL));
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SAS_TOKEN));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, "Authorization", TEST_SAS_TOKEN_STRING));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(TEST_HTTPAPIEX_HANDLE, "timeout", IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(TEST_HTTPAPIEX_HANDLE, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, NULL, IGNORED_PTR_ARG, NULL, NULL))
+        .CopyOutArgumentBuffer_statusCode(&httpStatusCodeOk, sizeof(httpStatusCodeOk));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request_with_timeout(connectionPool, 30000, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(int, (int)httpStatusCodeOk, (int)statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_021: [ IoTHubScConnectionPool_ExecuteRequestWithTimeout shall behave as IoTHubScConnectionPool_ExecuteRequest, preferring an idle connection whose timeout is already timeoutInMilliseconds. A request without timeout shall never reuse a connection that had a timeout set. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_022: [ If timeoutInMilliseconds is not 0 and differs from the timeout last set on the connection, IoTHubScConnectionPool_ExecuteRequestWithTimeout shall set it by calling HTTPAPIEX_SetOption with OPTION_HTTP_TIMEOUT. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequestWithTimeout_same_timeout_reuses_the_connection_without_setting_it_again)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+    (void)execute_request_with_timeout(connectionPool, 30000, &statusCode);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, false, false, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request_with_timeout(connectionPool, 30000, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_021: [ IoTHubScConnectionPool_ExecuteRequestWithTimeout shall behave as IoTHubScConnectionPool_ExecuteRequest, preferring an idle connection whose timeout is already timeoutInMilliseconds. A request without timeout shall never reuse a connection that had a timeout set. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_does_not_reuse_a_connection_with_a_timeout)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+    (void)execute_request_with_timeout(connectionPool, 30000, &statusCode);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, false, true, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_023: [ If HTTPAPIEX_SetOption fails, IoTHubScConnectionPool_ExecuteRequestWithTimeout shall destroy the connection and return HTTPAPIEX_ERROR. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequestWithTimeout_fails_when_HTTPAPIEX_SetOption_fails)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(TEST_HTTPAPIEX_HANDLE, "timeout", IGNORED_PTR_ARG))
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(TEST_HTTPAPIEX_HANDLE));
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request_with_timeout(connectionPool, 30000, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_024: [ If HTTPAPIEX_ExecuteRequest fails, IoTHubScConnectionPool_ExecuteRequest shall destroy the connection by calling HTTPAPIEX_Destroy instead of returning it to the pool. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_discards_the_connection_when_the_request_fails)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG))
+        .SetReturn(TEST_TIME);
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE));
+    STRICT_EXPECTED_CALL(SASToken_CreateString(TEST_SHAREDACCESSKEY, IGNORED_PTR_ARG, TEST_SHAREDACCESSKEYNAME, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(NULL));
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SAS_TOKEN));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, "Authorization", TEST_SAS_TOKEN_STRING));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(TEST_HTTPAPIEX_HANDLE, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, NULL, IGNORED_PTR_ARG, NULL, NULL))
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(TEST_HTTPAPIEX_HANDLE));
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_015: [ IoTHubScConnectionPool_ExecuteRequest shall take an idle connection from the pool, or create one by calling HTTPAPIEX_Create when the pool has none. ]*/
+/*Tests_SRS_IOTHUB_SC_CONNECTION_POOL_02_024: [ If HTTPAPIEX_ExecuteRequest fails, IoTHubScConnectionPool_ExecuteRequest shall destroy the connection by calling HTTPAPIEX_Destroy instead of returning it to the pool. ]*/
+TEST_FUNCTION(IoTHubScConnectionPool_ExecuteRequest_after_a_failed_request_creates_a_new_connection)
+{
+    ///arrange
+    IOTHUB_SC_CONNECTION_POOL_HANDLE connectionPool = create_connection_pool();
+    unsigned int statusCode = 0;
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(TEST_HTTPAPIEX_HANDLE, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, NULL, IGNORED_PTR_ARG, NULL, NULL))
+        .SetReturn(HTTPAPIEX_ERROR);
+    (void)execute_request(connectionPool, &statusCode);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_ExecuteRequest(TEST_TIME, NULL, false, true, &httpStatusCodeOk);
+
+    ///act
+    HTTPAPIEX_RESULT result = execute_request(connectionPool, &statusCode);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubScConnectionPool_Destroy(connectionPool);
+}
+
+END_TEST_SUITE(iothub_sc_connection_pool_ut)
@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#include "iothub_sc_feedback_parser.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define TEST_MAX_RECORDS 8
+
+static const char* TEST_FEEDBACK_TWO_RECORDS =
+    "[ { \"originalMessageId\": \"msg1\", \"deviceGenerationId\": \"gen1\", \"deviceId\": \"device1\", \"enqueuedTimeUtc\": \"2017-01-01T00:00:00Z\", \"description\": \"Success\", \"statusCode\": \"Success\" },\r\n"
+    "  { \"originalMessageId\": \"msg2\", \"deviceGenerationId\": \"gen2\", \"deviceId\": \"device2\", \"enqueuedTimeUtc\": \"2017-01-01T00:00:01Z\", \"description\": \"Expired\", \"statusCode\": \"Expired\" } ]";
+
+static IOTHUB_SERVICE_FEEDBACK_RECORD g_records[TEST_MAX_RECORDS];
+static size_t g_handlerCallCount;
+static size_t g_handlerFailAt;
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+static int test_record_handler(void* context, IOTHUB_SERVICE_FEEDBACK_RECORD* feedbackRecord)
+{
+    int result;
+    ASSERT_ARE_EQUAL(void_ptr, (void*)g_records, context);
+
+    if (g_handlerCallCount == g_handlerFailAt)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        ASSERT_IS_TRUE(g_handlerCallCount < TEST_MAX_RECORDS);
+        g_records[g_handlerCallCount] = *feedbackRecord;
+        result = 0;
+    }
+    g_handlerCallCount++;
+    return result;
+}
+
+/*parses a copy of json and returns the result of IoTHubScFeedbackParser_Parse, the copy is released by the caller*/
+static int parse(const char* json, char** copy, size_t* recordCount)
+{
+    size_t length = strlen(json);
+    *copy = (char*)malloc(length + 1);
+    ASSERT_IS_NOT_NULL(*copy);
+    (void)memcpy(*copy, json, length + 1);
+    return IoTHubScFeedbackParser_Parse(*copy, length, test_record_handler, g_records, recordCount);
+}
+
+static void assert_parse_fails(const char* json)
+{
+    char* copy;
+    size_t recordCount;
+
+    int result = parse(json, &copy, &recordCount);
+
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    free(copy);
+}
+
+BEGIN_TEST_SUITE(iothub_sc_feedback_parser_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    int result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    (void)memset(g_records, 0, sizeof(g_records));
+    g_handlerCallCount = 0;
+    g_handlerFailAt = (size_t)-1;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_001: [ If feedbackJson, recordHandler or recordCount is NULL then IoTHubScFeedbackParser_Parse shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_with_invalid_arguments_fails)
+{
+    ///arrange
+    char json[] = "[]";
+    size_t recordCount;
+
+    ///act
+    int nullJson = IoTHubScFeedbackParser_Parse(NULL, 2, test_record_handler, g_records, &recordCount);
+    int nullHandler = IoTHubScFeedbackParser_Parse(json, 2, NULL, g_records, &recordCount);
+    int nullRecordCount = IoTHubScFeedbackParser_Parse(json, 2, test_record_handler, g_records, NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, nullJson);
+    ASSERT_ARE_NOT_EQUAL(int, 0, nullHandler);
+    ASSERT_ARE_NOT_EQUAL(int, 0, nullRecordCount);
+    ASSERT_ARE_EQUAL(size_t, 0, g_handlerCallCount);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_002: [ IoTHubScFeedbackParser_Parse shall read feedbackJson once, without reading past length bytes and without allocating memory. ]*/
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_004: [ IoTHubScFeedbackParser_Parse shall call recordHandler for every record, in order, as soon as the record is parsed. ]*/
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_006: [ The values of deviceId, deviceGenerationId, description, enqueuedTimeUtc and originalMessageId shall be set in the record, pointing into feedbackJson; any other member shall be skipped. ]*/
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_009: [ Otherwise IoTHubScFeedbackParser_Parse shall succeed and return 0. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_hands_out_every_record_in_order)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+
+    ///act
+    int result = parse(TEST_FEEDBACK_TWO_RECORDS, &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 2, recordCount);
+    ASSERT_ARE_EQUAL(size_t, 2, g_handlerCallCount);
+    ASSERT_ARE_EQUAL(char_ptr, "device1", g_records[0].deviceId);
+    ASSERT_ARE_EQUAL(char_ptr, "gen1", g_records[0].generationId);
+    ASSERT_ARE_EQUAL(char_ptr, "success", g_records[0].description);
+    ASSERT_ARE_EQUAL(char_ptr, "2017-01-01T00:00:00Z", g_records[0].enqueuedTimeUtc);
+    ASSERT_ARE_EQUAL(char_ptr, "msg1", g_records[0].originalMessageId);
+    ASSERT_ARE_EQUAL(char_ptr, "", g_records[0].correlationId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS, g_records[0].statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, "device2", g_records[1].deviceId);
+    ASSERT_ARE_EQUAL(char_ptr, "msg2", g_records[1].originalMessageId);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, g_records[1].statusCode);
+    ASSERT_IS_TRUE((g_records[0].deviceId > copy) && (g_records[0].deviceId < copy + strlen(TEST_FEEDBACK_TWO_RECORDS)));
+
+    ///cleanup
+    free(copy);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_002: [ IoTHubScFeedbackParser_Parse shall read feedbackJson once, without reading past length bytes and without allocating memory. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_does_not_read_past_length)
+{
+    ///arrange
+    char json[] = "[{\"deviceId\":\"device1\"}]garbage";
+    size_t recordCount;
+
+    ///act
+    int result = IoTHubScFeedbackParser_Parse(json, sizeof("[{\"deviceId\":\"device1\"}]") - 1, test_record_handler, g_records, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, recordCount);
+    ASSERT_ARE_EQUAL(char_ptr, "device1", g_records[0].deviceId);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_009: [ Otherwise IoTHubScFeedbackParser_Parse shall succeed and return 0. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_accepts_trailing_NUL_terminator)
+{
+    ///arrange
+    char json[] = "[{\"deviceId\":\"device1\"}]";
+    size_t recordCount;
+
+    ///act
+    int result = IoTHubScFeedbackParser_Parse(json, sizeof(json), test_record_handler, g_records, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, recordCount);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_009: [ Otherwise IoTHubScFeedbackParser_Parse shall succeed and return 0. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_with_empty_array_succeeds_with_no_records)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+
+    ///act
+    int result = parse(" [ ] ", &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, recordCount);
+    ASSERT_ARE_EQUAL(size_t, 0, g_handlerCallCount);
+
+    ///cleanup
+    free(copy);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_003: [ If feedbackJson is not a JSON array of objects, optionally surrounded by whitespace, then IoTHubScFeedbackParser_Parse shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_with_malformed_json_fails)
+{
+    ///act & assert
+    assert_parse_fails("");
+    assert_parse_fails("{}");
+    assert_parse_fails("[1]");
+    assert_parse_fails("[{\"deviceId\":\"device1\"}");
+    assert_parse_fails("[{\"deviceId\":\"device1\"},]");
+    assert_parse_fails("[{\"deviceId\":\"device1\"}] x");
+    assert_parse_fails("[{\"deviceId\":\"device1}]");
+    assert_parse_fails("[{\"deviceId\" \"device1\"}]");
+    assert_parse_fails("[{\"deviceId\":device1}]");
+    assert_parse_fails("[{\"deviceId\":\"\\q\"}]");
+    assert_parse_fails("[{\"deviceId\":\"\\u12\"}]");
+    assert_parse_fails("[{\"deviceId\":\"\\ud83d\"}]");
+    assert_parse_fails("[{\"other\":[1,2}]");
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_005: [ If recordHandler returns a non-zero value then IoTHubScFeedbackParser_Parse shall stop and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_stops_when_the_handler_fails)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+    g_handlerFailAt = 0;
+
+    ///act
+    int result = parse(TEST_FEEDBACK_TWO_RECORDS, &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_handlerCallCount);
+    ASSERT_ARE_EQUAL(size_t, 0, recordCount);
+
+    ///cleanup
+    free(copy);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_006: [ The values of deviceId, deviceGenerationId, description, enqueuedTimeUtc and originalMessageId shall be set in the record, pointing into feedbackJson; any other member shall be skipped. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_skips_unknown_members)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+
+    ///act
+    int result = parse("[{\"lockToken\":{\"a\":[1,-2.5e3,{\"b\":null}],\"c\":true,\"d\":{}},\"deviceId\":\"device1\",\"e\":false,\"f\":[]}]", &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, recordCount);
+    ASSERT_ARE_EQUAL(char_ptr, "device1", g_records[0].deviceId);
+
+    ///cleanup
+    free(copy);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_006: [ The values of deviceId, deviceGenerationId, description, enqueuedTimeUtc and originalMessageId shall be set in the record, pointing into feedbackJson; any other member shall be skipped. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_unescapes_strings_in_place)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+
+    ///act
+    int result = parse("[{\"deviceId\":\"a\\\"b\\\\c\\/d\\te\\u00e9\\ud83d\\ude00\"}]", &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, recordCount);
+    ASSERT_ARE_EQUAL(char_ptr, "a\"b\\c/d\te\xC3\xA9\xF0\x9F\x98\x80", g_records[0].deviceId);
+
+    ///cleanup
+    free(copy);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_007: [ Fields that are not present in the record shall be NULL, correlationId shall be set to an empty string. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_leaves_missing_and_null_fields_NULL)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+
+    ///act
+    int result = parse("[{},{\"deviceId\":null,\"description\":null}]", &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 2, recordCount);
+    ASSERT_IS_NULL(g_records[0].deviceId);
+    ASSERT_IS_NULL(g_records[0].generationId);
+    ASSERT_IS_NULL(g_records[0].description);
+    ASSERT_IS_NULL(g_records[0].enqueuedTimeUtc);
+    ASSERT_IS_NULL(g_records[0].originalMessageId);
+    ASSERT_ARE_EQUAL(char_ptr, "", g_records[0].correlationId);
+    ASSERT_IS_NULL(g_records[1].deviceId);
+    ASSERT_IS_NULL(g_records[1].description);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN, g_records[1].statusCode);
+
+    ///cleanup
+    free(copy);
+}
+
+/*Tests_SRS_IOTHUB_SC_FEEDBACK_PARSER_02_008: [ The description shall be converted to lower case in place and the statusCode shall be set from it: "success" to IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS, "expired" to IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, "deliverycountexceeded" to IOTHUB_FEEDBACK_STATUS_CODE_DELIVER_COUNT_EXCEEDED, "rejected" to IOTHUB_FEEDBACK_STATUS_CODE_REJECTED and anything else, including a missing description, to IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN. ]*/
+TEST_FUNCTION(IoTHubScFeedbackParser_Parse_maps_the_description_to_the_status_code)
+{
+    ///arrange
+    char* copy;
+    size_t recordCount;
+
+    ///act
+    int result = parse("[{\"description\":\"SUCCESS\"},{\"description\":\"Expired\"},{\"description\":\"DeliveryCountExceeded\"},{\"description\":\"rejected\"},{\"description\":\"Purged\"},{}]", &copy, &recordCount);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 6, recordCount);
+    ASSERT_ARE_EQUAL(char_ptr, "success", g_records[0].description);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_SUCCESS, g_records[0].statusCode);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_EXPIRED, g_records[1].statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, "deliverycountexceeded", g_records[2].description);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_DELIVER_COUNT_EXCEEDED, g_records[2].statusCode);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_REJECTED, g_records[3].statusCode);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN, g_records[4].statusCode);
+    ASSERT_ARE_EQUAL(int, IOTHUB_FEEDBACK_STATUS_CODE_UNKNOWN, g_records[5].statusCode);
+
+    ///cleanup
+    free(copy);
+}
+
+END_TEST_SUITE(iothub_sc_feedback_parser_ut)
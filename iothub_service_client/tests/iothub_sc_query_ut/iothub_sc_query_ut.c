@@ -0,0 +1,450 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t l = strlen(source);
+    *destination = (char*)my_gballoc_malloc(l + 1);
+    strcpy(*destination, source);
+    return 0;
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "iothub_sc_connection_pool.h"
+#undef ENABLE_MOCKS
+
+#include "iothub_sc_query.h"
+
+TEST_DEFINE_ENUM_TYPE(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static const char* TEST_RELATIVE_PATH = "/devices/query?api-version=2017-11-08-preview";
+static const char* TEST_CONTINUATION_TOKEN = "theContinuationToken";
+static const char* TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT = "x-ms-max-item-count";
+static const char* TEST_HTTP_HEADER_KEY_CONTINUATION = "x-ms-continuation";
+
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4141;
+static BUFFER_HANDLE TEST_PAGE_BUFFER = (BUFFER_HANDLE)0x4242;
+static BUFFER_HANDLE TEST_REQUEST_BODY = (BUFFER_HANDLE)0x4343;
+static HTTP_HEADERS_HANDLE TEST_REQUEST_HEADERS = (HTTP_HEADERS_HANDLE)0x4444;
+static HTTP_HEADERS_HANDLE TEST_RESPONSE_HEADERS = (HTTP_HEADERS_HANDLE)0x4545;
+
+static const unsigned int httpStatusCodeOk = 200;
+static const unsigned int httpStatusCodeBadRequest = 400;
+
+static size_t g_createRequestHeaders_call_count;
+static size_t g_result_count;
+static size_t g_result_stop_at;
+static char g_last_result[64];
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+static HTTP_HEADERS_HANDLE testCreateRequestHeaders(void)
+{
+    g_createRequestHeaders_call_count++;
+    return TEST_REQUEST_HEADERS;
+}
+
+static int testResultCallback(void* context, const char* resultJson)
+{
+    (void)context;
+    g_result_count++;
+    (void)strncpy(g_last_result, resultJson, sizeof(g_last_result) - 1);
+    return (g_result_count == g_result_stop_at) ? 1 : 0;
+}
+
+static void set_expected_calls_for_page_request(const char* requestToken, const unsigned int* httpStatusCode, const char* nextToken)
+{
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(TEST_REQUEST_HEADERS, TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT, "10"));
+    if (requestToken != NULL)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(TEST_REQUEST_HEADERS, TEST_HTTP_HEADER_KEY_CONTINUATION, requestToken));
+    }
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, TEST_REQUEST_HEADERS, TEST_REQUEST_BODY, IGNORED_PTR_ARG, TEST_RESPONSE_HEADERS, TEST_PAGE_BUFFER))
+        .CopyOutArgumentBuffer_statusCode(httpStatusCode, sizeof(*httpStatusCode));
+    if (*httpStatusCode < 300)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(TEST_RESPONSE_HEADERS, TEST_HTTP_HEADER_KEY_CONTINUATION))
+            .SetReturn(nextToken);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        if (nextToken != NULL)
+        {
+            STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, nextToken));
+        }
+    }
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_RESPONSE_HEADERS));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_REQUEST_HEADERS));
+}
+
+static void set_expected_calls_for_ParsePage(unsigned char* page, size_t pageLength)
+{
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_PAGE_BUFFER))
+        .SetReturn(page);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_PAGE_BUFFER))
+        .SetReturn(pageLength);
+}
+
+static IOTHUB_SC_QUERY_RESULT parse_page(const char* text, bool* isStopped)
+{
+    unsigned char page[128];
+    size_t pageLength = strlen(text);
+
+    ASSERT_IS_TRUE(pageLength < sizeof(page));
+    (void)memcpy(page, text, pageLength + 1);
+    set_expected_calls_for_ParsePage(page, pageLength);
+
+    IOTHUB_SC_QUERY_RESULT result = IoTHubScQuery_ParsePage(TEST_PAGE_BUFFER, testResultCallback, NULL, isStopped);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, text, (const char*)page);
+    return result;
+}
+
+BEGIN_TEST_SUITE(iothub_sc_query_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    int result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SC_CONNECTION_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, 42);
+
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_new, TEST_PAGE_BUFFER);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_new, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_Alloc, TEST_RESPONSE_HEADERS);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_Alloc, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_FindHeaderValue, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubScConnectionPool_ExecuteRequest, HTTPAPIEX_ERROR);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_createRequestHeaders_call_count = 0;
+    g_result_count = 0;
+    g_result_stop_at = 0;
+    memset(g_last_result, 0, sizeof(g_last_result));
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_001: [ If connectionPool, relativePath, createRequestHeaders or resultCallback is NULL, or pageSize is 0, IoTHubScQuery_Execute shall fail and return IOTHUB_SC_QUERY_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubScQuery_Execute_with_invalid_arguments_fails)
+{
+    ///act
+    IOTHUB_SC_QUERY_RESULT nullPool = IoTHubScQuery_Execute(NULL, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+    IOTHUB_SC_QUERY_RESULT nullPath = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, NULL, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+    IOTHUB_SC_QUERY_RESULT nullHeaders = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, NULL, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+    IOTHUB_SC_QUERY_RESULT nullCallback = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, NULL, NULL);
+    IOTHUB_SC_QUERY_RESULT zeroPageSize = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 0, testResultCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullPool);
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullPath);
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullHeaders);
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullCallback);
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, zeroPageSize);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_002: [ IoTHubScQuery_Execute shall create a single response buffer that is reused for every page. ]*/
+/*Tests_SRS_IOTHUB_SC_QUERY_02_003: [ For every page IoTHubScQuery_Execute shall create the request headers by calling createRequestHeaders and add the x-ms-max-item-count header set to pageSize and, except for the first page, the x-ms-continuation header set to the token returned with the previous page. ]*/
+/*Tests_SRS_IOTHUB_SC_QUERY_02_004: [ IoTHubScQuery_Execute shall execute every page request by calling IoTHubScConnectionPool_ExecuteRequest with requestType, relativePath and requestBody, receiving every page in the same buffer. ]*/
+/*Tests_SRS_IOTHUB_SC_QUERY_02_006: [ IoTHubScQuery_Execute shall keep requesting pages while the response carries an x-ms-continuation header. ]*/
+/*Tests_SRS_IOTHUB_SC_QUERY_02_007: [ IoTHubScQuery_Execute shall hand every page to IoTHubScQuery_ParsePage and, if resultCallback stops it, return IOTHUB_SC_QUERY_OK without requesting further pages. ]*/
+TEST_FUNCTION(IoTHubScQuery_Execute_requests_pages_with_continuation_token)
+{
+    ///arrange
+    unsigned char firstPage[] = "[{\"id\":\"a\"},{\"id\":\"b\"}]";
+    unsigned char lastPage[] = "[{\"id\":\"c\"}]";
+
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_page_request(NULL, &httpStatusCodeOk, TEST_CONTINUATION_TOKEN);
+    set_expected_calls_for_ParsePage(firstPage, sizeof(firstPage) - 1);
+    set_expected_calls_for_page_request(TEST_CONTINUATION_TOKEN, &httpStatusCodeOk, NULL);
+    set_expected_calls_for_ParsePage(lastPage, sizeof(lastPage) - 1);
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_PAGE_BUFFER));
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, g_createRequestHeaders_call_count);
+    ASSERT_ARE_EQUAL(size_t, 3, g_result_count);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"id\":\"c\"}", g_last_result);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_007: [ IoTHubScQuery_Execute shall hand every page to IoTHubScQuery_ParsePage and, if resultCallback stops it, return IOTHUB_SC_QUERY_OK without requesting further pages. ]*/
+TEST_FUNCTION(IoTHubScQuery_Execute_stops_when_the_callback_returns_non_zero)
+{
+    ///arrange
+    unsigned char page[] = "[{\"id\":\"a\"},{\"id\":\"b\"}]";
+    g_result_stop_at = 1;
+
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_page_request(NULL, &httpStatusCodeOk, TEST_CONTINUATION_TOKEN);
+    set_expected_calls_for_ParsePage(page, sizeof(page) - 1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_PAGE_BUFFER));
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_result_count);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"id\":\"a\"}", g_last_result);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_005: [ If a request fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_HTTPAPI_ERROR, if its status code is 300 or above it shall return IOTHUB_SC_QUERY_HTTP_STATUS_ERROR. ]*/
+TEST_FUNCTION(IoTHubScQuery_Execute_returns_HTTP_STATUS_ERROR_for_a_failed_page)
+{
+    ///arrange
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    set_expected_calls_for_page_request(NULL, &httpStatusCodeBadRequest, NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_PAGE_BUFFER));
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_HTTP_STATUS_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_result_count);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_005: [ If a request fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_HTTPAPI_ERROR, if its status code is 300 or above it shall return IOTHUB_SC_QUERY_HTTP_STATUS_ERROR. ]*/
+TEST_FUNCTION(IoTHubScQuery_Execute_returns_HTTPAPI_ERROR_when_the_request_fails)
+{
+    ///arrange
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(TEST_REQUEST_HEADERS, TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT, "10"));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, TEST_REQUEST_HEADERS, TEST_REQUEST_BODY, IGNORED_PTR_ARG, TEST_RESPONSE_HEADERS, TEST_PAGE_BUFFER))
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_RESPONSE_HEADERS));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_REQUEST_HEADERS));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_PAGE_BUFFER));
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_HTTPAPI_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_008: [ If any other call fails IoTHubScQuery_Execute shall return IOTHUB_SC_QUERY_ERROR. ]*/
+TEST_FUNCTION(IoTHubScQuery_Execute_returns_ERROR_when_the_continuation_token_cannot_be_copied)
+{
+    ///arrange
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(TEST_REQUEST_HEADERS, TEST_HTTP_HEADER_KEY_MAX_ITEM_COUNT, "10"));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(IoTHubScConnectionPool_ExecuteRequest(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, TEST_REQUEST_HEADERS, TEST_REQUEST_BODY, IGNORED_PTR_ARG, TEST_RESPONSE_HEADERS, TEST_PAGE_BUFFER))
+        .CopyOutArgumentBuffer_statusCode(&httpStatusCodeOk, sizeof(httpStatusCodeOk));
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(TEST_RESPONSE_HEADERS, TEST_HTTP_HEADER_KEY_CONTINUATION))
+        .SetReturn(TEST_CONTINUATION_TOKEN);
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_CONTINUATION_TOKEN))
+        .SetReturn(42);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_RESPONSE_HEADERS));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_REQUEST_HEADERS));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_PAGE_BUFFER));
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = IoTHubScQuery_Execute(TEST_CONNECTION_POOL_HANDLE, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, testCreateRequestHeaders, TEST_REQUEST_BODY, 10, testResultCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_009: [ If pageBuffer, resultCallback or isStopped is NULL then IoTHubScQuery_ParsePage shall fail and return IOTHUB_SC_QUERY_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubScQuery_ParsePage_with_invalid_arguments_fails)
+{
+    ///arrange
+    bool isStopped = false;
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT nullBuffer = IoTHubScQuery_ParsePage(NULL, testResultCallback, NULL, &isStopped);
+    IOTHUB_SC_QUERY_RESULT nullCallback = IoTHubScQuery_ParsePage(TEST_PAGE_BUFFER, NULL, NULL, &isStopped);
+    IOTHUB_SC_QUERY_RESULT nullIsStopped = IoTHubScQuery_ParsePage(TEST_PAGE_BUFFER, testResultCallback, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullBuffer);
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullCallback);
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_INVALID_ARG, nullIsStopped);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_011: [ IoTHubScQuery_ParsePage shall call resultCallback with the NUL terminated JSON text of every object of the page, in order, as soon as the object is found. ]*/
+TEST_FUNCTION(IoTHubScQuery_ParsePage_hands_nested_objects_and_strings_to_the_callback_and_restores_the_page)
+{
+    ///arrange
+    bool isStopped = false;
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = parse_page(" [ {\"a\":{\"b\":[1,2]}} ,\n{\"s\":\"}]\\\"\"} ] ", &isStopped);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_OK, result);
+    ASSERT_IS_FALSE(isStopped);
+    ASSERT_ARE_EQUAL(size_t, 2, g_result_count);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"s\":\"}]\\\"\"}", g_last_result);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_011: [ IoTHubScQuery_ParsePage shall call resultCallback with the NUL terminated JSON text of every object of the page, in order, as soon as the object is found. ]*/
+TEST_FUNCTION(IoTHubScQuery_ParsePage_with_an_empty_array_succeeds)
+{
+    ///arrange
+    bool isStopped = false;
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = parse_page("[]", &isStopped);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 0, g_result_count);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_012: [ If resultCallback returns a non-zero value IoTHubScQuery_ParsePage shall set *isStopped to true and return IOTHUB_SC_QUERY_OK without reading the rest of the page. ]*/
+TEST_FUNCTION(IoTHubScQuery_ParsePage_stops_when_the_callback_returns_non_zero)
+{
+    ///arrange
+    bool isStopped = false;
+    g_result_stop_at = 1;
+
+    ///act
+    IOTHUB_SC_QUERY_RESULT result = parse_page("[{\"id\":\"a\"},not json", &isStopped);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_OK, result);
+    ASSERT_IS_TRUE(isStopped);
+    ASSERT_ARE_EQUAL(size_t, 1, g_result_count);
+}
+
+/*Tests_SRS_IOTHUB_SC_QUERY_02_010: [ If the page is not a JSON array of objects, optionally surrounded by whitespace, IoTHubScQuery_ParsePage shall return IOTHUB_SC_QUERY_JSON_ERROR. ]*/
+TEST_FUNCTION(IoTHubScQuery_ParsePage_with_malformed_pages_returns_JSON_ERROR)
+{
+    ///arrange
+    const char* malformedPages[] =
+    {
+        "{\"id\":\"a\"}",
+        "[",
+        "[{\"id\":\"a\"}",
+        "[{\"id\":\"a\"} {\"id\":\"b\"}]",
+        "[1,2]",
+        "[{\"id\":\"a\"",
+        "   "
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(malformedPages) / sizeof(malformedPages[0]); i++)
+    {
+        bool isStopped = false;
+        umock_c_reset_all_calls();
+
+        ///act
+        IOTHUB_SC_QUERY_RESULT result = parse_page(malformedPages[i], &isStopped);
+
+        ///assert
+        ASSERT_ARE_EQUAL(IOTHUB_SC_QUERY_RESULT, IOTHUB_SC_QUERY_JSON_ERROR, result);
+    }
+}
+
+END_TEST_SUITE(iothub_sc_query_ut)
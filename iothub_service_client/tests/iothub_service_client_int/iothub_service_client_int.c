@@ -0,0 +1,518 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*runs the service client against an in-process httpapiex standing in for IoT Hub, so that the pooled connections,
+the timeout set on them and the worker threads of the asynchronous calls are exercised with real threads and
+sleeps instead of mocks, and so that the paged enumerations can be run over fleets far larger than a unit test
+would script*/
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/httpheaders.h"
+
+#include "iothub_service_client_auth.h"
+#include "iothub_devicemethod.h"
+#include "iothub_registrymanager.h"
+
+TEST_DEFINE_ENUM_TYPE(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(IOTHUB_REGISTRYMANAGER_RESULT, IOTHUB_REGISTRYMANAGER_RESULT_VALUES);
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+static TICK_COUNTER_HANDLE g_tick_counter;
+static LOCK_HANDLE g_lock;
+
+static const char* TEST_CONNECTION_STRING = "HostName=int.azure-devices.net;SharedAccessKeyName=iothubowner;SharedAccessKey=dGVzdGtleWZvcmludGVncmF0aW9u";
+static const char* TEST_METHOD_NAME = "reboot";
+static const char* TEST_METHOD_PAYLOAD = "{}";
+static const char* TEST_METHOD_REPLY_FMT = "{\"status\":200,\"payload\":{\"deviceId\":\"%s\"}}";
+static const char* TEST_SLOW_DEVICE_ID = "device-0";
+static const unsigned int TEST_METHOD_TIMEOUT_SECONDS = 1;
+//the client abandons a call 10 seconds after the method timeout
+static const tickcounter_ms_t TEST_CALL_DEADLINE_MS = 11000;
+static const tickcounter_ms_t TEST_DEADLINE_SLACK_MS = 2000;
+static const unsigned int TEST_REPLY_COST_MS = 20;
+#define TEST_DEVICE_COUNT           12
+#define TEST_MAX_CONCURRENT_CALLS   4
+#define TEST_DEVICE_ID_LENGTH       32
+
+//every record has the same length whatever its index, so that the memory held does not depend on which page is read
+static const char* TEST_QUERY_DEVICE_RECORD_FMT = "{\"deviceId\":\"device-%08lu\",\"etag\":\"AAAAAAAAAAE=\",\"status\":\"enabled\",\"authenticationType\":\"sas\",\"connectionState\":\"Disconnected\",\"cloudToDeviceMessageCount\":0,\"version\":2,\"properties\":{\"desired\":{},\"reported\":{}}}";
+static const char* TEST_QUERY_MODULE_RECORD_FMT = "{\"deviceId\":\"device-%08lu\",\"moduleId\":\"module\",\"etag\":\"AAAAAAAAAAE=\",\"status\":\"enabled\",\"authenticationType\":\"sas\",\"connectionState\":\"Disconnected\",\"cloudToDeviceMessageCount\":0,\"version\":2,\"properties\":{\"desired\":{},\"reported\":{}}}";
+static const char* TEST_QUERY_CONTINUATION_FMT = "%08lu";
+static const size_t TEST_QUERY_PAGE_SIZE = 100;
+static const size_t TEST_SMALL_FLEET = 1000;
+static const size_t TEST_LARGE_FLEET = 50000;
+
+//what the service does, reset before every test
+static struct
+{
+    size_t connections_created;
+    size_t requests_received;
+    size_t requests_without_timeout;
+    unsigned int last_timeout_set_ms;
+    //time the service spends on every reply
+    unsigned int reply_cost_ms;
+    //this device never answers, its requests only end when the connection times out
+    const char* slow_device_id;
+    //number of records the query API returns
+    size_t query_record_count;
+    size_t query_requests_received;
+    //a page was requested with a continuation token that was not the one of the previous page
+    size_t query_requests_out_of_order;
+    size_t query_next_record;
+    bool query_is_modules;
+} g_service;
+
+//what the client reported, reset before every test
+static struct
+{
+    size_t count;
+    char device_ids[TEST_DEVICE_COUNT][TEST_DEVICE_ID_LENGTH];
+    IOTHUB_DEVICE_METHOD_RESULT results[TEST_DEVICE_COUNT];
+    int statuses[TEST_DEVICE_COUNT];
+    tickcounter_ms_t completed_ms[TEST_DEVICE_COUNT];
+    //enumerations
+    size_t records;
+    size_t records_out_of_order;
+    size_t records_with_keys;
+    size_t records_without_module;
+    //memory held by the client, sampled whenever it hands something back to the test
+    size_t peak_memory;
+} g_calls;
+
+//the in-process httpapiex
+typedef struct HTTPAPIEX_HANDLE_DATA_TAG
+{
+    unsigned int timeout_ms;
+} HTTPAPIEX_HANDLE_DATA;
+
+static tickcounter_ms_t now_ms(void)
+{
+    tickcounter_ms_t result;
+    ASSERT_ARE_EQUAL(int, 0, tickcounter_get_current_ms(g_tick_counter, &result));
+    return result;
+}
+
+HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
+{
+    HTTPAPIEX_HANDLE_DATA* result;
+    (void)hostName;
+    if ((result = (HTTPAPIEX_HANDLE_DATA*)calloc(1, sizeof(HTTPAPIEX_HANDLE_DATA))) != NULL)
+    {
+        ASSERT_ARE_EQUAL(int, LOCK_OK, Lock(g_lock));
+        g_service.connections_created++;
+        (void)Unlock(g_lock);
+    }
+    return result;
+}
+
+void HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
+{
+    free(handle);
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_SetOption(HTTPAPIEX_HANDLE handle, const char* optionName, const void* value)
+{
+    if (strcmp(optionName, OPTION_HTTP_TIMEOUT) == 0)
+    {
+        handle->timeout_ms = *(const unsigned int*)value;
+        ASSERT_ARE_EQUAL(int, LOCK_OK, Lock(g_lock));
+        g_service.last_timeout_set_ms = handle->timeout_ms;
+        (void)Unlock(g_lock);
+    }
+    return HTTPAPIEX_OK;
+}
+
+static void sample_memory(void)
+{
+    size_t current = gballoc_getCurrentMemoryUsed();
+    if (current > g_calls.peak_memory)
+    {
+        g_calls.peak_memory = current;
+    }
+}
+
+//POST /devices/query, the continuation token is the index of the first record of the page
+static HTTPAPIEX_RESULT reply_to_query(HTTPAPI_REQUEST_TYPE requestType, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    const char* continuation = HTTPHeaders_FindHeaderValue(requestHttpHeadersHandle, "x-ms-continuation");
+    const char* maxItemCount = HTTPHeaders_FindHeaderValue(requestHttpHeadersHandle, "x-ms-max-item-count");
+    const char* record_format = g_service.query_is_modules ? TEST_QUERY_MODULE_RECORD_FMT : TEST_QUERY_DEVICE_RECORD_FMT;
+    size_t first = (continuation == NULL) ? 0 : (size_t)strtoul(continuation, NULL, 10);
+    size_t count;
+    size_t record_length = strlen(record_format) + 8;
+    char* page;
+    size_t length;
+
+    ASSERT_ARE_EQUAL(int, HTTPAPI_REQUEST_POST, requestType);
+    ASSERT_IS_NOT_NULL(maxItemCount);
+    count = (size_t)strtoul(maxItemCount, NULL, 10);
+    if (first + count > g_service.query_record_count)
+    {
+        count = g_service.query_record_count - first;
+    }
+
+    g_service.query_requests_received++;
+    if (first != g_service.query_next_record)
+    {
+        g_service.query_requests_out_of_order++;
+    }
+    g_service.query_next_record = first + count;
+
+    page = (char*)malloc(2 + count * (record_length + 1));
+    ASSERT_IS_NOT_NULL(page);
+    length = 0;
+    page[length++] = '[';
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i > 0)
+        {
+            page[length++] = ',';
+        }
+        length += (size_t)sprintf(page + length, record_format, (unsigned long)(first + i));
+    }
+    page[length++] = ']';
+    ASSERT_ARE_EQUAL(int, 0, BUFFER_build(responseContent, (const unsigned char*)page, length));
+    free(page);
+
+    if (first + count < g_service.query_record_count)
+    {
+        char next[16];
+        (void)sprintf(next, TEST_QUERY_CONTINUATION_FMT, (unsigned long)(first + count));
+        ASSERT_ARE_EQUAL(int, HTTP_HEADERS_OK, HTTPHeaders_AddHeaderNameValuePair(responseHttpHeadersHandle, "x-ms-continuation", next));
+    }
+
+    //the whole page is now held by the client
+    sample_memory();
+    *statusCode = 200;
+    return HTTPAPIEX_OK;
+}
+
+//POST /twins/<deviceId>/methods
+static HTTPAPIEX_RESULT reply_to_method(HTTPAPIEX_HANDLE handle, const char* relativePath, unsigned int* statusCode, BUFFER_HANDLE responseContent)
+{
+    HTTPAPIEX_RESULT result;
+    char deviceId[TEST_DEVICE_ID_LENGTH];
+    const char* begin;
+    const char* end;
+    bool is_slow;
+
+    //"/twins/<deviceId>/methods?api-version=..."
+    ASSERT_ARE_EQUAL(int, 0, strncmp(relativePath, "/twins/", 7));
+    begin = relativePath + 7;
+    end = strchr(begin, '/');
+    ASSERT_IS_NOT_NULL(end);
+    ASSERT_IS_TRUE((size_t)(end - begin) < sizeof(deviceId));
+    (void)memcpy(deviceId, begin, end - begin);
+    deviceId[end - begin] = '\0';
+
+    ASSERT_ARE_EQUAL(int, LOCK_OK, Lock(g_lock));
+    g_service.requests_received++;
+    if (handle->timeout_ms == 0)
+    {
+        g_service.requests_without_timeout++;
+    }
+    is_slow = (g_service.slow_device_id != NULL) && (strcmp(deviceId, g_service.slow_device_id) == 0);
+    (void)Unlock(g_lock);
+
+    if (is_slow && (handle->timeout_ms != 0))
+    {
+        //the device does not answer, the request fails when the timeout set on the connection expires
+        tickcounter_ms_t start = now_ms();
+        while (now_ms() - start < handle->timeout_ms)
+        {
+            ThreadAPI_Sleep(10);
+        }
+        result = HTTPAPIEX_ERROR;
+    }
+    else
+    {
+        char reply[128];
+        int length = sprintf(reply, TEST_METHOD_REPLY_FMT, deviceId);
+
+        ThreadAPI_Sleep(g_service.reply_cost_ms);
+        ASSERT_ARE_EQUAL(int, 0, BUFFER_build(responseContent, (const unsigned char*)reply, (size_t)length));
+        *statusCode = 200;
+        result = HTTPAPIEX_OK;
+    }
+    return result;
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    HTTPAPIEX_RESULT result;
+    (void)requestContent;
+
+    if (strncmp(relativePath, "/devices/query", 14) == 0)
+    {
+        result = reply_to_query(requestType, requestHttpHeadersHandle, statusCode, responseHttpHeadersHandle, responseContent);
+    }
+    else
+    {
+        ASSERT_ARE_EQUAL(int, HTTPAPI_REQUEST_POST, requestType);
+        result = reply_to_method(handle, relativePath, statusCode, responseContent);
+    }
+    return result;
+}
+
+static void on_method_invoked(void* context, const char* deviceId, IOTHUB_DEVICE_METHOD_RESULT result, int responseStatus, const unsigned char* responsePayload, size_t responsePayloadSize)
+{
+    (void)context;
+    (void)responsePayload;
+    (void)responsePayloadSize;
+
+    ASSERT_ARE_EQUAL(int, LOCK_OK, Lock(g_lock));
+    ASSERT_IS_TRUE(g_calls.count < TEST_DEVICE_COUNT);
+    ASSERT_IS_TRUE(strlen(deviceId) < TEST_DEVICE_ID_LENGTH);
+    (void)strcpy(g_calls.device_ids[g_calls.count], deviceId);
+    g_calls.results[g_calls.count] = result;
+    g_calls.statuses[g_calls.count] = responseStatus;
+    g_calls.completed_ms[g_calls.count] = now_ms();
+    g_calls.count++;
+    (void)Unlock(g_lock);
+}
+
+static void on_enumerated(const char* deviceId, const char* moduleId, const char* primaryKey, const char* secondaryKey)
+{
+    char expected[TEST_DEVICE_ID_LENGTH];
+
+    (void)sprintf(expected, "device-%08lu", (unsigned long)g_calls.records);
+    if ((deviceId == NULL) || (strcmp(deviceId, expected) != 0))
+    {
+        g_calls.records_out_of_order++;
+    }
+    if ((primaryKey != NULL) || (secondaryKey != NULL))
+    {
+        g_calls.records_with_keys++;
+    }
+    if (g_service.query_is_modules && ((moduleId == NULL) || (strcmp(moduleId, "module") != 0)))
+    {
+        g_calls.records_without_module++;
+    }
+    g_calls.records++;
+    sample_memory();
+}
+
+static int on_device_enumerated(void* context, const IOTHUB_DEVICE_EX* device)
+{
+    (void)context;
+    on_enumerated(device->deviceId, NULL, device->primaryKey, device->secondaryKey);
+    return 0;
+}
+
+static int on_module_enumerated(void* context, const IOTHUB_MODULE* module)
+{
+    (void)context;
+    on_enumerated(module->deviceId, module->moduleId, module->primaryKey, module->secondaryKey);
+    return 0;
+}
+
+//enumerates a fleet of recordCount records and returns the most memory the client held above what it held before
+static size_t enumerate_fleet(IOTHUB_REGISTRYMANAGER_HANDLE registryManager, size_t recordCount, bool isModules)
+{
+    size_t baseline;
+    IOTHUB_REGISTRYMANAGER_RESULT result;
+
+    memset(&g_calls, 0, sizeof(g_calls));
+    g_service.query_record_count = recordCount;
+    g_service.query_requests_received = 0;
+    g_service.query_requests_out_of_order = 0;
+    g_service.query_next_record = 0;
+    g_service.query_is_modules = isModules;
+
+    baseline = gballoc_getCurrentMemoryUsed();
+    g_calls.peak_memory = baseline;
+    result = isModules ?
+        IoTHubRegistryManager_EnumerateModules(registryManager, TEST_QUERY_PAGE_SIZE, IOTHUB_MODULE_VERSION_1, on_module_enumerated, NULL) :
+        IoTHubRegistryManager_EnumerateDevices(registryManager, TEST_QUERY_PAGE_SIZE, on_device_enumerated, NULL);
+
+    ASSERT_ARE_EQUAL(IOTHUB_REGISTRYMANAGER_RESULT, IOTHUB_REGISTRYMANAGER_OK, result);
+    ASSERT_ARE_EQUAL(size_t, recordCount, g_calls.records);
+    ASSERT_ARE_EQUAL(size_t, 0, g_calls.records_out_of_order);
+    ASSERT_ARE_EQUAL(size_t, 0, g_calls.records_without_module);
+    //query results are twins, they never carry keys
+    ASSERT_ARE_EQUAL(size_t, 0, g_calls.records_with_keys);
+    ASSERT_ARE_EQUAL(size_t, (recordCount + TEST_QUERY_PAGE_SIZE - 1) / TEST_QUERY_PAGE_SIZE, g_service.query_requests_received);
+    ASSERT_ARE_EQUAL(size_t, 0, g_service.query_requests_out_of_order);
+
+    return g_calls.peak_memory - baseline;
+}
+
+static size_t completed_call_count(void)
+{
+    size_t result;
+    ASSERT_ARE_EQUAL(int, LOCK_OK, Lock(g_lock));
+    result = g_calls.count;
+    (void)Unlock(g_lock);
+    return result;
+}
+
+BEGIN_TEST_SUITE(iothub_service_client_int)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+    //the client is built with its allocations measured, the measuring has to start before its first allocation
+    ASSERT_ARE_EQUAL(int, 0, gballoc_init());
+    ASSERT_ARE_EQUAL(int, 0, platform_init());
+    g_tick_counter = tickcounter_create();
+    ASSERT_IS_NOT_NULL(g_tick_counter);
+    g_lock = Lock_Init();
+    ASSERT_IS_NOT_NULL(g_lock);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    (void)Lock_Deinit(g_lock);
+    tickcounter_destroy(g_tick_counter);
+    platform_deinit();
+    gballoc_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    memset(&g_service, 0, sizeof(g_service));
+    memset(&g_calls, 0, sizeof(g_calls));
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeOnDevicesAsync_abandons_a_slow_device_at_the_deadline_while_the_others_complete)
+{
+    //arrange
+    IOTHUB_SERVICE_CLIENT_AUTH_HANDLE auth = IoTHubServiceClientAuth_CreateFromConnectionString(TEST_CONNECTION_STRING);
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE deviceMethod;
+    char deviceIdStorage[TEST_DEVICE_COUNT][TEST_DEVICE_ID_LENGTH];
+    const char* deviceIds[TEST_DEVICE_COUNT];
+    ASSERT_IS_NOT_NULL(auth);
+    deviceMethod = IoTHubDeviceMethod_Create(auth);
+    ASSERT_IS_NOT_NULL(deviceMethod);
+    for (size_t i = 0; i < TEST_DEVICE_COUNT; i++)
+    {
+        (void)sprintf(deviceIdStorage[i], "device-%lu", (unsigned long)i);
+        deviceIds[i] = deviceIdStorage[i];
+    }
+    //the slow device is the first one, its worker is blocked on it for the whole call
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SLOW_DEVICE_ID, deviceIds[0]);
+    g_service.slow_device_id = TEST_SLOW_DEVICE_ID;
+    g_service.reply_cost_ms = TEST_REPLY_COST_MS;
+
+    //act
+    tickcounter_ms_t start = now_ms();
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeOnDevicesAsync(deviceMethod, deviceIds, TEST_DEVICE_COUNT, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_METHOD_TIMEOUT_SECONDS, TEST_MAX_CONCURRENT_CALLS, on_method_invoked, NULL);
+    while ((completed_call_count() < TEST_DEVICE_COUNT) && (now_ms() - start < TEST_CALL_DEADLINE_MS + TEST_DEADLINE_SLACK_MS))
+    {
+        ThreadAPI_Sleep(10);
+    }
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(size_t, TEST_DEVICE_COUNT, completed_call_count());
+    ASSERT_ARE_EQUAL(size_t, TEST_DEVICE_COUNT, g_service.requests_received);
+    ASSERT_ARE_EQUAL(size_t, 0, g_service.requests_without_timeout);
+    ASSERT_ARE_EQUAL(int, (int)TEST_CALL_DEADLINE_MS, (int)g_service.last_timeout_set_ms);
+    //no more connections than calls in flight, the fast devices reuse the pooled ones
+    ASSERT_IS_TRUE(g_service.connections_created <= TEST_MAX_CONCURRENT_CALLS);
+
+    //every other device is reported before the slow one, well before its deadline
+    for (size_t i = 0; i < TEST_DEVICE_COUNT - 1; i++)
+    {
+        ASSERT_ARE_NOT_EQUAL(char_ptr, TEST_SLOW_DEVICE_ID, g_calls.device_ids[i]);
+        ASSERT_ARE_EQUAL(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_OK, g_calls.results[i]);
+        ASSERT_ARE_EQUAL(int, 200, g_calls.statuses[i]);
+        ASSERT_IS_TRUE(g_calls.completed_ms[i] - start < TEST_CALL_DEADLINE_MS / 2);
+    }
+
+    //the slow device is reported as failed once the deadline of its call expired
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SLOW_DEVICE_ID, g_calls.device_ids[TEST_DEVICE_COUNT - 1]);
+    ASSERT_ARE_EQUAL(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_ERROR, g_calls.results[TEST_DEVICE_COUNT - 1]);
+    ASSERT_IS_TRUE(g_calls.completed_ms[TEST_DEVICE_COUNT - 1] - start >= TEST_CALL_DEADLINE_MS);
+    ASSERT_IS_TRUE(g_calls.completed_ms[TEST_DEVICE_COUNT - 1] - start < TEST_CALL_DEADLINE_MS + TEST_DEADLINE_SLACK_MS);
+
+    //cleanup
+    IoTHubDeviceMethod_Destroy(deviceMethod);
+    IoTHubServiceClientAuth_Destroy(auth);
+}
+
+TEST_FUNCTION(IoTHubRegistryManager_EnumerateDevices_peak_memory_does_not_depend_on_the_fleet_size)
+{
+    //arrange
+    IOTHUB_SERVICE_CLIENT_AUTH_HANDLE auth = IoTHubServiceClientAuth_CreateFromConnectionString(TEST_CONNECTION_STRING);
+    IOTHUB_REGISTRYMANAGER_HANDLE registryManager;
+    ASSERT_IS_NOT_NULL(auth);
+    registryManager = IoTHubRegistryManager_Create(auth);
+    ASSERT_IS_NOT_NULL(registryManager);
+    //the pool creates its SAS token and its connection on the first request, they are not part of what is measured
+    (void)enumerate_fleet(registryManager, TEST_QUERY_PAGE_SIZE, false);
+
+    //act
+    size_t small_fleet_peak = enumerate_fleet(registryManager, TEST_SMALL_FLEET, false);
+    size_t large_fleet_peak = enumerate_fleet(registryManager, TEST_LARGE_FLEET, false);
+
+    //assert
+    ASSERT_IS_TRUE(small_fleet_peak > 0);
+    ASSERT_ARE_EQUAL(size_t, small_fleet_peak, large_fleet_peak);
+
+    //cleanup
+    IoTHubRegistryManager_Destroy(registryManager);
+    IoTHubServiceClientAuth_Destroy(auth);
+}
+
+TEST_FUNCTION(IoTHubRegistryManager_EnumerateModules_peak_memory_does_not_depend_on_the_fleet_size)
+{
+    //arrange
+    IOTHUB_SERVICE_CLIENT_AUTH_HANDLE auth = IoTHubServiceClientAuth_CreateFromConnectionString(TEST_CONNECTION_STRING);
+    IOTHUB_REGISTRYMANAGER_HANDLE registryManager;
+    ASSERT_IS_NOT_NULL(auth);
+    registryManager = IoTHubRegistryManager_Create(auth);
+    ASSERT_IS_NOT_NULL(registryManager);
+    //the pool creates its SAS token and its connection on the first request, they are not part of what is measured
+    (void)enumerate_fleet(registryManager, TEST_QUERY_PAGE_SIZE, true);
+
+    //act
+    size_t small_fleet_peak = enumerate_fleet(registryManager, TEST_SMALL_FLEET, true);
+    size_t large_fleet_peak = enumerate_fleet(registryManager, TEST_LARGE_FLEET, true);
+
+    //assert
+    ASSERT_IS_TRUE(small_fleet_peak > 0);
+    ASSERT_ARE_EQUAL(size_t, small_fleet_peak, large_fleet_peak);
+
+    //cleanup
+    IoTHubRegistryManager_Destroy(registryManager);
+    IoTHubServiceClientAuth_Destroy(auth);
+}
+
+END_TEST_SUITE(iothub_service_client_int)
@@ -56,6 +56,8 @@ static STRING_TOKENIZER_HANDLE TEST_STRING_TOKENIZER_HANDLE_NULL = (STRING_TOKEN
 static STRING_HANDLE TEST_KEY_STRING_HANDLE = (STRING_HANDLE)0x4545;
 static STRING_HANDLE TEST_VALUE_STRING_HANDLE = (STRING_HANDLE)0x4646;
 
+static IOTHUB_SC_CONNECTION_POOL_HANDLE TEST_CONNECTION_POOL_HANDLE = (IOTHUB_SC_CONNECTION_POOL_HANDLE)0x4747;
+
 static const char* TEST_CHAR_PTR = "TestString";
 static const char* TEST_CONNECTION_STRING = "HostName=aaa.bbb.net;SharedAccessKeyName=xxx;SharedAccessKey=yyy";
 static size_t currentmalloc_call;
@@ -129,6 +131,12 @@ public:
     /* Connection string parser mock */
     MOCK_STATIC_METHOD_1(, MAP_HANDLE, connectionstringparser_parse, STRING_HANDLE, connectionString)
     MOCK_METHOD_END(MAP_HANDLE, TEST_MAP_HANDLE);
+
+    /* Connection pool mocks */
+    MOCK_STATIC_METHOD_4(, IOTHUB_SC_CONNECTION_POOL_HANDLE, IoTHubScConnectionPool_Create, const char*, hostname, const char*, sharedAccessKey, const char*, keyName, const char*, deviceId)
+    MOCK_METHOD_END(IOTHUB_SC_CONNECTION_POOL_HANDLE, TEST_CONNECTION_POOL_HANDLE);
+    MOCK_STATIC_METHOD_1(, void, IoTHubScConnectionPool_Destroy, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool)
+    MOCK_VOID_METHOD_END();
 };
 
 
@@ -154,6 +162,9 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubServiceClientAuthMocks, , void, STRING_TOKEN
 
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubServiceClientAuthMocks, , MAP_HANDLE, connectionstringparser_parse, STRING_HANDLE, connectionString);
 
+DECLARE_GLOBAL_MOCK_METHOD_4(CIoTHubServiceClientAuthMocks, , IOTHUB_SC_CONNECTION_POOL_HANDLE, IoTHubScConnectionPool_Create, const char*, hostname, const char*, sharedAccessKey, const char*, keyName, const char*, deviceId);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubServiceClientAuthMocks, , void, IoTHubScConnectionPool_Destroy, IOTHUB_SC_CONNECTION_POOL_HANDLE, connectionPool);
+
 static void set_expected_calls_for_free_service_client_auth(CIoTHubServiceClientAuthMocks &mocks)
 {
     (void)mocks;
@@ -169,6 +180,8 @@ static void set_expected_calls_for_free_service_client_auth(CIoTHubServiceClient
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mocks, IoTHubScConnectionPool_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 }
@@ -1249,6 +1262,8 @@ static void test_IoTHubServiceClientAuth_CreateFromConnectionString_impl(bool se
     
     EXPECTED_CALL(mocks, mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .SetReturn(0);
+
+    EXPECTED_CALL(mocks, IoTHubScConnectionPool_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     
     set_expected_calls_for_CreateFromConnectionString_cleanup(mocks);
 
@@ -1257,6 +1272,7 @@ static void test_IoTHubServiceClientAuth_CreateFromConnectionString_impl(bool se
 
     // assert
     ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_CONNECTION_POOL_HANDLE, (void*)result->connectionPool);
     if (result != NULL)
     {
         free(result);
@@ -1267,6 +1283,7 @@ static void test_IoTHubServiceClientAuth_CreateFromConnectionString_impl(bool se
 }
 
 /* Tests_SRS_IOTHUBSERVICECLIENT_12_006: [** If the IOTHUB_SERVICE_CLIENT_AUTH has been populated IoTHubServiceClientAuth_CreateFromConnectionString shall return with a IOTHUB_SERVICE_CLIENT_AUTH_HANDLE to it **]*/
+/* Tests_SRS_IOTHUBSERVICECLIENT_02_001: [** IoTHubServiceClientAuth_CreateFromConnectionString shall create the connection pool shared by all the service client handles created from it by calling IoTHubScConnectionPool_Create. **] */
 TEST_FUNCTION(IoTHubServiceClientAuth_CreateFromConnectionString_sharedaccesskeyname_set_succeed)
 {
     test_IoTHubServiceClientAuth_CreateFromConnectionString_impl(true, false);
@@ -1278,6 +1295,85 @@ TEST_FUNCTION(IoTHubServiceClientAuth_CreateFromConnectionString_deviceid_set_su
     test_IoTHubServiceClientAuth_CreateFromConnectionString_impl(false, true);
 }
 
+/* Tests_SRS_IOTHUBSERVICECLIENT_02_002: [** If the IoTHubScConnectionPool_Create fails, IoTHubServiceClientAuth_CreateFromConnectionString shall do clean up and return NULL. **] */
+TEST_FUNCTION(IoTHubServiceClientAuth_CreateFromConnectionString_do_clean_up_if_IoTHubScConnectionPool_Create_fails)
+{
+    // arrange
+    CIoTHubServiceClientAuthMocks mocks;
+
+    whenShallmalloc_fail = 0;
+    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(mocks, STRING_construct(TEST_CHAR_PTR));
+
+    STRICT_EXPECTED_CALL(mocks, connectionstringparser_parse(TEST_STRING_HANDLE))
+        .SetReturn(TEST_MAP_HANDLE);
+
+    STRICT_EXPECTED_CALL(mocks, Map_GetValueFromKey(TEST_MAP_HANDLE, (const char*)"SharedAccessKeyName"))
+        .SetReturn(TEST_CONST_CHAR_PTR);
+
+    STRICT_EXPECTED_CALL(mocks, Map_GetValueFromKey(TEST_MAP_HANDLE, (const char*)"DeviceId"))
+        .SetReturn(TEST_CONST_CHAR_PTR_NULL);
+
+    STRICT_EXPECTED_CALL(mocks, Map_GetValueFromKey(TEST_MAP_HANDLE, (const char*)"HostName"))
+        .SetReturn(TEST_CONST_CHAR_PTR);
+
+    STRICT_EXPECTED_CALL(mocks, Map_GetValueFromKey(TEST_MAP_HANDLE, (const char*)"SharedAccessKey"))
+        .SetReturn(TEST_CONST_CHAR_PTR);
+
+    STRICT_EXPECTED_CALL(mocks, STRING_construct(TEST_CONST_CHAR_PTR));
+
+    STRICT_EXPECTED_CALL(mocks, STRING_TOKENIZER_create(TEST_STRING_HANDLE))
+        .SetReturn(TEST_STRING_TOKENIZER_HANDLE);
+
+    STRICT_EXPECTED_CALL(mocks, STRING_new())
+        .SetReturn(TEST_STRING_HANDLE);
+
+    STRICT_EXPECTED_CALL(mocks, STRING_new())
+        .SetReturn(TEST_STRING_HANDLE);
+
+    STRICT_EXPECTED_CALL(mocks, STRING_TOKENIZER_get_next_token(TEST_STRING_TOKENIZER_HANDLE, TEST_STRING_HANDLE, "."))
+        .SetReturn(0);
+
+    STRICT_EXPECTED_CALL(mocks, STRING_TOKENIZER_get_next_token(TEST_STRING_TOKENIZER_HANDLE, TEST_STRING_HANDLE, "0"))
+        .SetReturn(0);
+
+    EXPECTED_CALL(mocks, mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(0);
+
+    EXPECTED_CALL(mocks, mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(0);
+
+    EXPECTED_CALL(mocks, mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(0);
+
+    EXPECTED_CALL(mocks, STRING_c_str(TEST_STRING_HANDLE))
+        .SetReturn(TEST_CHAR_PTR);
+
+    EXPECTED_CALL(mocks, STRING_c_str(TEST_STRING_HANDLE))
+        .SetReturn(TEST_CHAR_PTR);
+
+    EXPECTED_CALL(mocks, mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(0);
+
+    EXPECTED_CALL(mocks, mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(0);
+
+    EXPECTED_CALL(mocks, IoTHubScConnectionPool_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn((IOTHUB_SC_CONNECTION_POOL_HANDLE)NULL);
+
+    set_expected_calls_for_free_service_client_auth(mocks);
+    set_expected_calls_for_CreateFromConnectionString_cleanup(mocks);
+
+    // act
+    IOTHUB_SERVICE_CLIENT_AUTH_HANDLE result = IoTHubServiceClientAuth_CreateFromConnectionString(TEST_CHAR_PTR);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, NULL, result);
+    mocks.AssertActualAndExpectedCalls();
+}
+
 /* Tests_SRS_IOTHUBSERVICECLIENT_12_006: [** If the IOTHUB_SERVICE_CLIENT_AUTH has been populated IoTHubServiceClientAuth_CreateFromConnectionString shall return with a IOTHUB_SERVICE_CLIENT_AUTH_HANDLE to it **]*/
 TEST_FUNCTION(IoTHubServiceClientAuth_CreateFromConnectionString_sharedaccesskeyname_and_deviceid_both_set_fails)
 {
@@ -1324,6 +1420,7 @@ TEST_FUNCTION(IoTHubServiceClient_Destroy_return_if_input_parameter_serviceClien
 }
 
 /* Tests_SRS_IOTHUBSERVICECLIENT_12_008 : [** If the serviceClientHandle input parameter is not NULL IoTHubServiceClient_Destroy shall free the memory of it and return **] */
+/* Tests_SRS_IOTHUBSERVICECLIENT_02_003: [** IoTHubServiceClient_Destroy shall release its reference to the connection pool by calling IoTHubScConnectionPool_Destroy. **] */
 TEST_FUNCTION(IoTHubServiceClient_Destroy_do_clean_up_and_return_if_input_parameter_serviceClientHandle_is_not_NULL)
 {
     // arrange
@@ -1410,6 +1507,7 @@ TEST_FUNCTION(IoTHubServiceClient_Destroy_do_clean_up_and_return_if_input_parame
         .IgnoreAllArguments()
         .SetReturn(0);
 
+    EXPECTED_CALL(mocks, IoTHubScConnectionPool_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     set_expected_calls_for_free_service_client_auth(mocks);
     set_expected_calls_for_CreateFromConnectionString_cleanup(mocks);
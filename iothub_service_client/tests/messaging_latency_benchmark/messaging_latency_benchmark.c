@@ -0,0 +1,327 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*drives IoTHubMessaging_SendAsync against an in-process IoTHubMessaging_LL that completes every send on the next
+IoTHubMessaging_LL_DoWork, and prints the latency from IoTHubMessaging_SendAsync to the first IoTHubMessaging_LL_DoWork
+that sees the send (the point where the real client writes it to the socket), the burst throughput and the CPU used by
+an idle client*/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "iothub_message.h"
+#include "iothub_messaging_ll.h"
+#include "iothub_messaging.h"
+
+#define LATENCY_SAMPLES 1000
+#define LATENCY_SPACING_MILLISECONDS 3
+#define BURST_SENDS 100000
+#define IDLE_MEASURE_MILLISECONDS 2000
+#define MAX_IN_FLIGHT BURST_SENDS
+
+static double nowMicroseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000000.0 + (double)now.tv_nsec / 1000.0;
+#endif
+}
+
+/*the in-process IoTHubMessaging_LL, only ever called by iothub_messaging.c under its lock*/
+typedef struct FAKE_SEND_TAG
+{
+    IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback;
+    void* userContextCallback;
+} FAKE_SEND;
+
+typedef struct IOTHUB_MESSAGING_TAG
+{
+    FAKE_SEND inFlight[MAX_IN_FLIGHT];
+    size_t inFlightCount;
+    unsigned long doWorkCount;
+} IOTHUB_MESSAGING;
+
+static IOTHUB_MESSAGING fakeMessaging;
+
+/*filled by IoTHubMessaging_LL_DoWork, index is the user context of the send*/
+static double enqueueTimes[LATENCY_SAMPLES];
+static double latencies[LATENCY_SAMPLES];
+static int recordLatency;
+
+static LOCK_HANDLE completionLock;
+static size_t completedSends;
+
+IOTHUB_MESSAGING_HANDLE IoTHubMessaging_LL_Create(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE serviceClientHandle)
+{
+    (void)serviceClientHandle;
+    (void)memset(&fakeMessaging, 0, sizeof(fakeMessaging));
+    return &fakeMessaging;
+}
+
+void IoTHubMessaging_LL_Destroy(IOTHUB_MESSAGING_HANDLE messagingHandle)
+{
+    (void)messagingHandle;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Open(IOTHUB_MESSAGING_HANDLE messagingHandle, IOTHUB_OPEN_COMPLETE_CALLBACK openCompleteCallback, void* userContextCallback)
+{
+    (void)messagingHandle;
+    if (openCompleteCallback != NULL)
+    {
+        openCompleteCallback(userContextCallback);
+    }
+    return IOTHUB_MESSAGING_OK;
+}
+
+void IoTHubMessaging_LL_Close(IOTHUB_MESSAGING_HANDLE messagingHandle)
+{
+    (void)messagingHandle;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetFeedbackMessageCallback(IOTHUB_MESSAGING_HANDLE messagingHandle, IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK feedbackMessageReceivedCallback, void* userContextCallback)
+{
+    (void)messagingHandle;
+    (void)feedbackMessageReceivedCallback;
+    (void)userContextCallback;
+    return IOTHUB_MESSAGING_OK;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetFeedbackRecordCallback(IOTHUB_MESSAGING_HANDLE messagingHandle, IOTHUB_FEEDBACK_RECORD_RECEIVED_CALLBACK feedbackRecordReceivedCallback, void* userContextCallback)
+{
+    (void)messagingHandle;
+    (void)feedbackRecordReceivedCallback;
+    (void)userContextCallback;
+    return IOTHUB_MESSAGING_OK;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* deviceId, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+    (void)deviceId;
+    (void)message;
+
+    if (messagingHandle->inFlightCount == MAX_IN_FLIGHT)
+    {
+        result = IOTHUB_MESSAGING_ERROR;
+    }
+    else
+    {
+        messagingHandle->inFlight[messagingHandle->inFlightCount].sendCompleteCallback = sendCompleteCallback;
+        messagingHandle->inFlight[messagingHandle->inFlightCount].userContextCallback = userContextCallback;
+        messagingHandle->inFlightCount++;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SendBatch(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* const* deviceIds, size_t deviceIdCount, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_BATCH_COMPLETE_CALLBACK sendBatchCompleteCallback, void* userContextCallback)
+{
+    (void)messagingHandle;
+    (void)deviceIds;
+    (void)deviceIdCount;
+    (void)message;
+    (void)sendBatchCompleteCallback;
+    (void)userContextCallback;
+    return IOTHUB_MESSAGING_ERROR;
+}
+
+/*every send is acknowledged by the next DoWork, as if the service answered within one round*/
+void IoTHubMessaging_LL_DoWork(IOTHUB_MESSAGING_HANDLE messagingHandle)
+{
+    size_t i;
+    size_t count = messagingHandle->inFlightCount;
+
+    messagingHandle->doWorkCount++;
+    messagingHandle->inFlightCount = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (recordLatency)
+        {
+            size_t index = (size_t)messagingHandle->inFlight[i].userContextCallback;
+            latencies[index] = nowMicroseconds() - enqueueTimes[index];
+        }
+        messagingHandle->inFlight[i].sendCompleteCallback(messagingHandle->inFlight[i].userContextCallback, IOTHUB_MESSAGING_OK);
+    }
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetMaxInFlightSends(IOTHUB_MESSAGING_HANDLE messagingHandle, size_t maxInFlightSends)
+{
+    (void)messagingHandle;
+    (void)maxInFlightSends;
+    return IOTHUB_MESSAGING_OK;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_GetInFlightSendCount(IOTHUB_MESSAGING_HANDLE messagingHandle, size_t* inFlightSendCount)
+{
+    *inFlightSendCount = messagingHandle->inFlightCount;
+    return IOTHUB_MESSAGING_OK;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetTrustedCert(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* trusted_cert)
+{
+    (void)messagingHandle;
+    (void)trusted_cert;
+    return IOTHUB_MESSAGING_OK;
+}
+
+static void onSendComplete(void* context, IOTHUB_MESSAGING_RESULT messagingResult)
+{
+    (void)context;
+    (void)messagingResult;
+    (void)Lock(completionLock);
+    completedSends++;
+    (void)Unlock(completionLock);
+}
+
+static size_t getCompletedSends(void)
+{
+    size_t result;
+    (void)Lock(completionLock);
+    result = completedSends;
+    (void)Unlock(completionLock);
+    return result;
+}
+
+static void waitForCompletedSends(size_t expected)
+{
+    while (getCompletedSends() < expected)
+    {
+        ThreadAPI_Sleep(1);
+    }
+}
+
+static int compareDoubles(const void* left, const void* right)
+{
+    double l = *(const double*)left;
+    double r = *(const double*)right;
+    return (l < r) ? -1 : ((l > r) ? 1 : 0);
+}
+
+int main(void)
+{
+    int result;
+    IOTHUB_MESSAGE_HANDLE message;
+    IOTHUB_MESSAGING_CLIENT_HANDLE messagingClient;
+
+    if ((completionLock = Lock_Init()) == NULL)
+    {
+        (void)printf("failure creating a lock\n");
+        result = __LINE__;
+    }
+    else
+    {
+        if ((message = IoTHubMessage_CreateFromString("{\"temperature\":21.5}")) == NULL)
+        {
+            (void)printf("failure creating a message\n");
+            result = __LINE__;
+        }
+        else
+        {
+            /*the fake IoTHubMessaging_LL never looks at the authentication handle*/
+            if ((messagingClient = IoTHubMessaging_Create((IOTHUB_SERVICE_CLIENT_AUTH_HANDLE)&fakeMessaging)) == NULL)
+            {
+                (void)printf("failure creating the messaging client\n");
+                result = __LINE__;
+            }
+            else if (IoTHubMessaging_Open(messagingClient, NULL, NULL) != IOTHUB_MESSAGING_OK)
+            {
+                (void)printf("failure opening the messaging client\n");
+                IoTHubMessaging_Destroy(messagingClient);
+                result = __LINE__;
+            }
+            else
+            {
+                size_t i;
+                double start;
+                double seconds;
+                clock_t cpuStart;
+                unsigned long doWorkStart;
+
+                result = 0;
+
+                /*single sends on an idle client: what a caller sending now and then sees*/
+                recordLatency = 1;
+                for (i = 0; (result == 0) && (i < LATENCY_SAMPLES); i++)
+                {
+                    enqueueTimes[i] = nowMicroseconds();
+                    if (IoTHubMessaging_SendAsync(messagingClient, "device", message, onSendComplete, (void*)i) != IOTHUB_MESSAGING_OK)
+                    {
+                        (void)printf("failure sending\n");
+                        result = __LINE__;
+                    }
+                    else
+                    {
+                        waitForCompletedSends(i + 1);
+                        ThreadAPI_Sleep(LATENCY_SPACING_MILLISECONDS);
+                    }
+                }
+                recordLatency = 0;
+
+                if (result == 0)
+                {
+                    qsort(latencies, LATENCY_SAMPLES, sizeof(latencies[0]), compareDoubles);
+                    (void)printf("%-28s %10s %10s %10s %10s\n", "SendAsync to DoWork (us)", "min", "median", "p99", "max");
+                    (void)printf("%-28s %10.1f %10.1f %10.1f %10.1f\n", "",
+                        latencies[0], latencies[LATENCY_SAMPLES / 2], latencies[(LATENCY_SAMPLES * 99) / 100], latencies[LATENCY_SAMPLES - 1]);
+
+                    /*a burst: how fast callers can queue and how long until the last send was completed*/
+                    completedSends = 0;
+                    start = nowMicroseconds();
+                    for (i = 0; (result == 0) && (i < BURST_SENDS); i++)
+                    {
+                        if (IoTHubMessaging_SendAsync(messagingClient, "device", message, onSendComplete, NULL) != IOTHUB_MESSAGING_OK)
+                        {
+                            (void)printf("failure sending\n");
+                            result = __LINE__;
+                        }
+                    }
+                }
+
+                if (result == 0)
+                {
+                    double queued = nowMicroseconds() - start;
+                    waitForCompletedSends(BURST_SENDS);
+                    seconds = (nowMicroseconds() - start) / 1000000.0;
+                    (void)printf("%-28s %10s %14s %14s\n", "burst", "sends", "queued/s", "completed/s");
+                    (void)printf("%-28s %10lu %14.0f %14.0f\n", "",
+                        (unsigned long)BURST_SENDS, BURST_SENDS / (queued / 1000000.0), BURST_SENDS / seconds);
+
+                    /*nothing to do: the worker should only wake up to service the connection*/
+                    cpuStart = clock();
+                    doWorkStart = fakeMessaging.doWorkCount;
+                    ThreadAPI_Sleep(IDLE_MEASURE_MILLISECONDS);
+                    (void)printf("%-28s %14s %14s\n", "idle", "cpu ms/s", "DoWork/s");
+                    (void)printf("%-28s %14.2f %14.1f\n", "",
+                        ((double)(clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC) / (IDLE_MEASURE_MILLISECONDS / 1000.0),
+                        (double)(fakeMessaging.doWorkCount - doWorkStart) / (IDLE_MEASURE_MILLISECONDS / 1000.0));
+                }
+
+                IoTHubMessaging_Close(messagingClient);
+                IoTHubMessaging_Destroy(messagingClient);
+            }
+            IoTHubMessage_Destroy(message);
+        }
+        (void)Lock_Deinit(completionLock);
+    }
+
+    return result;
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef PROV_REGISTRATION_CACHE_H
+#define PROV_REGISTRATION_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif /* __cplusplus */
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_prov_client/prov_device_ll_client.h"
+
+typedef struct PROV_REGISTRATION_CACHE_INFO_TAG* PROV_REGISTRATION_CACHE_HANDLE;
+
+// Signs the digest of a cache entry with the device identity, returns a malloc'd signature or NULL
+typedef char*(*PROV_REGISTRATION_CACHE_SIGN)(const char* digest, void* user_ctx);
+
+MOCKABLE_FUNCTION(, PROV_REGISTRATION_CACHE_HANDLE, prov_registration_cache_create, const PROV_REGISTRATION_CACHE_OPTIONS*, options, PROV_REGISTRATION_CACHE_SIGN, sign_callback, void*, sign_ctx);
+MOCKABLE_FUNCTION(, void, prov_registration_cache_destroy, PROV_REGISTRATION_CACHE_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, prov_registration_cache_set_identity, PROV_REGISTRATION_CACHE_HANDLE, handle, const char*, scope_id, const char*, registration_id, const unsigned char*, attestation, size_t, attestation_len);
+MOCKABLE_FUNCTION(, int, prov_registration_cache_load, PROV_REGISTRATION_CACHE_HANDLE, handle, char**, iothub_uri, char**, device_id);
+MOCKABLE_FUNCTION(, int, prov_registration_cache_save, PROV_REGISTRATION_CACHE_HANDLE, handle, const char*, iothub_uri, const char*, device_id);
+MOCKABLE_FUNCTION(, void, prov_registration_cache_invalidate, PROV_REGISTRATION_CACHE_HANDLE, handle);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // PROV_REGISTRATION_CACHE_H
@@ -12,8 +12,10 @@
 
 #ifdef __cplusplus
 extern "C" {
+#include <cstdint>
 #else
 #include <stdbool.h>
+#include <stdint.h>
 #endif /* __cplusplus */
 
     #define PROV_STATUS_CODE_TRANSIENT_ERROR    429
@@ -49,7 +51,8 @@ extern "C" {
     } PROV_JSON_INFO;
 
     typedef void(*PROV_DEVICE_TRANSPORT_REGISTER_CALLBACK)(PROV_DEVICE_TRANSPORT_RESULT transport_result, BUFFER_HANDLE iothub_key, const char* assigned_hub, const char* device_id, void* user_ctx);
-    typedef void(*PROV_DEVICE_TRANSPORT_STATUS_CALLBACK)(PROV_DEVICE_TRANSPORT_STATUS transport_status, void* user_ctx);
+    // retry_interval is the number of seconds the service asked the device to wait before its next request, 0 when not specified
+    typedef void(*PROV_DEVICE_TRANSPORT_STATUS_CALLBACK)(PROV_DEVICE_TRANSPORT_STATUS transport_status, uint32_t retry_interval, void* user_ctx);
     typedef char*(*PROV_TRANSPORT_CHALLENGE_CALLBACK)(const unsigned char* nonce, size_t nonce_len, const char* key_name, void* user_ctx);
     typedef PROV_JSON_INFO*(*PROV_TRANSPORT_JSON_PARSE)(const char* json_document, void* user_ctx);
     typedef void(*PROV_TRANSPORT_ERROR_CALLBACK)(PROV_DEVICE_TRANSPORT_ERROR transport_error, void* user_context);
@@ -8,7 +8,8 @@
 *             module with 2 features:
 *                - scheduling the work for the IoTHubCLient from a
 *                  thread, so that the user does not need to create their
-*                  own thread
+*                  own thread, or from one worker thread shared by many
+*                  devices
 *                - thread-safe APIs
 */
 
@@ -20,6 +21,8 @@ typedef struct PROV_DEVICE_INSTANCE_TAG* PROV_DEVICE_HANDLE;
 #define PROV_DEVICE_CLIENT_INSTANCE_TYPE
 #endif // PROV_DEVICE_CLIENT_INSTANCE_TYPE
 
+typedef struct PROV_DEVICE_WORKER_INSTANCE_TAG* PROV_DEVICE_WORKER_HANDLE;
+
 #include <stddef.h>
 #include <stdint.h>
 #include "prov_device_ll_client.h"
@@ -38,6 +41,13 @@ MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_Register_Device, PROV_DEVICE
 MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_SetOption, PROV_DEVICE_HANDLE, prov_device_handle, const char*, optionName, const void*, value);
 MOCKABLE_FUNCTION(, const char*, Prov_Device_GetVersionString);
 
+/* A worker drives every device created with Prov_Device_CreateWithWorker from a single thread, instead of
+   one thread per device.  Destroying the worker stops its thread; if devices are still attached the worker's
+   memory is released with the last of them, and those devices can no longer be registered. */
+MOCKABLE_FUNCTION(, PROV_DEVICE_WORKER_HANDLE, Prov_Device_Worker_Create);
+MOCKABLE_FUNCTION(, void, Prov_Device_Worker_Destroy, PROV_DEVICE_WORKER_HANDLE, worker_handle);
+MOCKABLE_FUNCTION(, PROV_DEVICE_HANDLE, Prov_Device_CreateWithWorker, const char*, uri, const char*, scope_id, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, protocol, PROV_DEVICE_WORKER_HANDLE, worker_handle);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -45,6 +45,46 @@ DEFINE_ENUM(PROV_DEVICE_REG_STATUS, PROV_DEVICE_REG_STATUS_VALUES);
 static const char* const PROV_REGISTRATION_ID = "registration_id";
 static const char* const PROV_OPTION_LOG_TRACE = "logtrace";
 static const char* const PROV_OPTION_TIMEOUT = "provisioning_timeout";
+static const char* const PROV_OPTION_REGISTRATION_CACHE = "registration_cache";
+static const char* const PROV_OPTION_REGISTRATION_CACHE_INVALIDATE = "registration_cache_invalidate";
+static const char* const PROV_OPTION_POLLING_POLICY = "polling_policy";
+
+/* Value of the PROV_OPTION_POLLING_POLICY option.  The wait before each operation status request starts at
+   initial_interval_secs and doubles with every request up to max_interval_secs.  A longer Retry-After sent by
+   the service is honored, and up to max_jitter_percent is added to the wait so devices do not poll in step. */
+typedef struct PROV_POLLING_POLICY_TAG
+{
+    size_t initial_interval_secs;
+    size_t max_interval_secs;
+    size_t max_jitter_percent;
+} PROV_POLLING_POLICY;
+
+typedef char*(*PROV_REGISTRATION_CACHE_READ)(void* store_ctx);
+typedef int(*PROV_REGISTRATION_CACHE_WRITE)(const char* content, void* store_ctx);
+typedef void(*PROV_REGISTRATION_CACHE_CLEAR)(void* store_ctx);
+
+/* Persistent storage used by the registration cache.  cache_read returns a malloc'd NULL terminated
+   copy of the stored content (the caller frees it) or NULL when nothing has been stored. */
+typedef struct PROV_REGISTRATION_CACHE_STORE_TAG
+{
+    PROV_REGISTRATION_CACHE_READ cache_read;
+    PROV_REGISTRATION_CACHE_WRITE cache_write;
+    PROV_REGISTRATION_CACHE_CLEAR cache_clear;
+    void* store_ctx;
+} PROV_REGISTRATION_CACHE_STORE;
+
+/* Value of the PROV_OPTION_REGISTRATION_CACHE option.  When store is NULL the entry is kept in the file
+   named by file_path.  The entry is signed with integrity_key when one is given, otherwise with the
+   device's security module (x509 devices must supply an integrity_key).  A lifetime_secs of 0 selects
+   the default lifetime of 7 days. */
+typedef struct PROV_REGISTRATION_CACHE_OPTIONS_TAG
+{
+    const PROV_REGISTRATION_CACHE_STORE* store;
+    const char* file_path;
+    const unsigned char* integrity_key;
+    size_t integrity_key_len;
+    size_t lifetime_secs;
+} PROV_REGISTRATION_CACHE_OPTIONS;
 
 typedef void(*PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK)(PROV_DEVICE_RESULT register_result, const char* iothub_uri, const char* device_id, void* user_context);
 typedef void(*PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK)(PROV_DEVICE_REG_STATUS reg_status, void* user_context);
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdbool.h>
 
 #include <signal.h>
 #include "azure_c_shared_utility/gballoc.h"
@@ -19,8 +20,25 @@ typedef struct PROV_DEVICE_INSTANCE_TAG
     THREAD_HANDLE ThreadHandle;
     LOCK_HANDLE LockHandle;
     sig_atomic_t StopThread;
+
+    // Set when the device is driven by a shared worker, LockHandle is then the worker's lock
+    struct PROV_DEVICE_WORKER_INSTANCE_TAG* Worker;
+    struct PROV_DEVICE_INSTANCE_TAG* NextScheduled;
+    bool IsScheduled;
 } PROV_DEVICE_INSTANCE;
 
+typedef struct PROV_DEVICE_WORKER_INSTANCE_TAG
+{
+    THREAD_HANDLE ThreadHandle;
+    LOCK_HANDLE LockHandle;
+    sig_atomic_t StopThread;
+    PROV_DEVICE_INSTANCE* ScheduledDevices;
+    size_t DeviceCount;
+
+    // Set when Prov_Device_Worker_Destroy ran while devices were still attached, the last of them frees the worker
+    bool IsDestroyed;
+} PROV_DEVICE_WORKER_INSTANCE;
+
 static int ScheduleWork_Thread(void* threadArgument)
 {
     PROV_DEVICE_INSTANCE* prov_device_instance = (PROV_DEVICE_INSTANCE*)threadArgument;
@@ -51,6 +69,41 @@ static int ScheduleWork_Thread(void* threadArgument)
     return 0;
 }
 
+static int ScheduleWork_Worker_Thread(void* threadArgument)
+{
+    PROV_DEVICE_WORKER_INSTANCE* worker_instance = (PROV_DEVICE_WORKER_INSTANCE*)threadArgument;
+
+    while (1)
+    {
+        if (Lock(worker_instance->LockHandle) == LOCK_OK)
+        {
+            if (worker_instance->StopThread)
+            {
+                (void)Unlock(worker_instance->LockHandle);
+                break; /*gets out of the thread*/
+            }
+            else
+            {
+                PROV_DEVICE_INSTANCE* scheduled_device;
+                /* Codes_SRS_PROV_DEVICE_CLIENT_07_009: [ The worker thread shall call Prov_Device_LL_DoWork for every registered device of the worker on each pass. ] */
+                for (scheduled_device = worker_instance->ScheduledDevices; scheduled_device != NULL; scheduled_device = scheduled_device->NextScheduled)
+                {
+                    Prov_Device_LL_DoWork(scheduled_device->ProvDeviceLLHandle);
+                }
+                (void)Unlock(worker_instance->LockHandle);
+            }
+        }
+        else
+        {
+            LogError("Lock failed, shall retry");
+        }
+        (void)ThreadAPI_Sleep(1);
+    }
+
+    ThreadAPI_Exit(0);
+    return 0;
+}
+
 static PROV_DEVICE_RESULT StartWorkerThreadIfNeeded(PROV_DEVICE_INSTANCE* prov_device_instance)
 {
     PROV_DEVICE_RESULT result;
@@ -74,6 +127,93 @@ static PROV_DEVICE_RESULT StartWorkerThreadIfNeeded(PROV_DEVICE_INSTANCE* prov_d
     return result;
 }
 
+static PROV_DEVICE_RESULT register_worker_device(PROV_DEVICE_INSTANCE* prov_device_instance, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK register_callback, void* user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK register_status_callback, void* status_user_context)
+{
+    PROV_DEVICE_RESULT result;
+    PROV_DEVICE_WORKER_INSTANCE* worker_instance = prov_device_instance->Worker;
+
+    /* Codes_SRS_PROV_DEVICE_CLIENT_07_010: [ For a device created with a worker `Prov_Device_Register_Device` shall lock the worker's Lock and return with error if the locking fails. ] */
+    if (Lock(worker_instance->LockHandle) != LOCK_OK)
+    {
+        LogError("Could not acquire lock");
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    else if (worker_instance->IsDestroyed)
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_018: [ If the worker of the device was destroyed the function shall return error without calling the LL layer. ] */
+        LogError("The worker of the device was destroyed");
+        (void)Unlock(worker_instance->LockHandle);
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_011: [ The function shall call the LL layer Prov_Device_LL_Register_Device with the given parameters and return with the result. ] */
+        result = Prov_Device_LL_Register_Device(prov_device_instance->ProvDeviceLLHandle, register_callback, user_context, register_status_callback, status_user_context);
+        if (result == PROV_DEVICE_RESULT_OK)
+        {
+            /* Codes_SRS_PROV_DEVICE_CLIENT_07_012: [ On success the function shall start the worker thread if it is not running and add the device to the devices driven by the worker. ] */
+            if (worker_instance->ThreadHandle == NULL && ThreadAPI_Create(&worker_instance->ThreadHandle, ScheduleWork_Worker_Thread, worker_instance) != THREADAPI_OK)
+            {
+                /* Codes_SRS_PROV_DEVICE_CLIENT_07_013: [ If the worker thread cannot be started the function shall return error. ] */
+                LogError("ThreadAPI_Create failed");
+                worker_instance->ThreadHandle = NULL;
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            else if (!prov_device_instance->IsScheduled)
+            {
+                prov_device_instance->NextScheduled = worker_instance->ScheduledDevices;
+                worker_instance->ScheduledDevices = prov_device_instance;
+                prov_device_instance->IsScheduled = true;
+            }
+        }
+        (void)Unlock(worker_instance->LockHandle);
+    }
+    return result;
+}
+
+static void destroy_worker_device(PROV_DEVICE_INSTANCE* prov_device_instance)
+{
+    PROV_DEVICE_WORKER_INSTANCE* worker_instance = prov_device_instance->Worker;
+    bool free_worker;
+    bool is_locked = Lock(worker_instance->LockHandle) == LOCK_OK;
+    if (!is_locked)
+    {
+        LogError("Could not acquire lock");
+    }
+
+    /* Codes_SRS_PROV_DEVICE_CLIENT_07_014: [ For a device created with a worker `Prov_Device_Destroy` shall remove the device from the worker under the worker's Lock. ] */
+    if (prov_device_instance->IsScheduled)
+    {
+        PROV_DEVICE_INSTANCE** iterator = &worker_instance->ScheduledDevices;
+        while (*iterator != NULL && *iterator != prov_device_instance)
+        {
+            iterator = &(*iterator)->NextScheduled;
+        }
+        if (*iterator != NULL)
+        {
+            *iterator = prov_device_instance->NextScheduled;
+        }
+    }
+    worker_instance->DeviceCount--;
+    free_worker = worker_instance->IsDestroyed && worker_instance->DeviceCount == 0;
+
+    if (is_locked)
+    {
+        (void)Unlock(worker_instance->LockHandle);
+    }
+
+    /* Codes_SRS_PROV_DEVICE_CLIENT_07_015: [ The function shall call Prov_Device_LL_Destroy and free the device handle without joining or de-initializing the worker's resources. ] */
+    Prov_Device_LL_Destroy(prov_device_instance->ProvDeviceLLHandle);
+    free(prov_device_instance);
+
+    if (free_worker)
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_017: [ If the worker was already destroyed and this was its last device, the function shall de-init the worker's Lock and free the worker. ] */
+        Lock_Deinit(worker_instance->LockHandle);
+        free(worker_instance);
+    }
+}
+
 PROV_DEVICE_HANDLE Prov_Device_Create(const char* uri, const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol)
 {
     PROV_DEVICE_INSTANCE* result;
@@ -111,6 +251,9 @@ PROV_DEVICE_HANDLE Prov_Device_Create(const char* uri, const char* id_scope, PRO
                 /* Codes_SRS_PROV_DEVICE_CLIENT_12_007: [ The function shall initialize the result datastructure. ] */
                 result->ThreadHandle = NULL;
                 result->StopThread = 0;
+                result->Worker = NULL;
+                result->NextScheduled = NULL;
+                result->IsScheduled = false;
             }
         }
     }
@@ -125,6 +268,10 @@ void Prov_Device_Destroy(PROV_DEVICE_HANDLE prov_device_handle)
     {
         LogError("NULL prov_device_handle");
     }
+    else if (prov_device_handle->Worker != NULL)
+    {
+        destroy_worker_device(prov_device_handle);
+    }
     else
     {
         PROV_DEVICE_INSTANCE* prov_device_instance = (PROV_DEVICE_INSTANCE*)prov_device_handle;
@@ -178,8 +325,12 @@ PROV_DEVICE_RESULT Prov_Device_Register_Device(PROV_DEVICE_HANDLE prov_device_ha
     {
         PROV_DEVICE_INSTANCE* prov_device_instance = (PROV_DEVICE_INSTANCE*)prov_device_handle;
 
+        if (prov_device_instance->Worker != NULL)
+        {
+            result = register_worker_device(prov_device_instance, register_callback, user_context, register_status_callback, status_user_context);
+        }
         /* Codes_SRS_PROV_DEVICE_CLIENT_12_018: [ The function shall try to lock the Lock. ] */
-        if (Lock(prov_device_instance->LockHandle) != LOCK_OK)
+        else if (Lock(prov_device_instance->LockHandle) != LOCK_OK)
         {
             /* Codes_SRS_PROV_DEVICE_CLIENT_12_019: [ If the locking failed the function shall return with error. ] */
             LogError("Could not acquire lock");
@@ -230,6 +381,139 @@ PROV_DEVICE_RESULT Prov_Device_SetOption(PROV_DEVICE_HANDLE prov_device_handle,
     return result;
 }
 
+PROV_DEVICE_WORKER_HANDLE Prov_Device_Worker_Create(void)
+{
+    PROV_DEVICE_WORKER_INSTANCE* result;
+
+    /* Codes_SRS_PROV_DEVICE_CLIENT_07_001: [ `Prov_Device_Worker_Create` shall allocate memory for the worker and initialize its Lock. ] */
+    if ((result = (PROV_DEVICE_WORKER_INSTANCE*)malloc(sizeof(PROV_DEVICE_WORKER_INSTANCE))) == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_002: [ If any error is encountered `Prov_Device_Worker_Create` shall free the resources allocated and return NULL. ] */
+        LogError("Unable to allocate worker instance");
+    }
+    else if ((result->LockHandle = Lock_Init()) == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_002: [ If any error is encountered `Prov_Device_Worker_Create` shall free the resources allocated and return NULL. ] */
+        LogError("Lock_Init failed");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_003: [ The worker thread shall not be started until a device of the worker is registered. ] */
+        result->ThreadHandle = NULL;
+        result->StopThread = 0;
+        result->ScheduledDevices = NULL;
+        result->DeviceCount = 0;
+        result->IsDestroyed = false;
+    }
+    return result;
+}
+
+void Prov_Device_Worker_Destroy(PROV_DEVICE_WORKER_HANDLE worker_handle)
+{
+    /* Codes_SRS_PROV_DEVICE_CLIENT_07_004: [ If `worker_handle` is NULL `Prov_Device_Worker_Destroy` shall return. ] */
+    if (worker_handle == NULL)
+    {
+        LogError("NULL worker_handle");
+    }
+    else
+    {
+        bool free_worker;
+
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_005: [ `Prov_Device_Worker_Destroy` shall signal the worker thread to stop, join it if it is running, de-init the Lock and free the worker. ] */
+        if (Lock(worker_handle->LockHandle) != LOCK_OK)
+        {
+            LogError("Could not acquire lock");
+            worker_handle->StopThread = 1; /*setting it even when Lock fails*/
+        }
+        else
+        {
+            worker_handle->StopThread = 1;
+            (void)Unlock(worker_handle->LockHandle);
+        }
+
+        if (worker_handle->ThreadHandle != NULL)
+        {
+            int res;
+            if (ThreadAPI_Join(worker_handle->ThreadHandle, &res) != THREADAPI_OK)
+            {
+                LogError("ThreadAPI_Join failed");
+            }
+        }
+
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_016: [ If devices are still attached to the worker, `Prov_Device_Worker_Destroy` shall mark the worker as destroyed under the Lock and leave the Lock and the worker to be freed by the destroy of its last device. ] */
+        if (Lock(worker_handle->LockHandle) != LOCK_OK)
+        {
+            LogError("Could not acquire lock");
+            worker_handle->IsDestroyed = true;
+            free_worker = worker_handle->DeviceCount == 0;
+        }
+        else
+        {
+            worker_handle->IsDestroyed = true;
+            free_worker = worker_handle->DeviceCount == 0;
+            (void)Unlock(worker_handle->LockHandle);
+        }
+
+        if (free_worker)
+        {
+            Lock_Deinit(worker_handle->LockHandle);
+            free(worker_handle);
+        }
+        else
+        {
+            LogInfo("Worker destroyed with devices still attached, it is freed with its last device");
+        }
+    }
+}
+
+PROV_DEVICE_HANDLE Prov_Device_CreateWithWorker(const char* uri, const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol, PROV_DEVICE_WORKER_HANDLE worker_handle)
+{
+    PROV_DEVICE_INSTANCE* result;
+
+    /* Codes_SRS_PROV_DEVICE_CLIENT_07_006: [ If any of the input parameter is NULL `Prov_Device_CreateWithWorker` shall return NULL. ] */
+    if (uri == NULL || id_scope == NULL || protocol == NULL || worker_handle == NULL)
+    {
+        LogError("Invalid parameter specified uri: %p, id_scope: %p, protocol: %p, worker_handle: %p", uri, id_scope, protocol, worker_handle);
+        result = NULL;
+    }
+    else if ((result = (PROV_DEVICE_INSTANCE*)malloc(sizeof(PROV_DEVICE_INSTANCE))) == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_008: [ If any error is encountered `Prov_Device_CreateWithWorker` shall free the resources allocated and return NULL. ] */
+        LogError("Unable to allocate Instance Info");
+    }
+    else if ((result->ProvDeviceLLHandle = Prov_Device_LL_Create(uri, id_scope, protocol)) == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_008: [ If any error is encountered `Prov_Device_CreateWithWorker` shall free the resources allocated and return NULL. ] */
+        LogError("Prov_Device_LL_Create failed");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_PROV_DEVICE_CLIENT_07_007: [ The device shall use the Lock of the worker and shall not start a thread of its own. ] */
+        result->ThreadHandle = NULL;
+        result->LockHandle = worker_handle->LockHandle;
+        result->StopThread = 0;
+        result->Worker = worker_handle;
+        result->NextScheduled = NULL;
+        result->IsScheduled = false;
+
+        if (Lock(worker_handle->LockHandle) != LOCK_OK)
+        {
+            LogError("Could not acquire lock");
+            worker_handle->DeviceCount++; /*counting it even when Lock fails*/
+        }
+        else
+        {
+            worker_handle->DeviceCount++;
+            (void)Unlock(worker_handle->LockHandle);
+        }
+    }
+    return result;
+}
+
 const char* Prov_Device_GetVersionString(void)
 {
     /* Codes_SRS_PROV_DEVICE_CLIENT_12_024: [ The function shall call the LL layer Prov_Device_LL_GetVersionString and return with the result. ] */
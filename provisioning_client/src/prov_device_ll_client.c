@@ -20,6 +20,7 @@
 
 #include "azure_prov_client/internal/prov_auth_client.h"
 #include "azure_prov_client/internal/prov_transport_private.h"
+#include "azure_prov_client/internal/prov_registration_cache.h"
 #include "azure_prov_client/prov_device_ll_client.h"
 #include "azure_prov_client/prov_client_const.h"
 
@@ -40,6 +41,7 @@ static const char* const PROV_FAILED_STATUS = "failed";
 static const char* const PROV_BLACKLISTED_STATUS = "blacklisted";
 
 static const char* const SAS_TOKEN_SCOPE_FMT = "%s/registrations/%s";
+static const char* const REGISTRATION_CACHE_KEY_NAME = "registration_cache";
 
 #define DPS_HUB_ERROR_NO_HUB        400208
 #define DPS_HUB_ERROR_UNAUTH        400209
@@ -48,6 +50,9 @@ static const char* const SAS_TOKEN_SCOPE_FMT = "%s/registrations/%s";
 #define EPOCH_TIME_T_VALUE          (time_t)0
 #define MAX_AUTH_ATTEMPTS           3
 #define PROV_GET_THROTTLE_TIME      3
+#define PROV_MAX_POLL_INTERVAL      30
+#define PROV_POLL_JITTER_PERCENT    20
+#define PROV_MAX_RETRY_AFTER        300
 #define PROV_DEFAULT_TIMEOUT        60
 
 typedef enum CLIENT_STATE_TAG
@@ -62,6 +67,8 @@ typedef enum CLIENT_STATE_TAG
     CLIENT_STATE_STATUS_SENT,
     CLIENT_STATE_STATUS_RECV,
 
+    CLIENT_STATE_CACHED,
+
     CLIENT_STATE_ERROR
 } CLIENT_STATE;
 
@@ -86,8 +93,13 @@ typedef struct PROV_INSTANCE_INFO_TAG
     TICK_COUNTER_HANDLE tick_counter;
 
     tickcounter_ms_t status_throttle;
+    tickcounter_ms_t status_interval;
     tickcounter_ms_t timeout_value;
 
+    PROV_POLLING_POLICY polling_policy;
+    size_t status_attempts;
+    uint32_t jitter_state;
+
     uint8_t prov_timeout;
 
     char* registration_id;
@@ -106,6 +118,8 @@ typedef struct PROV_INSTANCE_INFO_TAG
     size_t auth_attempts_made;
 
     char* scope_id;
+
+    PROV_REGISTRATION_CACHE_HANDLE registration_cache;
 } PROV_INSTANCE_INFO;
 
 static char* prov_transport_challenge_callback(const unsigned char* nonce, size_t nonce_len, const char* key_name, void* user_ctx)
@@ -179,6 +193,80 @@ static char* prov_transport_challenge_callback(const unsigned char* nonce, size_
     return result;
 }
 
+static char* registration_cache_sign_callback(const char* digest, void* user_ctx)
+{
+    char* result;
+    if (user_ctx == NULL)
+    {
+        LogError("Bad argument user_ctx is NULL");
+        result = NULL;
+    }
+    else
+    {
+        PROV_INSTANCE_INFO* prov_info = (PROV_INSTANCE_INFO*)user_ctx;
+        // The entry expiry is part of the digest, the token only serves as a keyed hash of the device identity
+        result = prov_auth_construct_sas_token(prov_info->prov_auth_handle, digest, REGISTRATION_CACHE_KEY_NAME, 0);
+    }
+    return result;
+}
+
+static void set_registration_cache_identity(PROV_INSTANCE_INFO* prov_info, const unsigned char* attestation, size_t attestation_len)
+{
+    if (prov_info->registration_cache != NULL && prov_registration_cache_set_identity(prov_info->registration_cache, prov_info->scope_id, prov_info->registration_id, attestation, attestation_len) != 0)
+    {
+        // Without an identity the cache will simply miss and the device registers with the service
+        LogError("Failure setting the registration cache identity");
+    }
+}
+
+static void seed_status_jitter(PROV_INSTANCE_INFO* prov_info)
+{
+    // Devices that start together share a clock but not a registration id, so the id keeps their polls apart
+    const char* iterator;
+    uint32_t seed = 2166136261u ^ (uint32_t)prov_info->status_throttle;
+    for (iterator = prov_info->registration_id; iterator != NULL && *iterator != '\0'; iterator++)
+    {
+        seed = (seed ^ (unsigned char)*iterator) * 16777619u;
+    }
+    prov_info->jitter_state = seed != 0 ? seed : 1;
+}
+
+static void schedule_status_request(PROV_INSTANCE_INFO* prov_info, uint32_t retry_interval)
+{
+    size_t interval_secs = prov_info->polling_policy.initial_interval_secs;
+    size_t index;
+
+    /* Codes_SRS_PROV_CLIENT_07_042: [ The wait before an operation status request shall start at initial_interval_secs and double with every request of the registration, up to max_interval_secs. ] */
+    for (index = 0; index < prov_info->status_attempts && interval_secs < prov_info->polling_policy.max_interval_secs; index++)
+    {
+        interval_secs *= 2;
+    }
+    if (interval_secs > prov_info->polling_policy.max_interval_secs)
+    {
+        interval_secs = prov_info->polling_policy.max_interval_secs;
+    }
+
+    /* Codes_SRS_PROV_CLIENT_07_043: [ If the service's retry interval is longer than the wait, the retry interval shall be used, limited to 300 seconds. ] */
+    if (retry_interval > interval_secs)
+    {
+        interval_secs = retry_interval > PROV_MAX_RETRY_AFTER ? PROV_MAX_RETRY_AFTER : retry_interval;
+    }
+
+    /* Codes_SRS_PROV_CLIENT_07_044: [ A random jitter of up to max_jitter_percent shall be added to the wait. ] */
+    prov_info->jitter_state ^= prov_info->jitter_state << 13;
+    prov_info->jitter_state ^= prov_info->jitter_state >> 17;
+    prov_info->jitter_state ^= prov_info->jitter_state << 5;
+    prov_info->status_interval = (tickcounter_ms_t)interval_secs * 1000;
+    prov_info->status_interval += (prov_info->status_interval * prov_info->polling_policy.max_jitter_percent / 100) * (prov_info->jitter_state % 1001) / 1000;
+    prov_info->status_attempts++;
+
+    // The wait is measured from the service reply
+    if (tickcounter_get_current_ms(prov_info->tick_counter, &prov_info->status_throttle) != 0)
+    {
+        LogError("Failure getting the current time");
+    }
+}
+
 static void on_transport_error(PROV_DEVICE_TRANSPORT_ERROR transport_error, void* user_ctx)
 {
     if (user_ctx != NULL)
@@ -532,6 +620,12 @@ static void on_transport_registration_data(PROV_DEVICE_TRANSPORT_RESULT transpor
 
             if (prov_info->prov_state != CLIENT_STATE_ERROR)
             {
+                /* Codes_SRS_PROV_CLIENT_07_036: [ If the registration cache is enabled, a successful registration shall be saved to the cache before the register_callback is called. ] */
+                if (prov_info->registration_cache != NULL && prov_registration_cache_save(prov_info->registration_cache, assigned_hub, device_id) != 0)
+                {
+                    // A failure to cache only costs a registration on the next start
+                    LogError("Failure saving the registration to the cache");
+                }
                 prov_info->register_callback(PROV_DEVICE_RESULT_OK, assigned_hub, device_id, prov_info->user_context);
                 prov_info->prov_state = CLIENT_STATE_READY;
             }
@@ -554,7 +648,7 @@ static void on_transport_registration_data(PROV_DEVICE_TRANSPORT_RESULT transpor
     }
 }
 
-static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, void* user_ctx)
+static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, uint32_t retry_interval, void* user_ctx)
 {
     if (user_ctx == NULL)
     {
@@ -576,6 +670,7 @@ static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, v
             case PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING:
             case PROV_DEVICE_TRANSPORT_STATUS_UNASSIGNED:
                 prov_info->prov_state = CLIENT_STATE_STATUS_SEND;
+                schedule_status_request(prov_info, retry_interval);
                 if (transport_status == PROV_DEVICE_TRANSPORT_STATUS_UNASSIGNED)
                 {
                     if (prov_info->register_status_cb != NULL)
@@ -599,6 +694,7 @@ static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, v
                 else if (prov_info->prov_state == CLIENT_STATE_STATUS_SENT)
                 {
                     prov_info->prov_state = CLIENT_STATE_STATUS_SEND;
+                    schedule_status_request(prov_info, retry_interval);
                 }
                 else
                 {
@@ -632,6 +728,7 @@ static void destroy_instance(PROV_INSTANCE_INFO* prov_info)
     free(prov_info->registration_id);
     prov_auth_destroy(prov_info->prov_auth_handle);
     tickcounter_destroy(prov_info->tick_counter);
+    prov_registration_cache_destroy(prov_info->registration_cache);
     free(prov_info);
 }
 
@@ -706,9 +803,10 @@ PROV_DEVICE_LL_HANDLE Prov_Device_LL_Create(const char* uri, const char* id_scop
                 }
                 else
                 {
-                    // Ensure that we are passed the throttling time and send on the first send
                     (void)tickcounter_get_current_ms(result->tick_counter, &result->status_throttle);
-                    result->status_throttle += (PROV_GET_THROTTLE_TIME * 1000);
+                    result->polling_policy.initial_interval_secs = PROV_GET_THROTTLE_TIME;
+                    result->polling_policy.max_interval_secs = PROV_MAX_POLL_INTERVAL;
+                    result->polling_policy.max_jitter_percent = PROV_POLL_JITTER_PERCENT;
                 }
             }
         }
@@ -785,6 +883,11 @@ PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle,
                 }
                 else
                 {
+                    if (handle->registration_cache != NULL)
+                    {
+                        const unsigned char* ek_data = BUFFER_u_char(ek_value);
+                        set_registration_cache_identity(handle, ek_data, BUFFER_length(ek_value));
+                    }
                     result = PROV_DEVICE_RESULT_OK;
                 }
             }
@@ -827,6 +930,7 @@ PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle,
                     }
                     else
                     {
+                        set_registration_cache_identity(handle, (const unsigned char*)x509_cert, strlen(x509_cert));
                         result = PROV_DEVICE_RESULT_OK;
                     }
                     free(x509_cert);
@@ -835,6 +939,7 @@ PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle,
             }
             else
             {
+                set_registration_cache_identity(handle, (const unsigned char*)handle->registration_id, strlen(handle->registration_id));
                 result = PROV_DEVICE_RESULT_OK;
             }
         }
@@ -847,7 +952,13 @@ PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle,
             handle->register_status_cb = reg_status_cb;
             handle->status_user_ctx = status_ctx;
 
-            if (handle->prov_transport_protocol->prov_transport_open(handle->transport_handle, handle->registration_id, ek_value, srk_value, on_transport_registration_data, handle, on_transport_status, handle, prov_transport_challenge_callback, handle) != 0)
+            /* Codes_SRS_PROV_CLIENT_07_037: [ If the registration cache holds a valid entry for the device identity, Prov_Device_LL_Register_Device shall not contact the service and shall report the cached assignment on the next DoWork call. ] */
+            if (handle->registration_cache != NULL && prov_registration_cache_load(handle->registration_cache, &handle->iothub_info.iothub_url, &handle->iothub_info.device_id) == 0)
+            {
+                handle->prov_state = CLIENT_STATE_CACHED;
+                result = PROV_DEVICE_RESULT_OK;
+            }
+            else if (handle->prov_transport_protocol->prov_transport_open(handle->transport_handle, handle->registration_id, ek_value, srk_value, on_transport_registration_data, handle, on_transport_status, handle, prov_transport_challenge_callback, handle) != 0)
             {
                 LogError("Failure establishing  connection");
                 if (!handle->user_supplied_reg_id)
@@ -865,6 +976,8 @@ PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle,
             else
             {
                 handle->prov_state = CLIENT_STATE_REGISTER_SEND;
+                handle->status_attempts = 0;
+                seed_status_jitter(handle);
                 /* Codes_SRS_PROV_CLIENT_07_009: [ Upon success Prov_Device_LL_Register_Device shall return PROV_CLIENT_OK. ] */
                 result = PROV_DEVICE_RESULT_OK;
             }
@@ -884,10 +997,17 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
         /* Codes_SRS_PROV_CLIENT_07_011: [ Prov_Device_LL_DoWork shall call the underlying http_client_dowork function ] */
         prov_info->prov_transport_protocol->prov_transport_dowork(prov_info->transport_handle);
 
-        if (prov_info->is_connected || prov_info->prov_state == CLIENT_STATE_ERROR)
+        if (prov_info->is_connected || prov_info->prov_state == CLIENT_STATE_ERROR || prov_info->prov_state == CLIENT_STATE_CACHED)
         {
             switch (prov_info->prov_state)
             {
+                case CLIENT_STATE_CACHED:
+                    /* Codes_SRS_PROV_CLIENT_07_038: [ CLIENT_STATE_CACHED shall call the register_callback with PROV_DEVICE_RESULT_OK and the cached iothub uri and device id. ] */
+                    prov_info->register_callback(PROV_DEVICE_RESULT_OK, prov_info->iothub_info.iothub_url, prov_info->iothub_info.device_id, prov_info->user_context);
+                    cleanup_prov_info(prov_info);
+                    prov_info->prov_state = CLIENT_STATE_READY;
+                    break;
+
                 case CLIENT_STATE_REGISTER_SEND:
                     /* Codes_SRS_PROV_CLIENT_07_013: [ CLIENT_STATE_REGISTER_SEND which shall construct an initial call to the service with endorsement information ] */
                     if (prov_info->prov_transport_protocol->prov_transport_register(prov_info->transport_handle, prov_transport_process_json_reply, prov_info) != 0)
@@ -915,7 +1035,8 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
                         prov_info->error_reason = PROV_DEVICE_RESULT_ERROR;
                         prov_info->prov_state = CLIENT_STATE_ERROR;
                     }
-                    else if ( (current_time - prov_info->status_throttle) / 1000 > PROV_GET_THROTTLE_TIME)
+                    /* Codes_SRS_PROV_CLIENT_07_045: [ CLIENT_STATE_STATUS_SEND shall not send the operation status request until the scheduled wait has elapsed since the last service reply. ] */
+                    else if (current_time - prov_info->status_throttle >= prov_info->status_interval)
                     {
                         /* Codes_SRS_PROV_CLIENT_07_026: [ Upon receiving the reply of the CLIENT_STATE_URL_REQ_SEND message from  iothub_client shall process the the reply of the CLIENT_STATE_URL_REQ_SEND state ] */
                         if (prov_info->prov_transport_protocol->prov_transport_get_op_status(prov_info->transport_handle) != 0)
@@ -937,7 +1058,6 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
                                 prov_info->prov_state = CLIENT_STATE_ERROR;
                             }
                         }
-                        prov_info->status_throttle = current_time;
                     }
                     break;
                 }
@@ -1052,6 +1172,27 @@ PROV_DEVICE_RESULT Prov_Device_LL_SetOption(PROV_DEVICE_LL_HANDLE handle, const
                 result = PROV_DEVICE_RESULT_OK;
             }
         }
+        else if (strcmp(PROV_OPTION_POLLING_POLICY, option_name) == 0)
+        {
+            const PROV_POLLING_POLICY* polling_policy = (const PROV_POLLING_POLICY*)value;
+            /* Codes_SRS_PROV_CLIENT_07_046: [ If value is NULL, initial_interval_secs is 0, max_interval_secs is less than initial_interval_secs or max_jitter_percent is greater than 100, setting PROV_OPTION_POLLING_POLICY shall fail. ] */
+            if (polling_policy == NULL)
+            {
+                LogError("value must be set to the polling policy");
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            else if (polling_policy->initial_interval_secs == 0 || polling_policy->max_interval_secs < polling_policy->initial_interval_secs || polling_policy->max_jitter_percent > 100)
+            {
+                LogError("Invalid polling policy initial: %lu max: %lu jitter: %lu", (unsigned long)polling_policy->initial_interval_secs, (unsigned long)polling_policy->max_interval_secs, (unsigned long)polling_policy->max_jitter_percent);
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            else
+            {
+                /* Codes_SRS_PROV_CLIENT_07_047: [ PROV_OPTION_POLLING_POLICY shall replace the polling policy used for operation status requests. ] */
+                handle->polling_policy = *polling_policy;
+                result = PROV_DEVICE_RESULT_OK;
+            }
+        }
         else if (strcmp(PROV_REGISTRATION_ID, option_name) == 0)
         {
             if (handle->prov_state != CLIENT_STATE_READY)
@@ -1090,6 +1231,51 @@ PROV_DEVICE_RESULT Prov_Device_LL_SetOption(PROV_DEVICE_LL_HANDLE handle, const
                 }
             }
         }
+        else if (strcmp(PROV_OPTION_REGISTRATION_CACHE, option_name) == 0)
+        {
+            const PROV_REGISTRATION_CACHE_OPTIONS* cache_options = (const PROV_REGISTRATION_CACHE_OPTIONS*)value;
+            PROV_REGISTRATION_CACHE_HANDLE registration_cache;
+            /* Codes_SRS_PROV_CLIENT_07_039: [ If the registration has begun or value is NULL, setting PROV_OPTION_REGISTRATION_CACHE shall fail. ] */
+            if (handle->prov_state != CLIENT_STATE_READY)
+            {
+                LogError("registration cache cannot be set after registration has begun");
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            else if (cache_options == NULL)
+            {
+                LogError("value must be set to the registration cache options");
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            /* Codes_SRS_PROV_CLIENT_07_040: [ PROV_OPTION_REGISTRATION_CACHE shall create the registration cache, signing entries with the security module for tpm and symmetric key devices. ] */
+            else if ((registration_cache = prov_registration_cache_create(cache_options, handle->hsm_type == PROV_AUTH_TYPE_X509 ? NULL : registration_cache_sign_callback, handle)) == NULL)
+            {
+                LogError("Failure creating registration cache");
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            else
+            {
+                if (handle->registration_cache != NULL)
+                {
+                    prov_registration_cache_destroy(handle->registration_cache);
+                }
+                handle->registration_cache = registration_cache;
+                result = PROV_DEVICE_RESULT_OK;
+            }
+        }
+        else if (strcmp(PROV_OPTION_REGISTRATION_CACHE_INVALIDATE, option_name) == 0)
+        {
+            /* Codes_SRS_PROV_CLIENT_07_041: [ PROV_OPTION_REGISTRATION_CACHE_INVALIDATE shall clear the cached registration so the next registration contacts the service. ] */
+            if (handle->registration_cache == NULL)
+            {
+                LogError("registration cache has not been enabled");
+                result = PROV_DEVICE_RESULT_ERROR;
+            }
+            else
+            {
+                prov_registration_cache_invalidate(handle->registration_cache);
+                result = PROV_DEVICE_RESULT_OK;
+            }
+        }
         else
         {
             result = PROV_DEVICE_RESULT_OK;
@@ -0,0 +1,633 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "parson.h"
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/hmacsha256.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+
+#include "azure_prov_client/internal/prov_registration_cache.h"
+
+static const char* const JSON_NODE_SCOPE_ID = "scopeId";
+static const char* const JSON_NODE_REGISTRATION_ID = "registrationId";
+static const char* const JSON_NODE_FINGERPRINT = "fingerprint";
+static const char* const JSON_NODE_ASSIGNED_HUB = "assignedHub";
+static const char* const JSON_NODE_DEVICE_ID = "deviceId";
+static const char* const JSON_NODE_EXPIRES = "expiresUtc";
+static const char* const JSON_NODE_SIGNATURE = "signature";
+
+static const char* const CACHE_ENTRY_DIGEST_FMT = "%s\n%s\n%s\n%s\n%s\n%lu";
+static const char* const CACHE_FILE_TEMP_EXT = ".tmp";
+
+#define EPOCH_TIME_T_VALUE                  (time_t)0
+#define REGISTRATION_CACHE_DEFAULT_LIFETIME (7 * 24 * 60 * 60)
+#define REGISTRATION_CACHE_MAX_FILE_SIZE    4096
+
+typedef struct PROV_REGISTRATION_CACHE_INFO_TAG
+{
+    PROV_REGISTRATION_CACHE_STORE store;
+    char* file_path;
+
+    unsigned char* integrity_key;
+    size_t integrity_key_len;
+    PROV_REGISTRATION_CACHE_SIGN sign_callback;
+    void* sign_ctx;
+
+    size_t lifetime_secs;
+
+    char* scope_id;
+    char* registration_id;
+    char* fingerprint;
+} PROV_REGISTRATION_CACHE_INFO;
+
+static char* file_store_read(void* store_ctx)
+{
+    char* result;
+    FILE* cache_file;
+    if ((cache_file = fopen((const char*)store_ctx, "rb")) == NULL)
+    {
+        // Not having a cache file is the normal first boot case
+        result = NULL;
+    }
+    else
+    {
+        // Read one byte past the limit so an oversized file is detected
+        if ((result = (char*)malloc(REGISTRATION_CACHE_MAX_FILE_SIZE + 1)) == NULL)
+        {
+            LogError("Failure allocating cache file content");
+        }
+        else
+        {
+            size_t read_len = fread(result, 1, REGISTRATION_CACHE_MAX_FILE_SIZE + 1, cache_file);
+            if (read_len == 0 || read_len > REGISTRATION_CACHE_MAX_FILE_SIZE)
+            {
+                LogError("Invalid registration cache file size");
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                result[read_len] = '\0';
+            }
+        }
+        (void)fclose(cache_file);
+    }
+    return result;
+}
+
+static int file_store_write(const char* content, void* store_ctx)
+{
+    int result;
+    const char* file_path = (const char*)store_ctx;
+    size_t content_len = strlen(content);
+    char* temp_path;
+    FILE* cache_file;
+
+    if ((temp_path = (char*)malloc(strlen(file_path) + strlen(CACHE_FILE_TEMP_EXT) + 1)) == NULL)
+    {
+        LogError("Failure allocating temporary cache file path");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)strcpy(temp_path, file_path);
+        (void)strcat(temp_path, CACHE_FILE_TEMP_EXT);
+
+        // Write the whole entry aside and swap it in so an interrupted write never leaves half an entry
+        if ((cache_file = fopen(temp_path, "wb")) == NULL)
+        {
+            LogError("Failure opening registration cache file %s", temp_path);
+            result = __FAILURE__;
+        }
+        else
+        {
+            bool written = (fwrite(content, 1, content_len, cache_file) == content_len) && (fflush(cache_file) == 0);
+            if (fclose(cache_file) != 0 || !written)
+            {
+                LogError("Failure writing registration cache file %s", temp_path);
+                (void)remove(temp_path);
+                result = __FAILURE__;
+            }
+            else
+            {
+                // rename does not replace an existing file on every platform
+                (void)remove(file_path);
+                if (rename(temp_path, file_path) != 0)
+                {
+                    LogError("Failure renaming registration cache file to %s", file_path);
+                    (void)remove(temp_path);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+            }
+        }
+        free(temp_path);
+    }
+    return result;
+}
+
+static void file_store_clear(void* store_ctx)
+{
+    (void)remove((const char*)store_ctx);
+}
+
+static size_t get_current_utc_secs(void)
+{
+    return (size_t)(difftime(get_time(NULL), EPOCH_TIME_T_VALUE) + 0);
+}
+
+static STRING_HANDLE encode_sha256(const unsigned char* data, size_t data_len)
+{
+    STRING_HANDLE result;
+    SHA256Context sha_ctx;
+    uint8_t msg_digest[SHA256HashSize];
+
+    if (SHA256Reset(&sha_ctx) != 0)
+    {
+        LogError("Failed sha256 reset");
+        result = NULL;
+    }
+    else if (SHA256Input(&sha_ctx, data, (unsigned int)data_len) != 0)
+    {
+        LogError("Failed SHA256Input");
+        result = NULL;
+    }
+    else if (SHA256Result(&sha_ctx, msg_digest) != 0)
+    {
+        LogError("Failed SHA256Result");
+        result = NULL;
+    }
+    else if ((result = Base64_Encode_Bytes(msg_digest, SHA256HashSize)) == NULL)
+    {
+        LogError("Failed encoding sha256 digest");
+    }
+    return result;
+}
+
+static char* construct_entry_signature(PROV_REGISTRATION_CACHE_INFO* cache_info, const char* iothub_uri, const char* device_id, size_t expires_utc)
+{
+    char* result;
+    STRING_HANDLE entry_value;
+    STRING_HANDLE entry_digest;
+
+    if ((entry_value = STRING_construct_sprintf(CACHE_ENTRY_DIGEST_FMT, cache_info->scope_id, cache_info->registration_id, cache_info->fingerprint, iothub_uri, device_id, (unsigned long)expires_utc)) == NULL)
+    {
+        LogError("Failure constructing cache entry value");
+        result = NULL;
+    }
+    else
+    {
+        const char* entry_data = STRING_c_str(entry_value);
+        if ((entry_digest = encode_sha256((const unsigned char*)entry_data, strlen(entry_data))) == NULL)
+        {
+            LogError("Failure hashing cache entry");
+            result = NULL;
+        }
+        else
+        {
+            const char* digest_value = STRING_c_str(entry_digest);
+            if (cache_info->integrity_key != NULL)
+            {
+                BUFFER_HANDLE output_hash;
+                STRING_HANDLE encoded_hash;
+                if ((output_hash = BUFFER_new()) == NULL)
+                {
+                    LogError("Failed allocating output hash buffer");
+                    result = NULL;
+                }
+                else
+                {
+                    if (HMACSHA256_ComputeHash(cache_info->integrity_key, cache_info->integrity_key_len, (const unsigned char*)digest_value, strlen(digest_value), output_hash) != HMACSHA256_OK)
+                    {
+                        LogError("Failed computing HMAC Hash");
+                        result = NULL;
+                    }
+                    else
+                    {
+                        const unsigned char* hash_data = BUFFER_u_char(output_hash);
+                        if ((encoded_hash = Base64_Encode_Bytes(hash_data, BUFFER_length(output_hash))) == NULL)
+                        {
+                            LogError("Failed encoding HMAC Hash");
+                            result = NULL;
+                        }
+                        else
+                        {
+                            if (mallocAndStrcpy_s(&result, STRING_c_str(encoded_hash)) != 0)
+                            {
+                                LogError("Failed allocating signature");
+                                result = NULL;
+                            }
+                            STRING_delete(encoded_hash);
+                        }
+                    }
+                    BUFFER_delete(output_hash);
+                }
+            }
+            else if ((result = cache_info->sign_callback(digest_value, cache_info->sign_ctx)) == NULL)
+            {
+                LogError("Failure signing cache entry");
+            }
+            STRING_delete(entry_digest);
+        }
+        STRING_delete(entry_value);
+    }
+    return result;
+}
+
+static bool is_signature_equal(const char* expected, const char* actual)
+{
+    bool result;
+    size_t expected_len = strlen(expected);
+    if (expected_len != strlen(actual))
+    {
+        result = false;
+    }
+    else
+    {
+        // Compare every byte so the time taken does not reveal how much of the signature matched
+        unsigned char diff = 0;
+        size_t index;
+        for (index = 0; index < expected_len; index++)
+        {
+            diff |= (unsigned char)(expected[index] ^ actual[index]);
+        }
+        result = (diff == 0);
+    }
+    return result;
+}
+
+static int validate_cache_entry(PROV_REGISTRATION_CACHE_INFO* cache_info, JSON_Object* json_object, const char** iothub_uri, const char** device_id)
+{
+    int result;
+    const char* scope_id = json_object_get_string(json_object, JSON_NODE_SCOPE_ID);
+    const char* registration_id = json_object_get_string(json_object, JSON_NODE_REGISTRATION_ID);
+    const char* fingerprint = json_object_get_string(json_object, JSON_NODE_FINGERPRINT);
+    const char* signature = json_object_get_string(json_object, JSON_NODE_SIGNATURE);
+    JSON_Value* json_expires = json_object_get_value(json_object, JSON_NODE_EXPIRES);
+
+    *iothub_uri = json_object_get_string(json_object, JSON_NODE_ASSIGNED_HUB);
+    *device_id = json_object_get_string(json_object, JSON_NODE_DEVICE_ID);
+
+    if (scope_id == NULL || registration_id == NULL || fingerprint == NULL || signature == NULL || json_expires == NULL || *iothub_uri == NULL || *device_id == NULL)
+    {
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_022: [ If the stored entry is not a complete cache entry prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+        LogError("Registration cache entry is malformed");
+        result = __FAILURE__;
+    }
+    else if (strcmp(scope_id, cache_info->scope_id) != 0 || strcmp(registration_id, cache_info->registration_id) != 0 || strcmp(fingerprint, cache_info->fingerprint) != 0)
+    {
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_023: [ If the scope id, registration id or attestation fingerprint of the entry do not match the current identity prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+        LogInfo("Registration cache entry belongs to a different identity");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t current_time = get_current_utc_secs();
+        double expires_value = json_value_get_number(json_expires);
+        size_t expires_utc = (expires_value > 0) ? (size_t)expires_value : 0;
+
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_024: [ If the entry has expired, or expires further in the future than the configured lifetime, prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+        if (expires_utc <= current_time || (expires_utc - current_time) > cache_info->lifetime_secs)
+        {
+            LogInfo("Registration cache entry has expired");
+            result = __FAILURE__;
+        }
+        else
+        {
+            char* expected_signature;
+            if ((expected_signature = construct_entry_signature(cache_info, *iothub_uri, *device_id, expires_utc)) == NULL)
+            {
+                LogError("Failure constructing cache entry signature");
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* Codes_SRS_PROV_REGISTRATION_CACHE_07_025: [ If the signature of the entry does not match prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+                if (!is_signature_equal(expected_signature, signature))
+                {
+                    LogError("Registration cache entry failed the integrity check");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+                free(expected_signature);
+            }
+        }
+    }
+    return result;
+}
+
+PROV_REGISTRATION_CACHE_HANDLE prov_registration_cache_create(const PROV_REGISTRATION_CACHE_OPTIONS* options, PROV_REGISTRATION_CACHE_SIGN sign_callback, void* sign_ctx)
+{
+    PROV_REGISTRATION_CACHE_INFO* result;
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_001: [ If options is NULL, or neither store nor file_path are specified, prov_registration_cache_create shall return NULL. ] */
+    if (options == NULL || (options->store == NULL && options->file_path == NULL))
+    {
+        LogError("Invalid parameter specified options: %p", options);
+        result = NULL;
+    }
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_002: [ If store is specified and any of its functions are NULL, prov_registration_cache_create shall return NULL. ] */
+    else if (options->store != NULL && (options->store->cache_read == NULL || options->store->cache_write == NULL || options->store->cache_clear == NULL))
+    {
+        LogError("Invalid registration cache store specified");
+        result = NULL;
+    }
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_003: [ If integrity_key is NULL and sign_callback is NULL, or integrity_key_len is 0 with a non-NULL integrity_key, prov_registration_cache_create shall return NULL. ] */
+    else if ((options->integrity_key == NULL && sign_callback == NULL) || (options->integrity_key != NULL && options->integrity_key_len == 0))
+    {
+        LogError("No means of signing the registration cache was specified");
+        result = NULL;
+    }
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_004: [ prov_registration_cache_create shall allocate a PROV_REGISTRATION_CACHE_HANDLE and copy the options. ] */
+    else if ((result = (PROV_REGISTRATION_CACHE_INFO*)malloc(sizeof(PROV_REGISTRATION_CACHE_INFO))) == NULL)
+    {
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_005: [ If any error is encountered prov_registration_cache_create shall return NULL. ] */
+        LogError("Failure allocating registration cache");
+    }
+    else
+    {
+        memset(result, 0, sizeof(PROV_REGISTRATION_CACHE_INFO));
+        result->sign_callback = sign_callback;
+        result->sign_ctx = sign_ctx;
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_006: [ If lifetime_secs is 0 the entry lifetime shall default to 7 days. ] */
+        result->lifetime_secs = options->lifetime_secs == 0 ? REGISTRATION_CACHE_DEFAULT_LIFETIME : options->lifetime_secs;
+
+        if (options->store == NULL && mallocAndStrcpy_s(&result->file_path, options->file_path) != 0)
+        {
+            /* Codes_SRS_PROV_REGISTRATION_CACHE_07_005: [ If any error is encountered prov_registration_cache_create shall return NULL. ] */
+            LogError("Failure allocating registration cache file path");
+            free(result);
+            result = NULL;
+        }
+        else if (options->integrity_key != NULL && (result->integrity_key = (unsigned char*)malloc(options->integrity_key_len)) == NULL)
+        {
+            /* Codes_SRS_PROV_REGISTRATION_CACHE_07_005: [ If any error is encountered prov_registration_cache_create shall return NULL. ] */
+            LogError("Failure allocating registration cache integrity key");
+            free(result->file_path);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            if (options->integrity_key != NULL)
+            {
+                memcpy(result->integrity_key, options->integrity_key, options->integrity_key_len);
+                result->integrity_key_len = options->integrity_key_len;
+            }
+
+            if (options->store == NULL)
+            {
+                /* Codes_SRS_PROV_REGISTRATION_CACHE_07_007: [ If store is NULL the cache shall be kept in the file specified by file_path. ] */
+                result->store.cache_read = file_store_read;
+                result->store.cache_write = file_store_write;
+                result->store.cache_clear = file_store_clear;
+                result->store.store_ctx = result->file_path;
+            }
+            else
+            {
+                result->store = *options->store;
+            }
+        }
+    }
+    return result;
+}
+
+void prov_registration_cache_destroy(PROV_REGISTRATION_CACHE_HANDLE handle)
+{
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_008: [ If handle is NULL, prov_registration_cache_destroy shall do nothing. ] */
+    if (handle != NULL)
+    {
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_009: [ prov_registration_cache_destroy shall free all resources associated with the handle. ] */
+        if (handle->integrity_key != NULL)
+        {
+            memset(handle->integrity_key, 0, handle->integrity_key_len);
+            free(handle->integrity_key);
+        }
+        free(handle->file_path);
+        free(handle->scope_id);
+        free(handle->registration_id);
+        free(handle->fingerprint);
+        free(handle);
+    }
+}
+
+int prov_registration_cache_set_identity(PROV_REGISTRATION_CACHE_HANDLE handle, const char* scope_id, const char* registration_id, const unsigned char* attestation, size_t attestation_len)
+{
+    int result;
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_010: [ If handle, scope_id, registration_id or attestation are NULL or attestation_len is 0, prov_registration_cache_set_identity shall return a non-zero value. ] */
+    if (handle == NULL || scope_id == NULL || registration_id == NULL || attestation == NULL || attestation_len == 0)
+    {
+        LogError("Invalid parameter specified handle: %p, scope_id: %p, registration_id: %p, attestation: %p, attestation_len: %lu", handle, scope_id, registration_id, attestation, (unsigned long)attestation_len);
+        result = __FAILURE__;
+    }
+    else
+    {
+        STRING_HANDLE fingerprint;
+        char* temp_scope = NULL;
+        char* temp_reg_id = NULL;
+        char* temp_fingerprint = NULL;
+
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_011: [ prov_registration_cache_set_identity shall store the scope id, registration id and the base64 encoded SHA256 fingerprint of the attestation. ] */
+        if ((fingerprint = encode_sha256(attestation, attestation_len)) == NULL)
+        {
+            /* Codes_SRS_PROV_REGISTRATION_CACHE_07_012: [ If any error is encountered prov_registration_cache_set_identity shall return a non-zero value. ] */
+            LogError("Failure computing attestation fingerprint");
+            result = __FAILURE__;
+        }
+        else
+        {
+            if (mallocAndStrcpy_s(&temp_fingerprint, STRING_c_str(fingerprint)) != 0 ||
+                mallocAndStrcpy_s(&temp_scope, scope_id) != 0 ||
+                mallocAndStrcpy_s(&temp_reg_id, registration_id) != 0)
+            {
+                /* Codes_SRS_PROV_REGISTRATION_CACHE_07_012: [ If any error is encountered prov_registration_cache_set_identity shall return a non-zero value. ] */
+                LogError("Failure allocating registration cache identity");
+                free(temp_fingerprint);
+                free(temp_scope);
+                result = __FAILURE__;
+            }
+            else
+            {
+                free(handle->fingerprint);
+                free(handle->scope_id);
+                free(handle->registration_id);
+                handle->fingerprint = temp_fingerprint;
+                handle->scope_id = temp_scope;
+                handle->registration_id = temp_reg_id;
+                result = 0;
+            }
+            STRING_delete(fingerprint);
+        }
+    }
+    return result;
+}
+
+int prov_registration_cache_load(PROV_REGISTRATION_CACHE_HANDLE handle, char** iothub_uri, char** device_id)
+{
+    int result;
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_013: [ If handle, iothub_uri or device_id are NULL, prov_registration_cache_load shall return a non-zero value. ] */
+    if (handle == NULL || iothub_uri == NULL || device_id == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, iothub_uri: %p, device_id: %p", handle, iothub_uri, device_id);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_014: [ If the identity has not been set, prov_registration_cache_load shall return a non-zero value. ] */
+    else if (handle->fingerprint == NULL)
+    {
+        LogError("registration cache identity has not been set");
+        result = __FAILURE__;
+    }
+    else
+    {
+        char* content;
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_015: [ prov_registration_cache_load shall read the entry from the store. ] */
+        if ((content = handle->store.cache_read(handle->store.store_ctx)) == NULL)
+        {
+            /* Codes_SRS_PROV_REGISTRATION_CACHE_07_016: [ If the store is empty prov_registration_cache_load shall return a non-zero value. ] */
+            result = __FAILURE__;
+        }
+        else
+        {
+            JSON_Value* root_value;
+            JSON_Object* json_object;
+            const char* cached_uri;
+            const char* cached_device_id;
+
+            if ((root_value = json_parse_string(content)) == NULL)
+            {
+                /* Codes_SRS_PROV_REGISTRATION_CACHE_07_022: [ If the stored entry is not a complete cache entry prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+                LogError("Failure parsing registration cache entry");
+                handle->store.cache_clear(handle->store.store_ctx);
+                result = __FAILURE__;
+            }
+            else
+            {
+                if ((json_object = json_value_get_object(root_value)) == NULL || validate_cache_entry(handle, json_object, &cached_uri, &cached_device_id) != 0)
+                {
+                    handle->store.cache_clear(handle->store.store_ctx);
+                    result = __FAILURE__;
+                }
+                /* Codes_SRS_PROV_REGISTRATION_CACHE_07_017: [ On a valid entry prov_registration_cache_load shall return allocated copies of the iothub uri and device id and return 0. ] */
+                else if (mallocAndStrcpy_s(iothub_uri, cached_uri) != 0)
+                {
+                    LogError("Failure allocating cached iothub uri");
+                    result = __FAILURE__;
+                }
+                else if (mallocAndStrcpy_s(device_id, cached_device_id) != 0)
+                {
+                    LogError("Failure allocating cached device id");
+                    free(*iothub_uri);
+                    *iothub_uri = NULL;
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+                json_value_free(root_value);
+            }
+            free(content);
+        }
+    }
+    return result;
+}
+
+int prov_registration_cache_save(PROV_REGISTRATION_CACHE_HANDLE handle, const char* iothub_uri, const char* device_id)
+{
+    int result;
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_018: [ If handle, iothub_uri or device_id are NULL, or the identity has not been set, prov_registration_cache_save shall return a non-zero value. ] */
+    if (handle == NULL || iothub_uri == NULL || device_id == NULL || handle->fingerprint == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, iothub_uri: %p, device_id: %p", handle, iothub_uri, device_id);
+        result = __FAILURE__;
+    }
+    else
+    {
+        JSON_Value* root_value;
+        JSON_Object* json_object;
+        char* signature;
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_019: [ prov_registration_cache_save shall sign the entry, including its expiry time, with the integrity key or the sign_callback. ] */
+        size_t expires_utc = get_current_utc_secs() + handle->lifetime_secs;
+
+        if ((signature = construct_entry_signature(handle, iothub_uri, device_id, expires_utc)) == NULL)
+        {
+            /* Codes_SRS_PROV_REGISTRATION_CACHE_07_021: [ If any error is encountered prov_registration_cache_save shall return a non-zero value. ] */
+            LogError("Failure signing registration cache entry");
+            result = __FAILURE__;
+        }
+        else
+        {
+            if ((root_value = json_value_init_object()) == NULL)
+            {
+                LogError("Failure creating registration cache entry");
+                result = __FAILURE__;
+            }
+            else
+            {
+                char* content;
+                json_object = json_value_get_object(root_value);
+                if (json_object_set_string(json_object, JSON_NODE_SCOPE_ID, handle->scope_id) != JSONSuccess ||
+                    json_object_set_string(json_object, JSON_NODE_REGISTRATION_ID, handle->registration_id) != JSONSuccess ||
+                    json_object_set_string(json_object, JSON_NODE_FINGERPRINT, handle->fingerprint) != JSONSuccess ||
+                    json_object_set_string(json_object, JSON_NODE_ASSIGNED_HUB, iothub_uri) != JSONSuccess ||
+                    json_object_set_string(json_object, JSON_NODE_DEVICE_ID, device_id) != JSONSuccess ||
+                    json_object_set_number(json_object, JSON_NODE_EXPIRES, (double)expires_utc) != JSONSuccess ||
+                    json_object_set_string(json_object, JSON_NODE_SIGNATURE, signature) != JSONSuccess)
+                {
+                    LogError("Failure constructing registration cache entry");
+                    result = __FAILURE__;
+                }
+                else if ((content = json_serialize_to_string(root_value)) == NULL)
+                {
+                    LogError("Failure serializing registration cache entry");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_020: [ prov_registration_cache_save shall write the entry to the store. ] */
+                    if (handle->store.cache_write(content, handle->store.store_ctx) != 0)
+                    {
+                        LogError("Failure writing registration cache entry");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        result = 0;
+                    }
+                    json_free_serialized_string(content);
+                }
+                json_value_free(root_value);
+            }
+            free(signature);
+        }
+    }
+    return result;
+}
+
+void prov_registration_cache_invalidate(PROV_REGISTRATION_CACHE_HANDLE handle)
+{
+    /* Codes_SRS_PROV_REGISTRATION_CACHE_07_026: [ If handle is NULL, prov_registration_cache_invalidate shall do nothing. ] */
+    if (handle != NULL)
+    {
+        /* Codes_SRS_PROV_REGISTRATION_CACHE_07_027: [ prov_registration_cache_invalidate shall clear the store. ] */
+        handle->store.cache_clear(handle->store.store_ctx);
+    }
+}
@@ -39,6 +39,7 @@ static const char* const AMQP_API_VERSION_KEY = "com.microsoft:api-version";
 
 static const char* const AMQP_OP_TYPE_PROPERTY = "iotdps-operation-type";
 static const char* const AMQP_OPERATION_ID = "iotdps-operation-id";
+static const char* const AMQP_RETRY_AFTER = "retry-after";
 
 typedef enum AMQP_TRANSPORT_STATE_TAG
 {
@@ -95,6 +96,7 @@ typedef struct PROV_TRANSPORT_AMQP_INFO_TAG
     char* api_version;
 
     char* payload_data;
+    uint32_t retry_after_value;
 
     bool log_trace;
 
@@ -182,7 +184,7 @@ static void on_message_sender_state_changed_callback(void* context, MESSAGE_SEND
                         amqp_info->amqp_state = AMQP_STATE_CONNECTED;
                         if (amqp_info->status_cb != NULL)
                         {
-                            amqp_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, amqp_info->status_ctx);
+                            amqp_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, amqp_info->status_ctx);
                         }
                     }
                     break;
@@ -220,7 +222,7 @@ static void on_message_receiver_state_changed_callback(const void* user_ctx, MES
                     amqp_info->amqp_state = AMQP_STATE_CONNECTED;
                     if (amqp_info->status_cb != NULL)
                     {
-                        amqp_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, amqp_info->status_ctx);
+                        amqp_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, amqp_info->status_ctx);
                     }
                 }
                 break;
@@ -262,6 +264,68 @@ static STRING_HANDLE construct_link_address(PROV_TRANSPORT_AMQP_INFO* amqp_info)
     return result;
 }
 
+static uint32_t get_retry_after_value(MESSAGE_HANDLE message)
+{
+    uint32_t result = 0;
+    AMQP_VALUE app_properties = NULL;
+    if (message_get_application_properties(message, &app_properties) != 0)
+    {
+        LogError("Failure getting the message application properties");
+    }
+    else if (app_properties != NULL)
+    {
+        AMQP_VALUE prop_map;
+        AMQP_VALUE prop_key;
+        if ((prop_map = amqpvalue_get_inplace_described_value(app_properties)) == NULL)
+        {
+            LogError("Failure getting the application properties map");
+        }
+        else if ((prop_key = amqpvalue_create_string(AMQP_RETRY_AFTER)) == NULL)
+        {
+            LogError("Failure creating the retry-after property key");
+        }
+        else
+        {
+            AMQP_VALUE prop_value = amqpvalue_get_map_value(prop_map, prop_key);
+            if (prop_value != NULL)
+            {
+                const char* retry_string;
+                uint32_t retry_uint;
+                int32_t retry_int;
+                // The service may send the value as a string or as a number
+                switch (amqpvalue_get_type(prop_value))
+                {
+                    case AMQP_TYPE_STRING:
+                        if (amqpvalue_get_string(prop_value, &retry_string) == 0 && *retry_string >= '0' && *retry_string <= '9')
+                        {
+                            unsigned long retry_secs = strtoul(retry_string, NULL, 10);
+                            result = retry_secs > UINT32_MAX ? UINT32_MAX : (uint32_t)retry_secs;
+                        }
+                        break;
+                    case AMQP_TYPE_UINT:
+                        if (amqpvalue_get_uint(prop_value, &retry_uint) == 0)
+                        {
+                            result = retry_uint;
+                        }
+                        break;
+                    case AMQP_TYPE_INT:
+                        if (amqpvalue_get_int(prop_value, &retry_int) == 0 && retry_int > 0)
+                        {
+                            result = (uint32_t)retry_int;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                amqpvalue_destroy(prop_value);
+            }
+            amqpvalue_destroy(prop_key);
+        }
+        amqpvalue_destroy(app_properties);
+    }
+    return result;
+}
+
 static AMQP_VALUE on_message_recv_callback(const void* user_ctx, MESSAGE_HANDLE message)
 {
     AMQP_VALUE result;
@@ -312,6 +376,8 @@ static AMQP_VALUE on_message_recv_callback(const void* user_ctx, MESSAGE_HANDLE
             {
                 memset(amqp_info->payload_data, 0, binary_data.length + 1);
                 memcpy(amqp_info->payload_data, binary_data.bytes, binary_data.length);
+                /* Codes_PROV_TRANSPORT_AMQP_COMMON_07_062: [ on_message_recv_callback shall store the retry-after application property of the message, or 0 if the message does not contain one. ] */
+                amqp_info->retry_after_value = get_retry_after_value(message);
                 if (amqp_info->transport_state == TRANSPORT_CLIENT_STATE_REG_SENT)
                 {
                     amqp_info->transport_state = TRANSPORT_CLIENT_STATE_REG_RECV;
@@ -1300,7 +1366,8 @@ void prov_transport_common_amqp_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
                                 {
                                     if (amqp_info->status_cb != NULL)
                                     {
-                                        amqp_info->status_cb(parse_info->prov_status, amqp_info->status_ctx);
+                                        /* Codes_PROV_TRANSPORT_AMQP_COMMON_07_063: [ prov_transport_common_amqp_dowork shall pass the stored retry-after value to the status callback. ] */
+                                        amqp_info->status_cb(parse_info->prov_status, amqp_info->retry_after_value, amqp_info->status_ctx);
                                     }
                                 }
                                 break;
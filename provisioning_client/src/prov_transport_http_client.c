@@ -31,6 +31,7 @@ static const char* const HEADER_USER_AGENT = "UserAgent";
 static const char* const HEADER_ACCEPT = "Accept";
 static const char* const HEADER_CONTENT_TYPE = "Content-Type";
 static const char* const HEADER_CONNECTION = "Connection";
+static const char* const HEADER_RETRY_AFTER = "Retry-After";
 static const char* const USER_AGENT_VALUE = "prov_device_client/1.0";
 static const char* const ACCEPT_VALUE = "application/json";
 static const char* const CONTENT_TYPE_VALUE = "application/json; charset=utf-8";
@@ -93,6 +94,7 @@ typedef struct PROV_TRANSPORT_HTTP_INFO_TAG
 
     char* payload_data;
     unsigned int http_status_code;
+    uint32_t retry_after_value;
 
     bool http_connected;
     bool log_trace;
@@ -120,9 +122,21 @@ static void on_http_error(void* callback_ctx, HTTP_CALLBACK_REASON error_result)
     }
 }
 
+static uint32_t get_retry_after_value(HTTP_HEADERS_HANDLE response_headers)
+{
+    uint32_t result = 0;
+    const char* retry_after;
+    // Only the delay-seconds form is honored, an HTTP-date leaves the interval to the client's polling policy
+    if (response_headers != NULL && (retry_after = HTTPHeaders_FindHeaderValue(response_headers, HEADER_RETRY_AFTER)) != NULL && *retry_after >= '0' && *retry_after <= '9')
+    {
+        unsigned long retry_secs = strtoul(retry_after, NULL, 10);
+        result = retry_secs > UINT32_MAX ? UINT32_MAX : (uint32_t)retry_secs;
+    }
+    return result;
+}
+
 static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_result, const unsigned char* content, size_t content_len, unsigned int status_code, HTTP_HEADERS_HANDLE responseHeadersHandle)
 {
-    (void)responseHeadersHandle;
     if (callback_ctx != NULL)
     {
         PROV_TRANSPORT_HTTP_INFO* http_info = (PROV_TRANSPORT_HTTP_INFO*)callback_ctx;
@@ -134,6 +148,8 @@ static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_
         }
         else if ((status_code >= HTTP_STATUS_CODE_OK && status_code <= HTTP_STATUS_CODE_OK_MAX) || status_code == HTTP_STATUS_CODE_UNAUTHORIZED)
         {
+            /* Codes_PROV_TRANSPORT_HTTP_CLIENT_07_056: [ on_http_reply_recv shall store the delay-seconds value of the Retry-After response header, or 0 if the header is absent. ] */
+            http_info->retry_after_value = get_retry_after_value(responseHeadersHandle);
             if (content != NULL && content_len > 0)
             {
                 /* Codes_PROV_TRANSPORT_HTTP_CLIENT_07_038: [ prov_transport_http_dowork shall free the payload_data ] */
@@ -175,6 +191,8 @@ static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_
         }
         else if (status_code >= PROV_STATUS_CODE_TRANSIENT_ERROR)
         {
+            /* Codes_PROV_TRANSPORT_HTTP_CLIENT_07_056: [ on_http_reply_recv shall store the delay-seconds value of the Retry-After response header, or 0 if the header is absent. ] */
+            http_info->retry_after_value = get_retry_after_value(responseHeadersHandle);
             // On transient error reset the transport to send state
             http_info->transport_state = TRANSPORT_CLIENT_STATE_TRANSIENT;
         }
@@ -199,7 +217,7 @@ static void on_http_connected(void* callback_ctx, HTTP_CALLBACK_REASON open_resu
         {
             if (http_info->status_cb != NULL)
             {
-                http_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, http_info->status_ctx);
+                http_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, http_info->status_ctx);
             }
             http_info->http_connected = true;
         }
@@ -966,7 +984,8 @@ void prov_transport_http_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
                             {
                                 if (http_info->status_cb != NULL)
                                 {
-                                    http_info->status_cb(parse_info->prov_status, http_info->status_ctx);
+                                    /* Codes_PROV_TRANSPORT_HTTP_CLIENT_07_057: [ prov_transport_http_dowork shall pass the stored Retry-After value to the status callback. ] */
+                                    http_info->status_cb(parse_info->prov_status, http_info->retry_after_value, http_info->status_ctx);
                                 }
                                 http_info->transport_state = TRANSPORT_CLIENT_STATE_IDLE;
                             }
@@ -986,7 +1005,8 @@ void prov_transport_http_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
             case TRANSPORT_CLIENT_STATE_TRANSIENT:
                 if (http_info->status_cb != NULL)
                 {
-                    http_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_TRANSIENT, http_info->status_ctx);
+                    /* Codes_PROV_TRANSPORT_HTTP_CLIENT_07_057: [ prov_transport_http_dowork shall pass the stored Retry-After value to the status callback. ] */
+                    http_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_TRANSIENT, http_info->retry_after_value, http_info->status_ctx);
                 }
                 http_info->transport_state = TRANSPORT_CLIENT_STATE_IDLE;
                 break;
@@ -29,6 +29,7 @@ static const char* const MQTT_USERNAME_FMT = "%s/registrations/%s/api-version=%s
 static const char* const MQTT_REGISTER_MESSAGE_FMT = "$dps/registrations/PUT/iotdps-register/?$rid=%d";
 static const char* const MQTT_STATUS_MESSAGE_FMT = "$dps/registrations/GET/iotdps-get-operationstatus/?$rid=%d&operationId=%s";
 static const char* const MQTT_TOPIC_STATUS_PREFIX = "$dps/registrations/res/";
+static const char* const MQTT_TOPIC_RETRY_AFTER = "retry-after=";
 static const char* const KEY_NAME_VALUE = "registration";
 
 typedef enum MQTT_TRANSPORT_STATE_TAG
@@ -92,6 +93,7 @@ typedef struct PROV_TRANSPORT_MQTT_INFO_TAG
 
     char* api_version;
     char* payload_data;
+    uint32_t retry_after_value;
 
     bool log_trace;
 
@@ -270,6 +272,22 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
     }
 }
 
+static uint32_t get_retry_after_value(const char* topic_resp)
+{
+    uint32_t result = 0;
+    const char* retry_after = strstr(topic_resp, MQTT_TOPIC_RETRY_AFTER);
+    if (retry_after != NULL)
+    {
+        retry_after += strlen(MQTT_TOPIC_RETRY_AFTER);
+        if (*retry_after >= '0' && *retry_after <= '9')
+        {
+            unsigned long retry_secs = strtoul(retry_after, NULL, 10);
+            result = retry_secs > UINT32_MAX ? UINT32_MAX : (uint32_t)retry_secs;
+        }
+    }
+    return result;
+}
+
 static void mqtt_notification_callback(MQTT_MESSAGE_HANDLE handle, void* user_ctx)
 {
     if (user_ctx != NULL)
@@ -284,6 +302,9 @@ static void mqtt_notification_callback(MQTT_MESSAGE_HANDLE handle, void* user_ct
             size_t status_pos = strlen(MQTT_TOPIC_STATUS_PREFIX);
             if (memcmp(MQTT_TOPIC_STATUS_PREFIX, topic_resp, status_pos) == 0)
             {
+                /* Codes_PROV_TRANSPORT_MQTT_COMMON_07_063: [ mqtt_notification_callback shall store the retry-after value of the response topic, or 0 if the topic does not contain one. ] */
+                mqtt_info->retry_after_value = get_retry_after_value(topic_resp + status_pos);
+
                 // If the status code is > 429 then this is a transient error
                 long status_code = atol(topic_resp + status_pos);
                 if (status_code >= PROV_STATUS_CODE_TRANSIENT_ERROR)
@@ -752,7 +773,7 @@ int prov_transport_common_mqtt_open(PROV_DEVICE_TRANSPORT_HANDLE handle, const c
         mqtt_info->status_ctx = status_ctx;
         mqtt_info->mqtt_state = MQTT_STATE_DISCONNECTED;
         // Must add a false connect here due to the protocol quirk
-        //mqtt_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, mqtt_info->status_ctx);
+        //mqtt_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, mqtt_info->status_ctx);
         mqtt_info->challenge_cb = reg_challenge_cb;
         mqtt_info->challenge_ctx = challenge_ctx;
 
@@ -896,7 +917,7 @@ void prov_transport_common_mqtt_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
             }
             else
             {
-                mqtt_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, mqtt_info->status_ctx);
+                mqtt_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, mqtt_info->status_ctx);
                 mqtt_info->mqtt_state = MQTT_STATE_SUBSCRIBING;
             }
         }
@@ -971,7 +992,8 @@ void prov_transport_common_mqtt_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
                                     {
                                         if (mqtt_info->status_cb != NULL)
                                         {
-                                            mqtt_info->status_cb(parse_info->prov_status, mqtt_info->status_ctx);
+                                            /* Codes_PROV_TRANSPORT_MQTT_COMMON_07_064: [ prov_transport_common_mqtt_dowork shall pass the stored retry-after value to the status callback. ] */
+                                            mqtt_info->status_cb(parse_info->prov_status, mqtt_info->retry_after_value, mqtt_info->status_ctx);
                                         }
                                         mqtt_info->transport_state = TRANSPORT_CLIENT_STATE_IDLE;
                                     }
@@ -998,7 +1020,8 @@ void prov_transport_common_mqtt_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
                     case TRANSPORT_CLIENT_STATE_TRANSIENT:
                         if (mqtt_info->status_cb != NULL)
                         {
-                            mqtt_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_TRANSIENT, mqtt_info->status_ctx);
+                            /* Codes_PROV_TRANSPORT_MQTT_COMMON_07_064: [ prov_transport_common_mqtt_dowork shall pass the stored retry-after value to the status callback. ] */
+                            mqtt_info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_TRANSIENT, mqtt_info->retry_after_value, mqtt_info->status_ctx);
                         }
                         mqtt_info->transport_state = TRANSPORT_CLIENT_STATE_IDLE;
                         break;
@@ -49,6 +49,7 @@ static void my_gballoc_free(void* ptr)
 
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_prov_client/internal/prov_registration_cache.h"
 MOCKABLE_FUNCTION(, void, on_prov_register_device_callback, PROV_DEVICE_RESULT, register_result, const char*, iothub_uri, const char*, device_id, void*, user_context);
 MOCKABLE_FUNCTION(, void, on_prov_register_status_callback, PROV_DEVICE_REG_STATUS, reg_status, void*, user_context);
 MOCKABLE_FUNCTION(, char*, on_prov_transport_challenge_cb, const unsigned char*, nonce, size_t, nonce_len, const char*, key_name, void*, user_ctx);
@@ -89,6 +90,8 @@ static void* g_status_ctx;
 static void* g_http_error_ctx;
 PROV_TRANSPORT_JSON_PARSE g_json_parse_cb;
 void* g_json_ctx;
+static bool g_registration_cache_hit;
+static tickcounter_ms_t g_current_ms;
 
 #ifdef __cplusplus
 extern "C"
@@ -159,6 +162,9 @@ static int TEST_ERROR_STATUS_CODE = 500;
 #define TEST_DPS_HUB_ERROR_NO_HUB        400208
 #define TEST_DPS_HUB_ERROR_UNAUTH        400209
 
+// Longest wait of the first operation status request, initial interval plus the default jitter
+#define TEST_MAX_POLL_WAIT_MS            3600
+
 static unsigned char TEST_ENDORSMENT_KEY[] = { 'k', 'e', 'y' };
 
 static unsigned char TEST_DATA[] = { 'k', 'e', 'y' };
@@ -226,6 +232,13 @@ static void my_tickcounter_destroy(TICK_COUNTER_HANDLE tick_counter)
     my_gballoc_free(tick_counter);
 }
 
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_current_ms;
+    return 0;
+}
+
 static void my_BUFFER_delete(BUFFER_HANDLE handle)
 {
     my_gballoc_free(handle);
@@ -364,6 +377,38 @@ static BUFFER_HANDLE my_Base64_Decoder(const char* source)
     return (BUFFER_HANDLE)my_gballoc_malloc(1);
 }
 
+static PROV_REGISTRATION_CACHE_HANDLE my_prov_registration_cache_create(const PROV_REGISTRATION_CACHE_OPTIONS* options, PROV_REGISTRATION_CACHE_SIGN sign_callback, void* sign_ctx)
+{
+    (void)options;
+    (void)sign_callback;
+    (void)sign_ctx;
+    return (PROV_REGISTRATION_CACHE_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_prov_registration_cache_destroy(PROV_REGISTRATION_CACHE_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static int my_prov_registration_cache_load(PROV_REGISTRATION_CACHE_HANDLE handle, char** iothub_uri, char** device_id)
+{
+    int result;
+    (void)handle;
+    if (g_registration_cache_hit)
+    {
+        *iothub_uri = (char*)my_gballoc_malloc(strlen(TEST_IOTHUB) + 1);
+        strcpy(*iothub_uri, TEST_IOTHUB);
+        *device_id = (char*)my_gballoc_malloc(strlen(TEST_DEVICE_ID) + 1);
+        strcpy(*device_id, TEST_DEVICE_ID);
+        result = 0;
+    }
+    else
+    {
+        result = __LINE__;
+    }
+    return result;
+}
+
 static JSON_Value* my_json_parse_string(const char* string)
 {
     (void)string;
@@ -414,6 +459,8 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         REGISTER_UMOCK_ALIAS_TYPE(SEC_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_JSON_PARSE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_ERROR_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_REGISTRATION_CACHE_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_REGISTRATION_CACHE_SIGN, void*);
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -422,6 +469,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         REGISTER_GLOBAL_MOCK_HOOK(tickcounter_create, my_tickcounter_create);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(tickcounter_destroy, my_tickcounter_destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
 
         REGISTER_GLOBAL_MOCK_HOOK(prov_transport_create, my_prov_transport_create);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_create, NULL);
@@ -490,6 +538,16 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Base64_Encode_Bytes, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(Base64_Decoder, my_Base64_Decoder);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Base64_Decoder, NULL);
+
+        REGISTER_GLOBAL_MOCK_HOOK(prov_registration_cache_create, my_prov_registration_cache_create);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_registration_cache_create, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(prov_registration_cache_destroy, my_prov_registration_cache_destroy);
+        REGISTER_GLOBAL_MOCK_RETURN(prov_registration_cache_set_identity, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_registration_cache_set_identity, __LINE__);
+        REGISTER_GLOBAL_MOCK_HOOK(prov_registration_cache_load, my_prov_registration_cache_load);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_registration_cache_load, __LINE__);
+        REGISTER_GLOBAL_MOCK_RETURN(prov_registration_cache_save, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_registration_cache_save, __LINE__);
 }
 
     TEST_SUITE_CLEANUP(suite_cleanup)
@@ -515,6 +573,8 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         g_challenge_ctx = NULL;
         g_json_parse_cb = NULL;
         g_json_ctx = NULL;
+        g_registration_cache_hit = true;
+        g_current_ms = 0;
     }
 
     TEST_FUNCTION_CLEANUP(method_cleanup)
@@ -599,6 +659,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(prov_auth_destroy(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_destroy(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     }
 
@@ -989,7 +1050,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         umock_c_reset_all_calls();
 
         setup_Prov_Device_LL_DoWork_register_send_mocks();
@@ -1009,7 +1070,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         umock_c_reset_all_calls();
 
         int negativeTestsInitResult = umock_c_negative_tests_init();
@@ -1061,7 +1122,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1104,7 +1165,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1131,7 +1192,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1154,7 +1215,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1180,7 +1241,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1223,7 +1284,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1257,7 +1318,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1317,9 +1378,10 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, 0, g_status_ctx);
+        g_current_ms += TEST_MAX_POLL_WAIT_MS;
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
@@ -1342,9 +1404,10 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, 0, g_status_ctx);
+        g_current_ms += TEST_MAX_POLL_WAIT_MS;
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
@@ -1367,12 +1430,147 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         Prov_Device_LL_Destroy(handle);
     }
 
+    /* Tests_SRS_PROV_CLIENT_07_045: [ CLIENT_STATE_STATUS_SEND shall not send the operation status request until the scheduled wait has elapsed since the last service reply. ] */
+    /* Tests_SRS_PROV_CLIENT_07_042: [ The wait before an operation status request shall start at initial_interval_secs and double with every request of the registration, up to max_interval_secs. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_wait_not_elapsed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, 0, g_status_ctx);
+        g_current_ms += 2999;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_042: [ The wait before an operation status request shall start at initial_interval_secs and double with every request of the registration, up to max_interval_secs. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_transient_backoff)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, 0, g_status_ctx);
+        g_current_ms += TEST_MAX_POLL_WAIT_MS;
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_TRANSIENT, 0, g_status_ctx);
+        g_current_ms += 5999;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_043: [ If the service's retry interval is longer than the wait, the retry interval shall be used, limited to 300 seconds. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_retry_after_honored)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, 10, g_status_ctx);
+        g_current_ms += 9999;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_043: [ If the service's retry interval is longer than the wait, the retry interval shall be used, limited to 300 seconds. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_retry_after_limited)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, 100000, g_status_ctx);
+        g_current_ms += 360000;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_get_operation_status(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_047: [ PROV_OPTION_POLLING_POLICY shall replace the polling policy used for operation status requests. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_polling_policy_succeed)
+    {
+        //arrange
+        PROV_POLLING_POLICY polling_policy = { 1, 1, 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_POLLING_POLICY, &polling_policy);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, 0, g_status_ctx);
+        g_current_ms += 1000;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_get_operation_status(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
     TEST_FUNCTION(Prov_Device_LL_challenge_cb_nonce_NULL_fail)
     {
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1392,7 +1590,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1412,7 +1610,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1434,7 +1632,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1478,7 +1676,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1499,7 +1697,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1518,7 +1716,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1537,7 +1735,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1556,7 +1754,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1600,7 +1798,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1624,7 +1822,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
@@ -1749,7 +1947,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(prov_transport_set_trace(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
@@ -1771,7 +1969,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(prov_transport_set_trace(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__LINE__);
@@ -1889,7 +2087,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
-        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, g_status_ctx);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
         umock_c_reset_all_calls();
 
         //act
@@ -1939,4 +2137,355 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         Prov_Device_LL_Destroy(handle);
     }
 
+    /* Tests_SRS_PROV_CLIENT_07_046: [ If value is NULL, initial_interval_secs is 0, max_interval_secs is less than initial_interval_secs or max_jitter_percent is greater than 100, setting PROV_OPTION_POLLING_POLICY shall fail. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_polling_policy_value_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_POLLING_POLICY, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_046: [ If value is NULL, initial_interval_secs is 0, max_interval_secs is less than initial_interval_secs or max_jitter_percent is greater than 100, setting PROV_OPTION_POLLING_POLICY shall fail. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_polling_policy_invalid_fail)
+    {
+        //arrange
+        PROV_POLLING_POLICY no_interval = { 0, 30, 20 };
+        PROV_POLLING_POLICY max_below_initial = { 10, 5, 20 };
+        PROV_POLLING_POLICY jitter_too_large = { 3, 30, 101 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT no_interval_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_POLLING_POLICY, &no_interval);
+        PROV_DEVICE_RESULT max_below_initial_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_POLLING_POLICY, &max_below_initial);
+        PROV_DEVICE_RESULT jitter_too_large_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_POLLING_POLICY, &jitter_too_large);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, no_interval_result);
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, max_below_initial_result);
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, jitter_too_large_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_047: [ PROV_OPTION_POLLING_POLICY shall replace the polling policy used for operation status requests. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_polling_policy_succeed)
+    {
+        //arrange
+        PROV_POLLING_POLICY polling_policy = { 5, 60, 10 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_POLLING_POLICY, &polling_policy);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_039: [ If the registration has begun or value is NULL, setting PROV_OPTION_REGISTRATION_CACHE shall fail. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_value_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_039: [ If the registration has begun or value is NULL, setting PROV_OPTION_REGISTRATION_CACHE shall fail. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_after_register_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_040: [ PROV_OPTION_REGISTRATION_CACHE shall create the registration cache, signing entries with the security module for tpm and symmetric key devices. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_registration_cache_create(&cache_options, IGNORED_PTR_ARG, handle));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_040: [ PROV_OPTION_REGISTRATION_CACHE shall create the registration cache, signing entries with the security module for tpm and symmetric key devices. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_x509_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        setup_Prov_Device_LL_Create_mocks(PROV_AUTH_TYPE_X509);
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_registration_cache_create(&cache_options, NULL, handle));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_040: [ PROV_OPTION_REGISTRATION_CACHE shall create the registration cache, signing entries with the security module for tpm and symmetric key devices. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_create_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_registration_cache_create(&cache_options, IGNORED_PTR_ARG, handle)).SetReturn(NULL);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_041: [ PROV_OPTION_REGISTRATION_CACHE_INVALIDATE shall clear the cached registration so the next registration contacts the service. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_invalidate_no_cache_fail)
+    {
+        //arrange
+        bool invalidate = true;
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE_INVALIDATE, &invalidate);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_041: [ PROV_OPTION_REGISTRATION_CACHE_INVALIDATE shall clear the cached registration so the next registration contacts the service. ] */
+    TEST_FUNCTION(Prov_Device_LL_SetOption_registration_cache_invalidate_succeed)
+    {
+        //arrange
+        bool invalidate = true;
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_registration_cache_invalidate(IGNORED_PTR_ARG));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE_INVALIDATE, &invalidate);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_037: [ If the registration cache holds a valid entry for the device identity, Prov_Device_LL_Register_Device shall not contact the service and shall report the cached assignment on the next DoWork call. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_registration_cache_hit_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_get_registration_id(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_get_endorsement_key(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_get_storage_key(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_set_identity(IGNORED_PTR_ARG, TEST_SCOPE_ID, TEST_REGISTRATION_ID, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_load(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_037: [ If the registration cache holds a valid entry for the device identity, Prov_Device_LL_Register_Device shall not contact the service and shall report the cached assignment on the next DoWork call. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_registration_cache_miss_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+        umock_c_reset_all_calls();
+        g_registration_cache_hit = false;
+
+        STRICT_EXPECTED_CALL(prov_auth_get_registration_id(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_get_endorsement_key(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_get_storage_key(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_set_identity(IGNORED_PTR_ARG, TEST_SCOPE_ID, TEST_REGISTRATION_ID, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_load(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_open(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_038: [ CLIENT_STATE_CACHED shall call the register_callback with PROV_DEVICE_RESULT_OK and the cached iothub uri and device id. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_registration_cache_hit_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, IGNORED_PTR_ARG));
+        setup_cleanup_prov_info_mocks();
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_036: [ If the registration cache is enabled, a successful registration shall be saved to the cache before the register_callback is called. ] */
+    TEST_FUNCTION(Prov_Device_LL_on_registration_data_registration_cache_save_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+        g_registration_cache_hit = false;
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_save(IGNORED_PTR_ARG, TEST_IOTHUB, TEST_DEVICE_ID));
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, IGNORED_PTR_ARG));
+
+        //act
+        g_registration_callback(PROV_DEVICE_TRANSPORT_RESULT_OK, TEST_BUFFER_HANDLE_VALUE, TEST_IOTHUB, TEST_DEVICE_ID, g_registration_ctx);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_07_036: [ If the registration cache is enabled, a successful registration shall be saved to the cache before the register_callback is called. ] */
+    TEST_FUNCTION(Prov_Device_LL_on_registration_data_registration_cache_save_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS cache_options = { 0 };
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_SetOption(handle, PROV_OPTION_REGISTRATION_CACHE, &cache_options);
+        g_registration_cache_hit = false;
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(prov_registration_cache_save(IGNORED_PTR_ARG, TEST_IOTHUB, TEST_DEVICE_ID)).SetReturn(__LINE__);
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, IGNORED_PTR_ARG));
+
+        //act
+        g_registration_callback(PROV_DEVICE_TRANSPORT_RESULT_OK, TEST_BUFFER_HANDLE_VALUE, TEST_IOTHUB, TEST_DEVICE_ID, g_registration_ctx);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
     END_TEST_SUITE(prov_device_client_ll_ut)
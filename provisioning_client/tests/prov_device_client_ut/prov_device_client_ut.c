@@ -5,6 +5,7 @@
 #include <cstdlib>
 #else
 #include <stdlib.h>
+#include <stdbool.h>
 #endif
 
 static void* my_gballoc_malloc(size_t size)
@@ -93,14 +94,34 @@ static LOCK_RESULT my_Unlock(LOCK_HANDLE handle)
 static THREAD_HANDLE TEST_THREAD_HANDLE = (THREAD_HANDLE)0x3535;
 static THREAD_HANDLE TEST_THREAD_HANDLE_FAIL = (THREAD_HANDLE)0x1111;
 
+static size_t g_thread_create_count;
+static size_t g_dowork_count;
+static sig_atomic_t* g_stop_thread_on_sleep;
+
 static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
 {
     *threadHandle = TEST_THREAD_HANDLE;
     g_thread_func = func;
     g_thread_func_arg = arg;
+    g_thread_create_count++;
     return THREADAPI_OK;
 }
 
+static void my_ThreadAPI_Sleep(unsigned int milliseconds)
+{
+    (void)milliseconds;
+    if (g_stop_thread_on_sleep != NULL)
+    {
+        *g_stop_thread_on_sleep = 1;
+    }
+}
+
+static void my_Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
+{
+    (void)handle;
+    g_dowork_count++;
+}
+
 static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int *res)
 {
     if (threadHandle == TEST_THREAD_HANDLE_FAIL)
@@ -137,8 +158,23 @@ typedef struct TEST_PROV_DEVICE_INSTANCE_TAG
     THREAD_HANDLE ThreadHandle;
     LOCK_HANDLE LockHandle;
     sig_atomic_t StopThread;
+    void* Worker;
+    void* NextScheduled;
+    bool IsScheduled;
 } TEST_PROV_DEVICE_INSTANCE;
 
+typedef struct TEST_PROV_DEVICE_WORKER_INSTANCE_TAG
+{
+    THREAD_HANDLE ThreadHandle;
+    LOCK_HANDLE LockHandle;
+    sig_atomic_t StopThread;
+    void* ScheduledDevices;
+    size_t DeviceCount;
+    bool IsDestroyed;
+} TEST_PROV_DEVICE_WORKER_INSTANCE;
+
+#define TEST_WORKER_DEVICE_COUNT    500
+
 BEGIN_TEST_SUITE(prov_device_client_ut);
 
 TEST_SUITE_INITIALIZE(suite_init)
@@ -169,6 +205,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_WORKER_HANDLE, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
@@ -188,6 +225,9 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Join, THREADAPI_ERROR);
 
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Sleep, my_ThreadAPI_Sleep);
+    REGISTER_GLOBAL_MOCK_HOOK(Prov_Device_LL_DoWork, my_Prov_Device_LL_DoWork);
+
     REGISTER_GLOBAL_MOCK_RETURN(Prov_Device_LL_Create, (PROV_DEVICE_LL_HANDLE)0x1234);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Prov_Device_LL_Create, NULL);
 
@@ -217,6 +257,9 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     }
 
     umock_c_reset_all_calls();
+    g_thread_create_count = 0;
+    g_dowork_count = 0;
+    g_stop_thread_on_sleep = NULL;
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -685,4 +728,460 @@ TEST_FUNCTION(Prov_Device_GetVersionString_success)
     //cleanup
 }
 
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_001: [ `Prov_Device_Worker_Create` shall allocate memory for the worker and initialize its Lock. ] */
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_003: [ The worker thread shall not be started until a device of the worker is registered. ] */
+TEST_FUNCTION(Prov_Device_Worker_Create_succeeds)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    //act
+    PROV_DEVICE_WORKER_HANDLE result = Prov_Device_Worker_Create();
+
+    //assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    Prov_Device_Worker_Destroy(result);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_002: [ If any error is encountered `Prov_Device_Worker_Create` shall free the resources allocated and return NULL. ] */
+TEST_FUNCTION(Prov_Device_Worker_Create_fail)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "Prov_Device_Worker_Create failure in test %zu/%zu", index, count);
+
+        PROV_DEVICE_WORKER_HANDLE result = Prov_Device_Worker_Create();
+
+        // assert
+        ASSERT_IS_NULL_WITH_MSG(result, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_004: [ If `worker_handle` is NULL `Prov_Device_Worker_Destroy` shall return. ] */
+TEST_FUNCTION(Prov_Device_Worker_Destroy_handle_NULL)
+{
+    //arrange
+
+    //act
+    Prov_Device_Worker_Destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_005: [ `Prov_Device_Worker_Destroy` shall signal the worker thread to stop, join it if it is running, de-init the Lock and free the worker. ] */
+TEST_FUNCTION(Prov_Device_Worker_Destroy_no_thread_success)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    Prov_Device_Worker_Destroy(worker_handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_005: [ `Prov_Device_Worker_Destroy` shall signal the worker thread to stop, join it if it is running, de-init the Lock and free the worker. ] */
+TEST_FUNCTION(Prov_Device_Worker_Destroy_thread_success)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE prov_device_handle = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    (void)Prov_Device_Register_Device(prov_device_handle, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+    Prov_Device_Destroy(prov_device_handle);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(TEST_THREAD_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    Prov_Device_Worker_Destroy(worker_handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_016: [ If devices are still attached to the worker, `Prov_Device_Worker_Destroy` shall mark the worker as destroyed under the Lock and leave the Lock and the worker to be freed by the destroy of its last device. ] */
+TEST_FUNCTION(Prov_Device_Worker_Destroy_devices_attached_defers_free)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE first_device = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    PROV_DEVICE_HANDLE second_device = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    (void)Prov_Device_Register_Device(first_device, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(TEST_THREAD_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    Prov_Device_Worker_Destroy(worker_handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(((TEST_PROV_DEVICE_WORKER_INSTANCE*)worker_handle)->IsDestroyed);
+    ASSERT_ARE_EQUAL(size_t, 2, ((TEST_PROV_DEVICE_WORKER_INSTANCE*)worker_handle)->DeviceCount);
+
+    //cleanup
+    Prov_Device_Destroy(first_device);
+    Prov_Device_Destroy(second_device);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_015: [ The function shall call Prov_Device_LL_Destroy and free the device handle without joining or de-initializing the worker's resources. ] */
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_017: [ If the worker was already destroyed and this was its last device, the function shall de-init the worker's Lock and free the worker. ] */
+TEST_FUNCTION(Prov_Device_Destroy_last_device_of_destroyed_worker_frees_worker)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE first_device = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    PROV_DEVICE_HANDLE second_device = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    (void)Prov_Device_Register_Device(first_device, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+    Prov_Device_Worker_Destroy(worker_handle);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(first_device));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(second_device));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(worker_handle));
+
+    //act
+    Prov_Device_Destroy(first_device);
+    Prov_Device_Destroy(second_device);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_018: [ If the worker of the device was destroyed the function shall return error without calling the LL layer. ] */
+TEST_FUNCTION(Prov_Device_Register_Device_worker_destroyed_fail)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE prov_device_handle = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    Prov_Device_Worker_Destroy(worker_handle);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    PROV_DEVICE_RESULT prov_device_result = Prov_Device_Register_Device(prov_device_handle, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+
+    //assert
+    ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_device_result);
+    ASSERT_ARE_EQUAL(size_t, 0, g_thread_create_count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    Prov_Device_Destroy(prov_device_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_006: [ If any of the input parameter is NULL `Prov_Device_CreateWithWorker` shall return NULL. ] */
+TEST_FUNCTION(Prov_Device_CreateWithWorker_worker_NULL_fail)
+{
+    //arrange
+
+    //act
+    PROV_DEVICE_HANDLE result = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, NULL);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_006: [ If any of the input parameter is NULL `Prov_Device_CreateWithWorker` shall return NULL. ] */
+TEST_FUNCTION(Prov_Device_CreateWithWorker_uri_NULL_fail)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_DEVICE_HANDLE result = Prov_Device_CreateWithWorker(NULL, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_007: [ The device shall use the Lock of the worker and shall not start a thread of its own. ] */
+TEST_FUNCTION(Prov_Device_CreateWithWorker_succeeds)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    PROV_DEVICE_HANDLE result = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+
+    //assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_LOCK_HANDLE, ((TEST_PROV_DEVICE_INSTANCE*)result)->LockHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    Prov_Device_Destroy(result);
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_008: [ If any error is encountered `Prov_Device_CreateWithWorker` shall free the resources allocated and return NULL. ] */
+TEST_FUNCTION(Prov_Device_CreateWithWorker_fail)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    umock_c_reset_all_calls();
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION));
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "Prov_Device_CreateWithWorker failure in test %zu/%zu", index, count);
+
+        PROV_DEVICE_HANDLE result = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+
+        // assert
+        ASSERT_IS_NULL_WITH_MSG(result, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_010: [ For a device created with a worker `Prov_Device_Register_Device` shall lock the worker's Lock and return with error if the locking fails. ] */
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_011: [ The function shall call the LL layer Prov_Device_LL_Register_Device with the given parameters and return with the result. ] */
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_012: [ On success the function shall start the worker thread if it is not running and add the device to the devices driven by the worker. ] */
+TEST_FUNCTION(Prov_Device_Register_Device_with_worker_success)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE prov_device_handle = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, worker_handle));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    PROV_DEVICE_RESULT prov_device_result = Prov_Device_Register_Device(prov_device_handle, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+
+    //assert
+    ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_device_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    Prov_Device_Destroy(prov_device_handle);
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_012: [ On success the function shall start the worker thread if it is not running and add the device to the devices driven by the worker. ] */
+TEST_FUNCTION(Prov_Device_Register_Device_with_worker_thread_running_success)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE first_device = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    PROV_DEVICE_HANDLE second_device = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    (void)Prov_Device_Register_Device(first_device, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    PROV_DEVICE_RESULT prov_device_result = Prov_Device_Register_Device(second_device, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+
+    //assert
+    ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_device_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_thread_create_count);
+
+    //cleanup
+    Prov_Device_Destroy(first_device);
+    Prov_Device_Destroy(second_device);
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_010: [ For a device created with a worker `Prov_Device_Register_Device` shall lock the worker's Lock and return with error if the locking fails. ] */
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_013: [ If the worker thread cannot be started the function shall return error. ] */
+TEST_FUNCTION(Prov_Device_Register_Device_with_worker_fail)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE prov_device_handle = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    umock_c_reset_all_calls();
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, worker_handle));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 3 };
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+        {
+            continue;
+        }
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "Prov_Device_Register_Device failure in test %zu/%zu", index, count);
+
+        PROV_DEVICE_RESULT result = Prov_Device_Register_Device(prov_device_handle, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+
+        // assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(PROV_DEVICE_RESULT, result, PROV_DEVICE_RESULT_OK, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+    Prov_Device_Destroy(prov_device_handle);
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_014: [ For a device created with a worker `Prov_Device_Destroy` shall remove the device from the worker under the worker's Lock. ] */
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_015: [ The function shall call Prov_Device_LL_Destroy and free the device handle without joining or de-initializing the worker's resources. ] */
+TEST_FUNCTION(Prov_Device_Destroy_with_worker_success)
+{
+    //arrange
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    PROV_DEVICE_HANDLE prov_device_handle = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+    (void)Prov_Device_Register_Device(prov_device_handle, TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, TEST_USER_CONTEXT, TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, TEST_USER_CONTEXT);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Prov_Device_LL_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    Prov_Device_Destroy(prov_device_handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(((TEST_PROV_DEVICE_WORKER_INSTANCE*)worker_handle)->ScheduledDevices);
+
+    //cleanup
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
+/* Tests_SRS_PROV_DEVICE_CLIENT_07_009: [ The worker thread shall call Prov_Device_LL_DoWork for every registered device of the worker on each pass. ] */
+TEST_FUNCTION(Prov_Device_Worker_thread_drives_all_devices)
+{
+    //arrange
+    size_t index;
+    PROV_DEVICE_HANDLE devices[TEST_WORKER_DEVICE_COUNT];
+    PROV_DEVICE_WORKER_HANDLE worker_handle = Prov_Device_Worker_Create();
+    for (index = 0; index < TEST_WORKER_DEVICE_COUNT; index++)
+    {
+        devices[index] = Prov_Device_CreateWithWorker(TEST_PROV_URI, TEST_SCOPE_ID, TEST_PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, worker_handle);
+        ASSERT_IS_NOT_NULL(devices[index]);
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, Prov_Device_Register_Device(devices[index], TEST_PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, devices[index], TEST_PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, devices[index]));
+    }
+    g_stop_thread_on_sleep = &((TEST_PROV_DEVICE_WORKER_INSTANCE*)worker_handle)->StopThread;
+    umock_c_reset_all_calls();
+
+    //act
+    int thread_result = g_thread_func(g_thread_func_arg);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, thread_result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_thread_create_count);
+    ASSERT_ARE_EQUAL(size_t, TEST_WORKER_DEVICE_COUNT, g_dowork_count);
+
+    //cleanup
+    for (index = 0; index < TEST_WORKER_DEVICE_COUNT; index++)
+    {
+        Prov_Device_Destroy(devices[index]);
+    }
+    Prov_Device_Worker_Destroy(worker_handle);
+}
+
 END_TEST_SUITE(prov_device_client_ut)
@@ -0,0 +1,1223 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+#include <time.h>
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umock_c_negative_tests.h"
+#include "azure_c_shared_utility/macro_utils.h"
+
+#include "azure_prov_client/prov_device_ll_client.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/hmacsha256.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "parson.h"
+
+MOCKABLE_FUNCTION(, int, SHA256Reset, SHA256Context*, ctx);
+MOCKABLE_FUNCTION(, int, SHA256Input, SHA256Context*, ctx, const uint8_t*, bytes, unsigned int, bytecount);
+MOCKABLE_FUNCTION(, int, SHA256Result, SHA256Context*, ctx, uint8_t*, Message_Digest);
+
+MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Object*, json_value_get_object, const JSON_Value *, value);
+MOCKABLE_FUNCTION(, JSON_Value*, json_object_get_value, const JSON_Object *, object, const char *, name);
+MOCKABLE_FUNCTION(, const char*, json_object_get_string, const JSON_Object*, object, const char *, name);
+MOCKABLE_FUNCTION(, double, json_value_get_number, const JSON_Value*, value);
+MOCKABLE_FUNCTION(, void, json_value_free, JSON_Value*, value);
+MOCKABLE_FUNCTION(, JSON_Value*, json_value_init_object);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_string, JSON_Object*, object, const char*, name, const char*, string);
+MOCKABLE_FUNCTION(, JSON_Status, json_object_set_number, JSON_Object*, object, const char*, name, double, number);
+MOCKABLE_FUNCTION(, char*, json_serialize_to_string, const JSON_Value*, value);
+MOCKABLE_FUNCTION(, void, json_free_serialized_string, char*, string);
+
+MOCKABLE_FUNCTION(, char*, test_cache_read, void*, store_ctx);
+MOCKABLE_FUNCTION(, int, test_cache_write, const char*, content, void*, store_ctx);
+MOCKABLE_FUNCTION(, void, test_cache_clear, void*, store_ctx);
+MOCKABLE_FUNCTION(, char*, test_sign_callback, const char*, digest, void*, user_ctx);
+#undef ENABLE_MOCKS
+
+#include "azure_prov_client/internal/prov_registration_cache.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    STRING_HANDLE STRING_construct_sprintf(const char* format, ...);
+
+    STRING_HANDLE STRING_construct_sprintf(const char* format, ...)
+    {
+        (void)format;
+        return (STRING_HANDLE)my_gballoc_malloc(1);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#define TEST_JSON_ROOT_VALUE        (JSON_Value*)0x11111112
+#define TEST_JSON_OBJECT_VALUE      (JSON_Object*)0x11111113
+#define TEST_JSON_EXPIRES_VALUE     (JSON_Value*)0x11111114
+#define TEST_STORE_CTX              (void*)0x11111115
+#define TEST_SIGN_CTX               (void*)0x11111116
+#define TEST_TIME_VALUE             (time_t)1000000
+#define TEST_EXPIRES_VALUE          (1000000 + 3600)
+
+static unsigned char TEST_DATA[] = { 'k', 'e', 'y' };
+static const size_t TEST_DATA_LEN = 3;
+static const unsigned char TEST_INTEGRITY_KEY[] = { 0x01, 0x02, 0x03, 0x04 };
+static const unsigned char TEST_ATTESTATION[] = { 'e', 'k' };
+
+// STRING_c_str returns TEST_STRING_VALUE so fingerprints and signatures computed in the tests share this value
+static char* TEST_STRING_VALUE = "Test_String_Value";
+static const char* TEST_SCOPE_ID = "scope_id";
+static const char* TEST_REGISTRATION_ID = "registration_id";
+static const char* TEST_IOTHUB_URI = "iothub.azure-devices.net";
+static const char* TEST_DEVICE_ID = "device_id";
+static const char* TEST_CACHE_FILE = "prov_registration.cache";
+static char* TEST_CACHE_CONTENT = "{ cache_entry }";
+static char* TEST_SERIALIZED_JSON = "{ serialized }";
+
+static const char* g_store_content;
+static const char* g_entry_scope_id;
+static const char* g_entry_signature;
+static double g_entry_expires;
+
+static const PROV_REGISTRATION_CACHE_STORE test_store =
+{
+    test_cache_read,
+    test_cache_write,
+    test_cache_clear,
+    TEST_STORE_CTX
+};
+
+static const PROV_REGISTRATION_CACHE_STORE test_store_fail =
+{
+    test_cache_read,
+    NULL,
+    test_cache_clear,
+    TEST_STORE_CTX
+};
+
+TEST_DEFINE_ENUM_TYPE(HMACSHA256_RESULT, HMACSHA256_RESULT);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HMACSHA256_RESULT, HMACSHA256_RESULT);
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t src_len = strlen(source);
+    *destination = (char*)my_gballoc_malloc(src_len + 1);
+    strcpy(*destination, source);
+    return 0;
+}
+
+static STRING_HANDLE my_Base64_Encode_Bytes(const unsigned char* source, size_t size)
+{
+    (void)source;
+    (void)size;
+    return (STRING_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_STRING_delete(STRING_HANDLE h)
+{
+    my_gballoc_free((void*)h);
+}
+
+static BUFFER_HANDLE my_BUFFER_new(void)
+{
+    return (BUFFER_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_BUFFER_delete(BUFFER_HANDLE handle)
+{
+    my_gballoc_free((void*)handle);
+}
+
+static char* my_test_cache_read(void* store_ctx)
+{
+    char* result;
+    (void)store_ctx;
+    if (g_store_content == NULL)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = (char*)my_gballoc_malloc(strlen(g_store_content) + 1);
+        strcpy(result, g_store_content);
+    }
+    return result;
+}
+
+static char* my_test_sign_callback(const char* digest, void* user_ctx)
+{
+    char* result;
+    (void)digest;
+    (void)user_ctx;
+    result = (char*)my_gballoc_malloc(strlen(TEST_STRING_VALUE) + 1);
+    strcpy(result, TEST_STRING_VALUE);
+    return result;
+}
+
+static const char* my_json_object_get_string(const JSON_Object* object, const char* name)
+{
+    const char* result;
+    (void)object;
+    if (strcmp(name, "scopeId") == 0)
+    {
+        result = g_entry_scope_id;
+    }
+    else if (strcmp(name, "registrationId") == 0)
+    {
+        result = TEST_REGISTRATION_ID;
+    }
+    else if (strcmp(name, "assignedHub") == 0)
+    {
+        result = TEST_IOTHUB_URI;
+    }
+    else if (strcmp(name, "deviceId") == 0)
+    {
+        result = TEST_DEVICE_ID;
+    }
+    else if (strcmp(name, "signature") == 0)
+    {
+        result = g_entry_signature;
+    }
+    else
+    {
+        // fingerprint
+        result = TEST_STRING_VALUE;
+    }
+    return result;
+}
+
+static double my_json_value_get_number(const JSON_Value* value)
+{
+    (void)value;
+    return g_entry_expires;
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+BEGIN_TEST_SUITE(prov_registration_cache_ut)
+
+    TEST_SUITE_INITIALIZE(suite_init)
+    {
+        int result;
+
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+
+        result = umocktypes_charptr_register_types();
+        ASSERT_ARE_EQUAL(int, 0, result);
+        result = umocktypes_stdint_register_types();
+        ASSERT_ARE_EQUAL(int, 0, result);
+
+        REGISTER_TYPE(HMACSHA256_RESULT, HMACSHA256_RESULT);
+
+        REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_Value, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_Object, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
+
+        REGISTER_GLOBAL_MOCK_RETURN(SHA256Reset, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(SHA256Reset, __LINE__);
+        REGISTER_GLOBAL_MOCK_RETURN(SHA256Input, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(SHA256Input, __LINE__);
+        REGISTER_GLOBAL_MOCK_RETURN(SHA256Result, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(SHA256Result, __LINE__);
+        REGISTER_GLOBAL_MOCK_RETURN(HMACSHA256_ComputeHash, HMACSHA256_OK);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(HMACSHA256_ComputeHash, HMACSHA256_ERROR);
+
+        REGISTER_GLOBAL_MOCK_HOOK(Base64_Encode_Bytes, my_Base64_Encode_Bytes);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Base64_Encode_Bytes, NULL);
+
+        REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_new, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
+        REGISTER_GLOBAL_MOCK_RETURN(BUFFER_u_char, TEST_DATA);
+        REGISTER_GLOBAL_MOCK_RETURN(BUFFER_length, TEST_DATA_LEN);
+
+        REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, TEST_STRING_VALUE);
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
+
+        REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME_VALUE);
+
+        REGISTER_GLOBAL_MOCK_RETURN(json_parse_string, TEST_JSON_ROOT_VALUE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(json_value_get_object, TEST_JSON_OBJECT_VALUE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_get_object, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(json_object_get_value, TEST_JSON_EXPIRES_VALUE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_value, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(json_object_get_string, my_json_object_get_string);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_string, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(json_value_get_number, my_json_value_get_number);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_get_number, 0);
+        REGISTER_GLOBAL_MOCK_RETURN(json_value_init_object, TEST_JSON_ROOT_VALUE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_init_object, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(json_object_set_string, JSONSuccess);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_string, JSONFailure);
+        REGISTER_GLOBAL_MOCK_RETURN(json_object_set_number, JSONSuccess);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_set_number, JSONFailure);
+        REGISTER_GLOBAL_MOCK_RETURN(json_serialize_to_string, TEST_SERIALIZED_JSON);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_serialize_to_string, NULL);
+
+        REGISTER_GLOBAL_MOCK_HOOK(test_cache_read, my_test_cache_read);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(test_cache_read, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(test_cache_write, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(test_cache_write, __LINE__);
+        REGISTER_GLOBAL_MOCK_HOOK(test_sign_callback, my_test_sign_callback);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(test_sign_callback, NULL);
+    }
+
+    TEST_SUITE_CLEANUP(suite_cleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(method_init)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("Could not acquire test serialization mutex.");
+        }
+        umock_c_reset_all_calls();
+        g_store_content = TEST_CACHE_CONTENT;
+        g_entry_scope_id = TEST_SCOPE_ID;
+        g_entry_signature = TEST_STRING_VALUE;
+        g_entry_expires = TEST_EXPIRES_VALUE;
+    }
+
+    TEST_FUNCTION_CLEANUP(method_cleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    static int should_skip_index(size_t current_index, const size_t skip_array[], size_t length)
+    {
+        int result = 0;
+        for (size_t index = 0; index < length; index++)
+        {
+            if (current_index == skip_array[index])
+            {
+                result = __LINE__;
+                break;
+            }
+        }
+        return result;
+    }
+
+    static void initialize_options(PROV_REGISTRATION_CACHE_OPTIONS* options, bool use_key)
+    {
+        memset(options, 0, sizeof(PROV_REGISTRATION_CACHE_OPTIONS));
+        options->store = &test_store;
+        if (use_key)
+        {
+            options->integrity_key = TEST_INTEGRITY_KEY;
+            options->integrity_key_len = sizeof(TEST_INTEGRITY_KEY);
+        }
+    }
+
+    static PROV_REGISTRATION_CACHE_HANDLE create_cache_with_identity(bool use_key)
+    {
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        PROV_REGISTRATION_CACHE_HANDLE result;
+
+        initialize_options(&options, use_key);
+        result = prov_registration_cache_create(&options, use_key ? NULL : test_sign_callback, TEST_SIGN_CTX);
+        (void)prov_registration_cache_set_identity(result, TEST_SCOPE_ID, TEST_REGISTRATION_ID, TEST_ATTESTATION, sizeof(TEST_ATTESTATION));
+        umock_c_reset_all_calls();
+        return result;
+    }
+
+    static void setup_encode_sha256_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(SHA256Reset(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(SHA256Result(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    }
+
+    static void setup_set_identity_mocks(void)
+    {
+        setup_encode_sha256_mocks();
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_STRING_VALUE));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SCOPE_ID));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_REGISTRATION_ID));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    }
+
+    static void setup_entry_signature_mocks(bool use_key)
+    {
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+        setup_encode_sha256_mocks();
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+        if (use_key)
+        {
+            STRICT_EXPECTED_CALL(BUFFER_new());
+            STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, sizeof(TEST_INTEGRITY_KEY), IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+            STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        }
+        else
+        {
+            STRICT_EXPECTED_CALL(test_sign_callback(TEST_STRING_VALUE, TEST_SIGN_CTX));
+        }
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    }
+
+    static void setup_load_entry_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(test_cache_read(TEST_STORE_CTX));
+        STRICT_EXPECTED_CALL(json_parse_string(TEST_CACHE_CONTENT));
+        STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, "scopeId"));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, "registrationId"));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, "fingerprint"));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, "signature"));
+        STRICT_EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, "expiresUtc"));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, "assignedHub"));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, "deviceId"));
+    }
+
+    static void setup_load_expiry_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(get_time(NULL));
+        STRICT_EXPECTED_CALL(json_value_get_number(IGNORED_PTR_ARG));
+    }
+
+    static void setup_load_mocks(bool use_key)
+    {
+        setup_load_entry_mocks();
+        setup_load_expiry_mocks();
+        setup_entry_signature_mocks(use_key);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_IOTHUB_URI));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_DEVICE_ID));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+
+    static void setup_load_invalid_entry_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(test_cache_clear(TEST_STORE_CTX));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+
+    static void setup_save_mocks(bool use_key)
+    {
+        STRICT_EXPECTED_CALL(get_time(NULL));
+        setup_entry_signature_mocks(use_key);
+        STRICT_EXPECTED_CALL(json_value_init_object());
+        STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "scopeId", TEST_SCOPE_ID));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "registrationId", TEST_REGISTRATION_ID));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "fingerprint", TEST_STRING_VALUE));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "assignedHub", TEST_IOTHUB_URI));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "deviceId", TEST_DEVICE_ID));
+        STRICT_EXPECTED_CALL(json_object_set_number(IGNORED_PTR_ARG, "expiresUtc", IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, "signature", TEST_STRING_VALUE));
+        STRICT_EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(test_cache_write(TEST_SERIALIZED_JSON, TEST_STORE_CTX));
+        STRICT_EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_001: [ If options is NULL, or neither store nor file_path are specified, prov_registration_cache_create shall return NULL. ] */
+    TEST_FUNCTION(prov_registration_cache_create_options_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(NULL, test_sign_callback, TEST_SIGN_CTX);
+
+        //assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_001: [ If options is NULL, or neither store nor file_path are specified, prov_registration_cache_create shall return NULL. ] */
+    TEST_FUNCTION(prov_registration_cache_create_no_store_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        options.store = NULL;
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+
+        //assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_002: [ If store is specified and any of its functions are NULL, prov_registration_cache_create shall return NULL. ] */
+    TEST_FUNCTION(prov_registration_cache_create_store_function_NULL_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        options.store = &test_store_fail;
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+
+        //assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_003: [ If integrity_key is NULL and sign_callback is NULL, or integrity_key_len is 0 with a non-NULL integrity_key, prov_registration_cache_create shall return NULL. ] */
+    TEST_FUNCTION(prov_registration_cache_create_no_signing_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, false);
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+
+        //assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_003: [ If integrity_key is NULL and sign_callback is NULL, or integrity_key_len is 0 with a non-NULL integrity_key, prov_registration_cache_create shall return NULL. ] */
+    TEST_FUNCTION(prov_registration_cache_create_integrity_key_len_0_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        options.integrity_key_len = 0;
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+
+        //assert
+        ASSERT_IS_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_004: [ prov_registration_cache_create shall allocate a PROV_REGISTRATION_CACHE_HANDLE and copy the options. ] */
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_007: [ If store is NULL the cache shall be kept in the file specified by file_path. ] */
+    TEST_FUNCTION(prov_registration_cache_create_file_store_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        options.store = NULL;
+        options.file_path = TEST_CACHE_FILE;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_CACHE_FILE));
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_INTEGRITY_KEY)));
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+
+        //assert
+        ASSERT_IS_NOT_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_004: [ prov_registration_cache_create shall allocate a PROV_REGISTRATION_CACHE_HANDLE and copy the options. ] */
+    TEST_FUNCTION(prov_registration_cache_create_sign_callback_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, false);
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+        //act
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, test_sign_callback, TEST_SIGN_CTX);
+
+        //assert
+        ASSERT_IS_NOT_NULL(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_005: [ If any error is encountered prov_registration_cache_create shall return NULL. ] */
+    TEST_FUNCTION(prov_registration_cache_create_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        options.store = NULL;
+        options.file_path = TEST_CACHE_FILE;
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_CACHE_FILE));
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_INTEGRITY_KEY)));
+
+        umock_c_negative_tests_snapshot();
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(index);
+
+            char tmp_msg[64];
+            sprintf(tmp_msg, "prov_registration_cache_create failure in test %zu/%zu", index, count);
+
+            PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+
+            //assert
+            ASSERT_IS_NULL_WITH_MSG(handle, tmp_msg);
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_008: [ If handle is NULL, prov_registration_cache_destroy shall do nothing. ] */
+    TEST_FUNCTION(prov_registration_cache_destroy_handle_NULL)
+    {
+        //arrange
+
+        //act
+        prov_registration_cache_destroy(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_009: [ prov_registration_cache_destroy shall free all resources associated with the handle. ] */
+    TEST_FUNCTION(prov_registration_cache_destroy_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(NULL));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        prov_registration_cache_destroy(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_010: [ If handle, scope_id, registration_id or attestation are NULL or attestation_len is 0, prov_registration_cache_set_identity shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_set_identity_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        int result = prov_registration_cache_set_identity(NULL, TEST_SCOPE_ID, TEST_REGISTRATION_ID, TEST_ATTESTATION, sizeof(TEST_ATTESTATION));
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_010: [ If handle, scope_id, registration_id or attestation are NULL or attestation_len is 0, prov_registration_cache_set_identity shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_set_identity_attestation_len_0_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        //act
+        int result = prov_registration_cache_set_identity(handle, TEST_SCOPE_ID, TEST_REGISTRATION_ID, TEST_ATTESTATION, 0);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_011: [ prov_registration_cache_set_identity shall store the scope id, registration id and the base64 encoded SHA256 fingerprint of the attestation. ] */
+    TEST_FUNCTION(prov_registration_cache_set_identity_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+        umock_c_reset_all_calls();
+
+        setup_set_identity_mocks();
+
+        //act
+        int result = prov_registration_cache_set_identity(handle, TEST_SCOPE_ID, TEST_REGISTRATION_ID, TEST_ATTESTATION, sizeof(TEST_ATTESTATION));
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_012: [ If any error is encountered prov_registration_cache_set_identity shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_set_identity_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+        umock_c_reset_all_calls();
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_set_identity_mocks();
+
+        umock_c_negative_tests_snapshot();
+
+        size_t calls_cannot_fail[] = { 4, 8, 9, 10, 11 };
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            {
+                continue;
+            }
+
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(index);
+
+            char tmp_msg[64];
+            sprintf(tmp_msg, "prov_registration_cache_set_identity failure in test %zu/%zu", index, count);
+
+            int result = prov_registration_cache_set_identity(handle, TEST_SCOPE_ID, TEST_REGISTRATION_ID, TEST_ATTESTATION, sizeof(TEST_ATTESTATION));
+
+            //assert
+            ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, tmp_msg);
+        }
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_013: [ If handle, iothub_uri or device_id are NULL, prov_registration_cache_load shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_handle_NULL_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+
+        //act
+        int result = prov_registration_cache_load(NULL, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_IS_NULL(device_id);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_014: [ If the identity has not been set, prov_registration_cache_load shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_no_identity_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+        umock_c_reset_all_calls();
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_016: [ If the store is empty prov_registration_cache_load shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_store_empty_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+        g_store_content = NULL;
+
+        STRICT_EXPECTED_CALL(test_cache_read(TEST_STORE_CTX));
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_015: [ prov_registration_cache_load shall read the entry from the store. ] */
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_017: [ On a valid entry prov_registration_cache_load shall return allocated copies of the iothub uri and device id and return 0. ] */
+    TEST_FUNCTION(prov_registration_cache_load_integrity_key_succeed)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        setup_load_mocks(true);
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_IOTHUB_URI, iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_DEVICE_ID, device_id);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        my_gballoc_free(iothub_uri);
+        my_gballoc_free(device_id);
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_017: [ On a valid entry prov_registration_cache_load shall return allocated copies of the iothub uri and device id and return 0. ] */
+    TEST_FUNCTION(prov_registration_cache_load_sign_callback_succeed)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(false);
+
+        setup_load_mocks(false);
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_IOTHUB_URI, iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_DEVICE_ID, device_id);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        my_gballoc_free(iothub_uri);
+        my_gballoc_free(device_id);
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_022: [ If the stored entry is not a complete cache entry prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_parse_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        STRICT_EXPECTED_CALL(test_cache_read(TEST_STORE_CTX));
+        STRICT_EXPECTED_CALL(json_parse_string(TEST_CACHE_CONTENT)).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(test_cache_clear(TEST_STORE_CTX));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_023: [ If the scope id, registration id or attestation fingerprint of the entry do not match the current identity prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_identity_mismatch_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+        g_entry_scope_id = "other_scope_id";
+
+        setup_load_entry_mocks();
+        setup_load_invalid_entry_mocks();
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_024: [ If the entry has expired, or expires further in the future than the configured lifetime, prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_expired_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+        g_entry_expires = (double)TEST_TIME_VALUE;
+
+        setup_load_entry_mocks();
+        setup_load_expiry_mocks();
+        setup_load_invalid_entry_mocks();
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_024: [ If the entry has expired, or expires further in the future than the configured lifetime, prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_expiry_beyond_lifetime_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+        g_entry_expires = (double)TEST_TIME_VALUE + (8 * 24 * 60 * 60);
+
+        setup_load_entry_mocks();
+        setup_load_expiry_mocks();
+        setup_load_invalid_entry_mocks();
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_025: [ If the signature of the entry does not match prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_signature_mismatch_fail)
+    {
+        //arrange
+        char* iothub_uri = NULL;
+        char* device_id = NULL;
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+        g_entry_signature = "Test_String_Valuf";
+
+        setup_load_entry_mocks();
+        setup_load_expiry_mocks();
+        setup_entry_signature_mocks(true);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        setup_load_invalid_entry_mocks();
+
+        //act
+        int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(iothub_uri);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_022: [ If the stored entry is not a complete cache entry prov_registration_cache_load shall clear the store and return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_load_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_load_mocks(true);
+
+        umock_c_negative_tests_snapshot();
+
+        size_t calls_cannot_fail[] = { 10, 12, 17, 20, 21, 23, 25, 26, 27, 28, 29, 32, 33 };
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            {
+                continue;
+            }
+
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(index);
+
+            char* iothub_uri = NULL;
+            char* device_id = NULL;
+            char tmp_msg[64];
+            sprintf(tmp_msg, "prov_registration_cache_load failure in test %zu/%zu", index, count);
+
+            int result = prov_registration_cache_load(handle, &iothub_uri, &device_id);
+
+            //assert
+            ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, tmp_msg);
+        }
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_018: [ If handle, iothub_uri or device_id are NULL, or the identity has not been set, prov_registration_cache_save shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_save_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        int result = prov_registration_cache_save(NULL, TEST_IOTHUB_URI, TEST_DEVICE_ID);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_018: [ If handle, iothub_uri or device_id are NULL, or the identity has not been set, prov_registration_cache_save shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_save_no_identity_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_OPTIONS options;
+        initialize_options(&options, true);
+        PROV_REGISTRATION_CACHE_HANDLE handle = prov_registration_cache_create(&options, NULL, NULL);
+        umock_c_reset_all_calls();
+
+        //act
+        int result = prov_registration_cache_save(handle, TEST_IOTHUB_URI, TEST_DEVICE_ID);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_019: [ prov_registration_cache_save shall sign the entry, including its expiry time, with the integrity key or the sign_callback. ] */
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_020: [ prov_registration_cache_save shall write the entry to the store. ] */
+    TEST_FUNCTION(prov_registration_cache_save_integrity_key_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        setup_save_mocks(true);
+
+        //act
+        int result = prov_registration_cache_save(handle, TEST_IOTHUB_URI, TEST_DEVICE_ID);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_019: [ prov_registration_cache_save shall sign the entry, including its expiry time, with the integrity key or the sign_callback. ] */
+    TEST_FUNCTION(prov_registration_cache_save_sign_callback_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(false);
+
+        setup_save_mocks(false);
+
+        //act
+        int result = prov_registration_cache_save(handle, TEST_IOTHUB_URI, TEST_DEVICE_ID);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_021: [ If any error is encountered prov_registration_cache_save shall return a non-zero value. ] */
+    TEST_FUNCTION(prov_registration_cache_save_fail)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_save_mocks(true);
+
+        umock_c_negative_tests_snapshot();
+
+        size_t calls_cannot_fail[] = { 0, 1, 6, 9, 10, 12, 14, 15, 16, 17, 19, 29, 30, 31 };
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            {
+                continue;
+            }
+
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(index);
+
+            char tmp_msg[64];
+            sprintf(tmp_msg, "prov_registration_cache_save failure in test %zu/%zu", index, count);
+
+            int result = prov_registration_cache_save(handle, TEST_IOTHUB_URI, TEST_DEVICE_ID);
+
+            //assert
+            ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, tmp_msg);
+        }
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_026: [ If handle is NULL, prov_registration_cache_invalidate shall do nothing. ] */
+    TEST_FUNCTION(prov_registration_cache_invalidate_handle_NULL)
+    {
+        //arrange
+
+        //act
+        prov_registration_cache_invalidate(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_REGISTRATION_CACHE_07_027: [ prov_registration_cache_invalidate shall clear the store. ] */
+    TEST_FUNCTION(prov_registration_cache_invalidate_succeed)
+    {
+        //arrange
+        PROV_REGISTRATION_CACHE_HANDLE handle = create_cache_with_identity(true);
+
+        STRICT_EXPECTED_CALL(test_cache_clear(TEST_STORE_CTX));
+
+        //act
+        prov_registration_cache_invalidate(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_registration_cache_destroy(handle);
+    }
+
+END_TEST_SUITE(prov_registration_cache_ut)
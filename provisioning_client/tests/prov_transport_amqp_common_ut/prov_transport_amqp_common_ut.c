@@ -62,7 +62,7 @@ static void my_gballoc_free(void* ptr)
 
 #include "azure_c_shared_utility/umock_c_prod.h"
 MOCKABLE_FUNCTION(, void, on_transport_register_data_cb, PROV_DEVICE_TRANSPORT_RESULT, transport_result, BUFFER_HANDLE, iothub_key, const char*, assigned_hub, const char*, device_id, void*, user_ctx);
-MOCKABLE_FUNCTION(, void, on_transport_status_cb, PROV_DEVICE_TRANSPORT_STATUS, transport_status, void*, user_ctx);
+MOCKABLE_FUNCTION(, void, on_transport_status_cb, PROV_DEVICE_TRANSPORT_STATUS, transport_status, uint32_t, retry_interval, void*, user_ctx);
 MOCKABLE_FUNCTION(, char*, on_transport_challenge_callback, const unsigned char*, nonce, size_t, nonce_len, const char*, key_name, void*, user_ctx);
 MOCKABLE_FUNCTION(, PROV_TRANSPORT_IO_INFO*, on_transport_io, const char*, fqdn, SASL_MECHANISM_HANDLE*, sasl_mechanism, const HTTP_PROXY_OPTIONS*, proxy_info);
 MOCKABLE_FUNCTION(, PROV_JSON_INFO*, on_transport_json_parse, const char*, json_document, void*, user_ctx);
@@ -116,6 +116,7 @@ static const char* TEST_OPERATION_ID = "operation_id";
 static const char* TEST_USERNAME_VALUE = "username";
 static const char* TEST_PASSWORD_VALUE = "password";
 static const char* TEST_JSON_REPLY = "{ json_reply }";
+static const uint32_t TEST_RETRY_AFTER_VALUE = 5;
 
 static ON_MESSAGE_RECEIVER_STATE_CHANGED g_msg_rcvr_state_changed;
 static void* g_msg_rcvr_state_changed_ctx;
@@ -474,6 +475,7 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
         REGISTER_UMOCK_ALIAS_TYPE(ON_LINK_ATTACHED, void*);
         REGISTER_UMOCK_ALIAS_TYPE(role, bool);
         REGISTER_UMOCK_ALIAS_TYPE(AMQP_VALUE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(AMQP_TYPE, int);
         REGISTER_UMOCK_ALIAS_TYPE(fields, void*);
         REGISTER_UMOCK_ALIAS_TYPE(receiver_settle_mode, uint8_t);
         REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_RECEIVER_STATE_CHANGED, void*);
@@ -541,12 +543,13 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
 
-        /*REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_map_value, my_amqpvalue_get_map_value);
+        REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_map_value, my_amqpvalue_get_map_value);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(amqpvalue_get_map_value, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(message_get_application_properties, my_message_get_application_properties);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(message_get_application_properties, __LINE__);
         REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_get_inplace_described_value, TEST_AMQP_VALUE);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(amqpvalue_get_inplace_described_value, NULL);*/
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(amqpvalue_get_inplace_described_value, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_get_type, AMQP_TYPE_NULL);
 
         REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_create_symbol, my_amqpvalue_create_symbol);
         //REGISTER_GLOBAL_MOCK_RETURN(link_set_attach_properties, 0);
@@ -634,11 +637,29 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
         STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
     }
 
+    static void setup_retry_after_mocks(AMQP_TYPE retry_after_type)
+    {
+        STRICT_EXPECTED_CALL(message_get_application_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_get_inplace_described_value(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_get_map_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_get_type(IGNORED_PTR_ARG)).SetReturn(retry_after_type);
+        if (retry_after_type == AMQP_TYPE_UINT)
+        {
+            STRICT_EXPECTED_CALL(amqpvalue_get_uint(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .CopyOutArgumentBuffer_uint_value(&TEST_RETRY_AFTER_VALUE, sizeof(TEST_RETRY_AFTER_VALUE));
+        }
+        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+    }
+
     static void setup_on_message_recv_callback_mocks()
     {
         STRICT_EXPECTED_CALL(message_get_body_type(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setup_retry_after_mocks(AMQP_TYPE_NULL);
         STRICT_EXPECTED_CALL(messaging_delivery_accepted());
     }
 
@@ -1056,7 +1077,7 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
         STRICT_EXPECTED_CALL(BUFFER_clone(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(BUFFER_clone(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_REGISTRATION_ID_VALUE));
-        //STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, IGNORED_PTR_ARG));
+        //STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
 
         //act
         int result = prov_transport_common_amqp_open(handle, TEST_REGISTRATION_ID_VALUE, TEST_BUFFER_VALUE, TEST_BUFFER_VALUE, on_transport_register_data_cb, NULL, on_transport_status_cb, NULL, on_transport_challenge_callback, NULL);
@@ -1082,7 +1103,7 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
         //arrange
         STRICT_EXPECTED_CALL(BUFFER_clone(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(BUFFER_clone(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
 
         umock_c_negative_tests_snapshot();
 
@@ -1123,7 +1144,7 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
 
         //arrange
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_REGISTRATION_ID_VALUE));
-        //STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, IGNORED_PTR_ARG));
+        //STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
 
         //act
         int result = prov_transport_common_amqp_open(handle, TEST_REGISTRATION_ID_VALUE, NULL, NULL, on_transport_register_data_cb, NULL, on_transport_status_cb, NULL, on_transport_challenge_callback, NULL);
@@ -1621,6 +1642,45 @@ BEGIN_TEST_SUITE(prov_transport_amqp_common_ut)
         prov_transport_common_amqp_destroy(handle);
     }
 
+    /* Tests_PROV_TRANSPORT_AMQP_COMMON_07_062: [ on_message_recv_callback shall store the retry-after application property of the message, or 0 if the property is absent. ] */
+    /* Tests_PROV_TRANSPORT_AMQP_COMMON_07_063: [ prov_transport_common_amqp_dowork shall pass the stored retry-after value to the status callback. ] */
+    TEST_FUNCTION(prov_transport_common_amqp_dowork_register_recv_retry_after_succeed)
+    {
+        PROV_DEVICE_TRANSPORT_HANDLE handle = prov_transport_common_amqp_create(TEST_URI_VALUE, TRANSPORT_HSM_TYPE_TPM, TEST_SCOPE_ID_VALUE, TEST_DPS_API_VALUE, on_transport_io, on_transport_error, NULL);
+        (void)prov_transport_common_amqp_open(handle, TEST_REGISTRATION_ID_VALUE, TEST_BUFFER_VALUE, TEST_BUFFER_VALUE, on_transport_register_data_cb, NULL, on_transport_status_cb, NULL, on_transport_challenge_callback, NULL);
+        (void)prov_transport_common_amqp_register_device(handle, on_transport_json_parse, NULL);
+        prov_transport_common_amqp_dowork(handle);
+        g_msg_sndr_state_changed(g_msg_sndr_state_changed_ctx, MESSAGE_SENDER_STATE_OPEN, MESSAGE_SENDER_STATE_OPENING);
+        g_msg_rcvr_state_changed(g_msg_rcvr_state_changed_ctx, MESSAGE_RECEIVER_STATE_OPEN, MESSAGE_RECEIVER_STATE_OPENING);
+        prov_transport_common_amqp_dowork(handle);
+        g_target_transport_status = PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING;
+        umock_c_reset_all_calls();
+
+        //arrange
+        STRICT_EXPECTED_CALL(message_get_body_type(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setup_retry_after_mocks(AMQP_TYPE_UINT);
+        STRICT_EXPECTED_CALL(messaging_delivery_accepted());
+        STRICT_EXPECTED_CALL(connection_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_transport_json_parse(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, TEST_RETRY_AFTER_VALUE, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        (void)g_on_msg_recv(msg_recv_callback_context, TEST_MESSAGE_HANDLE);
+        prov_transport_common_amqp_dowork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_transport_common_amqp_close(handle);
+        prov_transport_common_amqp_destroy(handle);
+    }
+
     /* Tests_PROV_TRANSPORT_AMQP_COMMON_07_055: [ When then transport_state is set to TRANSPORT_CLIENT_STATE_STATUS_SEND, prov_transport_common_amqp_dowork shall send a AMQP_OPERATION_STATUS message ] */
     /* Tests_PROV_TRANSPORT_AMQP_COMMON_07_056: [ Upon successful sending of a AMQP_OPERATION_STATUS message, prov_transport_common_amqp_dowork shall set the transport_state to TRANSPORT_CLIENT_STATE_STATUS_SENT ] */
     TEST_FUNCTION(prov_transport_common_amqp_dowork_send_status_succeed)
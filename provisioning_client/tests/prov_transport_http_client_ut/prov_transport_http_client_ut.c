@@ -53,7 +53,7 @@ static void my_gballoc_free(void* ptr)
 
 #include "azure_c_shared_utility/umock_c_prod.h"
 MOCKABLE_FUNCTION(, void, on_transport_register_data_cb, PROV_DEVICE_TRANSPORT_RESULT, transport_result, BUFFER_HANDLE, iothub_key, const char*, assigned_hub, const char*, device_id, void*, user_ctx);
-MOCKABLE_FUNCTION(, void, on_transport_status_cb, PROV_DEVICE_TRANSPORT_STATUS, transport_status, void*, user_ctx);
+MOCKABLE_FUNCTION(, void, on_transport_status_cb, PROV_DEVICE_TRANSPORT_STATUS, transport_status, uint32_t, retry_interval, void*, user_ctx);
 MOCKABLE_FUNCTION(, char*, on_transport_challenge_callback, const unsigned char*, nonce, size_t, nonce_len, const char*, key_name, void*, user_ctx);
 MOCKABLE_FUNCTION(, PROV_JSON_INFO*, on_transport_json_parse, const char*, json_document, void*, user_ctx);
 MOCKABLE_FUNCTION(, void, on_transport_error, PROV_DEVICE_TRANSPORT_ERROR, transport_error, void*, user_context);
@@ -116,6 +116,7 @@ static const char* TEST_JSON_CONTENT = "{test json content}";
 #define TEST_SUCCESS_STATUS_CODE    204
 #define TEST_FAILURE_STATUS_CODE    501
 #define TEST_THROTTLE_STATUS_CODE   429
+#define TEST_RETRY_AFTER_VALUE      "5"
 #define TEST_STRING_VALUE_LEN       17
 #define HTTP_STATUS_CODE_UNAUTHORIZED   401
 
@@ -317,9 +318,10 @@ static void my_on_transport_register_data_cb(PROV_DEVICE_TRANSPORT_RESULT transp
     (void)user_ctx;
 }
 
-static void my_on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS transport_status, void* user_ctx)
+static void my_on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS transport_status, uint32_t retry_interval, void* user_ctx)
 {
     (void)transport_status;
+    (void)retry_interval;
     (void)user_ctx;
 }
 
@@ -1058,6 +1060,7 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
         prov_dev_http_transport_dowork(handle);
         umock_c_reset_all_calls();
 
+        STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(TEST_HTTP_HANDLE_VALUE, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
         //act
@@ -1081,6 +1084,8 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
         prov_dev_http_transport_dowork(handle);
         umock_c_reset_all_calls();
 
+        STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(TEST_HTTP_HANDLE_VALUE, IGNORED_PTR_ARG));
+
         //act
         g_on_http_reply_recv(g_http_execute_ctx, HTTP_CALLBACK_REASON_OK, (const unsigned char*)TEST_JSON_CONTENT, TEST_JSON_CONTENT_LEN, TEST_FAILURE_STATUS_CODE, TEST_HTTP_HANDLE_VALUE);
 
@@ -1102,6 +1107,8 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
         prov_dev_http_transport_dowork(handle);
         umock_c_reset_all_calls();
 
+        STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(TEST_HTTP_HANDLE_VALUE, IGNORED_PTR_ARG));
+
         //act
         g_on_http_reply_recv(g_http_execute_ctx, HTTP_CALLBACK_REASON_OK, (const unsigned char*)TEST_JSON_CONTENT, TEST_JSON_CONTENT_LEN, TEST_THROTTLE_STATUS_CODE, TEST_HTTP_HANDLE_VALUE);
 
@@ -1113,6 +1120,34 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
         prov_dev_http_transport_destroy(handle);
     }
 
+    /* Tests_PROV_TRANSPORT_HTTP_CLIENT_07_056: [ on_http_reply_recv shall store the delay-seconds value of the Retry-After response header, or 0 if the header is absent. ] */
+    /* Tests_PROV_TRANSPORT_HTTP_CLIENT_07_057: [ prov_transport_http_dowork shall pass the stored Retry-After value to the status callback. ] */
+    TEST_FUNCTION(prov_transport_http_reply_recv_retry_after_succeed)
+    {
+        //arrange
+        PROV_DEVICE_TRANSPORT_HANDLE handle = prov_dev_http_transport_create(TEST_URI_VALUE, TRANSPORT_HSM_TYPE_TPM, TEST_SCOPE_ID_VALUE, TEST_DPS_API_VALUE, on_transport_error, NULL);
+        (void)prov_dev_http_transport_open(handle, TEST_REGISTRATION_ID_VALUE, TEST_BUFFER_VALUE, TEST_BUFFER_VALUE, on_transport_register_data_cb, NULL, on_transport_status_cb, NULL, on_transport_challenge_callback, NULL);
+        (void)prov_dev_http_transport_register_device(handle, on_transport_json_parse, NULL);
+        g_on_http_open(g_http_open_ctx, HTTP_CALLBACK_REASON_OK);
+        prov_dev_http_transport_dowork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(TEST_HTTP_HANDLE_VALUE, IGNORED_PTR_ARG)).SetReturn(TEST_RETRY_AFTER_VALUE);
+        STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_TRANSIENT, 5, IGNORED_PTR_ARG));
+
+        //act
+        g_on_http_reply_recv(g_http_execute_ctx, HTTP_CALLBACK_REASON_OK, (const unsigned char*)TEST_JSON_CONTENT, TEST_JSON_CONTENT_LEN, TEST_THROTTLE_STATUS_CODE, TEST_HTTP_HANDLE_VALUE);
+        prov_dev_http_transport_dowork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        (void)prov_dev_http_transport_close(handle);
+        prov_dev_http_transport_destroy(handle);
+    }
+
     /* Tests_PROV_TRANSPORT_HTTP_CLIENT_07_029: [ If the argument handle, or operation_id is NULL, prov_transport_http_get_operation_status shall return a non-zero value. ] */
     TEST_FUNCTION(prov_transport_http_get_operation_status_handle_NULL_fail)
     {
@@ -1325,7 +1360,7 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
         STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(on_transport_json_parse(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_transport_status_cb(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
         g_target_transport_status = PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING;
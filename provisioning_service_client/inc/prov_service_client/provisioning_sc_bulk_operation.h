@@ -65,6 +65,9 @@ MOCKABLE_FUNCTION(, void, bulkOperationResult_free, PROVISIONING_BULK_OPERATION_
 
 /* ---INTERNAL USAGE ONLY--- */
 MOCKABLE_FUNCTION(, PROVISIONING_BULK_OPERATION_ERROR*, bulkOperationError_fromJson, JSON_Object*, root_object);
+MOCKABLE_FUNCTION(, PROVISIONING_BULK_OPERATION_RESULT*, bulkOperationResult_create);
+MOCKABLE_FUNCTION(, int, bulkOperationResult_append, PROVISIONING_BULK_OPERATION_RESULT*, bulk_op_result, PROVISIONING_BULK_OPERATION_RESULT*, other_result);
+MOCKABLE_FUNCTION(, int, bulkOperationResult_addError, PROVISIONING_BULK_OPERATION_RESULT*, bulk_op_result, const char*, registration_id, int32_t, error_code, const char*, error_status);
 
 #ifdef __cplusplus
 }
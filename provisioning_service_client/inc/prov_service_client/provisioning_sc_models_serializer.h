@@ -62,6 +62,18 @@ MOCKABLE_FUNCTION(, DEVICE_REGISTRATION_STATE_HANDLE, deviceRegistrationState_de
 */
 MOCKABLE_FUNCTION(, char*, bulkOperation_serializeToJson, const PROVISIONING_BULK_OPERATION*, bulk_op);
 
+/** @brief  Serializes part of the enrollments of a Bulk Operation into a JSON String, written into a buffer owned by the caller.
+*
+* @param    bulk_op     A pointer to a Bulk Operation structure
+* @param    first       The index of the first enrollment to serialize
+* @param    count       The number of enrollments to serialize
+* @param    buffer      A pointer to the buffer the JSON String is written to. It is grown as needed and can be passed again for the next part
+* @param    capacity    A pointer to the size of buffer
+*
+* @return   0 upon success, a non-zero number otherwise.
+*/
+MOCKABLE_FUNCTION(, int, bulkOperation_serializeRangeToBuffer, const PROVISIONING_BULK_OPERATION*, bulk_op, size_t, first, size_t, count, char**, buffer, size_t*, capacity);
+
 /** @brief  Deserializes a JSON String representation of a Bulk Operation Result.
 *
 * @param    json_string     A JSON String representing an Bulk Operation Result.
@@ -87,6 +99,18 @@ MOCKABLE_FUNCTION(, char*, querySpecification_serializeToJson, const PROVISIONIN
 */
 MOCKABLE_FUNCTION(, PROVISIONING_QUERY_RESPONSE*, queryResponse_deserializeFromJson, const char*, json_string, PROVISIONING_QUERY_TYPE, type);
 
+/** @brief  Finds the next record of a Query Response page without deserializing the page. The record is NUL-terminated in place,
+*           so that it can be handed to the deserializer of its model.
+*
+* @param    json_string     A JSON String representing a Query Response page. It is modified.
+* @param    length          The length of json_string
+* @param    position        A pointer to the position of the next record in json_string, 0 before the first call. It is advanced past the record
+* @param    record_json     A pointer to be set to the next record in json_string, and to NULL when there are no more records in the page
+*
+* @return   0 upon success, a non-zero number otherwise.
+*/
+MOCKABLE_FUNCTION(, int, queryResponse_nextRecord, char*, json_string, size_t, length, size_t*, position, char**, record_json);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -65,6 +65,24 @@ MOCKABLE_FUNCTION(, int, prov_sc_set_certificate, PROVISIONING_SERVICE_CLIENT_HA
 */
 MOCKABLE_FUNCTION(, int, prov_sc_set_proxy, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, HTTP_PROXY_OPTIONS*, proxy_options);
 
+/** @brief  Set how long a request to the Provisioning Service may take before it is abandoned.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    timeout_ms      The timeout in milliseconds, covering connecting, sending the request and receiving the reply. 0 means no timeout. The default is 60000.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_set_request_timeout, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, size_t, timeout_ms);
+
+/** @brief  Set how many requests prov_sc_run_individual_enrollment_bulk_operation_chunked keeps in flight, each on its own connection.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    max_requests    The number of requests sent at the same time, at least 1. The default is 4.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_set_bulk_operation_requests_in_flight, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, size_t, max_requests);
+
 /** @brief Creates or updates an individual device enrollment record on the Provisioning Service, reflecting the changes in the given struct.
 *
 * @param    prov_client         The handle used for connecting to the Provisioning Service.
@@ -121,10 +139,26 @@ MOCKABLE_FUNCTION(, int, prov_sc_query_individual_enrollment, PROVISIONING_SERVI
 * @param    bulk_op         A pointer to a bulk operation structure with details about the bulk operation.
 * @param    bulk_res_ptr    A pointer to a bulk operation result pointer that will be filled with the results upon completion
 *
-* @return   0 upon success, a non-zero number upon failure.
+* @return   0 upon success, a non-zero number upon failure. The request is not sent again once it may have reached the
+*           Provisioning Service, so after a failure without a reply the enrollments may or may not have been applied.
 */
 MOCKABLE_FUNCTION(, int, prov_sc_run_individual_enrollment_bulk_operation, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_BULK_OPERATION*, bulk_op, PROVISIONING_BULK_OPERATION_RESULT**, bulk_res_ptr);
 
+/** @brief  Performs a bulk operation on any number of individual device enrollment records. The enrollments are sent in chunks
+*           the size the Provisioning Service accepts, with several requests in flight (see prov_sc_set_bulk_operation_requests_in_flight).
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    bulk_op         A pointer to a bulk operation structure with details about the bulk operation.
+* @param    bulk_res_ptr    A pointer to a bulk operation result pointer that will be filled with the results of all the chunks.
+*                           The enrollments of a chunk the Provisioning Service did not process are reported as errors.
+*                           A chunk is only sent again when its connection failed before the request was sent on it. A chunk
+*                           that failed or timed out after it was sent is reported as errors with status 0 and is not sent
+*                           again, as it may have reached the service: its enrollments may or may not have been applied.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_run_individual_enrollment_bulk_operation_chunked, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_BULK_OPERATION*, bulk_op, PROVISIONING_BULK_OPERATION_RESULT**, bulk_res_ptr);
+
 /** @brief  Creates or updates a device enrollment group record on the Provisioning Service.
 *
 * @param    prov_client         The handle used for connecting to the Provisioning Service.
@@ -212,6 +246,76 @@ MOCKABLE_FUNCTION(, int, prov_sc_get_device_registration_state, PROVISIONING_SER
 */
 MOCKABLE_FUNCTION(, int, prov_sc_query_device_registration_state, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec, char**, cont_token_ptr, PROVISIONING_QUERY_RESPONSE**, query_resp_ptr);
 
+/** @brief  Handle to a query iterator, which returns the results of a query one record at a time. The pages of results and their
+*           continuation tokens are handled by the iterator; the next page is requested while the current one is read, and only
+*           the page being read is held in memory. The request timeout of a page only counts the time a next call spends
+*           waiting for it, not the time the page was requested ahead.
+*/
+typedef struct PROV_SC_QUERY_ITERATOR_TAG* PROV_SC_QUERY_ITERATOR_HANDLE;
+
+/** @brief  Creates an iterator over the individual device enrollment records matching a query, and requests the first page.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service. It must not be destroyed before the iterator.
+* @param    query_spec      The query specification with query details and settings. It is not used after the call.
+*
+* @return   A non-NULL PROV_SC_QUERY_ITERATOR_HANDLE upon success, NULL upon failure.
+*/
+MOCKABLE_FUNCTION(, PROV_SC_QUERY_ITERATOR_HANDLE, prov_sc_create_individual_enrollment_query_iterator, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec);
+
+/** @brief  Creates an iterator over the enrollment group records matching a query, and requests the first page.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service. It must not be destroyed before the iterator.
+* @param    query_spec      The query specification with query details and settings. It is not used after the call.
+*
+* @return   A non-NULL PROV_SC_QUERY_ITERATOR_HANDLE upon success, NULL upon failure.
+*/
+MOCKABLE_FUNCTION(, PROV_SC_QUERY_ITERATOR_HANDLE, prov_sc_create_enrollment_group_query_iterator, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec);
+
+/** @brief  Creates an iterator over the device registration states of an enrollment group, and requests the first page.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service. It must not be destroyed before the iterator.
+* @param    query_spec      The query specification with query details and settings. It is not used after the call.
+*
+* @return   A non-NULL PROV_SC_QUERY_ITERATOR_HANDLE upon success, NULL upon failure.
+*/
+MOCKABLE_FUNCTION(, PROV_SC_QUERY_ITERATOR_HANDLE, prov_sc_create_device_registration_state_query_iterator, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec);
+
+/** @brief  Gets the next individual device enrollment record from a query iterator.
+*
+* @param    iterator        A handle created by prov_sc_create_individual_enrollment_query_iterator.
+* @param    enrollment_ptr  A pointer to a handle for an individual enrollment, filled with the next record or NULL when there are no more.
+*                           The record is owned by the caller. If the call fails it can be made again.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_query_iterator_next_individual_enrollment, PROV_SC_QUERY_ITERATOR_HANDLE, iterator, INDIVIDUAL_ENROLLMENT_HANDLE*, enrollment_ptr);
+
+/** @brief  Gets the next enrollment group record from a query iterator.
+*
+* @param    iterator        A handle created by prov_sc_create_enrollment_group_query_iterator.
+* @param    enrollment_ptr  A pointer to a handle for an enrollment group, filled with the next record or NULL when there are no more.
+*                           The record is owned by the caller. If the call fails it can be made again.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_query_iterator_next_enrollment_group, PROV_SC_QUERY_ITERATOR_HANDLE, iterator, ENROLLMENT_GROUP_HANDLE*, enrollment_ptr);
+
+/** @brief  Gets the next device registration state from a query iterator.
+*
+* @param    iterator        A handle created by prov_sc_create_device_registration_state_query_iterator.
+* @param    reg_state_ptr   A pointer to a handle for a registration state, filled with the next record or NULL when there are no more.
+*                           The record is owned by the caller. If the call fails it can be made again.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_query_iterator_next_device_registration_state, PROV_SC_QUERY_ITERATOR_HANDLE, iterator, DEVICE_REGISTRATION_STATE_HANDLE*, reg_state_ptr);
+
+/** @brief  Disposes of a query iterator, abandoning the request for the next page if there is one.
+*
+* @param    iterator        The handle created by one of the query iterator create functions.
+*/
+MOCKABLE_FUNCTION(, void, prov_sc_query_iterator_destroy, PROV_SC_QUERY_ITERATOR_HANDLE, iterator);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdio.h>
 
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/gballoc.h"
@@ -14,6 +15,8 @@
 #include "prov_service_client/provisioning_sc_enrollment.h"
 #include "parson.h"
 
+#define BULK_OPERATION_BUFFER_INITIAL_SIZE  1024
+
 static const char* bulkOperation_mode_toString(PROVISIONING_BULK_OPERATION_MODE mode)
 {
     const char* result;
@@ -209,6 +212,138 @@ char* bulkOperation_serializeToJson(const PROVISIONING_BULK_OPERATION* bulk_op)
     return result;
 }
 
+static int ensure_buffer_capacity(char** buffer, size_t* capacity, size_t required)
+{
+    int result;
+
+    if (required <= *capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        char* new_buffer;
+        size_t new_capacity = (*capacity == 0) ? BULK_OPERATION_BUFFER_INITIAL_SIZE : *capacity;
+        while (new_capacity < required)
+        {
+            new_capacity *= 2;
+        }
+
+        if ((new_buffer = realloc(*buffer, new_capacity)) == NULL)
+        {
+            LogError("Failed to grow the serialization buffer");
+            result = __FAILURE__;
+        }
+        else
+        {
+            *buffer = new_buffer;
+            *capacity = new_capacity;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int bulkOperation_serializeRangeToBuffer(const PROVISIONING_BULK_OPERATION* bulk_op, size_t first, size_t count, char** buffer, size_t* capacity)
+{
+    int result;
+    const char* mode_str;
+
+    if (bulk_op == NULL || bulk_op->enrollments.ie == NULL || count < 1 || first >= bulk_op->num_enrollments || count > bulk_op->num_enrollments - first)
+    {
+        LogError("Invalid bulk operation range");
+        result = __FAILURE__;
+    }
+    else if (buffer == NULL || capacity == NULL)
+    {
+        LogError("Invalid buffer");
+        result = __FAILURE__;
+    }
+    else if (bulk_op->version != PROVISIONING_BULK_OPERATION_VERSION_1)
+    {
+        LogError("Invalid Version");
+        result = __FAILURE__;
+    }
+    else if ((mode_str = bulkOperation_mode_toString(bulk_op->mode)) == NULL)
+    {
+        LogError("Invalid bulk operation mode");
+        result = __FAILURE__;
+    }
+    else
+    {
+        //the enrollments are serialized one at a time straight into the buffer, so the whole operation is never held as a JSON tree
+        int prefix_length = snprintf(NULL, 0, "{\"%s\":\"%s\",\"%s\":[", BULK_ENROLLMENT_OPERATION_JSON_KEY_MODE, mode_str, BULK_ENROLLMENT_OPERATION_JSON_KEY_ENROLLMENTS);
+        size_t length;
+        size_t i;
+
+        if (prefix_length < 0 || ensure_buffer_capacity(buffer, capacity, (size_t)prefix_length + 1) != 0)
+        {
+            LogError("Failed to write the bulk operation mode");
+            result = __FAILURE__;
+        }
+        else
+        {
+            length = (size_t)snprintf(*buffer, *capacity, "{\"%s\":\"%s\",\"%s\":[", BULK_ENROLLMENT_OPERATION_JSON_KEY_MODE, mode_str, BULK_ENROLLMENT_OPERATION_JSON_KEY_ENROLLMENTS);
+            result = 0;
+        }
+
+        for (i = first; (result == 0) && (i < first + count); i++)
+        {
+            //in future, add logic here to decide which toJson function is used depending on bulk_op->type
+            JSON_Value* enrollment_value;
+            size_t enrollment_size;
+
+            if ((enrollment_value = individualEnrollment_toJson(bulk_op->enrollments.ie[i])) == NULL)
+            {
+                LogError("Failed to serialize enrollment %lu", (unsigned long)i);
+                result = __FAILURE__;
+            }
+            else
+            {
+                //enrollment_size counts the terminating null character, add room for the separator and the closing "]}"
+                if ((enrollment_size = json_serialization_size(enrollment_value)) == 0)
+                {
+                    LogError("Failed to size enrollment %lu", (unsigned long)i);
+                    result = __FAILURE__;
+                }
+                else if (ensure_buffer_capacity(buffer, capacity, length + enrollment_size + 3) != 0)
+                {
+                    LogError("Failed to make room for enrollment %lu", (unsigned long)i);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    if (i != first)
+                    {
+                        (*buffer)[length++] = ',';
+                    }
+
+                    if (json_serialize_to_buffer(enrollment_value, *buffer + length, enrollment_size) != JSONSuccess)
+                    {
+                        LogError("Failed to write enrollment %lu", (unsigned long)i);
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        length += enrollment_size - 1;
+                    }
+                }
+                json_value_free(enrollment_value);
+            }
+        }
+
+        if (result == 0)
+        {
+            (*buffer)[length++] = ']';
+            (*buffer)[length++] = '}';
+            (*buffer)[length] = '\0';
+        }
+    }
+
+    return result;
+}
+
 PROVISIONING_BULK_OPERATION_RESULT* bulkOperationResult_deserializeFromJson(const char* json_string)
 {
     PROVISIONING_BULK_OPERATION_RESULT* new_result = NULL;
@@ -255,3 +390,119 @@ void bulkOperationResult_free(PROVISIONING_BULK_OPERATION_RESULT* bulk_op_result
         free(bulk_op_result);
     }
 }
+
+PROVISIONING_BULK_OPERATION_RESULT* bulkOperationResult_create(void)
+{
+    PROVISIONING_BULK_OPERATION_RESULT* new_result;
+
+    if ((new_result = malloc(sizeof(PROVISIONING_BULK_OPERATION_RESULT))) == NULL)
+    {
+        LogError("Allocation of Bulk Operation Result failed");
+    }
+    else
+    {
+        memset(new_result, 0, sizeof(PROVISIONING_BULK_OPERATION_RESULT));
+        new_result->is_successful = true;
+    }
+
+    return new_result;
+}
+
+static int bulkOperationResult_reserveErrors(PROVISIONING_BULK_OPERATION_RESULT* bulk_op_result, size_t num_new_errors)
+{
+    int result;
+    PROVISIONING_BULK_OPERATION_ERROR** new_errors;
+
+    if ((new_errors = realloc(bulk_op_result->errors, (bulk_op_result->num_errors + num_new_errors) * sizeof(PROVISIONING_BULK_OPERATION_ERROR*))) == NULL)
+    {
+        LogError("Failed to grow the Bulk Operation Errors");
+        result = __FAILURE__;
+    }
+    else
+    {
+        bulk_op_result->errors = new_errors;
+        result = 0;
+    }
+
+    return result;
+}
+
+int bulkOperationResult_append(PROVISIONING_BULK_OPERATION_RESULT* bulk_op_result, PROVISIONING_BULK_OPERATION_RESULT* other_result)
+{
+    int result;
+
+    if (bulk_op_result == NULL || other_result == NULL)
+    {
+        LogError("Invalid Bulk Operation Result");
+        result = __FAILURE__;
+    }
+    else if (other_result->num_errors > 0 && bulkOperationResult_reserveErrors(bulk_op_result, other_result->num_errors) != 0)
+    {
+        LogError("Failed to append Bulk Operation Errors");
+        result = __FAILURE__;
+    }
+    else
+    {
+        //the errors are moved, not copied, and other_result is freed
+        for (size_t i = 0; i < other_result->num_errors; i++)
+        {
+            bulk_op_result->errors[bulk_op_result->num_errors++] = other_result->errors[i];
+        }
+        bulk_op_result->is_successful = bulk_op_result->is_successful && other_result->is_successful;
+
+        free(other_result->errors);
+        free(other_result);
+        result = 0;
+    }
+
+    return result;
+}
+
+int bulkOperationResult_addError(PROVISIONING_BULK_OPERATION_RESULT* bulk_op_result, const char* registration_id, int32_t error_code, const char* error_status)
+{
+    int result;
+    PROVISIONING_BULK_OPERATION_ERROR* new_error = NULL;
+
+    if (bulk_op_result == NULL || registration_id == NULL || error_status == NULL)
+    {
+        LogError("Invalid Bulk Operation Error");
+        result = __FAILURE__;
+    }
+    else if ((new_error = malloc(sizeof(PROVISIONING_BULK_OPERATION_ERROR))) == NULL)
+    {
+        LogError("Allocation of Bulk Operation Error failed");
+        result = __FAILURE__;
+    }
+    else
+    {
+        memset(new_error, 0, sizeof(PROVISIONING_BULK_OPERATION_ERROR));
+        new_error->error_code = error_code;
+
+        if (mallocAndStrcpy_s(&(new_error->registration_id), registration_id) != 0)
+        {
+            LogError("Failed to set registration id in Bulk Operation Error");
+            bulkOperationError_free(new_error);
+            result = __FAILURE__;
+        }
+        else if (mallocAndStrcpy_s(&(new_error->error_status), error_status) != 0)
+        {
+            LogError("Failed to set error status in Bulk Operation Error");
+            bulkOperationError_free(new_error);
+            result = __FAILURE__;
+        }
+        else if (bulkOperationResult_reserveErrors(bulk_op_result, 1) != 0)
+        {
+            LogError("Failed to add Bulk Operation Error");
+            bulkOperationError_free(new_error);
+            result = __FAILURE__;
+        }
+        else
+        {
+            bulk_op_result->errors[bulk_op_result->num_errors++] = new_error;
+            bulk_op_result->is_successful = false;
+            result = 0;
+        }
+    }
+
+    return result;
+}
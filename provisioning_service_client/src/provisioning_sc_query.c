@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdbool.h>
 
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/gballoc.h"
@@ -241,6 +242,125 @@ PROVISIONING_QUERY_RESPONSE* queryResponse_deserializeFromJson(const char* json_
      return new_result;
 }
 
+static size_t skip_whitespace(const char* json_string, size_t length, size_t position)
+{
+    while ((position < length) && ((json_string[position] == ' ') || (json_string[position] == '\t') || (json_string[position] == '\r') || (json_string[position] == '\n')))
+    {
+        position++;
+    }
+    return position;
+}
+
+//returns the position of the brace closing the object that starts at position, or length if the object is not complete
+static size_t find_object_end(const char* json_string, size_t length, size_t position)
+{
+    size_t result = length;
+    size_t depth = 0;
+    bool in_string = false;
+
+    while ((result == length) && (position < length))
+    {
+        char c = json_string[position];
+        if (in_string)
+        {
+            if (c == '\\')
+            {
+                position++;
+            }
+            else if (c == '"')
+            {
+                in_string = false;
+            }
+        }
+        else if (c == '"')
+        {
+            in_string = true;
+        }
+        else if ((c == '{') || (c == '['))
+        {
+            depth++;
+        }
+        else if (((c == '}') || (c == ']')) && (--depth == 0))
+        {
+            result = position;
+        }
+        position++;
+    }
+
+    return result;
+}
+
+int queryResponse_nextRecord(char* json_string, size_t length, size_t* position, char** record_json)
+{
+    int result;
+
+    if ((json_string == NULL) || (position == NULL) || (record_json == NULL))
+    {
+        LogError("Invalid parameter json_string: %p, position: %p, record_json: %p", json_string, position, record_json);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t current = *position;
+        result = 0;
+        *record_json = NULL;
+
+        if (current == 0)
+        {
+            current = skip_whitespace(json_string, length, 0);
+            if ((current < length) && (json_string[current] == '['))
+            {
+                current = skip_whitespace(json_string, length, current + 1);
+                if ((current < length) && (json_string[current] == ']'))
+                {
+                    //the page has no records
+                    current = length;
+                }
+            }
+            else
+            {
+                LogError("Query response is not an array");
+                result = __FAILURE__;
+            }
+        }
+        else
+        {
+            current = skip_whitespace(json_string, length, current);
+        }
+
+        if ((result == 0) && (current < length))
+        {
+            size_t end;
+            size_t next;
+
+            if ((json_string[current] != '{') || ((end = find_object_end(json_string, length, current)) == length))
+            {
+                LogError("Malformed record in query response");
+                result = __FAILURE__;
+            }
+            else if (((next = skip_whitespace(json_string, length, end + 1)) < length) && ((json_string[next] == ',') || (json_string[next] == ']')))
+            {
+                //the separator is read before it is overwritten by the end of the record
+                *record_json = &json_string[current];
+                current = (json_string[next] == ',') ? next + 1 : length;
+                json_string[end + 1] = '\0';
+            }
+            else
+            {
+                LogError("Malformed record separator in query response");
+                result = __FAILURE__;
+            }
+        }
+
+        if (result == 0)
+        {
+            *position = current;
+        }
+    }
+
+    return result;
+}
+
 PROVISIONING_QUERY_TYPE queryType_stringToEnum(const char* string)
 {
     PROVISIONING_QUERY_TYPE result;
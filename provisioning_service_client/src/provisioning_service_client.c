@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdbool.h>
 
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -14,6 +15,8 @@
 #include "azure_c_shared_utility/connection_string_parser.h"
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/http_proxy_io.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/tickcounter.h"
 
 #include "azure_uhttp_c/uhttp.h"
 
@@ -32,6 +35,26 @@ typedef enum HTTP_CONNECTION_STATE_TAG
     HTTP_STATE_ERROR
 } HTTP_CONNECTION_STATE;
 
+typedef struct PROV_SC_CONNECTION_TAG
+{
+    HTTP_CLIENT_HANDLE http_client;
+    HTTP_CONNECTION_STATE http_state;
+    bool request_sent;
+    bool response_received;
+    unsigned int status_code;
+    char* response;
+    HTTP_HEADERS_HANDLE response_headers;
+} PROV_SC_CONNECTION;
+
+typedef struct PROV_SC_REQUEST_TAG
+{
+    HTTP_CLIENT_REQUEST_TYPE operation;
+    const char* registration_path;
+    HTTP_HEADERS_HANDLE request_headers;
+    const char* content;
+    size_t content_len;
+} PROV_SC_REQUEST;
+
 //consider substructure representing SharedAccessSignature?
 typedef struct PROVISIONING_SERVICE_CLIENT_TAG
 {
@@ -41,17 +64,58 @@ typedef struct PROVISIONING_SERVICE_CLIENT_TAG
     char* access_key;
 
     //Connection data
-    HTTP_CONNECTION_STATE http_state;
-    char* response;
-    HTTP_HEADERS_HANDLE response_headers;
+    PROV_SC_CONNECTION connection;
+    PROV_SC_CONNECTION* bulk_connections; //used with connection by bulk operations that keep more than one request in flight
+    size_t bulk_connection_count;
+    TICK_COUNTER_HANDLE tick_counter;
 
     //Connection options
     TRACING_STATUS tracing;
     HTTP_PROXY_OPTIONS* proxy_options;
     char* certificate;
+    size_t request_timeout_ms;
+    size_t bulk_requests_in_flight;
 
 } PROV_SERVICE_CLIENT;
 
+//one request of a chunked bulk operation, sent on its own connection
+typedef struct BULK_OPERATION_LANE_TAG
+{
+    PROV_SC_CONNECTION* connection;
+    PROV_SC_REQUEST request;
+    char* content;
+    size_t content_capacity;
+    size_t first_enrollment;
+    size_t num_enrollments;
+    tickcounter_ms_t request_start;
+    bool busy;
+    bool reused_connection;
+    bool retried;
+    bool timed_out;
+} BULK_OPERATION_LANE;
+
+//walks the results of a query record by record, the request for the next page is in flight while the current one is read
+typedef struct PROV_SC_QUERY_ITERATOR_TAG
+{
+    PROV_SERVICE_CLIENT* prov_client;
+    PROV_SC_CONNECTION connection;
+    PROV_SC_REQUEST request;
+    PROVISIONING_QUERY_TYPE type;
+    STRING_HANDLE registration_path;
+    char* content;
+    size_t page_size;
+    char* cont_token;
+    tickcounter_ms_t request_start;
+    bool page_requested;
+    bool last_page;
+    bool reused_connection;
+
+    //the body of the page being read, the records are cut out of it in place
+    char* page;
+    size_t page_length;
+    size_t page_position;
+} PROV_SC_QUERY_ITERATOR;
+
 typedef char*(*VECTOR_SERIALIZE_TO_JSON)(void*);
 typedef void*(*VECTOR_DESERIALIZE_FROM_JSON)(char*);
 typedef char*(*VECTOR_GET_ID)(void*);
@@ -90,11 +154,16 @@ static const char* const HEADER_KEY_ITEM_TYPE =                 "x-ms-item-type"
 static const char* const HEADER_VALUE_USER_AGENT =              "iothub_dps_prov_client/1.0";
 static const char* const HEADER_VALUE_ACCEPT =                  "application/json";
 static const char* const HEADER_VALUE_CONTENT_TYPE =            "application/json; charset=utf-8";
+static const char* const BULK_REQUEST_FAILED_STATUS =           "Bulk operation request failed";
 
 #define DEFAULT_HTTPS_PORT          443
 #define UID_LENGTH                  37
 #define SAS_TOKEN_DEFAULT_LIFETIME  3600
 #define EPOCH_TIME_T_VALUE          (time_t)0
+#define DEFAULT_REQUEST_TIMEOUT_MS  60000
+#define HTTP_IDLE_WAIT_MS           1
+#define BULK_OPERATION_MAX_ENROLLMENTS      10
+#define DEFAULT_BULK_REQUESTS_IN_FLIGHT     4
 
 static HANDLE_FUNCTION_VECTOR getVector_individualEnrollment()
 {
@@ -136,14 +205,14 @@ static void on_http_connected(void* callback_ctx, HTTP_CALLBACK_REASON connect_r
 {
     if (callback_ctx != NULL)
     {
-        PROV_SERVICE_CLIENT* prov_client = (PROV_SERVICE_CLIENT*)callback_ctx;
+        PROV_SC_CONNECTION* connection = (PROV_SC_CONNECTION*)callback_ctx;
         if (connect_result == HTTP_CALLBACK_REASON_OK)
         {
-            prov_client->http_state = HTTP_STATE_CONNECTED;
+            connection->http_state = HTTP_STATE_CONNECTED;
         }
         else
         {
-            prov_client->http_state = HTTP_STATE_ERROR;
+            connection->http_state = HTTP_STATE_ERROR;
         }
     }
 }
@@ -153,8 +222,8 @@ static void on_http_error(void* callback_ctx, HTTP_CALLBACK_REASON error_result)
     (void)error_result;
     if (callback_ctx != NULL)
     {
-        PROV_SERVICE_CLIENT* prov_client = (PROV_SERVICE_CLIENT*)callback_ctx;
-        prov_client->http_state = HTTP_STATE_ERROR;
+        PROV_SC_CONNECTION* connection = (PROV_SC_CONNECTION*)callback_ctx;
+        connection->http_state = HTTP_STATE_ERROR;
         LogError("Failure encountered in http %d", error_result);
     }
     else
@@ -168,49 +237,51 @@ static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_
     (void)content_len;
     if (callback_ctx != NULL)
     {
-        PROV_SERVICE_CLIENT* prov_client = (PROV_SERVICE_CLIENT*)callback_ctx;
+        PROV_SC_CONNECTION* connection = (PROV_SC_CONNECTION*)callback_ctx;
         const char* content_str = (const char*)content;
 
-        //attach headers to prov_client
+        //attach headers to the connection
         if (responseHeadersHandle != NULL)
         {
-            if ((prov_client->response_headers = HTTPHeaders_Clone(responseHeadersHandle)) == NULL)
+            if ((connection->response_headers = HTTPHeaders_Clone(responseHeadersHandle)) == NULL)
             {
                 LogError("Copying response headers failed");
-                prov_client->response_headers = NULL;
+                connection->response_headers = NULL;
             }
         }
 
         //if there is a json response
         if (content != NULL)
         {
-            if ((prov_client->response = malloc(content_len + 1)) == NULL)
+            if ((connection->response = malloc(content_len + 1)) == NULL)
             {
                 LogError("Allocating response failed");
-                prov_client->response = NULL;
+                connection->response = NULL;
             }
             else
             {
-                memset(prov_client->response, 0, content_len);
-                memcpy(prov_client->response, content_str, content_len);
+                memset(connection->response, 0, content_len + 1);
+                memcpy(connection->response, content_str, content_len);
             }
         }
 
         //update HTTP state
         if (request_result == HTTP_CALLBACK_REASON_OK)
         {
+            connection->response_received = true;
+            connection->status_code = status_code;
             if (status_code >= 200 && status_code <= 299)
             {
-                prov_client->http_state = HTTP_STATE_REQUEST_RECV;
+                connection->http_state = HTTP_STATE_REQUEST_RECV;
             }
             else
             {
-                prov_client->http_state = HTTP_STATE_ERROR;
+                connection->http_state = HTTP_STATE_ERROR;
             }
         }
         else
         {
-            prov_client->http_state = HTTP_STATE_ERROR;
+            connection->http_state = HTTP_STATE_ERROR;
         }
     }
     else
@@ -322,10 +393,10 @@ static STRING_HANDLE create_registration_path(const char* path_format, const cha
     return registration_path;
 }
 
-static int get_response_headers(PROV_SERVICE_CLIENT* prov_client, char** cont_token_ptr, const char** resp_type_ptr)
+static int get_response_headers(const PROV_SC_CONNECTION* connection, char** cont_token_ptr, const char** resp_type_ptr)
 {
     int result = 0;
-    HTTP_HEADERS_HANDLE resp_headers = prov_client->response_headers;
+    HTTP_HEADERS_HANDLE resp_headers = connection->response_headers;
     if (resp_headers == NULL)
     {
         LogError("Unable to retrieve headers");
@@ -359,7 +430,7 @@ static int get_response_headers(PROV_SERVICE_CLIENT* prov_client, char** cont_to
     return result;
 }
 
-static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
+static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client, PROV_SC_CONNECTION* connection)
 {
     HTTP_CLIENT_HANDLE result;
 
@@ -391,7 +462,7 @@ static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
         LogError("platform default tlsio is NULL");
         result = NULL;
     }
-    else if ((result = uhttp_client_create(interface_desc, &tls_io_config, on_http_error, prov_client)) == NULL)
+    else if ((result = uhttp_client_create(interface_desc, &tls_io_config, on_http_error, connection)) == NULL)
     {
         LogError("Failed creating http object");
     }
@@ -407,7 +478,7 @@ static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
         uhttp_client_destroy(result);
         result = NULL;
     }
-    else if (uhttp_client_open(result, prov_client->provisioning_service_uri, DEFAULT_HTTPS_PORT, on_http_connected, prov_client) != HTTP_CLIENT_OK)
+    else if (uhttp_client_open(result, prov_client->provisioning_service_uri, DEFAULT_HTTPS_PORT, on_http_connected, connection) != HTTP_CLIENT_OK)
     {
         LogError("Failed opening http url %s", prov_client->provisioning_service_uri);
         uhttp_client_destroy(result);
@@ -416,71 +487,458 @@ static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
     return result;
 }
 
-static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT_REQUEST_TYPE operation, const char* registration_path, HTTP_HEADERS_HANDLE request_headers, const char* content)
+static void disconnect_from_service(PROV_SC_CONNECTION* connection)
+{
+    if (connection->http_client != NULL)
+    {
+        uhttp_client_close(connection->http_client, NULL, NULL);
+        uhttp_client_destroy(connection->http_client);
+        connection->http_client = NULL;
+    }
+    connection->http_state = HTTP_STATE_DISCONNECTED;
+}
+
+static void disconnect_all_from_service(PROV_SERVICE_CLIENT* prov_client)
+{
+    disconnect_from_service(&prov_client->connection);
+    for (size_t i = 0; i < prov_client->bulk_connection_count; i++)
+    {
+        disconnect_from_service(&prov_client->bulk_connections[i]);
+    }
+}
+
+static void clear_response(PROV_SC_CONNECTION* connection)
+{
+    free(connection->response);
+    connection->response = NULL;
+    HTTPHeaders_Free(connection->response_headers);
+    connection->response_headers = NULL;
+}
+
+//uhttp does not expose its socket, so when a call to uhttp_client_dowork brings nothing new the caller sleeps instead of spinning
+static int wait_for_service(PROV_SERVICE_CLIENT* prov_client, tickcounter_ms_t request_start)
 {
     int result;
-    size_t content_len;
-    HTTP_CLIENT_HANDLE http_client;
+    tickcounter_ms_t now;
 
-    if (content == NULL)
+    if (tickcounter_get_current_ms(prov_client->tick_counter, &now) != 0)
     {
-        content_len = 0;
+        LogError("Failure reading the tick counter");
+        result = __FAILURE__;
+    }
+    else if ((prov_client->request_timeout_ms != 0) && ((now - request_start) >= prov_client->request_timeout_ms))
+    {
+        LogError("Request timed out after %lu ms", (unsigned long)(now - request_start));
+        result = __FAILURE__;
     }
     else
     {
-        content_len = strlen(content);
+        ThreadAPI_Sleep(HTTP_IDLE_WAIT_MS);
+        result = 0;
+    }
+
+    return result;
+}
+
+//moves the request on connection one step forward, returns true if the state of the connection changed
+static bool connection_do_work(PROV_SC_CONNECTION* connection, const PROV_SC_REQUEST* request)
+{
+    HTTP_CONNECTION_STATE previous_state = connection->http_state;
+
+    uhttp_client_dowork(connection->http_client);
+    if (connection->http_state == HTTP_STATE_CONNECTED)
+    {
+        if (uhttp_client_execute_request(connection->http_client, request->operation, request->registration_path, request->request_headers, (unsigned char*)request->content, request->content_len, on_http_reply_recv, connection) != HTTP_CLIENT_OK)
+        {
+            LogError("Failure executing http request");
+            connection->http_state = HTTP_STATE_ERROR;
+        }
+        else
+        {
+            connection->http_state = HTTP_STATE_REQUEST_SENT;
+            connection->request_sent = true;
+        }
+    }
+    else if (connection->http_state == HTTP_STATE_REQUEST_RECV)
+    {
+        connection->http_state = HTTP_STATE_COMPLETE;
+    }
+
+    return connection->http_state != previous_state;
+}
+
+static int execute_request(PROV_SERVICE_CLIENT* prov_client, PROV_SC_CONNECTION* connection, const PROV_SC_REQUEST* request, tickcounter_ms_t request_start, bool* timed_out)
+{
+    int result;
+
+    //the request may have been moved forward before, by the caller
+    *timed_out = false;
+    while (connection->http_state != HTTP_STATE_COMPLETE && connection->http_state != HTTP_STATE_ERROR)
+    {
+        if (!connection_do_work(connection, request) && (wait_for_service(prov_client, request_start) != 0))
+        {
+            connection->http_state = HTTP_STATE_ERROR;
+            *timed_out = true;
+        }
     }
 
-    http_client = connect_to_service(prov_client);
-    if (http_client == NULL)
+    if (connection->http_state == HTTP_STATE_ERROR)
     {
-        LogError("Failed connecting to service");
+        LogError("HTTP error");
         result = __FAILURE__;
     }
     else
     {
         result = 0;
+    }
+
+    return result;
+}
+
+//idempotent is false for a request the service must not apply twice, it is then only sent again if it never left the client
+static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT_REQUEST_TYPE operation, const char* registration_path, HTTP_HEADERS_HANDLE request_headers, const char* content, bool idempotent)
+{
+    int result;
+    PROV_SC_CONNECTION* connection = &prov_client->connection;
+    PROV_SC_REQUEST request;
+    tickcounter_ms_t request_start;
+
+    request.operation = operation;
+    request.registration_path = registration_path;
+    request.request_headers = request_headers;
+    request.content = content;
+    if (content == NULL)
+    {
+        request.content_len = 0;
+    }
+    else
+    {
+        request.content_len = strlen(content);
+    }
+
+    if (tickcounter_get_current_ms(prov_client->tick_counter, &request_start) != 0)
+    {
+        LogError("Failure reading the tick counter");
+        result = __FAILURE__;
+    }
+    else
+    {
+        bool retry;
         do
         {
-            uhttp_client_dowork(http_client);
-            if (prov_client->http_state == HTTP_STATE_CONNECTED)
+            //the connection is kept open between calls, a new one is only made when there is none
+            bool reused_connection = (connection->http_client != NULL);
+            retry = false;
+
+            if (!reused_connection && ((connection->http_client = connect_to_service(prov_client, connection)) == NULL))
+            {
+                LogError("Failed connecting to service");
+                result = __FAILURE__;
+            }
+            else
             {
-                if (uhttp_client_execute_request(http_client, operation, registration_path, request_headers, (unsigned char*)content, content_len, on_http_reply_recv, prov_client) != HTTP_CLIENT_OK)
+                bool timed_out;
+                connection->request_sent = false;
+                connection->response_received = false;
+                connection->status_code = 0;
+                if ((result = execute_request(prov_client, connection, &request, request_start, &timed_out)) != 0)
                 {
-                    LogError("Failure executing http request");
-                    prov_client->http_state = HTTP_STATE_ERROR;
-                    result = __FAILURE__;
+                    //a kept-alive connection the service closed fails before any reply, the request is sent once more on a new connection
+                    retry = reused_connection && !connection->response_received && !timed_out && (idempotent || !connection->request_sent);
+                    disconnect_from_service(connection);
                 }
                 else
                 {
-                    prov_client->http_state = HTTP_STATE_REQUEST_SENT;
+                    connection->http_state = HTTP_STATE_CONNECTED;
                 }
             }
-            else if (prov_client->http_state == HTTP_STATE_REQUEST_RECV)
+        } while (retry);
+    }
+
+    return result;
+}
+
+static PROV_SC_CONNECTION* get_bulk_connection(PROV_SERVICE_CLIENT* prov_client, size_t index)
+{
+    return (index == 0) ? &prov_client->connection : &prov_client->bulk_connections[index - 1];
+}
+
+static int reserve_bulk_connections(PROV_SERVICE_CLIENT* prov_client, size_t num_connections)
+{
+    int result;
+
+    if (num_connections <= prov_client->bulk_connection_count)
+    {
+        result = 0;
+    }
+    else
+    {
+        PROV_SC_CONNECTION* new_connections;
+
+        //the uhttp clients point back to their connection, which realloc may move
+        for (size_t i = 0; i < prov_client->bulk_connection_count; i++)
+        {
+            disconnect_from_service(&prov_client->bulk_connections[i]);
+        }
+
+        if ((new_connections = realloc(prov_client->bulk_connections, num_connections * sizeof(PROV_SC_CONNECTION))) == NULL)
+        {
+            LogError("Failed allocating bulk operation connections");
+            result = __FAILURE__;
+        }
+        else
+        {
+            memset(&new_connections[prov_client->bulk_connection_count], 0, (num_connections - prov_client->bulk_connection_count) * sizeof(PROV_SC_CONNECTION));
+            prov_client->bulk_connections = new_connections;
+            prov_client->bulk_connection_count = num_connections;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+//a chunk the service did not process is reported as one error per enrollment
+static int add_bulk_chunk_errors(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, const PROVISIONING_BULK_OPERATION* bulk_op, const BULK_OPERATION_LANE* lane, const char* error_status)
+{
+    int result = 0;
+
+    for (size_t i = lane->first_enrollment; (result == 0) && (i < lane->first_enrollment + lane->num_enrollments); i++)
+    {
+        const char* registration_id = individualEnrollment_getRegistrationId(bulk_op->enrollments.ie[i]);
+        if (bulkOperationResult_addError(bulk_res, (registration_id == NULL) ? "" : registration_id, (int32_t)lane->connection->status_code, error_status) != 0)
+        {
+            LogError("Failure reporting the enrollments of a failed bulk operation request");
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
+static int start_bulk_chunk(PROV_SERVICE_CLIENT* prov_client, BULK_OPERATION_LANE* lane, const PROVISIONING_BULK_OPERATION* bulk_op, size_t* next_enrollment, PROVISIONING_BULK_OPERATION_RESULT* bulk_res)
+{
+    int result = 0;
+
+    while ((result == 0) && !lane->busy && (*next_enrollment < bulk_op->num_enrollments))
+    {
+        lane->first_enrollment = *next_enrollment;
+        lane->num_enrollments = bulk_op->num_enrollments - lane->first_enrollment;
+        if (lane->num_enrollments > BULK_OPERATION_MAX_ENROLLMENTS)
+        {
+            lane->num_enrollments = BULK_OPERATION_MAX_ENROLLMENTS;
+        }
+        *next_enrollment += lane->num_enrollments;
+
+        //the headers are made for every chunk so that the SAS token does not expire during a long operation
+        HTTPHeaders_Free(lane->request.request_headers);
+        if ((lane->request.request_headers = construct_http_headers(prov_client, NULL, HTTP_CLIENT_REQUEST_POST)) == NULL)
+        {
+            LogError("Failure constructing http headers");
+            result = __FAILURE__;
+        }
+        else if (bulkOperation_serializeRangeToBuffer(bulk_op, lane->first_enrollment, lane->num_enrollments, &lane->content, &lane->content_capacity) != 0)
+        {
+            LogError("Failure serializing bulk operation");
+            result = __FAILURE__;
+        }
+        else if (tickcounter_get_current_ms(prov_client->tick_counter, &lane->request_start) != 0)
+        {
+            LogError("Failure reading the tick counter");
+            result = __FAILURE__;
+        }
+        else
+        {
+            lane->request.content = lane->content;
+            lane->request.content_len = strlen(lane->content);
+            lane->reused_connection = (lane->connection->http_client != NULL);
+            lane->retried = false;
+            lane->timed_out = false;
+            lane->connection->request_sent = false;
+            lane->connection->response_received = false;
+            lane->connection->status_code = 0;
+
+            if (!lane->reused_connection && ((lane->connection->http_client = connect_to_service(prov_client, lane->connection)) == NULL))
+            {
+                LogError("Failed connecting to service");
+                result = add_bulk_chunk_errors(bulk_res, bulk_op, lane, BULK_REQUEST_FAILED_STATUS);
+            }
+            else
             {
-                prov_client->http_state = HTTP_STATE_COMPLETE;
+                lane->busy = true;
             }
-            else if (prov_client->http_state == HTTP_STATE_ERROR)
+        }
+    }
+
+    return result;
+}
+
+static int complete_bulk_chunk(BULK_OPERATION_LANE* lane, const PROVISIONING_BULK_OPERATION* bulk_op, PROVISIONING_BULK_OPERATION_RESULT* bulk_res)
+{
+    int result;
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res;
+
+    if ((chunk_res = bulkOperationResult_deserializeFromJson(lane->connection->response)) == NULL)
+    {
+        LogError("Failure deserializing bulk operation result");
+        result = add_bulk_chunk_errors(bulk_res, bulk_op, lane, BULK_REQUEST_FAILED_STATUS);
+    }
+    else if (bulkOperationResult_append(bulk_res, chunk_res) != 0)
+    {
+        LogError("Failure merging bulk operation result");
+        bulkOperationResult_free(chunk_res);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    clear_response(lane->connection);
+    lane->connection->http_state = HTTP_STATE_CONNECTED;
+    lane->busy = false;
+
+    return result;
+}
+
+static int fail_bulk_chunk(PROV_SERVICE_CLIENT* prov_client, BULK_OPERATION_LANE* lane, const PROVISIONING_BULK_OPERATION* bulk_op, PROVISIONING_BULK_OPERATION_RESULT* bulk_res)
+{
+    int result;
+
+    if (lane->reused_connection && !lane->retried && !lane->connection->request_sent && !lane->timed_out)
+    {
+        //a kept-alive connection the service closed before the chunk was handed to it, the chunk is sent once more on a new connection.
+        //a bulk POST is not idempotent, so once it may have reached the service it is reported as errors instead
+        clear_response(lane->connection);
+        disconnect_from_service(lane->connection);
+        lane->retried = true;
+        if ((lane->connection->http_client = connect_to_service(prov_client, lane->connection)) == NULL)
+        {
+            LogError("Failed connecting to service");
+            result = add_bulk_chunk_errors(bulk_res, bulk_op, lane, BULK_REQUEST_FAILED_STATUS);
+            lane->busy = false;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    else
+    {
+        result = add_bulk_chunk_errors(bulk_res, bulk_op, lane, (lane->connection->response != NULL) ? lane->connection->response : BULK_REQUEST_FAILED_STATUS);
+        clear_response(lane->connection);
+        disconnect_from_service(lane->connection);
+        lane->busy = false;
+    }
+
+    return result;
+}
+
+//like wait_for_service, for every request of a bulk operation. The deadlines are checked on every pass, a lane
+//that stalls times out even while the other lanes keep making progress; the sleep only happens when none did
+static int check_bulk_lanes(PROV_SERVICE_CLIENT* prov_client, BULK_OPERATION_LANE* lanes, size_t lane_count, bool progress)
+{
+    int result;
+    tickcounter_ms_t now;
+
+    if (prov_client->request_timeout_ms == 0)
+    {
+        result = 0;
+    }
+    else if (tickcounter_get_current_ms(prov_client->tick_counter, &now) != 0)
+    {
+        LogError("Failure reading the tick counter");
+        result = __FAILURE__;
+    }
+    else
+    {
+        for (size_t i = 0; i < lane_count; i++)
+        {
+            if (lanes[i].busy && (lanes[i].connection->http_state != HTTP_STATE_ERROR) && ((now - lanes[i].request_start) >= prov_client->request_timeout_ms))
             {
-                result = __FAILURE__;
-                LogError("HTTP error");
+                LogError("Bulk operation request timed out after %lu ms", (unsigned long)(now - lanes[i].request_start));
+                lanes[i].connection->http_state = HTTP_STATE_ERROR;
+                lanes[i].timed_out = true;
             }
-        } while (prov_client->http_state != HTTP_STATE_COMPLETE && prov_client->http_state != HTTP_STATE_ERROR);
+        }
+        result = 0;
+    }
 
-        uhttp_client_close(http_client, NULL, NULL);
-        uhttp_client_destroy(http_client);
+    if ((result == 0) && !progress)
+    {
+        ThreadAPI_Sleep(HTTP_IDLE_WAIT_MS);
     }
 
-    prov_client->http_state = HTTP_STATE_DISCONNECTED;
     return result;
 }
 
-static void clear_response(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+//keeps a request in flight on every lane until all the chunks of bulk_op are done
+static int run_bulk_lanes(PROV_SERVICE_CLIENT* prov_client, BULK_OPERATION_LANE* lanes, size_t lane_count, const PROVISIONING_BULK_OPERATION* bulk_op, PROVISIONING_BULK_OPERATION_RESULT* bulk_res)
 {
-    free(prov_client->response);
-    prov_client->response = NULL;
-    HTTPHeaders_Free(prov_client->response_headers);
-    prov_client->response_headers = NULL;
+    int result = 0;
+    size_t next_enrollment = 0;
+    size_t busy_lanes;
+
+    do
+    {
+        bool progress = false;
+        busy_lanes = 0;
+
+        for (size_t i = 0; (result == 0) && (i < lane_count); i++)
+        {
+            BULK_OPERATION_LANE* lane = &lanes[i];
+
+            if (!lane->busy)
+            {
+                result = start_bulk_chunk(prov_client, lane, bulk_op, &next_enrollment, bulk_res);
+            }
+
+            if ((result == 0) && lane->busy)
+            {
+                if ((lane->connection->http_state != HTTP_STATE_ERROR) && connection_do_work(lane->connection, &lane->request))
+                {
+                    progress = true;
+                }
+
+                if (lane->connection->http_state == HTTP_STATE_COMPLETE)
+                {
+                    result = complete_bulk_chunk(lane, bulk_op, bulk_res);
+                    progress = true;
+                }
+                else if (lane->connection->http_state == HTTP_STATE_ERROR)
+                {
+                    result = fail_bulk_chunk(prov_client, lane, bulk_op, bulk_res);
+                    progress = true;
+                }
+
+                if (lane->busy)
+                {
+                    busy_lanes++;
+                }
+            }
+        }
+
+        if ((result == 0) && (busy_lanes > 0))
+        {
+            result = check_bulk_lanes(prov_client, lanes, lane_count, progress);
+        }
+    } while ((result == 0) && ((busy_lanes > 0) || (next_enrollment < bulk_op->num_enrollments)));
+
+    if (result != 0)
+    {
+        //the requests still in flight are abandoned with their connection
+        for (size_t i = 0; i < lane_count; i++)
+        {
+            if (lanes[i].busy)
+            {
+                clear_response(lanes[i].connection);
+                disconnect_from_service(lanes[i].connection);
+                lanes[i].busy = false;
+            }
+        }
+    }
+
+    return result;
 }
 
 static int prov_sc_create_or_update_record(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, void** handle_ptr, HANDLE_FUNCTION_VECTOR vector, const char* path_format)
@@ -530,12 +988,12 @@ static int prov_sc_create_or_update_record(PROVISIONING_SERVICE_CLIENT_HANDLE pr
                 }
                 else
                 {
-                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_PUT, STRING_c_str(registration_path), request_headers, content);
+                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_PUT, STRING_c_str(registration_path), request_headers, content, true);
 
                     if (result == 0)
                     {
                         INDIVIDUAL_ENROLLMENT_HANDLE new_handle;
-                        if ((new_handle = vector.deserializeFromJson(prov_client->response)) == NULL)
+                        if ((new_handle = vector.deserializeFromJson(prov_client->connection.response)) == NULL)
                         {
                             LogError("Failure constructing new enrollment structure from json response");
                             result = __FAILURE__;
@@ -549,7 +1007,7 @@ static int prov_sc_create_or_update_record(PROVISIONING_SERVICE_CLIENT_HANDLE pr
                     {
                         LogError("Rest call failed");
                     }
-                    clear_response(prov_client);
+                    clear_response(&prov_client->connection);
                 }
                 HTTPHeaders_Free(request_headers);
             }
@@ -593,8 +1051,8 @@ static int prov_sc_delete_record_by_param(PROVISIONING_SERVICE_CLIENT_HANDLE pro
             }
             else
             {
-                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_DELETE, STRING_c_str(registration_path), request_headers, NULL);
-                clear_response(prov_client);
+                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_DELETE, STRING_c_str(registration_path), request_headers, NULL, true);
+                clear_response(&prov_client->connection);
             }
             HTTPHeaders_Free(request_headers);
         }
@@ -641,19 +1099,19 @@ static int prov_sc_get_record(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, co
             }
             else
             {
-                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_GET, STRING_c_str(registration_path), request_headers, NULL);
+                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_GET, STRING_c_str(registration_path), request_headers, NULL, true);
 
                 if (result == 0)
                 {
                     void* handle;
-                    if ((handle = vector.deserializeFromJson(prov_client->response)) == NULL)
+                    if ((handle = vector.deserializeFromJson(prov_client->connection.response)) == NULL)
                     {
                         LogError("Failure constructing new enrollment structure from json response");
                         result = __FAILURE__;
                     }
                     *handle_ptr = handle;
                 }
-                clear_response(prov_client);
+                clear_response(&prov_client->connection);
             }
             HTTPHeaders_Free(request_headers);
         }
@@ -713,11 +1171,11 @@ static int prov_sc_run_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_cl
                 }
                 else
                 {
-                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, content);
+                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, content, false);
 
                     if (result == 0)
                     {
-                        if ((*bulk_res_ptr = bulkOperationResult_deserializeFromJson(prov_client->response)) == NULL)
+                        if ((*bulk_res_ptr = bulkOperationResult_deserializeFromJson(prov_client->connection.response)) == NULL)
                         {
                             LogError("Failure deserializing bulk operation result");
                             result = __FAILURE__;
@@ -727,7 +1185,7 @@ static int prov_sc_run_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_cl
                     {
                         LogError("Rest call failed");
                     }
-                    clear_response(prov_client);
+                    clear_response(&prov_client->connection);
                 }
                 HTTPHeaders_Free(request_headers);
             }
@@ -739,28 +1197,115 @@ static int prov_sc_run_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_cl
     return result;
 }
 
-static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, char** cont_token_ptr, PROVISIONING_QUERY_RESPONSE** query_res_ptr, const char* path_format)
+static int prov_sc_run_chunked_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_BULK_OPERATION* bulk_op, PROVISIONING_BULK_OPERATION_RESULT** bulk_res_ptr, const char* path_format)
 {
-    int result = 0;
+    int result;
 
     if (prov_client == NULL)
     {
         LogError("Invalid Provisioning Client Handle");
         result = __FAILURE__;
     }
-    else if (query_spec == NULL || query_spec->version != PROVISIONING_QUERY_SPECIFICATION_VERSION_1)
+    else if (bulk_op == NULL || bulk_op->num_enrollments < 1 || bulk_op->enrollments.ie == NULL)
     {
-        LogError("Invalid Query details");
+        LogError("Invalid Bulk Op");
         result = __FAILURE__;
     }
-    else if (cont_token_ptr == NULL)
+    else if (bulk_op->version != PROVISIONING_BULK_OPERATION_VERSION_1)
     {
-        LogError("Invalid Continuation Token pointer");
+        LogError("Invalid Bulk Op Version #");
         result = __FAILURE__;
     }
-    else if (query_res_ptr == NULL)
+    else if (bulk_res_ptr == NULL)
     {
-        LogError("Invalid Query Response pointer");
+        LogError("Invalid Bulk Op Result pointer");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t num_chunks = (bulk_op->num_enrollments + BULK_OPERATION_MAX_ENROLLMENTS - 1) / BULK_OPERATION_MAX_ENROLLMENTS;
+        size_t lane_count = (prov_client->bulk_requests_in_flight < num_chunks) ? prov_client->bulk_requests_in_flight : num_chunks;
+        BULK_OPERATION_LANE* lanes = NULL;
+        STRING_HANDLE registration_path = NULL;
+        PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+
+        //the first lane uses the connection of the other requests, the others get their own
+        if (reserve_bulk_connections(prov_client, lane_count - 1) != 0)
+        {
+            LogError("Failure reserving bulk operation connections");
+            result = __FAILURE__;
+        }
+        else if ((lanes = malloc(lane_count * sizeof(BULK_OPERATION_LANE))) == NULL)
+        {
+            LogError("Failure allocating bulk operation lanes");
+            result = __FAILURE__;
+        }
+        else if ((registration_path = create_registration_path(path_format, NULL)) == NULL)
+        {
+            LogError("Failed to construct a registration path");
+            result = __FAILURE__;
+        }
+        else if ((bulk_res = bulkOperationResult_create()) == NULL)
+        {
+            LogError("Failure creating bulk operation result");
+            result = __FAILURE__;
+        }
+        else
+        {
+            memset(lanes, 0, lane_count * sizeof(BULK_OPERATION_LANE));
+            for (size_t i = 0; i < lane_count; i++)
+            {
+                lanes[i].connection = get_bulk_connection(prov_client, i);
+                lanes[i].request.operation = HTTP_CLIENT_REQUEST_POST;
+                lanes[i].request.registration_path = STRING_c_str(registration_path);
+            }
+
+            if ((result = run_bulk_lanes(prov_client, lanes, lane_count, bulk_op, bulk_res)) != 0)
+            {
+                LogError("Bulk operation failed");
+                bulkOperationResult_free(bulk_res);
+            }
+            else
+            {
+                *bulk_res_ptr = bulk_res;
+            }
+
+            for (size_t i = 0; i < lane_count; i++)
+            {
+                HTTPHeaders_Free(lanes[i].request.request_headers);
+                free(lanes[i].content);
+            }
+        }
+
+        STRING_delete(registration_path);
+        free(lanes);
+    }
+
+    return result;
+}
+
+static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, char** cont_token_ptr, PROVISIONING_QUERY_RESPONSE** query_res_ptr, const char* path_format)
+{
+    int result = 0;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid Provisioning Client Handle");
+        result = __FAILURE__;
+    }
+    else if (query_spec == NULL || query_spec->version != PROVISIONING_QUERY_SPECIFICATION_VERSION_1)
+    {
+        LogError("Invalid Query details");
+        result = __FAILURE__;
+    }
+    else if (cont_token_ptr == NULL)
+    {
+        LogError("Invalid Continuation Token pointer");
+        result = __FAILURE__;
+    }
+    else if (query_res_ptr == NULL)
+    {
+        LogError("Invalid Query Response pointer");
         result = __FAILURE__;
     }
     else
@@ -796,7 +1341,7 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
                 }
                 else
                 {
-                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, content);
+                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, content, true);
 
                     if (result == 0)
                     {
@@ -804,7 +1349,7 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
                         char* new_cont_token = NULL;
                         PROVISIONING_QUERY_TYPE type;
 
-                        if (get_response_headers(prov_client, &new_cont_token, &resp_type) != 0)
+                        if (get_response_headers(&prov_client->connection, &new_cont_token, &resp_type) != 0)
                         {
                             LogError("Failure reading response headers");
                             result = __FAILURE__;
@@ -814,7 +1359,7 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
                             LogError("Failure to parse response type");
                             result = __FAILURE__;
                         }
-                        else if ((*query_res_ptr = queryResponse_deserializeFromJson(prov_client->response, type)) == NULL)
+                        else if ((*query_res_ptr = queryResponse_deserializeFromJson(prov_client->connection.response, type)) == NULL)
                         {
                             LogError("Failure deserializing query response");
                             result = __FAILURE__;
@@ -826,7 +1371,7 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
                     {
                         LogError("Rest call failed");
                     }
-                    clear_response(prov_client);
+                    clear_response(&prov_client->connection);
                 }
                 HTTPHeaders_Free(request_headers);
             }
@@ -838,18 +1383,313 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
     return result;
 }
 
+static int start_query_page_request(PROV_SC_QUERY_ITERATOR* iterator)
+{
+    int result;
+    PROV_SERVICE_CLIENT* prov_client = iterator->prov_client;
+
+    //the headers are made for every page so that the SAS token does not expire during a long query
+    HTTPHeaders_Free(iterator->request.request_headers);
+    if ((iterator->request.request_headers = construct_http_headers(prov_client, NULL, HTTP_CLIENT_REQUEST_POST)) == NULL)
+    {
+        LogError("Failure constructing http headers");
+        result = __FAILURE__;
+    }
+    else if (add_query_headers(iterator->request.request_headers, iterator->page_size, iterator->cont_token) != 0)
+    {
+        LogError("Failure adding query headers");
+        result = __FAILURE__;
+    }
+    else
+    {
+        iterator->reused_connection = (iterator->connection.http_client != NULL);
+        iterator->connection.request_sent = false;
+        iterator->connection.response_received = false;
+        iterator->connection.status_code = 0;
+
+        if (!iterator->reused_connection && ((iterator->connection.http_client = connect_to_service(prov_client, &iterator->connection)) == NULL))
+        {
+            LogError("Failed connecting to service");
+            result = __FAILURE__;
+        }
+        else
+        {
+            iterator->page_requested = true;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int wait_for_query_page(PROV_SC_QUERY_ITERATOR* iterator)
+{
+    int result;
+    bool retry;
+
+    do
+    {
+        bool timed_out;
+        retry = false;
+
+        if ((result = execute_request(iterator->prov_client, &iterator->connection, &iterator->request, iterator->request_start, &timed_out)) != 0)
+        {
+            //same as rest_call, a kept-alive connection the service closed is given one more try on a new connection
+            retry = iterator->reused_connection && !iterator->connection.response_received && !timed_out;
+            clear_response(&iterator->connection);
+            disconnect_from_service(&iterator->connection);
+            if (retry)
+            {
+                iterator->reused_connection = false;
+                if ((iterator->connection.http_client = connect_to_service(iterator->prov_client, &iterator->connection)) == NULL)
+                {
+                    LogError("Failed connecting to service");
+                    retry = false;
+                }
+            }
+        }
+    } while (retry);
+
+    return result;
+}
+
+//makes the page that was requested the current one, and requests the one after it
+static int take_query_page(PROV_SC_QUERY_ITERATOR* iterator)
+{
+    int result;
+    const char* resp_type = NULL;
+
+    iterator->page_requested = false;
+
+    //the timeout only runs while the caller waits, a page requested ahead may sit unread for as long as the caller reads the one before it
+    if (tickcounter_get_current_ms(iterator->prov_client->tick_counter, &iterator->request_start) != 0)
+    {
+        //the page in flight is abandoned and requested again the next time it is needed
+        LogError("Failure reading the tick counter");
+        clear_response(&iterator->connection);
+        disconnect_from_service(&iterator->connection);
+        result = __FAILURE__;
+    }
+    else if (wait_for_query_page(iterator) != 0)
+    {
+        LogError("Failure requesting query page");
+        result = __FAILURE__;
+    }
+    else
+    {
+        char* new_cont_token = NULL;
+
+        if (get_response_headers(&iterator->connection, &new_cont_token, &resp_type) != 0)
+        {
+            LogError("Failure reading response headers");
+            result = __FAILURE__;
+        }
+        else if (queryType_stringToEnum(resp_type) != iterator->type)
+        {
+            LogError("Unexpected query response type");
+            result = __FAILURE__;
+        }
+        else if (iterator->connection.response == NULL)
+        {
+            LogError("Query response has no body");
+            result = __FAILURE__;
+        }
+        else
+        {
+            //the body is handed over instead of being copied
+            iterator->page = iterator->connection.response;
+            iterator->connection.response = NULL;
+            iterator->page_length = strlen(iterator->page);
+            iterator->page_position = 0;
+
+            //the token of a page is only replaced once the page is taken, so that a page that failed is requested again
+            free(iterator->cont_token);
+            iterator->cont_token = new_cont_token;
+            new_cont_token = NULL;
+            iterator->last_page = (iterator->cont_token == NULL);
+            result = 0;
+        }
+        free(new_cont_token);
+        clear_response(&iterator->connection);
+        iterator->connection.http_state = HTTP_STATE_CONNECTED;
+
+        if ((result == 0) && !iterator->last_page && (start_query_page_request(iterator) != 0))
+        {
+            //not fatal, the page is requested again once it is needed
+            LogError("Failure requesting the next query page ahead");
+        }
+    }
+
+    return result;
+}
+
+static PROV_SC_QUERY_ITERATOR* create_query_iterator(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, PROVISIONING_QUERY_TYPE type, const char* path_format)
+{
+    PROV_SC_QUERY_ITERATOR* result;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid Provisioning Client Handle");
+        result = NULL;
+    }
+    else if (query_spec == NULL || query_spec->version != PROVISIONING_QUERY_SPECIFICATION_VERSION_1)
+    {
+        LogError("Invalid Query details");
+        result = NULL;
+    }
+    else if ((result = malloc(sizeof(PROV_SC_QUERY_ITERATOR))) == NULL)
+    {
+        LogError("Allocation of query iterator failed");
+    }
+    else
+    {
+        memset(result, 0, sizeof(PROV_SC_QUERY_ITERATOR));
+        result->prov_client = prov_client;
+        result->type = type;
+        result->page_size = query_spec->page_size;
+
+        //do not serialize the query specification if there is no query_string (i.e. DRS query)
+        if ((query_spec->query_string != NULL) && ((result->content = querySpecification_serializeToJson(query_spec)) == NULL))
+        {
+            LogError("Failure serializing query specification");
+            prov_sc_query_iterator_destroy(result);
+            result = NULL;
+        }
+        else if ((result->registration_path = create_registration_path(path_format, query_spec->registration_id)) == NULL)
+        {
+            LogError("Failed to construct a registration path");
+            prov_sc_query_iterator_destroy(result);
+            result = NULL;
+        }
+        else
+        {
+            result->request.operation = HTTP_CLIENT_REQUEST_POST;
+            result->request.registration_path = STRING_c_str(result->registration_path);
+            result->request.content = result->content;
+            result->request.content_len = (result->content == NULL) ? 0 : strlen(result->content);
+
+            //the first page is requested right away
+            if (start_query_page_request(result) != 0)
+            {
+                LogError("Failure requesting the first query page");
+                prov_sc_query_iterator_destroy(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+static int query_iterator_next(PROV_SC_QUERY_ITERATOR* iterator, PROVISIONING_QUERY_TYPE type, void** handle_ptr)
+{
+    int result;
+
+    if (iterator == NULL)
+    {
+        LogError("Invalid query iterator");
+        result = __FAILURE__;
+    }
+    else if (handle_ptr == NULL)
+    {
+        LogError("Invalid handle pointer");
+        result = __FAILURE__;
+    }
+    else if (iterator->type != type)
+    {
+        LogError("Query iterator does not return this type of record");
+        result = __FAILURE__;
+    }
+    else
+    {
+        bool end_of_results = false;
+        char* record_json = NULL;
+
+        result = 0;
+        *handle_ptr = NULL;
+
+        //lets the request for the next page move forward while the records of this one are read
+        if (iterator->page_requested && (iterator->connection.http_state != HTTP_STATE_COMPLETE) && (iterator->connection.http_state != HTTP_STATE_ERROR))
+        {
+            (void)connection_do_work(&iterator->connection, &iterator->request);
+        }
+
+        while ((result == 0) && (record_json == NULL) && !end_of_results)
+        {
+            if ((iterator->page != NULL) && (queryResponse_nextRecord(iterator->page, iterator->page_length, &iterator->page_position, &record_json) != 0))
+            {
+                LogError("Failure reading query response");
+                result = __FAILURE__;
+            }
+            else if (record_json != NULL)
+            {
+                if (type == QUERY_TYPE_INDIVIDUAL_ENROLLMENT)
+                {
+                    *handle_ptr = individualEnrollment_deserializeFromJson(record_json);
+                }
+                else if (type == QUERY_TYPE_ENROLLMENT_GROUP)
+                {
+                    *handle_ptr = enrollmentGroup_deserializeFromJson(record_json);
+                }
+                else
+                {
+                    *handle_ptr = deviceRegistrationState_deserializeFromJson(record_json);
+                }
+
+                if (*handle_ptr == NULL)
+                {
+                    LogError("Failure deserializing query record");
+                    result = __FAILURE__;
+                }
+            }
+            else
+            {
+                //this page is done, only one page is held at a time
+                free(iterator->page);
+                iterator->page = NULL;
+
+                if (!iterator->page_requested && !iterator->last_page)
+                {
+                    //a request that failed or could not be started before is tried again
+                    result = start_query_page_request(iterator);
+                }
+
+                if (result == 0)
+                {
+                    if (iterator->page_requested)
+                    {
+                        result = take_query_page(iterator);
+                    }
+                    else
+                    {
+                        end_of_results = true;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 //Exposed functions below
 
 void prov_sc_destroy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
 {
     if (prov_client != NULL)
     {
+        disconnect_all_from_service(prov_client);
         free(prov_client->provisioning_service_uri);
         free(prov_client->key_name);
         free(prov_client->access_key);
-        free(prov_client->response);
-        HTTPHeaders_Free(prov_client->response_headers);
+        free(prov_client->connection.response);
+        HTTPHeaders_Free(prov_client->connection.response_headers);
         free(prov_client->certificate);
+        free(prov_client->bulk_connections);
+        if (prov_client->tick_counter != NULL)
+        {
+            tickcounter_destroy(prov_client->tick_counter);
+        }
         free(prov_client);
     }
 }
@@ -931,9 +1771,17 @@ PROVISIONING_SERVICE_CLIENT_HANDLE prov_sc_create_from_connection_string(const c
                         prov_sc_destroy(result);
                         result = NULL;
                     }
+                    else if ((result->tick_counter = tickcounter_create()) == NULL)
+                    {
+                        LogError("Failure creating tick counter");
+                        prov_sc_destroy(result);
+                        result = NULL;
+                    }
                     else
                     {
                         result->tracing = TRACING_STATUS_OFF;
+                        result->request_timeout_ms = DEFAULT_REQUEST_TIMEOUT_MS;
+                        result->bulk_requests_in_flight = DEFAULT_BULK_REQUESTS_IN_FLIGHT;
                     }
                 }
                 Map_Destroy(connection_string_values_map);
@@ -949,6 +1797,8 @@ void prov_sc_set_trace(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, TRACING_S
     if (prov_client != NULL)
     {
         prov_client->tracing = status;
+        //connection options are applied when connecting, the next request opens a new connection
+        disconnect_all_from_service(prov_client);
     }
 }
 
@@ -965,12 +1815,17 @@ int prov_sc_set_certificate(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, cons
     {
         free(prov_client->certificate);
         prov_client->certificate = NULL;
+        disconnect_all_from_service(prov_client);
     }
     else if (mallocAndStrcpy_overwrite(&prov_client->certificate, (char*)certificate) != 0)
     {
         LogError("Failed allocating memory for certificate");
         result = __FAILURE__;
     }
+    else
+    {
+        disconnect_all_from_service(prov_client);
+    }
 
     return result;
 }
@@ -1005,12 +1860,54 @@ int prov_sc_set_proxy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_PROXY
         else
         {
             prov_client->proxy_options = proxy_options;
+            disconnect_all_from_service(prov_client);
         }
     }
 
     return result;
 }
 
+int prov_sc_set_request_timeout(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, size_t timeout_ms)
+{
+    int result;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+        result = __FAILURE__;
+    }
+    else
+    {
+        prov_client->request_timeout_ms = timeout_ms;
+        result = 0;
+    }
+
+    return result;
+}
+
+int prov_sc_set_bulk_operation_requests_in_flight(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, size_t max_requests)
+{
+    int result;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+        result = __FAILURE__;
+    }
+    else if (max_requests == 0)
+    {
+        LogError("At least one request must be allowed in flight");
+        result = __FAILURE__;
+    }
+    else
+    {
+        prov_client->bulk_requests_in_flight = max_requests;
+        result = 0;
+    }
+
+    return result;
+}
+
 int prov_sc_create_or_update_individual_enrollment(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, INDIVIDUAL_ENROLLMENT_HANDLE* enrollment_ptr)
 {
     return prov_sc_create_or_update_record(prov_client,(void**)enrollment_ptr, getVector_individualEnrollment(), INDV_ENROLL_PROVISION_PATH_FMT);
@@ -1041,6 +1938,11 @@ int prov_sc_run_individual_enrollment_bulk_operation(PROVISIONING_SERVICE_CLIENT
     return prov_sc_run_bulk_operation(prov_client, bulk_op, bulk_res_ptr, INDV_ENROLL_BULK_PATH_FMT);
 }
 
+int prov_sc_run_individual_enrollment_bulk_operation_chunked(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_BULK_OPERATION* bulk_op, PROVISIONING_BULK_OPERATION_RESULT** bulk_res_ptr)
+{
+    return prov_sc_run_chunked_bulk_operation(prov_client, bulk_op, bulk_res_ptr, INDV_ENROLL_BULK_PATH_FMT);
+}
+
 int prov_sc_delete_device_registration_state(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, DEVICE_REGISTRATION_STATE_HANDLE reg_state)
 {
     return prov_sc_delete_record_by_param(prov_client, deviceRegistrationState_getRegistrationId(reg_state), deviceRegistrationState_getEtag(reg_state), REG_STATE_PROVISION_PATH_FMT);
@@ -1084,4 +1986,49 @@ int prov_sc_get_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
 int prov_sc_query_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, char** cont_token_ptr, PROVISIONING_QUERY_RESPONSE** query_resp_ptr)
 {
     return prov_sc_query_records(prov_client, query_spec, cont_token_ptr, query_resp_ptr, ENROLL_GROUP_QUERY_PATH_FMT);
-}
\ No newline at end of file
+}
+
+PROV_SC_QUERY_ITERATOR_HANDLE prov_sc_create_individual_enrollment_query_iterator(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec)
+{
+    return create_query_iterator(prov_client, query_spec, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, INDV_ENROLL_QUERY_PATH_FMT);
+}
+
+PROV_SC_QUERY_ITERATOR_HANDLE prov_sc_create_enrollment_group_query_iterator(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec)
+{
+    return create_query_iterator(prov_client, query_spec, QUERY_TYPE_ENROLLMENT_GROUP, ENROLL_GROUP_QUERY_PATH_FMT);
+}
+
+PROV_SC_QUERY_ITERATOR_HANDLE prov_sc_create_device_registration_state_query_iterator(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec)
+{
+    return create_query_iterator(prov_client, query_spec, QUERY_TYPE_DEVICE_REGISTRATION_STATE, REG_STATE_QUERY_PATH_FMT);
+}
+
+int prov_sc_query_iterator_next_individual_enrollment(PROV_SC_QUERY_ITERATOR_HANDLE iterator, INDIVIDUAL_ENROLLMENT_HANDLE* enrollment_ptr)
+{
+    return query_iterator_next(iterator, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, (void**)enrollment_ptr);
+}
+
+int prov_sc_query_iterator_next_enrollment_group(PROV_SC_QUERY_ITERATOR_HANDLE iterator, ENROLLMENT_GROUP_HANDLE* enrollment_ptr)
+{
+    return query_iterator_next(iterator, QUERY_TYPE_ENROLLMENT_GROUP, (void**)enrollment_ptr);
+}
+
+int prov_sc_query_iterator_next_device_registration_state(PROV_SC_QUERY_ITERATOR_HANDLE iterator, DEVICE_REGISTRATION_STATE_HANDLE* reg_state_ptr)
+{
+    return query_iterator_next(iterator, QUERY_TYPE_DEVICE_REGISTRATION_STATE, (void**)reg_state_ptr);
+}
+
+void prov_sc_query_iterator_destroy(PROV_SC_QUERY_ITERATOR_HANDLE iterator)
+{
+    if (iterator != NULL)
+    {
+        clear_response(&iterator->connection);
+        disconnect_from_service(&iterator->connection);
+        HTTPHeaders_Free(iterator->request.request_headers);
+        STRING_delete(iterator->registration_path);
+        free(iterator->content);
+        free(iterator->cont_token);
+        free(iterator->page);
+        free(iterator);
+    }
+}
@@ -14,6 +14,11 @@ void* real_malloc(size_t size)
     return malloc(size);
 }
 
+void* real_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
 void real_free(void* ptr)
 {
     free(ptr);
@@ -54,6 +59,8 @@ MOCKABLE_FUNCTION(, size_t, json_array_get_count, const JSON_Array*, array);
 MOCKABLE_FUNCTION(, JSON_Object*, json_array_get_object, const JSON_Array*, array, size_t, index);
 MOCKABLE_FUNCTION(, JSON_Array*, json_object_get_array, const JSON_Object*, object, const char*, name);
 MOCKABLE_FUNCTION(, int, json_object_get_boolean, const JSON_Object*, object, const char*, name);
+MOCKABLE_FUNCTION(, size_t, json_serialization_size, const JSON_Value*, value);
+MOCKABLE_FUNCTION(, JSON_Status, json_serialize_to_buffer, const JSON_Value*, value, char*, buf, size_t, buf_size_in_bytes);
 
 #undef ENABLE_MOCKS
 
@@ -128,6 +135,22 @@ static int my_deserialize_and_get_struct_array(void*** dest_arr, size_t* dest_le
     return 0;
 }
 
+static size_t my_json_serialization_size(const JSON_Value* value)
+{
+    AZURE_UNREFERENCED_PARAMETER(value);
+
+    return strlen(DUMMY_JSON) + 1;
+}
+
+static JSON_Status my_json_serialize_to_buffer(const JSON_Value* value, char* buf, size_t buf_size_in_bytes)
+{
+    AZURE_UNREFERENCED_PARAMETER(value);
+
+    ASSERT_ARE_EQUAL(size_t, strlen(DUMMY_JSON) + 1, buf_size_in_bytes);
+    strcpy(buf, DUMMY_JSON);
+    return JSONSuccess;
+}
+
 static INDIVIDUAL_ENROLLMENT_HANDLE* create_dummy_enrollment_list(size_t len)
 {
     INDIVIDUAL_ENROLLMENT_HANDLE* ret;
@@ -143,6 +166,8 @@ static void free_dummy_enrollment_list(INDIVIDUAL_ENROLLMENT_HANDLE* enrollments
 static void register_global_mocks()
 {
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, real_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, real_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, real_free);
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __FAILURE__);
@@ -172,6 +197,14 @@ static void register_global_mocks()
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_boolean, -1);
     REGISTER_GLOBAL_MOCK_RETURN(json_object_get_number, DUMMY_NUM);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_number, 0);
+    REGISTER_GLOBAL_MOCK_HOOK(json_serialization_size, my_json_serialization_size);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_serialization_size, 0);
+    REGISTER_GLOBAL_MOCK_HOOK(json_serialize_to_buffer, my_json_serialize_to_buffer);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_serialize_to_buffer, JSONFailure);
+
+    //enrollment
+    REGISTER_GLOBAL_MOCK_RETURN(individualEnrollment_toJson, TEST_JSON_VALUE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(individualEnrollment_toJson, NULL);
 
     //shared helpers
     REGISTER_GLOBAL_MOCK_RETURN(json_serialize_and_set_struct_array, 0);
@@ -689,4 +722,443 @@ TEST_FUNCTION(bulkOperationResult_free_no_errors)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+static void expected_calls_serialize_range(size_t count, bool grow_buffer)
+{
+    if (grow_buffer)
+    {
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        STRICT_EXPECTED_CALL(individualEnrollment_toJson(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_serialization_size(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_serialize_to_buffer(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    }
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_null_handle)
+{
+    //arrange
+    char* buffer = NULL;
+    size_t capacity = 0;
+
+    //act
+    int res = bulkOperation_serializeRangeToBuffer(NULL, 0, 1, &buffer, &capacity);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(buffer);
+
+    //cleanup
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_null_buffer)
+{
+    //arrange
+    size_t capacity = 0;
+    PROVISIONING_BULK_OPERATION bulk_op;
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.enrollments.ie = create_dummy_enrollment_list(2);
+    bulk_op.num_enrollments = 2;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+
+    //act
+    int res = bulkOperation_serializeRangeToBuffer(&bulk_op, 0, 1, NULL, &capacity);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+
+    //cleanup
+    free_dummy_enrollment_list(bulk_op.enrollments.ie);
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_invalid_range)
+{
+    //arrange
+    char* buffer = NULL;
+    size_t capacity = 0;
+    PROVISIONING_BULK_OPERATION bulk_op;
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.enrollments.ie = create_dummy_enrollment_list(2);
+    bulk_op.num_enrollments = 2;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+
+    //act
+    int res_empty = bulkOperation_serializeRangeToBuffer(&bulk_op, 0, 0, &buffer, &capacity);
+    int res_past_end = bulkOperation_serializeRangeToBuffer(&bulk_op, 1, 2, &buffer, &capacity);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_empty);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_past_end);
+    ASSERT_IS_NULL(buffer);
+
+    //cleanup
+    free_dummy_enrollment_list(bulk_op.enrollments.ie);
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_invalid_version)
+{
+    //arrange
+    char* buffer = NULL;
+    size_t capacity = 0;
+    PROVISIONING_BULK_OPERATION bulk_op;
+    bulk_op.version = -1;
+    bulk_op.enrollments.ie = create_dummy_enrollment_list(2);
+    bulk_op.num_enrollments = 2;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+
+    //act
+    int res = bulkOperation_serializeRangeToBuffer(&bulk_op, 0, 2, &buffer, &capacity);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(buffer);
+
+    //cleanup
+    free_dummy_enrollment_list(bulk_op.enrollments.ie);
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_success)
+{
+    //arrange
+    char* buffer = NULL;
+    size_t capacity = 0;
+    char expected_json[256];
+    PROVISIONING_BULK_OPERATION bulk_op;
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.enrollments.ie = create_dummy_enrollment_list(3);
+    bulk_op.num_enrollments = 3;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    (void)sprintf(expected_json, "{\"mode\":\"create\",\"enrollments\":[%s,%s]}", DUMMY_JSON, DUMMY_JSON);
+
+    umock_c_reset_all_calls();
+    expected_calls_serialize_range(2, true);
+
+    //act
+    int res = bulkOperation_serializeRangeToBuffer(&bulk_op, 1, 2, &buffer, &capacity);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(buffer);
+    ASSERT_IS_TRUE(capacity > strlen(expected_json));
+    ASSERT_ARE_EQUAL(char_ptr, expected_json, buffer);
+
+    //cleanup
+    free_dummy_enrollment_list(bulk_op.enrollments.ie);
+    free(buffer);
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_reuses_buffer)
+{
+    //arrange
+    char* buffer = NULL;
+    size_t capacity = 0;
+    char expected_json[256];
+    PROVISIONING_BULK_OPERATION bulk_op;
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.enrollments.ie = create_dummy_enrollment_list(3);
+    bulk_op.num_enrollments = 3;
+    bulk_op.mode = BULK_OP_DELETE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    (void)sprintf(expected_json, "{\"mode\":\"delete\",\"enrollments\":[%s]}", DUMMY_JSON);
+    (void)bulkOperation_serializeRangeToBuffer(&bulk_op, 0, 2, &buffer, &capacity);
+    char* first_buffer = buffer;
+    size_t first_capacity = capacity;
+
+    umock_c_reset_all_calls();
+    expected_calls_serialize_range(1, false);
+
+    //act
+    int res = bulkOperation_serializeRangeToBuffer(&bulk_op, 2, 1, &buffer, &capacity);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(void_ptr, first_buffer, buffer);
+    ASSERT_ARE_EQUAL(size_t, first_capacity, capacity);
+    ASSERT_ARE_EQUAL(char_ptr, expected_json, buffer);
+
+    //cleanup
+    free_dummy_enrollment_list(bulk_op.enrollments.ie);
+    free(buffer);
+}
+
+TEST_FUNCTION(bulkOperation_serializeRangeToBuffer_error)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_BULK_OPERATION bulk_op;
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.enrollments.ie = create_dummy_enrollment_list(2);
+    bulk_op.num_enrollments = 2;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+
+    umock_c_reset_all_calls();
+    expected_calls_serialize_range(2, true);
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 4, 8 };
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+    size_t count = umock_c_negative_tests_call_count();
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, num_cannot_fail) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "bulkOperation_serializeRangeToBuffer_error failure in test %zu/%zu", test_num, test_max);
+
+        char* buffer = NULL;
+        size_t capacity = 0;
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = bulkOperation_serializeRangeToBuffer(&bulk_op, 0, 2, &buffer, &capacity);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, res, tmp_msg);
+
+        //cleanup
+        free(buffer);
+    }
+
+    //cleanup
+    free_dummy_enrollment_list(bulk_op.enrollments.ie);
+}
+
+TEST_FUNCTION(bulkOperationResult_create_success)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    //act
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_IS_NULL(bulk_res->errors);
+    ASSERT_ARE_EQUAL(size_t, 0, bulk_res->num_errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_create_error)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+
+    //act
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(bulk_res);
+
+    //cleanup
+}
+
+TEST_FUNCTION(bulkOperationResult_addError_null)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    umock_c_reset_all_calls();
+
+    //act
+    int res_null_result = bulkOperationResult_addError(NULL, DUMMY_STRING, 500, DUMMY_STRING);
+    int res_null_id = bulkOperationResult_addError(bulk_res, NULL, 500, DUMMY_STRING);
+    int res_null_status = bulkOperationResult_addError(bulk_res, DUMMY_STRING, 500, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_id);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_status);
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_addError_success)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, DUMMY_STRING));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "failed"));
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    //act
+    int res = bulkOperationResult_addError(bulk_res, DUMMY_STRING, 500, "failed");
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 1, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(char_ptr, DUMMY_STRING, bulk_res->errors[0]->registration_id);
+    ASSERT_ARE_EQUAL(char_ptr, "failed", bulk_res->errors[0]->error_status);
+    ASSERT_ARE_EQUAL(int, 500, bulk_res->errors[0]->error_code);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_addError_error)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, DUMMY_STRING));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "failed"));
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    umock_c_negative_tests_snapshot();
+
+    size_t count = umock_c_negative_tests_call_count();
+
+    for (size_t index = 0; index < count; index++)
+    {
+        char tmp_msg[128];
+        sprintf(tmp_msg, "bulkOperationResult_addError_error failure in test %zu/%zu", index + 1, count);
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = bulkOperationResult_addError(bulk_res, DUMMY_STRING, 500, "failed");
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, res, tmp_msg);
+        ASSERT_ARE_EQUAL_WITH_MSG(size_t, 0, bulk_res->num_errors, tmp_msg);
+        ASSERT_IS_TRUE_WITH_MSG(bulk_res->is_successful, tmp_msg);
+    }
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_append_null)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    umock_c_reset_all_calls();
+
+    //act
+    int res_null_result = bulkOperationResult_append(NULL, bulk_res);
+    int res_null_other = bulkOperationResult_append(bulk_res, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_other);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_append_success)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    PROVISIONING_BULK_OPERATION_RESULT* other_res = bulkOperationResult_create();
+    (void)bulkOperationResult_addError(bulk_res, "reg1", 400, "failed");
+    (void)bulkOperationResult_addError(other_res, "reg2", 409, "conflict");
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(other_res));
+
+    //act
+    int res = bulkOperationResult_append(bulk_res, other_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 2, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(char_ptr, "reg1", bulk_res->errors[0]->registration_id);
+    ASSERT_ARE_EQUAL(char_ptr, "reg2", bulk_res->errors[1]->registration_id);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_append_no_errors)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    PROVISIONING_BULK_OPERATION_RESULT* other_res = bulkOperationResult_create();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(other_res));
+
+    //act
+    int res = bulkOperationResult_append(bulk_res, other_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 0, bulk_res->num_errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_append_error)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = bulkOperationResult_create();
+    PROVISIONING_BULK_OPERATION_RESULT* other_res = bulkOperationResult_create();
+    (void)bulkOperationResult_addError(other_res, "reg2", 409, "conflict");
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(NULL);
+
+    //act
+    int res = bulkOperationResult_append(bulk_res, other_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 0, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(size_t, 1, other_res->num_errors);
+
+    //cleanup
+    bulkOperationResult_free(other_res);
+    bulkOperationResult_free(bulk_res);
+}
+
 END_TEST_SUITE(prov_sc_bulk_operation_ut);
@@ -822,6 +822,186 @@ TEST_FUNCTION(queryType_stringToEnum_invalid_string)
     //cleanup
 }
 
+/*Tests_PROV_QUERY_22_002: [ If json_string, position or record_json is NULL, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_null_json_string)
+{
+    //arrange
+    size_t position = 0;
+    char* record;
+
+    //act
+    int res = queryResponse_nextRecord(NULL, 0, &position, &record);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_002: [ If json_string, position or record_json is NULL, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_null_position)
+{
+    //arrange
+    char page[] = "[{\"a\":1}]";
+    char* record;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page), NULL, &record);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_002: [ If json_string, position or record_json is NULL, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_null_record_json)
+{
+    //arrange
+    char page[] = "[{\"a\":1}]";
+    size_t position = 0;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page), &position, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_006: [ When there are no more records, queryResponse_nextRecord shall set record_json to NULL and return 0 ]*/
+TEST_FUNCTION(queryResponse_nextRecord_empty_array)
+{
+    //arrange
+    char page[] = " [ ] ";
+    size_t position = 0;
+    char* record = page;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page), &position, &record);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(record);
+    ASSERT_ARE_EQUAL(size_t, strlen(page), position);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_003: [ queryResponse_nextRecord shall read json_string from position without reading past length bytes and without allocating memory ]*/
+/*Tests_PROV_QUERY_22_005: [ queryResponse_nextRecord shall NUL-terminate the next record in place, set record_json to it and advance position past it ]*/
+/*Tests_PROV_QUERY_22_006: [ When there are no more records, queryResponse_nextRecord shall set record_json to NULL and return 0 ]*/
+TEST_FUNCTION(queryResponse_nextRecord_golden)
+{
+    //arrange
+    char page[] = "[{\"id\":\"a}\\\"{\"},\n {\"id\":\"b\",\"tags\":{\"x\":[1,{\"y\":2}]}} ,{}]";
+    size_t length = strlen(page);
+    size_t position = 0;
+    char* record1;
+    char* record2;
+    char* record3;
+    char* record4;
+
+    //act
+    int res1 = queryResponse_nextRecord(page, length, &position, &record1);
+    int res2 = queryResponse_nextRecord(page, length, &position, &record2);
+    int res3 = queryResponse_nextRecord(page, length, &position, &record3);
+    int res4 = queryResponse_nextRecord(page, length, &position, &record4);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res1);
+    ASSERT_ARE_EQUAL(int, 0, res2);
+    ASSERT_ARE_EQUAL(int, 0, res3);
+    ASSERT_ARE_EQUAL(int, 0, res4);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"id\":\"a}\\\"{\"}", record1);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"id\":\"b\",\"tags\":{\"x\":[1,{\"y\":2}]}}", record2);
+    ASSERT_ARE_EQUAL(char_ptr, "{}", record3);
+    ASSERT_IS_NULL(record4);
+    ASSERT_ARE_EQUAL(size_t, length, position);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_004: [ If json_string is not a JSON array of objects, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_not_array)
+{
+    //arrange
+    char page[] = "{\"id\":\"a\"}";
+    size_t position = 0;
+    char* record;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page), &position, &record);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(size_t, 0, position);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_003: [ queryResponse_nextRecord shall read json_string from position without reading past length bytes and without allocating memory ]*/
+/*Tests_PROV_QUERY_22_004: [ If json_string is not a JSON array of objects, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_truncated_record)
+{
+    //arrange
+    char page[] = "[{\"id\":\"a\"}]";
+    size_t position = 0;
+    char* record;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page) - 2, &position, &record);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_004: [ If json_string is not a JSON array of objects, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_bad_separator)
+{
+    //arrange
+    char page[] = "[{\"id\":\"a\"} {\"id\":\"b\"}]";
+    size_t position = 0;
+    char* record;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page), &position, &record);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROV_QUERY_22_004: [ If json_string is not a JSON array of objects, queryResponse_nextRecord shall fail and return a non-zero value ]*/
+TEST_FUNCTION(queryResponse_nextRecord_not_object)
+{
+    //arrange
+    char page[] = "[\"a\",\"b\"]";
+    size_t position = 0;
+    char* record;
+
+    //act
+    int res = queryResponse_nextRecord(page, strlen(page), &position, &record);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
 /*Tests_PROV_QUERY_22_001: [ queryResponse_free shall free all memory in the structure pointed to by query_resp ]*/
 TEST_FUNCTION(queryResponse_free_null)
 {
@@ -0,0 +1,472 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*runs the provisioning service client against an in-process uhttp client standing in for the service, so that the
+kept-alive connection, the reconnect after the service closed it, the request timeout and the requests in flight of a
+chunked bulk operation are exercised with the real tick counter and sleeps instead of mocks*/
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_uhttp_c/uhttp.h"
+
+#include "prov_service_client/provisioning_service_client.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+static TICK_COUNTER_HANDLE g_tick_counter;
+
+static const char* TEST_CONNECTION_STRING = "HostName=int.azure-devices-provisioning.net;SharedAccessKeyName=provisioningserviceowner;SharedAccessKey=dGVzdGtleWZvcmludGVncmF0aW9u";
+static const char* TEST_REGISTRATION_ID = "device-1";
+static const char* ENROLLMENT_JSON = "{\"registrationId\":\"device-1\",\"deviceId\":\"device-1\",\"attestation\":{\"type\":\"tpm\",\"tpm\":{\"endorsementKey\":\"AToAAQALAAMAsgAgg3GXZ0SEs\"}},"
+    "\"iotHubHostName\":\"int.azure-devices.net\",\"etag\":\"etag-1\",\"provisioningStatus\":\"enabled\","
+    "\"createdDateTimeUtc\":\"2018-01-01T00:00:00.000Z\",\"lastUpdatedDateTimeUtc\":\"2018-01-01T00:00:00.000Z\"}";
+static const char* BULK_OPERATION_RESULT_JSON = "{\"isSuccessful\":true,\"errors\":[]}";
+static const char* TEST_ENDORSEMENT_KEY = "AToAAQALAAMAsgAgg3GXZ0SEs";
+static const size_t TEST_REQUEST_TIMEOUT_MS = 100;
+static const size_t TEST_BULK_REQUEST_TIMEOUT_MS = 50;
+static const size_t TEST_BULK_REPLY_COST_MS = 5;
+#define TEST_BULK_ENROLLMENTS   400
+#define TEST_BULK_CHUNK_SIZE    10
+
+//what the service does, reset before every test
+static struct
+{
+    size_t connections_opened;
+    size_t requests_received;
+    //the next connection found idle is closed by the service, as it does with connections kept open for too long
+    bool close_idle_connection;
+    //this request, counted from 1, is never answered; 0 for none
+    size_t stalled_request;
+    //the connection of this request, counted from 1, fails after the service received it; 0 for none
+    size_t dropped_request;
+    //time the service spends on every reply
+    tickcounter_ms_t reply_cost_ms;
+    tickcounter_ms_t last_request_ms;
+    bool stalled_request_closed;
+    tickcounter_ms_t stalled_request_closed_ms;
+} g_service;
+
+//the in-process uhttp client
+typedef struct HTTP_CLIENT_HANDLE_DATA_TAG
+{
+    ON_HTTP_ERROR_CALLBACK on_error;
+    void* error_ctx;
+    ON_HTTP_OPEN_COMPLETE_CALLBACK on_open;
+    void* open_ctx;
+    bool open_pending;
+    ON_HTTP_REQUEST_CALLBACK on_reply;
+    void* reply_ctx;
+    HTTP_CLIENT_REQUEST_TYPE request_type;
+    bool request_pending;
+    bool stalled;
+    bool dropped;
+} HTTP_CLIENT_HANDLE_DATA;
+
+static tickcounter_ms_t now_ms(void)
+{
+    tickcounter_ms_t result;
+    ASSERT_ARE_EQUAL(int, 0, tickcounter_get_current_ms(g_tick_counter, &result));
+    return result;
+}
+
+HTTP_CLIENT_HANDLE uhttp_client_create(const IO_INTERFACE_DESCRIPTION* io_interface_desc, const void* xio_param, ON_HTTP_ERROR_CALLBACK on_http_error, void* callback_ctx)
+{
+    HTTP_CLIENT_HANDLE_DATA* result;
+    (void)io_interface_desc;
+    (void)xio_param;
+    if ((result = (HTTP_CLIENT_HANDLE_DATA*)calloc(1, sizeof(HTTP_CLIENT_HANDLE_DATA))) != NULL)
+    {
+        result->on_error = on_http_error;
+        result->error_ctx = callback_ctx;
+    }
+    return result;
+}
+
+void uhttp_client_destroy(HTTP_CLIENT_HANDLE handle)
+{
+    free(handle);
+}
+
+HTTP_CLIENT_RESULT uhttp_client_open(HTTP_CLIENT_HANDLE handle, const char* host, int port_num, ON_HTTP_OPEN_COMPLETE_CALLBACK on_connect, void* callback_ctx)
+{
+    (void)host;
+    (void)port_num;
+    handle->on_open = on_connect;
+    handle->open_ctx = callback_ctx;
+    handle->open_pending = true;
+    return HTTP_CLIENT_OK;
+}
+
+void uhttp_client_close(HTTP_CLIENT_HANDLE handle, ON_HTTP_CLOSED_CALLBACK on_close_callback, void* callback_ctx)
+{
+    if (handle->request_pending && handle->stalled)
+    {
+        g_service.stalled_request_closed = true;
+        g_service.stalled_request_closed_ms = now_ms();
+    }
+    handle->request_pending = false;
+    if (on_close_callback != NULL)
+    {
+        on_close_callback(callback_ctx);
+    }
+}
+
+HTTP_CLIENT_RESULT uhttp_client_set_trace(HTTP_CLIENT_HANDLE handle, bool trace_on, bool trace_data)
+{
+    (void)handle;
+    (void)trace_on;
+    (void)trace_data;
+    return HTTP_CLIENT_OK;
+}
+
+HTTP_CLIENT_RESULT uhttp_client_set_trusted_cert(HTTP_CLIENT_HANDLE handle, const char* certificate)
+{
+    (void)handle;
+    (void)certificate;
+    return HTTP_CLIENT_OK;
+}
+
+HTTP_CLIENT_RESULT uhttp_client_execute_request(HTTP_CLIENT_HANDLE handle, HTTP_CLIENT_REQUEST_TYPE request_type, const char* relative_path, HTTP_HEADERS_HANDLE http_header_handle, const unsigned char* content, size_t content_length, ON_HTTP_REQUEST_CALLBACK on_request_callback, void* callback_ctx)
+{
+    (void)relative_path;
+    (void)http_header_handle;
+    (void)content;
+    (void)content_length;
+    g_service.requests_received++;
+    g_service.last_request_ms = now_ms();
+    handle->on_reply = on_request_callback;
+    handle->reply_ctx = callback_ctx;
+    handle->request_type = request_type;
+    handle->request_pending = true;
+    handle->stalled = (g_service.requests_received == g_service.stalled_request);
+    handle->dropped = (g_service.requests_received == g_service.dropped_request);
+    return HTTP_CLIENT_OK;
+}
+
+void uhttp_client_dowork(HTTP_CLIENT_HANDLE handle)
+{
+    if (handle->open_pending)
+    {
+        handle->open_pending = false;
+        g_service.connections_opened++;
+        handle->on_open(handle->open_ctx, HTTP_CALLBACK_REASON_OK);
+    }
+    else if (!handle->request_pending && g_service.close_idle_connection)
+    {
+        g_service.close_idle_connection = false;
+        handle->on_error(handle->error_ctx, HTTP_CALLBACK_REASON_ERROR);
+    }
+    else if (handle->request_pending && handle->dropped)
+    {
+        handle->request_pending = false;
+        handle->on_error(handle->error_ctx, HTTP_CALLBACK_REASON_ERROR);
+    }
+    else if (handle->request_pending && !handle->stalled)
+    {
+        const char* body = (handle->request_type == HTTP_CLIENT_REQUEST_POST) ? BULK_OPERATION_RESULT_JSON : ENROLLMENT_JSON;
+        HTTP_HEADERS_HANDLE headers = HTTPHeaders_Alloc();
+        tickcounter_ms_t start = now_ms();
+
+        //the dowork call is busy for as long as the reply takes, like the first read of a large reply
+        while (now_ms() - start < g_service.reply_cost_ms)
+        {
+        }
+        handle->request_pending = false;
+        handle->on_reply(handle->reply_ctx, HTTP_CALLBACK_REASON_OK, (const unsigned char*)body, strlen(body), 200, headers);
+        HTTPHeaders_Free(headers);
+    }
+}
+
+BEGIN_TEST_SUITE(provisioning_service_client_int)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+    ASSERT_ARE_EQUAL(int, 0, platform_init());
+    g_tick_counter = tickcounter_create();
+    ASSERT_IS_NOT_NULL(g_tick_counter);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    tickcounter_destroy(g_tick_counter);
+    platform_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    memset(&g_service, 0, sizeof(g_service));
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+TEST_FUNCTION(prov_sc_keeps_the_connection_open_between_requests)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE first = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE second = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+
+    //act
+    int first_result = prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &first);
+    int second_result = prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &second);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, first_result);
+    ASSERT_ARE_EQUAL(int, 0, second_result);
+    ASSERT_IS_NOT_NULL(first);
+    ASSERT_IS_NOT_NULL(second);
+    ASSERT_ARE_EQUAL(size_t, 1, g_service.connections_opened);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.requests_received);
+
+    //cleanup
+    individualEnrollment_destroy(first);
+    individualEnrollment_destroy(second);
+    prov_sc_destroy(prov_client);
+}
+
+TEST_FUNCTION(prov_sc_reconnects_when_the_service_closed_the_idle_connection)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE first = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE second = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+    ASSERT_ARE_EQUAL(int, 0, prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &first));
+
+    g_service.close_idle_connection = true;
+
+    //act
+    int result = prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &second);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(second);
+    ASSERT_IS_FALSE(g_service.close_idle_connection);
+    //the closed connection never carried the request, it was sent once on the new one
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.connections_opened);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.requests_received);
+
+    //cleanup
+    individualEnrollment_destroy(first);
+    individualEnrollment_destroy(second);
+    prov_sc_destroy(prov_client);
+}
+
+TEST_FUNCTION(prov_sc_request_times_out_when_the_service_does_not_reply)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE first = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE second = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+    ASSERT_ARE_EQUAL(int, 0, prov_sc_set_request_timeout(prov_client, TEST_REQUEST_TIMEOUT_MS));
+
+    g_service.stalled_request = 1;
+
+    //act
+    tickcounter_ms_t start = now_ms();
+    int first_result = prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &first);
+    tickcounter_ms_t elapsed = now_ms() - start;
+    int second_result = prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &second);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, first_result);
+    ASSERT_IS_NULL(first);
+    ASSERT_IS_TRUE(elapsed >= TEST_REQUEST_TIMEOUT_MS);
+    //the request that timed out is not sent again, and its connection is not used again
+    ASSERT_ARE_EQUAL(int, 0, second_result);
+    ASSERT_IS_NOT_NULL(second);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.connections_opened);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.requests_received);
+
+    //cleanup
+    individualEnrollment_destroy(second);
+    prov_sc_destroy(prov_client);
+}
+
+TEST_FUNCTION(prov_sc_bulk_operation_times_out_a_stalled_request_while_the_others_progress)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollment = individualEnrollment_create(TEST_REGISTRATION_ID, attestationMechanism_createWithTpm(TEST_ENDORSEMENT_KEY, NULL));
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollments[TEST_BULK_ENROLLMENTS];
+    PROVISIONING_BULK_OPERATION bulk_op;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+    ASSERT_IS_NOT_NULL(enrollment);
+    for (size_t i = 0; i < TEST_BULK_ENROLLMENTS; i++)
+    {
+        enrollments[i] = enrollment;
+    }
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    bulk_op.enrollments.ie = enrollments;
+    bulk_op.num_enrollments = TEST_BULK_ENROLLMENTS;
+    ASSERT_ARE_EQUAL(int, 0, prov_sc_set_request_timeout(prov_client, TEST_BULK_REQUEST_TIMEOUT_MS));
+
+    //the other lanes keep the client busy for several times the timeout
+    g_service.stalled_request = 1;
+    g_service.reply_cost_ms = TEST_BULK_REPLY_COST_MS;
+
+    //act
+    int result = prov_sc_run_individual_enrollment_bulk_operation_chunked(prov_client, &bulk_op, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, TEST_BULK_CHUNK_SIZE, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(size_t, TEST_BULK_ENROLLMENTS / TEST_BULK_CHUNK_SIZE, g_service.requests_received);
+    //the stalled request was given up on while the other lanes were still sending chunks
+    ASSERT_IS_TRUE(g_service.stalled_request_closed);
+    ASSERT_IS_TRUE(g_service.stalled_request_closed_ms < g_service.last_request_ms);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    individualEnrollment_destroy(enrollment);
+    prov_sc_destroy(prov_client);
+}
+
+TEST_FUNCTION(prov_sc_bulk_operation_does_not_resend_a_request_the_service_may_have_received)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollment = individualEnrollment_create(TEST_REGISTRATION_ID, attestationMechanism_createWithTpm(TEST_ENDORSEMENT_KEY, NULL));
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollments[TEST_BULK_CHUNK_SIZE];
+    PROVISIONING_BULK_OPERATION bulk_op;
+    PROVISIONING_BULK_OPERATION_RESULT* first_res = NULL;
+    PROVISIONING_BULK_OPERATION_RESULT* second_res = NULL;
+    PROVISIONING_BULK_OPERATION_RESULT* third_res = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+    ASSERT_IS_NOT_NULL(enrollment);
+    for (size_t i = 0; i < TEST_BULK_CHUNK_SIZE; i++)
+    {
+        enrollments[i] = enrollment;
+    }
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    bulk_op.enrollments.ie = enrollments;
+    bulk_op.num_enrollments = TEST_BULK_CHUNK_SIZE;
+    ASSERT_ARE_EQUAL(int, 0, prov_sc_run_individual_enrollment_bulk_operation_chunked(prov_client, &bulk_op, &first_res));
+
+    //act
+    g_service.close_idle_connection = true;
+    int closed_result = prov_sc_run_individual_enrollment_bulk_operation_chunked(prov_client, &bulk_op, &second_res);
+    g_service.dropped_request = 3;
+    int dropped_result = prov_sc_run_individual_enrollment_bulk_operation_chunked(prov_client, &bulk_op, &third_res);
+
+    //assert
+    //a kept-alive connection closed before the chunk was sent on it is reconnected and the chunk sent once
+    ASSERT_ARE_EQUAL(int, 0, closed_result);
+    ASSERT_IS_NOT_NULL(second_res);
+    ASSERT_IS_TRUE(second_res->is_successful);
+    //a chunk whose connection failed after it was sent is reported, not sent again
+    ASSERT_ARE_EQUAL(int, 0, dropped_result);
+    ASSERT_IS_NOT_NULL(third_res);
+    ASSERT_IS_FALSE(third_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, TEST_BULK_CHUNK_SIZE, third_res->num_errors);
+    ASSERT_ARE_EQUAL(size_t, 3, g_service.requests_received);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.connections_opened);
+
+    //cleanup
+    bulkOperationResult_free(first_res);
+    bulkOperationResult_free(second_res);
+    bulkOperationResult_free(third_res);
+    individualEnrollment_destroy(enrollment);
+    prov_sc_destroy(prov_client);
+}
+
+TEST_FUNCTION(prov_sc_resends_a_get_the_service_dropped_after_receiving_it)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE first = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE second = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+    ASSERT_ARE_EQUAL(int, 0, prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &first));
+
+    g_service.dropped_request = 2;
+
+    //act
+    int result = prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &second);
+
+    //assert
+    //reading an enrollment twice is harmless, the request is sent once more on a new connection
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(second);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.connections_opened);
+    ASSERT_ARE_EQUAL(size_t, 3, g_service.requests_received);
+
+    //cleanup
+    individualEnrollment_destroy(first);
+    individualEnrollment_destroy(second);
+    prov_sc_destroy(prov_client);
+}
+
+TEST_FUNCTION(prov_sc_does_not_resend_a_bulk_operation_the_service_dropped_after_receiving_it)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE first = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollment = individualEnrollment_create(TEST_REGISTRATION_ID, attestationMechanism_createWithTpm(TEST_ENDORSEMENT_KEY, NULL));
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollments[1];
+    PROVISIONING_BULK_OPERATION bulk_op;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    ASSERT_IS_NOT_NULL(prov_client);
+    ASSERT_IS_NOT_NULL(enrollment);
+    enrollments[0] = enrollment;
+    bulk_op.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulk_op.mode = BULK_OP_CREATE;
+    bulk_op.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    bulk_op.enrollments.ie = enrollments;
+    bulk_op.num_enrollments = 1;
+    ASSERT_ARE_EQUAL(int, 0, prov_sc_get_individual_enrollment(prov_client, TEST_REGISTRATION_ID, &first));
+
+    //the bulk POST goes out on the kept-alive connection, which the service closes after receiving it
+    g_service.dropped_request = 2;
+
+    //act
+    int result = prov_sc_run_individual_enrollment_bulk_operation(prov_client, &bulk_op, &bulk_res);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_IS_NULL(bulk_res);
+    ASSERT_ARE_EQUAL(size_t, 1, g_service.connections_opened);
+    ASSERT_ARE_EQUAL(size_t, 2, g_service.requests_received);
+
+    //cleanup
+    individualEnrollment_destroy(first);
+    individualEnrollment_destroy(enrollment);
+    prov_sc_destroy(prov_client);
+}
+
+END_TEST_SUITE(provisioning_service_client_int)
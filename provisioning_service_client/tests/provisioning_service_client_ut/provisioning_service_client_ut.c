@@ -37,6 +37,8 @@ static void real_free(void* ptr)
 #include "azure_c_shared_utility/connection_string_parser.h"
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/http_proxy_io.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/tickcounter.h"
 
 #include "azure_uhttp_c/uhttp.h"
 
@@ -62,6 +64,16 @@ static ON_HTTP_OPEN_COMPLETE_CALLBACK g_on_http_open;
 static void* g_http_open_ctx;
 static ON_HTTP_REQUEST_CALLBACK g_on_http_reply_recv;
 static void* g_http_reply_recv_ctx;
+static ON_HTTP_ERROR_CALLBACK g_on_http_error;
+static void* g_http_error_ctx;
+static bool g_http_open_pending;
+static bool g_http_request_pending;
+static bool g_service_replies;
+static bool g_service_closes_connection;
+static bool g_service_drops_request;
+static size_t g_service_reply_delay;
+static size_t g_page_records;
+static tickcounter_ms_t g_current_ms;
 
 static response_switch g_response_content_status;
 
@@ -119,6 +131,7 @@ static ENROLLMENT_GROUP_HANDLE TEST_ENROLLMENT_GROUP_HANDLE = (ENROLLMENT_GROUP_
 static IO_INTERFACE_DESCRIPTION* TEST_IO_INTERFACE_DESC = (IO_INTERFACE_DESCRIPTION*)0x11111118;
 static STRING_HANDLE TEST_STRING_HANDLE = (STRING_HANDLE)0x11111119;
 static DEVICE_REGISTRATION_STATE_HANDLE TEST_DEVICE_REGISTRATION_STATE_HANDLE = (DEVICE_REGISTRATION_STATE_HANDLE)0x11111120;
+static TICK_COUNTER_HANDLE TEST_TICK_COUNTER_HANDLE = (TICK_COUNTER_HANDLE)0x11111123;
 #define TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 (INDIVIDUAL_ENROLLMENT_HANDLE)0x11111121
 #define TEST_HTTP_HEADERS_HANDLE (HTTP_HEADERS_HANDLE)0x11111122
 static const unsigned char* TEST_REPLY_JSON = (const unsigned char*)"{my-json-reply}";
@@ -143,6 +156,7 @@ static const char* TEST_CONT_TOKEN2 = "cont2";
 static int TEST_PROXY_PORT = 123;
 static size_t TEST_REPLY_JSON_LEN = 15;
 static unsigned int STATUS_CODE_SUCCESS = 204;
+static size_t TEST_REQUEST_TIMEOUT_MS = 5000;
 
 typedef enum {ETAG, NO_ETAG} etag_flag;
 typedef enum {RESPONSE, NO_RESPONSE} response_flag;
@@ -159,8 +173,8 @@ static HTTP_CLIENT_HANDLE my_uhttp_client_create(const IO_INTERFACE_DESCRIPTION*
 {
     (void)io_interface_desc;
     (void)xio_param;
-    (void)on_http_error;
-    (void)callback_ctx;
+    g_on_http_error = on_http_error;
+    g_http_error_ctx = callback_ctx; //prov_client
 
     return (HTTP_CLIENT_HANDLE)real_malloc(1);
 }
@@ -177,6 +191,7 @@ static HTTP_CLIENT_RESULT my_uhttp_client_open(HTTP_CLIENT_HANDLE handle, const
     (void)port_num;
     g_on_http_open = on_connect;
     g_http_open_ctx = callback_ctx; //prov_client
+    g_http_open_pending = true;
 
     //note that a real malloc does occur in this fn, but it can't be mocked since it's in a field of handle
 
@@ -203,6 +218,7 @@ static HTTP_CLIENT_RESULT my_uhttp_client_execute_request(HTTP_CLIENT_HANDLE han
     (void)content_len;
     g_on_http_reply_recv = on_request_callback;
     g_http_reply_recv_ctx = callback_ctx;
+    g_http_request_pending = true;
 
     return HTTP_CLIENT_OK;
 }
@@ -217,15 +233,52 @@ static void my_uhttp_client_dowork(HTTP_CLIENT_HANDLE handle)
     else
         content = NULL;
 
-    if (g_uhttp_client_dowork_call_count == 0)
+    //every call completes at most one pending operation, like the first call after the socket becomes readable
+    if (g_service_closes_connection)
+    {
+        g_service_closes_connection = false;
+        g_on_http_error(g_http_error_ctx, HTTP_CALLBACK_REASON_ERROR);
+    }
+    else if (g_http_open_pending)
+    {
+        g_http_open_pending = false;
         g_on_http_open(g_http_open_ctx, HTTP_CALLBACK_REASON_OK);
-    else if (g_uhttp_client_dowork_call_count == 1)
+    }
+    else if (g_http_request_pending && g_service_drops_request)
+    {
+        //the connection fails after the request was sent, the service may or may not have received it
+        g_service_drops_request = false;
+        g_http_request_pending = false;
+        g_on_http_error(g_http_error_ctx, HTTP_CALLBACK_REASON_ERROR);
+    }
+    else if (g_http_request_pending && g_service_replies)
     {
-        g_on_http_reply_recv(g_http_reply_recv_ctx, HTTP_CALLBACK_REASON_OK, content, 1, STATUS_CODE_SUCCESS, TEST_HTTP_HEADERS_HANDLE);
+        if (g_service_reply_delay > 0)
+        {
+            //the reply is not there yet
+            g_service_reply_delay--;
+        }
+        else
+        {
+            g_http_request_pending = false;
+            g_on_http_reply_recv(g_http_reply_recv_ctx, HTTP_CALLBACK_REASON_OK, content, 1, STATUS_CODE_SUCCESS, TEST_HTTP_HEADERS_HANDLE);
+        }
     }
     g_uhttp_client_dowork_call_count++;
 }
 
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_current_ms;
+    return 0;
+}
+
+static void my_ThreadAPI_Sleep(unsigned int milliseconds)
+{
+    g_current_ms += milliseconds;
+}
+
 static const char* my_Map_GetValueFromKey(MAP_HANDLE handle, const char* key)
 {
     char* result = NULL;
@@ -386,6 +439,31 @@ static void my_bulkOperationResult_free(PROVISIONING_BULK_OPERATION_RESULT* bulk
     real_free(bulk_res);
 }
 
+static PROVISIONING_BULK_OPERATION_RESULT* my_bulkOperationResult_create(void)
+{
+    PROVISIONING_BULK_OPERATION_RESULT* result = (PROVISIONING_BULK_OPERATION_RESULT*)real_malloc(sizeof(PROVISIONING_BULK_OPERATION_RESULT));
+    memset(result, 0, sizeof(PROVISIONING_BULK_OPERATION_RESULT));
+    result->is_successful = true;
+    return result;
+}
+
+static int my_bulkOperationResult_append(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, PROVISIONING_BULK_OPERATION_RESULT* other_res)
+{
+    (void)bulk_res;
+    real_free(other_res);
+    return 0;
+}
+
+static int my_bulkOperationResult_addError(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, const char* registration_id, int32_t error_code, const char* error_status)
+{
+    (void)registration_id;
+    (void)error_code;
+    (void)error_status;
+    bulk_res->num_errors++;
+    bulk_res->is_successful = false;
+    return 0;
+}
+
 static void my_queryResponse_free(PROVISIONING_QUERY_RESPONSE* query_resp)
 {
     real_free(query_resp);
@@ -511,6 +589,21 @@ static char* my_bulkOperation_serializeToJson(const PROVISIONING_BULK_OPERATION*
     return result;
 }
 
+static int my_bulkOperation_serializeRangeToBuffer(const PROVISIONING_BULK_OPERATION* bulkop, size_t first, size_t count, char** buffer, size_t* capacity)
+{
+    (void)bulkop;
+    (void)first;
+    (void)count;
+    size_t len = strlen(TEST_ENROLLMENT_JSON);
+    if (*buffer == NULL)
+    {
+        *buffer = (char*)real_malloc(len + 1);
+        *capacity = len + 1;
+    }
+    strncpy(*buffer, TEST_ENROLLMENT_JSON, len + 1);
+    return 0;
+}
+
 static char* my_querySpecification_serializeToJson(const PROVISIONING_QUERY_SPECIFICATION* query_spec)
 {
     (void)query_spec;
@@ -521,6 +614,22 @@ static char* my_querySpecification_serializeToJson(const PROVISIONING_QUERY_SPEC
     return result;
 }
 
+//every page of a query holds g_page_records records, the position is the number of records already read
+static int my_queryResponse_nextRecord(char* json_string, size_t length, size_t* position, char** record_json)
+{
+    (void)length;
+    if (*position < g_page_records)
+    {
+        *record_json = json_string;
+        (*position)++;
+    }
+    else
+    {
+        *record_json = NULL;
+    }
+    return 0;
+}
+
 static void register_global_mock_hooks()
 {
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, real_malloc);
@@ -563,6 +672,11 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_HOOK(uhttp_client_execute_request, my_uhttp_client_execute_request);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(uhttp_client_execute_request, HTTP_CLIENT_ERROR);
 
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_get_current_ms, __FAILURE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Sleep, my_ThreadAPI_Sleep);
+
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_Alloc, NULL);
 
@@ -624,6 +738,18 @@ static void register_global_mock_hooks()
 
     REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_free, my_bulkOperationResult_free);
 
+    REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_create, my_bulkOperationResult_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperationResult_create, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_append, my_bulkOperationResult_append);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperationResult_append, __FAILURE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_addError, my_bulkOperationResult_addError);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperationResult_addError, __FAILURE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(bulkOperation_serializeRangeToBuffer, my_bulkOperation_serializeRangeToBuffer);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperation_serializeRangeToBuffer, __FAILURE__);
+
     REGISTER_GLOBAL_MOCK_HOOK(querySpecification_serializeToJson, my_querySpecification_serializeToJson);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(querySpecification_serializeToJson, NULL);
 
@@ -634,6 +760,9 @@ static void register_global_mock_hooks()
 
     REGISTER_GLOBAL_MOCK_HOOK(queryType_stringToEnum, my_queryType_stringToEnum);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(queryType_stringToEnum, QUERY_TYPE_INVALID);
+
+    REGISTER_GLOBAL_MOCK_HOOK(queryResponse_nextRecord, my_queryResponse_nextRecord);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(queryResponse_nextRecord, __FAILURE__);
 }
 
 static void register_global_mock_returns()
@@ -659,6 +788,9 @@ static void register_global_mock_returns()
     REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, TEST_STRING);
 
     REGISTER_GLOBAL_MOCK_RETURN(http_proxy_io_get_interface_description, TEST_IO_INTERFACE_DESC);
+
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
 }
 
 static void register_global_mock_alias_types()
@@ -679,8 +811,10 @@ static void register_global_mock_alias_types()
     REGISTER_UMOCK_ALIAS_TYPE(ON_HTTP_REQUEST_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_HTTP_CLOSED_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_CLIENT_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_CLIENT_REQUEST_TYPE, int);
     REGISTER_UMOCK_ALIAS_TYPE(PROVISIONING_QUERY_TYPE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(int32_t, int);
 }
 
 BEGIN_TEST_SUITE(provisioning_service_client_ut)
@@ -719,6 +853,16 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     g_http_open_ctx = NULL;
     g_on_http_reply_recv = NULL;
     g_http_reply_recv_ctx = NULL;
+    g_on_http_error = NULL;
+    g_http_error_ctx = NULL;
+    g_http_open_pending = false;
+    g_http_request_pending = false;
+    g_service_replies = true;
+    g_service_closes_connection = false;
+    g_service_drops_request = false;
+    g_service_reply_delay = 0;
+    g_page_records = 1;
+    g_current_ms = 0;
     g_uhttp_client_dowork_call_count = 0;
     g_response_content_status = RESPONSE_ON;
 
@@ -820,9 +964,8 @@ static void expected_calls_connect_to_service()
     STRICT_EXPECTED_CALL(uhttp_client_open(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 }
 
-static void expected_calls_rest_call(HTTP_CLIENT_REQUEST_TYPE request_type, response_flag response_flag)
+static void expected_calls_send_request(HTTP_CLIENT_REQUEST_TYPE request_type, response_flag response_flag)
 {
-    expected_calls_connect_to_service();
     STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, request_type, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
@@ -831,10 +974,116 @@ static void expected_calls_rest_call(HTTP_CLIENT_REQUEST_TYPE request_type, resp
     {
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));  //this is also in the callback
     }
+}
+
+static void expected_calls_disconnect_from_service()
+{
     STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG)); //does not fail
 }
 
+//the connection is left open for the next request
+static void expected_calls_rest_call(HTTP_CLIENT_REQUEST_TYPE request_type, response_flag response_flag)
+{
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    expected_calls_connect_to_service();
+    expected_calls_send_request(request_type, response_flag);
+}
+
+static void expected_calls_start_bulk_chunk(bool connect)
+{
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    STRICT_EXPECTED_CALL(bulkOperation_serializeRangeToBuffer(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    if (connect)
+    {
+        expected_calls_connect_to_service();
+    }
+}
+
+//the timeout of the chunk is checked on the pass that sent it, which made progress and does not sleep
+static void expected_calls_complete_bulk_chunk()
+{
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Clone(IGNORED_PTR_ARG)); //this is in a callback for on_http_reply_recv
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //this is also in the callback
+    STRICT_EXPECTED_CALL(bulkOperationResult_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(bulkOperationResult_append(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+}
+
+static void expected_calls_end_bulk_operation()
+{
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+}
+
+static void expected_calls_start_query_page(bool has_cont_token, bool connect)
+{
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    expected_calls_add_query_headers(true, has_cont_token);
+    if (connect)
+    {
+        expected_calls_connect_to_service();
+    }
+}
+
+static void expected_calls_create_query_iterator(bool has_query_string)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    if (has_query_string)
+    {
+        STRICT_EXPECTED_CALL(querySpecification_serializeToJson(IGNORED_PTR_ARG));
+    }
+    expected_calls_construct_registration_path(!has_query_string);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_query_page(false, true);
+}
+
+//the request for the next page is moved forward once by every call to next
+static void expected_calls_query_iterator_pump()
+{
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+}
+
+static void expected_calls_receive_query_page(const char* cont_token, const char* item_type)
+{
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Clone(IGNORED_PTR_ARG)); //this is in a callback for on_http_reply_recv
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //this is also in the callback
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(cont_token); //does not fail
+    if (cont_token != NULL)
+    {
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    }
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(item_type);
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(item_type));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    if (cont_token != NULL)
+    {
+        expected_calls_start_query_page(true, false);
+    }
+}
+
+//the timeout of the page starts when the iterator starts waiting for it
+static void expected_calls_take_query_page(const char* cont_token, const char* item_type)
+{
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    expected_calls_receive_query_page(cont_token, item_type);
+}
+
 /* UNIT TESTS BEGIN */
 
 /* Tests_PROVISIONING_SERVICE_CLIENT_22_001: [ If conn_string is NULL prov_sc_create_from_connection_string shall fail and return NULL ] */
@@ -867,6 +1116,7 @@ TEST_FUNCTION(prov_sc_create_from_connection_string_GOLDEN)
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_create());
     STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 
@@ -896,12 +1146,13 @@ TEST_FUNCTION(prov_sc_create_from_connection_string_FAIL)
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_create());
     STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 9, 10 };
+    size_t calls_cannot_fail[] = { 10, 11 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -962,6 +1213,8 @@ TEST_FUNCTION(prov_sc_destroy_GOLDEN)
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     //act
     prov_sc_destroy(sc);
@@ -1269,678 +1522,586 @@ TEST_FUNCTION(prov_sc_set_proxy_GOLDEN_FULL_PROXY)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_SC_HANDLE)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_101: [ If prov_client is NULL, prov_sc_set_request_timeout shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_set_request_timeout_ERROR_INPUT_NULL)
 {
     //arrange
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_individual_enrollment(NULL, &ie);
+    int res = prov_sc_set_request_timeout(NULL, TEST_REQUEST_TIMEOUT_MS);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_102: [ prov_sc_set_request_timeout shall set the time a request may take to timeout_ms and return 0. 0 means there is no timeout, the default is 60000 ms ] */
+TEST_FUNCTION(prov_sc_set_request_timeout_GOLDEN)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_individual_enrollment(sc, NULL);
+    int res = prov_sc_set_request_timeout(sc, TEST_REQUEST_TIMEOUT_MS);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE2)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_109: [ If prov_client is NULL or max_requests is 0, prov_sc_set_bulk_operation_requests_in_flight shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_set_bulk_operation_requests_in_flight_ERROR_INPUT_NULL)
 {
     //arrange
-    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
-    umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int res = prov_sc_set_bulk_operation_requests_in_flight(NULL, 2);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_109: [ If prov_client is NULL or max_requests is 0, prov_sc_set_bulk_operation_requests_in_flight shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_set_bulk_operation_requests_in_flight_ERROR_ZERO)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-
     //act
-    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int res = prov_sc_set_bulk_operation_requests_in_flight(sc, 0);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_w_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_110: [ prov_sc_set_bulk_operation_requests_in_flight shall set the number of requests prov_sc_run_individual_enrollment_bulk_operation_chunked keeps in flight to max_requests and return 0. The default is 4 ] */
+TEST_FUNCTION(prov_sc_set_bulk_operation_requests_in_flight_GOLDEN)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-
     //act
-    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int res = prov_sc_set_bulk_operation_requests_in_flight(sc, 1);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_ALL_HTTP_OPTIONS)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_103: [ After a request completes, the HTTP connection shall be kept open and used for the next request. A new connection shall only be made when none is open ] */
+TEST_FUNCTION(prov_sc_rest_call_reuses_connection)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-
-    HTTP_PROXY_OPTIONS proxy_options;
-    proxy_options.host_address = TEST_PROXY_HOSTNAME;
-    proxy_options.port = TEST_PROXY_PORT;
-    proxy_options.username = TEST_PROXY_USERNAME;
-    proxy_options.password = TEST_PROXY_PASSWORD;
-
-    prov_sc_set_proxy(sc, &proxy_options);
-    prov_sc_set_certificate(sc, TEST_TRUSTED_CERT);
-    prov_sc_set_trace(sc, TRACING_STATUS_ON);
-
-    g_proxy = PROXY;
-    g_cert = CERT;
-    g_trace = TRACE;
-
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    expected_calls_send_request(HTTP_CLIENT_REQUEST_GET, RESPONSE);
     STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie2);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(ie2);
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
+    individualEnrollment_destroy(ie2);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_null_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_104: [ If a request sent on a connection kept open fails before any reply is received, the connection shall be closed and the request shall be sent once more on a new connection ] */
+TEST_FUNCTION(prov_sc_rest_call_reconnects_when_service_closed_connection)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    g_service_closes_connection = true;
+
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //the service closed the connection
+    expected_calls_disconnect_from_service();
+    expected_calls_connect_to_service();
+    expected_calls_send_request(HTTP_CLIENT_REQUEST_GET, RESPONSE);
     STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-
-    umock_c_negative_tests_snapshot();
-
-    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 19, 20, 21, 22, 24, 25, 27, 28, 29, 30, 31 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
-
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
-
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
-
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
-
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
-
-        //act
-        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
-        //assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+    //act
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie2);
 
-        g_uhttp_client_dowork_call_count = 0;
-    }
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(ie2);
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
-    umock_c_negative_tests_deinit();
+    individualEnrollment_destroy(ie2);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_w_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_104: [ If a request sent on a connection kept open fails before any reply is received, the connection shall be closed and the request shall be sent once more on a new connection ] */
+TEST_FUNCTION(prov_sc_rest_call_resends_idempotent_request_when_connection_failed_after_send)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    g_service_drops_request = true;
+
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //the connection failed after the request was sent
+    expected_calls_disconnect_from_service();
+    expected_calls_connect_to_service();
+    expected_calls_send_request(HTTP_CLIENT_REQUEST_GET, RESPONSE);
     STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-
-    umock_c_negative_tests_snapshot();
-
-    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 15, 16, 20, 21, 22, 23, 25, 26, 28, 29, 30, 31, 32 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
-
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
-
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
-
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
-
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
-
-        //act
-        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
-        //assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+    //act
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie2);
 
-        g_uhttp_client_dowork_call_count = 0;
-    }
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(ie2);
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
-    umock_c_negative_tests_deinit();
+    individualEnrollment_destroy(ie2);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIONS)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_105: [ When a call to uhttp_client_dowork brings no progress, the client shall sleep 1 ms before calling it again ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_106: [ If the request has not completed timeout_ms after it started, it shall fail and the connection shall be closed ] */
+TEST_FUNCTION(prov_sc_rest_call_FAIL_timeout)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-
-    HTTP_PROXY_OPTIONS proxy_options;
-    proxy_options.host_address = TEST_PROXY_HOSTNAME;
-    proxy_options.port = TEST_PROXY_PORT;
-    proxy_options.username = TEST_PROXY_USERNAME;
-    proxy_options.password = TEST_PROXY_PASSWORD;
-
-    prov_sc_set_proxy(sc, &proxy_options);
-    prov_sc_set_certificate(sc, TEST_TRUSTED_CERT);
-    prov_sc_set_trace(sc, TRACING_STATUS_ON);
-
-    g_proxy = PROXY;
-    g_cert = CERT;
-    g_trace = TRACE;
-
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_set_request_timeout(sc, 2);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    g_service_replies = false;
+
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    expected_calls_connect_to_service();
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //2 ms elapsed
+    expected_calls_disconnect_from_service();
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-
-    umock_c_negative_tests_snapshot();
-
-    size_t calls_cannot_fail[] = { 3, 4, 5,  7, 12, 14, 15, 16, 22, 24, 25, 27, 28, 30, 31, 32, 33, 34 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
+    //act
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(ie);
 
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+    //cleanup
+    prov_sc_destroy(sc);
+}
 
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_107: [ prov_sc_set_trace, prov_sc_set_certificate and prov_sc_set_proxy shall close the HTTP connection kept open by prov_client so that the next request uses the new setting ] */
+TEST_FUNCTION(prov_sc_set_trace_closes_connection)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    umock_c_reset_all_calls();
 
-        //act
-        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    expected_calls_disconnect_from_service();
 
-        //assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+    //act
+    prov_sc_set_trace(sc, TRACING_STATUS_ON);
 
-        g_uhttp_client_dowork_call_count = 0;
-    }
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
-    umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_010: [ If prov_client or enrollment are NULL, prov_sc_delete_individual_enrollment shall fail and return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_108: [ prov_sc_destroy shall close and destroy the HTTP connection kept open by prov_client, if any ] */
+TEST_FUNCTION(prov_sc_destroy_closes_connection)
 {
     //arrange
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    umock_c_reset_all_calls();
+
+    expected_calls_disconnect_from_service();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_delete_individual_enrollment(NULL, TEST_INDIVIDUAL_ENROLLMENT_HANDLE);
+    prov_sc_destroy(sc);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
+    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_010: [ If prov_client or enrollment are NULL, prov_sc_delete_individual_enrollment shall fail and return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_ERROR_INPUT_NULL_ENROLLMENT)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_SC_HANDLE)
 {
     //arrange
-    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-
     //act
-    int res = prov_sc_delete_individual_enrollment(sc, NULL);
+    int result = prov_sc_create_or_update_individual_enrollment(NULL, &ie);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_011: [ A 'DELETE' REST call shall be issued to delete the individual enrollment record on the Provisioning Service that matches enrollment based on registration id and etag ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_013: [ Upon a successful delete, prov_sc_delete_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_GOLDEN_NO_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
-    //arrange
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //no etag
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
     //act
-    int res = prov_sc_delete_individual_enrollment(sc, ie);
+    int result = prov_sc_create_or_update_individual_enrollment(sc, NULL);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_011: [ A 'DELETE' REST call shall be issued to delete the individual enrollment record on the Provisioning Service that matches enrollment based on registration id and etag ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_013: [ Upon a successful delete, prov_sc_delete_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_GOLDEN_WITH_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE2)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    set_response_status(RESPONSE_OFF);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
     umock_c_reset_all_calls();
 
-    //arrange
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
     //act
-    int res = prov_sc_delete_individual_enrollment(sc, ie);
+    int result = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_012: [ If the 'DELETE' REST call fails, prov_sc_delete_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    set_response_status(RESPONSE_OFF);
-
+    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)); //can fail, but for sake of this example, cannot
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
-    umock_c_negative_tests_snapshot();
-
-    size_t calls_cannot_fail[] = { 0, 3, 4, 6, 10, 13, 14, 18, 20, 21, 22, 23, 24, 25, 26, 27 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
-
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
-
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
-
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_delete_individual_enrollment failure in test %zu/%zu", test_num, test_max);
-
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
-
-        //act
-        int res = prov_sc_delete_individual_enrollment(sc, ie);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
-        //assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+    //act
+    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
-        g_uhttp_client_dowork_call_count = 0;
-    }
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
-    umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_046: [ If prov_client or reg_id are NULL, prov_sc_delete_individual_enrollment_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_w_etag)
 {
     //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_delete_individual_enrollment_by_param(NULL, TEST_REGID, TEST_ETAG);
+    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_046: [ If prov_client or reg_id are NULL, prov_sc_delete_individual_enrollment_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_NULL_REG_ID)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_ALL_HTTP_OPTIONS)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    umock_c_reset_all_calls();
 
-    //act
-    int res = prov_sc_delete_individual_enrollment_by_param(sc, NULL, TEST_ETAG);
+    HTTP_PROXY_OPTIONS proxy_options;
+    proxy_options.host_address = TEST_PROXY_HOSTNAME;
+    proxy_options.port = TEST_PROXY_PORT;
+    proxy_options.username = TEST_PROXY_USERNAME;
+    proxy_options.password = TEST_PROXY_PASSWORD;
 
-    //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    prov_sc_set_proxy(sc, &proxy_options);
+    prov_sc_set_certificate(sc, TEST_TRUSTED_CERT);
+    prov_sc_set_trace(sc, TRACING_STATUS_ON);
 
-    //cleanup
-    prov_sc_destroy(sc);
-}
+    g_proxy = PROXY;
+    g_cert = CERT;
+    g_trace = TRACE;
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_047: [ If etag is given as NULL, it shall be ignored ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_048: [A 'DELETE' REST call shall be issued to delete the individual enrollment record of a device with ID reg_id, and optionally, etag from the Provisioning Service] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_050: [ Upon a successful delete, prov_sc_delete_individual_enrollment_by_param shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_GOLDEN_NO_ETAG)
-{
-    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
     umock_c_reset_all_calls();
 
-    //arrange
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE); // <- this NO_ETAG flag is what proves Requirement 047 - if etag wasn't ignored, actual calls will not line up with expected
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_delete_individual_enrollment_by_param(sc, TEST_REGID, NULL);
+    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_048: [A 'DELETE' REST call shall be issued to delete the individual enrollment record of a device with ID reg_id, and optionally, etag from the Provisioning Service] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_050: [ Upon a successful delete, prov_sc_delete_individual_enrollment_by_param shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_GOLDEN_WITH_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_null_etag)
 {
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+
     umock_c_reset_all_calls();
 
-    //arrange
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
-    //act
-    int res = prov_sc_delete_individual_enrollment_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+    umock_c_negative_tests_snapshot();
 
-    //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 20, 21, 22, 23, 26, 27, 28, 29, 30 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
 
     //cleanup
     prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+    umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_049: [ If the 'DELETE' REST call fails, prov_sc_delete_individual_enrollment_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_w_etag)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
 
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 8, 11, 12, 16, 18, 19, 20, 21, 22, 23, 24, 25 };
-
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 15, 16, 21, 22, 23, 24, 27, 28, 29, 30, 31 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -1954,13 +2115,15 @@ TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_delete_individual_enrollment_by_param failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_delete_individual_enrollment_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -1970,53 +2133,119 @@ TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_FAIL)
 
     //cleanup
     prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_014: [ If prov_client, reg_id or enrollment_ptr are NULL, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIONS)
 {
     //arrange
-    INDIVIDUAL_ENROLLMENT_HANDLE ie;
-
-    //act
-    int res = prov_sc_get_individual_enrollment(NULL, TEST_REGID, &ie);
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-    //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
 
-    //cleanup
-}
+    HTTP_PROXY_OPTIONS proxy_options;
+    proxy_options.host_address = TEST_PROXY_HOSTNAME;
+    proxy_options.port = TEST_PROXY_PORT;
+    proxy_options.username = TEST_PROXY_USERNAME;
+    proxy_options.password = TEST_PROXY_PASSWORD;
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_014: [ If prov_client, reg_id or enrollment_ptr are NULL, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_REG_ID)
+    prov_sc_set_proxy(sc, &proxy_options);
+    prov_sc_set_certificate(sc, TEST_TRUSTED_CERT);
+    prov_sc_set_trace(sc, TRACING_STATUS_ON);
+
+    g_proxy = PROXY;
+    g_cert = CERT;
+    g_trace = TRACE;
+
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 17, 23, 25, 26, 29, 30, 31, 32, 33 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_ON);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_010: [ If prov_client or enrollment are NULL, prov_sc_delete_individual_enrollment shall fail and return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_ERROR_INPUT_NULL_PROV_SC)
 {
     //arrange
-    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie;
-    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_get_individual_enrollment(sc, NULL, &ie);
+    int res = prov_sc_delete_individual_enrollment(NULL, TEST_INDIVIDUAL_ENROLLMENT_HANDLE);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_014: [ If prov_client, reg_id or enrollment_ptr are NULL, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_ENROLLMENT)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_010: [ If prov_client or enrollment are NULL, prov_sc_delete_individual_enrollment shall fail and return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_ERROR_INPUT_NULL_ENROLLMENT)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+
     //act
-    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, NULL);
+    int res = prov_sc_delete_individual_enrollment(sc, NULL);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2026,56 +2255,91 @@ TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_ENROLLMENT)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_015: [ A 'GET' REST call shall be issued to retrieve the enrollment record of a device with ID reg_id from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_017: [ The data from the retrieved device enrollment record shall populate enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_019: [ Upon successful population of enrollment_ptr with the retrieved device enrollment record data, prov_sc_get_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_get_individual_enrollment_GOLDEN)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_011: [ A 'DELETE' REST call shall be issued to delete the individual enrollment record on the Provisioning Service that matches enrollment based on registration id and etag ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_013: [ Upon a successful delete, prov_sc_delete_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_GOLDEN_NO_ETAG)
 {
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    set_response_status(RESPONSE_OFF);
+    umock_c_reset_all_calls();
+
     //arrange
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //no etag
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_delete_individual_enrollment(sc, ie);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_011: [ A 'DELETE' REST call shall be issued to delete the individual enrollment record on the Provisioning Service that matches enrollment based on registration id and etag ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_013: [ Upon a successful delete, prov_sc_delete_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_GOLDEN_WITH_ETAG)
+{
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
+    //arrange
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    int res = prov_sc_delete_individual_enrollment(sc, ie);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_IS_NOT_NULL(ie);
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_016: [If the 'GET' REST call fails, prov_sc_get_individual_enrollment shall fail and return a non - zero value] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_018: [ If populating enrollment_ptr with retrieved data fails, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_012: [ If the 'DELETE' REST call fails, prov_sc_delete_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_FAIL)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    set_response_status(RESPONSE_OFF);
+
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)); //can fail, but for sake of this example, cannot
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -2083,7 +2347,7 @@ TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 12, 16, 18, 19, 21, 22, 24, 25, 26, 27};
+    size_t calls_cannot_fail[] = { 0, 3, 4, 6, 10, 13, 14, 19, 21, 22, 23, 24, 25, 26 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -2097,13 +2361,15 @@ TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_get_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_delete_individual_enrollment failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+        int res = prov_sc_delete_individual_enrollment(sc, ie);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -2117,234 +2383,123 @@ TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_030: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_ERROR_INPUT_NULL_SC_HANDLE)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_046: [ If prov_client or reg_id are NULL, prov_sc_delete_individual_enrollment_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_NULL_PROV_SC)
 {
     //arrange
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-    umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_enrollment_group(NULL, &eg);
+    int res = prov_sc_delete_individual_enrollment_by_param(NULL, TEST_REGID, TEST_ETAG);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_030: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_ERROR_INPUT_NULL_EG_HANDLE)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_046: [ If prov_client or reg_id are NULL, prov_sc_delete_individual_enrollment_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_NULL_REG_ID)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_enrollment_group(sc, NULL);
+    int res = prov_sc_delete_individual_enrollment_by_param(sc, NULL, TEST_ETAG);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_030: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_ERROR_INPUT_NULL_EG_HANDLE2)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_047: [ If etag is given as NULL, it shall be ignored ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_048: [A 'DELETE' REST call shall be issued to delete the individual enrollment record of a device with ID reg_id, and optionally, etag from the Provisioning Service] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_050: [ Upon a successful delete, prov_sc_delete_individual_enrollment_by_param shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_GOLDEN_NO_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = NULL;
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
+    //arrange
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE); // <- this NO_ETAG flag is what proves Requirement 047 - if etag wasn't ignored, actual calls will not line up with expected
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
     //act
-    int result = prov_sc_create_or_update_enrollment_group(sc, &eg);
+    int res = prov_sc_delete_individual_enrollment_by_param(sc, TEST_REGID, NULL);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_031: [ A 'PUT' REST call shall be issued to create/update the device enrollment group on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_051: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_033: [ Upon a successful create or update, prov_sc_create_or_update_enrollment_group shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_GOLDEN_no_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_048: [A 'DELETE' REST call shall be issued to delete the individual enrollment record of a device with ID reg_id, and optionally, etag from the Provisioning Service] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_050: [ Upon a successful delete, prov_sc_delete_individual_enrollment_by_param shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_GOLDEN_WITH_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-    ENROLLMENT_GROUP_HANDLE old_eg = eg;
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
+    //arrange
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
+    int res = prov_sc_delete_individual_enrollment_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_eg != eg); //eg was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_031: [ A 'PUT' REST call shall be issued to create/update the device enrollment group on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_051: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_033: [ Upon a successful create or update, prov_sc_create_or_update_enrollment_group shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_GOLDEN_w_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_049: [ If the 'DELETE' REST call fails, prov_sc_delete_individual_enrollment_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_FAIL)
 {
     //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-    ENROLLMENT_GROUP_HANDLE old_eg = eg;
+    set_response_status(RESPONSE_OFF);
+
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-
-    //act
-    int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
-
-    //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_eg != eg); //eg was changed by the function
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-    //cleanup
-    prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
-}
-
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_052: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_no_etag)
-{
-    //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
-    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-
-    umock_c_reset_all_calls();
-
-    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 19, 20, 21, 22, 24, 25, 27, 28, 29, 30, 31, 32 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
-
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
-
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
-
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_enrollment_group failure in test %zu/%zu", test_num, test_max);
-
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
-
-        //act
-        int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
-
-        //assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
-    }
-
-    //cleanup
-    prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
-    umock_c_negative_tests_deinit();
-}
-
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_052: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_w_etag)
-{
-    //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
-    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-
-    umock_c_reset_all_calls();
-
-    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-
-    umock_c_negative_tests_snapshot();
+    size_t calls_cannot_fail[] = { 1, 2, 4, 8, 11, 12, 17, 19, 20, 21, 22, 23, 24 };
 
-    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 15, 16, 20, 21, 22, 23, 25, 26, 28, 29, 30, 31, 32, 33 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -2358,13 +2513,15 @@ TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_w_etag)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_enrollment_group failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_delete_individual_enrollment_by_param failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
+        int res = prov_sc_delete_individual_enrollment_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -2374,19 +2531,17 @@ TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_w_etag)
 
     //cleanup
     prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_034: [ If prov_client or id are NULL, prov_sc_delete_enrollment_group shall return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_014: [ If prov_client, reg_id or enrollment_ptr are NULL, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_PROV_SC)
 {
     //arrange
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
+    INDIVIDUAL_ENROLLMENT_HANDLE ie;
 
     //act
-    int res = prov_sc_delete_enrollment_group(NULL, TEST_ENROLLMENT_GROUP_HANDLE);
+    int res = prov_sc_get_individual_enrollment(NULL, TEST_REGID, &ie);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2395,18 +2550,16 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_ERROR_INPUT_NULL_PROV_SC)
     //cleanup
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_034: [ If prov_client or id are NULL, prov_sc_delete_enrollment_group shall return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_ERROR_INPUT_NULL_ENROLLMENT)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_014: [ If prov_client, reg_id or enrollment_ptr are NULL, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_REG_ID)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
-
     //act
-    int res = prov_sc_delete_enrollment_group(sc, NULL);
+    int res = prov_sc_get_individual_enrollment(sc, NULL, &ie);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2416,91 +2569,74 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_ERROR_INPUT_NULL_ENROLLMENT)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_035: [ A 'DELETE' REST call shall be issued to delete the device enrollment group that matches enrollment from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_037: [ Upon a successful delete, prov_sc_delete_enrollment_group shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_GOLDEN_NO_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_014: [ If prov_client, reg_id or enrollment_ptr are NULL, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_ERROR_INPUT_NULL_ENROLLMENT)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
-    //arrange
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //no etag
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
     //act
-    int res = prov_sc_delete_enrollment_group(sc, eg);
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, NULL);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_035: [ A 'DELETE' REST call shall be issued to delete the device enrollment group that matches enrollment from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_037: [ Upon a successful delete, prov_sc_delete_enrollment_group shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_GOLDEN_WITH_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_015: [ A 'GET' REST call shall be issued to retrieve the enrollment record of a device with ID reg_id from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_017: [ The data from the retrieved device enrollment record shall populate enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_019: [ Upon successful population of enrollment_ptr with the retrieved device enrollment record data, prov_sc_get_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_GOLDEN)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-    set_response_status(RESPONSE_OFF);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
     umock_c_reset_all_calls();
 
-    //arrange
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_delete_enrollment_group(sc, eg);
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(ie);
 
     //cleanup
     prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
+    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_036: [ If the 'DELETE' REST call fails, prov_sc_delete_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_016: [If the 'GET' REST call fails, prov_sc_get_individual_enrollment shall fail and return a non - zero value] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_018: [ If populating enrollment_ptr with retrieved data fails, prov_sc_get_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
-    set_response_status(RESPONSE_OFF);
-
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)); //can fail, but for sake of this example, cannot
-    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -2508,7 +2644,7 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 0, 3, 4, 6, 10, 13, 14, 18, 20, 21, 22, 23, 24, 25, 26, 27 };
+    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 12, 17, 19, 20, 23, 24, 25, 26 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -2522,13 +2658,15 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_delete_enrollment_group failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_get_individual_enrollment failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_delete_enrollment_group(sc, eg);
+        int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -2538,126 +2676,174 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
 
     //cleanup
     prov_sc_destroy(sc);
-    enrollmentGroup_destroy(eg);
+    individualEnrollment_destroy(ie);
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_053: [ If prov_client or group_id are NULL, prov_sc_delete_enrollment_group_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_030: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_ERROR_INPUT_NULL_SC_HANDLE)
 {
     //arrange
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+    umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_delete_enrollment_group_by_param(NULL, TEST_GROUPID, TEST_ETAG);
+    int result = prov_sc_create_or_update_enrollment_group(NULL, &eg);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
+    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_053: [ If prov_client or group_id are NULL, prov_sc_delete_enrollment_group_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_NULL_REG_ID)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_030: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_ERROR_INPUT_NULL_EG_HANDLE)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_delete_enrollment_group_by_param(sc, NULL, TEST_ETAG);
+    int result = prov_sc_create_or_update_enrollment_group(sc, NULL);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_054: [ If etag is given as NULL, it shall be ignored ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_055: [ A 'DELETE' REST call shall be issued to delete the enrollment group record with ID group_id, and optionally, etag from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_057: [ Upon a successful delete, prov_sc_delete_enrollment_group_by_param shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_GOLDEN_NO_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_030: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_ERROR_INPUT_NULL_EG_HANDLE2)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    ENROLLMENT_GROUP_HANDLE eg = NULL;
     umock_c_reset_all_calls();
 
-    //arrange
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE); // <- this NO_ETAG flag is what proves Requirement 054 - if etag wasn't ignored, actual calls will not line up with expected
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
     //act
-    int res = prov_sc_delete_enrollment_group_by_param(sc, TEST_REGID, NULL);
+    int result = prov_sc_create_or_update_enrollment_group(sc, &eg);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_055: [ A 'DELETE' REST call shall be issued to delete the enrollment group record with ID group_id, and optionally, etag from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_057: [ Upon a successful delete, prov_sc_delete_enrollment_group_by_param shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_GOLDEN_WITH_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_031: [ A 'PUT' REST call shall be issued to create/update the device enrollment group on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_051: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_033: [ Upon a successful create or update, prov_sc_create_or_update_enrollment_group shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_GOLDEN_no_etag)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+    ENROLLMENT_GROUP_HANDLE old_eg = eg;
     umock_c_reset_all_calls();
 
-    //arrange
+    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_delete_enrollment_group_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+    int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_eg != eg); //eg was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_056: [ If the 'DELETE' REST call fails, prov_sc_delete_enrollment_group_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_031: [ A 'PUT' REST call shall be issued to create/update the device enrollment group on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_051: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_033: [ Upon a successful create or update, prov_sc_create_or_update_enrollment_group shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_GOLDEN_w_etag)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+    ENROLLMENT_GROUP_HANDLE old_eg = eg;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_eg != eg); //eg was changed by the function
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_052: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_no_etag)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
 
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 8, 11, 12, 16, 18, 19, 20, 21, 22, 23, 24, 25 };
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 20, 21, 22, 23, 26, 27, 28, 29, 30, 31 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -2671,13 +2857,15 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_delete_enrollment_group_by_param failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_create_or_update_enrollment_group failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_delete_enrollment_group_by_param(sc, TEST_GROUPID, TEST_ETAG_STAR);
+        int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -2687,17 +2875,85 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_FAIL)
 
     //cleanup
     prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_038: [ If prov_client, group_id or enrollment_ptr are NULL, prov_sc_get_enrollment_group shall return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_052: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_w_etag)
 {
     //arrange
-    ENROLLMENT_GROUP_HANDLE eg;
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(enrollmentGroup_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 15, 16, 21, 22, 23, 24, 27, 28, 29, 30, 31, 32 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_create_or_update_enrollment_group failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_create_or_update_enrollment_group(sc, &eg);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_034: [ If prov_client or id are NULL, prov_sc_delete_enrollment_group shall return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_ERROR_INPUT_NULL_PROV_SC)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_get_enrollment_group(NULL, TEST_GROUPID, &eg);
+    int res = prov_sc_delete_enrollment_group(NULL, TEST_ENROLLMENT_GROUP_HANDLE);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2706,16 +2962,18 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_PROV_SC)
     //cleanup
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_038: [ If prov_client, group_id or enrollment_ptr are NULL, prov_sc_get_enrollment_group shall return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_REG_ID)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_034: [ If prov_client or id are NULL, prov_sc_delete_enrollment_group shall return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_ERROR_INPUT_NULL_ENROLLMENT)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg;
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
+
     //act
-    int res = prov_sc_get_enrollment_group(sc, NULL, &eg);
+    int res = prov_sc_delete_enrollment_group(sc, NULL);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2725,74 +2983,91 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_REG_ID)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_038: [ If prov_client, group_id or enrollment_ptr are NULL, prov_sc_get_enrollment_group shall return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_ENROLLMENT)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_035: [ A 'DELETE' REST call shall be issued to delete the device enrollment group that matches enrollment from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_037: [ Upon a successful delete, prov_sc_delete_enrollment_group shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_GOLDEN_NO_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
+    //arrange
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //no etag
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
     //act
-    int res = prov_sc_get_enrollment_group(sc, TEST_GROUPID, NULL);
+    int res = prov_sc_delete_enrollment_group(sc, eg);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_039: [ A 'GET' REST call shall be issued to retrieve the device enrollment group with ID group_id from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_041: [ The data from the retrieved device enrollment group shall populate enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_043: [ Upon successful population of enrollment_ptr with the retrieved device enrollment group data, prov_sc_get_enrollment_group shall return 0 ] */
-TEST_FUNCTION(prov_sc_get_enrollment_group_GOLDEN)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_035: [ A 'DELETE' REST call shall be issued to delete the device enrollment group that matches enrollment from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_037: [ Upon a successful delete, prov_sc_delete_enrollment_group shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_GOLDEN_WITH_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = NULL;
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
+    //arrange
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
-    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_get_enrollment_group(sc, TEST_GROUPID, &eg);
+    int res = prov_sc_delete_enrollment_group(sc, eg);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_IS_NOT_NULL(eg);
 
     //cleanup
     prov_sc_destroy(sc);
     enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_040: [ If the 'GET' REST call fails, prov_sc_get_enrollment_group shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_042: [ If populating enrollment_ptr with retrieved data fails, prov_sc_get_enrollment_group shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_036: [ If the 'DELETE' REST call fails, prov_sc_delete_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    ENROLLMENT_GROUP_HANDLE eg = NULL;
+    ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
+    set_response_status(RESPONSE_OFF);
+
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(enrollmentGroup_getEtag(IGNORED_PTR_ARG)); //can fail, but for sake of this example, cannot
+    STRICT_EXPECTED_CALL(enrollmentGroup_getGroupId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
-    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -2800,7 +3075,7 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 12, 16, 18, 19, 21, 22, 24, 25, 26, 27 };
+    size_t calls_cannot_fail[] = { 0, 3, 4, 6, 10, 13, 14, 19, 21, 22, 23, 24, 25, 26 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -2814,13 +3089,15 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_get_enrollment_group failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_delete_enrollment_group failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_get_enrollment_group(sc, TEST_REGID, &eg);
+        int res = prov_sc_delete_enrollment_group(sc, eg);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -2834,14 +3111,13 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_024: [ If prov_client or reg_id are NULL, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_053: [ If prov_client or group_id are NULL, prov_sc_delete_enrollment_group_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_NULL_PROV_SC)
 {
     //arrange
-    DEVICE_REGISTRATION_STATE_HANDLE drs;
 
     //act
-    int res = prov_sc_get_device_registration_state(NULL, TEST_REGID, &drs);
+    int res = prov_sc_delete_enrollment_group_by_param(NULL, TEST_GROUPID, TEST_ETAG);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2850,16 +3126,15 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_PROV_SC)
     //cleanup
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_024: [ If prov_client or reg_id are NULL, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_REG_ID)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_053: [ If prov_client or group_id are NULL, prov_sc_delete_enrollment_group_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_NULL_REG_ID)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    DEVICE_REGISTRATION_STATE_HANDLE drs;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_get_device_registration_state(sc, NULL, &drs);
+    int res = prov_sc_delete_enrollment_group_by_param(sc, NULL, TEST_ETAG);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2869,74 +3144,81 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_REG_ID)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_024: [ If prov_client or reg_id are NULL, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_ENROLLMENT)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_054: [ If etag is given as NULL, it shall be ignored ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_055: [ A 'DELETE' REST call shall be issued to delete the enrollment group record with ID group_id, and optionally, etag from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_057: [ Upon a successful delete, prov_sc_delete_enrollment_group_by_param shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_GOLDEN_NO_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
-    //act
-    int res = prov_sc_get_enrollment_group(sc, TEST_REGID, NULL);
-
-    //assert
-    ASSERT_ARE_NOT_EQUAL(int, res, 0);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    //arrange
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE); // <- this NO_ETAG flag is what proves Requirement 054 - if etag wasn't ignored, actual calls will not line up with expected
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_delete_enrollment_group_by_param(sc, TEST_REGID, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_025: [ A 'GET' REST call shall be issued to retrieve the registration state of a device with ID reg_id from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_027: [ The data from the retrieved device registration state shall populate reg_state ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_029: [ Upon successful population of reg_state with the retrieved device registration state data, prov_sc_get_device_registration_state shall return 0 ] */
-TEST_FUNCTION(prov_sc_get_device_registration_state_GOLDEN)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_055: [ A 'DELETE' REST call shall be issued to delete the enrollment group record with ID group_id, and optionally, etag from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_057: [ Upon a successful delete, prov_sc_delete_enrollment_group_by_param shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_GOLDEN_WITH_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    DEVICE_REGISTRATION_STATE_HANDLE drs = NULL;
+    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
+    //arrange
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
-    STRICT_EXPECTED_CALL(deviceRegistrationState_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_get_device_registration_state(sc, TEST_REGID, &drs);
+    int res = prov_sc_delete_enrollment_group_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_IS_NOT_NULL(drs);
 
     //cleanup
     prov_sc_destroy(sc);
-    deviceRegistrationState_destroy(drs);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_026: [ If the 'GET' REST call fails, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_028: [ If populating reg_state with retrieved data fails, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_056: [ If the 'DELETE' REST call fails, prov_sc_delete_enrollment_group_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_FAIL)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    DEVICE_REGISTRATION_STATE_HANDLE drs = NULL;
+    set_response_status(RESPONSE_OFF);
+
     umock_c_reset_all_calls();
 
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
-    STRICT_EXPECTED_CALL(deviceRegistrationState_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -2944,7 +3226,7 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 12, 16, 18, 19, 21, 22, 24, 25, 26, 27 };
+    size_t calls_cannot_fail[] = { 1, 2, 4, 8, 11, 12, 17, 19, 20, 21, 22, 23, 24 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -2958,13 +3240,15 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_get_device_registration_state failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_delete_enrollment_group_by_param failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_get_device_registration_state(sc, TEST_REGID, &drs);
+        int res = prov_sc_delete_enrollment_group_by_param(sc, TEST_GROUPID, TEST_ETAG_STAR);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -2974,19 +3258,17 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
 
     //cleanup
     prov_sc_destroy(sc);
-    deviceRegistrationState_destroy(drs);
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_020: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_038: [ If prov_client, group_id or enrollment_ptr are NULL, prov_sc_get_enrollment_group shall return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_PROV_SC)
 {
     //arrange
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
+    ENROLLMENT_GROUP_HANDLE eg;
 
     //act
-    int res = prov_sc_delete_device_registration_state(NULL, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+    int res = prov_sc_get_enrollment_group(NULL, TEST_GROUPID, &eg);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -2995,18 +3277,16 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_ERROR_INPUT_NULL_PROV_SC)
     //cleanup
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_020: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_ERROR_INPUT_NULL_ENROLLMENT)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_038: [ If prov_client, group_id or enrollment_ptr are NULL, prov_sc_get_enrollment_group shall return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_REG_ID)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    ENROLLMENT_GROUP_HANDLE eg;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
-
     //act
-    int res = prov_sc_delete_device_registration_state(sc, NULL);
+    int res = prov_sc_get_enrollment_group(sc, NULL, &eg);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -3016,86 +3296,74 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_ERROR_INPUT_NULL_ENROLLME
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_021: [ A 'DELETE' REST call shall be issued to delete the registration state of a device with ID reg_id from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_023: [ Upon a successful delete, prov_sc_delete_device_registration_state shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_GOLDEN_NO_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_038: [ If prov_client, group_id or enrollment_ptr are NULL, prov_sc_get_enrollment_group shall return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_enrollment_group_ERROR_INPUT_NULL_ENROLLMENT)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
-    //arrange
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //no etag
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
     //act
-    int res = prov_sc_delete_device_registration_state(sc, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+    int res = prov_sc_get_enrollment_group(sc, TEST_GROUPID, NULL);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_021: [ A 'DELETE' REST call shall be issued to delete the registration state of a device with ID reg_id from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_023: [ Upon a successful delete, prov_sc_delete_device_registration_state shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_GOLDEN_WITH_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_039: [ A 'GET' REST call shall be issued to retrieve the device enrollment group with ID group_id from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_041: [ The data from the retrieved device enrollment group shall populate enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_043: [ Upon successful population of enrollment_ptr with the retrieved device enrollment group data, prov_sc_get_enrollment_group shall return 0 ] */
+TEST_FUNCTION(prov_sc_get_enrollment_group_GOLDEN)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    ENROLLMENT_GROUP_HANDLE eg = NULL;
     umock_c_reset_all_calls();
 
-    //arrange
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_delete_device_registration_state(sc, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+    int res = prov_sc_get_enrollment_group(sc, TEST_GROUPID, &eg);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(eg);
 
     //cleanup
     prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_022: [ If the 'DELETE' REST call fails, prov_sc_delete_device_registration_state shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_040: [ If the 'GET' REST call fails, prov_sc_get_enrollment_group shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_042: [ If populating enrollment_ptr with retrieved data fails, prov_sc_get_enrollment_group shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
-
+    ENROLLMENT_GROUP_HANDLE eg = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG)); //can fail, but for sake of this example, cannot
-    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -3103,7 +3371,7 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 0, 3, 4, 6, 10, 13, 14, 18, 20, 21, 22, 23, 24, 25, 26, 27 };
+    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 12, 17, 19, 20, 23, 24, 25, 26 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -3117,13 +3385,15 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_delete_device_registration_state failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_get_enrollment_group failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_delete_device_registration_state(sc, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+        int res = prov_sc_get_enrollment_group(sc, TEST_REGID, &eg);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -3133,16 +3403,18 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
 
     //cleanup
     prov_sc_destroy(sc);
+    enrollmentGroup_destroy(eg);
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_058: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_024: [ If prov_client or reg_id are NULL, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_PROV_SC)
 {
     //arrange
+    DEVICE_REGISTRATION_STATE_HANDLE drs;
 
     //act
-    int res = prov_sc_delete_device_registration_state_by_param(NULL, TEST_REGID, TEST_ETAG);
+    int res = prov_sc_get_device_registration_state(NULL, TEST_REGID, &drs);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -3151,15 +3423,16 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_NULL_PROV_SC)
     //cleanup
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_058: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_NULL_REG_ID)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_024: [ If prov_client or reg_id are NULL, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_REG_ID)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    DEVICE_REGISTRATION_STATE_HANDLE drs;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_delete_device_registration_state_by_param(sc, NULL, TEST_ETAG);
+    int res = prov_sc_get_device_registration_state(sc, NULL, &drs);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -3169,81 +3442,74 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_NULL_REG_ID)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_059: [ If etag is given as NULL, it shall be ignored ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_060: [ A 'DELETE' REST call shall be issued to delete the device registration state record with ID reg_id, and optionally, etag from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_062: [ Upon a successful delete, prov_sc_delete_device_registration_state_by_param shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_GOLDEN_NO_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_024: [ If prov_client or reg_id are NULL, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_device_registration_state_ERROR_INPUT_NULL_ENROLLMENT)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
     umock_c_reset_all_calls();
 
-    //arrange
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE); // <- this NO_ETAG flag is what proves Requirement 054 - if etag wasn't ignored, actual calls will not line up with expected
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-
     //act
-    int res = prov_sc_delete_device_registration_state_by_param(sc, TEST_REGID, NULL);
+    int res = prov_sc_get_enrollment_group(sc, TEST_REGID, NULL);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_060: [ A 'DELETE' REST call shall be issued to delete the device registration state record with ID reg_id, and optionally, etag from the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_062: [ Upon a successful delete, prov_sc_delete_device_registration_state_by_param shall return 0 ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_GOLDEN_WITH_ETAG)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_025: [ A 'GET' REST call shall be issued to retrieve the registration state of a device with ID reg_id from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_027: [ The data from the retrieved device registration state shall populate reg_state ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_029: [ Upon successful population of reg_state with the retrieved device registration state data, prov_sc_get_device_registration_state shall return 0 ] */
+TEST_FUNCTION(prov_sc_get_device_registration_state_GOLDEN)
 {
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
+    DEVICE_REGISTRATION_STATE_HANDLE drs = NULL;
     umock_c_reset_all_calls();
 
-    //arrange
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
+    STRICT_EXPECTED_CALL(deviceRegistrationState_deserializeFromJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_delete_device_registration_state_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+    int res = prov_sc_get_device_registration_state(sc, TEST_REGID, &drs);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(drs);
 
     //cleanup
     prov_sc_destroy(sc);
+    deviceRegistrationState_destroy(drs);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_061: [ If the 'DELETE' REST call fails, prov_sc_delete_device_registration_state_by_param shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_026: [ If the 'GET' REST call fails, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_028: [ If populating reg_state with retrieved data fails, prov_sc_get_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    set_response_status(RESPONSE_OFF);
-
+    DEVICE_REGISTRATION_STATE_HANDLE drs = NULL;
     umock_c_reset_all_calls();
 
     expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
+    STRICT_EXPECTED_CALL(deviceRegistrationState_deserializeFromJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -3251,7 +3517,7 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 8, 11, 12, 16, 18, 19, 20, 21, 22, 23, 24, 25 };
+    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 12, 17, 19, 20, 23, 24, 25, 26 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -3265,13 +3531,15 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_delete_device_registration_state_by_param failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_get_device_registration_state failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_delete_device_registration_state_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+        int res = prov_sc_get_device_registration_state(sc, TEST_REGID, &drs);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -3281,164 +3549,1306 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
 
     //cleanup
     prov_sc_destroy(sc);
+    deviceRegistrationState_destroy(drs);
     umock_c_negative_tests_deinit();
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_070: [ If prov_client, bulk_op or bulk_res_ptr are NULL, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_NULL_prov)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_020: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_ERROR_INPUT_NULL_PROV_SC)
 {
     //arrange
-    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = {TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2};
-    PROVISIONING_BULK_OPERATION bulkop;
-    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
-    bulkop.enrollments.ie = ie_arr;
-    bulkop.mode = BULK_OP_CREATE;
-    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
-    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_run_individual_enrollment_bulk_operation(NULL, &bulkop, &bulk_res);
+    int res = prov_sc_delete_device_registration_state(NULL, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
 
     //assert
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
 
     //cleanup
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_070: [ If prov_client, bulk_op or bulk_res_ptr are NULL, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_NULL_bulkop)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_020: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_ERROR_INPUT_NULL_ENROLLMENT)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
+
     //act
-    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, NULL, &bulk_res);
+    int res = prov_sc_delete_device_registration_state(sc, NULL);
 
     //assert
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_070: [ If prov_client, bulk_op or bulk_res_ptr are NULL, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_NULL_bulk_res)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_021: [ A 'DELETE' REST call shall be issued to delete the registration state of a device with ID reg_id from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_023: [ Upon a successful delete, prov_sc_delete_device_registration_state shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_GOLDEN_NO_ETAG)
 {
-    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
-    PROVISIONING_BULK_OPERATION bulkop;
-    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
-    bulkop.enrollments.ie = ie_arr;
-    bulkop.mode = BULK_OP_CREATE;
-    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    set_response_status(RESPONSE_OFF);
+    umock_c_reset_all_calls();
+
+    //arrange
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //no etag
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_delete_device_registration_state(sc, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_021: [ A 'DELETE' REST call shall be issued to delete the registration state of a device with ID reg_id from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_023: [ Upon a successful delete, prov_sc_delete_device_registration_state shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_GOLDEN_WITH_ETAG)
+{
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    set_response_status(RESPONSE_OFF);
+    umock_c_reset_all_calls();
+
+    //arrange
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_delete_device_registration_state(sc, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_022: [ If the 'DELETE' REST call fails, prov_sc_delete_device_registration_state shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    set_response_status(RESPONSE_OFF);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getEtag(IGNORED_PTR_ARG)); //can fail, but for sake of this example, cannot
+    STRICT_EXPECTED_CALL(deviceRegistrationState_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 0, 3, 4, 6, 10, 13, 14, 19, 21, 22, 23, 24, 25, 26 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_delete_device_registration_state failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_delete_device_registration_state(sc, TEST_DEVICE_REGISTRATION_STATE_HANDLE);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_058: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_NULL_PROV_SC)
+{
+    //arrange
+
+    //act
+    int res = prov_sc_delete_device_registration_state_by_param(NULL, TEST_REGID, TEST_ETAG);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_058: [ If prov_client or reg_id are NULL, prov_sc_delete_device_registration_state_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_NULL_REG_ID)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_delete_device_registration_state_by_param(sc, NULL, TEST_ETAG);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_059: [ If etag is given as NULL, it shall be ignored ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_060: [ A 'DELETE' REST call shall be issued to delete the device registration state record with ID reg_id, and optionally, etag from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_062: [ Upon a successful delete, prov_sc_delete_device_registration_state_by_param shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_GOLDEN_NO_ETAG)
+{
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    set_response_status(RESPONSE_OFF);
+    umock_c_reset_all_calls();
+
+    //arrange
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_DELETE); // <- this NO_ETAG flag is what proves Requirement 054 - if etag wasn't ignored, actual calls will not line up with expected
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_delete_device_registration_state_by_param(sc, TEST_REGID, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_060: [ A 'DELETE' REST call shall be issued to delete the device registration state record with ID reg_id, and optionally, etag from the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_062: [ Upon a successful delete, prov_sc_delete_device_registration_state_by_param shall return 0 ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_GOLDEN_WITH_ETAG)
+{
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    set_response_status(RESPONSE_OFF);
+    umock_c_reset_all_calls();
+
+    //arrange
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_delete_device_registration_state_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_061: [ If the 'DELETE' REST call fails, prov_sc_delete_device_registration_state_by_param shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    set_response_status(RESPONSE_OFF);
+
+    umock_c_reset_all_calls();
+
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_DELETE);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_DELETE, NO_RESPONSE);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 1, 2, 4, 8, 11, 12, 17, 19, 20, 21, 22, 23, 24 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_delete_device_registration_state_by_param failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_delete_device_registration_state_by_param(sc, TEST_REGID, TEST_ETAG_STAR);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_070: [ If prov_client, bulk_op or bulk_res_ptr are NULL, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_NULL_prov)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = {TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2};
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(NULL, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+
+    //cleanup
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_070: [ If prov_client, bulk_op or bulk_res_ptr are NULL, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_NULL_bulkop)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, NULL, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_070: [ If prov_client, bulk_op or bulk_res_ptr are NULL, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_NULL_bulk_res)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_071: [ If bulk_op has invalid values, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_invalid_bulkop_version)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = 47474747;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_072: [ A 'POST' REST call shall be issued to run the bulk operation on the Provisoning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_074: [ The data from the bulk operation response shall populate bulk_res_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_076: [ Upon successful population of bulk_res_ptr, prov_sc_run_individual_enrollment_bulk_operation shall return 0 ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_SUCCESS)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(false);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
+    STRICT_EXPECTED_CALL(bulkOperationResult_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_073: [ If the 'POST' REST call fails, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_138: [ The 'POST' of prov_sc_run_individual_enrollment_bulk_operation is not idempotent, it shall only be sent once more as described in SRS_PROVISIONING_SERVICE_CLIENT_22_104 if the connection failed before the request was passed to uhttp_client_execute_request ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_does_not_resend_request_that_was_sent)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    umock_c_reset_all_calls();
+
+    g_service_drops_request = true;
+
+    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(false);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //the connection failed after the request was sent
+    expected_calls_disconnect_from_service();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(bulk_res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_073: [ If the 'POST' REST call fails, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_075: [ If populating bulk_res_ptr with the retrieved data fails, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(false);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE); //----------------->20?
+    STRICT_EXPECTED_CALL(bulkOperationResult_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 3, 8, 10, 11, 16, 18, 19, 22, 23, 24, 25, 26 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_run_individual_enrollment_bulk_op_ERROR failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_111: [ If prov_client, bulk_op or bulk_res_ptr are NULL, or bulk_op has no enrollments or an invalid version, prov_sc_run_individual_enrollment_bulk_operation_chunked shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_NULL_input)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res_null_prov = prov_sc_run_individual_enrollment_bulk_operation_chunked(NULL, &bulkop, &bulk_res);
+    int res_null_bulkop = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, NULL, &bulk_res);
+    int res_null_bulk_res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_prov);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_bulkop);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_null_bulk_res);
+    ASSERT_IS_NULL(bulk_res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_111: [ If prov_client, bulk_op or bulk_res_ptr are NULL, or bulk_op has no enrollments or an invalid version, prov_sc_run_individual_enrollment_bulk_operation_chunked shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_invalid_bulkop)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 0;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res_no_enrollments = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+    bulkop.num_enrollments = 2;
+    bulkop.version = 2;
+    int res_bad_version = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_no_enrollments);
+    ASSERT_ARE_NOT_EQUAL(int, 0, res_bad_version);
+    ASSERT_IS_NULL(bulk_res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_112: [ The enrollments of bulk_op shall be sent in order, in 'POST' REST calls of at most 10 enrollments each ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_114: [ The body of every request shall be serialized into a buffer reused by the following requests on the same connection ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_115: [ The results of all the requests shall be merged into one bulk operation result ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_118: [ Upon success, bulk_res_ptr shall be set to the merged result and prov_sc_run_individual_enrollment_bulk_operation_chunked shall return 0 ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_SUCCESS)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(false);
+    STRICT_EXPECTED_CALL(bulkOperationResult_create());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_bulk_chunk(true);
+    expected_calls_complete_bulk_chunk();
+    expected_calls_end_bulk_operation();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_112: [ The enrollments of bulk_op shall be sent in order, in 'POST' REST calls of at most 10 enrollments each ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_113: [ Up to the number of requests set with prov_sc_set_bulk_operation_requests_in_flight shall be in flight at the same time, each on its own HTTP connection. The connections shall be kept open for the next bulk operation ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_114: [ The body of every request shall be serialized into a buffer reused by the following requests on the same connection ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_SUCCESS_several_chunks)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[12];
+    for (size_t i = 0; i < 12; i++)
+    {
+        ie_arr[i] = TEST_INDIVIDUAL_ENROLLMENT_HANDLE;
+    }
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 12;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_set_bulk_operation_requests_in_flight(sc, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(false);
+    STRICT_EXPECTED_CALL(bulkOperationResult_create());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_bulk_chunk(true);
+    expected_calls_complete_bulk_chunk();
+    expected_calls_start_bulk_chunk(false); //the connection of the first chunk is reused
+    expected_calls_complete_bulk_chunk();
+    expected_calls_end_bulk_operation();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_116: [ If a request fails or times out, every enrollment of that request shall be added to the errors of the result with the HTTP status of the reply, 0 if there was none, and the request shall not be retried beyond what is described in SRS_PROVISIONING_SERVICE_CLIENT_22_104 ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_137: [ The timeout of every request in flight shall be checked on every pass over the requests, including the passes where another request made progress ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_timeout_reports_enrollments)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_set_request_timeout(sc, 2);
+    umock_c_reset_all_calls();
+
+    g_service_replies = false;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(false);
+    STRICT_EXPECTED_CALL(bulkOperationResult_create());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_bulk_chunk(true);
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //checked on the pass that sent the request, without sleeping
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //2 ms elapsed
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(TEST_INDIVIDUAL_ENROLLMENT_HANDLE));
+    STRICT_EXPECTED_CALL(bulkOperationResult_addError(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(TEST_INDIVIDUAL_ENROLLMENT_HANDLE2));
+    STRICT_EXPECTED_CALL(bulkOperationResult_addError(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_disconnect_from_service();
+    expected_calls_end_bulk_operation();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 2, bulk_res->num_errors);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_136: [ A request shall only be sent once more as described in SRS_PROVISIONING_SERVICE_CLIENT_22_104 if its connection failed before the request was passed to uhttp_client_execute_request. A request that may have reached the Provisioning Service without a reply shall not be sent again, its enrollments shall be reported as described in SRS_PROVISIONING_SERVICE_CLIENT_22_116 and may or may not have been applied ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_reconnects_when_service_closed_connection)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res2 = NULL;
+    (void)prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+    umock_c_reset_all_calls();
+
+    g_service_closes_connection = true;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(false);
+    STRICT_EXPECTED_CALL(bulkOperationResult_create());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_bulk_chunk(false);
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //the service closed the connection, the chunk was not sent
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_disconnect_from_service();
+    expected_calls_connect_to_service();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    expected_calls_complete_bulk_chunk();
+    expected_calls_end_bulk_operation();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res2);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res2);
+    ASSERT_IS_TRUE(bulk_res2->is_successful);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(bulk_res2);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_136: [ A request shall only be sent once more as described in SRS_PROVISIONING_SERVICE_CLIENT_22_104 if its connection failed before the request was passed to uhttp_client_execute_request. A request that may have reached the Provisioning Service without a reply shall not be sent again, its enrollments shall be reported as described in SRS_PROVISIONING_SERVICE_CLIENT_22_116 and may or may not have been applied ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_does_not_resend_request_that_was_sent)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res2 = NULL;
+    (void)prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+    umock_c_reset_all_calls();
+
+    g_service_drops_request = true;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(false);
+    STRICT_EXPECTED_CALL(bulkOperationResult_create());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_bulk_chunk(false);
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //the connection failed after the chunk was sent
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(TEST_INDIVIDUAL_ENROLLMENT_HANDLE));
+    STRICT_EXPECTED_CALL(bulkOperationResult_addError(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(TEST_INDIVIDUAL_ENROLLMENT_HANDLE2));
+    STRICT_EXPECTED_CALL(bulkOperationResult_addError(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_disconnect_from_service();
+    expected_calls_end_bulk_operation();
+
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res2);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res2);
+    ASSERT_IS_FALSE(bulk_res2->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 2, bulk_res2->num_errors);
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(bulk_res2);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_117: [ If allocating, serializing or merging fails, prov_sc_run_individual_enrollment_bulk_operation_chunked shall close the connections with a request in flight, fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_chunked_ERROR)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(false);
+    STRICT_EXPECTED_CALL(bulkOperationResult_create());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_start_bulk_chunk(true);
+    expected_calls_complete_bulk_chunk();
+    expected_calls_end_bulk_operation();
+
+    umock_c_negative_tests_snapshot();
+
+    //the connection, the request and the reply only fail their chunk, whose enrollments are reported in the result
+    size_t calls_cannot_fail[] = { 3, 4, 6, 11, 13, 16, 17, 18, 19, 20, 22, 23, 24, 25, 27, 28, 29, 30, 31, 32 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, num_cannot_fail) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_run_individual_enrollment_bulk_operation_chunked_ERROR failure in test %zu/%zu", test_num, test_max);
+
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_run_individual_enrollment_bulk_operation_chunked(sc, &bulkop, &bulk_res);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+        ASSERT_IS_NULL_WITH_MSG(bulk_res, tmp_msg);
+
+        g_uhttp_client_dowork_call_count = 0;
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    umock_c_negative_tests_deinit();
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_prov_client)
+{
+    //arrange
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(NULL, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_spec)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, NULL, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_cont_token_ptr)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, NULL);
+    int res = prov_sc_query_individual_enrollment(sc, &qs, NULL, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(query_resp);
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_071: [ If bulk_op has invalid values, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_invalid_bulkop_version)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_resp_ptr)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
-    PROVISIONING_BULK_OPERATION bulkop;
-    bulkop.version = 47474747;
-    bulkop.enrollments.ie = ie_arr;
-    bulkop.mode = BULK_OP_CREATE;
-    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
-    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token = NULL;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, NULL);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_072: [ A 'POST' REST call shall be issued to run the bulk operation on the Provisoning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_074: [ The data from the bulk operation response shall populate bulk_res_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_076: [ Upon successful population of bulk_res_ptr, prov_sc_run_individual_enrollment_bulk_operation shall return 0 ]*/
-TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_SUCCESS)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_078: [ If query_spec has invalid values, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_invalid_version)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
-    PROVISIONING_BULK_OPERATION bulkop;
-    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
-    bulkop.enrollments.ie = ie_arr;
-    bulkop.mode = BULK_OP_CREATE;
-    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
-    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = 47474;
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG));
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
     expected_calls_construct_registration_path(false);
     expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_add_query_headers(false, false);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
-    STRICT_EXPECTED_CALL(bulkOperationResult_deserializeFromJson(IGNORED_PTR_ARG));
+    //response headers
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    //end response headers
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NOT_NULL(query_resp);
+
+    //cleanup
+    free(cont_token);
+    prov_sc_destroy(sc);
+    queryResponse_free(query_resp);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_no_given_token_w_token_return)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
+    expected_calls_construct_registration_path(false);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    expected_calls_add_query_headers(true, false);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
+    //response headers
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN); //cannot fail
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    //end response headers
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(cont_token);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_CONT_TOKEN, cont_token);
+    ASSERT_IS_NOT_NULL(query_resp);
+
+    //cleanup
+    free(cont_token);
+    prov_sc_destroy(sc);
+    queryResponse_free(query_resp);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_no_token_return)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token;
+    mallocAndStrcpy_s(&cont_token, TEST_CONT_TOKEN);
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
+    expected_calls_construct_registration_path(false);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    expected_calls_add_query_headers(true, true);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
+    //response headers
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    //end response headers
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NOT_NULL(query_resp);
+
+    //cleanup
+    free(cont_token);
+    prov_sc_destroy(sc);
+    queryResponse_free(query_resp);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_token_return)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token;
+    mallocAndStrcpy_s(&cont_token, TEST_CONT_TOKEN);
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
+    expected_calls_construct_registration_path(false);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
+    expected_calls_add_query_headers(true, true);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
+    //response headers
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot fail
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    //end response headers
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, res);
-    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_CONT_TOKEN2, cont_token);
+    ASSERT_IS_NOT_NULL(query_resp);
 
     //cleanup
+    free(cont_token);
     prov_sc_destroy(sc);
-    bulkOperationResult_free(bulk_res);
+    queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_073: [ If the 'POST' REST call fails, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_075: [ If populating bulk_res_ptr with the retrieved data fails, prov_sc_run_individual_enrollment_bulk_operation shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
+/*---Note that this failure test covers all failures from other cases by virtue of making all possible calls---/*
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_080: [ If the 'POST' REST call fails, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_082: [ If populating query_resp_ptr with the retrieved data fails, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_token_return_ERROR)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
-    PROVISIONING_BULK_OPERATION bulkop;
-    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
-    bulkop.enrollments.ie = ie_arr;
-    bulkop.mode = BULK_OP_CREATE;
-    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
-    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token;
+    mallocAndStrcpy_s(&cont_token, TEST_CONT_TOKEN);
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
     expected_calls_construct_registration_path(false);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE); //----------------->20?
-    STRICT_EXPECTED_CALL(bulkOperationResult_deserializeFromJson(IGNORED_PTR_ARG));
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST); //10
+    expected_calls_add_query_headers(true, true); //12
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
+    //response headers
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot "fail"
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT); //cannot "fail"
+    //end response headers
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -3447,27 +4857,28 @@ TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 3, 8, 10, 11, 15, 17, 18, 20, 21, 23, 24, 25, 26, 27 };
-    size_t count = umock_c_negative_tests_call_count();
+    size_t calls_cannot_fail[] = { 3, 8, 10, 13, 18, 20, 23, 25, 28, 29, 30, 31, 32, 33 };
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
-
+    size_t count = umock_c_negative_tests_call_count();
     size_t test_num = 0;
     size_t test_max = count - num_cannot_fail;
 
     for (size_t index = 0; index < count; index++)
     {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+        if (should_skip_index(index, calls_cannot_fail, num_cannot_fail) != 0)
             continue;
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_run_individual_enrollment_bulk_op_ERROR failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_query_individual_enrollment_success_paging_given_token_w_token_return_ERROR failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+        int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -3476,12 +4887,12 @@ TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
     }
 
     //cleanup
+    free(cont_token);
     prov_sc_destroy(sc);
-    umock_c_negative_tests_deinit();
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_prov_client)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_prov_client)
 {
     //arrange
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
@@ -3494,7 +4905,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_prov_client)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(NULL, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(NULL, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3505,8 +4916,8 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_prov_client)
     //cleanup
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_spec)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_spec)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3516,7 +4927,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_spec)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, NULL, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, NULL, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3528,8 +4939,8 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_spec)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_cont_token_ptr)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_cont_token_ptr)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3542,7 +4953,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_cont_token_ptr)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, NULL, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, &qs, NULL, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3553,8 +4964,8 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_cont_token_ptr)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_resp_ptr)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_resp_ptr)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3567,7 +4978,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_resp_ptr)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, NULL);
+    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, NULL);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3578,8 +4989,8 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_resp_ptr)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_078: [ If query_spec has invalid values, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_invalid_version)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_086: [ If query_spec has invalid values, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_invalid_version)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3593,7 +5004,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_invalid_version)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3605,11 +5016,11 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_invalid_version)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_success_full_results)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3630,10 +5041,10 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -3642,7 +5053,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3656,11 +5067,11 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
     queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_no_given_token_w_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_no_given_token_w_token_return)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3682,10 +5093,10 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_no_given_token_
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN); //cannot fail
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -3694,7 +5105,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_no_given_token_
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3709,11 +5120,11 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_no_given_token_
     queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_no_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_no_token_return)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3735,10 +5146,10 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_no_
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -3747,7 +5158,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_no_
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3761,11 +5172,11 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_no_
     queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_return)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3788,10 +5199,10 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot fail
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -3800,7 +5211,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3814,10 +5225,10 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
     queryResponse_free(query_resp);
 }
 
-/*---Note that this failure test covers all failures from other cases by virtue of making all possible calls---/*
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_080: [ If the 'POST' REST call fails, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_082: [ If populating query_resp_ptr with the retrieved data fails, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_token_return_ERROR)
+/*---Note that this failure test covers all failures from other cases by virtue of making all possible calls---*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_088: [ If the 'POST' REST call fails, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_090: [ If populating query_resp_ptr with the retrieved data fails, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_return_ERROR)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
@@ -3843,10 +5254,10 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot "fail"
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT); //cannot "fail"
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP); //cannot "fail"
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT));
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP));
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -3856,7 +5267,7 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 3, 8, 10, 13, 17, 19, 22, 23, 24, 26, 29, 30, 31, 32, 33, 34 };
+    size_t calls_cannot_fail[] = { 3, 8, 10, 13, 18, 20, 23, 25, 28, 29, 30, 31, 32, 33 };
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
     size_t count = umock_c_negative_tests_call_count();
     size_t test_num = 0;
@@ -3869,13 +5280,15 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_query_individual_enrollment_success_paging_given_token_w_token_return_ERROR failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_query_enrollment_group_success_paging_given_token_w_token_return_ERROR failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+        int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -3888,13 +5301,13 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_prov_client)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_prov_client)
 {
     //arrange
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token = NULL;
@@ -3902,7 +5315,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_prov_client)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_enrollment_group(NULL, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(NULL, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3913,8 +5326,8 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_prov_client)
     //cleanup
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_spec)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_query_spec)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -3924,7 +5337,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_spec)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, NULL, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, NULL, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3936,21 +5349,21 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_spec)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_cont_token_ptr)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_cont_token_ptr)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, NULL, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, &qs, NULL, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3961,21 +5374,21 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_cont_token_ptr)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_085: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_resp_ptr)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_query_resp_ptr)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token = NULL;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, NULL);
+    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, NULL);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -3986,14 +5399,14 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_NULL_query_resp_ptr)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_086: [ If query_spec has invalid values, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_invalid_version)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_094: [ If query_spec has invalid values, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_invalid_version)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = 47474;
 
     char* cont_token = NULL;
@@ -4001,7 +5414,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_invalid_version)
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4013,36 +5426,35 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_invalid_version)
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_success_full_results)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_success_full_results)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token = NULL;
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
-    expected_calls_construct_registration_path(false);
+    expected_calls_construct_registration_path(true);
     expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
     expected_calls_add_query_headers(false, false);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
@@ -4050,7 +5462,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_full_results)
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4064,25 +5476,24 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_full_results)
     queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_no_given_token_w_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_no_given_token_w_token_return)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token = NULL;
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
-    expected_calls_construct_registration_path(false);
+    expected_calls_construct_registration_path(true);
     expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
     expected_calls_add_query_headers(true, false);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
@@ -4090,10 +5501,10 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_no_given_token_w_tok
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN); //cannot fail
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -4102,7 +5513,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_no_given_token_w_tok
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4117,17 +5528,17 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_no_given_token_w_tok
     queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_no_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token_no_token_return)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token;
@@ -4135,18 +5546,17 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_no_token
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
-    expected_calls_construct_registration_path(false);
+    expected_calls_construct_registration_path(true);
     expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
     expected_calls_add_query_headers(true, true);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -4155,7 +5565,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_no_token
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4169,17 +5579,17 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_no_token
     queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_087: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_089: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_091: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_092: [ Upon success, prov_sc_query_enrollment_group shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token_w_token_return)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token;
@@ -4187,8 +5597,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
-    expected_calls_construct_registration_path(false);
+    expected_calls_construct_registration_path(true);
     expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
     expected_calls_add_query_headers(true, true);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
@@ -4196,10 +5605,10 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot fail
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -4208,7 +5617,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
     //act
-    int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -4222,10 +5631,10 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     queryResponse_free(query_resp);
 }
 
-/*---Note that this failure test covers all failures from other cases by virtue of making all possible calls---*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_088: [ If the 'POST' REST call fails, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_090: [ If populating query_resp_ptr with the retrieved data fails, prov_sc_query_enrollment_group shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_return_ERROR)
+/*---Note that this failure test covers all failures from other cases by virtue of making all possible calls--/*
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_096: [ If the 'POST' REST call fails, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_098: [ If populating query_resp_ptr with the retrieved data fails, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token_w_token_return_ERROR)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
@@ -4234,7 +5643,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.query_string = TEST_QUERY_STRING;
+    qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token;
@@ -4242,19 +5651,18 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(&qs));
-    expected_calls_construct_registration_path(false);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST); //10
-    expected_calls_add_query_headers(true, true); //12
+    expected_calls_construct_registration_path(true);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST); //12
+    expected_calls_add_query_headers(true, true); //14
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
     //response headers
     STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot "fail"
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP); //cannot "fail"
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE); //cannot "fail"
     //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP));
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_ENROLLMENT_GROUP));
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE));
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
@@ -4264,7 +5672,7 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 3, 8, 10, 13, 17, 19, 22, 23, 24, 26, 29, 30, 31, 32, 33, 34};
+    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 14, 19, 21, 24, 25, 26, 29, 30, 31, 32, 33, 34 };
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
     size_t count = umock_c_negative_tests_call_count();
     size_t test_num = 0;
@@ -4277,13 +5685,15 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_query_enrollment_group_success_paging_given_token_w_token_return_ERROR failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_query_device_registration_state_success_paging_given_token_w_token_return_ERROR failure in test %zu/%zu", test_num, test_max);
 
+        //drops the connection the previous iteration kept open
+        prov_sc_set_trace(sc, TRACING_STATUS_OFF);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_query_enrollment_group(sc, &qs, &cont_token, &query_resp);
+        int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
@@ -4296,289 +5706,521 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_prov_client)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_119: [ If prov_client or query_spec is NULL, or query_spec has invalid values, the query iterator create functions shall fail and return NULL ]*/
+TEST_FUNCTION(prov_sc_create_individual_enrollment_query_iterator_NULL_prov_client)
 {
     //arrange
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(NULL, &qs);
+
+    //assert
+    ASSERT_IS_NULL(it);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_119: [ If prov_client or query_spec is NULL, or query_spec has invalid values, the query iterator create functions shall fail and return NULL ]*/
+TEST_FUNCTION(prov_sc_create_individual_enrollment_query_iterator_NULL_query_spec)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, NULL);
+
+    //assert
+    ASSERT_IS_NULL(it);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_119: [ If prov_client or query_spec is NULL, or query_spec has invalid values, the query iterator create functions shall fail and return NULL ]*/
+TEST_FUNCTION(prov_sc_create_individual_enrollment_query_iterator_invalid_version)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = 0;
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+
+    //assert
+    ASSERT_IS_NULL(it);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_120: [ The query specification shall be serialized (when it has a query_string) and the registration path built once, when the iterator is created ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_121: [ The iterator shall use a connection of its own, and shall send the 'POST' request for the first page when it is created ]*/
+TEST_FUNCTION(prov_sc_create_individual_enrollment_query_iterator_GOLDEN)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
+
+    expected_calls_create_query_iterator(true);
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+
+    //assert
+    ASSERT_IS_NOT_NULL(it);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_query_iterator_destroy(it);
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_120: [ The query specification shall be serialized (when it has a query_string) and the registration path built once, when the iterator is created ]*/
+TEST_FUNCTION(prov_sc_create_device_registration_state_query_iterator_GOLDEN)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
     qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
 
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    expected_calls_create_query_iterator(false);
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_device_registration_state_query_iterator(sc, &qs);
+
+    //assert
+    ASSERT_IS_NOT_NULL(it);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_query_iterator_destroy(it);
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_133: [ If iterator is NULL, prov_sc_query_iterator_destroy shall do nothing ]*/
+TEST_FUNCTION(prov_sc_query_iterator_destroy_NULL)
+{
+    //arrange
+
+    //act
+    prov_sc_query_iterator_destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_134: [ prov_sc_query_iterator_destroy shall close the connection of the iterator, abandoning the page in flight, and free all the memory of the iterator ]*/
+TEST_FUNCTION(prov_sc_query_iterator_destroy_GOLDEN)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //response
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //response headers
+    expected_calls_disconnect_from_service();
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //request headers
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //content
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //continuation token
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //page
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //iterator
+
     //act
-    int res = prov_sc_query_device_registration_state(NULL, &qs, &cont_token, &query_resp);
+    prov_sc_query_iterator_destroy(it);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_123: [ If iterator or the handle pointer is NULL, or the iterator was created for another type of record, the next functions shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_NULL_iterator)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+
+    //act
+    int res = prov_sc_query_iterator_next_individual_enrollment(NULL, &ie);
+
+    //assert
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NULL(query_resp);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_query_spec)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_123: [ If iterator or the handle pointer is NULL, or the iterator was created for another type of record, the next functions shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_NULL_handle_ptr)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+    umock_c_reset_all_calls();
 
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    //act
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_query_iterator_destroy(it);
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_123: [ If iterator or the handle pointer is NULL, or the iterator was created for another type of record, the next functions shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_enrollment_group_wrong_type)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    ENROLLMENT_GROUP_HANDLE eg = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_iterator_next_enrollment_group(it, &eg);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(eg);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_query_iterator_destroy(it);
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_124: [ If the request for the next page is in flight, the next functions shall move it forward once, without waiting ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_125: [ The next record shall be cut out of the current page with queryResponse_nextRecord and deserialized into the handle pointer, which is owned by the caller ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_126: [ When the current page has no more records, it shall be freed and the next functions shall wait for the page in flight, retrying once on a new connection if a kept-alive connection was closed by the service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_127: [ The page received shall become the current page without being copied, if its x-ms-item-type matches the type of the iterator ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_132: [ Otherwise the next functions shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_GOLDEN)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
     umock_c_reset_all_calls();
 
+    expected_calls_query_iterator_pump();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //no page yet
+    expected_calls_take_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+
     //act
-    int res = prov_sc_query_device_registration_state(sc, NULL, &cont_token, &query_resp);
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, &ie);
 
     //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(ie);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NULL(query_resp);
 
     //cleanup
+    individualEnrollment_destroy(ie);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_cont_token_ptr)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_130: [ When the last page has no more records, the next functions shall set the handle pointer to NULL and return 0 ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_end_of_results)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.registration_id = TEST_REGID;
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = TEST_INDIVIDUAL_ENROLLMENT_HANDLE;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    (void)prov_sc_query_iterator_next_individual_enrollment(it, &ie);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //the last page
+
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, NULL, &query_resp);
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, &ie2);
 
     //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(ie);
+    ASSERT_IS_NULL(ie2);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(query_resp);
 
     //cleanup
+    individualEnrollment_destroy(ie);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_093: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_NULL_query_resp_ptr)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_124: [ If the request for the next page is in flight, the next functions shall move it forward once, without waiting ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_128: [ If the page received has a continuation token, the request for the page after it shall be sent right away, with new headers ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_several_pages)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.registration_id = TEST_REGID;
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
     umock_c_reset_all_calls();
 
+    //first page, the second one is requested as soon as it arrives
+    expected_calls_query_iterator_pump();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //no page yet
+    expected_calls_take_query_page(TEST_CONT_TOKEN, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    //second page, sent on the kept-alive connection while the first one is read
+    expected_calls_query_iterator_pump();
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //the first page
+    expected_calls_take_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, NULL);
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, &ie);
+    int res2 = prov_sc_query_iterator_next_individual_enrollment(it, &ie2);
 
     //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(int, 0, res2);
+    ASSERT_IS_NOT_NULL(ie);
+    ASSERT_IS_NOT_NULL(ie2);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
 
     //cleanup
+    individualEnrollment_destroy(ie);
+    individualEnrollment_destroy(ie2);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_094: [ If query_spec has invalid values, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_invalid_version)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_126: [ When the current page has no more records, it shall be freed and the next functions shall wait for the page in flight, retrying once on a new connection if a kept-alive connection was closed by the service ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_reconnects_when_service_closed_connection)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.registration_id = TEST_REGID;
-    qs.version = 47474;
-
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    (void)prov_sc_query_iterator_next_individual_enrollment(it, &ie);
     umock_c_reset_all_calls();
 
+    g_service_closes_connection = true;
+
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //the service closed the connection
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //the first page
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //no response
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //no response headers
+    expected_calls_disconnect_from_service();
+    expected_calls_connect_to_service();
+    expected_calls_query_iterator_pump();
+    expected_calls_receive_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, &ie2);
 
     //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(ie2);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NULL(query_resp);
 
     //cleanup
+    individualEnrollment_destroy(ie);
+    individualEnrollment_destroy(ie2);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_success_full_results)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_129: [ If a page request failed or could not be sent, it shall be sent again with the same continuation token the next time a page is needed ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_131: [ If reading, receiving or deserializing a record fails, the next functions shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_retries_failed_page)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.registration_id = TEST_REGID;
+    qs.page_size = 5;
+    qs.query_string = TEST_QUERY_STRING;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+    umock_c_reset_all_calls();
 
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    //the first reply is not for enrollments
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, &ie);
     umock_c_reset_all_calls();
 
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
-    expected_calls_add_query_headers(false, false);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
-    //response headers
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
-    //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_start_query_page(false, false);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    expected_calls_receive_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
+    int res2 = prov_sc_query_iterator_next_individual_enrollment(it, &ie2);
 
     //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(ie);
+    ASSERT_ARE_EQUAL(int, 0, res2);
+    ASSERT_IS_NOT_NULL(ie2);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NOT_NULL(query_resp);
 
     //cleanup
-    free(cont_token);
+    individualEnrollment_destroy(ie2);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
-    queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_no_given_token_w_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_135: [ The timeout of a page request shall start when the next functions start waiting for the page, not when the request was sent ahead ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_slow_consumer_does_not_time_out)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.registration_id = TEST_REGID;
+    qs.query_string = TEST_QUERY_STRING;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie2 = NULL;
+    (void)prov_sc_set_request_timeout(sc, 2);
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    (void)prov_sc_query_iterator_next_individual_enrollment(it, &ie);
     umock_c_reset_all_calls();
 
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
-    expected_calls_add_query_headers(true, false);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
-    //response headers
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN); //cannot fail
-    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
-    //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    //the caller spends longer than the timeout on the first page, and the second page is slow to come
+    g_current_ms += 10;
+    g_service_reply_delay = 1;
+
+    expected_calls_query_iterator_pump();
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //the first page
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //no reply
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //0 ms elapsed
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    expected_calls_receive_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_iterator_next_individual_enrollment(it, &ie2);
 
     //assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, res);
-    ASSERT_IS_NOT_NULL(cont_token);
-    ASSERT_ARE_EQUAL(char_ptr, TEST_CONT_TOKEN, cont_token);
-    ASSERT_IS_NOT_NULL(query_resp);
+    ASSERT_IS_NOT_NULL(ie2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    free(cont_token);
+    individualEnrollment_destroy(ie);
+    individualEnrollment_destroy(ie2);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
-    queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token_no_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_125: [ The next record shall be cut out of the current page with queryResponse_nextRecord and deserialized into the handle pointer, which is owned by the caller ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_enrollment_group_GOLDEN)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.registration_id = TEST_REGID;
+    qs.query_string = TEST_QUERY_STRING;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token;
-    mallocAndStrcpy_s(&cont_token, TEST_CONT_TOKEN);
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    ENROLLMENT_GROUP_HANDLE eg = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_enrollment_group_query_iterator(sc, &qs);
     umock_c_reset_all_calls();
 
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
-    expected_calls_add_query_headers(true, true);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
-    //response headers
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
-    //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_query_iterator_pump();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //no page yet
+    expected_calls_take_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_ENROLLMENT_GROUP);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(enrollmentGroup_deserializeFromJson(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_iterator_next_enrollment_group(it, &eg);
 
     //assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NOT_NULL(query_resp);
+    ASSERT_IS_NOT_NULL(eg);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    free(cont_token);
+    enrollmentGroup_destroy(eg);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
-    queryResponse_free(query_resp);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_095: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_097: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_099: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_100: [ Upon success, prov_sc_query_device_registration_state shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token_w_token_return)
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_125: [ The next record shall be cut out of the current page with queryResponse_nextRecord and deserialized into the handle pointer, which is owned by the caller ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_device_registration_state_GOLDEN)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
@@ -4586,50 +6228,34 @@ TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token
     qs.page_size = 5;
     qs.registration_id = TEST_REGID;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token;
-    mallocAndStrcpy_s(&cont_token, TEST_CONT_TOKEN);
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    DEVICE_REGISTRATION_STATE_HANDLE drs = NULL;
+    PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_device_registration_state_query_iterator(sc, &qs);
     umock_c_reset_all_calls();
 
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST);
-    expected_calls_add_query_headers(true, true);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
-    //response headers
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot fail
-    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
-    //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE)); //cannot fail
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_query_iterator_pump();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //no page yet
+    expected_calls_take_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE);
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(deviceRegistrationState_deserializeFromJson(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_query_iterator_next_device_registration_state(it, &drs);
 
     //assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, res);
-    ASSERT_ARE_EQUAL(char_ptr, TEST_CONT_TOKEN2, cont_token);
-    ASSERT_IS_NOT_NULL(query_resp);
+    ASSERT_IS_NOT_NULL(drs);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    free(cont_token);
+    deviceRegistrationState_destroy(drs);
+    prov_sc_query_iterator_destroy(it);
     prov_sc_destroy(sc);
-    queryResponse_free(query_resp);
 }
 
-/*---Note that this failure test covers all failures from other cases by virtue of making all possible calls--/*
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_096: [ If the 'POST' REST call fails, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_098: [ If populating query_resp_ptr with the retrieved data fails, prov_sc_query_device_registration_state shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token_w_token_return_ERROR)
+/*---Note that this failure test covers the failures of the create and next functions by making all their calls---*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_122: [ If any of the above fails, the query iterator create functions shall fail and return NULL ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_131: [ If reading, receiving or deserializing a record fails, the next functions shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_iterator_next_individual_enrollment_ERROR)
 {
     //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
@@ -4638,36 +6264,20 @@ TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
-    qs.registration_id = TEST_REGID;
+    qs.query_string = TEST_QUERY_STRING;
     qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token;
-    mallocAndStrcpy_s(&cont_token, TEST_CONT_TOKEN);
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
     umock_c_reset_all_calls();
 
-    expected_calls_construct_registration_path(true);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_POST); //12
-    expected_calls_add_query_headers(true, true); //14
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_POST, RESPONSE);
-    //response headers
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(TEST_CONT_TOKEN2); //cannot "fail"
-    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE); //cannot "fail"
-    //end response headers
-    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_DEVICE_REGISTRATION_STATE));
-    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_DEVICE_REGISTRATION_STATE));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_create_query_iterator(true); //17
+    expected_calls_query_iterator_pump(); //19
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_take_query_page(NULL, QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT); //31
+    STRICT_EXPECTED_CALL(queryResponse_nextRecord(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 2, 4, 9, 11, 14, 18, 20, 23, 24, 25, 26, 27, 30, 31, 32, 33, 34, 35 };
+    size_t calls_cannot_fail[] = { 3, 4, 6, 11, 13, 18, 20, 22, 25, 28, 29, 30, 31 };
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
     size_t count = umock_c_negative_tests_call_count();
     size_t test_num = 0;
@@ -4680,22 +6290,31 @@ TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token
         test_num++;
 
         char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_query_device_registration_state_success_paging_given_token_w_token_return_ERROR failure in test %zu/%zu", test_num, test_max);
+        sprintf(tmp_msg, "prov_sc_query_iterator_next_individual_enrollment_ERROR failure in test %zu/%zu", test_num, test_max);
 
+        INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+        int res = __LINE__;
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         //act
-        int res = prov_sc_query_device_registration_state(sc, &qs, &cont_token, &query_resp);
+        PROV_SC_QUERY_ITERATOR_HANDLE it = prov_sc_create_individual_enrollment_query_iterator(sc, &qs);
+        if (it != NULL)
+        {
+            res = prov_sc_query_iterator_next_individual_enrollment(it, &ie);
+        }
 
         //assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, res, 0, tmp_msg);
+        ASSERT_IS_NULL_WITH_MSG(ie, tmp_msg);
 
+        prov_sc_query_iterator_destroy(it);
+        g_http_open_pending = false;
+        g_http_request_pending = false;
         g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
-    free(cont_token);
     prov_sc_destroy(sc);
 }
 
@@ -0,0 +1,330 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*reads every individual enrollment of a query from an in-process uhttp client that serves synthetic pages after a
+simulated service latency, once page by page with prov_sc_query_individual_enrollment and once with the query iterator,
+and prints the throughput and the most memory the client held between calls, for a short and a long query*/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_uhttp_c/uhttp.h"
+
+#include "prov_service_client/provisioning_service_client.h"
+
+#define SHORT_QUERY_PAGES 10
+#define LONG_QUERY_PAGES 2000
+#define RECORDS_PER_PAGE 40
+#define SERVICE_LATENCY_MICROSECONDS 2000
+#define RECORD_PROCESSING_MICROSECONDS 50
+#define MAX_RECORD_LENGTH 1024
+
+static const char* const CONNECTION_STRING = "HostName=benchmark.azure-devices-provisioning.net;SharedAccessKeyName=provisioningserviceowner;SharedAccessKey=dGVzdGtleWZvcmJlbmNobWFyaw==";
+static const char* const QUERY_STRING = "SELECT * FROM enrollments";
+
+static double now_microseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000000.0 + (double)now.tv_nsec / 1000.0;
+#endif
+}
+
+/*memory held by the client, sampled whenever it hands something back to the benchmark*/
+static size_t peak_memory;
+
+static void sample_memory(void)
+{
+    size_t current = gballoc_getCurrentMemoryUsed();
+    if (current > peak_memory)
+    {
+        peak_memory = current;
+    }
+}
+
+/*the in-process uhttp client, the page asked for is the value of the continuation token*/
+typedef struct HTTP_CLIENT_HANDLE_DATA_TAG
+{
+    ON_HTTP_ERROR_CALLBACK on_error;
+    void* error_ctx;
+    ON_HTTP_OPEN_COMPLETE_CALLBACK on_open;
+    void* open_ctx;
+    int open_pending;
+    ON_HTTP_REQUEST_CALLBACK on_reply;
+    void* reply_ctx;
+    int request_pending;
+    size_t requested_page;
+    double reply_due;
+} HTTP_CLIENT_HANDLE_DATA;
+
+static size_t total_pages;
+static char page_buffer[RECORDS_PER_PAGE * MAX_RECORD_LENGTH + 8];
+
+static size_t build_page(size_t page)
+{
+    size_t length = 0;
+    page_buffer[length++] = '[';
+    for (size_t i = 0; i < RECORDS_PER_PAGE; i++)
+    {
+        size_t record = page * RECORDS_PER_PAGE + i;
+        length += (size_t)snprintf(&page_buffer[length], MAX_RECORD_LENGTH,
+            "%s{\"registrationId\":\"device-%zu\",\"deviceId\":\"device-%zu\","
+            "\"attestation\":{\"type\":\"tpm\",\"tpm\":{\"endorsementKey\":\"AToAAQALAAMAsgAgg3GXZ0SEs/gakMyNRqXXJP1S124GUgtk8qHaGzMUaaoABgCAAEMAEAgAAAAAAAEAxsj2gUScTk1UjuioeTlfGYZrrimExB+bScH75adUMRIi2UOMxG1kw4y+9RW/IVoMl4e620VxZad0ARX2gUqVjYO7KPVt3dyKhZS3dkcvfBisBhP1XH9B33VqHG9SHnbnQXdBUaCgKAfxome8UmBKfe+naTsE5fkvjb/do3/dD6l4sGBwFCnKRdln4XpM03zLpoHFao8zOwt8l/uP3qUIxmCYv9A7m69Ms+5/pCkTu/rK4mRDsfhZ0QLfbzVI6zQFOKF/rwsfBtFeWlWtcuJMKlXdD8TXWElTzgh7JS4qhFzreL0c1mI0GCj+Aws0usZh7dLIVPnlgZcBhgy1SSDQMQ==\"}},"
+            "\"iotHubHostName\":\"benchmark.azure-devices.net\",\"etag\":\"etag-%zu\",\"provisioningStatus\":\"enabled\","
+            "\"createdDateTimeUtc\":\"2018-01-01T00:00:00.000Z\",\"lastUpdatedDateTimeUtc\":\"2018-01-01T00:00:00.000Z\"}",
+            (i == 0) ? "" : ",", record, record, record);
+    }
+    page_buffer[length++] = ']';
+    page_buffer[length] = '\0';
+    return length;
+}
+
+HTTP_CLIENT_HANDLE uhttp_client_create(const IO_INTERFACE_DESCRIPTION* io_interface_desc, const void* xio_param, ON_HTTP_ERROR_CALLBACK on_http_error, void* callback_ctx)
+{
+    HTTP_CLIENT_HANDLE_DATA* result;
+    (void)io_interface_desc;
+    (void)xio_param;
+    if ((result = calloc(1, sizeof(HTTP_CLIENT_HANDLE_DATA))) != NULL)
+    {
+        result->on_error = on_http_error;
+        result->error_ctx = callback_ctx;
+    }
+    return result;
+}
+
+void uhttp_client_destroy(HTTP_CLIENT_HANDLE handle)
+{
+    free(handle);
+}
+
+HTTP_CLIENT_RESULT uhttp_client_open(HTTP_CLIENT_HANDLE handle, const char* host, int port_num, ON_HTTP_OPEN_COMPLETE_CALLBACK on_connect, void* callback_ctx)
+{
+    (void)host;
+    (void)port_num;
+    handle->on_open = on_connect;
+    handle->open_ctx = callback_ctx;
+    handle->open_pending = 1;
+    return HTTP_CLIENT_OK;
+}
+
+void uhttp_client_close(HTTP_CLIENT_HANDLE handle, ON_HTTP_CLOSED_CALLBACK on_close_callback, void* callback_ctx)
+{
+    handle->request_pending = 0;
+    if (on_close_callback != NULL)
+    {
+        on_close_callback(callback_ctx);
+    }
+}
+
+HTTP_CLIENT_RESULT uhttp_client_set_trace(HTTP_CLIENT_HANDLE handle, bool trace_on, bool trace_data)
+{
+    (void)handle;
+    (void)trace_on;
+    (void)trace_data;
+    return HTTP_CLIENT_OK;
+}
+
+HTTP_CLIENT_RESULT uhttp_client_set_trusted_cert(HTTP_CLIENT_HANDLE handle, const char* certificate)
+{
+    (void)handle;
+    (void)certificate;
+    return HTTP_CLIENT_OK;
+}
+
+HTTP_CLIENT_RESULT uhttp_client_execute_request(HTTP_CLIENT_HANDLE handle, HTTP_CLIENT_REQUEST_TYPE request_type, const char* relative_path, HTTP_HEADERS_HANDLE http_header_handle, const unsigned char* content, size_t content_length, ON_HTTP_REQUEST_CALLBACK on_request_callback, void* callback_ctx)
+{
+    const char* cont_token = HTTPHeaders_FindHeaderValue(http_header_handle, "x-ms-continuation");
+    (void)request_type;
+    (void)relative_path;
+    (void)content;
+    (void)content_length;
+    handle->on_reply = on_request_callback;
+    handle->reply_ctx = callback_ctx;
+    handle->requested_page = (cont_token == NULL) ? 0 : (size_t)strtoul(cont_token, NULL, 10);
+    handle->reply_due = now_microseconds() + SERVICE_LATENCY_MICROSECONDS;
+    handle->request_pending = 1;
+    return HTTP_CLIENT_OK;
+}
+
+void uhttp_client_dowork(HTTP_CLIENT_HANDLE handle)
+{
+    if (handle->open_pending)
+    {
+        handle->open_pending = 0;
+        handle->on_open(handle->open_ctx, HTTP_CALLBACK_REASON_OK);
+    }
+    else if (handle->request_pending && (now_microseconds() >= handle->reply_due))
+    {
+        HTTP_HEADERS_HANDLE headers = HTTPHeaders_Alloc();
+        size_t length = build_page(handle->requested_page);
+        char next_page[32];
+
+        handle->request_pending = 0;
+        (void)HTTPHeaders_AddHeaderNameValuePair(headers, "x-ms-item-type", "Enrollment");
+        if (handle->requested_page + 1 < total_pages)
+        {
+            (void)snprintf(next_page, sizeof(next_page), "%zu", handle->requested_page + 1);
+            (void)HTTPHeaders_AddHeaderNameValuePair(headers, "x-ms-continuation", next_page);
+        }
+        handle->on_reply(handle->reply_ctx, HTTP_CALLBACK_REASON_OK, (const unsigned char*)page_buffer, length, 200, headers);
+        HTTPHeaders_Free(headers);
+        sample_memory();
+    }
+}
+
+/*stands for what the application does with every record, it is the time the iterator can spend receiving the next page*/
+static void process_record(const char* registration_id)
+{
+    double until = now_microseconds() + RECORD_PROCESSING_MICROSECONDS;
+    (void)registration_id;
+    while (now_microseconds() < until)
+    {
+    }
+}
+
+static void init_query(PROVISIONING_QUERY_SPECIFICATION* query_spec)
+{
+    memset(query_spec, 0, sizeof(PROVISIONING_QUERY_SPECIFICATION));
+    query_spec->version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    query_spec->page_size = RECORDS_PER_PAGE;
+    query_spec->query_string = QUERY_STRING;
+}
+
+static size_t read_page_by_page(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+{
+    PROVISIONING_QUERY_SPECIFICATION query_spec;
+    char* cont_token = NULL;
+    size_t records = 0;
+
+    init_query(&query_spec);
+    do
+    {
+        PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+        if (prov_sc_query_individual_enrollment(prov_client, &query_spec, &cont_token, &query_resp) != 0)
+        {
+            (void)printf("query failed after %zu records\r\n", records);
+            break;
+        }
+        sample_memory();
+        for (size_t i = 0; i < query_resp->response_arr_size; i++)
+        {
+            process_record(individualEnrollment_getRegistrationId(query_resp->response_arr.ie[i]));
+            records++;
+        }
+        queryResponse_free(query_resp);
+    } while (cont_token != NULL);
+    free(cont_token);
+
+    return records;
+}
+
+static size_t read_with_iterator(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+{
+    PROVISIONING_QUERY_SPECIFICATION query_spec;
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator;
+    size_t records = 0;
+
+    init_query(&query_spec);
+    if ((iterator = prov_sc_create_individual_enrollment_query_iterator(prov_client, &query_spec)) == NULL)
+    {
+        (void)printf("failed creating the query iterator\r\n");
+    }
+    else
+    {
+        INDIVIDUAL_ENROLLMENT_HANDLE enrollment;
+        do
+        {
+            enrollment = NULL;
+            if (prov_sc_query_iterator_next_individual_enrollment(iterator, &enrollment) != 0)
+            {
+                (void)printf("query failed after %zu records\r\n", records);
+                break;
+            }
+            sample_memory();
+            if (enrollment != NULL)
+            {
+                process_record(individualEnrollment_getRegistrationId(enrollment));
+                individualEnrollment_destroy(enrollment);
+                records++;
+            }
+        } while (enrollment != NULL);
+        prov_sc_query_iterator_destroy(iterator);
+    }
+
+    return records;
+}
+
+static void run(const char* name, size_t pages, size_t(*read_query)(PROVISIONING_SERVICE_CLIENT_HANDLE))
+{
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client;
+
+    total_pages = pages;
+    if ((prov_client = prov_sc_create_from_connection_string(CONNECTION_STRING)) == NULL)
+    {
+        (void)printf("failed creating the provisioning service client\r\n");
+    }
+    else
+    {
+        size_t baseline = gballoc_getCurrentMemoryUsed();
+        double start;
+        double elapsed;
+        size_t records;
+
+        peak_memory = baseline;
+        start = now_microseconds();
+        records = read_query(prov_client);
+        elapsed = now_microseconds() - start;
+
+        (void)printf("%-14s %6zu pages %8zu records %10.0f records/s %10zu bytes peak\r\n",
+            name, pages, records, (double)records * 1000000.0 / elapsed, peak_memory - baseline);
+
+        prov_sc_destroy(prov_client);
+    }
+}
+
+int main(void)
+{
+    if (platform_init() != 0)
+    {
+        (void)printf("platform_init failed\r\n");
+        return 1;
+    }
+    if (gballoc_init() != 0)
+    {
+        (void)printf("gballoc_init failed\r\n");
+        platform_deinit();
+        return 1;
+    }
+
+    (void)printf("%d records per page, %d us service latency, %d us processing per record\r\n",
+        RECORDS_PER_PAGE, SERVICE_LATENCY_MICROSECONDS, RECORD_PROCESSING_MICROSECONDS);
+
+    run("page by page", SHORT_QUERY_PAGES, read_page_by_page);
+    run("iterator", SHORT_QUERY_PAGES, read_with_iterator);
+    run("page by page", LONG_QUERY_PAGES, read_page_by_page);
+    run("iterator", LONG_QUERY_PAGES, read_with_iterator);
+
+    gballoc_deinit();
+    platform_deinit();
+    return 0;
+}
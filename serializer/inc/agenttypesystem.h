@@ -646,6 +646,12 @@ struct AGENT_DATA_TYPE_TAG
 
 MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToString, STRING_HANDLE, destination, const AGENT_DATA_TYPE*, value);
 
+/*size of a buffer that can hold the JSON representation of any fixed length AGENT_DATA_TYPE (numbers, dates, GUIDs, booleans, null), including the '\0'*/
+#define AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE 160
+
+/*writes the JSON representation of a fixed length AGENT_DATA_TYPE into a caller supplied buffer, no allocations*/
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToCharBuffer, char*, destination, size_t, destinationSize, const AGENT_DATA_TYPE*, value, size_t*, length);
+
 /*Create/Destroy work in pairs. For some data type not calling Uncreate might be ok. For some, it will lead to memory leaks*/
 
 /*creates an AGENT_DATA_TYPE containing a EDM_BOOLEAN from a int*/
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef BINARYDECODER_H
+#define BINARYDECODER_H
+
+#include "multitree.h"
+#include "binaryencoder.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef enum BINARY_DECODER_RESULT_TAG
+{
+    BINARY_DECODER_OK,
+    BINARY_DECODER_INVALID_ARG,
+    BINARY_DECODER_PARSE_ERROR,
+    BINARY_DECODER_MULTITREE_FAILED,
+    BINARY_DECODER_ERROR
+} BINARY_DECODER_RESULT;
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+MOCKABLE_FUNCTION(, BINARY_DECODER_RESULT, BinaryDecoder_To_MultiTree, DATA_ENCODING, encoding, const unsigned char*, source, size_t, sourceSize, MULTITREE_HANDLE*, multiTreeHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BINARYDECODER_H */
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef BINARYENCODER_H
+#define BINARYENCODER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "agenttypesystem.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/*the wire encodings the serializer can produce and consume*/
+#define DATA_ENCODING_VALUES    \
+DATA_ENCODING_JSON,             \
+DATA_ENCODING_CBOR,             \
+DATA_ENCODING_MSGPACK
+
+DEFINE_ENUM(DATA_ENCODING, DATA_ENCODING_VALUES);
+
+#define BINARY_ENCODER_RESULT_VALUES    \
+BINARY_ENCODER_OK,                      \
+BINARY_ENCODER_INVALID_ARG,             \
+BINARY_ENCODER_NOT_SUPPORTED,           \
+BINARY_ENCODER_ERROR
+
+DEFINE_ENUM(BINARY_ENCODER_RESULT, BINARY_ENCODER_RESULT_VALUES);
+
+/*receives the encoded bytes, in order. Returns 0 on success*/
+typedef int(*BINARY_ENCODER_WRITE_FUNCTION)(void* context, const unsigned char* bytes, size_t size);
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, const char*, BinaryEncoder_GetContentType, DATA_ENCODING, encoding);
+MOCKABLE_FUNCTION(, const char*, BinaryEncoder_GetContentEncoding, DATA_ENCODING, encoding);
+MOCKABLE_FUNCTION(, BINARY_ENCODER_RESULT, BinaryEncoder_EncodeMapHeader, DATA_ENCODING, encoding, size_t, memberCount, BINARY_ENCODER_WRITE_FUNCTION, write, void*, context);
+MOCKABLE_FUNCTION(, BINARY_ENCODER_RESULT, BinaryEncoder_EncodeString, DATA_ENCODING, encoding, const char*, value, size_t, length, BINARY_ENCODER_WRITE_FUNCTION, write, void*, context);
+MOCKABLE_FUNCTION(, BINARY_ENCODER_RESULT, BinaryEncoder_EncodeValue, DATA_ENCODING, encoding, const AGENT_DATA_TYPE*, value, BINARY_ENCODER_WRITE_FUNCTION, write, void*, context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BINARYENCODER_H */
@@ -111,9 +111,19 @@ typedef struct REFLECTION_DESIRED_PROPERTY_TAG
     const char* modelName;
 } REFLECTION_DESIRED_PROPERTY;
 
+/*one entry for every WITH_DATA of a model, in declaration order (which is also increasing offset order)*/
+typedef struct CODEFIRST_MODEL_FIELD_TAG
+{
+    const char* name;
+    size_t offset;
+    size_t size;
+    int(*Create_AGENT_DATA_TYPE_from_Ptr)(void* param, AGENT_DATA_TYPE* dest);
+} CODEFIRST_MODEL_FIELD;
+
 typedef struct REFLECTION_MODEL_TAG
 {
     const char* name;
+    const CODEFIRST_MODEL_FIELD* (*getFields)(size_t* fieldCount); /*NULL when the model has no field table*/
 } REFLECTION_MODEL;
 
 typedef struct REFLECTED_SOMETHING_TAG
@@ -172,13 +182,17 @@ MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, CodeFirst_InvokeMethod, DEVICE_HANDLE,
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteCommand, void*, device, const char*, command);
 
+MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, CodeFirst_ExecuteEncodedCommand, void*, device, DATA_ENCODING, encoding, const unsigned char*, command, size_t, commandSize);
+
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, CodeFirst_ExecuteMethod, void*, device, const char*, methodName, const char*, methodPayload);
 
 MOCKABLE_FUNCTION(, void*, CodeFirst_CreateDevice, SCHEMA_MODEL_TYPE_HANDLE, model, const REFLECTED_DATA_FROM_DATAPROVIDER*, metadata, size_t, dataSize, bool, includePropertyPath);
 MOCKABLE_FUNCTION(, void, CodeFirst_DestroyDevice, void*, device);
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_SetEncoding, void*, device, DATA_ENCODING, encoding);
 
 extern CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...);
 extern CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t* destinationSize, size_t numReportedProperties, ...);
+extern CODEFIRST_RESULT CodeFirst_SerializeModel(unsigned char** destination, size_t* destinationSize, const void* model, const CODEFIRST_MODEL_FIELD* fields, size_t fieldCount, size_t numSelectedFields, ...);
 
 MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_IngestDesiredProperties, void*, device, const char*, jsonPayload, bool, parseDesiredNode);
 
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "binaryencoder.h"
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/vector.h"
 #ifdef __cplusplus
@@ -25,7 +26,8 @@ DATA_MARSHALLER_JSON_ENCODER_ERROR,             \
 DATA_MARSHALLER_ERROR,                          \
 DATA_MARSHALLER_AGENT_DATA_TYPES_ERROR,         \
 DATA_MARSHALLER_MULTITREE_ERROR,                \
-DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED          \
+DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED,         \
+DATA_MARSHALLER_BINARY_ENCODER_ERROR            \
 
 DEFINE_ENUM(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
 
@@ -40,6 +42,7 @@ typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG* DATA_MARSHALLER_HANDLE;
 
 MOCKABLE_FUNCTION(,DATA_MARSHALLER_HANDLE, DataMarshaller_Create, SCHEMA_MODEL_TYPE_HANDLE, modelHandle, bool, includePropertyPath);
 MOCKABLE_FUNCTION(,void, DataMarshaller_Destroy, DATA_MARSHALLER_HANDLE, dataMarshallerHandle);
+MOCKABLE_FUNCTION(,DATA_MARSHALLER_RESULT, DataMarshaller_SetEncoding, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, DATA_ENCODING, encoding);
 MOCKABLE_FUNCTION(,DATA_MARSHALLER_RESULT, DataMarshaller_SendData, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, size_t, valueCount, const DATA_MARSHALLER_VALUE*, values, unsigned char**, destination, size_t*, destinationSize);
 
 MOCKABLE_FUNCTION(, DATA_MARSHALLER_RESULT, DataMarshaller_SendData_ReportedProperties, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, VECTOR_HANDLE, values, unsigned char**, destination, size_t*, destinationSize);
@@ -6,6 +6,7 @@
 
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "binaryencoder.h"
 /* Normally we could include <stdbool> for cpp, but some toolchains are not well behaved and simply don't have it - ARM CC for example */
 #include <stdbool.h>
 
@@ -33,6 +34,7 @@ typedef struct DATA_PUBLISHER_HANDLE_DATA_TAG* DATA_PUBLISHER_HANDLE;
 
 MOCKABLE_FUNCTION(,DATA_PUBLISHER_HANDLE, DataPublisher_Create, SCHEMA_MODEL_TYPE_HANDLE, modelHandle, bool, includePropertyPath);
 MOCKABLE_FUNCTION(,void, DataPublisher_Destroy, DATA_PUBLISHER_HANDLE, dataPublisherHandle);
+MOCKABLE_FUNCTION(,DATA_PUBLISHER_RESULT, DataPublisher_SetEncoding, DATA_PUBLISHER_HANDLE, dataPublisherHandle, DATA_ENCODING, encoding);
 
 MOCKABLE_FUNCTION(,TRANSACTION_HANDLE, DataPublisher_StartTransaction, DATA_PUBLISHER_HANDLE, dataPublisherHandle);
 MOCKABLE_FUNCTION(,DATA_PUBLISHER_RESULT, DataPublisher_PublishTransacted, TRANSACTION_HANDLE, transactionHandle, const char*, propertyPath, const AGENT_DATA_TYPE*, data);
@@ -169,7 +169,9 @@ extern "C"
 
 #define SERIALIZER_REGISTER_NAMESPACE(NAMESPACE) CodeFirst_RegisterSchema(#NAMESPACE, & ALL_REFLECTED(NAMESPACE))
 
+/*Codes_SRS_SERIALIZER_H_02_035: [ DECLARE_MODEL shall generate a static field table for the model containing, in declaration order, the name, offset, size and marshalling function of every WITH_DATA property, and an enumeration of field indexes named name_FIELD_propertyName terminated by name_FIELD_COUNT. ]*/
 #define DECLARE_MODEL(name, ...)                                                             \
+    static const CODEFIRST_MODEL_FIELD* C2(GetModelFields_, name)(size_t* fieldCount);        \
     REFLECTED_MODEL(name)                                                                    \
     FOR_EACH_1(CREATE_DESIRED_PROPERTY_CALLBACK, __VA_ARGS__)                                \
     typedef struct name { int :1; FOR_EACH_1(BUILD_MODEL_STRUCT, __VA_ARGS__) } name;        \
@@ -192,6 +194,34 @@ extern "C"
         (void)destination;                                                                   \
         FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT_GLOBAL_DEINITIALIZE, name, __VA_ARGS__)       \
     }                                                                                        \
+    enum { FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT_FIELD_INDEX, name, __VA_ARGS__) C2(name, _FIELD_COUNT) }; \
+    static const CODEFIRST_MODEL_FIELD C2(ModelFields_, name)[] =                            \
+    {                                                                                        \
+        FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT_FIELD_TABLE, name, __VA_ARGS__)               \
+        { NULL, 0, 0, NULL }                                                                 \
+    };                                                                                       \
+    static const CODEFIRST_MODEL_FIELD* C2(GetModelFields_, name)(size_t* fieldCount)        \
+    {                                                                                        \
+        *fieldCount = C2(name, _FIELD_COUNT);                                                \
+        return C2(ModelFields_, name);                                                       \
+    }                                                                                        \
+
+/**
+ * @def   DECLARE_MODEL_SERIALIZE(name)
+ * Generates CODEFIRST_RESULT Model_Serialize_<name>(unsigned char** destination,
+ * size_t* destinationSize, const name* model), which serializes all the
+ * properties of a model instance straight from the field table generated by
+ * ::DECLARE_MODEL. The function is static, so it shall only be generated in
+ * the translation units that call it.
+ *
+ * @param   name    The name of a model previously declared with ::DECLARE_MODEL.
+ */
+/*Codes_SRS_SERIALIZER_H_02_039: [ DECLARE_MODEL_SERIALIZE shall generate a function CODEFIRST_RESULT Model_Serialize_name(unsigned char** destination, size_t* destinationSize, const name* model) that serializes all the properties of the model by calling CodeFirst_SerializeModel. ]*/
+#define DECLARE_MODEL_SERIALIZE(name)                                                        \
+    static CODEFIRST_RESULT C2(Model_Serialize_, name)(unsigned char** destination, size_t* destinationSize, const name* model) \
+    {                                                                                        \
+        return CodeFirst_SerializeModel(destination, destinationSize, model, C2(ModelFields_, name), C2(name, _FIELD_COUNT), 0); \
+    }
 
 
 
@@ -307,6 +337,30 @@ extern "C"
 /*Codes_SRS_SERIALIZER_99_114:[ If CodeFirst_SendAsync fails, SEND shall return IOT_AGENT_SERIALIZE_FAILED.] */
 #define SERIALIZE(destination, destinationSize,...) CodeFirst_SendAsync(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
+/**
+ * @def      SERIALIZE_MODEL_FIELDS(destination, destinationSize, modelName, model, ...)
+ * This macro produces the JSON serialized representation of a subset of the
+ * properties of a model instance, straight from the generated field table of
+ * the model (no lookups are performed). Use the Model_Serialize_<modelName>
+ * function generated by ::DECLARE_MODEL_SERIALIZE to serialize all the properties.
+ *
+ * @param   destination                  Pointer to an @c unsigned @c char* that
+ *                                       will receive the serialized data.
+ * @param   destinationSize              Pointer to a @c size_t that gets
+ *                                       written with the size in bytes of the
+ *                                       serialized data
+ * @param   modelName                    The name of the model.
+ * @param   model                        Pointer to the model instance.
+ * @param   property1, property2...      Names of the properties to serialize.
+ *                                       Properties are written in the order in
+ *                                       which they are declared in the model.
+ */
+/*Codes_SRS_SERIALIZER_H_02_036: [ SERIALIZE_MODEL_FIELDS shall call CodeFirst_SerializeModel passing the field table generated by DECLARE_MODEL and the index of each listed property. ]*/
+#define SERIALIZE_MODEL_FIELDS(destination, destinationSize, modelName, model, ...) \
+    CodeFirst_SerializeModel(destination, destinationSize, model, C2(ModelFields_, modelName), C2(modelName, _FIELD_COUNT), COUNT_ARG(__VA_ARGS__) FOR_EACH_1_KEEP_1(MODEL_FIELD_INDEX_MACRO, modelName, __VA_ARGS__))
+
+#define MODEL_FIELD_INDEX_MACRO(modelName, fieldName) , C2(modelName, C2(_FIELD_, fieldName))
+
 #define SERIALIZE_REPORTED_PROPERTIES(destination, destinationSize,...) CodeFirst_SendAsyncReported(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
 
@@ -325,6 +379,29 @@ extern "C"
 /*Codes_SRS_SERIALIZER_02_018: [EXECUTE_COMMAND macro shall call CodeFirst_ExecuteCommand passing device, commandBuffer and commandBufferSize.]*/
 #define EXECUTE_COMMAND(device, command) (CodeFirst_ExecuteCommand(device, command))
 
+/**
+ * @def   EXECUTE_ENCODED_COMMAND(device, encoding, command, commandSize)
+ * Same as EXECUTE_COMMAND, for a command received as JSON, CBOR or MessagePack.
+ *
+ * @param   device      Pointer to device data.
+ * @param   encoding    DATA_ENCODING_JSON, DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK.
+ * @param   command     The bytes of the command.
+ * @param   commandSize The number of bytes in command.
+ */
+/*Codes_SRS_SERIALIZER_H_02_037: [ EXECUTE_ENCODED_COMMAND macro shall call CodeFirst_ExecuteEncodedCommand passing device, encoding, command and commandSize. ]*/
+#define EXECUTE_ENCODED_COMMAND(device, encoding, command, commandSize) (CodeFirst_ExecuteEncodedCommand(device, encoding, command, commandSize))
+
+/**
+ * @def   SET_ENCODING(device, encoding)
+ * Selects the encoding SERIALIZE and SERIALIZE_REPORTED_PROPERTIES produce for this device.
+ * The matching message content type is BinaryEncoder_GetContentType(encoding).
+ *
+ * @param   device      Pointer to device data.
+ * @param   encoding    DATA_ENCODING_JSON (the default), DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK.
+ */
+/*Codes_SRS_SERIALIZER_H_02_038: [ SET_ENCODING macro shall call CodeFirst_SetEncoding passing device and encoding. ]*/
+#define SET_ENCODING(device, encoding) (CodeFirst_SetEncoding(device, encoding))
+
 /**
 * @def   EXECUTE_METHOD(device, methodName, methodPayload)
 * Any method that is declared in a model must also have an implementation as
@@ -444,7 +521,7 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define REFLECTED_FIELD(XstructName, XfieldType, XfieldName) \
     static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_FIELD_TYPE,                &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {TOSTRING(XfieldName), TOSTRING(XfieldType), TOSTRING(XstructName)}, {0}, {0}, {0} } };
 #define REFLECTED_MODEL(name) \
-    static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {TOSTRING(name)} } };
+    static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {TOSTRING(name), C2(GetModelFields_, name)} } };
 #define REFLECTED_PROPERTY(type, name, modelName) \
     static const REFLECTED_SOMETHING C2(REFLECTED_, C1(INC(__COUNTER__))) = { REFLECTION_PROPERTY_TYPE,             &C2(REFLECTED_, C1(DEC(DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {TOSTRING(name), TOSTRING(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name, offsetof(modelName, name), sizeof(type), TOSTRING(modelName)}, {0}, {0} } };
 #define REFLECTED_REPORTED_PROPERTY(type, name, modelName) \
@@ -499,6 +576,28 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define CREATE_ELEMENT_GLOBAL_DEINITIALIZATION(modelName, elem) EXPAND_ARGS(CREATE_SOMETHING_GLOBAL_DEINITIALIZATION(modelName, EXPAND_ARGS(EXPAND_##elem)))
 #define CREATE_MODEL_ELEMENT_GLOBAL_DEINITIALIZE(modelName, elem) EXPAND_ARGS(CREATE_ELEMENT_GLOBAL_DEINITIALIZATION(modelName, elem))
 
+#define CREATE_MODEL_ENTITY_FIELD_INDEX(modelName, callType, ...) EXPAND_ARGS(CREATE_FIELD_INDEX_##callType(modelName, __VA_ARGS__))
+#define CREATE_SOMETHING_FIELD_INDEX(modelName, ...) EXPAND_ARGS(CREATE_MODEL_ENTITY_FIELD_INDEX(modelName, __VA_ARGS__))
+#define CREATE_ELEMENT_FIELD_INDEX(modelName, elem) EXPAND_ARGS(CREATE_SOMETHING_FIELD_INDEX(modelName, EXPAND_ARGS(EXPAND_##elem)))
+#define CREATE_MODEL_ELEMENT_FIELD_INDEX(modelName, elem) EXPAND_ARGS(CREATE_ELEMENT_FIELD_INDEX(modelName, elem))
+
+#define CREATE_MODEL_ENTITY_FIELD_TABLE(modelName, callType, ...) EXPAND_ARGS(CREATE_FIELD_TABLE_##callType(modelName, __VA_ARGS__))
+#define CREATE_SOMETHING_FIELD_TABLE(modelName, ...) EXPAND_ARGS(CREATE_MODEL_ENTITY_FIELD_TABLE(modelName, __VA_ARGS__))
+#define CREATE_ELEMENT_FIELD_TABLE(modelName, elem) EXPAND_ARGS(CREATE_SOMETHING_FIELD_TABLE(modelName, EXPAND_ARGS(EXPAND_##elem)))
+#define CREATE_MODEL_ELEMENT_FIELD_TABLE(modelName, elem) EXPAND_ARGS(CREATE_ELEMENT_FIELD_TABLE(modelName, elem))
+
+/*only WITH_DATA properties get an entry in the field table of a model*/
+#define CREATE_FIELD_INDEX_MODEL_PROPERTY(modelName, type, name) modelName##_FIELD_##name,
+#define CREATE_FIELD_TABLE_MODEL_PROPERTY(modelName, type, name) { TOSTRING(name), offsetof(modelName, name), sizeof(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name },
+#define CREATE_FIELD_INDEX_MODEL_REPORTED_PROPERTY(...)
+#define CREATE_FIELD_TABLE_MODEL_REPORTED_PROPERTY(...)
+#define CREATE_FIELD_INDEX_MODEL_DESIRED_PROPERTY(...)
+#define CREATE_FIELD_TABLE_MODEL_DESIRED_PROPERTY(...)
+#define CREATE_FIELD_INDEX_MODEL_ACTION(...)
+#define CREATE_FIELD_TABLE_MODEL_ACTION(...)
+#define CREATE_FIELD_INDEX_MODEL_METHOD(...)
+#define CREATE_FIELD_TABLE_MODEL_METHOD(...)
+
 #define INSERT_FIELD_INTO_STRUCT(x, y) x y;
 
 
@@ -17,6 +17,7 @@
 #include <math.h>
 #include <limits.h>
 #include <errno.h>
+#include <string.h>
 
 /*if ULLONG_MAX is defined by limits.h for whatever reasons... */
 #ifndef ULLONG_MAX
@@ -48,24 +49,6 @@
 
 #define GUID_STRING_LENGTH 38
 
-// This is an artificial upper limit on floating point string length
-// (e.g. the size of the string when printing %f). It is set to twice the
-// maximum decimal precision plus 2. 1 for the decimal point and 1 for a
-// sign (+/-)
-// Unfortunately it is quite possible to print a float larger than this.
-// An example of this would be printf("%.*f", MAX_FLOATING_POINT_STRING_LENGTH, 1.3);
-// But currently no explicit requests for this exist in the file nor are
-// any expected to reasonably occur when being used (numbers that hit
-// this limit would be experiencing significant precision loss in storage anyway.
-#define MAX_FLOATING_POINT_STRING_LENGTH (DECIMAL_DIG *2 + 2)
-
-// This maximum length is 11 for 32 bit integers (including the sign)
-// optionally increase to 21 if longs are 64 bit
-#define MAX_LONG_STRING_LENGTH ( 11 + (10 * (sizeof(long)/ 8)))
-
-// This is the maximum length for the largest 64 bit number (signed)
-#define MAX_ULONG_LONG_STRING_LENGTH 20
-
 DEFINE_ENUM_STRINGS(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
 
 static int ValidateDate(int year, int month, int day);
@@ -83,6 +66,7 @@ static void NoFreeFunction(void* value)
 
 
 #define IS_DIGIT(a) (('0'<=(a)) &&((a)<='9'))
+#define IS_WHITESPACE(c) (((c) == ' ') || ((c) == '\t') || ((c) == '\n') || ((c) == '\v') || ((c) == '\f') || ((c) == '\r'))
 #define splitInt(intVal, bytePos)   (char)((intVal >> (bytePos << 3)) & 0xFF)
 #define joinChars(a, b, c, d) (uint32_t)( (uint32_t)a + ((uint32_t)b << 8) + ((uint32_t)c << 16) + ((uint32_t)d << 24))
 
@@ -323,26 +307,6 @@ static void scanOptionalSign(const char* source, size_t sourceSize, size_t* posi
     }
 }
 
-/*scans a minus sign, if any*/
-/*if no sign, then it will set *sign to = +1*/
-/*if sign, then it will set *sign to = +/-1*/
-static void scanOptionalMinusSign(const char* source, size_t sourceSize, size_t* position, int* sign)
-{
-    if (*position < sourceSize)
-    {
-        if (source[*position] == '-')
-        {
-
-            *sign = -1;
-            (*position)++;
-        }
-        else
-        {
-            *sign = +1;
-        }
-    }
-}
-
 /*this function alawys returns 0 if it processed 1 digit*/
 /*return 1 when error (such as wrong parameters)*/
 static int scanMandatoryOneDigit(const char* source, size_t sourceSize, size_t* position)
@@ -383,26 +347,6 @@ static void scanOptionalNDigits(const char* source, size_t sourceSize, size_t* p
     }
 }
 
-/*from the string pointed to by source, having the size sourceSize, starting at initial position *position*/
-/*this function will attempt to read a decimal number having an optional sign(+/-) followed by precisely N digits */
-/*will return 0 if in the string there was a number and that number has been read in the *value parameter*/
-/*will update position parameter to reflect the first character not belonging to the number*/
-static int scanAndReadNDigitsInt(const char* source, size_t* position, int *value, size_t N)
-{
-    N++;
-    *value = 0;
-    while ((IS_DIGIT(source[*position])) &&
-        (N > 0))
-    {
-        *value *= 10;
-        *value += (source[*position] - '0');
-        (*position)++;
-        N--;
-    }
-
-    return N != 1;
-}
-
 /*this function alawys returns 0 if it found a dot followed by at least digit*/
 /*return 1 when error (such as wrong parameters)*/
 static int scanOptionalDotAndDigits(const char* source, size_t sourceSize, size_t* position)
@@ -1283,538 +1227,765 @@ static char hexDigitToChar(uint8_t hexDigit)
     else return ('A' - 10) + hexDigit;
 }
 
-AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+/*all the decimal pairs "00" to "99", so that integers are written 2 digits at a time*/
+static const char decimalDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/*writes value in base 10, left padded with '0' up to minDigits (same as "%.*llu"). Returns the number of characters written*/
+static size_t WriteDecimal(char* destination, uint64_t value, size_t minDigits)
 {
-    AGENT_DATA_TYPES_RESULT result;
+    char digits[20]; /*written in reverse order*/
+    size_t nDigits = 0;
+    size_t pos = 0;
 
-    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_015:[If destination parameter is NULL, AgentDataTypes_ToString shall return AGENT_DATA_TYPES_INVALID_ARG.]*/
-    if(destination == NULL)
+    while (value >= 100)
     {
-        result = AGENT_DATA_TYPES_INVALID_ARG;
-        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        digits[nDigits++] = decimalDigitPairs[pair + 1];
+        digits[nDigits++] = decimalDigitPairs[pair];
     }
-    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_053:[ If value is NULL or has been destroyed or otherwise doesn't contain valid data, AGENT_DATA_TYPES_INVALID_ARG shall be returned.]*/
-    else if (value == NULL)
+
+    if (value >= 10)
     {
-        result = AGENT_DATA_TYPES_INVALID_ARG;
-        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        size_t pair = (size_t)value * 2;
+        digits[nDigits++] = decimalDigitPairs[pair + 1];
+        digits[nDigits++] = decimalDigitPairs[pair];
     }
     else
     {
-        switch(value->type)
-        {
-            default:
-            {
-                result = AGENT_DATA_TYPES_INVALID_ARG;
-                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                break;
-            }
-        case(EDM_NULL_TYPE) :
-            {
-                /*SRS_AGENT_TYPE_SYSTEM_99_101:[ EDM_NULL_TYPE shall return the unquoted string null.]*/
-                if (STRING_concat(destination, "null") != 0)
-                {
-                    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_014:[ All functions shall return AGENT_DATA_TYPES_OK when the processing is successful.]*/
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-        case(EDM_BOOLEAN_TYPE) :
-            {
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_017:[EDM_BOOLEAN:as in(odata - abnf - construction - rules, 2013), booleanValue = "true" / "false"]*/
-                if (value->value.edmBoolean.value == EDM_TRUE)
-                {
-                    /*SRS_AGENT_TYPE_SYSTEM_99_030:[If v is different than 0 then the AGENT_DATA_TYPE shall have the value "true".]*/
-                    if (STRING_concat(destination, "true") != 0)
-                    {
-                        /*Codes_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        /*Codes_SRS_AGENT_TYPE_SYSTEM_99_014:[ All functions shall return AGENT_DATA_TYPES_OK when the processing is successful.]*/
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_017:[EDM_BOOLEAN:as in(odata - abnf - construction - rules, 2013), booleanValue = "true" / "false"]*/
-                else if (value->value.edmBoolean.value == EDM_FALSE)
-                {
-                    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_029:[ If v 0 then the AGENT_DATA_TYPE shall have the value "false" Boolean.]*/
-                    if (STRING_concat(destination, "false") != 0)
-                    {
-                        /*Codes_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        /*Codes_SRS_AGENT_TYPE_SYSTEM_99_014:[ All functions shall return AGENT_DATA_TYPES_OK when the processing is successful.]*/
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                else
-                {
-                    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_053:[ If value contains invalid data, AgentDataTypes_ToString shall return AGENT_DATA_TYPES_INVALID_ARG.]*/
-                    result = AGENT_DATA_TYPES_INVALID_ARG;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-
-                break;
-            }
-            case(EDM_BYTE_TYPE) :
-            {
-                char tempbuffer2[4]; /*because bytes can at most be 255 and that is 3 characters + 1 for '\0'*/
-                size_t pos = 0;
-                if (value->value.edmByte.value >= 100) tempbuffer2[pos++] = '0' + (value->value.edmByte.value / 100);
-                if (value->value.edmByte.value >= 10) tempbuffer2[pos++] = '0' + (value->value.edmByte.value % 100) / 10;
-                tempbuffer2[pos++] = '0' + (value->value.edmByte.value % 10);
-                tempbuffer2[pos++] = '\0';
+        digits[nDigits++] = '0' + (char)value;
+    }
 
-                if (STRING_concat(destination, tempbuffer2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-            case(EDM_DATE_TYPE) :
-            {
-                size_t pos = 0;
-                char tempBuffer2[1 + 5 + 1 + 2 + 1 + 2 + 1+1];
-                int16_t year = value->value.edmDate.year;
-                tempBuffer2[pos++] = '\"';
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_068:[ EDM_DATE: dateValue = year "-" month "-" day.]*/
-                if (year < 0)
-                {
-                    tempBuffer2[pos++] = '-';
-                    year = -year;
-                }
+    while (pos + nDigits < minDigits)
+    {
+        destination[pos++] = '0';
+    }
 
-                tempBuffer2[pos++] = '0' + (char)(year / 1000);
-                tempBuffer2[pos++] = '0' + (char)((year % 1000) / 100);
-                tempBuffer2[pos++] = '0' + (char)((year % 100) / 10);
-                tempBuffer2[pos++] = '0' + (char)(year % 10);
-                tempBuffer2[pos++] = '-';
-                tempBuffer2[pos++] = '0' + value->value.edmDate.month / 10;
-                tempBuffer2[pos++] = '0' + value->value.edmDate.month % 10;
-                tempBuffer2[pos++] = '-';
-                tempBuffer2[pos++] = '0' + value->value.edmDate.day / 10;
-                tempBuffer2[pos++] = '0' + value->value.edmDate.day % 10;
-                tempBuffer2[pos++] = '\"';
-                tempBuffer2[pos++] = '\0';
+    while (nDigits > 0)
+    {
+        destination[pos++] = digits[--nDigits];
+    }
 
-                if (STRING_concat(destination, tempBuffer2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-            case (EDM_DATE_TIME_OFFSET_TYPE):
-            {
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_019:[ EDM_DATETIMEOFFSET: dateTimeOffsetValue = year "-" month "-" day "T" hour ":" minute [ ":" second [ "." fractionalSeconds ] ] ( "Z" / sign hour ":" minute )]*/
-                /*from ABNF seems like these numbers HAVE to be padded with zeroes*/
-                if (value->value.edmDateTimeOffset.hasTimeZone)
-                {
-                    if (value->value.edmDateTimeOffset.hasFractionalSecond)
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // .
-                            MAX_ULONG_LONG_STRING_LENGTH + // %.12llu
-                            1 + MAX_LONG_STRING_LENGTH + // %+.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + //\"
-                            1;  // " (terminating NULL);
-
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12llu%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year+1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.fractionalSecond,
-                                value->value.edmDateTimeOffset.timeZoneHour,
-                                value->value.edmDateTimeOffset.timeZoneMinute) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
+    return pos;
+}
 
-                            // Clean up temp buffer if allocated
-                            free(tempBuffer);
-                        }
-                    }
-                    else
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + MAX_LONG_STRING_LENGTH + // %+.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // \"
-                            1; // " terminating NULL
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.timeZoneHour,
-                                value->value.edmDateTimeOffset.timeZoneMinute) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
+/*same as WriteDecimal, but for signed values. forceSign produces a '+' for positive values (same as "%+.*lld")*/
+static size_t WriteSignedDecimal(char* destination, int64_t value, size_t minDigits, bool forceSign)
+{
+    size_t pos = 0;
+    uint64_t magnitude;
 
-                            // Clean up temp buffer if allocated
-                            free(tempBuffer);
-                        }
-                    }
-                }
-                else
-                {
-                    if (value->value.edmDateTimeOffset.hasFractionalSecond)
-                    {
-                        size_t tempBufferSize = 1 + //\"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // .
-                            MAX_ULONG_LONG_STRING_LENGTH + // %.12llu
-                            1 + // Z
-                            1 + // \"
-                            1; // " (terminating NULL)
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12lluZ\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.fractionalSecond) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
+    if (value < 0)
+    {
+        destination[pos++] = '-';
+        magnitude = (uint64_t)0 - (uint64_t)value;
+    }
+    else
+    {
+        if (forceSign)
+        {
+            destination[pos++] = '+';
+        }
+        magnitude = (uint64_t)value;
+    }
 
-                            free(tempBuffer);
-                        }
-                    }
-                    else
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // Z
-                            1 + // \"
-                            1; // " (terminating null);
-
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2dZ\"",
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
+    return pos + WriteDecimal(destination + pos, magnitude, minDigits);
+}
 
-                            free(tempBuffer);
-                        }
-                    }
-                }
-                break;
-            }
-            case(EDM_DECIMAL_TYPE) :
-            {
-                if (STRING_concat_with_STRING(destination, value->value.edmDecimal.value) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-            case (EDM_INT16_TYPE) :
-            {
-                /*-32768 to +32767*/
-                char buffertemp2[7]; /*because 5 digits and sign and '\0'*/
-                uint16_t positiveValue;
-                size_t pos = 0;
-                uint16_t rank = (uint16_t)10000;
-                bool foundFirstDigit = false;
+#ifndef NO_FLOATS
 
-                if (value->value.edmInt16.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = -value->value.edmInt16.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt16.value;
-                }
+static const uint64_t powersOf10[20] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
 
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
+/*the following is an implementation of Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers", 2010)*/
+/*it produces the shortest (in the vast majority of cases) string of decimal digits that reads back as the exact same binary value*/
+/*and it does so using only 64 bit integer arithmetic - no sprintf, no locale, no allocations*/
+typedef struct DIY_FP_TAG
+{
+    uint64_t f;
+    int e;
+} DIY_FP;
 
-                if (STRING_concat(destination, buffertemp2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-            case (EDM_INT32_TYPE) :
-            {
-                /*-2147483648 to +2147483647*/
-                char buffertemp2[12]; /*because 10 digits and sign and '\0'*/
-                uint32_t positiveValue;
-                size_t pos = 0;
-                uint32_t rank = 1000000000UL;
-                bool foundFirstDigit = false;
+typedef struct CACHED_POWER_TAG
+{
+    uint64_t f;
+    int e; /*binary exponent*/
+    int k; /*decimal exponent*/
+} CACHED_POWER;
 
-                if (value->value.edmInt32.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = - value->value.edmInt32.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt32.value;
-                }
+/*normalized 64 bit approximations of 10^k, for k = -348, -340, ..., 340*/
+static const CACHED_POWER cachedPowersOf10[] =
+{
+    { 0xfa8fd5a0081c0288ULL, -1220, -348 }, { 0xbaaee17fa23ebf76ULL, -1193, -340 }, { 0x8b16fb203055ac76ULL, -1166, -332 },
+    { 0xcf42894a5dce35eaULL, -1140, -324 }, { 0x9a6bb0aa55653b2dULL, -1113, -316 }, { 0xe61acf033d1a45dfULL, -1087, -308 },
+    { 0xab70fe17c79ac6caULL, -1060, -300 }, { 0xff77b1fcbebcdc4fULL, -1034, -292 }, { 0xbe5691ef416bd60cULL, -1007, -284 },
+    { 0x8dd01fad907ffc3cULL, -980, -276 }, { 0xd3515c2831559a83ULL, -954, -268 }, { 0x9d71ac8fada6c9b5ULL, -927, -260 },
+    { 0xea9c227723ee8bcbULL, -901, -252 }, { 0xaecc49914078536dULL, -874, -244 }, { 0x823c12795db6ce57ULL, -847, -236 },
+    { 0xc21094364dfb5637ULL, -821, -228 }, { 0x9096ea6f3848984fULL, -794, -220 }, { 0xd77485cb25823ac7ULL, -768, -212 },
+    { 0xa086cfcd97bf97f4ULL, -741, -204 }, { 0xef340a98172aace5ULL, -715, -196 }, { 0xb23867fb2a35b28eULL, -688, -188 },
+    { 0x84c8d4dfd2c63f3bULL, -661, -180 }, { 0xc5dd44271ad3cdbaULL, -635, -172 }, { 0x936b9fcebb25c996ULL, -608, -164 },
+    { 0xdbac6c247d62a584ULL, -582, -156 }, { 0xa3ab66580d5fdaf6ULL, -555, -148 }, { 0xf3e2f893dec3f126ULL, -529, -140 },
+    { 0xb5b5ada8aaff80b8ULL, -502, -132 }, { 0x87625f056c7c4a8bULL, -475, -124 }, { 0xc9bcff6034c13053ULL, -449, -116 },
+    { 0x964e858c91ba2655ULL, -422, -108 }, { 0xdff9772470297ebdULL, -396, -100 }, { 0xa6dfbd9fb8e5b88fULL, -369, -92 },
+    { 0xf8a95fcf88747d94ULL, -343, -84 }, { 0xb94470938fa89bcfULL, -316, -76 }, { 0x8a08f0f8bf0f156bULL, -289, -68 },
+    { 0xcdb02555653131b6ULL, -263, -60 }, { 0x993fe2c6d07b7facULL, -236, -52 }, { 0xe45c10c42a2b3b06ULL, -210, -44 },
+    { 0xaa242499697392d3ULL, -183, -36 }, { 0xfd87b5f28300ca0eULL, -157, -28 }, { 0xbce5086492111aebULL, -130, -20 },
+    { 0x8cbccc096f5088ccULL, -103, -12 }, { 0xd1b71758e219652cULL, -77, -4 }, { 0x9c40000000000000ULL, -50, 4 },
+    { 0xe8d4a51000000000ULL, -24, 12 }, { 0xad78ebc5ac620000ULL, 3, 20 }, { 0x813f3978f8940984ULL, 30, 28 },
+    { 0xc097ce7bc90715b3ULL, 56, 36 }, { 0x8f7e32ce7bea5c70ULL, 83, 44 }, { 0xd5d238a4abe98068ULL, 109, 52 },
+    { 0x9f4f2726179a2245ULL, 136, 60 }, { 0xed63a231d4c4fb27ULL, 162, 68 }, { 0xb0de65388cc8ada8ULL, 189, 76 },
+    { 0x83c7088e1aab65dbULL, 216, 84 }, { 0xc45d1df942711d9aULL, 242, 92 }, { 0x924d692ca61be758ULL, 269, 100 },
+    { 0xda01ee641a708deaULL, 295, 108 }, { 0xa26da3999aef774aULL, 322, 116 }, { 0xf209787bb47d6b85ULL, 348, 124 },
+    { 0xb454e4a179dd1877ULL, 375, 132 }, { 0x865b86925b9bc5c2ULL, 402, 140 }, { 0xc83553c5c8965d3dULL, 428, 148 },
+    { 0x952ab45cfa97a0b3ULL, 455, 156 }, { 0xde469fbd99a05fe3ULL, 481, 164 }, { 0xa59bc234db398c25ULL, 508, 172 },
+    { 0xf6c69a72a3989f5cULL, 534, 180 }, { 0xb7dcbf5354e9beceULL, 561, 188 }, { 0x88fcf317f22241e2ULL, 588, 196 },
+    { 0xcc20ce9bd35c78a5ULL, 614, 204 }, { 0x98165af37b2153dfULL, 641, 212 }, { 0xe2a0b5dc971f303aULL, 667, 220 },
+    { 0xa8d9d1535ce3b396ULL, 694, 228 }, { 0xfb9b7cd9a4a7443cULL, 720, 236 }, { 0xbb764c4ca7a44410ULL, 747, 244 },
+    { 0x8bab8eefb6409c1aULL, 774, 252 }, { 0xd01fef10a657842cULL, 800, 260 }, { 0x9b10a4e5e9913129ULL, 827, 268 },
+    { 0xe7109bfba19c0c9dULL, 853, 276 }, { 0xac2820d9623bf429ULL, 880, 284 }, { 0x80444b5e7aa7cf85ULL, 907, 292 },
+    { 0xbf21e44003acdd2dULL, 933, 300 }, { 0x8e679c2f5e44ff8fULL, 960, 308 }, { 0xd433179d9c8cb841ULL, 986, 316 },
+    { 0x9e19db92b4e31ba9ULL, 1013, 324 }, { 0xeb96bf6ebadf77d9ULL, 1039, 332 }, { 0xaf87023b9bf0ee6bULL, 1066, 340 }
+};
 
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
+static DIY_FP DiyFp_Multiply(DIY_FP x, DIY_FP y)
+{
+    DIY_FP result;
+    const uint64_t M32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & M32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & M32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1ULL << 31; /*round*/
+    result.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    result.e = x.e + y.e + 64;
+    return result;
+}
 
-                if (STRING_concat(destination, buffertemp2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-            case (EDM_INT64_TYPE):
-            {
-                char buffertemp2[21]; /*because 19 digits and sign and '\0'*/
-                uint64_t positiveValue;
-                size_t pos = 0;
-                uint64_t rank = 10000000000000000000ULL;
-                bool foundFirstDigit = false;
+static DIY_FP DiyFp_Normalize(DIY_FP x)
+{
+    while ((x.f & 0x8000000000000000ULL) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
 
-                if (value->value.edmInt64.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = -value->value.edmInt64.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt64.value;
-                }
+/*returns c such that c * 2^w.e lands in the range Grisu needs (-60..-32) and sets decimalExponent to -k of c = 10^k*/
+static DIY_FP GetCachedPower(int e, int* decimalExponent)
+{
+    DIY_FP result;
+    double dk = (-61 - e) * 0.30102999566398114 + 347; /*0.30102999566398114 = log10(2)*/
+    int k = (int)dk;
+    size_t index;
+    if (dk - k > 0.0)
+    {
+        k++;
+    }
+    index = (size_t)((k >> 3) + 1);
+    *decimalExponent = -cachedPowersOf10[index].k;
+    result.f = cachedPowersOf10[index].f;
+    result.e = cachedPowersOf10[index].e;
+    return result;
+}
 
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
+static void GrisuRound(char* digits, size_t nDigits, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while (
+        (rest < distance) &&
+        (delta - rest >= tenKappa) &&
+        ((rest + tenKappa < distance) || (distance - rest > rest + tenKappa - distance))
+        )
+    {
+        digits[nDigits - 1]--;
+        rest += tenKappa;
+    }
+}
 
-                if (STRING_concat(destination, buffertemp2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
+static void GrisuGenerateDigits(DIY_FP w, DIY_FP mp, uint64_t delta, char* digits, size_t* nDigits, int* decimalExponent)
+{
+    const int shift = -mp.e;
+    const uint64_t one = 1ULL << shift;
+    const uint64_t distance = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> shift);
+    uint64_t p2 = mp.f & (one - 1);
+    int kappa = 0;
+
+    while ((kappa < 10) && (p1 >= powersOf10[kappa]))
+    {
+        kappa++;
+    }
+
+    *nDigits = 0;
+    while (kappa > 0)
+    {
+        uint32_t divisor = (uint32_t)powersOf10[kappa - 1];
+        uint32_t d = p1 / divisor;
+        uint64_t rest;
+        p1 %= divisor;
+        if ((d != 0) || (*nDigits != 0))
+        {
+            digits[(*nDigits)++] = '0' + (char)d;
+        }
+        kappa--;
+        rest = ((uint64_t)p1 << shift) + p2;
+        if (rest <= delta)
+        {
+            *decimalExponent += kappa;
+            GrisuRound(digits, *nDigits, delta, rest, powersOf10[kappa] << shift, distance);
+            return;
+        }
+    }
+
+    for (;;)
+    {
+        char d;
+        p2 *= 10;
+        delta *= 10;
+        d = (char)(p2 >> shift);
+        if ((d != 0) || (*nDigits != 0))
+        {
+            digits[(*nDigits)++] = '0' + d;
+        }
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *decimalExponent += kappa;
+            GrisuRound(digits, *nDigits, delta, p2, one, distance * ((-kappa < 20) ? powersOf10[-kappa] : 0));
+            return;
+        }
+    }
+}
+
+/*value = f * 2^e, f != 0. lowerBoundaryIsCloser is true when f is an exact power of 2 (the previous representable value is closer than the next one)*/
+/*produces digits (no '\0') such that value is read back from digits * 10^decimalExponent*/
+static void GrisuShortestDigits(uint64_t f, int e, bool lowerBoundaryIsCloser, char* digits, size_t* nDigits, int* decimalExponent)
+{
+    DIY_FP v;
+    DIY_FP plus;
+    DIY_FP minus;
+    DIY_FP cachedPower;
+    DIY_FP w;
+    DIY_FP wPlus;
+    DIY_FP wMinus;
+
+    v.f = f;
+    v.e = e;
+    plus.f = (f << 1) + 1;
+    plus.e = e - 1;
+    plus = DiyFp_Normalize(plus);
+    if (lowerBoundaryIsCloser)
+    {
+        minus.f = (f << 2) - 1;
+        minus.e = e - 2;
+    }
+    else
+    {
+        minus.f = (f << 1) - 1;
+        minus.e = e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    cachedPower = GetCachedPower(plus.e, decimalExponent);
+    w = DiyFp_Multiply(DiyFp_Normalize(v), cachedPower);
+    wPlus = DiyFp_Multiply(plus, cachedPower);
+    wMinus = DiyFp_Multiply(minus, cachedPower);
+    /*make the interval a bit more narrow so the imprecision of the cached power cannot produce digits outside of it*/
+    wMinus.f++;
+    wPlus.f--;
+    GrisuGenerateDigits(w, wPlus, wPlus.f - wMinus.f, digits, nDigits, decimalExponent);
+}
+
+/*lays out digits * 10^decimalExponent as a JSON number that always contains a '.' or an exponent (e.g. 3.0, 0.001, 1.5e-07 would be 1.5e-7)*/
+static size_t WriteDigitsAsNumber(char* destination, const char* digits, size_t nDigits, int decimalExponent)
+{
+    size_t pos = 0;
+    int pointPosition = (int)nDigits + decimalExponent; /*number of digits before the decimal point*/
+
+    if ((decimalExponent >= 0) && (pointPosition <= 21))
+    {
+        /*an integer: 1234e2 => 123400.0*/
+        int i;
+        (void)memcpy(destination, digits, nDigits);
+        pos = nDigits;
+        for (i = 0; i < decimalExponent; i++)
+        {
+            destination[pos++] = '0';
+        }
+        destination[pos++] = '.';
+        destination[pos++] = '0';
+    }
+    else if ((pointPosition > 0) && (pointPosition <= 21))
+    {
+        /*1234e-2 => 12.34*/
+        (void)memcpy(destination, digits, (size_t)pointPosition);
+        pos = (size_t)pointPosition;
+        destination[pos++] = '.';
+        (void)memcpy(destination + pos, digits + pointPosition, nDigits - (size_t)pointPosition);
+        pos += nDigits - (size_t)pointPosition;
+    }
+    else if ((pointPosition > -6) && (pointPosition <= 0))
+    {
+        /*1234e-6 => 0.001234*/
+        int i;
+        destination[pos++] = '0';
+        destination[pos++] = '.';
+        for (i = pointPosition; i < 0; i++)
+        {
+            destination[pos++] = '0';
+        }
+        (void)memcpy(destination + pos, digits, nDigits);
+        pos += nDigits;
+    }
+    else
+    {
+        /*1234e30 => 1.234e33, 1e30 => 1e30*/
+        destination[pos++] = digits[0];
+        if (nDigits > 1)
+        {
+            destination[pos++] = '.';
+            (void)memcpy(destination + pos, digits + 1, nDigits - 1);
+            pos += nDigits - 1;
+        }
+        destination[pos++] = 'e';
+        pos += WriteSignedDecimal(destination + pos, (int64_t)pointPosition - 1, 1, false);
+    }
+
+    return pos;
+}
+
+/*f * 2^e with sign. f == 0 writes 0.0 (or -0.0)*/
+static size_t WriteShortestFloatingPoint(char* destination, bool isNegative, uint64_t f, int e, bool lowerBoundaryIsCloser)
+{
+    size_t pos = 0;
+
+    if (isNegative)
+    {
+        destination[pos++] = '-';
+    }
+
+    if (f == 0)
+    {
+        destination[pos++] = '0';
+        destination[pos++] = '.';
+        destination[pos++] = '0';
+    }
+    else
+    {
+        char digits[32];
+        size_t nDigits;
+        int decimalExponent;
+        GrisuShortestDigits(f, e, lowerBoundaryIsCloser, digits, &nDigits, &decimalExponent);
+        pos += WriteDigitsAsNumber(destination + pos, digits, nDigits, decimalExponent);
+    }
+
+    return pos;
+}
+
+static size_t WriteDouble(char* destination, double value)
+{
+    uint64_t bits;
+    uint64_t significand;
+    int biasedExponent;
+    size_t result;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    significand = bits & 0x000FFFFFFFFFFFFFULL;
+    biasedExponent = (int)((bits >> 52) & 0x7FF);
+
+    if (biasedExponent != 0)
+    {
+        result = WriteShortestFloatingPoint(destination, (bits >> 63) != 0, significand | 0x0010000000000000ULL, biasedExponent - 1075, (significand == 0) && (biasedExponent > 1));
+    }
+    else
+    {
+        /*denormals*/
+        result = WriteShortestFloatingPoint(destination, (bits >> 63) != 0, significand, -1074, false);
+    }
+
+    return result;
+}
+
+static size_t WriteSingle(char* destination, float value)
+{
+    uint32_t bits;
+    uint32_t significand;
+    int biasedExponent;
+    size_t result;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    significand = bits & 0x007FFFFFUL;
+    biasedExponent = (int)((bits >> 23) & 0xFF);
+
+    if (biasedExponent != 0)
+    {
+        result = WriteShortestFloatingPoint(destination, (bits >> 31) != 0, (uint64_t)(significand | 0x00800000UL), biasedExponent - 150, (significand == 0) && (biasedExponent > 1));
+    }
+    else
+    {
+        /*denormals*/
+        result = WriteShortestFloatingPoint(destination, (bits >> 31) != 0, (uint64_t)significand, -149, false);
+    }
+
+    return result;
+}
+
+#endif
+
+static size_t WriteString(char* destination, const char* source)
+{
+    size_t length = strlen(source);
+    (void)memcpy(destination, source, length);
+    return length;
+}
+
+static bool IsFixedLengthType(AGENT_DATA_TYPE_TYPE type)
+{
+    bool result;
+    switch (type)
+    {
+        case EDM_NULL_TYPE:
+        case EDM_BOOLEAN_TYPE:
+        case EDM_BYTE_TYPE:
+        case EDM_SBYTE_TYPE:
+        case EDM_INT16_TYPE:
+        case EDM_INT32_TYPE:
+        case EDM_INT64_TYPE:
+        case EDM_DATE_TYPE:
+        case EDM_DATE_TIME_OFFSET_TYPE:
+        case EDM_GUID_TYPE:
+#ifndef NO_FLOATS
+        case EDM_SINGLE_TYPE:
+        case EDM_DOUBLE_TYPE:
+#endif
+        {
+            result = true;
+            break;
+        }
+        default:
+        {
+            result = false;
+            break;
+        }
+    }
+    return result;
+}
+
+/*writes the JSON representation of a fixed length type in destination (that has at least AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE bytes), '\0' terminated*/
+static AGENT_DATA_TYPES_RESULT WriteFixedLengthType(char* destination, const AGENT_DATA_TYPE* value, size_t* length)
+{
+    AGENT_DATA_TYPES_RESULT result = AGENT_DATA_TYPES_OK;
+    size_t pos = 0;
+
+    switch (value->type)
+    {
+        default:
+        {
+            result = AGENT_DATA_TYPES_INVALID_ARG;
+            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+            break;
+        }
+        case EDM_NULL_TYPE:
+        {
+            /*SRS_AGENT_TYPE_SYSTEM_99_101:[ EDM_NULL_TYPE shall return the unquoted string null.]*/
+            pos = WriteString(destination, "null");
+            break;
+        }
+        case EDM_BOOLEAN_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_017:[EDM_BOOLEAN:as in(odata - abnf - construction - rules, 2013), booleanValue = "true" / "false"]*/
+            if (value->value.edmBoolean.value == EDM_TRUE)
+            {
+                /*SRS_AGENT_TYPE_SYSTEM_99_030:[If v is different than 0 then the AGENT_DATA_TYPE shall have the value "true".]*/
+                pos = WriteString(destination, "true");
+            }
+            else if (value->value.edmBoolean.value == EDM_FALSE)
+            {
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_029:[ If v 0 then the AGENT_DATA_TYPE shall have the value "false" Boolean.]*/
+                pos = WriteString(destination, "false");
+            }
+            else
+            {
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_053:[ If value contains invalid data, AgentDataTypes_ToString shall return AGENT_DATA_TYPES_INVALID_ARG.]*/
+                result = AGENT_DATA_TYPES_INVALID_ARG;
+                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+            }
+            break;
+        }
+        case EDM_BYTE_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_018:[ EDM_BYTE: as in (odata-abnf-construction-rules, 2013), byteValue  = 1*3DIGIT ; numbers in the range from 0 to 255]*/
+            pos = WriteDecimal(destination, value->value.edmByte.value, 1);
+            break;
+        }
+        case EDM_SBYTE_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_026:[ EDM_SBYTE: sbyteValue = [ sign ] 1*3DIGIT  ; numbers in the range from -128 to 127]*/
+            pos = WriteSignedDecimal(destination, value->value.edmSbyte.value, 1, false);
+            break;
+        }
+        case EDM_INT16_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_023:[ EDM_INT16: int16Value = [ sign ] 1*5DIGIT  ; numbers in the range from -32768 to 32767]*/
+            pos = WriteSignedDecimal(destination, value->value.edmInt16.value, 1, false);
+            break;
+        }
+        case EDM_INT32_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_024:[ EDM_INT32: int32Value = [ sign ] 1*10DIGIT ; numbers in the range from -2147483648 to 2147483647]*/
+            pos = WriteSignedDecimal(destination, value->value.edmInt32.value, 1, false);
+            break;
+        }
+        case EDM_INT64_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_025:[ EDM_INT64: int64Value = [ sign ] 1*19DIGIT ; numbers in the range from -9223372036854775808 to 9223372036854775807]*/
+            pos = WriteSignedDecimal(destination, value->value.edmInt64.value, 1, false);
+            break;
+        }
+        case EDM_DATE_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_068:[ EDM_DATE: dateValue = year "-" month "-" day.]*/
+            destination[pos++] = '\"';
+            pos += WriteSignedDecimal(destination + pos, value->value.edmDate.year, 4, false);
+            destination[pos++] = '-';
+            pos += WriteDecimal(destination + pos, value->value.edmDate.month, 2);
+            destination[pos++] = '-';
+            pos += WriteDecimal(destination + pos, value->value.edmDate.day, 2);
+            destination[pos++] = '\"';
+            break;
+        }
+        case EDM_DATE_TIME_OFFSET_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_019:[ EDM_DATETIMEOFFSET: dateTimeOffsetValue = year "-" month "-" day "T" hour ":" minute [ ":" second [ "." fractionalSeconds ] ] ( "Z" / sign hour ":" minute )]*/
+            /*from ABNF seems like these numbers HAVE to be padded with zeroes*/
+            /*the fields are written as "%.4d-%.2d-%.2dT%.2d:%.2d:%.2d[.%.12llu](Z|%+.2d:%.2d)" would write them*/
+            const EDM_DATE_TIME_OFFSET* dateTimeOffset = &value->value.edmDateTimeOffset;
+            destination[pos++] = '\"';
+            pos += WriteSignedDecimal(destination + pos, (int64_t)dateTimeOffset->dateTime.tm_year + 1900, 4, false);
+            destination[pos++] = '-';
+            pos += WriteSignedDecimal(destination + pos, (int64_t)dateTimeOffset->dateTime.tm_mon + 1, 2, false);
+            destination[pos++] = '-';
+            pos += WriteSignedDecimal(destination + pos, dateTimeOffset->dateTime.tm_mday, 2, false);
+            destination[pos++] = 'T';
+            pos += WriteSignedDecimal(destination + pos, dateTimeOffset->dateTime.tm_hour, 2, false);
+            destination[pos++] = ':';
+            pos += WriteSignedDecimal(destination + pos, dateTimeOffset->dateTime.tm_min, 2, false);
+            destination[pos++] = ':';
+            pos += WriteSignedDecimal(destination + pos, dateTimeOffset->dateTime.tm_sec, 2, false);
+            if (dateTimeOffset->hasFractionalSecond)
+            {
+                destination[pos++] = '.';
+                pos += WriteDecimal(destination + pos, dateTimeOffset->fractionalSecond, 12);
+            }
+            if (dateTimeOffset->hasTimeZone)
+            {
+                pos += WriteSignedDecimal(destination + pos, dateTimeOffset->timeZoneHour, 2, true);
+                destination[pos++] = ':';
+                pos += WriteSignedDecimal(destination + pos, dateTimeOffset->timeZoneMinute, 2, false);
+            }
+            else
+            {
+                destination[pos++] = 'Z';
+            }
+            destination[pos++] = '\"';
+            break;
+        }
+        case EDM_GUID_TYPE:
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_093:[ EDM_GUID: 8HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 12HEXDIG]*/
+            size_t i;
+            destination[pos++] = '\"';
+            for (i = 0; i < 16; i++)
+            {
+                if ((i == 4) || (i == 6) || (i == 8) || (i == 10))
                 {
-                    result = AGENT_DATA_TYPES_OK;
+                    destination[pos++] = '-';
                 }
-                break;
+                destination[pos++] = hexDigitToChar(value->value.edmGuid.GUID[i] / 16);
+                destination[pos++] = hexDigitToChar(value->value.edmGuid.GUID[i] % 16);
+            }
+            destination[pos++] = '\"';
+            break;
+        }
+#ifndef NO_FLOATS
+        case EDM_SINGLE_TYPE:
+        {
+            /*C89 standard says: When a float is promoted to double or long double, or a double is promoted to long double, its value is unchanged*/
+            /*I read that as : when a float is NaN or Inf, it will stay NaN or INF in double representation*/
+            if (ISNAN(value->value.edmSingle.value))
+            {
+                pos = WriteString(destination, NaN_STRING);
+            }
+            else if (ISNEGATIVEINFINITY(value->value.edmSingle.value))
+            {
+                pos = WriteString(destination, MINUSINF_STRING);
+            }
+            else if (ISPOSITIVEINFINITY(value->value.edmSingle.value))
+            {
+                pos = WriteString(destination, PLUSINF_STRING);
+            }
+            else
+            {
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_02_002: [ EDM_SINGLE and EDM_DOUBLE values shall be written with the shortest sequence of decimal digits that reads back as the same value. ]*/
+                pos = WriteSingle(destination, value->value.edmSingle.value);
+            }
+            break;
+        }
+        case EDM_DOUBLE_TYPE:
+        {
+            /*OData-ABNF says these can be used: nanInfinity = 'NaN' / '-INF' / 'INF'*/
+            /*C90 doesn't declare a NaN or Inf in the standard, however, values might be NaN or Inf...*/
+            /*C99 ... does*/
+            /*C11 is same as C99*/
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
+            if (ISNAN(value->value.edmDouble.value))
+            {
+                pos = WriteString(destination, NaN_STRING);
+            }
+            else if (ISNEGATIVEINFINITY(value->value.edmDouble.value))
+            {
+                pos = WriteString(destination, MINUSINF_STRING);
+            }
+            else if (ISPOSITIVEINFINITY(value->value.edmDouble.value))
+            {
+                pos = WriteString(destination, PLUSINF_STRING);
             }
-            case (EDM_SBYTE_TYPE) :
+            else
             {
-                char tempbuffer2[5]; /* because '-' and 3 characters for 127 let's say and '\0'*/
-                int absValue = value->value.edmSbyte.value;
-                size_t pos=0;
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_026:[ EDM_SBYTE: sbyteValue = [ sign ] 1*3DIGIT  ; numbers in the range from -128 to 127]*/
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_02_002: [ EDM_SINGLE and EDM_DOUBLE values shall be written with the shortest sequence of decimal digits that reads back as the same value. ]*/
+                pos = WriteDouble(destination, value->value.edmDouble.value);
+            }
+            break;
+        }
+#endif
+    }
 
-                if (value->value.edmSbyte.value < 0)
-                {
-                    tempbuffer2[pos++] = '-';
-                    absValue = -absValue;
-                }
+    destination[pos] = '\0';
+    *length = pos;
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_ToCharBuffer(char* destination, size_t destinationSize, const AGENT_DATA_TYPE* value, size_t* length)
+{
+    AGENT_DATA_TYPES_RESULT result;
 
-                if (absValue >= 100 ) tempbuffer2[pos++] = '0' + (char)(absValue / 100);
-                if (absValue >=10) tempbuffer2[pos++] = '0' + (absValue % 100) / 10;
-                tempbuffer2[pos++] = '0' + (absValue % 10);
-                tempbuffer2[pos++] = '\0';
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_02_003: [ If destination, value or length is NULL then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if (
+        (destination == NULL) ||
+        (value == NULL) ||
+        (length == NULL)
+        )
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("invalid argument char* destination=%p, const AGENT_DATA_TYPE* value=%p, size_t* length=%p", destination, value, length);
+    }
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_02_004: [ If value is not of a fixed length type (EDM_NULL, EDM_BOOLEAN, EDM_BYTE, EDM_SBYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DATE, EDM_DATE_TIME_OFFSET, EDM_GUID, EDM_SINGLE, EDM_DOUBLE) then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_NOT_IMPLEMENTED. ]*/
+    else if (!IsFixedLengthType(value->type))
+    {
+        result = AGENT_DATA_TYPES_NOT_IMPLEMENTED;
+        LogError("type %d cannot be written to a fixed size buffer", (int)value->type);
+    }
+    else
+    {
+        char temp[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+        size_t tempLength;
 
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_02_005: [ AgentDataTypes_ToCharBuffer shall produce the same characters as AgentDataTypes_ToString would append. ]*/
+        result = WriteFixedLengthType(temp, value, &tempLength);
+        if (result != AGENT_DATA_TYPES_OK)
+        {
+            /*already logged*/
+        }
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_02_006: [ If destinationSize is not enough to hold the characters and the '\0' terminator then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_ERROR. ]*/
+        else if (tempLength + 1 > destinationSize)
+        {
+            result = AGENT_DATA_TYPES_ERROR;
+            LogError("destinationSize=%lu is too small, %lu bytes are needed", (unsigned long)destinationSize, (unsigned long)(tempLength + 1));
+        }
+        else
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_02_007: [ Otherwise AgentDataTypes_ToCharBuffer shall copy the '\0' terminated characters to destination, set length to the number of characters (not counting '\0') and return AGENT_DATA_TYPES_OK. ]*/
+            (void)memcpy(destination, temp, tempLength + 1);
+            *length = tempLength;
+        }
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    AGENT_DATA_TYPES_RESULT result;
 
-                if (STRING_concat(destination, tempbuffer2) != 0)
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_015:[If destination parameter is NULL, AgentDataTypes_ToString shall return AGENT_DATA_TYPES_INVALID_ARG.]*/
+    if(destination == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_053:[ If value is NULL or has been destroyed or otherwise doesn't contain valid data, AGENT_DATA_TYPES_INVALID_ARG shall be returned.]*/
+    else if (value == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_02_001: [ Fixed length types (numbers, dates, GUIDs, booleans and null) shall be written in a stack buffer and appended to destination with a single STRING_concat. ]*/
+    else if (IsFixedLengthType(value->type))
+    {
+        char temp[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+        size_t tempLength;
+
+        result = WriteFixedLengthType(temp, value, &tempLength);
+        if (result != AGENT_DATA_TYPES_OK)
+        {
+            /*already logged*/
+        }
+        else if (STRING_concat(destination, temp) != 0)
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
+            result = AGENT_DATA_TYPES_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_99_014:[ All functions shall return AGENT_DATA_TYPES_OK when the processing is successful.]*/
+            result = AGENT_DATA_TYPES_OK;
+        }
+    }
+    else
+    {
+        switch(value->type)
+        {
+            default:
+            {
+                result = AGENT_DATA_TYPES_INVALID_ARG;
+                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                break;
+            }
+            case(EDM_DECIMAL_TYPE) :
+            {
+                if (STRING_concat_with_STRING(destination, value->value.edmDecimal.value) != 0)
                 {
                     result = AGENT_DATA_TYPES_ERROR;
                     LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
@@ -1884,210 +2055,37 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                                 tempBuffer[w++] = '0';
                                 tempBuffer[w++] = '0';
                                 tempBuffer[w++] = hexToASCII[(v[i] & 0xF0) >> 4]; /*high nibble*/
-                                tempBuffer[w++] = hexToASCII[v[i] & 0x0F]; /*lowNibble nibble*/
-                            }
-                            else if (v[i] == '"')
-                            {
-                                tempBuffer[w++] = '\\';
-                                tempBuffer[w++] = '"';
-                            }
-                            else if (v[i] == '\\')
-                            {
-                                tempBuffer[w++] = '\\';
-                                tempBuffer[w++] = '\\';
-                            }
-                            else if (v[i] == '/')
-                            {
-                                tempBuffer[w++] = '\\';
-                                tempBuffer[w++] = '/';
-                            }
-                            else
-                            {
-                                tempBuffer[w++] = v[i];
-                            }
-                        }
-
-#ifdef _MSC_VER
-#pragma warning(suppress: 6386) /* The test Create_AGENT_DATA_TYPE_from_charz_With_2_Slashes_Succeeds verifies that Code Analysis is wrong here */
-#endif
-                        tempBuffer[w] = '"';
-                        /*zero terminating it*/
-                        tempBuffer[vlen + 5 * nControlCharacters + nEscapeCharacters + 3 - 1] = '\0';
-
-                        if (STRING_concat(destination, tempBuffer) != 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
-
-                        free(tempBuffer);
-                    }
-                }
-
-                break;
-            }
-
-            /* Codes_SRS_AGENT_TYPE_SYSTEM_01_003: [EDM_STRING_no_quotes: the string is copied as given when the AGENT_DATA_TYPE was created.] */
-            case (EDM_STRING_NO_QUOTES_TYPE) :
-            {
-                /* this is a special case where we just want to copy/paste the contents, no encoding, no quotes */
-                /* Codes_SRS_AGENT_TYPE_SYSTEM_01_002: [When serialized, this type is not enclosed with quotes.] */
-                if (STRING_concat(destination, value->value.edmStringNoQuotes.chars) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-
-                break;
-            }
-
-#ifndef NO_FLOATS
-            case(EDM_SINGLE_TYPE):
-            {
-                /*C89 standard says: When a float is promoted to double or long double, or a double is promoted to long double, its value is unchanged*/
-                /*I read that as : when a float is NaN or Inf, it will stay NaN or INF in double representation*/
-
-                /*The sprintf function returns the number of characters written in the array, not counting the terminating null character.*/
-
-                if(ISNAN(value->value.edmSingle.value))
-                {
-                    if (STRING_concat(destination, NaN_STRING) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                else if (ISNEGATIVEINFINITY(value->value.edmSingle.value))
-                {
-                    if (STRING_concat(destination, MINUSINF_STRING) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                else if (ISPOSITIVEINFINITY(value->value.edmSingle.value))
-                {
-                    if (STRING_concat(destination, PLUSINF_STRING) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                else
-                {
-                    size_t tempBufferSize = MAX_FLOATING_POINT_STRING_LENGTH;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value)) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
-
-                        free(tempBuffer);
-                    }
-                }
-                break;
-            }
-            case(EDM_DOUBLE_TYPE):
-            {
-                /*The sprintf function returns the number of characters written in the array, not counting the terminating null character.*/
-                /*OData-ABNF says these can be used: nanInfinity = 'NaN' / '-INF' / 'INF'*/
-                /*C90 doesn't declare a NaN or Inf in the standard, however, values might be NaN or Inf...*/
-                /*C99 ... does*/
-                /*C11 is same as C99*/
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
-                if(ISNAN(value->value.edmDouble.value))
-                {
-                    if (STRING_concat(destination, NaN_STRING) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
-                else if (ISNEGATIVEINFINITY(value->value.edmDouble.value))
-                {
-                    if (STRING_concat(destination, MINUSINF_STRING) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
-                else if (ISPOSITIVEINFINITY(value->value.edmDouble.value))
-                {
-                    if (STRING_concat(destination, PLUSINF_STRING) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        result = AGENT_DATA_TYPES_OK;
-                    }
-                }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
-                else
-                {
-                    size_t tempBufferSize = DECIMAL_DIG * 2;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                                tempBuffer[w++] = hexToASCII[v[i] & 0x0F]; /*lowNibble nibble*/
+                            }
+                            else if (v[i] == '"')
+                            {
+                                tempBuffer[w++] = '\\';
+                                tempBuffer[w++] = '"';
+                            }
+                            else if (v[i] == '\\')
+                            {
+                                tempBuffer[w++] = '\\';
+                                tempBuffer[w++] = '\\';
+                            }
+                            else if (v[i] == '/')
+                            {
+                                tempBuffer[w++] = '\\';
+                                tempBuffer[w++] = '/';
+                            }
+                            else
+                            {
+                                tempBuffer[w++] = v[i];
+                            }
                         }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
+
+#ifdef _MSC_VER
+#pragma warning(suppress: 6386) /* The test Create_AGENT_DATA_TYPE_from_charz_With_2_Slashes_Succeeds verifies that Code Analysis is wrong here */
+#endif
+                        tempBuffer[w] = '"';
+                        /*zero terminating it*/
+                        tempBuffer[vlen + 5 * nControlCharacters + nEscapeCharacters + 3 - 1] = '\0';
+
+                        if (STRING_concat(destination, tempBuffer) != 0)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
@@ -2100,9 +2098,27 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                         free(tempBuffer);
                     }
                 }
+
+                break;
+            }
+
+            /* Codes_SRS_AGENT_TYPE_SYSTEM_01_003: [EDM_STRING_no_quotes: the string is copied as given when the AGENT_DATA_TYPE was created.] */
+            case (EDM_STRING_NO_QUOTES_TYPE) :
+            {
+                /* this is a special case where we just want to copy/paste the contents, no encoding, no quotes */
+                /* Codes_SRS_AGENT_TYPE_SYSTEM_01_002: [When serialized, this type is not enclosed with quotes.] */
+                if (STRING_concat(destination, value->value.edmStringNoQuotes.chars) != 0)
+                {
+                    result = AGENT_DATA_TYPES_ERROR;
+                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                }
+                else
+                {
+                    result = AGENT_DATA_TYPES_OK;
+                }
+
                 break;
             }
-#endif
 
             case(EDM_COMPLEX_TYPE_TYPE) :
             {
@@ -2155,66 +2171,6 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 }
                 break;
             }
-            case EDM_GUID_TYPE:
-            {
-                char tempBuffer2[1 + 8 + 1 + 4 + 1 + 4 + 1 + 4 + 1 + 12 + 1+ 1];
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_093:[ EDM_GUID: 8HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 12HEXDIG]*/
-                tempBuffer2[0] = '\"';
-                tempBuffer2[1] = hexDigitToChar(value->value.edmGuid.GUID[0] / 16);
-                tempBuffer2[2] = hexDigitToChar(value->value.edmGuid.GUID[0] % 16);
-                tempBuffer2[3] = hexDigitToChar(value->value.edmGuid.GUID[1] / 16);
-                tempBuffer2[4] = hexDigitToChar(value->value.edmGuid.GUID[1] % 16);
-                tempBuffer2[5] = hexDigitToChar(value->value.edmGuid.GUID[2] / 16);
-                tempBuffer2[6] = hexDigitToChar(value->value.edmGuid.GUID[2] % 16);
-                tempBuffer2[7] = hexDigitToChar(value->value.edmGuid.GUID[3] / 16);
-                tempBuffer2[8] = hexDigitToChar(value->value.edmGuid.GUID[3] % 16);
-
-                tempBuffer2[9] = '-';
-                tempBuffer2[10] = hexDigitToChar(value->value.edmGuid.GUID[4] / 16);
-                tempBuffer2[11] = hexDigitToChar(value->value.edmGuid.GUID[4] % 16);
-                tempBuffer2[12] = hexDigitToChar(value->value.edmGuid.GUID[5] / 16);
-                tempBuffer2[13] = hexDigitToChar(value->value.edmGuid.GUID[5] % 16);
-
-                tempBuffer2[14] = '-';
-                tempBuffer2[15] = hexDigitToChar(value->value.edmGuid.GUID[6] / 16);
-                tempBuffer2[16] = hexDigitToChar(value->value.edmGuid.GUID[6] % 16);
-                tempBuffer2[17] = hexDigitToChar(value->value.edmGuid.GUID[7] / 16);
-                tempBuffer2[18] = hexDigitToChar(value->value.edmGuid.GUID[7] % 16);
-
-                tempBuffer2[19] = '-';
-                tempBuffer2[20] = hexDigitToChar(value->value.edmGuid.GUID[8] / 16);
-                tempBuffer2[21] = hexDigitToChar(value->value.edmGuid.GUID[8] % 16);
-                tempBuffer2[22] = hexDigitToChar(value->value.edmGuid.GUID[9] / 16);
-                tempBuffer2[23] = hexDigitToChar(value->value.edmGuid.GUID[9] % 16);
-
-                tempBuffer2[24] = '-';
-                tempBuffer2[25] = hexDigitToChar(value->value.edmGuid.GUID[10] / 16);
-                tempBuffer2[26] = hexDigitToChar(value->value.edmGuid.GUID[10] % 16);
-                tempBuffer2[27] = hexDigitToChar(value->value.edmGuid.GUID[11] / 16);
-                tempBuffer2[28] = hexDigitToChar(value->value.edmGuid.GUID[11] % 16);
-                tempBuffer2[29] = hexDigitToChar(value->value.edmGuid.GUID[12] / 16);
-                tempBuffer2[30] = hexDigitToChar(value->value.edmGuid.GUID[12] % 16);
-                tempBuffer2[31] = hexDigitToChar(value->value.edmGuid.GUID[13] / 16);
-                tempBuffer2[32] = hexDigitToChar(value->value.edmGuid.GUID[13] % 16);
-                tempBuffer2[33] = hexDigitToChar(value->value.edmGuid.GUID[14] / 16);
-                tempBuffer2[34] = hexDigitToChar(value->value.edmGuid.GUID[14] % 16);
-                tempBuffer2[35] = hexDigitToChar(value->value.edmGuid.GUID[15] / 16);
-                tempBuffer2[36] = hexDigitToChar(value->value.edmGuid.GUID[15] % 16);
-
-                tempBuffer2[37] = '\"';
-                tempBuffer2[38] = '\0';
-
-                if (STRING_concat(destination, tempBuffer2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
             case EDM_BINARY_TYPE:
             {
                 size_t currentPosition = 0;
@@ -2987,159 +2943,645 @@ static void fill_tm_yday_and_tm_wday(struct tm* source)
     /*the function shall count days */
 }
 
-/*the following function does the same as  sscanf(pos2, ":%02d", &sec)*/
-/*this function only exists because of optimizing valgrind time, otherwise sscanf would be just as good*/
-static int sscanf2d(const char *pos2, int* sec)
+/*the scanners below share one cursor based convention: cursor points to the first character to be scanned*/
+/*on success they return 0 and advance *cursor past the consumed characters, on failure they return a non-zero value and do not move *cursor*/
+/*they do not allocate. Only the slow path of the floating point scanners calls strtod/strtof*/
+/* Codes_SRS_AGENT_TYPE_SYSTEM_02_008: [ CreateAgentDataType_From_String shall not use the C library scanf family. ]*/
+
+/*scans exactly N digits (not followed by another digit) into value*/
+static int scanNDigits(const char** cursor, size_t N, int* value)
 {
     int result;
-    size_t position = 1;
-    if (
-        (pos2[0] == ':') &&
-        (scanAndReadNDigitsInt(pos2, &position, sec, 2) == 0)
-        )
+    const char* p = *cursor;
+    int temp = 0;
+    size_t i;
+
+    for (i = 0; (i < N) && IS_DIGIT(*p); i++, p++)
     {
-        result = 1;
+        temp = temp * 10 + (*p - '0');
+    }
+
+    if ((i != N) || IS_DIGIT(*p))
+    {
+        result = __FAILURE__;
     }
     else
     {
-        result = EOF;
+        *value = temp;
+        *cursor = p;
+        result = 0;
+    }
+    return result;
+}
+
+/*scans 1*DIGIT into value, fails if the value is greater than maxValue*/
+static int scanUnsignedDecimal(const char** cursor, uint64_t maxValue, uint64_t* value)
+{
+    int result;
+    const char* p = *cursor;
+    uint64_t temp = 0;
+
+    if (!IS_DIGIT(*p))
+    {
+        result = __FAILURE__;
     }
+    else
+    {
+        result = 0;
+        do
+        {
+            uint64_t digit = (uint64_t)(*p - '0');
+            if (temp > (maxValue - digit) / 10)
+            {
+                result = __FAILURE__;
+                break;
+            }
+            temp = temp * 10 + digit;
+            p++;
+        } while (IS_DIGIT(*p));
 
+        if (result == 0)
+        {
+            *value = temp;
+            *cursor = p;
+        }
+    }
     return result;
+}
+
+/*scans *WHITESPACE followed by the end of the string*/
+/*numbers are only valid when nothing else follows them, so "12abc" and "0x10" are rejected instead of producing the value of the digits in front*/
+/* Codes_SRS_AGENT_TYPE_SYSTEM_02_013: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DOUBLE and EDM_SINGLE shall be rejected if anything other than whitespace follows the number. ]*/
+static int scanEndOfNumber(const char** cursor)
+{
+    int result;
+    const char* p = *cursor;
+
+    while (IS_WHITESPACE(*p))
+    {
+        p++;
+    }
 
+    if (*p != '\0')
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        *cursor = p;
+        result = 0;
+    }
+    return result;
 }
 
-/*the following function does the same as  sscanf(pos2, "%d", &sec)*/
-/*this function only exists because of optimizing valgrind time, otherwise sscanf would be just as good*/
-static int sscanfd(const char *src, int* dst)
+/*scans *WHITESPACE [ "+" / "-" ] 1*DIGIT *WHITESPACE followed by the end of the string, fails if the value does not fit in int64_t*/
+/* Codes_SRS_AGENT_TYPE_SYSTEM_02_009: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32 and EDM_INT64 shall be read from optional whitespace, an optional sign and decimal digits; values outside of the range of the type shall be rejected. ]*/
+static int scanSignedDecimal(const char** cursor, int64_t* value)
 {
     int result;
-    char* next;
-    long int temp = strtol(src, &next, 10);
-    if ((src == next) || (((temp == LONG_MAX) || (temp == LONG_MIN)) && (errno != 0)))
+    const char* p = *cursor;
+    bool isNegative = false;
+    uint64_t magnitude;
+
+    while (IS_WHITESPACE(*p))
+    {
+        p++;
+    }
+
+    if (*p == '-')
+    {
+        isNegative = true;
+        p++;
+    }
+    else if (*p == '+')
     {
-        result = EOF;
+        p++;
+    }
+
+    if ((scanUnsignedDecimal(&p, isNegative ? 9223372036854775808ULL : 9223372036854775807ULL, &magnitude) != 0) ||
+        (scanEndOfNumber(&p) != 0))
+    {
+        result = __FAILURE__;
     }
     else
     {
-        (*dst) = (int)temp;
-        result = 1;
+        if (!isNegative)
+        {
+            *value = (int64_t)magnitude;
+        }
+        else if (magnitude == 9223372036854775808ULL)
+        {
+            *value = -9223372036854775807LL - 1LL;
+        }
+        else
+        {
+            *value = -(int64_t)magnitude;
+        }
+        *cursor = p;
+        result = 0;
+    }
+    return result;
+}
+
+/*the decimal digits of a floating point number, as scanned by scanFloatingPointDigits*/
+typedef struct FLOATING_POINT_DIGITS_TAG
+{
+    bool isNegative;
+    uint64_t mantissa;     /*the first (at most) 19 significant digits*/
+    bool isTruncated;      /*true if there were non-zero digits after the first 19 significant digits*/
+    int decimalExponent;   /*value = mantissa * 10^decimalExponent (when not truncated)*/
+    const char* digitsBegin; /*first character of the [int] [. frac] part*/
+    const char* digitsEnd;   /*character after the [int] [. frac] part*/
+    int exponent;          /*the value of the e[sign]digits part, clamped*/
+} FLOATING_POINT_DIGITS;
+
+/*scans *WHITESPACE [sign] ( 1*DIGIT ["." *DIGIT] / "." 1*DIGIT ) [ ("e"/"E") [sign] 1*DIGIT ] *WHITESPACE followed by the end of the string*/
+/*NaN and infinities are handled by CreateAgentDataType_From_String*/
+static int scanFloatingPointDigits(const char** cursor, FLOATING_POINT_DIGITS* digits)
+{
+    int result;
+    const char* p = *cursor;
+    bool hasDigits = false;
+    int nSignificantDigits = 0;
+    int droppedDigits = 0; /*significant digits before the '.' that did not fit in mantissa*/
+    int fractionDigits = 0; /*digits after the '.' that made it into mantissa, or that were zeroes in front of the first significant digit*/
+
+    digits->isNegative = false;
+    digits->mantissa = 0;
+    digits->isTruncated = false;
+    digits->exponent = 0;
+
+    while (IS_WHITESPACE(*p))
+    {
+        p++;
+    }
+
+    if (*p == '-')
+    {
+        digits->isNegative = true;
+        p++;
+    }
+    else if (*p == '+')
+    {
+        p++;
+    }
+
+    digits->digitsBegin = p;
+
+    while (IS_DIGIT(*p))
+    {
+        hasDigits = true;
+        if ((digits->mantissa == 0) && (*p == '0'))
+        {
+            /*leading zero*/
+        }
+        else if (nSignificantDigits < 19)
+        {
+            digits->mantissa = digits->mantissa * 10 + (uint64_t)(*p - '0');
+            nSignificantDigits++;
+        }
+        else
+        {
+            droppedDigits++;
+            digits->isTruncated |= (*p != '0');
+        }
+        p++;
+    }
+
+    if (*p == '.')
+    {
+        p++;
+        while (IS_DIGIT(*p))
+        {
+            hasDigits = true;
+            if ((digits->mantissa == 0) && (*p == '0'))
+            {
+                fractionDigits++;
+            }
+            else if (nSignificantDigits < 19)
+            {
+                digits->mantissa = digits->mantissa * 10 + (uint64_t)(*p - '0');
+                nSignificantDigits++;
+                fractionDigits++;
+            }
+            else
+            {
+                digits->isTruncated |= (*p != '0');
+            }
+            p++;
+        }
+    }
+
+    digits->digitsEnd = p;
+
+    if (!hasDigits)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        if ((*p == 'e') || (*p == 'E'))
+        {
+            const char* e = p + 1;
+            bool isExponentNegative = false;
+            if (*e == '-')
+            {
+                isExponentNegative = true;
+                e++;
+            }
+            else if (*e == '+')
+            {
+                e++;
+            }
+
+            if (IS_DIGIT(*e))
+            {
+                while (IS_DIGIT(*e))
+                {
+                    if (digits->exponent < 100000) /*anything bigger is 0 or overflow anyway*/
+                    {
+                        digits->exponent = digits->exponent * 10 + (*e - '0');
+                    }
+                    e++;
+                }
+                if (isExponentNegative)
+                {
+                    digits->exponent = -digits->exponent;
+                }
+                p = e;
+            }
+            else
+            {
+                /*"1e" is "1" followed by "e", which is rejected below*/
+            }
+        }
+
+        if (scanEndOfNumber(&p) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            digits->decimalExponent = droppedDigits - fractionDigits + digits->exponent;
+            *cursor = p;
+            result = 0;
+        }
     }
+
     return result;
 }
 
-/*the following function does the same as  sscanf(src, "%llu", &dst), but, it changes the src pointer.*/
-static int sscanfllu(const char** src, unsigned long long* dst)
+/*a correctly rounded double can depend on up to 767 significant digits, the ones after that can only act as a sticky bit*/
+#define MAX_SLOW_PATH_DIGITS 780
+
+/*writes the significant digits of [digitsBegin, digitsEnd) followed by e<exponent>, without a decimal point*/
+static void writeNormalizedNumber(const FLOATING_POINT_DIGITS* digits, char* destination)
+{
+    const char* p;
+    size_t pos = 0;
+    size_t nSignificantDigits = 0;
+    bool seenPoint = false;
+    bool seenSignificant = false;
+    bool isSticky = false;
+    long exponent = digits->exponent;
+
+    if (digits->isNegative)
+    {
+        destination[pos++] = '-';
+    }
+
+    for (p = digits->digitsBegin; p < digits->digitsEnd; p++)
+    {
+        if (*p == '.')
+        {
+            seenPoint = true;
+        }
+        else if (!seenSignificant && (*p == '0'))
+        {
+            if (seenPoint)
+            {
+                exponent--;
+            }
+        }
+        else
+        {
+            seenSignificant = true;
+            if (nSignificantDigits < MAX_SLOW_PATH_DIGITS)
+            {
+                destination[pos++] = *p;
+                nSignificantDigits++;
+                if (seenPoint)
+                {
+                    exponent--;
+                }
+            }
+            else
+            {
+                if (!seenPoint)
+                {
+                    exponent++;
+                }
+                isSticky |= (*p != '0');
+            }
+        }
+    }
+
+    if (nSignificantDigits == 0)
+    {
+        destination[pos++] = '0';
+    }
+
+    if (isSticky)
+    {
+        /*the value is strictly greater than the digits kept, a trailing 1 keeps it that way*/
+        destination[pos++] = '1';
+        exponent--;
+    }
+
+    destination[pos++] = 'e';
+    pos += WriteSignedDecimal(destination + pos, exponent, 1, false);
+    destination[pos] = '\0';
+}
+
+static const double exactPowersOf10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*scans a decimal number into a correctly rounded double*/
+/* Codes_SRS_AGENT_TYPE_SYSTEM_02_010: [ EDM_DOUBLE and EDM_SINGLE shall be read from optional whitespace, an optional sign, decimal digits with an optional '.' and an optional exponent, and shall be rounded to the nearest representable value (ties to even). ]*/
+static int scanDouble(const char** cursor, double* value)
 {
-    int result = 1;
-    char* next;
-    (*dst) = strtoull((*src), &next, 10);
-    if (((*src) == (const char*)next) || (((*dst) == ULLONG_MAX) && (errno != 0)))
+    int result;
+    const char* p = *cursor;
+    FLOATING_POINT_DIGITS digits;
+
+    if (scanFloatingPointDigits(&p, &digits) != 0)
     {
-        result = EOF;
+        result = __FAILURE__;
+    }
+    else
+    {
+        double temp;
+        result = 0;
+        if (digits.mantissa == 0)
+        {
+            temp = 0.0;
+        }
+#if defined(FLT_EVAL_METHOD) && ((FLT_EVAL_METHOD == 0) || (FLT_EVAL_METHOD == 1))
+        /*Clinger's fast path: when both the mantissa and 10^decimalExponent are exact doubles, a single IEEE multiplication or division is correctly rounded*/
+        else if (
+            (!digits.isTruncated) &&
+            (digits.mantissa <= (1ULL << 53)) &&
+            (digits.decimalExponent >= -22) &&
+            (digits.decimalExponent <= 22)
+            )
+        {
+            temp = (double)digits.mantissa;
+            if (digits.decimalExponent < 0)
+            {
+                temp /= exactPowersOf10[-digits.decimalExponent];
+            }
+            else
+            {
+                temp *= exactPowersOf10[digits.decimalExponent];
+            }
+        }
+#endif
+        else
+        {
+            /*slow path, rare for telemetry: C library does the rounding on a string that has no decimal point*/
+            char normalized[1 + MAX_SLOW_PATH_DIGITS + 1 + 1 + 12 + 1];
+            writeNormalizedNumber(&digits, normalized);
+            temp = fabs(strtod(normalized, NULL));
+            if (ISPOSITIVEINFINITY(temp))
+            {
+                /* Codes_SRS_AGENT_TYPE_SYSTEM_02_011: [ EDM_DOUBLE and EDM_SINGLE values that overflow the type shall be rejected. ]*/
+                result = __FAILURE__;
+            }
+        }
+
+        if (result == 0)
+        {
+            *value = digits.isNegative ? -temp : temp;
+            *cursor = p;
+        }
     }
-    (*src) = (const char*)next;
     return result;
 }
 
-/*the following function does the same as  sscanf(src, ".%llu", &dst)*/
-static int sscanfdotllu(const char*src, unsigned long long* dst)
+static const float exactPowersOf10f[] =
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/*scans a decimal number into a correctly rounded float (not a double rounded to float, that could be off by one ulp)*/
+static int scanFloat(const char** cursor, float* value)
 {
     int result;
+    const char* p = *cursor;
+    FLOATING_POINT_DIGITS digits;
 
-    if ((*src) != '.')
+    if (scanFloatingPointDigits(&p, &digits) != 0)
     {
-        /*doesn't start with '.' error out*/
-        result = EOF;
+        result = __FAILURE__;
     }
     else
     {
-        src++;
-        result = sscanfllu(&src, dst);
-    }
+        float temp;
+        result = 0;
+        if (digits.mantissa == 0)
+        {
+            temp = 0.0f;
+        }
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+        else if (
+            (!digits.isTruncated) &&
+            (digits.mantissa <= (1ULL << 24)) &&
+            (digits.decimalExponent >= -10) &&
+            (digits.decimalExponent <= 10)
+            )
+        {
+            temp = (float)digits.mantissa;
+            if (digits.decimalExponent < 0)
+            {
+                temp /= exactPowersOf10f[-digits.decimalExponent];
+            }
+            else
+            {
+                temp *= exactPowersOf10f[digits.decimalExponent];
+            }
+        }
+#endif
+        else
+        {
+            char normalized[1 + MAX_SLOW_PATH_DIGITS + 1 + 1 + 12 + 1];
+            writeNormalizedNumber(&digits, normalized);
+            temp = fabsf(strtof(normalized, NULL));
+            if (ISPOSITIVEINFINITY(temp))
+            {
+                /* Codes_SRS_AGENT_TYPE_SYSTEM_02_011: [ EDM_DOUBLE and EDM_SINGLE values that overflow the type shall be rejected. ]*/
+                result = __FAILURE__;
+            }
+        }
 
+        if (result == 0)
+        {
+            *value = digits.isNegative ? -temp : temp;
+            *cursor = p;
+        }
+    }
     return result;
 }
 
-/*the following function does the same as  sscanf(src, "%u", &dst)*/
-static int sscanfu(const char* src, uint32_t* dst)
+/*the fields of an EDM_DATE_TIME_OFFSET, as scanned by scanDateTimeOffset*/
+typedef struct DATE_TIME_OFFSET_FIELDS_TAG
+{
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+    bool hasFractionalSecond;
+    uint64_t fractionalSecond;
+    bool hasTimeZone;
+    int hourOffset;
+    int minuteOffset;
+} DATE_TIME_OFFSET_FIELDS;
+
+/*scans the inside of a quoted EDM_DATE_TIME_OFFSET: ["-"] 4DIGIT "-" 2DIGIT "-" 2DIGIT "T" 2DIGIT ":" 2DIGIT [":" 2DIGIT] ["." 1*DIGIT] ("Z" / sign 2DIGIT ":" 2DIGIT / 3DIGIT ":" 2DIGIT)*/
+/*fields are not range checked, that is left to the caller*/
+static int scanDateTimeOffset(const char** cursor, DATE_TIME_OFFSET_FIELDS* fields)
 {
     int result;
-    char* next;
-    unsigned long int temp = strtoul(src, &next, 10);
-    if ((src == next) || ((temp == ULONG_MAX) && (errno != 0)))
+    const char* p = *cursor;
+    int sign = 1;
+
+    fields->second = 0;
+    fields->fractionalSecond = 0;
+    fields->hasFractionalSecond = false;
+    fields->hasTimeZone = false;
+    fields->hourOffset = 0;
+    fields->minuteOffset = 0;
+
+    if (*p == '-')
+    {
+        sign = -1;
+        p++;
+    }
+
+    if ((scanNDigits(&p, 4, &fields->year) != 0) ||
+        (*p++ != '-') ||
+        (scanNDigits(&p, 2, &fields->month) != 0) ||
+        (*p++ != '-') ||
+        (scanNDigits(&p, 2, &fields->day) != 0) ||
+        (*p++ != 'T') ||
+        (scanNDigits(&p, 2, &fields->hour) != 0) ||
+        (*p++ != ':') ||
+        (scanNDigits(&p, 2, &fields->minute) != 0))
     {
-        result = EOF;
+        result = __FAILURE__;
     }
     else
     {
-        result = 1;
-        (*dst) = (uint32_t)temp;
+        result = 0;
+        fields->year *= sign;
+
+        if (*p == ':')
+        {
+            p++;
+            result = scanNDigits(&p, 2, &fields->second);
+        }
+
+        if ((result == 0) && (*p == '.'))
+        {
+            p++;
+            fields->hasFractionalSecond = true;
+            result = scanUnsignedDecimal(&p, 999999999999ULL, &fields->fractionalSecond);
+        }
+
+        if (result != 0)
+        {
+            /*already failed*/
+        }
+        else if (*p == 'Z')
+        {
+            p++;
+        }
+        else
+        {
+            bool isNegative = (*p == '-');
+            if ((*p == '-') || (*p == '+'))
+            {
+                p++;
+                result = scanNDigits(&p, 2, &fields->hourOffset);
+            }
+            else
+            {
+                result = scanNDigits(&p, 3, &fields->hourOffset);
+            }
+
+            if ((result != 0) ||
+                (*p++ != ':') ||
+                (scanNDigits(&p, 2, &fields->minuteOffset) != 0))
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                fields->hasTimeZone = true;
+                if (isNegative)
+                {
+                    fields->hourOffset = -fields->hourOffset;
+                }
+            }
+        }
     }
-    return result;
-}
 
-/*the following function does the same as  sscanf(src, "%f", &dst)*/
-static int sscanff(const char*src, float* dst)
-{
-    int result = 1;
-    char* next;
-    (*dst) = strtof(src, &next);
-    if ((src == next) || (((*dst) == HUGE_VALF) && (errno != 0)))
+    if (result == 0)
     {
-        result = EOF;
+        *cursor = p;
     }
-    return result;
-}
-
-/*the following function does the same as  sscanf(src, "%lf", &dst)*/
-static int sscanflf(const char*src, double* dst)
-{
-    int result = 1;
-    char* next;
-    (*dst) = strtod(src, &next);
-    if ((src == next) || (((*dst) == HUGE_VALL) && (errno != 0)))
+    else
     {
-        result = EOF;
+        result = __FAILURE__;
     }
     return result;
 }
 
-
-/*the below function replaces sscanf(src, "%03d:%02d\"", &hourOffset, &minOffset)*/
-/*return 2 if success*/
-
-static int sscanf3d2d(const char* src, int* hourOffset, int* minOffset)
+/*scans the inside of a quoted EDM_GUID: 8HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 4HEXDIG "-" 12HEXDIG (capital letters only)*/
+static int scanGuid(const char** cursor, EDM_GUID* value)
 {
-    size_t position = 0;
-    int result = EOF;
-    bool isNegative = false;
+    int result = 0;
+    const char* p = *cursor;
+    size_t i;
 
-    if (*src == '+')
-    {
-        position++;
-    }
-    else if (*src == '-')
+    for (i = 0; i < 16; i++)
     {
-        isNegative = true;
-        position++;
-    }
+        if ((i == 4) || (i == 6) || (i == 8) || (i == 10))
+        {
+            if (*p != '-')
+            {
+                result = __FAILURE__;
+                break;
+            }
+            p++;
+        }
 
-    if (
-        (scanAndReadNDigitsInt(src, &position, hourOffset, (3-position)) == 0) &&
-        (src[position++] == ':') &&
-        (scanAndReadNDigitsInt(src, &position, minOffset, 2) == 0)
-        )
-    {
-        result = 2;
+        if (scanMandatory2CapitalHexDigits(p, &value->GUID[i]) != 0)
+        {
+            result = __FAILURE__;
+            break;
+        }
+        p += 2;
     }
-    else
+
+    if (result == 0)
     {
-        result = 0;
+        *cursor = p;
     }
-    if (isNegative)
-        *hourOffset *= -1;
-
     return result;
 }
 
@@ -3212,8 +3654,9 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_084:[ EDM_SBYTE] */
             case EDM_SBYTE_TYPE:
             {
-                int sByteValue;
-                if ((sscanfd(source, &sByteValue) != 1) ||
+                const char* pos = source;
+                int64_t sByteValue;
+                if ((scanSignedDecimal(&pos, &sByteValue) != 0) ||
                     (sByteValue < -128) ||
                     (sByteValue > 127))
                 {
@@ -3234,8 +3677,9 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_077:[ EDM_BYTE] */
             case EDM_BYTE_TYPE:
             {
-                int byteValue;
-                if ((sscanfd(source, &byteValue) != 1) ||
+                const char* pos = source;
+                int64_t byteValue;
+                if ((scanSignedDecimal(&pos, &byteValue) != 0) ||
                     (byteValue < 0) ||
                     (byteValue > 255))
                 {
@@ -3256,8 +3700,9 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_081:[ EDM_INT16] */
             case EDM_INT16_TYPE:
             {
-                int int16Value;
-                if ((sscanfd(source, &int16Value) != 1) ||
+                const char* pos = source;
+                int64_t int16Value;
+                if ((scanSignedDecimal(&pos, &int16Value) != 0) ||
                     (int16Value < -32768) ||
                     (int16Value > 32767))
                 {
@@ -3278,29 +3723,13 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_082:[ EDM_INT32] */
             case EDM_INT32_TYPE:
             {
-                int32_t int32Value;
-                unsigned char isNegative;
-                uint32_t uint32Value;
-                const char* pos;
-                size_t strLength;
-
-                if (source[0] == '-')
-                {
-                    isNegative = 1;
-                    pos = &source[1];
-                }
-                else
-                {
-                    isNegative = 0;
-                    pos = &source[0];
-                }
-
-                strLength = strlen(source);
+                const char* pos = source;
+                int64_t int32Value;
 
-                if ((sscanfu(pos, &uint32Value) != 1) ||
-                    (strLength > 11) ||
-                    ((uint32Value > 2147483648UL) && isNegative) ||
-                    ((uint32Value > 2147483647UL) && (!isNegative)))
+                if ((scanSignedDecimal(&pos, &int32Value) != 0) ||
+                    (strlen(source) > 11) ||
+                    (int32Value < INT32_MIN) ||
+                    (int32Value > INT32_MAX))
                 {
                     /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
                     result = AGENT_DATA_TYPES_INVALID_ARG;
@@ -3308,22 +3737,6 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
                 }
                 else
                 {
-                    if (isNegative)
-                    {
-                        if (uint32Value == 2147483648UL)
-                        {
-                           int32Value = -2147483647L - 1L;
-                        }
-                        else
-                        {
-                            int32Value = -(int32_t)uint32Value;
-                        }
-                    }
-                    else
-                    {
-                        int32Value = uint32Value;
-                    }
-
                     agentData->type = EDM_INT32_TYPE;
                     agentData->value.edmInt32.value = (int32_t)int32Value;
                     result = AGENT_DATA_TYPES_OK;
@@ -3335,29 +3748,11 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_083:[ EDM_INT64] */
             case EDM_INT64_TYPE:
             {
-                long long int64Value;
-                unsigned char isNegative;
-                unsigned long long ullValue;
-                const char* pos;
-                size_t strLength;
-
-                if (source[0] == '-')
-                {
-                    isNegative = 1;
-                    pos = &source[1];
-                }
-                else
-                {
-                    isNegative = 0;
-                    pos = &source[0];
-                }
-
-                strLength = strlen(source);
+                const char* pos = source;
+                int64_t int64Value;
 
-                if ((sscanfllu(&pos, &ullValue) != 1) ||
-                    (strLength > 20) ||
-                    ((ullValue > 9223372036854775808ULL) && isNegative) ||
-                    ((ullValue > 9223372036854775807ULL) && (!isNegative)))
+                if ((scanSignedDecimal(&pos, &int64Value) != 0) ||
+                    (strlen(source) > 20))
                 {
                     /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
                     result = AGENT_DATA_TYPES_INVALID_ARG;
@@ -3365,23 +3760,8 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
                 }
                 else
                 {
-                    if (isNegative)
-                    {
-                        if (ullValue == 9223372036854775808ULL)
-                        {
-                            int64Value = -9223372036854775807LL - 1LL;
-                        }
-                        else
-                        {
-                            int64Value = -(long long)ullValue;
-                        }
-                    }
-                    else
-                    {
-                        int64Value = ullValue;
-                    }
                     agentData->type = EDM_INT64_TYPE;
-                    agentData->value.edmInt64.value = (int64_t)int64Value;
+                    agentData->value.edmInt64.value = int64Value;
                     result = AGENT_DATA_TYPES_OK;
                 }
 
@@ -3406,15 +3786,19 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
                 }
                 else
                 {
-                    size_t pos = 1;
-                    int sign;
-                    scanOptionalMinusSign(source, 2, &pos, &sign);
+                    const char* pos = source + 1;
+                    int sign = 1;
+                    if (*pos == '-')
+                    {
+                        sign = -1;
+                        pos++;
+                    }
 
-                    if ((scanAndReadNDigitsInt(source, &pos, &year, 4) != 0) ||
-                        (source[pos++] != '-') ||
-                        (scanAndReadNDigitsInt(source, &pos, &month, 2) != 0) ||
-                        (source[pos++] != '-') ||
-                        (scanAndReadNDigitsInt(source, &pos, &day, 2) != 0) ||
+                    if ((scanNDigits(&pos, 4, &year) != 0) ||
+                        (*pos++ != '-') ||
+                        (scanNDigits(&pos, 2, &month) != 0) ||
+                        (*pos++ != '-') ||
+                        (scanNDigits(&pos, 2, &day) != 0) ||
                         (Create_AGENT_DATA_TYPE_from_date(agentData, (int16_t)(sign*year), (uint8_t)month, (uint8_t)day) != AGENT_DATA_TYPES_OK))
                     {
                         /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
@@ -3433,15 +3817,8 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_078:[ EDM_DATETIMEOFFSET] */
             case EDM_DATE_TIME_OFFSET_TYPE:
             {
-                int year;
-                int month;
-                int day;
-                int hour;
-                int min;
-                int sec = 0;
-                int hourOffset;
-                int minOffset;
-                unsigned long long fractionalSeconds = 0;
+                DATE_TIME_OFFSET_FIELDS fields;
+                const char* pos = source + 1;
                 size_t strLength = strlen(source);
 
                 agentData->value.edmDateTimeOffset.hasFractionalSecond = 0;
@@ -3452,7 +3829,26 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
 
                 if ((strLength < 2) ||
                     (source[0] != '"') ||
-                    (source[strLength - 1] != '"'))
+                    (source[strLength - 1] != '"') ||
+                    /* Codes_SRS_AGENT_TYPE_SYSTEM_02_012: [ EDM_DATE_TIME_OFFSET shall be read from "[-]YYYY-MM-DDThh:mm[:ss][.fraction](Z|+hh:mm|-hh:mm|hhh:mm)" and nothing else shall follow between the time zone and the closing quote. ]*/
+                    (scanDateTimeOffset(&pos, &fields) != 0) ||
+                    (pos != source + strLength - 1))
+                {
+                    /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
+                    result = AGENT_DATA_TYPES_INVALID_ARG;
+                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                }
+                else if ((ValidateDate(fields.year, fields.month, fields.day) != 0) ||
+                    (fields.hour < 0) ||
+                    (fields.hour > 23) ||
+                    (fields.minute < 0) ||
+                    (fields.minute > 59) ||
+                    (fields.second < 0) ||
+                    (fields.second > 59) ||
+                    (fields.hourOffset < -23) ||
+                    (fields.hourOffset > 23) ||
+                    (fields.minuteOffset < 0) ||
+                    (fields.minuteOffset > 59))
                 {
                     /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
                     result = AGENT_DATA_TYPES_INVALID_ARG;
@@ -3460,137 +3856,21 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
                 }
                 else
                 {
-                    size_t pos = 1;
-                    int sign;
-                    scanOptionalMinusSign(source, 2, &pos, &sign);
-
-                    if ((scanAndReadNDigitsInt(source, &pos, &year, 4) != 0) ||
-                        (source[pos++] != '-') ||
-                        (scanAndReadNDigitsInt(source, &pos, &month, 2) != 0) ||
-                        (source[pos++] != '-') ||
-                        (scanAndReadNDigitsInt(source, &pos, &day, 2) != 0) ||
-                        (source[pos++] != 'T') ||
-                        (scanAndReadNDigitsInt(source, &pos, &hour, 2) != 0) ||
-                        (source[pos++] != ':') ||
-                        (scanAndReadNDigitsInt(source, &pos, &min, 2) != 0))
-                    {
-                        /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        const char* pos2;
-                        year = year*sign;
-                        if ((pos2 = strchr(source, ':')) == NULL)
-                        {
-                            /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                            result = AGENT_DATA_TYPES_INVALID_ARG;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            pos2 += 3;
-                            if (*pos2 == ':')
-                            {
-                                if (sscanf2d(pos2, &sec) != 1)
-                                {
-                                    pos2 = NULL;
-                                }
-                                else
-                                {
-                                    pos2 += 3;
-                                }
-                            }
-
-                            if ((pos2 != NULL) &&
-                                (*pos2 == '.'))
-                            {
-                                if (sscanfdotllu(pos2, &fractionalSeconds) != 1)
-                                {
-                                    pos2 = NULL;
-                                }
-                                else
-                                {
-                                    pos2++;
-
-                                    agentData->value.edmDateTimeOffset.hasFractionalSecond = 1;
-
-                                    while ((*pos2 != '\0') &&
-                                        (IS_DIGIT(*pos2)))
-                                    {
-                                        pos2++;
-                                    }
-
-                                    if (*pos2 == '\0')
-                                    {
-                                        pos2 = NULL;
-                                    }
-                                }
-                            }
-
-                            if (pos2 == NULL)
-                            {
-                                /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                                result = AGENT_DATA_TYPES_INVALID_ARG;
-                                LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                hourOffset = 0;
-                                minOffset = 0;
-
-                                if (sscanf3d2d(pos2, &hourOffset, &minOffset) == 2)
-                                {
-                                    agentData->value.edmDateTimeOffset.hasTimeZone = 1;
-                                }
-
-                                if ((strcmp(pos2, "Z\"") == 0) ||
-                                    agentData->value.edmDateTimeOffset.hasTimeZone)
-                                {
-                                    if ((ValidateDate(year, month, day) != 0) ||
-                                        (hour < 0) ||
-                                        (hour > 23) ||
-                                        (min < 0) ||
-                                        (min > 59) ||
-                                        (sec < 0) ||
-                                        (sec > 59) ||
-                                        (fractionalSeconds > 999999999999) ||
-                                        (hourOffset < -23) ||
-                                        (hourOffset > 23) ||
-                                        (minOffset < 0) ||
-                                        (minOffset > 59))
-                                    {
-                                        /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                                        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                                    }
-                                    else
-                                    {
-                                        agentData->type = EDM_DATE_TIME_OFFSET_TYPE;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_year= year-1900;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_mon = month-1;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_mday = day;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_hour = hour;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_min = min;
-                                        agentData->value.edmDateTimeOffset.dateTime.tm_sec = sec;
-                                        /*fill in tm_wday and tm_yday*/
-                                        fill_tm_yday_and_tm_wday(&agentData->value.edmDateTimeOffset.dateTime);
-                                        agentData->value.edmDateTimeOffset.fractionalSecond = (uint64_t)fractionalSeconds;
-                                        agentData->value.edmDateTimeOffset.timeZoneHour = (int8_t)hourOffset;
-                                        agentData->value.edmDateTimeOffset.timeZoneMinute = (uint8_t)minOffset;
-                                        result = AGENT_DATA_TYPES_OK;
-                                    }
-                                }
-                                else
-                                {
-                                    /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
-                                    result = AGENT_DATA_TYPES_INVALID_ARG;
-                                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                                }
-                            }
-                        }
-                    }
+                    agentData->type = EDM_DATE_TIME_OFFSET_TYPE;
+                    agentData->value.edmDateTimeOffset.dateTime.tm_year = fields.year - 1900;
+                    agentData->value.edmDateTimeOffset.dateTime.tm_mon = fields.month - 1;
+                    agentData->value.edmDateTimeOffset.dateTime.tm_mday = fields.day;
+                    agentData->value.edmDateTimeOffset.dateTime.tm_hour = fields.hour;
+                    agentData->value.edmDateTimeOffset.dateTime.tm_min = fields.minute;
+                    agentData->value.edmDateTimeOffset.dateTime.tm_sec = fields.second;
+                    /*fill in tm_wday and tm_yday*/
+                    fill_tm_yday_and_tm_wday(&agentData->value.edmDateTimeOffset.dateTime);
+                    agentData->value.edmDateTimeOffset.hasFractionalSecond = fields.hasFractionalSecond ? 1 : 0;
+                    agentData->value.edmDateTimeOffset.fractionalSecond = fields.fractionalSecond;
+                    agentData->value.edmDateTimeOffset.hasTimeZone = fields.hasTimeZone ? 1 : 0;
+                    agentData->value.edmDateTimeOffset.timeZoneHour = (int8_t)fields.hourOffset;
+                    agentData->value.edmDateTimeOffset.timeZoneMinute = (uint8_t)fields.minuteOffset;
+                    result = AGENT_DATA_TYPES_OK;
                 }
 
                 break;
@@ -3599,19 +3879,21 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_080:[ EDM_DOUBLE] */
             case EDM_DOUBLE_TYPE:
             {
-                if (strcmp(source, "\"NaN\"") == 0)
+                const char* pos = source;
+                /* Codes_SRS_AGENT_TYPE_SYSTEM_02_014: [ EDM_DOUBLE and EDM_SINGLE shall accept NaN, INF and -INF both as written by AgentDataTypes_ToString and enclosed in quotes. ]*/
+                if ((strcmp(source, "\"NaN\"") == 0) || (strcmp(source, NaN_STRING) == 0))
                 {
                     agentData->type = EDM_DOUBLE_TYPE;
                     agentData->value.edmDouble.value = NAN;
                     result = AGENT_DATA_TYPES_OK;
                 }
-                else if (strcmp(source, "\"INF\"") == 0)
+                else if ((strcmp(source, "\"INF\"") == 0) || (strcmp(source, PLUSINF_STRING) == 0))
                 {
                     agentData->type = EDM_DOUBLE_TYPE;
                     agentData->value.edmDouble.value = INFINITY;
                     result = AGENT_DATA_TYPES_OK;
                 }
-                else if (strcmp(source, "\"-INF\"") == 0)
+                else if ((strcmp(source, "\"-INF\"") == 0) || (strcmp(source, MINUSINF_STRING) == 0))
                 {
                     agentData->type = EDM_DOUBLE_TYPE;
 #ifdef _MSC_VER
@@ -3624,7 +3906,7 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
 #endif
                     result = AGENT_DATA_TYPES_OK;
                 }
-                else if (sscanflf(source, &(agentData->value.edmDouble.value)) != 1)
+                else if (scanDouble(&pos, &(agentData->value.edmDouble.value)) != 0)
                 {
                     /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
                     result = AGENT_DATA_TYPES_INVALID_ARG;
@@ -3640,19 +3922,21 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
             /* Codes_SRS_AGENT_TYPE_SYSTEM_99_089:[EDM_SINGLE] */
             case EDM_SINGLE_TYPE:
             {
-                if (strcmp(source, "\"NaN\"") == 0)
+                const char* pos = source;
+                /* Codes_SRS_AGENT_TYPE_SYSTEM_02_014: [ EDM_DOUBLE and EDM_SINGLE shall accept NaN, INF and -INF both as written by AgentDataTypes_ToString and enclosed in quotes. ]*/
+                if ((strcmp(source, "\"NaN\"") == 0) || (strcmp(source, NaN_STRING) == 0))
                 {
                     agentData->type = EDM_SINGLE_TYPE;
                     agentData->value.edmSingle.value = NAN;
                     result = AGENT_DATA_TYPES_OK;
                 }
-                else if (strcmp(source, "\"INF\"") == 0)
+                else if ((strcmp(source, "\"INF\"") == 0) || (strcmp(source, PLUSINF_STRING) == 0))
                 {
                     agentData->type = EDM_SINGLE_TYPE;
                     agentData->value.edmSingle.value = INFINITY;
                     result = AGENT_DATA_TYPES_OK;
                 }
-                else if (strcmp(source, "\"-INF\"") == 0)
+                else if ((strcmp(source, "\"-INF\"") == 0) || (strcmp(source, MINUSINF_STRING) == 0))
                 {
                     agentData->type = EDM_SINGLE_TYPE;
 #ifdef _MSC_VER
@@ -3665,7 +3949,7 @@ AGENT_DATA_TYPES_RESULT CreateAgentDataType_From_String(const char* source, AGEN
 #endif
 result = AGENT_DATA_TYPES_OK;
                 }
-                else if (sscanff(source, &agentData->value.edmSingle.value) != 1)
+                else if (scanFloat(&pos, &(agentData->value.edmSingle.value)) != 0)
                 {
                     /* Codes_SRS_AGENT_TYPE_SYSTEM_99_087:[ CreateAgentDataType_From_String shall return AGENT_DATA_TYPES_INVALID_ARG if source is not a valid string for a value of type type.] */
                     result = AGENT_DATA_TYPES_INVALID_ARG;
@@ -3777,87 +4061,12 @@ result = AGENT_DATA_TYPES_OK;
                 }
                 else
                 {
+                    const char* pos = source + 1;
                     if (source[0] != '"')
                     {
                         result = AGENT_DATA_TYPES_INVALID_ARG;
                     }
-                    else if (scanMandatory2CapitalHexDigits(source + 1, &(agentData->value.edmGuid.GUID[0])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 3, &(agentData->value.edmGuid.GUID[1])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 5, &(agentData->value.edmGuid.GUID[2])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 7, &(agentData->value.edmGuid.GUID[3])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (source[9] != '-')
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 10, &(agentData->value.edmGuid.GUID[4])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 12, &(agentData->value.edmGuid.GUID[5])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (source[14] != '-')
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 15, &(agentData->value.edmGuid.GUID[6])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 17, &(agentData->value.edmGuid.GUID[7])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (source[19] != '-')
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 20, &(agentData->value.edmGuid.GUID[8])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 22, &(agentData->value.edmGuid.GUID[9])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (source[24] != '-')
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 25, &(agentData->value.edmGuid.GUID[10])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 27, &(agentData->value.edmGuid.GUID[11])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 29, &(agentData->value.edmGuid.GUID[12])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 31, &(agentData->value.edmGuid.GUID[13])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 33, &(agentData->value.edmGuid.GUID[14])) != 0)
-                    {
-                        result = AGENT_DATA_TYPES_INVALID_ARG;
-                    }
-                    else if (scanMandatory2CapitalHexDigits(source + 35, &(agentData->value.edmGuid.GUID[15])) != 0)
+                    else if (scanGuid(&pos, &(agentData->value.edmGuid)) != 0)
                     {
                         result = AGENT_DATA_TYPES_INVALID_ARG;
                     }
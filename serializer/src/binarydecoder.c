@@ -0,0 +1,696 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "binarydecoder.h"
+#include "agenttypesystem.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/*maps and arrays nested deeper than this are rejected, the decoder is recursive*/
+#define BINARY_DECODER_MAX_DEPTH 64
+
+/*names of members shorter than this are copied on the stack*/
+#define BINARY_DECODER_SHORT_NAME_SIZE 64
+
+typedef enum BINARY_ITEM_KIND_TAG
+{
+    BINARY_ITEM_MAP,
+    BINARY_ITEM_ARRAY,
+    BINARY_ITEM_TEXT,
+    BINARY_ITEM_BYTES,
+    BINARY_ITEM_UNSIGNED,
+    BINARY_ITEM_NEGATIVE,
+    BINARY_ITEM_BOOLEAN,
+    BINARY_ITEM_NULL,
+    BINARY_ITEM_SINGLE,
+    BINARY_ITEM_DOUBLE
+} BINARY_ITEM_KIND;
+
+typedef struct BINARY_ITEM_TAG
+{
+    BINARY_ITEM_KIND kind;
+    uint64_t argument; /*byte count of strings, number of entries of maps and arrays, magnitude of integers (a negative integer is -1 - argument)*/
+    const unsigned char* bytes; /*content of strings*/
+    uint64_t bits; /*IEEE 754 bits of BINARY_ITEM_SINGLE and BINARY_ITEM_DOUBLE*/
+    bool booleanValue;
+} BINARY_ITEM;
+
+typedef struct BINARY_READER_TAG
+{
+    DATA_ENCODING encoding;
+    const unsigned char* position;
+    const unsigned char* end;
+} BINARY_READER;
+
+static int StringClone(void** destination, const void* source)
+{
+    return mallocAndStrcpy_s((char**)destination, (const char*)source);
+}
+
+static void StringFree(void* value)
+{
+    free(value);
+}
+
+static int ReadBigEndian(BINARY_READER* reader, size_t byteCount, uint64_t* value)
+{
+    int result;
+    if ((size_t)(reader->end - reader->position) < byteCount)
+    {
+        LogError("unexpected end of input");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        *value = 0;
+        for (i = 0; i < byteCount; i++)
+        {
+            *value = (*value << 8) | reader->position[i];
+        }
+        reader->position += byteCount;
+        result = 0;
+    }
+    return result;
+}
+
+/*converts the bits of an IEEE 754 half precision float into the bits of the single precision float having the same value*/
+static uint32_t HalfToSingleBits(uint32_t half)
+{
+    uint32_t sign = (half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t result;
+
+    if (exponent == 0x1F)
+    {
+        /*infinities and NaNs*/
+        result = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        result = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        result = sign;
+    }
+    else
+    {
+        /*subnormal half, it becomes a normal single*/
+        exponent = 113;
+        while ((mantissa & 0x400) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        result = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    return result;
+}
+
+static int ReadCBORItem(BINARY_READER* reader, BINARY_ITEM* item)
+{
+    int result;
+    do
+    {
+        unsigned char initialByte = *(reader->position++);
+        unsigned char majorType = initialByte >> 5;
+        unsigned char additionalInformation = initialByte & 0x1F;
+        uint64_t argument = additionalInformation;
+
+        if (additionalInformation >= 28)
+        {
+            /*Codes_SRS_BINARY_DECODER_02_007: [ Indefinite length items, reserved values, extension types and map keys that are not text strings shall be rejected with BINARY_DECODER_PARSE_ERROR. ]*/
+            LogError("unsupported CBOR additional information %u", (unsigned int)additionalInformation);
+            result = __FAILURE__;
+        }
+        else if ((additionalInformation >= 24) &&
+            (majorType != 7) &&
+            (ReadBigEndian(reader, (size_t)1 << (additionalInformation - 24), &argument) != 0))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+            item->argument = argument;
+            switch (majorType)
+            {
+                case 0:
+                    item->kind = BINARY_ITEM_UNSIGNED;
+                    break;
+                case 1:
+                    item->kind = BINARY_ITEM_NEGATIVE;
+                    break;
+                case 2:
+                    item->kind = BINARY_ITEM_BYTES;
+                    break;
+                case 3:
+                    item->kind = BINARY_ITEM_TEXT;
+                    break;
+                case 4:
+                    item->kind = BINARY_ITEM_ARRAY;
+                    break;
+                case 5:
+                    item->kind = BINARY_ITEM_MAP;
+                    break;
+                case 6:
+                    /*tags only annotate the next item, the item itself is decoded*/
+                    item->kind = BINARY_ITEM_NULL;
+                    if (reader->position == reader->end)
+                    {
+                        LogError("unexpected end of input after a tag");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        result = -1;
+                    }
+                    break;
+                default:
+                {
+                    switch (additionalInformation)
+                    {
+                        case 20:
+                        case 21:
+                            item->kind = BINARY_ITEM_BOOLEAN;
+                            item->booleanValue = (additionalInformation == 21);
+                            break;
+                        case 22:
+                        case 23:
+                            item->kind = BINARY_ITEM_NULL;
+                            break;
+                        case 25:
+                            item->kind = BINARY_ITEM_SINGLE;
+                            if (ReadBigEndian(reader, 2, &item->bits) != 0)
+                            {
+                                result = __FAILURE__;
+                            }
+                            else
+                            {
+                                item->bits = HalfToSingleBits((uint32_t)item->bits);
+                            }
+                            break;
+                        case 26:
+                            item->kind = BINARY_ITEM_SINGLE;
+                            result = ReadBigEndian(reader, 4, &item->bits);
+                            break;
+                        case 27:
+                            item->kind = BINARY_ITEM_DOUBLE;
+                            result = ReadBigEndian(reader, 8, &item->bits);
+                            break;
+                        default:
+                            /*Codes_SRS_BINARY_DECODER_02_007: [ Indefinite length items, reserved values, extension types and map keys that are not text strings shall be rejected with BINARY_DECODER_PARSE_ERROR. ]*/
+                            LogError("unsupported CBOR simple value %u", (unsigned int)additionalInformation);
+                            result = __FAILURE__;
+                            break;
+                    }
+                    break;
+                }
+            }
+        }
+    } while (result == -1);
+
+    return result;
+}
+
+static int ReadMsgPackItem(BINARY_READER* reader, BINARY_ITEM* item)
+{
+    int result;
+    unsigned char formatByte = *(reader->position++);
+
+    if (formatByte <= 0x7F)
+    {
+        item->kind = BINARY_ITEM_UNSIGNED;
+        item->argument = formatByte;
+        result = 0;
+    }
+    else if (formatByte <= 0x8F)
+    {
+        item->kind = BINARY_ITEM_MAP;
+        item->argument = formatByte & 0x0F;
+        result = 0;
+    }
+    else if (formatByte <= 0x9F)
+    {
+        item->kind = BINARY_ITEM_ARRAY;
+        item->argument = formatByte & 0x0F;
+        result = 0;
+    }
+    else if (formatByte <= 0xBF)
+    {
+        item->kind = BINARY_ITEM_TEXT;
+        item->argument = formatByte & 0x1F;
+        result = 0;
+    }
+    else if (formatByte >= 0xE0)
+    {
+        /*negative fixint, -32..-1*/
+        item->kind = BINARY_ITEM_NEGATIVE;
+        item->argument = (uint64_t)(0xFF - formatByte);
+        result = 0;
+    }
+    else
+    {
+        switch (formatByte)
+        {
+            case 0xC0:
+                item->kind = BINARY_ITEM_NULL;
+                result = 0;
+                break;
+            case 0xC2:
+            case 0xC3:
+                item->kind = BINARY_ITEM_BOOLEAN;
+                item->booleanValue = (formatByte == 0xC3);
+                result = 0;
+                break;
+            case 0xC4:
+            case 0xC5:
+            case 0xC6:
+                item->kind = BINARY_ITEM_BYTES;
+                result = ReadBigEndian(reader, (size_t)1 << (formatByte - 0xC4), &item->argument);
+                break;
+            case 0xCA:
+                item->kind = BINARY_ITEM_SINGLE;
+                result = ReadBigEndian(reader, 4, &item->bits);
+                break;
+            case 0xCB:
+                item->kind = BINARY_ITEM_DOUBLE;
+                result = ReadBigEndian(reader, 8, &item->bits);
+                break;
+            case 0xCC:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF:
+                item->kind = BINARY_ITEM_UNSIGNED;
+                result = ReadBigEndian(reader, (size_t)1 << (formatByte - 0xCC), &item->argument);
+                break;
+            case 0xD0:
+            case 0xD1:
+            case 0xD2:
+            case 0xD3:
+            {
+                size_t byteCount = (size_t)1 << (formatByte - 0xD0);
+                uint64_t bits;
+                if ((result = ReadBigEndian(reader, byteCount, &bits)) == 0)
+                {
+                    /*sign extend*/
+                    int64_t value;
+                    if ((byteCount < 8) && ((bits >> (8 * byteCount - 1)) & 1))
+                    {
+                        bits |= ~(uint64_t)0 << (8 * byteCount);
+                    }
+                    (void)memcpy(&value, &bits, sizeof(value));
+                    if (value >= 0)
+                    {
+                        item->kind = BINARY_ITEM_UNSIGNED;
+                        item->argument = (uint64_t)value;
+                    }
+                    else
+                    {
+                        item->kind = BINARY_ITEM_NEGATIVE;
+                        item->argument = (uint64_t)(-(value + 1));
+                    }
+                }
+                break;
+            }
+            case 0xD9:
+            case 0xDA:
+            case 0xDB:
+                item->kind = BINARY_ITEM_TEXT;
+                result = ReadBigEndian(reader, (size_t)1 << (formatByte - 0xD9), &item->argument);
+                break;
+            case 0xDC:
+            case 0xDD:
+                item->kind = BINARY_ITEM_ARRAY;
+                result = ReadBigEndian(reader, (formatByte == 0xDC) ? 2 : 4, &item->argument);
+                break;
+            case 0xDE:
+            case 0xDF:
+                item->kind = BINARY_ITEM_MAP;
+                result = ReadBigEndian(reader, (formatByte == 0xDE) ? 2 : 4, &item->argument);
+                break;
+            default:
+                /*Codes_SRS_BINARY_DECODER_02_007: [ Indefinite length items, reserved values, extension types and map keys that are not text strings shall be rejected with BINARY_DECODER_PARSE_ERROR. ]*/
+                LogError("unsupported MessagePack format 0x%02X", (unsigned int)formatByte);
+                result = __FAILURE__;
+                break;
+        }
+    }
+    return result;
+}
+
+static int ReadItem(BINARY_READER* reader, BINARY_ITEM* item)
+{
+    int result;
+    if (reader->position == reader->end)
+    {
+        LogError("unexpected end of input");
+        result = __FAILURE__;
+    }
+    else if (((reader->encoding == DATA_ENCODING_CBOR) ? ReadCBORItem(reader, item) : ReadMsgPackItem(reader, item)) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else if ((item->kind == BINARY_ITEM_TEXT) || (item->kind == BINARY_ITEM_BYTES))
+    {
+        if (item->argument > (uint64_t)(reader->end - reader->position))
+        {
+            LogError("string of %lu bytes goes past the end of input", (unsigned long)item->argument);
+            result = __FAILURE__;
+        }
+        else
+        {
+            item->bytes = reader->position;
+            reader->position += (size_t)item->argument;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static size_t WriteUnsigned(char* destination, uint64_t value)
+{
+    char digits[20];
+    size_t digitCount = 0;
+    size_t i;
+    do
+    {
+        digits[digitCount++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    for (i = 0; i < digitCount; i++)
+    {
+        destination[i] = digits[digitCount - 1 - i];
+    }
+    destination[digitCount] = '\0';
+    return digitCount;
+}
+
+/*sets on node the JSON text of a string, escaped the same way the JSON decoder expects it*/
+static BINARY_DECODER_RESULT SetStringLeaf(MULTITREE_HANDLE node, const unsigned char* chars, size_t length)
+{
+    BINARY_DECODER_RESULT result;
+    char* text;
+
+    if ((length > (SIZE_MAX - 3) / 6) ||
+        ((text = (char*)malloc(length * 6 + 3)) == NULL))
+    {
+        LogError("unable to allocate the text of a %lu bytes string", (unsigned long)length);
+        result = BINARY_DECODER_ERROR;
+    }
+    else
+    {
+        size_t position = 0;
+        size_t i;
+        text[position++] = '"';
+        for (i = 0; i < length; i++)
+        {
+            unsigned char c = chars[i];
+            if ((c == '"') || (c == '\\'))
+            {
+                text[position++] = '\\';
+                text[position++] = (char)c;
+            }
+            else if (c < 0x20)
+            {
+                static const char hexDigits[] = "0123456789ABCDEF";
+                text[position++] = '\\';
+                text[position++] = 'u';
+                text[position++] = '0';
+                text[position++] = '0';
+                text[position++] = hexDigits[c >> 4];
+                text[position++] = hexDigits[c & 0x0F];
+            }
+            else
+            {
+                text[position++] = (char)c;
+            }
+        }
+        text[position++] = '"';
+        text[position] = '\0';
+
+        result = (MultiTree_SetValue(node, text) == MULTITREE_OK) ? BINARY_DECODER_OK : BINARY_DECODER_MULTITREE_FAILED;
+        free(text);
+    }
+    return result;
+}
+
+/*byte strings get the same base64 text the JSON of an EDM_BINARY value has*/
+static BINARY_DECODER_RESULT SetBytesLeaf(MULTITREE_HANDLE node, const unsigned char* bytes, size_t length)
+{
+    BINARY_DECODER_RESULT result;
+    STRING_HANDLE text = STRING_new();
+    if (text == NULL)
+    {
+        LogError("failure in STRING_new");
+        result = BINARY_DECODER_ERROR;
+    }
+    else
+    {
+        AGENT_DATA_TYPE value;
+        value.type = EDM_BINARY_TYPE;
+        value.value.edmBinary.size = length;
+        value.value.edmBinary.data = (unsigned char*)bytes;
+        if (AgentDataTypes_ToString(text, &value) != AGENT_DATA_TYPES_OK)
+        {
+            LogError("failure in AgentDataTypes_ToString");
+            result = BINARY_DECODER_ERROR;
+        }
+        else if (MultiTree_SetValue(node, (void*)STRING_c_str(text)) != MULTITREE_OK)
+        {
+            /*Codes_SRS_BINARY_DECODER_02_008: [ If any MultiTree API fails, BinaryDecoder_To_MultiTree shall return BINARY_DECODER_MULTITREE_FAILED. ]*/
+            result = BINARY_DECODER_MULTITREE_FAILED;
+        }
+        else
+        {
+            result = BINARY_DECODER_OK;
+        }
+        STRING_delete(text);
+    }
+    return result;
+}
+
+static BINARY_DECODER_RESULT SetScalarLeaf(MULTITREE_HANDLE node, const BINARY_ITEM* item)
+{
+    BINARY_DECODER_RESULT result;
+    char text[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+
+    switch (item->kind)
+    {
+        case BINARY_ITEM_UNSIGNED:
+            (void)WriteUnsigned(text, item->argument);
+            result = BINARY_DECODER_OK;
+            break;
+        case BINARY_ITEM_NEGATIVE:
+            if (item->argument == UINT64_MAX)
+            {
+                LogError("negative integer too large");
+                result = BINARY_DECODER_PARSE_ERROR;
+            }
+            else
+            {
+                text[0] = '-';
+                (void)WriteUnsigned(text + 1, item->argument + 1);
+                result = BINARY_DECODER_OK;
+            }
+            break;
+        case BINARY_ITEM_BOOLEAN:
+            (void)strcpy(text, item->booleanValue ? "true" : "false");
+            result = BINARY_DECODER_OK;
+            break;
+        case BINARY_ITEM_NULL:
+            (void)strcpy(text, "null");
+            result = BINARY_DECODER_OK;
+            break;
+        default:
+        {
+            /*Codes_SRS_BINARY_DECODER_02_005: [ Floating point numbers shall be written in the leaf as the text AgentDataTypes_ToCharBuffer produces for an EDM_SINGLE or EDM_DOUBLE having the same value. ]*/
+            AGENT_DATA_TYPE value;
+            size_t length;
+            if (item->kind == BINARY_ITEM_SINGLE)
+            {
+                uint32_t bits = (uint32_t)item->bits;
+                value.type = EDM_SINGLE_TYPE;
+                (void)memcpy(&value.value.edmSingle.value, &bits, sizeof(bits));
+            }
+            else
+            {
+                value.type = EDM_DOUBLE_TYPE;
+                (void)memcpy(&value.value.edmDouble.value, &item->bits, sizeof(item->bits));
+            }
+
+            if (AgentDataTypes_ToCharBuffer(text, sizeof(text), &value, &length) != AGENT_DATA_TYPES_OK)
+            {
+                LogError("failure in AgentDataTypes_ToCharBuffer");
+                result = BINARY_DECODER_ERROR;
+            }
+            else
+            {
+                text[length] = '\0';
+                result = BINARY_DECODER_OK;
+            }
+            break;
+        }
+    }
+
+    if ((result == BINARY_DECODER_OK) &&
+        (MultiTree_SetValue(node, text) != MULTITREE_OK))
+    {
+        /*Codes_SRS_BINARY_DECODER_02_008: [ If any MultiTree API fails, BinaryDecoder_To_MultiTree shall return BINARY_DECODER_MULTITREE_FAILED. ]*/
+        result = BINARY_DECODER_MULTITREE_FAILED;
+    }
+    return result;
+}
+
+static BINARY_DECODER_RESULT ParseContainer(BINARY_READER* reader, const BINARY_ITEM* container, MULTITREE_HANDLE node, size_t depth)
+{
+    BINARY_DECODER_RESULT result = BINARY_DECODER_OK;
+    uint64_t i;
+
+    if (depth > BINARY_DECODER_MAX_DEPTH)
+    {
+        LogError("nesting deeper than %d", BINARY_DECODER_MAX_DEPTH);
+        result = BINARY_DECODER_PARSE_ERROR;
+    }
+
+    for (i = 0; (result == BINARY_DECODER_OK) && (i < container->argument); i++)
+    {
+        char shortName[BINARY_DECODER_SHORT_NAME_SIZE];
+        char* name = shortName;
+        BINARY_ITEM key;
+        BINARY_ITEM value;
+        MULTITREE_HANDLE child;
+
+        if (container->kind == BINARY_ITEM_ARRAY)
+        {
+            /*Codes_SRS_BINARY_DECODER_02_004: [ For array elements the multi tree node name shall be the string representation of the array index. ]*/
+            (void)WriteUnsigned(shortName, i);
+        }
+        else if ((ReadItem(reader, &key) != 0) ||
+            (key.kind != BINARY_ITEM_TEXT))
+        {
+            /*Codes_SRS_BINARY_DECODER_02_007: [ Indefinite length items, reserved values, extension types and map keys that are not text strings shall be rejected with BINARY_DECODER_PARSE_ERROR. ]*/
+            LogError("map key is not a text string");
+            result = BINARY_DECODER_PARSE_ERROR;
+        }
+        else if ((key.argument >= sizeof(shortName)) &&
+            ((name = (char*)malloc((size_t)key.argument + 1)) == NULL))
+        {
+            LogError("unable to allocate a name of %lu bytes", (unsigned long)key.argument);
+            result = BINARY_DECODER_ERROR;
+        }
+        else
+        {
+            (void)memcpy(name, key.bytes, (size_t)key.argument);
+            name[key.argument] = '\0';
+        }
+
+        if (result == BINARY_DECODER_OK)
+        {
+            if (ReadItem(reader, &value) != 0)
+            {
+                result = BINARY_DECODER_PARSE_ERROR;
+            }
+            /*Codes_SRS_BINARY_DECODER_02_003: [ Every (name, value) pair of a map shall become a child of the current node having that name, exactly as JSONDecoder_JSON_To_MultiTree adds a child for every member of an object. ]*/
+            else if (MultiTree_AddChild(node, name, &child) != MULTITREE_OK)
+            {
+                /*Codes_SRS_BINARY_DECODER_02_008: [ If any MultiTree API fails, BinaryDecoder_To_MultiTree shall return BINARY_DECODER_MULTITREE_FAILED. ]*/
+                result = BINARY_DECODER_MULTITREE_FAILED;
+            }
+            else if ((value.kind == BINARY_ITEM_MAP) || (value.kind == BINARY_ITEM_ARRAY))
+            {
+                result = ParseContainer(reader, &value, child, depth + 1);
+            }
+            /*Codes_SRS_BINARY_DECODER_02_006: [ Text strings shall be written in the leaf as quoted JSON strings, byte strings as the text AgentDataTypes_ToString produces for an EDM_BINARY and integers, booleans and null as their JSON literals. ]*/
+            else if (value.kind == BINARY_ITEM_TEXT)
+            {
+                result = SetStringLeaf(child, value.bytes, (size_t)value.argument);
+            }
+            else if (value.kind == BINARY_ITEM_BYTES)
+            {
+                result = SetBytesLeaf(child, value.bytes, (size_t)value.argument);
+            }
+            else
+            {
+                result = SetScalarLeaf(child, &value);
+            }
+
+            if (name != shortName)
+            {
+                free(name);
+            }
+        }
+    }
+    return result;
+}
+
+BINARY_DECODER_RESULT BinaryDecoder_To_MultiTree(DATA_ENCODING encoding, const unsigned char* source, size_t sourceSize, MULTITREE_HANDLE* multiTreeHandle)
+{
+    BINARY_DECODER_RESULT result;
+
+    /*Codes_SRS_BINARY_DECODER_02_001: [ If source or multiTreeHandle is NULL, or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK, then BinaryDecoder_To_MultiTree shall fail and return BINARY_DECODER_INVALID_ARG. ]*/
+    if ((source == NULL) ||
+        (multiTreeHandle == NULL) ||
+        ((encoding != DATA_ENCODING_CBOR) && (encoding != DATA_ENCODING_MSGPACK)))
+    {
+        LogError("invalid argument DATA_ENCODING encoding=%d, const unsigned char* source=%p, MULTITREE_HANDLE* multiTreeHandle=%p", (int)encoding, source, multiTreeHandle);
+        result = BINARY_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        BINARY_READER reader;
+        BINARY_ITEM root;
+        reader.encoding = encoding;
+        reader.position = source;
+        reader.end = source + sourceSize;
+
+        /*Codes_SRS_BINARY_DECODER_02_009: [ The encoded document shall be a single map or array, otherwise BinaryDecoder_To_MultiTree shall return BINARY_DECODER_PARSE_ERROR. ]*/
+        if ((ReadItem(&reader, &root) != 0) ||
+            ((root.kind != BINARY_ITEM_MAP) && (root.kind != BINARY_ITEM_ARRAY)))
+        {
+            LogError("the document is not a map or an array");
+            result = BINARY_DECODER_PARSE_ERROR;
+        }
+        /*Codes_SRS_BINARY_DECODER_02_002: [ BinaryDecoder_To_MultiTree shall create a multi tree whose leaves own a copy of their JSON text. ]*/
+        else if ((*multiTreeHandle = MultiTree_Create(StringClone, StringFree)) == NULL)
+        {
+            /*Codes_SRS_BINARY_DECODER_02_008: [ If any MultiTree API fails, BinaryDecoder_To_MultiTree shall return BINARY_DECODER_MULTITREE_FAILED. ]*/
+            LogError("failure in MultiTree_Create");
+            result = BINARY_DECODER_MULTITREE_FAILED;
+        }
+        else
+        {
+            result = ParseContainer(&reader, &root, *multiTreeHandle, 0);
+            if ((result == BINARY_DECODER_OK) &&
+                (reader.position != reader.end))
+            {
+                /*Codes_SRS_BINARY_DECODER_02_009: [ The encoded document shall be a single map or array, otherwise BinaryDecoder_To_MultiTree shall return BINARY_DECODER_PARSE_ERROR. ]*/
+                LogError("%lu bytes follow the document", (unsigned long)(reader.end - reader.position));
+                result = BINARY_DECODER_PARSE_ERROR;
+            }
+
+            if (result != BINARY_DECODER_OK)
+            {
+                MultiTree_Destroy(*multiTreeHandle);
+                *multiTreeHandle = NULL;
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,424 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "binaryencoder.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(DATA_ENCODING, DATA_ENCODING_VALUES);
+DEFINE_ENUM_STRINGS(BINARY_ENCODER_RESULT, BINARY_ENCODER_RESULT_VALUES);
+
+/*CBOR major types (RFC 7049), already shifted in the upper 3 bits of the initial byte*/
+#define CBOR_UNSIGNED_INTEGER   0x00
+#define CBOR_NEGATIVE_INTEGER   0x20
+#define CBOR_BYTE_STRING        0x40
+#define CBOR_TEXT_STRING        0x60
+#define CBOR_MAP                0xA0
+#define CBOR_FALSE              0xF4
+#define CBOR_TRUE               0xF5
+#define CBOR_NULL               0xF6
+#define CBOR_SINGLE             0xFA
+#define CBOR_DOUBLE             0xFB
+
+/*MessagePack format bytes*/
+#define MSGPACK_NIL             0xC0
+#define MSGPACK_FALSE           0xC2
+#define MSGPACK_TRUE            0xC3
+#define MSGPACK_BIN8            0xC4
+#define MSGPACK_BIN16           0xC5
+#define MSGPACK_BIN32           0xC6
+#define MSGPACK_FLOAT32         0xCA
+#define MSGPACK_FLOAT64         0xCB
+#define MSGPACK_UINT8           0xCC
+#define MSGPACK_UINT16          0xCD
+#define MSGPACK_UINT32          0xCE
+#define MSGPACK_UINT64          0xCF
+#define MSGPACK_INT8            0xD0
+#define MSGPACK_INT16           0xD1
+#define MSGPACK_INT32           0xD2
+#define MSGPACK_INT64           0xD3
+#define MSGPACK_STR8            0xD9
+#define MSGPACK_STR16           0xDA
+#define MSGPACK_STR32           0xDB
+#define MSGPACK_MAP16           0xDE
+#define MSGPACK_MAP32           0xDF
+#define MSGPACK_FIXMAP          0x80
+#define MSGPACK_FIXSTR          0xA0
+
+/*writes formatByte followed by the lowest byteCount bytes of value, big endian (network order)*/
+static int WriteFormatAndValue(BINARY_ENCODER_WRITE_FUNCTION write, void* context, unsigned char formatByte, uint64_t value, size_t byteCount)
+{
+    unsigned char bytes[9];
+    size_t i;
+    bytes[0] = formatByte;
+    for (i = 0; i < byteCount; i++)
+    {
+        bytes[byteCount - i] = (unsigned char)(value >> (8 * i));
+    }
+    return write(context, bytes, byteCount + 1);
+}
+
+/*writes the initial byte of a CBOR data item with the shortest possible argument encoding*/
+static int WriteCBORHead(BINARY_ENCODER_WRITE_FUNCTION write, void* context, unsigned char majorType, uint64_t argument)
+{
+    int result;
+    if (argument < 24)
+    {
+        result = WriteFormatAndValue(write, context, (unsigned char)(majorType | argument), 0, 0);
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        result = WriteFormatAndValue(write, context, majorType | 24, argument, 1);
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        result = WriteFormatAndValue(write, context, majorType | 25, argument, 2);
+    }
+    else if (argument <= UINT32_MAX)
+    {
+        result = WriteFormatAndValue(write, context, majorType | 26, argument, 4);
+    }
+    else
+    {
+        result = WriteFormatAndValue(write, context, majorType | 27, argument, 8);
+    }
+    return result;
+}
+
+/*writes a MessagePack head for a length-prefixed family (str, bin, map), fixFormat and format8 are 0 for families that do not have those variants*/
+static BINARY_ENCODER_RESULT WriteMsgPackLength(BINARY_ENCODER_WRITE_FUNCTION write, void* context, size_t length, unsigned char fixFormat, size_t fixMaximum, unsigned char format8, unsigned char format16, unsigned char format32)
+{
+    BINARY_ENCODER_RESULT result;
+    if ((uint64_t)length > UINT32_MAX)
+    {
+        /*Codes_SRS_BINARY_ENCODER_02_011: [ If a length does not fit the encoding, the encoding functions shall fail and return BINARY_ENCODER_NOT_SUPPORTED. ]*/
+        LogError("length %lu does not fit in a MessagePack header", (unsigned long)length);
+        result = BINARY_ENCODER_NOT_SUPPORTED;
+    }
+    else
+    {
+        int writeResult;
+        if ((fixFormat != 0) && (length <= fixMaximum))
+        {
+            writeResult = WriteFormatAndValue(write, context, (unsigned char)(fixFormat | length), 0, 0);
+        }
+        else if ((format8 != 0) && (length <= UINT8_MAX))
+        {
+            writeResult = WriteFormatAndValue(write, context, format8, length, 1);
+        }
+        else if (length <= UINT16_MAX)
+        {
+            writeResult = WriteFormatAndValue(write, context, format16, length, 2);
+        }
+        else
+        {
+            writeResult = WriteFormatAndValue(write, context, format32, length, 4);
+        }
+        result = (writeResult == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+    }
+    return result;
+}
+
+static BINARY_ENCODER_RESULT WriteInteger(DATA_ENCODING encoding, int64_t value, BINARY_ENCODER_WRITE_FUNCTION write, void* context)
+{
+    int writeResult;
+    if (encoding == DATA_ENCODING_CBOR)
+    {
+        writeResult = (value >= 0) ?
+            WriteCBORHead(write, context, CBOR_UNSIGNED_INTEGER, (uint64_t)value) :
+            WriteCBORHead(write, context, CBOR_NEGATIVE_INTEGER, (uint64_t)(-(value + 1)));
+    }
+    else if (value >= 0)
+    {
+        if (value <= 0x7F)
+        {
+            /*positive fixint*/
+            writeResult = WriteFormatAndValue(write, context, (unsigned char)value, 0, 0);
+        }
+        else if (value <= UINT8_MAX)
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_UINT8, (uint64_t)value, 1);
+        }
+        else if (value <= UINT16_MAX)
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_UINT16, (uint64_t)value, 2);
+        }
+        else if (value <= UINT32_MAX)
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_UINT32, (uint64_t)value, 4);
+        }
+        else
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_UINT64, (uint64_t)value, 8);
+        }
+    }
+    else
+    {
+        if (value >= -32)
+        {
+            /*negative fixint*/
+            writeResult = WriteFormatAndValue(write, context, (unsigned char)(int8_t)value, 0, 0);
+        }
+        else if (value >= INT8_MIN)
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_INT8, (uint64_t)value, 1);
+        }
+        else if (value >= INT16_MIN)
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_INT16, (uint64_t)value, 2);
+        }
+        else if (value >= INT32_MIN)
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_INT32, (uint64_t)value, 4);
+        }
+        else
+        {
+            writeResult = WriteFormatAndValue(write, context, MSGPACK_INT64, (uint64_t)value, 8);
+        }
+    }
+    return (writeResult == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+}
+
+static BINARY_ENCODER_RESULT WriteBytes(DATA_ENCODING encoding, bool isText, const unsigned char* bytes, size_t length, BINARY_ENCODER_WRITE_FUNCTION write, void* context)
+{
+    BINARY_ENCODER_RESULT result;
+    if (encoding == DATA_ENCODING_CBOR)
+    {
+        result = (WriteCBORHead(write, context, isText ? CBOR_TEXT_STRING : CBOR_BYTE_STRING, length) == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+    }
+    else if (isText)
+    {
+        result = WriteMsgPackLength(write, context, length, MSGPACK_FIXSTR, 31, MSGPACK_STR8, MSGPACK_STR16, MSGPACK_STR32);
+    }
+    else
+    {
+        result = WriteMsgPackLength(write, context, length, 0, 0, MSGPACK_BIN8, MSGPACK_BIN16, MSGPACK_BIN32);
+    }
+
+    if ((result == BINARY_ENCODER_OK) &&
+        (length > 0) &&
+        (write(context, bytes, length) != 0))
+    {
+        result = BINARY_ENCODER_ERROR;
+    }
+    return result;
+}
+
+static bool IsValidEncoding(DATA_ENCODING encoding)
+{
+    return (encoding == DATA_ENCODING_CBOR) || (encoding == DATA_ENCODING_MSGPACK);
+}
+
+const char* BinaryEncoder_GetContentType(DATA_ENCODING encoding)
+{
+    const char* result;
+    /*Codes_SRS_BINARY_ENCODER_02_001: [ BinaryEncoder_GetContentType shall return "application/json" for DATA_ENCODING_JSON, "application/cbor" for DATA_ENCODING_CBOR and "application/x-msgpack" for DATA_ENCODING_MSGPACK. ]*/
+    switch (encoding)
+    {
+        case DATA_ENCODING_JSON:
+            result = "application/json";
+            break;
+        case DATA_ENCODING_CBOR:
+            result = "application/cbor";
+            break;
+        case DATA_ENCODING_MSGPACK:
+            result = "application/x-msgpack";
+            break;
+        default:
+            /*Codes_SRS_BINARY_ENCODER_02_002: [ For any other value BinaryEncoder_GetContentType shall return NULL. ]*/
+            LogError("unknown encoding %d", (int)encoding);
+            result = NULL;
+            break;
+    }
+    return result;
+}
+
+const char* BinaryEncoder_GetContentEncoding(DATA_ENCODING encoding)
+{
+    /*Codes_SRS_BINARY_ENCODER_02_003: [ BinaryEncoder_GetContentEncoding shall return "utf-8" for DATA_ENCODING_JSON and NULL for any other encoding, since binary payloads have no character encoding. ]*/
+    return (encoding == DATA_ENCODING_JSON) ? "utf-8" : NULL;
+}
+
+BINARY_ENCODER_RESULT BinaryEncoder_EncodeMapHeader(DATA_ENCODING encoding, size_t memberCount, BINARY_ENCODER_WRITE_FUNCTION write, void* context)
+{
+    BINARY_ENCODER_RESULT result;
+    /*Codes_SRS_BINARY_ENCODER_02_004: [ If write is NULL or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then the encoding functions shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    if ((write == NULL) ||
+        (!IsValidEncoding(encoding)))
+    {
+        LogError("invalid argument DATA_ENCODING encoding=%d, BINARY_ENCODER_WRITE_FUNCTION write=%p", (int)encoding, write);
+        result = BINARY_ENCODER_INVALID_ARG;
+    }
+    else if (encoding == DATA_ENCODING_CBOR)
+    {
+        /*Codes_SRS_BINARY_ENCODER_02_005: [ BinaryEncoder_EncodeMapHeader shall write the header of a map of memberCount (name, value) pairs, using the shortest form the encoding allows. ]*/
+        result = (WriteCBORHead(write, context, CBOR_MAP, memberCount) == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_BINARY_ENCODER_02_005: [ BinaryEncoder_EncodeMapHeader shall write the header of a map of memberCount (name, value) pairs, using the shortest form the encoding allows. ]*/
+        result = WriteMsgPackLength(write, context, memberCount, MSGPACK_FIXMAP, 15, 0, MSGPACK_MAP16, MSGPACK_MAP32);
+    }
+    return result;
+}
+
+BINARY_ENCODER_RESULT BinaryEncoder_EncodeString(DATA_ENCODING encoding, const char* value, size_t length, BINARY_ENCODER_WRITE_FUNCTION write, void* context)
+{
+    BINARY_ENCODER_RESULT result;
+    /*Codes_SRS_BINARY_ENCODER_02_004: [ If write is NULL or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then the encoding functions shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    /*Codes_SRS_BINARY_ENCODER_02_006: [ If value is NULL and length is not 0 then BinaryEncoder_EncodeString shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    if ((write == NULL) ||
+        (!IsValidEncoding(encoding)) ||
+        ((value == NULL) && (length != 0)))
+    {
+        LogError("invalid argument DATA_ENCODING encoding=%d, const char* value=%p, BINARY_ENCODER_WRITE_FUNCTION write=%p", (int)encoding, value, write);
+        result = BINARY_ENCODER_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_BINARY_ENCODER_02_007: [ BinaryEncoder_EncodeString shall write the length bytes of value as a text string. ]*/
+        result = WriteBytes(encoding, true, (const unsigned char*)value, length, write, context);
+    }
+    return result;
+}
+
+static BINARY_ENCODER_RESULT EncodeValue(DATA_ENCODING encoding, const AGENT_DATA_TYPE* value, BINARY_ENCODER_WRITE_FUNCTION write, void* context)
+{
+    BINARY_ENCODER_RESULT result;
+    bool isCBOR = (encoding == DATA_ENCODING_CBOR);
+
+    switch (value->type)
+    {
+        /*Codes_SRS_BINARY_ENCODER_02_008: [ BinaryEncoder_EncodeValue shall encode EDM_NULL_TYPE as null, EDM_BOOLEAN_TYPE as a boolean, EDM_BYTE_TYPE, EDM_SBYTE_TYPE, EDM_INT16_TYPE, EDM_INT32_TYPE and EDM_INT64_TYPE as the shortest integer, EDM_SINGLE_TYPE as a 32 bit float, EDM_DOUBLE_TYPE as a 64 bit float, EDM_STRING_TYPE and EDM_STRING_NO_QUOTES_TYPE as text strings and EDM_BINARY_TYPE as a byte string. ]*/
+        case EDM_NULL_TYPE:
+            result = (WriteFormatAndValue(write, context, isCBOR ? CBOR_NULL : MSGPACK_NIL, 0, 0) == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+            break;
+        case EDM_BOOLEAN_TYPE:
+        {
+            unsigned char formatByte = (value->value.edmBoolean.value == EDM_TRUE) ?
+                (isCBOR ? CBOR_TRUE : MSGPACK_TRUE) :
+                (isCBOR ? CBOR_FALSE : MSGPACK_FALSE);
+            result = (WriteFormatAndValue(write, context, formatByte, 0, 0) == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+            break;
+        }
+        case EDM_BYTE_TYPE:
+            result = WriteInteger(encoding, value->value.edmByte.value, write, context);
+            break;
+        case EDM_SBYTE_TYPE:
+            result = WriteInteger(encoding, value->value.edmSbyte.value, write, context);
+            break;
+        case EDM_INT16_TYPE:
+            result = WriteInteger(encoding, value->value.edmInt16.value, write, context);
+            break;
+        case EDM_INT32_TYPE:
+            result = WriteInteger(encoding, value->value.edmInt32.value, write, context);
+            break;
+        case EDM_INT64_TYPE:
+            result = WriteInteger(encoding, value->value.edmInt64.value, write, context);
+            break;
+#ifndef NO_FLOATS
+        case EDM_SINGLE_TYPE:
+        {
+            uint32_t bits;
+            (void)memcpy(&bits, &value->value.edmSingle.value, sizeof(bits));
+            result = (WriteFormatAndValue(write, context, isCBOR ? CBOR_SINGLE : MSGPACK_FLOAT32, bits, 4) == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+            break;
+        }
+        case EDM_DOUBLE_TYPE:
+        {
+            uint64_t bits;
+            (void)memcpy(&bits, &value->value.edmDouble.value, sizeof(bits));
+            result = (WriteFormatAndValue(write, context, isCBOR ? CBOR_DOUBLE : MSGPACK_FLOAT64, bits, 8) == 0) ? BINARY_ENCODER_OK : BINARY_ENCODER_ERROR;
+            break;
+        }
+#endif
+        case EDM_STRING_TYPE:
+            result = WriteBytes(encoding, true, (const unsigned char*)value->value.edmString.chars, value->value.edmString.length, write, context);
+            break;
+        case EDM_STRING_NO_QUOTES_TYPE:
+            result = WriteBytes(encoding, true, (const unsigned char*)value->value.edmStringNoQuotes.chars, value->value.edmStringNoQuotes.length, write, context);
+            break;
+        case EDM_BINARY_TYPE:
+            result = WriteBytes(encoding, false, value->value.edmBinary.data, value->value.edmBinary.size, write, context);
+            break;
+        case EDM_DECIMAL_TYPE:
+        {
+            /*Codes_SRS_BINARY_ENCODER_02_010: [ EDM_DECIMAL_TYPE shall be encoded as a text string holding its decimal digits, so no precision is lost. ]*/
+            const char* digits = STRING_c_str(value->value.edmDecimal.value);
+            if (digits == NULL)
+            {
+                LogError("EDM_DECIMAL has no value");
+                result = BINARY_ENCODER_ERROR;
+            }
+            else
+            {
+                result = WriteBytes(encoding, true, (const unsigned char*)digits, strlen(digits), write, context);
+            }
+            break;
+        }
+        case EDM_DATE_TYPE:
+        case EDM_DATE_TIME_OFFSET_TYPE:
+        case EDM_GUID_TYPE:
+        {
+            /*Codes_SRS_BINARY_ENCODER_02_009: [ EDM_DATE_TYPE, EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE shall be encoded as text strings holding the same characters as the JSON string produced by AgentDataTypes_ToCharBuffer, without the quotes. ]*/
+            char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+            size_t length;
+            if ((AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), value, &length) != AGENT_DATA_TYPES_OK) ||
+                (length < 2))
+            {
+                LogError("failure in AgentDataTypes_ToCharBuffer");
+                result = BINARY_ENCODER_ERROR;
+            }
+            else
+            {
+                result = WriteBytes(encoding, true, (const unsigned char*)buffer + 1, length - 2, write, context);
+            }
+            break;
+        }
+        case EDM_COMPLEX_TYPE_TYPE:
+        {
+            /*Codes_SRS_BINARY_ENCODER_02_012: [ EDM_COMPLEX_TYPE_TYPE shall be encoded as a map having one (fieldName, value) pair for every field. ]*/
+            size_t i;
+            result = BinaryEncoder_EncodeMapHeader(encoding, value->value.edmComplexType.nMembers, write, context);
+            for (i = 0; (result == BINARY_ENCODER_OK) && (i < value->value.edmComplexType.nMembers); i++)
+            {
+                const COMPLEX_TYPE_FIELD_TYPE* field = &value->value.edmComplexType.fields[i];
+                if ((result = BinaryEncoder_EncodeString(encoding, field->fieldName, strlen(field->fieldName), write, context)) == BINARY_ENCODER_OK)
+                {
+                    result = EncodeValue(encoding, field->value, write, context);
+                }
+            }
+            break;
+        }
+        default:
+            /*Codes_SRS_BINARY_ENCODER_02_013: [ For any other type BinaryEncoder_EncodeValue shall fail and return BINARY_ENCODER_NOT_SUPPORTED. ]*/
+            LogError("type %d cannot be encoded in encoding %d", (int)value->type, (int)encoding);
+            result = BINARY_ENCODER_NOT_SUPPORTED;
+            break;
+    }
+    return result;
+}
+
+BINARY_ENCODER_RESULT BinaryEncoder_EncodeValue(DATA_ENCODING encoding, const AGENT_DATA_TYPE* value, BINARY_ENCODER_WRITE_FUNCTION write, void* context)
+{
+    BINARY_ENCODER_RESULT result;
+    /*Codes_SRS_BINARY_ENCODER_02_004: [ If write is NULL or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then the encoding functions shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    /*Codes_SRS_BINARY_ENCODER_02_014: [ If value is NULL then BinaryEncoder_EncodeValue shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    if ((write == NULL) ||
+        (value == NULL) ||
+        (!IsValidEncoding(encoding)))
+    {
+        LogError("invalid argument DATA_ENCODING encoding=%d, const AGENT_DATA_TYPE* value=%p, BINARY_ENCODER_WRITE_FUNCTION write=%p", (int)encoding, value, write);
+        result = BINARY_ENCODER_INVALID_ARG;
+    }
+    else
+    {
+        result = EncodeValue(encoding, value, write, context);
+    }
+    return result;
+}
@@ -19,6 +19,14 @@ DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
 #define LOG_CODEFIRST_ERROR \
     LogError("(result = %s)", ENUM_TO_STRING(CODEFIRST_RESULT, result))
 
+/*remembers where a value inside a child model was found in the metadata and the path it is published under*/
+typedef struct VALUE_PATH_CACHE_ENTRY_TAG
+{
+    size_t offset;
+    const REFLECTED_SOMETHING* propertyReflectedData;
+    char* valuePath;
+} VALUE_PATH_CACHE_ENTRY;
+
 typedef struct DEVICE_HEADER_DATA_TAG
 {
     DEVICE_HANDLE DeviceHandle;
@@ -26,6 +34,10 @@ typedef struct DEVICE_HEADER_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     size_t DataSize;
     unsigned char* data;
+    const CODEFIRST_MODEL_FIELD* ModelFields; /*field table of the device model, NULL when the model has none*/
+    size_t ModelFieldCount;
+    VALUE_PATH_CACHE_ENTRY* ValuePathCache; /*sorted by offset*/
+    size_t ValuePathCacheCount;
 } DEVICE_HEADER_DATA;
 
 #define COUNT_OF(A) (sizeof(A) / sizeof((A)[0]))
@@ -80,7 +92,7 @@ DEFINE_ENUM(CODEFIRST_STATE, CODEFIRST_STATE_VALUES)
 static CODEFIRST_STATE g_state = CODEFIRST_STATE_NOT_INIT;
 static const char* g_OverrideSchemaNamespace;
 static size_t g_DeviceCount = 0;
-static DEVICE_HEADER_DATA** g_Devices = NULL;
+static DEVICE_HEADER_DATA** g_Devices = NULL; /*sorted by data address*/
 
 static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void* destination)
 {
@@ -158,11 +170,40 @@ static void DestroyDevice(DEVICE_HEADER_DATA* deviceHeader)
     /* Codes_SRS_CODEFIRST_99_085:[CodeFirst_DestroyDevice shall free all resources associated with a device.] */
     /* Codes_SRS_CODEFIRST_99_087:[In order to release the device handle, CodeFirst_DestroyDevice shall call Device_Destroy.] */
 
+    size_t i;
+
     Device_Destroy(deviceHeader->DeviceHandle);
+    for (i = 0; i < deviceHeader->ValuePathCacheCount; i++)
+    {
+        free(deviceHeader->ValuePathCache[i].valuePath);
+    }
+    free(deviceHeader->ValuePathCache);
     free(deviceHeader->data);
     free(deviceHeader);
 }
 
+/*returns the index of the first device whose data starts after value*/
+static size_t UpperBoundDevice(const void* value)
+{
+    size_t low = 0;
+    size_t high = g_DeviceCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if ((const unsigned char*)value < g_Devices[middle]->data)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
+
 static CODEFIRST_RESULT buildStructTypes(SCHEMA_HANDLE schemaHandle, const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData)
 {
     CODEFIRST_RESULT result = CODEFIRST_OK;
@@ -486,6 +527,21 @@ static const REFLECTED_SOMETHING* FindModelInCodeFirstMetadata(const REFLECTED_S
     return result;
 }
 
+static void SetModelFields(DEVICE_HEADER_DATA* deviceHeader, const char* modelName)
+{
+    const REFLECTED_SOMETHING* modelReflectedData;
+
+    deviceHeader->ModelFields = NULL;
+    deviceHeader->ModelFieldCount = 0;
+
+    if ((modelName != NULL) &&
+        ((modelReflectedData = FindModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, modelName)) != NULL) &&
+        (modelReflectedData->what.model.getFields != NULL))
+    {
+        deviceHeader->ModelFields = modelReflectedData->what.model.getFields(&deviceHeader->ModelFieldCount);
+    }
+}
+
 static const REFLECTED_SOMETHING* FindChildModelInCodeFirstMetadata(const REFLECTED_SOMETHING* reflectedData, const REFLECTED_SOMETHING* startModel, const char* relativePath, size_t* offset)
 {
     const REFLECTED_SOMETHING* result = startModel;
@@ -955,8 +1011,18 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     }
                     else
                     {
+                        size_t position;
+
+                        /* Codes_SRS_CODEFIRST_02_065: [ CodeFirst_CreateDevice shall look up the model of the device in metadata by the name returned by Schema_GetModelName and, if the model has a field table, keep it with the device. ]*/
+                        SetModelFields(deviceHeader, Schema_GetModelName(model));
+                        deviceHeader->ValuePathCache = NULL;
+                        deviceHeader->ValuePathCacheCount = 0;
+
+                        /* Codes_SRS_CODEFIRST_02_076: [ CodeFirst_CreateDevice shall keep the devices sorted by the address of their data, so that the device of a value is found by a binary search. ]*/
                         g_Devices = newDevices;
-                        g_Devices[g_DeviceCount] = deviceHeader;
+                        position = UpperBoundDevice(deviceHeader->data);
+                        (void)memmove(&g_Devices[position + 1], &g_Devices[position], (g_DeviceCount - position) * sizeof(DEVICE_HEADER_DATA*));
+                        g_Devices[position] = deviceHeader;
                         g_DeviceCount++;
 
                         /* Codes_SRS_CODEFIRST_99_101:[On success, CodeFirst_CreateDevice shall return a non NULL pointer to the device data.] */
@@ -976,23 +1042,21 @@ void CodeFirst_DestroyDevice(void* device)
     /* Codes_SRS_CODEFIRST_99_086:[If the argument is NULL, CodeFirst_DestroyDevice shall do nothing.] */
     if (device != NULL)
     {
-        size_t i;
+        size_t i = UpperBoundDevice(device);
 
-        for (i = 0; i < g_DeviceCount; i++)
+        if ((i > 0) &&
+            (g_Devices[i - 1]->data == device))
         {
-            if (g_Devices[i]->data == device)
-            {
-                deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
-                Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
+            i--;
+            deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
+            Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
 
-                // Delete the Created Schema if all the devices are unassociated
-                Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+            // Delete the Created Schema if all the devices are unassociated
+            Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
 
-                DestroyDevice(g_Devices[i]);
-                (void)memcpy(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
-                g_DeviceCount--;
-                break;
-            }
+            DestroyDevice(g_Devices[i]);
+            (void)memmove(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
+            g_DeviceCount--;
         }
 
         /*Codes_SRS_CODEFIRST_02_039: [ If the current device count is zero then CodeFirst_DestroyDevice shall deallocate all other used resources. ]*/
@@ -1007,20 +1071,77 @@ void CodeFirst_DestroyDevice(void* device)
 
 static DEVICE_HEADER_DATA* FindDevice(void* value)
 {
-    size_t i;
+    /*the only device that can hold value is the last one that starts at or before it*/
+    size_t position = UpperBoundDevice(value);
     DEVICE_HEADER_DATA* result = NULL;
 
-    for (i = 0; i < g_DeviceCount; i++)
+    if ((position > 0) &&
+        (g_Devices[position - 1]->data + g_Devices[position - 1]->DataSize > (unsigned char*)value))
     {
-        if ((g_Devices[i]->data <= (unsigned char*)value) &&
-            (g_Devices[i]->data + g_Devices[i]->DataSize > (unsigned char*)value))
+        result = g_Devices[position - 1];
+    }
+
+    return result;
+}
+
+/*returns the index of the first cache entry whose offset is not less than offset*/
+static size_t LowerBoundValuePath(const DEVICE_HEADER_DATA* deviceHeader, size_t offset)
+{
+    size_t low = 0;
+    size_t high = deviceHeader->ValuePathCacheCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (deviceHeader->ValuePathCache[middle].offset < offset)
         {
-            result = g_Devices[i];
-            break;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
         }
     }
 
-    return result;
+    return low;
+}
+
+static const VALUE_PATH_CACHE_ENTRY* FindCachedValuePath(const DEVICE_HEADER_DATA* deviceHeader, const void* value)
+{
+    size_t offset = (size_t)((const unsigned char*)value - deviceHeader->data);
+    size_t position = LowerBoundValuePath(deviceHeader, offset);
+
+    return ((position < deviceHeader->ValuePathCacheCount) && (deviceHeader->ValuePathCache[position].offset == offset)) ?
+        &deviceHeader->ValuePathCache[position] :
+        NULL;
+}
+
+/*failing to cache only means that the next lookup for the same value goes through the metadata again*/
+static void CacheValuePath(DEVICE_HEADER_DATA* deviceHeader, const void* value, const REFLECTED_SOMETHING* propertyReflectedData, const char* valuePath)
+{
+    size_t offset = (size_t)((const unsigned char*)value - deviceHeader->data);
+    size_t position = LowerBoundValuePath(deviceHeader, offset);
+    char* valuePathCopy;
+    VALUE_PATH_CACHE_ENTRY* newCache;
+
+    if (mallocAndStrcpy_s(&valuePathCopy, valuePath) != 0)
+    {
+        LogError("unable to copy value path %s", valuePath);
+    }
+    else if ((newCache = (VALUE_PATH_CACHE_ENTRY*)realloc(deviceHeader->ValuePathCache, (deviceHeader->ValuePathCacheCount + 1) * sizeof(VALUE_PATH_CACHE_ENTRY))) == NULL)
+    {
+        LogError("unable to grow the value path cache");
+        free(valuePathCopy);
+    }
+    else
+    {
+        deviceHeader->ValuePathCache = newCache;
+        (void)memmove(&newCache[position + 1], &newCache[position], (deviceHeader->ValuePathCacheCount - position) * sizeof(VALUE_PATH_CACHE_ENTRY));
+        newCache[position].offset = offset;
+        newCache[position].propertyReflectedData = propertyReflectedData;
+        newCache[position].valuePath = valuePathCopy;
+        deviceHeader->ValuePathCacheCount++;
+    }
 }
 
 static const REFLECTED_SOMETHING* FindValue(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
@@ -1103,45 +1224,131 @@ static const REFLECTED_SOMETHING* FindReportedProperty(DEVICE_HEADER_DATA* devic
     return result;
 }
 
+/*returns the entry of the field table of the device that starts exactly at value, NULL if there is none*/
+static const CODEFIRST_MODEL_FIELD* FindModelField(const DEVICE_HEADER_DATA* deviceHeader, const void* value)
+{
+    const CODEFIRST_MODEL_FIELD* result = NULL;
+    size_t valueOffset = (size_t)((const unsigned char*)value - deviceHeader->data);
+    size_t low = 0;
+    size_t high = deviceHeader->ModelFieldCount;
+
+    /*the field table is in declaration order, which is also increasing offset order*/
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (deviceHeader->ModelFields[middle].offset < valueOffset)
+        {
+            low = middle + 1;
+        }
+        else if (deviceHeader->ModelFields[middle].offset > valueOffset)
+        {
+            high = middle;
+        }
+        else
+        {
+            result = &deviceHeader->ModelFields[middle];
+            break;
+        }
+    }
+
+    return result;
+}
+
+static CODEFIRST_RESULT PublishValue(TRANSACTION_HANDLE transaction, const char* valuePath, int(*createAgentDataType)(void* param, AGENT_DATA_TYPE* dest), void* value)
+{
+    CODEFIRST_RESULT result;
+    AGENT_DATA_TYPE agentDataType;
+
+    /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
+    /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
+    if (createAgentDataType(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+    {
+        /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
+        result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+        LOG_CODEFIRST_ERROR;
+    }
+    else
+    {
+        /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
+        if (Device_PublishTransacted(transaction, valuePath, &agentDataType) != DEVICE_OK)
+        {
+            /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+            result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+            LOG_CODEFIRST_ERROR;
+        }
+        else
+        {
+            result = CODEFIRST_OK;
+        }
+
+        Destroy_AGENT_DATA_TYPE(&agentDataType);
+    }
+
+    return result;
+}
+
+static CODEFIRST_RESULT PublishModelField(TRANSACTION_HANDLE transaction, unsigned char* deviceAddress, const CODEFIRST_MODEL_FIELD* field)
+{
+    return PublishValue(transaction, field->name, field->Create_AGENT_DATA_TYPE_from_Ptr, deviceAddress + field->offset);
+}
+
 /* Codes_SRS_CODEFIRST_99_130:[If a pointer to the beginning of a device block is passed to CodeFirst_SendAsync instead of a pointer to a property, CodeFirst_SendAsync shall send all the properties that belong to that device.] */
 /* Codes_SRS_CODEFIRST_99_131:[The properties shall be given to Device as one transaction, as if they were all passed as individual arguments to Code_First.] */
 static CODEFIRST_RESULT SendAllDeviceProperties(DEVICE_HEADER_DATA* deviceHeader, TRANSACTION_HANDLE transaction)
 {
-    const char* modelName = Schema_GetModelName(deviceHeader->ModelHandle);
-    const REFLECTED_SOMETHING* something;
     unsigned char* deviceAddress = (unsigned char*)deviceHeader->data;
     CODEFIRST_RESULT result = CODEFIRST_OK;
 
-    for (something = deviceHeader->ReflectedData->reflectedData; something != NULL; something = something->next)
+    if (deviceHeader->ModelFields != NULL)
     {
-        if ((something->type == REFLECTION_PROPERTY_TYPE) &&
-            (strcmp(something->what.property.modelName, modelName) == 0))
+        /* Codes_SRS_CODEFIRST_02_067: [ When the device has a field table, CodeFirst_SendAsync shall send all the properties of the device from the field table, in the same order as the metadata lists them. ]*/
+        /*the metadata lists the properties of a model last declared first*/
+        size_t i = deviceHeader->ModelFieldCount;
+        while (i > 0)
         {
-            AGENT_DATA_TYPE agentDataType;
-
-            /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
-            /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
-            if (something->what.property.Create_AGENT_DATA_TYPE_from_Ptr(deviceAddress + something->what.property.offset, &agentDataType) != AGENT_DATA_TYPES_OK)
+            i--;
+            if ((result = PublishModelField(transaction, deviceAddress, &deviceHeader->ModelFields[i])) != CODEFIRST_OK)
             {
-                /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
-                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
-                LOG_CODEFIRST_ERROR;
                 break;
             }
-            else
+        }
+    }
+    else
+    {
+        const char* modelName = Schema_GetModelName(deviceHeader->ModelHandle);
+        const REFLECTED_SOMETHING* something;
+
+        for (something = deviceHeader->ReflectedData->reflectedData; something != NULL; something = something->next)
+        {
+            if ((something->type == REFLECTION_PROPERTY_TYPE) &&
+                (strcmp(something->what.property.modelName, modelName) == 0))
             {
-                /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
-                if (Device_PublishTransacted(transaction, something->what.property.name, &agentDataType) != DEVICE_OK)
-                {
-                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                AGENT_DATA_TYPE agentDataType;
 
-                    /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
+                /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
+                if (something->what.property.Create_AGENT_DATA_TYPE_from_Ptr(deviceAddress + something->what.property.offset, &agentDataType) != AGENT_DATA_TYPES_OK)
+                {
+                    /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
+                    result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                     LOG_CODEFIRST_ERROR;
                     break;
                 }
+                else
+                {
+                    /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
+                    if (Device_PublishTransacted(transaction, something->what.property.name, &agentDataType) != DEVICE_OK)
+                    {
+                        Destroy_AGENT_DATA_TYPE(&agentDataType);
 
-                Destroy_AGENT_DATA_TYPE(&agentDataType);
+                        /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                        LOG_CODEFIRST_ERROR;
+                        break;
+                    }
+
+                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                }
             }
         }
     }
@@ -1222,6 +1429,8 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
         for (i = 0; i < numProperties; i++)
         {
             void* value = (void*)va_arg(ap, void*);
+            const CODEFIRST_MODEL_FIELD* modelField;
+            const VALUE_PATH_CACHE_ENTRY* cachedValuePath;
 
             /* Codes_SRS_CODEFIRST_99_095:[For each value passed to it, CodeFirst_SendAsync shall look up to which device the value belongs.] */
             DEVICE_HEADER_DATA* currentValueDeviceHeader = FindDevice(value);
@@ -1264,6 +1473,24 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
                         break;
                     }
                 }
+                else if ((modelField = FindModelField(deviceHeader, value)) != NULL)
+                {
+                    /* Codes_SRS_CODEFIRST_02_066: [ When the device has a field table and a value is exactly one of the fields in the table, CodeFirst_SendAsync shall marshal and publish the value using the name and the Create_AGENT_DATA_TYPE_from_Ptr function from the field table, without searching the metadata. ]*/
+                    result = PublishModelField(transaction, deviceHeader->data, modelField);
+                    if (result != CODEFIRST_OK)
+                    {
+                        break;
+                    }
+                }
+                else if ((cachedValuePath = FindCachedValuePath(deviceHeader, value)) != NULL)
+                {
+                    /* Codes_SRS_CODEFIRST_02_077: [ When a value has been published before from the same device, CodeFirst_SendAsync shall reuse the property and the full path found the first time, without searching the metadata again. ]*/
+                    result = PublishValue(transaction, cachedValuePath->valuePath, cachedValuePath->propertyReflectedData->what.property.Create_AGENT_DATA_TYPE_from_Ptr, value);
+                    if (result != CODEFIRST_OK)
+                    {
+                        break;
+                    }
+                }
                 else
                 {
                     const REFLECTED_SOMETHING* propertyReflectedData;
@@ -1313,7 +1540,8 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
                             {
                                 /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
                                 /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
-                                if (Device_PublishTransacted(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
+                                const char* valuePathAsString = STRING_c_str(valuePath);
+                                if (Device_PublishTransacted(transaction, valuePathAsString, &agentDataType) != DEVICE_OK)
                                 {
                                     Destroy_AGENT_DATA_TYPE(&agentDataType);
 
@@ -1325,6 +1553,8 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
                                 }
                                 else
                                 {
+                                    /* Codes_SRS_CODEFIRST_02_078: [ After a value found by searching the metadata has been published, CodeFirst_SendAsync shall remember its property and full path for the device. Failing to remember them shall not fail CodeFirst_SendAsync. ]*/
+                                    CacheValuePath(deviceHeader, value, propertyReflectedData, valuePathAsString);
                                     STRING_delete(valuePath); /*anyway*/
                                 }
 
@@ -1363,6 +1593,157 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
     return result;
 }
 
+static CODEFIRST_RESULT AppendModelField(STRING_HANDLE json, const void* model, const CODEFIRST_MODEL_FIELD* field, bool isFirst)
+{
+    CODEFIRST_RESULT result;
+    AGENT_DATA_TYPE agentDataType;
+
+    /* Codes_SRS_CODEFIRST_02_071: [ For every serialized field CodeFirst_SerializeModel shall call the Create_AGENT_DATA_TYPE_from_Ptr function of the field and append "name":value to the JSON object, separating members with ", ". ]*/
+    if (field->Create_AGENT_DATA_TYPE_from_Ptr((unsigned char*)model + field->offset, &agentDataType) != AGENT_DATA_TYPES_OK)
+    {
+        /* Codes_SRS_CODEFIRST_02_072: [ If Create_AGENT_DATA_TYPE_from_Ptr or AgentDataTypes_ToString fails, CodeFirst_SerializeModel shall fail and return CODEFIRST_AGENT_DATA_TYPE_ERROR. ]*/
+        result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+        LOG_CODEFIRST_ERROR;
+    }
+    else
+    {
+        if ((STRING_concat(json, isFirst ? "\"" : ", \"") != 0) ||
+            (STRING_concat(json, field->name) != 0) ||
+            (STRING_concat(json, "\":") != 0))
+        {
+            /* Codes_SRS_CODEFIRST_02_074: [ If any other error occurs, CodeFirst_SerializeModel shall fail and return CODEFIRST_ERROR. ]*/
+            result = CODEFIRST_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else if (AgentDataTypes_ToString(json, &agentDataType) != AGENT_DATA_TYPES_OK)
+        {
+            /* Codes_SRS_CODEFIRST_02_072: [ If Create_AGENT_DATA_TYPE_from_Ptr or AgentDataTypes_ToString fails, CodeFirst_SerializeModel shall fail and return CODEFIRST_AGENT_DATA_TYPE_ERROR. ]*/
+            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else
+        {
+            result = CODEFIRST_OK;
+        }
+
+        Destroy_AGENT_DATA_TYPE(&agentDataType);
+    }
+
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_SerializeModel(unsigned char** destination, size_t* destinationSize, const void* model, const CODEFIRST_MODEL_FIELD* fields, size_t fieldCount, size_t numSelectedFields, ...)
+{
+    CODEFIRST_RESULT result;
+
+    /* Codes_SRS_CODEFIRST_02_068: [ If destination, destinationSize, model or fields is NULL, or numSelectedFields is greater than fieldCount, CodeFirst_SerializeModel shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    if ((destination == NULL) ||
+        (destinationSize == NULL) ||
+        (model == NULL) ||
+        (fields == NULL) ||
+        (numSelectedFields > fieldCount))
+    {
+        result = CODEFIRST_INVALID_ARG;
+        LOG_CODEFIRST_ERROR;
+    }
+    else
+    {
+        unsigned char* isSelected = NULL;
+        result = CODEFIRST_OK;
+
+        if (numSelectedFields > 0)
+        {
+            if ((isSelected = (unsigned char*)calloc(fieldCount, 1)) == NULL)
+            {
+                /* Codes_SRS_CODEFIRST_02_074: [ If any other error occurs, CodeFirst_SerializeModel shall fail and return CODEFIRST_ERROR. ]*/
+                result = CODEFIRST_ERROR;
+                LOG_CODEFIRST_ERROR;
+            }
+            else
+            {
+                va_list ap;
+                size_t i;
+
+                /* Codes_SRS_CODEFIRST_02_070: [ Otherwise CodeFirst_SerializeModel shall serialize only the fields whose indexes are passed as int arguments after numSelectedFields, in declaration order. ]*/
+                va_start(ap, numSelectedFields);
+                for (i = 0; i < numSelectedFields; i++)
+                {
+                    int fieldIndex = va_arg(ap, int);
+                    if ((fieldIndex < 0) ||
+                        ((size_t)fieldIndex >= fieldCount) ||
+                        (isSelected[fieldIndex] != 0))
+                    {
+                        /* Codes_SRS_CODEFIRST_02_069: [ If a field index is out of range or appears more than once, CodeFirst_SerializeModel shall fail and return CODEFIRST_INVALID_ARG. ]*/
+                        result = CODEFIRST_INVALID_ARG;
+                        LOG_CODEFIRST_ERROR;
+                        break;
+                    }
+                    isSelected[fieldIndex] = 1;
+                }
+                va_end(ap);
+            }
+        }
+
+        if (result == CODEFIRST_OK)
+        {
+            STRING_HANDLE json;
+            if ((json = STRING_construct("{")) == NULL)
+            {
+                /* Codes_SRS_CODEFIRST_02_074: [ If any other error occurs, CodeFirst_SerializeModel shall fail and return CODEFIRST_ERROR. ]*/
+                result = CODEFIRST_ERROR;
+                LOG_CODEFIRST_ERROR;
+            }
+            else
+            {
+                size_t i;
+                bool isFirst = true;
+
+                /* Codes_SRS_CODEFIRST_02_073: [ If numSelectedFields is 0, CodeFirst_SerializeModel shall serialize all the fields, in declaration order. ]*/
+                for (i = 0; i < fieldCount; i++)
+                {
+                    if ((isSelected == NULL) || (isSelected[i] != 0))
+                    {
+                        if ((result = AppendModelField(json, model, &fields[i], isFirst)) != CODEFIRST_OK)
+                        {
+                            break;
+                        }
+                        isFirst = false;
+                    }
+                }
+
+                if (result == CODEFIRST_OK)
+                {
+                    size_t jsonLength;
+                    if (STRING_concat(json, "}") != 0)
+                    {
+                        /* Codes_SRS_CODEFIRST_02_074: [ If any other error occurs, CodeFirst_SerializeModel shall fail and return CODEFIRST_ERROR. ]*/
+                        result = CODEFIRST_ERROR;
+                        LOG_CODEFIRST_ERROR;
+                    }
+                    else if ((*destination = (unsigned char*)malloc(jsonLength = STRING_length(json))) == NULL)
+                    {
+                        /* Codes_SRS_CODEFIRST_02_074: [ If any other error occurs, CodeFirst_SerializeModel shall fail and return CODEFIRST_ERROR. ]*/
+                        result = CODEFIRST_ERROR;
+                        LOG_CODEFIRST_ERROR;
+                    }
+                    else
+                    {
+                        /* Codes_SRS_CODEFIRST_02_075: [ On success CodeFirst_SerializeModel shall return in destination a newly allocated buffer holding the JSON (not zero terminated), in destinationSize its size, and return CODEFIRST_OK. ]*/
+                        (void)memcpy(*destination, STRING_c_str(json), jsonLength);
+                        *destinationSize = jsonLength;
+                    }
+                }
+
+                STRING_delete(json);
+            }
+        }
+
+        free(isSelected);
+    }
+
+    return result;
+}
+
 CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t* destinationSize, size_t numReportedProperties, ...)
 {
     CODEFIRST_RESULT result;
@@ -1555,6 +1936,70 @@ EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommand(void* device, const char* comman
     return result;
 }
 
+EXECUTE_COMMAND_RESULT CodeFirst_ExecuteEncodedCommand(void* device, DATA_ENCODING encoding, const unsigned char* command, size_t commandSize)
+{
+    EXECUTE_COMMAND_RESULT result;
+    /*Codes_SRS_CODEFIRST_02_079: [ If parameter device or command is NULL then CodeFirst_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    if (
+        (device == NULL) ||
+        (command == NULL)
+        )
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("invalid argument (NULL) passed to CodeFirst_ExecuteEncodedCommand void* device = %p, const unsigned char* command = %p", device, command);
+    }
+    else
+    {
+        DEVICE_HEADER_DATA* deviceHeader = FindDevice(device);
+        if (deviceHeader == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_02_080: [ If finding the device fails, then CodeFirst_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+            result = EXECUTE_COMMAND_ERROR;
+            LogError("unable to find the device given by address %p", device);
+        }
+        else
+        {
+            /*Codes_SRS_CODEFIRST_02_081: [ Otherwise CodeFirst_ExecuteEncodedCommand shall call Device_ExecuteEncodedCommand and return what Device_ExecuteEncodedCommand is returning. ]*/
+            result = Device_ExecuteEncodedCommand(deviceHeader->DeviceHandle, encoding, command, commandSize);
+        }
+    }
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_SetEncoding(void* device, DATA_ENCODING encoding)
+{
+    CODEFIRST_RESULT result;
+    /*Codes_SRS_CODEFIRST_02_082: [ If device is NULL then CodeFirst_SetEncoding shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    if (device == NULL)
+    {
+        result = CODEFIRST_INVALID_ARG;
+        LogError("invalid argument (NULL) passed to CodeFirst_SetEncoding");
+    }
+    else
+    {
+        DEVICE_HEADER_DATA* deviceHeader = FindDevice(device);
+        if (deviceHeader == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_02_083: [ If finding the device fails, then CodeFirst_SetEncoding shall fail and return CODEFIRST_INVALID_ARG. ]*/
+            result = CODEFIRST_INVALID_ARG;
+            LogError("unable to find the device given by address %p", device);
+        }
+        /*Codes_SRS_CODEFIRST_02_084: [ CodeFirst_SetEncoding shall call Device_SetEncoding. ]*/
+        else if (Device_SetEncoding(deviceHeader->DeviceHandle, encoding) != DEVICE_OK)
+        {
+            /*Codes_SRS_CODEFIRST_02_085: [ If Device_SetEncoding fails then CodeFirst_SetEncoding shall fail and return CODEFIRST_DEVICE_FAILED. ]*/
+            result = CODEFIRST_DEVICE_FAILED;
+            LogError("failure in Device_SetEncoding");
+        }
+        else
+        {
+            /*Codes_SRS_CODEFIRST_02_086: [ Otherwise CodeFirst_SetEncoding shall succeed and return CODEFIRST_OK. ]*/
+            result = CODEFIRST_OK;
+        }
+    }
+    return result;
+}
+
 METHODRETURN_HANDLE CodeFirst_ExecuteMethod(void* device, const char* methodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
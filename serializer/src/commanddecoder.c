@@ -14,6 +14,7 @@
 #include "schema.h"
 #include "codefirst.h"
 #include "jsondecoder.h"
+#include "binarydecoder.h"
 
 DEFINE_ENUM_STRINGS(COMMANDDECODER_RESULT, COMMANDDECODER_RESULT_VALUES);
 
@@ -632,6 +633,51 @@ static METHODRETURN_HANDLE DecodeMethod(COMMAND_DECODER_HANDLE_DATA* commandDeco
 }
 
 /*Codes_SRS_COMMAND_DECODER_01_009: [Whenever CommandDecoder_ExecuteCommand is the command shall be decoded and further dispatched to the actionCallback passed in CommandDecoder_Create.]*/
+/*decodes size bytes of command JSON (not necessarily '\0' terminated) and dispatches the command*/
+static EXECUTE_COMMAND_RESULT ExecuteJSONCommand(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, const char* command, size_t size)
+{
+    EXECUTE_COMMAND_RESULT result;
+    char* commandJSON;
+
+    /* Codes_SRS_COMMAND_DECODER_01_011: [If the size of the command is 0 then the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.]*/
+    if (size == 0)
+    {
+        LogError("Failed because command size is zero");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    /*Codes_SRS_COMMAND_DECODER_01_013: [If parsing the JSON to a multi tree fails, the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.]*/
+    else if ((commandJSON = (char*)malloc(size + 1)) == NULL)
+    {
+        LogError("Failed to allocate temporary storage for the commands JSON");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        MULTITREE_HANDLE commandsTree;
+
+        (void)memcpy(commandJSON, command, size);
+        commandJSON[size] = '\0';
+
+        /* Codes_SRS_COMMAND_DECODER_01_012: [CommandDecoder shall decode the command JSON contained in buffer to a multi-tree by using JSONDecoder_JSON_To_MultiTree.] */
+        if (JSONDecoder_JSON_To_MultiTree(commandJSON, &commandsTree) != JSON_DECODER_OK)
+        {
+            /* Codes_SRS_COMMAND_DECODER_01_013: [If parsing the JSON to a multi tree fails, the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.] */
+            LogError("Decoding JSON to a multi tree failed");
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else
+        {
+            result = DecodeCommand(commandDecoderInstance, commandsTree);
+
+            /* Codes_SRS_COMMAND_DECODER_01_016: [CommandDecoder shall ensure that the multi-tree resulting from JSONDecoder_JSON_To_MultiTree is freed after the commands are executed.] */
+            MultiTree_Destroy(commandsTree);
+        }
+
+        free(commandJSON);
+    }
+    return result;
+}
+
 EXECUTE_COMMAND_RESULT CommandDecoder_ExecuteCommand(COMMAND_DECODER_HANDLE handle, const char* command)
 {
     EXECUTE_COMMAND_RESULT result;
@@ -647,44 +693,45 @@ EXECUTE_COMMAND_RESULT CommandDecoder_ExecuteCommand(COMMAND_DECODER_HANDLE hand
     }
     else
     {
-        size_t size = strlen(command);
-        char* commandJSON;
+        result = ExecuteJSONCommand(commandDecoderInstance, command, strlen(command));
+    }
+    return result;
+}
 
-        /* Codes_SRS_COMMAND_DECODER_01_011: [If the size of the command is 0 then the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.]*/
-        if (size == 0)
-        {
-            LogError("Failed because command size is zero");
-            result = EXECUTE_COMMAND_ERROR;
-        }
-        /*Codes_SRS_COMMAND_DECODER_01_013: [If parsing the JSON to a multi tree fails, the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.]*/
-        else if ((commandJSON = (char*)malloc(size + 1)) == NULL)
+EXECUTE_COMMAND_RESULT CommandDecoder_ExecuteEncodedCommand(COMMAND_DECODER_HANDLE handle, DATA_ENCODING encoding, const unsigned char* command, size_t commandSize)
+{
+    EXECUTE_COMMAND_RESULT result;
+    COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+    /*Codes_SRS_COMMAND_DECODER_02_029: [ If handle or command is NULL then CommandDecoder_ExecuteEncodedCommand shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    if (
+        (command == NULL) ||
+        (commandDecoderInstance == NULL)
+    )
+    {
+        LogError("Invalid argument, COMMAND_DECODER_HANDLE handle=%p, const unsigned char* command=%p", handle, command);
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else if (encoding == DATA_ENCODING_JSON)
+    {
+        /*Codes_SRS_COMMAND_DECODER_02_030: [ If encoding is DATA_ENCODING_JSON then CommandDecoder_ExecuteEncodedCommand shall decode and dispatch the commandSize bytes of command exactly as CommandDecoder_ExecuteCommand does. ]*/
+        result = ExecuteJSONCommand(commandDecoderInstance, (const char*)command, commandSize);
+    }
+    else
+    {
+        MULTITREE_HANDLE commandsTree;
+
+        /*Codes_SRS_COMMAND_DECODER_02_031: [ Otherwise CommandDecoder_ExecuteEncodedCommand shall decode the command to a multi tree by calling BinaryDecoder_To_MultiTree. ]*/
+        if (BinaryDecoder_To_MultiTree(encoding, command, commandSize, &commandsTree) != BINARY_DECODER_OK)
         {
-            LogError("Failed to allocate temporary storage for the commands JSON");
+            /*Codes_SRS_COMMAND_DECODER_02_032: [ If BinaryDecoder_To_MultiTree fails then CommandDecoder_ExecuteEncodedCommand shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+            LogError("Decoding the command (encoding=%d) to a multi tree failed", (int)encoding);
             result = EXECUTE_COMMAND_ERROR;
         }
         else
         {
-            MULTITREE_HANDLE commandsTree;
-
-            (void)memcpy(commandJSON, command, size);
-            commandJSON[size] = '\0';
-
-            /* Codes_SRS_COMMAND_DECODER_01_012: [CommandDecoder shall decode the command JSON contained in buffer to a multi-tree by using JSONDecoder_JSON_To_MultiTree.] */
-            if (JSONDecoder_JSON_To_MultiTree(commandJSON, &commandsTree) != JSON_DECODER_OK)
-            {
-                /* Codes_SRS_COMMAND_DECODER_01_013: [If parsing the JSON to a multi tree fails, the processing shall stop and the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.] */
-                LogError("Decoding JSON to a multi tree failed");
-                result = EXECUTE_COMMAND_ERROR;
-            }
-            else
-            {
-                result = DecodeCommand(commandDecoderInstance, commandsTree);
-
-                /* Codes_SRS_COMMAND_DECODER_01_016: [CommandDecoder shall ensure that the multi-tree resulting from JSONDecoder_JSON_To_MultiTree is freed after the commands are executed.] */
-                MultiTree_Destroy(commandsTree);
-            }
-
-            free(commandJSON);
+            /*Codes_SRS_COMMAND_DECODER_02_033: [ CommandDecoder_ExecuteEncodedCommand shall dispatch the command from the multi tree the same way CommandDecoder_ExecuteCommand does, free the multi tree and return the result of the dispatch. ]*/
+            result = DecodeCommand(commandDecoderInstance, commandsTree);
+            MultiTree_Destroy(commandsTree);
         }
     }
     return result;
@@ -797,10 +844,95 @@ void CommandDecoder_Destroy(COMMAND_DECODER_HANDLE commandDecoderHandle)
 
 DEFINE_ENUM_STRINGS(AGENT_DATA_TYPE_TYPE, AGENT_DATA_TYPE_TYPE_VALUES);
 
+/*a twin patch deletes a desired property by setting it to null*/
+static bool isNullNode(MULTITREE_HANDLE node)
+{
+    const void* value = NULL;
+    return (MultiTree_GetValue(node, &value) == MULTITREE_OK) &&
+        (value != NULL) &&
+        (strcmp((const char*)value, "null") == 0);
+}
+
+static int resetDesiredProperty(void* startAddress, size_t offset, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle)
+{
+    int result;
+    pfDesiredPropertyDeinitialize desiredPropertyDeinitialize;
+    pfDesiredPropertyInitialize desiredPropertyInitialize;
+
+    if (
+        ((desiredPropertyDeinitialize = Schema_GetModelDesiredProperty_pfDesiredPropertyDeinitialize(desiredPropertyHandle)) == NULL) ||
+        ((desiredPropertyInitialize = Schema_GetModelDesiredProperty_pfDesiredPropertyInitialize(desiredPropertyHandle)) == NULL)
+        )
+    {
+        LogError("unexpected error in getting the initialize/deinitialize functions of a desired property");
+        result = __FAILURE__;
+    }
+    else
+    {
+        char* destination = (char*)startAddress + offset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle);
+        desiredPropertyDeinitialize(destination);
+        desiredPropertyInitialize(destination);
+        result = 0;
+    }
+    return result;
+}
+
+/*resets all the desired properties of a model, including the ones of its models in model*/
+static int resetModelDesiredProperties(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, size_t offset)
+{
+    int result;
+    size_t nDesiredProperties;
+    size_t nModels;
+
+    if (
+        (Schema_GetModelDesiredPropertyCount(modelHandle, &nDesiredProperties) != SCHEMA_OK) ||
+        (Schema_GetModelModelCount(modelHandle, &nModels) != SCHEMA_OK)
+        )
+    {
+        LogError("failure in getting the desired properties of a model");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        result = 0;
+
+        for (i = 0; (result == 0) && (i < nDesiredProperties); i++)
+        {
+            SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = Schema_GetModelDesiredPropertyByIndex(modelHandle, i);
+            if (desiredPropertyHandle == NULL)
+            {
+                LogError("failure in Schema_GetModelDesiredPropertyByIndex");
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = resetDesiredProperty(startAddress, offset, desiredPropertyHandle);
+            }
+        }
+
+        for (i = 0; (result == 0) && (i < nModels); i++)
+        {
+            SCHEMA_MODEL_TYPE_HANDLE modelModel = Schema_GetModelModelyByIndex(modelHandle, i);
+            if (modelModel == NULL)
+            {
+                LogError("failure in Schema_GetModelModelyByIndex");
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = resetModelDesiredProperties(startAddress, modelModel, offset + Schema_GetModelModelByIndex_Offset(modelHandle, i));
+            }
+        }
+    }
+    return result;
+}
+
 /*validates that the multitree (coming from a JSON) is actually a serialization of the model (complete or incomplete)*/
 /*if the serialization contains more than the model, then it fails.*/
 /*if the serialization does not contain mandatory items from the model, it fails*/
-static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE desiredPropertiesTree, size_t offset)
+/*when isPatch is true the multitree comes from a twin patch, where null means "delete the property"*/
+static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE desiredPropertiesTree, size_t offset, bool isPatch)
 {
 
     bool result;
@@ -861,7 +993,26 @@ static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HAN
 
                             const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
                             AGENT_DATA_TYPE output;
-                            if (DecodeValueFromNode(Schema_GetSchemaForModelType(modelHandle), &output, child, desiredPropertyType) != 0)
+                            if (isPatch && isNullNode(child))
+                            {
+                                /*Codes_SRS_COMMAND_DECODER_02_026: [ If parseDesiredNode is false and the value of a desired property is null then the desired property shall be reset to its default value by calling its pfDesiredPropertyDeinitialize and pfDesiredPropertyInitialize. ]*/
+                                if (resetDesiredProperty(startAddress, offset, desiredPropertyHandle) != 0)
+                                {
+                                    LogError("failure in resetting desired property %s", childName_str);
+                                    i = nChildren;
+                                }
+                                else
+                                {
+                                    /*Codes_SRS_COMMAND_DECODER_02_027: [ After a desired property has been reset, its non-NULL pfOnDesiredProperty shall be called. ]*/
+                                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
+                                    if (onDesiredProperty != NULL)
+                                    {
+                                        onDesiredProperty((char*)startAddress + offset);
+                                    }
+                                    nProcessedChildren++;
+                                }
+                            }
+                            else if (DecodeValueFromNode(Schema_GetSchemaForModelType(modelHandle), &output, child, desiredPropertyType) != 0)
                             {
                                 LogError("failure in DecodeValueFromNode");
                                 i = nChildren;
@@ -892,9 +1043,29 @@ static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HAN
                         case(SCHEMA_MODEL_IN_MODEL):
                         {
                             SCHEMA_MODEL_TYPE_HANDLE modelModel = elementType.elementHandle.modelHandle;
+                            size_t modelModelOffset = offset + Schema_GetModelModelByName_Offset(modelHandle, childName_str);
+
+                            if (isPatch && isNullNode(child))
+                            {
+                                /*Codes_SRS_COMMAND_DECODER_02_028: [ If parseDesiredNode is false and the value of a model in model is null then all the desired properties of the model in model shall be reset to their default values. ]*/
+                                if (resetModelDesiredProperties(startAddress, modelModel, modelModelOffset) != 0)
+                                {
+                                    LogError("failure in resetting model in model %s", childName_str);
+                                    i = nChildren;
+                                }
+                                else
+                                {
+                                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(modelHandle, childName_str);
+                                    if (onDesiredProperty != NULL)
+                                    {
+                                        onDesiredProperty((char*)startAddress + offset);
+                                    }
 
+                                    nProcessedChildren++;
+                                }
+                            }
                             /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
-                            if (!validateModel_vs_Multitree(startAddress, modelModel, child, offset + Schema_GetModelModelByName_Offset(modelHandle, childName_str)))
+                            else if (!validateModel_vs_Multitree(startAddress, modelModel, child, modelModelOffset, isPatch))
                             {
                                 LogError("failure in validateModel_vs_Multitree");
                                 i = nChildren;
@@ -936,10 +1107,10 @@ static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HAN
     return result;
 }
 
-static EXECUTE_COMMAND_RESULT DecodeDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE_DATA* handle, MULTITREE_HANDLE desiredPropertiesTree)
+static EXECUTE_COMMAND_RESULT DecodeDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE_DATA* handle, MULTITREE_HANDLE desiredPropertiesTree, bool isPatch)
 {
     /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-    return validateModel_vs_Multitree(startAddress, handle->ModelHandle, desiredPropertiesTree, 0 )?EXECUTE_COMMAND_SUCCESS:EXECUTE_COMMAND_FAILED;
+    return validateModel_vs_Multitree(startAddress, handle->ModelHandle, desiredPropertiesTree, 0, isPatch)?EXECUTE_COMMAND_SUCCESS:EXECUTE_COMMAND_FAILED;
 }
 
 /* Raw JSON has properties we don't need; potentially nodes other than "desired" for full TWIN as well as a $version we don't pass to callees */
@@ -1027,7 +1198,8 @@ EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress
                     COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
 
                     /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-                    result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree);
+                    /*a complete twin (parseDesiredNode is true) is ingested as is, otherwise the JSON is a patch that only carries the changed desired properties*/
+                    result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree, !parseDesiredNode);
 
                     // Do NOT free desiredPropertiesTree.  It is only a pointer into initialParsedTree.
                     MultiTree_Destroy(initialParsedTree);
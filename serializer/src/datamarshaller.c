@@ -2,13 +2,15 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h> /*for free*/
+#include <string.h>
+#include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stdbool.h>
 #include "datamarshaller.h"
+#include "binaryencoder.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
-#include "jsonencoder.h"
 #include "agenttypesystem.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "parson.h"
@@ -23,17 +25,396 @@ typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG
 {
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     bool IncludePropertyPath;
+    DATA_ENCODING Encoding;
 } DATA_MARSHALLER_HANDLE_DATA;
 
-static int NoCloneFunction(void** destination, const void* source)
+/*same limit as MultiTree puts on the names of inner nodes*/
+#define DATA_MARSHALLER_INNER_NAME_SIZE 128
+
+/*the output buffer starts with room for this many bytes per value and grows geometrically*/
+#define DATA_MARSHALLER_BYTES_PER_VALUE_HINT 48
+
+typedef struct OUTPUT_WRITER_TAG
+{
+    unsigned char* buffer;
+    size_t size;
+    size_t capacity;
+} OUTPUT_WRITER;
+
+static int OutputWriter_Init(OUTPUT_WRITER* writer, size_t capacity)
 {
-    *destination = (void*)source;
-    return 0;
+    int result;
+    if ((writer->buffer = (unsigned char*)malloc(capacity)) == NULL)
+    {
+        LogError("failure allocating %lu bytes for the output", (unsigned long)capacity);
+        result = __FAILURE__;
+    }
+    else
+    {
+        writer->size = 0;
+        writer->capacity = capacity;
+        result = 0;
+    }
+    return result;
 }
 
-static void NoFreeFunction(void* value)
+static int OutputWriter_Append(OUTPUT_WRITER* writer, const char* source, size_t sourceLength)
 {
-    (void)value;
+    int result;
+    if (writer->size + sourceLength > writer->capacity)
+    {
+        size_t newCapacity = writer->capacity * 2;
+        unsigned char* newBuffer;
+        if (newCapacity < writer->size + sourceLength)
+        {
+            newCapacity = writer->size + sourceLength;
+        }
+
+        if ((newBuffer = (unsigned char*)realloc(writer->buffer, newCapacity)) == NULL)
+        {
+            LogError("failure growing the output to %lu bytes", (unsigned long)newCapacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            writer->buffer = newBuffer;
+            writer->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        (void)memcpy(writer->buffer + writer->size, source, sourceLength);
+        writer->size += sourceLength;
+    }
+    return result;
+}
+
+/*BINARY_ENCODER_WRITE_FUNCTION appending to an OUTPUT_WRITER*/
+static int OutputWriter_Write(void* context, const unsigned char* bytes, size_t size)
+{
+    return OutputWriter_Append((OUTPUT_WRITER*)context, (const char*)bytes, size);
+}
+
+/*a (path, value) pair of the working copy. Order is the position of the pair in the input, it decides the order of the members*/
+typedef struct DATA_MARSHALLER_ENTRY_TAG
+{
+    const char* PropertyPath;
+    const AGENT_DATA_TYPE* Value;
+    size_t Order;
+} DATA_MARSHALLER_ENTRY;
+
+/*a run of entries sharing the same first path segment*/
+typedef struct DATA_MARSHALLER_GROUP_TAG
+{
+    size_t First;
+    size_t Count;
+    size_t Order;
+} DATA_MARSHALLER_GROUP;
+
+/*the working copy and the room needed to reorder it, taken in a single allocation. scratch and groups are only used while one level is
+reordered, so every level reuses them*/
+typedef struct ENTRY_TABLE_TAG
+{
+    DATA_MARSHALLER_ENTRY* entries;
+    DATA_MARSHALLER_ENTRY* scratch;
+    DATA_MARSHALLER_GROUP* groups;
+} ENTRY_TABLE;
+
+static int EntryTable_Init(ENTRY_TABLE* table, size_t entryCount)
+{
+    int result;
+    size_t count = (entryCount == 0) ? 1 : entryCount;
+    if ((table->entries = (DATA_MARSHALLER_ENTRY*)malloc(count * (2 * sizeof(DATA_MARSHALLER_ENTRY) + sizeof(DATA_MARSHALLER_GROUP)))) == NULL)
+    {
+        LogError("failure allocating the working copy of %lu values", (unsigned long)entryCount);
+        result = __FAILURE__;
+    }
+    else
+    {
+        table->scratch = table->entries + count;
+        table->groups = (DATA_MARSHALLER_GROUP*)(table->scratch + count);
+        result = 0;
+    }
+    return result;
+}
+
+/*orders paths segment by segment: the end of a path comes before '/', which comes before any other character. This way all the paths
+sharing a prefix of whole segments are contiguous, and a leaf comes right before the paths going through it*/
+static int ComparePaths(const char* left, const char* right)
+{
+    while ((*left != '\0') && (*left == *right))
+    {
+        left++;
+        right++;
+    }
+
+    return
+        (*left == *right) ? 0 :
+        (*left == '\0') ? -1 :
+        (*right == '\0') ? 1 :
+        (*left == '/') ? -1 :
+        (*right == '/') ? 1 :
+        ((unsigned char)*left < (unsigned char)*right) ? -1 : 1;
+}
+
+static int CompareEntries(const void* left, const void* right)
+{
+    const DATA_MARSHALLER_ENTRY* leftEntry = (const DATA_MARSHALLER_ENTRY*)left;
+    const DATA_MARSHALLER_ENTRY* rightEntry = (const DATA_MARSHALLER_ENTRY*)right;
+    int result = ComparePaths(leftEntry->PropertyPath, rightEntry->PropertyPath);
+    if (result == 0)
+    {
+        /*qsort is not stable, the input order keeps it deterministic*/
+        result = (leftEntry->Order < rightEntry->Order) ? -1 : 1;
+    }
+    return result;
+}
+
+static int CompareGroups(const void* left, const void* right)
+{
+    return (((const DATA_MARSHALLER_GROUP*)left)->Order < ((const DATA_MARSHALLER_GROUP*)right)->Order) ? -1 : 1;
+}
+
+/*returns the length of the first path segment of path (path is expected to have its leading '/' already skipped)*/
+static size_t GetSegmentLength(const char* path)
+{
+    const char* whereIsDelimiter = strchr(path, '/');
+    return (whereIsDelimiter == NULL) ? strlen(path) : (size_t)(whereIsDelimiter - path);
+}
+
+/*writes the name of an object member, preceded by the separator if it is not the first member*/
+static int WriteMemberName(OUTPUT_WRITER* writer, DATA_ENCODING encoding, const char* name, size_t nameLength, bool isFirstMember)
+{
+    int result;
+    if (encoding == DATA_ENCODING_JSON)
+    {
+        if (
+            ((!isFirstMember) && (OutputWriter_Append(writer, ", ", 2) != 0)) ||
+            (OutputWriter_Append(writer, "\"", 1) != 0) ||
+            (OutputWriter_Append(writer, name, nameLength) != 0) ||
+            (OutputWriter_Append(writer, "\":", 2) != 0)
+            )
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    else if (BinaryEncoder_EncodeString(encoding, name, nameLength, OutputWriter_Write, writer) != BINARY_ENCODER_OK)
+    {
+        LogError("failure in BinaryEncoder_EncodeString");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*writes an object (a JSON object or a CBOR/MessagePack map) containing the entryCount entries of table starting at first. The entries are reordered
+and the paths inside are advanced while writing*/
+/*the produced JSON is the same as the one MultiTree + JSONEncoder would produce: members appear in the order of first appearance of their name,
+entries sharing a path prefix are grouped under the same member and a leaf cannot be followed by a path going through it*/
+/*the root sorts all the entries by path once, which makes every group contiguous at every level. Each level then only puts its groups back
+in the order of first appearance, so writing n values costs O(n log n) plus one pass per level*/
+static DATA_MARSHALLER_RESULT WriteObject(OUTPUT_WRITER* writer, DATA_ENCODING encoding, STRING_HANDLE valueAsString, ENTRY_TABLE* table, size_t first, size_t entryCount, bool isRoot)
+{
+    DATA_MARSHALLER_RESULT result = DATA_MARSHALLER_OK;
+    DATA_MARSHALLER_ENTRY* entries = table->entries + first;
+    size_t memberCount = 0;
+    bool isInOrder = true;
+    size_t i;
+
+    for (i = 0; i < entryCount; i++)
+    {
+        if ((entries[i].PropertyPath != NULL) &&
+            (entries[i].PropertyPath[0] == '/'))
+        {
+            entries[i].PropertyPath++;
+        }
+
+        if ((entries[i].PropertyPath == NULL) ||
+            (entries[i].PropertyPath[0] == '\0') ||
+            (entries[i].PropertyPath[0] == '/') ||
+            (entries[i].Value == NULL))
+        {
+            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+            result = DATA_MARSHALLER_MULTITREE_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+            break;
+        }
+    }
+
+    if ((result == DATA_MARSHALLER_OK) && isRoot)
+    {
+        /* Codes_SRS_DATA_MARSHALLER_02_022: [ DataMarshaller_SendData shall make one working copy of the (path, value) pairs and sort it once by path, so that they can be grouped by path prefix without building a MultiTree. ]*/
+        qsort(entries, entryCount, sizeof(DATA_MARSHALLER_ENTRY), CompareEntries);
+    }
+
+    /*every member is one contiguous group, the leaf of a name (if any) coming first. Binary encodings need the member count before the first member*/
+    i = 0;
+    while ((result == DATA_MARSHALLER_OK) && (i < entryCount))
+    {
+        const char* name = entries[i].PropertyPath;
+        size_t nameLength = GetSegmentLength(name);
+        DATA_MARSHALLER_GROUP* group = table->groups + memberCount;
+        size_t j;
+
+        if ((name[nameLength] == '/') &&
+            (nameLength >= DATA_MARSHALLER_INNER_NAME_SIZE))
+        {
+            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+            result = DATA_MARSHALLER_MULTITREE_ERROR;
+            LogError("path segment is too large %lu", (unsigned long)nameLength);
+            break;
+        }
+
+        group->First = i;
+        group->Order = entries[i].Order;
+        for (j = i + 1;
+            (j < entryCount) &&
+            (strncmp(entries[j].PropertyPath, name, nameLength) == 0) &&
+            ((entries[j].PropertyPath[nameLength] == '\0') || (entries[j].PropertyPath[nameLength] == '/'));
+            j++)
+        {
+            if (entries[j].Order < group->Order)
+            {
+                group->Order = entries[j].Order;
+            }
+        }
+        group->Count = j - i;
+
+        /*the leaves of the name are first in the group, a leaf is only allowed when it is the first appearance of the name*/
+        for (j = i; (j < i + group->Count) && (entries[j].PropertyPath[nameLength] == '\0'); j++)
+        {
+            if (entries[j].Order != group->Order)
+            {
+                /*a second leaf with the same name, or a leaf arriving after a path that goes through it*/
+                /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+                result = DATA_MARSHALLER_MULTITREE_ERROR;
+                LOG_DATA_MARSHALLER_ERROR
+                break;
+            }
+        }
+
+        if ((memberCount > 0) && (group->Order < table->groups[memberCount - 1].Order))
+        {
+            isInOrder = false;
+        }
+        memberCount++;
+        i += group->Count;
+    }
+
+    if ((result == DATA_MARSHALLER_OK) && (!isInOrder))
+    {
+        /*put the groups in the order of first appearance of their names, the entries inside a group keep their order*/
+        size_t written = 0;
+        qsort(table->groups, memberCount, sizeof(DATA_MARSHALLER_GROUP), CompareGroups);
+        for (i = 0; i < memberCount; i++)
+        {
+            (void)memcpy(table->scratch + written, entries + table->groups[i].First, table->groups[i].Count * sizeof(DATA_MARSHALLER_ENTRY));
+            written += table->groups[i].Count;
+        }
+        (void)memcpy(entries, table->scratch, entryCount * sizeof(DATA_MARSHALLER_ENTRY));
+    }
+
+    if (result == DATA_MARSHALLER_OK)
+    {
+        if (encoding == DATA_ENCODING_JSON)
+        {
+            if (OutputWriter_Append(writer, "{", 1) != 0)
+            {
+                result = DATA_MARSHALLER_ERROR;
+                LOG_DATA_MARSHALLER_ERROR
+            }
+        }
+        /* Codes_SRS_DATA_MARSHALLER_02_025: [ When the encoding is DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK, DataMarshaller_SendData shall produce the same document as a map written by BinaryEncoder_EncodeMapHeader, BinaryEncoder_EncodeString and BinaryEncoder_EncodeValue. ]*/
+        else if (BinaryEncoder_EncodeMapHeader(encoding, memberCount, OutputWriter_Write, writer) != BINARY_ENCODER_OK)
+        {
+            result = DATA_MARSHALLER_BINARY_ENCODER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+    }
+
+    i = 0;
+    while ((result == DATA_MARSHALLER_OK) && (i < entryCount))
+    {
+        const char* name = entries[i].PropertyPath;
+        size_t nameLength = GetSegmentLength(name);
+        bool isLeaf = (name[nameLength] == '\0');
+        size_t groupEnd = i + 1;
+
+        while ((groupEnd < entryCount) &&
+            (strncmp(entries[groupEnd].PropertyPath, name, nameLength) == 0) &&
+            ((entries[groupEnd].PropertyPath[nameLength] == '\0') || (entries[groupEnd].PropertyPath[nameLength] == '/')))
+        {
+            groupEnd++;
+        }
+
+        if (WriteMemberName(writer, encoding, name, nameLength, (i == 0)) != 0)
+        {
+            result = (encoding == DATA_ENCODING_JSON) ? DATA_MARSHALLER_ERROR : DATA_MARSHALLER_BINARY_ENCODER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        else if ((!isLeaf) || (groupEnd > i + 1))
+        {
+            /*there are paths continuing past this name, so it becomes an object. A leaf that preceded them is not encoded*/
+            size_t firstChild = isLeaf ? i + 1 : i;
+            size_t j;
+            for (j = firstChild; j < groupEnd; j++)
+            {
+                entries[j].PropertyPath += nameLength;
+            }
+            result = WriteObject(writer, encoding, valueAsString, table, first + firstChild, groupEnd - firstChild, false);
+        }
+        else if (encoding != DATA_ENCODING_JSON)
+        {
+            if (BinaryEncoder_EncodeValue(encoding, entries[i].Value, OutputWriter_Write, writer) != BINARY_ENCODER_OK)
+            {
+                /* Codes_SRS_DATA_MARSHALLER_02_026: [ If any BinaryEncoder API fails, DataMarshaller_SendData shall fail and return DATA_MARSHALLER_BINARY_ENCODER_ERROR. ]*/
+                result = DATA_MARSHALLER_BINARY_ENCODER_ERROR;
+                LOG_DATA_MARSHALLER_ERROR
+            }
+        }
+        else if (AgentDataTypes_ToString(valueAsString, entries[i].Value) != AGENT_DATA_TYPES_OK)
+        {
+            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
+            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        else
+        {
+            const char* valueAsChars = STRING_c_str(valueAsString);
+            size_t valueLength = STRING_length(valueAsString);
+            if ((OutputWriter_Append(writer, valueAsChars, valueLength) != 0) ||
+                (STRING_empty(valueAsString) != 0))
+            {
+                result = DATA_MARSHALLER_ERROR;
+                LOG_DATA_MARSHALLER_ERROR
+            }
+        }
+
+        i = groupEnd;
+    }
+
+    if ((result == DATA_MARSHALLER_OK) &&
+        (encoding == DATA_ENCODING_JSON) &&
+        (OutputWriter_Append(writer, "}", 1) != 0))
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+
+    return result;
 }
 
 DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
@@ -58,6 +439,8 @@ DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandl
         /*Codes_SRS_DATA_MARSHALLER_99_018:[ DataMarshaller_Create shall create a new DataMarshaller instance and on success it shall return a non NULL handle.]*/
         result->ModelHandle = modelHandle;
         result->IncludePropertyPath = includePropertyPath;
+        /* Codes_SRS_DATA_MARSHALLER_02_024: [ DataMarshaller_Create shall set the encoding of the new instance to DATA_ENCODING_JSON. ]*/
+        result->Encoding = DATA_ENCODING_JSON;
     }
     return result;
 }
@@ -73,11 +456,29 @@ void DataMarshaller_Destroy(DATA_MARSHALLER_HANDLE dataMarshallerHandle)
     }
 }
 
+DATA_MARSHALLER_RESULT DataMarshaller_SetEncoding(DATA_MARSHALLER_HANDLE dataMarshallerHandle, DATA_ENCODING encoding)
+{
+    DATA_MARSHALLER_RESULT result;
+    /* Codes_SRS_DATA_MARSHALLER_02_027: [ If dataMarshallerHandle is NULL or encoding is not one of DATA_ENCODING_JSON, DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then DataMarshaller_SetEncoding shall fail and return DATA_MARSHALLER_INVALID_ARG. ]*/
+    if ((dataMarshallerHandle == NULL) ||
+        ((encoding != DATA_ENCODING_JSON) && (encoding != DATA_ENCODING_CBOR) && (encoding != DATA_ENCODING_MSGPACK)))
+    {
+        result = DATA_MARSHALLER_INVALID_ARG;
+        LogError("invalid argument DATA_MARSHALLER_HANDLE dataMarshallerHandle=%p, DATA_ENCODING encoding=%d", dataMarshallerHandle, (int)encoding);
+    }
+    else
+    {
+        /* Codes_SRS_DATA_MARSHALLER_02_028: [ Otherwise DataMarshaller_SetEncoding shall store encoding, all the following DataMarshaller_SendData and DataMarshaller_SendData_ReportedProperties calls shall produce that encoding, and return DATA_MARSHALLER_OK. ]*/
+        dataMarshallerHandle->Encoding = encoding;
+        result = DATA_MARSHALLER_OK;
+    }
+    return result;
+}
+
 DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarshallerHandle, size_t valueCount, const DATA_MARSHALLER_VALUE* values, unsigned char** destination, size_t* destinationSize)
 {
     DATA_MARSHALLER_HANDLE_DATA* dataMarshallerInstance = (DATA_MARSHALLER_HANDLE_DATA*)dataMarshallerHandle;
     DATA_MARSHALLER_RESULT result;
-    MULTITREE_HANDLE treeHandle;
 
     /* Codes_SRS_DATA_MARSHALLER_99_034:[All argument checks shall be performed before calling any other modules.] */
     /* Codes_SRS_DATA_MARSHALLER_99_004:[ DATA_MARSHALLER_INVALID_ARG shall be returned when the function has detected an invalid parameter (NULL) being passed to the function.] */
@@ -120,96 +521,82 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 
         if (i == valueCount)
         {
-            /* Codes_SRS_DATA_MARSHALLER_99_037:[DataMarshaller shall store as MultiTree the data to be encoded by the JSONEncoder module.] */
-            if ((treeHandle = MultiTree_Create(NoCloneFunction, NoFreeFunction)) == NULL)
+            const DATA_MARSHALLER_VALUE* source;
+            size_t entryCount;
+            ENTRY_TABLE table;
+
+            if ((includePropertyPath == false) && (values[0].Value->type == EDM_COMPLEX_TYPE_TYPE))
             {
-                /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                result = DATA_MARSHALLER_MULTITREE_ERROR;
+                /* Codes_SRS_DATAMARSHALLER_01_001: [If the includePropertyPath argument passed to DataMarshaller_Create was false and only one struct is being sent, the relative path of the value passed to DataMarshaller_SendData - including property name - shall be ignored and the value shall be placed at JSON root.] */
+                /* Codes_SRS_DATAMARSHALLER_01_004: [In this case the members of the struct shall be added as leafs into the MultiTree, each leaf having the name of the struct member.] */
+                source = NULL;
+                entryCount = values[0].Value->value.edmComplexType.nMembers;
+            }
+            else
+            {
+                source = values;
+                entryCount = valueCount;
+            }
+
+            /* Codes_SRS_DATA_MARSHALLER_02_022: [ DataMarshaller_SendData shall make one working copy of the (path, value) pairs and sort it once by path, so that they can be grouped by path prefix without building a MultiTree. ]*/
+            if (EntryTable_Init(&table, entryCount) != 0)
+            {
+                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+                result = DATA_MARSHALLER_ERROR;
                 LOG_DATA_MARSHALLER_ERROR
             }
             else
             {
+                STRING_HANDLE valueAsString;
                 size_t j;
-                result = DATA_MARSHALLER_OK; /* addressing warning in VS compiler */
-                /* Codes_SRS_DATA_MARSHALLER_99_038:[For each pair in the values argument, a string : value pair shall exist in the JSON object in the form of propertyName : value.] */
-                for (j = 0; j < valueCount; j++)
+                for (j = 0; j < entryCount; j++)
                 {
-                    if ((includePropertyPath == false) && (values[j].Value->type == EDM_COMPLEX_TYPE_TYPE))
+                    if (source != NULL)
                     {
-                        size_t k;
-
-                        /* Codes_SRS_DATAMARSHALLER_01_001: [If the includePropertyPath argument passed to DataMarshaller_Create was false and only one struct is being sent, the relative path of the value passed to DataMarshaller_SendData - including property name - shall be ignored and the value shall be placed at JSON root.] */
-                        for (k = 0; k < values[j].Value->value.edmComplexType.nMembers; k++)
-                        {
-                            /* Codes_SRS_DATAMARSHALLER_01_004: [In this case the members of the struct shall be added as leafs into the MultiTree, each leaf having the name of the struct member.] */
-                            if (MultiTree_AddLeaf(treeHandle, values[j].Value->value.edmComplexType.fields[k].fieldName, (void*)values[j].Value->value.edmComplexType.fields[k].value) != MULTITREE_OK)
-                            {
-                                break;
-                            }
-                        }
-
-                        if (k < values[j].Value->value.edmComplexType.nMembers)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                            result = DATA_MARSHALLER_MULTITREE_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                            break;
-                        }
+                        table.entries[j].PropertyPath = source[j].PropertyPath;
+                        table.entries[j].Value = source[j].Value;
                     }
                     else
                     {
-                        /* Codes_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
-                        if (MultiTree_AddLeaf(treeHandle, values[j].PropertyPath, (void*)values[j].Value) != MULTITREE_OK)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                            result = DATA_MARSHALLER_MULTITREE_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                            break;
-                        }
+                        table.entries[j].PropertyPath = values[0].Value->value.edmComplexType.fields[j].fieldName;
+                        table.entries[j].Value = values[0].Value->value.edmComplexType.fields[j].value;
                     }
-
+                    table.entries[j].Order = j;
                 }
 
-                if (j == valueCount)
+                if ((valueAsString = STRING_new()) == NULL)
+                {
+                    result = DATA_MARSHALLER_ERROR;
+                    LOG_DATA_MARSHALLER_ERROR
+                }
+                else
                 {
-                    STRING_HANDLE payload = STRING_new();
-                    if (payload == NULL)
+                    OUTPUT_WRITER writer;
+                    /* Codes_SRS_DATA_MARSHALLER_02_023: [ DataMarshaller_SendData shall write the JSON directly into a single growable buffer. ]*/
+                    if (OutputWriter_Init(&writer, 2 + entryCount * DATA_MARSHALLER_BYTES_PER_VALUE_HINT) != 0)
                     {
                         result = DATA_MARSHALLER_ERROR;
                         LOG_DATA_MARSHALLER_ERROR
                     }
                     else
                     {
-                        if (JSONEncoder_EncodeTree(treeHandle, payload, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
+                        /* Codes_SRS_DATA_MARSHALLER_99_038:[For each pair in the values argument, a string : value pair shall exist in the JSON object in the form of propertyName : value.] */
+                        /* Codes_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
+                        if ((result = WriteObject(&writer, dataMarshallerInstance->Encoding, valueAsString, &table, 0, entryCount, true)) != DATA_MARSHALLER_OK)
                         {
-                            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
-                            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
+                            free(writer.buffer);
                         }
                         else
                         {
                             /*Codes_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
-                            size_t resultSize = STRING_length(payload);
-                            unsigned char* temp = malloc(resultSize);
-                            if (temp == NULL)
-                            {
-                                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
-                                result = DATA_MARSHALLER_ERROR;
-                                LOG_DATA_MARSHALLER_ERROR;
-                            }
-                            else
-                            {
-                                (void)memcpy(temp, STRING_c_str(payload), resultSize);
-                                *destination = temp;
-                                *destinationSize = resultSize;
-                                result = DATA_MARSHALLER_OK;
-                            }
+                            *destination = writer.buffer;
+                            *destinationSize = writer.size;
                         }
-                        STRING_delete(payload);
                     }
-                } /* if (j==valueCount)*/
-                MultiTree_Destroy(treeHandle);
-            } /* MultiTree_Create */
+                    STRING_delete(valueAsString);
+                }
+                free(table.entries);
+            }
         }
     }
 
@@ -217,6 +604,56 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 }
 
 
+/*CBOR/MessagePack reported properties are written by the same code that writes SendData's output*/
+static DATA_MARSHALLER_RESULT SendBinaryReportedProperties(DATA_ENCODING encoding, VECTOR_HANDLE values, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    size_t nReportedProperties = VECTOR_size(values);
+    ENTRY_TABLE table;
+
+    if (EntryTable_Init(&table, nReportedProperties) != 0)
+    {
+        /*Codes_SRS_DATA_MARSHALLER_02_019: [ If any failure occurs, DataMarshaller_SendData_ReportedProperties shall fail and return DATA_MARSHALLER_ERROR. ]*/
+        LogError("failure allocating the reported properties working copy");
+        result = DATA_MARSHALLER_ERROR;
+    }
+    else
+    {
+        OUTPUT_WRITER writer;
+        size_t i;
+        for (i = 0; i < nReportedProperties; i++)
+        {
+            const DATA_MARSHALLER_VALUE* value = *(DATA_MARSHALLER_VALUE**)VECTOR_element(values, i);
+            table.entries[i].PropertyPath = value->PropertyPath;
+            table.entries[i].Value = value->Value;
+            table.entries[i].Order = i;
+        }
+
+        if (OutputWriter_Init(&writer, 1 + nReportedProperties * DATA_MARSHALLER_BYTES_PER_VALUE_HINT) != 0)
+        {
+            /*Codes_SRS_DATA_MARSHALLER_02_019: [ If any failure occurs, DataMarshaller_SendData_ReportedProperties shall fail and return DATA_MARSHALLER_ERROR. ]*/
+            result = DATA_MARSHALLER_ERROR;
+        }
+        /*Codes_SRS_DATA_MARSHALLER_02_011: [ DataMarshaller_SendData_ReportedProperties shall ignore the value of includePropertyPath and shall consider it to be true. ]*/
+        else if (WriteObject(&writer, encoding, NULL, &table, 0, nReportedProperties, true) != DATA_MARSHALLER_OK)
+        {
+            /*Codes_SRS_DATA_MARSHALLER_02_019: [ If any failure occurs, DataMarshaller_SendData_ReportedProperties shall fail and return DATA_MARSHALLER_ERROR. ]*/
+            LogError("failure encoding the reported properties");
+            free(writer.buffer);
+            result = DATA_MARSHALLER_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_DATA_MARSHALLER_02_020: [ Otherwise DataMarshaller_SendData_ReportedProperties shall succeed and return DATA_MARSHALLER_OK. ]*/
+            *destination = writer.buffer;
+            *destinationSize = writer.size;
+            result = DATA_MARSHALLER_OK;
+        }
+        free(table.entries);
+    }
+    return result;
+}
+
 DATA_MARSHALLER_RESULT DataMarshaller_SendData_ReportedProperties(DATA_MARSHALLER_HANDLE dataMarshallerHandle, VECTOR_HANDLE values, unsigned char** destination, size_t* destinationSize)
 {
     DATA_MARSHALLER_RESULT result;
@@ -238,6 +675,11 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData_ReportedProperties(DATA_MARSHALLE
             destinationSize);
         result = DATA_MARSHALLER_INVALID_ARG;
     }
+    else if (dataMarshallerHandle->Encoding != DATA_ENCODING_JSON)
+    {
+        /*Codes_SRS_DATA_MARSHALLER_02_029: [ When the encoding is DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK, DataMarshaller_SendData_ReportedProperties shall produce a map having the same structure as the JSON object, written by BinaryEncoder_EncodeMapHeader, BinaryEncoder_EncodeString and BinaryEncoder_EncodeValue. ]*/
+        result = SendBinaryReportedProperties(dataMarshallerHandle->Encoding, values, destination, destinationSize);
+    }
     else
     {
         /*Codes_SRS_DATA_MARSHALLER_02_012: [ DataMarshaller_SendData_ReportedProperties shall create an empty JSON_Value. ]*/
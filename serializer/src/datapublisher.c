@@ -5,6 +5,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stdbool.h>
+#include <string.h>
 #include "datapublisher.h"
 #include "jsonencoder.h"
 #include "datamarshaller.h"
@@ -24,6 +25,9 @@ DEFINE_ENUM_STRINGS(DATA_PUBLISHER_RESULT, DATA_PUBLISHER_RESULT_VALUES)
 /* Codes_SRS_DATA_PUBLISHER_99_067:[ Before any call to DataPublisher_SetMaxBufferSize, the default max buffer size shall be equal to 10KB.] */
 static size_t maxBufferSize_ = DEFAULT_MAX_BUFFER_SIZE;
 
+/*transactions hold at least this many values before growing, always a power of 2*/
+#define TRANSACTION_MINIMUM_CAPACITY 4
+
 typedef struct DATA_PUBLISHER_HANDLE_DATA_TAG
 {
     DATA_MARSHALLER_HANDLE DataMarshallerHandle;
@@ -33,16 +37,101 @@ typedef struct DATA_PUBLISHER_HANDLE_DATA_TAG
 typedef struct TRANSACTION_HANDLE_DATA_TAG
 {
     DATA_PUBLISHER_HANDLE_DATA* DataPublisherInstance;
+    size_t InitialCapacity;
+    size_t ValueCapacity;
     size_t ValueCount;
-    DATA_MARSHALLER_VALUE* Values;
+    DATA_MARSHALLER_VALUE* Values; /*ValueCapacity values, followed in the same allocation by PathIndex*/
+    DATA_MARSHALLER_VALUE** PathIndex; /*2*ValueCapacity slots, open addressing by property path*/
 } TRANSACTION_HANDLE_DATA;
 
 typedef struct REPORTED_PROPERTIES_TRANSACTION_HANDLE_DATA_TAG
 {
     DATA_PUBLISHER_HANDLE_DATA* DataPublisherInstance;
     VECTOR_HANDLE value; /*holds (DATA_MARSHALLER_VALUE*) */
+    DATA_MARSHALLER_VALUE** PathIndex; /*open addressing by property path over the elements of value*/
+    size_t PathIndexSize;
+    size_t PathIndexCount;
 }REPORTED_PROPERTIES_TRANSACTION_HANDLE_DATA;
 
+/*FNV-1a of the property path*/
+static size_t hashPropertyPath(const char* propertyPath)
+{
+    size_t hash = 2166136261u;
+    while (*propertyPath != '\0')
+    {
+        hash = (hash ^ (unsigned char)*propertyPath) * 16777619u;
+        propertyPath++;
+    }
+    return hash;
+}
+
+/*returns the slot of pathIndex that holds propertyPath or, if propertyPath is not indexed, the empty slot where it would go. pathIndexSize is a power of 2 and pathIndex is never full*/
+static DATA_MARSHALLER_VALUE** lookupPropertyPath(DATA_MARSHALLER_VALUE** pathIndex, size_t pathIndexSize, const char* propertyPath)
+{
+    size_t position = hashPropertyPath(propertyPath) & (pathIndexSize - 1);
+    while ((pathIndex[position] != NULL) && (strcmp(pathIndex[position]->PropertyPath, propertyPath) != 0))
+    {
+        position = (position + 1) & (pathIndexSize - 1);
+    }
+    return &pathIndex[position];
+}
+
+static int growTransaction(TRANSACTION_HANDLE_DATA* transaction)
+{
+    int result;
+    size_t newCapacity = (transaction->ValueCapacity == 0) ? transaction->InitialCapacity : (transaction->ValueCapacity * 2);
+    /*Codes_SRS_DATA_PUBLISHER_02_033: [ The values of a transaction and their path index shall be kept in a single allocation that grows geometrically. ]*/
+    DATA_MARSHALLER_VALUE* newValues = (DATA_MARSHALLER_VALUE*)realloc(transaction->Values, newCapacity * (sizeof(DATA_MARSHALLER_VALUE) + 2 * sizeof(DATA_MARSHALLER_VALUE*)));
+    if (newValues == NULL)
+    {
+        LogError("unable to realloc");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        transaction->Values = newValues;
+        transaction->ValueCapacity = newCapacity;
+        transaction->PathIndex = (DATA_MARSHALLER_VALUE**)(newValues + newCapacity);
+        (void)memset(transaction->PathIndex, 0, 2 * newCapacity * sizeof(DATA_MARSHALLER_VALUE*));
+        for (i = 0; i < transaction->ValueCount; i++)
+        {
+            *lookupPropertyPath(transaction->PathIndex, 2 * newCapacity, newValues[i].PropertyPath) = &newValues[i];
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static int growReportedPropertiesPathIndex(REPORTED_PROPERTIES_TRANSACTION_HANDLE_DATA* handleData)
+{
+    int result;
+    size_t newSize = handleData->PathIndexSize * 2;
+    DATA_MARSHALLER_VALUE** newPathIndex = (DATA_MARSHALLER_VALUE**)malloc(newSize * sizeof(DATA_MARSHALLER_VALUE*));
+    if (newPathIndex == NULL)
+    {
+        LogError("unable to malloc");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        (void)memset(newPathIndex, 0, newSize * sizeof(DATA_MARSHALLER_VALUE*));
+        for (i = 0; i < handleData->PathIndexSize; i++)
+        {
+            if (handleData->PathIndex[i] != NULL)
+            {
+                *lookupPropertyPath(newPathIndex, newSize, handleData->PathIndex[i]->PropertyPath) = handleData->PathIndex[i];
+            }
+        }
+        free(handleData->PathIndex);
+        handleData->PathIndex = newPathIndex;
+        handleData->PathIndexSize = newSize;
+        result = 0;
+    }
+    return result;
+}
+
 DATA_PUBLISHER_HANDLE DataPublisher_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
 {
     DATA_PUBLISHER_HANDLE_DATA* result;
@@ -92,6 +181,30 @@ void DataPublisher_Destroy(DATA_PUBLISHER_HANDLE dataPublisherHandle)
     }
 }
 
+DATA_PUBLISHER_RESULT DataPublisher_SetEncoding(DATA_PUBLISHER_HANDLE dataPublisherHandle, DATA_ENCODING encoding)
+{
+    DATA_PUBLISHER_RESULT result;
+    /*Codes_SRS_DATA_PUBLISHER_02_036: [ If dataPublisherHandle is NULL then DataPublisher_SetEncoding shall fail and return DATA_PUBLISHER_INVALID_ARG. ]*/
+    if (dataPublisherHandle == NULL)
+    {
+        result = DATA_PUBLISHER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(DATA_PUBLISHER_RESULT, result));
+    }
+    /*Codes_SRS_DATA_PUBLISHER_02_037: [ DataPublisher_SetEncoding shall call DataMarshaller_SetEncoding passing the encoding. ]*/
+    else if (DataMarshaller_SetEncoding(dataPublisherHandle->DataMarshallerHandle, encoding) != DATA_MARSHALLER_OK)
+    {
+        /*Codes_SRS_DATA_PUBLISHER_02_038: [ If DataMarshaller_SetEncoding fails then DataPublisher_SetEncoding shall fail and return DATA_PUBLISHER_MARSHALLER_ERROR. ]*/
+        result = DATA_PUBLISHER_MARSHALLER_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(DATA_PUBLISHER_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_DATA_PUBLISHER_02_039: [ Otherwise DataPublisher_SetEncoding shall succeed and return DATA_PUBLISHER_OK. ]*/
+        result = DATA_PUBLISHER_OK;
+    }
+    return result;
+}
+
 TRANSACTION_HANDLE DataPublisher_StartTransaction(DATA_PUBLISHER_HANDLE dataPublisherHandle)
 {
     TRANSACTION_HANDLE_DATA* transaction;
@@ -112,8 +225,23 @@ TRANSACTION_HANDLE DataPublisher_StartTransaction(DATA_PUBLISHER_HANDLE dataPubl
         }
         else
         {
+            size_t propertyCount = 0;
+
+            /*Codes_SRS_DATA_PUBLISHER_02_032: [ DataPublisher_StartTransaction shall size the first allocation of the transaction values from the number of properties of the model, as returned by Schema_GetModelPropertyCount. ]*/
+            if (Schema_GetModelPropertyCount(((DATA_PUBLISHER_HANDLE_DATA*)dataPublisherHandle)->ModelHandle, &propertyCount) != SCHEMA_OK)
+            {
+                propertyCount = 0;
+            }
+
+            transaction->InitialCapacity = TRANSACTION_MINIMUM_CAPACITY;
+            while (transaction->InitialCapacity < propertyCount)
+            {
+                transaction->InitialCapacity *= 2;
+            }
+            transaction->ValueCapacity = 0;
             transaction->ValueCount = 0;
             transaction->Values = NULL;
+            transaction->PathIndex = NULL;
             transaction->DataPublisherInstance = (DATA_PUBLISHER_HANDLE_DATA*)dataPublisherHandle;
         }
     }
@@ -126,7 +254,6 @@ TRANSACTION_HANDLE DataPublisher_StartTransaction(DATA_PUBLISHER_HANDLE dataPubl
 DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transactionHandle, const char* propertyPath, const AGENT_DATA_TYPE* data)
 {
     DATA_PUBLISHER_RESULT result;
-    char* propertyPathCopy;
 
     /* Codes_SRS_DATA_PUBLISHER_99_017:[ When one or more NULL parameter(s) are specified, DataPublisher_PublishTransacted is called with a NULL transactionHandle, it shall return DATA_PUBLISHER_INVALID_ARG.] */
     if ((transactionHandle == NULL) ||
@@ -136,12 +263,6 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transac
         result = DATA_PUBLISHER_INVALID_ARG;
         LOG_DATA_PUBLISHER_ERROR;
     }
-    else if (mallocAndStrcpy_s(&propertyPathCopy, propertyPath) != 0)
-    {
-        /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
-        result = DATA_PUBLISHER_ERROR;
-        LOG_DATA_PUBLISHER_ERROR;
-    }
     else
     {
         TRANSACTION_HANDLE_DATA* transaction = (TRANSACTION_HANDLE_DATA*)transactionHandle;
@@ -149,23 +270,18 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transac
 
         if (!Schema_ModelPropertyByPathExists(transaction->DataPublisherInstance->ModelHandle, propertyPath))
         {
-            free(propertyPathCopy);
-
             /* Codes_SRS_DATA_PUBLISHER_99_040:[ When propertyPath does not exist in the supplied model, DataPublisher_Publish shall return DATA_PUBLISHER_SCHEMA_FAILED without dispatching data.] */
             result = DATA_PUBLISHER_SCHEMA_FAILED;
             LOG_DATA_PUBLISHER_ERROR;
         }
         else if ((propertyValue = (AGENT_DATA_TYPE*)malloc(sizeof(AGENT_DATA_TYPE))) == NULL)
         {
-            free(propertyPathCopy);
-
             /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
             result = DATA_PUBLISHER_ERROR;
             LOG_DATA_PUBLISHER_ERROR;
         }
         else if (Create_AGENT_DATA_TYPE_from_AGENT_DATA_TYPE(propertyValue, data) != AGENT_DATA_TYPES_OK)
         {
-            free(propertyPathCopy);
             free(propertyValue);
 
             /* Codes_SRS_DATA_PUBLISHER_99_028:[ If creating the copy fails then DATA_PUBLISHER_AGENT_DATA_TYPES_ERROR shall be returned.] */
@@ -174,60 +290,53 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted(TRANSACTION_HANDLE transac
         }
         else
         {
-            size_t i;
-            DATA_MARSHALLER_VALUE* propertySlot = NULL;
-
-            /* Codes_SRS_DATA_PUBLISHER_99_019:[ If the same property is associated twice with a transaction, then the last value shall be kept associated with the transaction.] */
-            for (i = 0; i < transaction->ValueCount; i++)
-            {
-                if (strcmp(transaction->Values[i].PropertyPath, propertyPath) == 0)
-                {
-                    propertySlot = &transaction->Values[i];
-                    break;
-                }
-            }
-
-            if (propertySlot == NULL)
-            {
-                DATA_MARSHALLER_VALUE* newValues = (DATA_MARSHALLER_VALUE*)realloc(transaction->Values, sizeof(DATA_MARSHALLER_VALUE)* (transaction->ValueCount + 1));
-                if (newValues != NULL)
-                {
-                    transaction->Values = newValues;
-                    propertySlot = &transaction->Values[transaction->ValueCount];
-                    propertySlot->Value = NULL;
-                    propertySlot->PropertyPath = NULL;
-                    transaction->ValueCount++;
-                }
-            }
+            DATA_MARSHALLER_VALUE** indexSlot = (transaction->ValueCapacity == 0) ? NULL : lookupPropertyPath(transaction->PathIndex, 2 * transaction->ValueCapacity, propertyPath);
 
-            if (propertySlot == NULL)
+            if ((indexSlot != NULL) && (*indexSlot != NULL))
             {
-                Destroy_AGENT_DATA_TYPE((AGENT_DATA_TYPE*)propertyValue);
-                free(propertyValue);
-                free(propertyPathCopy);
+                /* Codes_SRS_DATA_PUBLISHER_99_019:[ If the same property is associated twice with a transaction, then the last value shall be kept associated with the transaction.] */
+                /*Codes_SRS_DATA_PUBLISHER_02_034: [ When the property is already in the transaction, DataPublisher_PublishTransacted shall find it through the path index and shall reuse its copy of propertyPath. ]*/
+                Destroy_AGENT_DATA_TYPE((AGENT_DATA_TYPE*)(*indexSlot)->Value);
+                free((AGENT_DATA_TYPE*)(*indexSlot)->Value);
+                (*indexSlot)->Value = propertyValue;
 
-                /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
-                result = DATA_PUBLISHER_ERROR;
-                LOG_DATA_PUBLISHER_ERROR;
+                result = DATA_PUBLISHER_OK;
             }
             else
             {
-                if (propertySlot->Value != NULL)
+                char* propertyPathCopy;
+
+                if ((transaction->ValueCount == transaction->ValueCapacity) &&
+                    (growTransaction(transaction) != 0))
                 {
-                    Destroy_AGENT_DATA_TYPE((AGENT_DATA_TYPE*)propertySlot->Value);
-                    free((AGENT_DATA_TYPE*)propertySlot->Value);
+                    Destroy_AGENT_DATA_TYPE(propertyValue);
+                    free(propertyValue);
+
+                    /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
+                    result = DATA_PUBLISHER_ERROR;
+                    LOG_DATA_PUBLISHER_ERROR;
                 }
-                if (propertySlot->PropertyPath != NULL)
+                else if (mallocAndStrcpy_s(&propertyPathCopy, propertyPath) != 0)
                 {
-                    char* existingValue = (char*)propertySlot->PropertyPath;
-                    free(existingValue);
+                    Destroy_AGENT_DATA_TYPE(propertyValue);
+                    free(propertyValue);
+
+                    /* Codes_SRS_DATA_PUBLISHER_99_020:[ For any errors not explicitly mentioned here the DataPublisher APIs shall return DATA_PUBLISHER_ERROR.] */
+                    result = DATA_PUBLISHER_ERROR;
+                    LOG_DATA_PUBLISHER_ERROR;
                 }
+                else
+                {
+                    DATA_MARSHALLER_VALUE* propertySlot = &transaction->Values[transaction->ValueCount];
 
-                /* Codes_SRS_DATA_PUBLISHER_99_016:[ When DataPublisher_PublishTransacted is invoked, DataPublisher shall associate the data with the transaction identified by the transactionHandle argument and return DATA_PUBLISHER_OK. No data shall be dispatched at the time of the call.] */
-                propertySlot->PropertyPath = propertyPathCopy;
-                propertySlot->Value = propertyValue;
+                    /* Codes_SRS_DATA_PUBLISHER_99_016:[ When DataPublisher_PublishTransacted is invoked, DataPublisher shall associate the data with the transaction identified by the transactionHandle argument and return DATA_PUBLISHER_OK. No data shall be dispatched at the time of the call.] */
+                    propertySlot->PropertyPath = propertyPathCopy;
+                    propertySlot->Value = propertyValue;
+                    *lookupPropertyPath(transaction->PathIndex, 2 * transaction->ValueCapacity, propertyPath) = propertySlot;
+                    transaction->ValueCount++;
 
-                result = DATA_PUBLISHER_OK;
+                    result = DATA_PUBLISHER_OK;
+                }
             }
         }
     }
@@ -358,9 +467,20 @@ REPORTED_PROPERTIES_TRANSACTION_HANDLE DataPublisher_CreateTransaction_ReportedP
                 free(result);
                 result = NULL;
             }
+            else if ((result->PathIndex = (DATA_MARSHALLER_VALUE**)malloc(2 * TRANSACTION_MINIMUM_CAPACITY * sizeof(DATA_MARSHALLER_VALUE*))) == NULL)
+            {
+                /*Codes_SRS_DATA_PUBLISHER_02_029: [ If any error occurs then DataPublisher_CreateTransaction_ReportedProperties shall fail and return NULL. ]*/
+                LogError("unable to malloc");
+                VECTOR_destroy(result->value);
+                free(result);
+                result = NULL;
+            }
             else
             {
                 /*Codes_SRS_DATA_PUBLISHER_02_030: [ Otherwise DataPublisher_CreateTransaction_ReportedProperties shall succeed and return a non-NULL handle. ]*/
+                (void)memset(result->PathIndex, 0, 2 * TRANSACTION_MINIMUM_CAPACITY * sizeof(DATA_MARSHALLER_VALUE*));
+                result->PathIndexSize = 2 * TRANSACTION_MINIMUM_CAPACITY;
+                result->PathIndexCount = 0;
                 result->DataPublisherInstance = dataPublisherHandle;
             }
         }
@@ -369,12 +489,6 @@ REPORTED_PROPERTIES_TRANSACTION_HANDLE DataPublisher_CreateTransaction_ReportedP
     return result;
 }
 
-static bool reportedPropertyExistsByPath(const void* element, const void* value)
-{
-    DATA_MARSHALLER_VALUE* dataMarshallerValue = *(DATA_MARSHALLER_VALUE**)element;
-    return (strcmp(dataMarshallerValue->PropertyPath, (const char*)value) == 0);
-}
-
 DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted_ReportedProperty(REPORTED_PROPERTIES_TRANSACTION_HANDLE transactionHandle, const char* reportedPropertyPath, const AGENT_DATA_TYPE* data)
 {
     DATA_PUBLISHER_RESULT result;
@@ -402,8 +516,9 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted_ReportedProperty(REPORTED_
         }
         else
         {
-            DATA_MARSHALLER_VALUE** existingValue = VECTOR_find_if(handleData->value, reportedPropertyExistsByPath, reportedPropertyPath);
-            if(existingValue != NULL)
+            /*Codes_SRS_DATA_PUBLISHER_02_035: [ DataPublisher_PublishTransacted_ReportedProperty shall find a reported property already in the transaction through the path index of the transaction. ]*/
+            DATA_MARSHALLER_VALUE** existingValue = lookupPropertyPath(handleData->PathIndex, handleData->PathIndexSize, reportedPropertyPath);
+            if (*existingValue != NULL)
             {
                 /*Codes_SRS_DATA_PUBLISHER_02_014: [ If the same (by reportedPropertypath) reported property has already been added to the transaction, then DataPublisher_PublishTransacted_ReportedProperty shall overwrite the previous reported property. ]*/
                 AGENT_DATA_TYPE *clone = (AGENT_DATA_TYPE *)malloc(sizeof(AGENT_DATA_TYPE));
@@ -435,8 +550,15 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted_ReportedProperty(REPORTED_
             else
             {
                 /*totally new reported property*/
-                DATA_MARSHALLER_VALUE* newValue = (DATA_MARSHALLER_VALUE*)malloc(sizeof(DATA_MARSHALLER_VALUE));
-                if (newValue == NULL)
+                DATA_MARSHALLER_VALUE* newValue;
+                if (((handleData->PathIndexCount + 1) * 2 > handleData->PathIndexSize) &&
+                    (growReportedPropertiesPathIndex(handleData) != 0))
+                {
+                    /*Codes_SRS_DATA_PUBLISHER_02_016: [ If any error occurs then DataPublisher_PublishTransacted_ReportedProperty shall fail and return DATA_PUBLISHER_ERROR. ]*/
+                    LogError("unable to grow the path index");
+                    result = DATA_PUBLISHER_ERROR;
+                }
+                else if ((newValue = (DATA_MARSHALLER_VALUE*)malloc(sizeof(DATA_MARSHALLER_VALUE))) == NULL)
                 {
                     /*Codes_SRS_DATA_PUBLISHER_02_016: [ If any error occurs then DataPublisher_PublishTransacted_ReportedProperty shall fail and return DATA_PUBLISHER_ERROR. ]*/
                     LogError("unable to malloc");
@@ -487,6 +609,8 @@ DATA_PUBLISHER_RESULT DataPublisher_PublishTransacted_ReportedProperty(REPORTED_
                                 else
                                 {
                                     /*Codes_SRS_DATA_PUBLISHER_02_017: [ Otherwise DataPublisher_PublishTransacted_ReportedProperty shall succeed and return DATA_PUBLISHER_OK. ]*/
+                                    *lookupPropertyPath(handleData->PathIndex, handleData->PathIndexSize, reportedPropertyPath) = newValue;
+                                    handleData->PathIndexCount++;
                                     result = DATA_PUBLISHER_OK;
                                 }
                             }
@@ -565,6 +689,7 @@ void DataPublisher_DestroyTransaction_ReportedProperties(REPORTED_PROPERTIES_TRA
             free((void*)value);
         }
         VECTOR_destroy(handleData->value);
+        free(handleData->PathIndex);
         free(handleData);
     }
     return;
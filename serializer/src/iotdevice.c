@@ -151,6 +151,30 @@ void Device_Destroy(DEVICE_HANDLE deviceHandle)
     }
 }
 
+DEVICE_RESULT Device_SetEncoding(DEVICE_HANDLE deviceHandle, DATA_ENCODING encoding)
+{
+    DEVICE_RESULT result;
+    /*Codes_SRS_DEVICE_02_041: [ If deviceHandle is NULL then Device_SetEncoding shall fail and return DEVICE_INVALID_ARG. ]*/
+    if (deviceHandle == NULL)
+    {
+        result = DEVICE_INVALID_ARG;
+        LogError("(Error code: %s)", ENUM_TO_STRING(DEVICE_RESULT, result));
+    }
+    /*Codes_SRS_DEVICE_02_042: [ Device_SetEncoding shall call DataPublisher_SetEncoding. ]*/
+    else if (DataPublisher_SetEncoding(((DEVICE_HANDLE_DATA*)deviceHandle)->dataPublisherHandle, encoding) != DATA_PUBLISHER_OK)
+    {
+        /*Codes_SRS_DEVICE_02_043: [ If DataPublisher_SetEncoding fails then Device_SetEncoding shall fail and return DEVICE_DATA_PUBLISHER_FAILED. ]*/
+        result = DEVICE_DATA_PUBLISHER_FAILED;
+        LogError("(Error code: %s)", ENUM_TO_STRING(DEVICE_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_DEVICE_02_044: [ Otherwise Device_SetEncoding shall succeed and return DEVICE_OK. ]*/
+        result = DEVICE_OK;
+    }
+    return result;
+}
+
 TRANSACTION_HANDLE Device_StartTransaction(DEVICE_HANDLE deviceHandle)
 {
     TRANSACTION_HANDLE result;
@@ -281,6 +305,27 @@ EXECUTE_COMMAND_RESULT Device_ExecuteCommand(DEVICE_HANDLE deviceHandle, const c
     return result;
 }
 
+EXECUTE_COMMAND_RESULT Device_ExecuteEncodedCommand(DEVICE_HANDLE deviceHandle, DATA_ENCODING encoding, const unsigned char* command, size_t commandSize)
+{
+    EXECUTE_COMMAND_RESULT result;
+    /*Codes_SRS_DEVICE_02_045: [ If deviceHandle or command is NULL then Device_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    if (
+        (deviceHandle == NULL) ||
+        (command == NULL)
+        )
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("invalid parameter (NULL passed to Device_ExecuteEncodedCommand DEVICE_HANDLE deviceHandle=%p, const unsigned char* command=%p", deviceHandle, command);
+    }
+    else
+    {
+        /*Codes_SRS_DEVICE_02_046: [ Otherwise, Device_ExecuteEncodedCommand shall call CommandDecoder_ExecuteEncodedCommand and return what CommandDecoder_ExecuteEncodedCommand is returning. ]*/
+        DEVICE_HANDLE_DATA* device = (DEVICE_HANDLE_DATA*)deviceHandle;
+        result = CommandDecoder_ExecuteEncodedCommand(device->commandDecoderHandle, encoding, command, commandSize);
+    }
+    return result;
+}
+
 METHODRETURN_HANDLE Device_ExecuteMethod(DEVICE_HANDLE deviceHandle, const char* methodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
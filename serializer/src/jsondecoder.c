@@ -6,15 +6,53 @@
 
 #include "jsondecoder.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*the index of the strings is built with SSE2 or NEON when the target has them, define JSON_DECODER_NO_SIMD to force the scalar classifier*/
+#if !defined(JSON_DECODER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#include <emmintrin.h>
+#define JSON_DECODER_USE_SSE2
+#elif !defined(JSON_DECODER_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define JSON_DECODER_USE_NEON
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #define IsWhiteSpace(A) (((A) == 0x20) || ((A) == 0x09) || ((A) == 0x0A) || ((A) == 0x0D))
+#define NO_INVALID_ESCAPE SIZE_MAX
+#define INDEX_BLOCK_SIZE 64
+#define EVEN_BITS 0x5555555555555555ULL
+
+/*the offsets of the quotes that end the strings of the JSON, in document order*/
+typedef struct STRING_INDEX_TAG
+{
+    uint32_t* positions;
+    size_t count;
+    size_t capacity;
+    size_t current; /*first string end not yet consumed by the tree build*/
+    size_t firstInvalidEscape; /*offset of the first '\\' inside a string that does not start a valid escape sequence*/
+} STRING_INDEX;
+
+/*one bit per character of a 64 characters block*/
+typedef struct BLOCK_MASKS_TAG
+{
+    uint64_t quotes;
+    uint64_t backslashes;
+} BLOCK_MASKS;
 
 typedef struct PARSER_STATE_TAG
 {
     char* json;
+    char* jsonBegin;
+    STRING_INDEX index;
 } PARSER_STATE;
 
 static JSON_DECODER_RESULT ParseArray(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode);
@@ -40,69 +78,308 @@ void SkipWhiteSpaces(PARSER_STATE* parserState)
     }
 }
 
-static JSON_DECODER_RESULT ParseString(PARSER_STATE* parserState, char** stringBegin)
+#if defined(JSON_DECODER_USE_SSE2)
+static void ClassifyBlock(const char* block, BLOCK_MASKS* masks)
 {
-    JSON_DECODER_RESULT result = JSON_DECODER_OK;
-    *stringBegin = parserState->json;
+    size_t i;
+    masks->quotes = 0;
+    masks->backslashes = 0;
+    for (i = 0; i < INDEX_BLOCK_SIZE; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(block + i));
+        masks->quotes |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'))) << i;
+        masks->backslashes |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))) << i;
+    }
+}
+#elif defined(JSON_DECODER_USE_NEON)
+/*NEON has no movemask, each byte of a comparison result is weighted by its bit and the halves are folded with pairwise additions*/
+static uint64_t MoveMask(uint8x16_t comparison)
+{
+    static const uint8_t bitWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t weighted = vandq_u8(comparison, vld1q_u8(bitWeights));
+    uint8x8_t low = vget_low_u8(weighted);
+    uint8x8_t high = vget_high_u8(weighted);
+    low = vpadd_u8(low, low);
+    low = vpadd_u8(low, low);
+    low = vpadd_u8(low, low);
+    high = vpadd_u8(high, high);
+    high = vpadd_u8(high, high);
+    high = vpadd_u8(high, high);
+    return (uint64_t)vget_lane_u8(low, 0) | ((uint64_t)vget_lane_u8(high, 0) << 8);
+}
 
-    /* Codes_SRS_JSON_DECODER_99_028:[ A string begins and ends with quotation marks.] */
-    if (*(parserState->json) != '"')
+static void ClassifyBlock(const char* block, BLOCK_MASKS* masks)
+{
+    size_t i;
+    masks->quotes = 0;
+    masks->backslashes = 0;
+    for (i = 0; i < INDEX_BLOCK_SIZE; i += 16)
     {
-        /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
-        result = JSON_DECODER_PARSE_ERROR;
+        uint8x16_t chunk = vld1q_u8((const uint8_t*)(block + i));
+        masks->quotes |= MoveMask(vceqq_u8(chunk, vdupq_n_u8('"'))) << i;
+        masks->backslashes |= MoveMask(vceqq_u8(chunk, vdupq_n_u8('\\'))) << i;
+    }
+}
+#else
+#define REPEAT_BYTE(A) (0x0101010101010101ULL * (uint8_t)(A))
+#define LOW_7_BITS REPEAT_BYTE(0x7F)
+
+/*the 8 characters of a word are compared at once, the result has 0x80 in each byte that equals the character in all bytes of repeated*/
+static uint64_t BytesEqual(uint64_t word, uint64_t repeated)
+{
+    uint64_t difference = word ^ repeated;
+    return ~(((difference & LOW_7_BITS) + LOW_7_BITS) | difference | LOW_7_BITS);
+}
+
+/*gathers the 0x80 bits of the bytes into the 8 low bits, first character first*/
+static uint64_t ByteMask(uint64_t highBits)
+{
+    return ((highBits >> 7) * 0x0102040810204080ULL) >> 56;
+}
+
+static void ClassifyBlock(const char* block, BLOCK_MASKS* masks)
+{
+    size_t i;
+    masks->quotes = 0;
+    masks->backslashes = 0;
+    for (i = 0; i < INDEX_BLOCK_SIZE; i += 8)
+    {
+        const uint8_t* bytes = (const uint8_t*)(block + i);
+        /*first character in the low byte, whatever the endianness of the target*/
+        uint64_t word =
+            (uint64_t)bytes[0] | ((uint64_t)bytes[1] << 8) | ((uint64_t)bytes[2] << 16) | ((uint64_t)bytes[3] << 24) |
+            ((uint64_t)bytes[4] << 32) | ((uint64_t)bytes[5] << 40) | ((uint64_t)bytes[6] << 48) | ((uint64_t)bytes[7] << 56);
+        masks->quotes |= ByteMask(BytesEqual(word, REPEAT_BYTE('"'))) << i;
+        masks->backslashes |= ByteMask(BytesEqual(word, REPEAT_BYTE('\\'))) << i;
+    }
+}
+#endif
+
+static unsigned int CountTrailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64) || defined(_M_ARM64))
+    unsigned long bitIndex;
+    (void)_BitScanForward64(&bitIndex, value);
+    return (unsigned int)bitIndex;
+#elif defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll(value);
+#else
+    unsigned int result = 0;
+    if ((uint32_t)value == 0)
+    {
+        value >>= 32;
+        result = 32;
+    }
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        result++;
+    }
+    return result;
+#endif
+}
+
+/*bit i of the result is the xor of bits 0..i, a quote mask becomes the mask of the characters from an opening quote up to (not including) the closing quote*/
+static uint64_t PrefixXor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/*returns the mask of the characters that follow an odd length sequence of backslashes, these are escaped*/
+/*endsInOddBackslashes carries the information from one block to the next*/
+static uint64_t FindEscapedCharacters(uint64_t backslashes, uint64_t* endsInOddBackslashes)
+{
+    uint64_t sequenceStarts = backslashes & ~(backslashes << 1);
+    uint64_t evenStartMask = EVEN_BITS ^ *endsInOddBackslashes;
+    uint64_t evenStarts = sequenceStarts & evenStartMask;
+    uint64_t oddStarts = sequenceStarts & ~evenStartMask;
+    /*adding the start of a sequence to the sequence moves a carry to the first character after it*/
+    uint64_t evenCarries = backslashes + evenStarts;
+    uint64_t oddCarries = backslashes + oddStarts;
+    uint64_t oddEnds;
+    uint64_t nextEndsInOddBackslashes = (oddCarries < backslashes) ? 1 : 0;
+
+    oddCarries |= *endsInOddBackslashes;
+    *endsInOddBackslashes = nextEndsInOddBackslashes;
+
+    /*a sequence starting on an even bit and ending on an odd bit (or the other way around) has an odd length*/
+    oddEnds = ((evenCarries & ~backslashes) & ~EVEN_BITS) | ((oddCarries & ~backslashes) & EVEN_BITS);
+    return oddEnds;
+}
+
+/* Codes_SRS_JSON_DECODER_99_030:[ Any character may be escaped.]  */
+/* Codes_SRS_JSON_DECODER_99_033:[ Alternatively, there are two-character sequence escape  representations of some popular characters.  So, for example, a string containing only a single reverse solidus character may be represented more compactly as "\\\\".] */
+static bool IsValidEscapedCharacter(char escaped)
+{
+    return
+        /* Codes_SRS_JSON_DECODER_99_051:[ %x5C /          ; \    reverse solidus U+005C] */
+        (escaped == '\\') ||
+        /* Codes_SRS_JSON_DECODER_99_050:[ %x22 /          ; "    quotation mark  U+0022] */
+        (escaped == '"') ||
+        /* Codes_SRS_JSON_DECODER_99_052:[ %x2F /          ; /    solidus         U+002F] */
+        (escaped == '/') ||
+        /* Codes_SRS_JSON_DECODER_99_053:[ %x62 /          ; b    backspace       U+0008] */
+        (escaped == 'b') ||
+        /* Codes_SRS_JSON_DECODER_99_054:[ %x66 /          ; f    form feed       U+000C] */
+        (escaped == 'f') ||
+        /* Codes_SRS_JSON_DECODER_99_055:[ %x6E /          ; n    line feed       U+000A] */
+        (escaped == 'n') ||
+        /* Codes_SRS_JSON_DECODER_99_056:[ %x72 /          ; r    carriage return U+000D] */
+        (escaped == 'r') ||
+        /* Codes_SRS_JSON_DECODER_99_057:[ %x74 /          ; t    tab             U+0009] */
+        (escaped == 't');
+}
+
+/* Codes_SRS_JSON_DECODER_02_001: [ JSONDecoder_JSON_To_MultiTree shall first record the positions of the quotes that end the strings of the JSON in one pass over the input. ]*/
+static JSON_DECODER_RESULT BuildStringIndex(PARSER_STATE* parserState)
+{
+    JSON_DECODER_RESULT result;
+    STRING_INDEX* index = &parserState->index;
+    const char* json = parserState->jsonBegin;
+    size_t length = strlen(json);
+
+    index->count = 0;
+    index->current = 0;
+    index->firstInvalidEscape = NO_INVALID_ESCAPE;
+    /*a device twin has a string every few characters, start with a guess and grow*/
+    index->capacity = (length / 8) + INDEX_BLOCK_SIZE;
+
+    if (length >= UINT32_MAX)
+    {
+        index->positions = NULL;
+        result = JSON_DECODER_ERROR;
+    }
+    else if ((index->positions = (uint32_t*)malloc(index->capacity * sizeof(uint32_t))) == NULL)
+    {
+        result = JSON_DECODER_ERROR;
     }
     else
     {
-        parserState->json++;
-        while ((*(parserState->json) != '"') && (*(parserState->json) != '\0'))
+        size_t blockStart;
+        uint64_t endsInOddBackslashes = 0;
+        uint64_t endsInString = 0;
+        result = JSON_DECODER_OK;
+
+        for (blockStart = 0; blockStart < length; blockStart += INDEX_BLOCK_SIZE)
         {
-            /* Codes_SRS_JSON_DECODER_99_030:[ Any character may be escaped.]  */
-            /* Codes_SRS_JSON_DECODER_99_033:[ Alternatively, there are two-character sequence escape  representations of some popular characters.  So, for example, a string containing only a single reverse solidus character may be represented more compactly as "\\".] */
-            if (*(parserState->json) == '\\')
+            BLOCK_MASKS masks;
+            uint64_t escaped;
+            uint64_t quotes;
+            uint64_t inString;
+            uint64_t stringEnds;
+
+            if (blockStart + INDEX_BLOCK_SIZE <= length)
             {
-                parserState->json++;
-                if (
-                    /* Codes_SRS_JSON_DECODER_99_051:[ %x5C /          ; \    reverse solidus U+005C] */
-                    (*parserState->json == '\\') ||
-                    /* Codes_SRS_JSON_DECODER_99_050:[ %x22 /          ; "    quotation mark  U+0022] */
-                    (*parserState->json == '"') ||
-                    /* Codes_SRS_JSON_DECODER_99_052:[ %x2F /          ; /    solidus         U+002F] */
-                    (*parserState->json == '/') ||
-                    /* Codes_SRS_JSON_DECODER_99_053:[ %x62 /          ; b    backspace       U+0008] */
-                    (*parserState->json == 'b') ||
-                    /* Codes_SRS_JSON_DECODER_99_054:[ %x66 /          ; f    form feed       U+000C] */
-                    (*parserState->json == 'f') ||
-                    /* Codes_SRS_JSON_DECODER_99_055:[ %x6E /          ; n    line feed       U+000A] */
-                    (*parserState->json == 'n') ||
-                    /* Codes_SRS_JSON_DECODER_99_056:[ %x72 /          ; r    carriage return U+000D] */
-                    (*parserState->json == 'r') ||
-                    /* Codes_SRS_JSON_DECODER_99_057:[ %x74 /          ; t    tab             U+0009] */
-                    (*parserState->json == 't'))
+                ClassifyBlock(json + blockStart, &masks);
+            }
+            else
+            {
+                /*the last block is padded with '\0', which is neither a quote nor a backslash*/
+                char lastBlock[INDEX_BLOCK_SIZE];
+                (void)memset(lastBlock, 0, sizeof(lastBlock));
+                (void)memcpy(lastBlock, json + blockStart, length - blockStart);
+                ClassifyBlock(lastBlock, &masks);
+            }
+
+            escaped = FindEscapedCharacters(masks.backslashes, &endsInOddBackslashes);
+            quotes = masks.quotes & ~escaped;
+            inString = PrefixXor(quotes) ^ endsInString;
+            endsInString = (uint64_t)0 - (inString >> 63);
+
+            /*escape sequences are rare, only those need to be looked at one by one*/
+            escaped &= inString;
+            while ((escaped != 0) && (index->firstInvalidEscape == NO_INVALID_ESCAPE))
+            {
+                size_t escapedPosition = blockStart + CountTrailingZeros(escaped);
+                if (!IsValidEscapedCharacter(json[escapedPosition]))
                 {
-                    parserState->json++;
+                    index->firstInvalidEscape = escapedPosition - 1;
                 }
-                else
+                escaped &= escaped - 1;
+            }
+
+            if (index->count + INDEX_BLOCK_SIZE > index->capacity)
+            {
+                size_t newCapacity = index->capacity * 2;
+                uint32_t* newPositions = (uint32_t*)realloc(index->positions, newCapacity * sizeof(uint32_t));
+                if (newPositions == NULL)
                 {
-                    /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
-                    result = JSON_DECODER_PARSE_ERROR;
+                    result = JSON_DECODER_ERROR;
                     break;
                 }
+                index->positions = newPositions;
+                index->capacity = newCapacity;
             }
-            else
+
+            /*a quote that ends a string is not part of inString*/
+            stringEnds = quotes & ~inString;
+            while (stringEnds != 0)
             {
-                parserState->json++;
+                index->positions[index->count++] = (uint32_t)(blockStart + CountTrailingZeros(stringEnds));
+                stringEnds &= stringEnds - 1;
             }
         }
 
-        if (*(parserState->json) != '"')
+        if (result != JSON_DECODER_OK)
+        {
+            free(index->positions);
+            index->positions = NULL;
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_RESULT ParseString(PARSER_STATE* parserState, char** stringBegin)
+{
+    JSON_DECODER_RESULT result = JSON_DECODER_OK;
+    *stringBegin = parserState->json;
+
+    /* Codes_SRS_JSON_DECODER_99_028:[ A string begins and ends with quotation marks.] */
+    if (*(parserState->json) != '"')
+    {
+        /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+        result = JSON_DECODER_PARSE_ERROR;
+    }
+    else
+    {
+        STRING_INDEX* index = &parserState->index;
+        size_t opening = (size_t)(parserState->json - parserState->jsonBegin);
+
+        /* Codes_SRS_JSON_DECODER_02_002: [ The end of a string shall be found from the index of the strings, without looking at the characters of the string. ]*/
+        while ((index->current < index->count) && (index->positions[index->current] < opening))
+        {
+            index->current++;
+        }
+
+        if (index->current == index->count)
         {
+            /*the string does not end before the end of the JSON*/
             /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
             result = JSON_DECODER_PARSE_ERROR;
         }
         else
         {
-            parserState->json++;
-            result = JSON_DECODER_OK;
+            size_t closing = index->positions[index->current];
+            if ((index->firstInvalidEscape != NO_INVALID_ESCAPE) &&
+                (index->firstInvalidEscape > opening) &&
+                (index->firstInvalidEscape < closing))
+            {
+                /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+                result = JSON_DECODER_PARSE_ERROR;
+            }
+            else
+            {
+                index->current++;
+                parserState->json = parserState->jsonBegin + closing + 1;
+                result = JSON_DECODER_OK;
+            }
         }
     }
 
@@ -229,19 +506,19 @@ static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, MULTITREE_HANDL
     /* Codes_SRS_JSON_DECODER_99_018:[ A JSON value MUST be an object, array, number, or string, or one of the following three literal names: false null true] */
     /* Codes_SRS_JSON_DECODER_99_019:[ The literal names MUST be lowercase.] */
     /* Codes_SRS_JSON_DECODER_99_020:[ No other literal names are allowed.] */
-    else if (strncmp(parserState->json, "false", 5) == 0)
+    else if ((*(parserState->json) == 'f') && (strncmp(parserState->json, "false", 5) == 0))
     {
         *stringBegin = parserState->json;
         parserState->json += 5;
         result = JSON_DECODER_OK;
     }
-    else if (strncmp(parserState->json, "true", 4) == 0)
+    else if ((*(parserState->json) == 't') && (strncmp(parserState->json, "true", 4) == 0))
     {
         *stringBegin = parserState->json;
         parserState->json += 4;
         result = JSON_DECODER_OK;
     }
-    else if (strncmp(parserState->json, "null", 4) == 0)
+    else if ((*(parserState->json) == 'n') && (strncmp(parserState->json, "null", 4) == 0))
     {
         *stringBegin = parserState->json;
         parserState->json += 4;
@@ -566,9 +843,21 @@ static JSON_DECODER_RESULT ParseObjectOrArray(PARSER_STATE* parserState, MULTITR
 static JSON_DECODER_RESULT ParseJSON(char* json, MULTITREE_HANDLE currentNode)
 {
     /* Codes_SRS_JSON_DECODER_99_009:[ On success, JSONDecoder_JSON_To_MultiTree shall return a handle to the multi tree it created in the multiTreeHandle argument and it shall return JSON_DECODER_OK.] */
+    JSON_DECODER_RESULT result;
     PARSER_STATE parseState;
     parseState.json = json;
-    return ParseObjectOrArray(&parseState, currentNode);
+    parseState.jsonBegin = json;
+
+    /* Codes_SRS_JSON_DECODER_02_003: [ If building the index of the strings fails, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_ERROR. ]*/
+    result = BuildStringIndex(&parseState);
+    if (result == JSON_DECODER_OK)
+    {
+        /* Codes_SRS_JSON_DECODER_02_004: [ The multi tree shall then be built from the index of the strings, in document order, using the same MultiTree calls as a character by character parser would. ]*/
+        result = ParseObjectOrArray(&parseState, currentNode);
+        free(parseState.index.positions);
+    }
+
+    return result;
 }
 
 JSON_DECODER_RESULT JSONDecoder_JSON_To_MultiTree(char* json, MULTITREE_HANDLE* multiTreeHandle)
@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <climits>
 #include <cfloat>
+#include <cstring>
 
 #define CTEST_USE_STDINT
 
@@ -4275,7 +4276,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             Destroy_AGENT_DATA_TYPE(&ag);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_SignallingNan_succeeds)
         {
             ///arrange
@@ -4288,7 +4289,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_SignallingNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4301,7 +4302,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_QuietNan_succeeds)
         {
             ///arrange
@@ -4314,7 +4315,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_QuietNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4327,7 +4328,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_minusInf_succeeds)
         {
             ///arrange
@@ -4340,7 +4341,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "-INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_minusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4354,7 +4355,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_plusInf_succeeds)
         {
             ///arrange
@@ -4367,7 +4368,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_plusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4380,7 +4381,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_succeeds_1)
         {
             ///arrange
@@ -4393,7 +4394,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(double, TEST_DOUBLE_1, atof(STRING_c_str(global_bufferTemp)));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_succeeds_2)
         {
             ///arrange
@@ -4502,7 +4503,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             Destroy_AGENT_DATA_TYPE(&ag);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_SignallingNan_succeeds)
         {
             ///arrange
@@ -4515,7 +4516,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_SignallingNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4529,7 +4530,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_QuietNan_succeeds)
         {
             ///arrange
@@ -4542,7 +4543,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_QuietNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4557,7 +4558,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
 
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_minusInf_succeeds)
         {
             ///arrange
@@ -4570,7 +4571,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "-INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_minusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4586,7 +4587,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
 
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_plusInf_succeeds)
         {
             ///arrange
@@ -4599,7 +4600,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_plusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4613,7 +4614,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_succeeds_1)
         {
             ///arrange
@@ -4627,7 +4628,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
 
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits).]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_succeeds_2)
         {
             ///arrange
@@ -4640,8 +4641,273 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(float, TEST_FLOAT_2, (float)atof(STRING_c_str(global_bufferTemp)));
 
         }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_002: [ EDM_SINGLE and EDM_DOUBLE values shall be written with the shortest sequence of decimal digits that reads back as the same value. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_writes_shortest_representation)
+        {
+            ///arrange
+            const double values[] = { 10.5, 0.1, 3.0, -0.0, 1e21, 1e-7, 0.000001234, 5e-324, DBL_MAX };
+            const char* expected[] = { "10.5", "0.1", "3.0", "-0.0", "1e21", "1e-7", "0.000001234", "5e-324", "1.7976931348623157e308" };
+
+            for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                AGENT_DATA_TYPE ag;
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, values[i]);
+                STRING_empty(global_bufferTemp);
+
+                ///act
+                auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, expected[i], STRING_c_str(global_bufferTemp));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_002: [ EDM_SINGLE and EDM_DOUBLE values shall be written with the shortest sequence of decimal digits that reads back as the same value. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_writes_shortest_representation)
+        {
+            ///arrange
+            const float values[] = { TEST_FLOAT_1, TEST_FLOAT_2, 0.1f, 3.0f, FLT_MAX, 1e-45f };
+            const char* expected[] = { "42.5", "42.589123", "0.1", "3.0", "3.4028235e38", "1e-45" };
+
+            for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                AGENT_DATA_TYPE ag;
+                (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, values[i]);
+                STRING_empty(global_bufferTemp);
+
+                ///act
+                auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, expected[i], STRING_c_str(global_bufferTemp));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_002: [ EDM_SINGLE and EDM_DOUBLE values shall be written with the shortest sequence of decimal digits that reads back as the same value. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_DOUBLE_round_trips_through_CreateAgentDataType_From_String)
+        {
+            ///arrange
+            uint64_t state = 0x2545F4914F6CDD1DULL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                AGENT_DATA_TYPE readBack;
+                char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+                size_t length;
+                uint64_t bits;
+                double value;
+
+                /*xorshift64, any bit pattern is a candidate*/
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                bits = state;
+                (void)memcpy(&value, &bits, sizeof(value));
+                if ((value != value) || (value - value != 0.0)) /*NaN and INF are covered by the tests above*/
+                {
+                    continue;
+                }
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, value);
+
+                ///act
+                auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &ag, &length);
+                auto resReadBack = CreateAgentDataType_From_String(buffer, EDM_DOUBLE_TYPE, &readBack);
+
+                ///assert
+                if ((res != AGENT_DATA_TYPES_OK) || (resReadBack != AGENT_DATA_TYPES_OK) || (memcmp(&readBack.value.edmDouble.value, &value, sizeof(value)) != 0))
+                {
+                    ASSERT_FAIL(buffer);
+                }
+                ASSERT_ARE_EQUAL(size_t, strlen(buffer), length);
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&readBack);
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_002: [ EDM_SINGLE and EDM_DOUBLE values shall be written with the shortest sequence of decimal digits that reads back as the same value. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_FLOAT_round_trips_through_CreateAgentDataType_From_String)
+        {
+            ///arrange
+            uint32_t state = 0x9E3779B9UL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                AGENT_DATA_TYPE readBack;
+                char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+                size_t length;
+                float value;
+
+                /*xorshift32*/
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                (void)memcpy(&value, &state, sizeof(value));
+                if ((value != value) || (value - value != 0.0f))
+                {
+                    continue;
+                }
+                (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, value);
+
+                ///act
+                auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &ag, &length);
+                auto resReadBack = CreateAgentDataType_From_String(buffer, EDM_SINGLE_TYPE, &readBack);
+
+                ///assert
+                if ((res != AGENT_DATA_TYPES_OK) || (resReadBack != AGENT_DATA_TYPES_OK) || (memcmp(&readBack.value.edmSingle.value, &value, sizeof(value)) != 0))
+                {
+                    ASSERT_FAIL(buffer);
+                }
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&readBack);
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
 #endif
 
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_003: [ If destination, value or length is NULL then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_with_NULL_destination_fails)
+        {
+            ///arrange
+            size_t length;
+
+            ///act
+            auto res = AgentDataTypes_ToCharBuffer(NULL, 10, &agDouble1, &length);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_003: [ If destination, value or length is NULL then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_with_NULL_value_fails)
+        {
+            ///arrange
+            char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+            size_t length;
+
+            ///act
+            auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), NULL, &length);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_003: [ If destination, value or length is NULL then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_with_NULL_length_fails)
+        {
+            ///arrange
+            char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+
+            ///act
+            auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &agDouble1, NULL);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_004: [ If value is not of a fixed length type (EDM_NULL, EDM_BOOLEAN, EDM_BYTE, EDM_SBYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DATE, EDM_DATE_TIME_OFFSET, EDM_GUID, EDM_SINGLE, EDM_DOUBLE) then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_NOT_IMPLEMENTED. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_with_string_returns_NOT_IMPLEMENTED)
+        {
+            ///arrange
+            char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+            size_t length;
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_charz(&ag, "a string");
+
+            ///act
+            auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &ag, &length);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_NOT_IMPLEMENTED, res);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_006: [ If destinationSize is not enough to hold the characters and the '\0' terminator then AgentDataTypes_ToCharBuffer shall fail and return AGENT_DATA_TYPES_ERROR. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_with_too_small_buffer_fails)
+        {
+            ///arrange
+            char buffer[4];
+            size_t length;
+
+            ///act
+            auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &agDouble1, &length); /*"10.5" needs 5 bytes*/
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_005: [ AgentDataTypes_ToCharBuffer shall produce the same characters as AgentDataTypes_ToString would append. ]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_007: [ Otherwise AgentDataTypes_ToCharBuffer shall copy the '\0' terminated characters to destination, set length to the number of characters (not counting '\0') and return AGENT_DATA_TYPES_OK. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_with_exact_size_buffer_succeeds)
+        {
+            ///arrange
+            char buffer[12];
+            size_t length;
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_SINT32(&ag, INT32_MIN);
+
+            ///act
+            auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &ag, &length);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "-2147483648", buffer);
+            ASSERT_ARE_EQUAL(size_t, 11, length);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_005: [ AgentDataTypes_ToCharBuffer shall produce the same characters as AgentDataTypes_ToString would append. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToCharBuffer_EDM_DATE_TIME_OFFSET_succeeds)
+        {
+            for (size_t i = 0; i < sizeof(global_testVector) / sizeof(global_testVector[0]); i++)
+            {
+                ///arrange
+                char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+                size_t length;
+                AGENT_DATA_TYPE agentData;
+                EDM_DATE_TIME_OFFSET temp;
+                temp.dateTime.tm_year = global_testVector[i].year - 1900;
+                temp.dateTime.tm_mon = global_testVector[i].month - 1;
+                temp.dateTime.tm_mday = global_testVector[i].day;
+                temp.dateTime.tm_hour = global_testVector[i].hour;
+                temp.dateTime.tm_min = global_testVector[i].min;
+                temp.dateTime.tm_sec = global_testVector[i].sec;
+                temp.hasFractionalSecond = global_testVector[i].hasFractionalSecond;
+                temp.fractionalSecond = global_testVector[i].fractionalSecond;
+                temp.hasTimeZone = global_testVector[i].hasTimeZone;
+                temp.timeZoneHour = global_testVector[i].timeZoneHour;
+                temp.timeZoneMinute = global_testVector[i].timeZoneMin;
+                (void)Create_AGENT_DATA_TYPE_from_EDM_DATE_TIME_OFFSET(&agentData, temp);
+
+                ///act
+                auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &agentData, &length);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, global_testVector[i].expectedOutput, buffer);
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&agentData);
+            }
+        }
+
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_043:[ Creates an AGENT_DATA_TYPE containing an EDM_INT16 from int16_t]*/
         TEST_FUNCTION(Create_AGENT_DATA_TYPE_from_SINT16_succeeds)
         {
@@ -13023,6 +13289,505 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             }
         }
 
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_010: [ EDM_DOUBLE and EDM_SINGLE shall be read from optional whitespace, an optional sign, decimal digits with an optional '.' and an optional exponent, and shall be rounded to the nearest representable value (ties to even). ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_DOUBLE_matches_strtod_on_random_decimal_strings)
+        {
+            ///arrange
+            uint64_t state = 0x853C49E6748FEA9BULL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                char source[128];
+                size_t pos = 0;
+                size_t nDigits;
+                double expected;
+
+                /*xorshift64 drives a random walk through the accepted grammar*/
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                if (state & 1)
+                {
+                    source[pos++] = '-';
+                }
+                for (nDigits = (size_t)((state >> 1) % 24); nDigits > 0; nDigits--)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    source[pos++] = (char)('0' + state % 10);
+                }
+                if ((pos == 0) || (source[pos - 1] == '-') || (state & 0x100))
+                {
+                    source[pos++] = '.';
+                    for (nDigits = 1 + (size_t)((state >> 9) % 24); nDigits > 0; nDigits--)
+                    {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        source[pos++] = (char)('0' + state % 10);
+                    }
+                }
+                if (state & 0x200)
+                {
+                    pos += sprintf(source + pos, "e%d", (int)((state >> 10) % 700) - 350);
+                }
+                source[pos] = '\0';
+                expected = strtod(source, NULL);
+                if (expected - expected != 0.0) /*overflows are covered by CreateAgentDataType_From_String_DOUBLE_out_of_range_fails*/
+                {
+                    continue;
+                }
+
+                ///act
+                auto result = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &ag);
+
+                ///assert
+                if ((result != AGENT_DATA_TYPES_OK) || (memcmp(&ag.value.edmDouble.value, &expected, sizeof(expected)) != 0))
+                {
+                    ASSERT_FAIL(source);
+                }
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_010: [ EDM_DOUBLE and EDM_SINGLE shall be read from optional whitespace, an optional sign, decimal digits with an optional '.' and an optional exponent, and shall be rounded to the nearest representable value (ties to even). ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_SINGLE_matches_strtof_on_random_decimal_strings)
+        {
+            ///arrange
+            uint64_t state = 0xDA3E39CB94B95BDBULL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                char source[64];
+                size_t pos = 0;
+                size_t nDigits;
+                float expected;
+
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                if (state & 1)
+                {
+                    source[pos++] = '-';
+                }
+                for (nDigits = 1 + (size_t)((state >> 1) % 12); nDigits > 0; nDigits--)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    source[pos++] = (char)('0' + state % 10);
+                }
+                if (state & 0x100)
+                {
+                    source[pos++] = '.';
+                    for (nDigits = (size_t)((state >> 9) % 12); nDigits > 0; nDigits--)
+                    {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        source[pos++] = (char)('0' + state % 10);
+                    }
+                }
+                if (state & 0x200)
+                {
+                    pos += sprintf(source + pos, "E%d", (int)((state >> 10) % 100) - 55);
+                }
+                source[pos] = '\0';
+                expected = strtof(source, NULL);
+                if (expected - expected != 0.0f)
+                {
+                    continue;
+                }
+
+                ///act
+                auto result = CreateAgentDataType_From_String(source, EDM_SINGLE_TYPE, &ag);
+
+                ///assert
+                if ((result != AGENT_DATA_TYPES_OK) || (memcmp(&ag.value.edmSingle.value, &expected, sizeof(expected)) != 0))
+                {
+                    ASSERT_FAIL(source);
+                }
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_010: [ EDM_DOUBLE and EDM_SINGLE shall be read from optional whitespace, an optional sign, decimal digits with an optional '.' and an optional exponent, and shall be rounded to the nearest representable value (ties to even). ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_DOUBLE_rounds_halfway_cases_using_all_digits)
+        {
+            ///arrange
+            /*9007199254740993 is exactly halfway between 2^53 and 2^53+2*/
+            char source[1024];
+            AGENT_DATA_TYPE tieToEven;
+            AGENT_DATA_TYPE aboveTie;
+            (void)strcpy(source, "9007199254740993.");
+            (void)memset(source + 17, '0', 900);
+            source[917] = '\0';
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &tieToEven);
+            source[916] = '1';
+            auto result2 = CreateAgentDataType_From_String(source, EDM_DOUBLE_TYPE, &aboveTie);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result2);
+            ASSERT_IS_TRUE(tieToEven.value.edmDouble.value == 9007199254740992.0);
+            ASSERT_IS_TRUE(aboveTie.value.edmDouble.value == 9007199254740994.0);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&tieToEven);
+            Destroy_AGENT_DATA_TYPE(&aboveTie);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_011: [ EDM_DOUBLE and EDM_SINGLE values that overflow the type shall be rejected. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_DOUBLE_out_of_range_fails)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("1e309", EDM_DOUBLE_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("-1e309", EDM_DOUBLE_TYPE, &ag);
+            auto result3 = CreateAgentDataType_From_String("3.5e38", EDM_SINGLE_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result3);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_013: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DOUBLE and EDM_SINGLE shall be rejected if anything other than whitespace follows the number. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_DOUBLE_hexadecimal_fails)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("0x10", EDM_DOUBLE_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("-0x1p3", EDM_DOUBLE_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_013: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DOUBLE and EDM_SINGLE shall be rejected if anything other than whitespace follows the number. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_SINGLE_hexadecimal_fails)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("0x10", EDM_SINGLE_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("-0x1p3", EDM_SINGLE_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_013: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DOUBLE and EDM_SINGLE shall be rejected if anything other than whitespace follows the number. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_DOUBLE_trailing_characters_fail)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("1e", EDM_DOUBLE_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("2.5abc", EDM_DOUBLE_TYPE, &ag);
+            auto result3 = CreateAgentDataType_From_String("2.5 ", EDM_DOUBLE_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result3);
+            ASSERT_IS_TRUE(ag.value.edmDouble.value == 2.5);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_013: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DOUBLE and EDM_SINGLE shall be rejected if anything other than whitespace follows the number. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_integers_trailing_characters_fail)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("12abc", EDM_INT32_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("0x10", EDM_INT64_TYPE, &ag);
+            auto result3 = CreateAgentDataType_From_String("-5.0", EDM_SBYTE_TYPE, &ag);
+            auto result4 = CreateAgentDataType_From_String("7 8", EDM_INT16_TYPE, &ag);
+            auto result5 = CreateAgentDataType_From_String(" 200 ", EDM_BYTE_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result3);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result4);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result5);
+            ASSERT_ARE_EQUAL(uint8_t, (uint8_t)200, ag.value.edmByte.value);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_013: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32, EDM_INT64, EDM_DOUBLE and EDM_SINGLE shall be rejected if anything other than whitespace follows the number. ]*/
+        /*the C library functions used before 02_013 read the number in front of the junk, this is the difference the test pins down*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_numbers_with_random_trailing_characters_fail_where_the_C_library_succeeds)
+        {
+            ///arrange
+            static const char junk[] = "abcdfpP_#%/;,:\"'+-";
+            static const AGENT_DATA_TYPE_TYPE types[] = { EDM_INT64_TYPE, EDM_INT32_TYPE, EDM_DOUBLE_TYPE, EDM_SINGLE_TYPE };
+            uint64_t state = 0xD1B54A32D192ED03ULL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                AGENT_DATA_TYPE_TYPE type;
+                char source[64];
+                char* end;
+                int length;
+
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                type = types[state % (sizeof(types) / sizeof(types[0]))];
+                if ((type == EDM_INT64_TYPE) || (type == EDM_INT32_TYPE))
+                {
+                    length = sprintf(source, "%d", (int)(int32_t)(state >> 16));
+                }
+                else
+                {
+                    length = sprintf(source, "%.6g", (double)(int32_t)(state >> 16) / (double)((state >> 48) | 1));
+                }
+                source[length] = junk[(state >> 8) % (sizeof(junk) - 1)];
+                source[length + 1] = junk[(state >> 12) % (sizeof(junk) - 1)];
+                source[length + 2] = '\0';
+
+                if ((type == EDM_INT64_TYPE) || (type == EDM_INT32_TYPE))
+                {
+                    (void)strtoll(source, &end, 10);
+                }
+                else
+                {
+                    (void)strtod(source, &end);
+                }
+
+                ///act
+                auto result = CreateAgentDataType_From_String(source, type, &ag);
+
+                ///assert
+                ASSERT_IS_TRUE(end > source);
+                ASSERT_IS_TRUE(*end != '\0');
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_014: [ EDM_DOUBLE and EDM_SINGLE shall accept NaN, INF and -INF both as written by AgentDataTypes_ToString and enclosed in quotes. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_DOUBLE_NaN_and_INF_round_trip_through_AgentDataTypes_ToCharBuffer)
+        {
+            ///arrange
+            double values[3];
+            values[0] = numeric_limits<double>::quiet_NaN();
+            values[1] = numeric_limits<double>::infinity();
+            values[2] = -numeric_limits<double>::infinity();
+
+            for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                AGENT_DATA_TYPE ag;
+                AGENT_DATA_TYPE readBack;
+                char buffer[AGENT_DATA_TYPES_SCALAR_BUFFER_SIZE];
+                size_t length;
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, values[i]);
+
+                ///act
+                auto res = AgentDataTypes_ToCharBuffer(buffer, sizeof(buffer), &ag, &length);
+                auto resReadBack = CreateAgentDataType_From_String(buffer, EDM_DOUBLE_TYPE, &readBack);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, resReadBack);
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPE_TYPE, EDM_DOUBLE_TYPE, readBack.type);
+                ASSERT_ARE_EQUAL(int, ISNAN(values[i]) ? 1 : 0, ISNAN(readBack.value.edmDouble.value) ? 1 : 0);
+                ASSERT_ARE_EQUAL(int, ISPOSITIVEINFINITY(values[i]) ? 1 : 0, ISPOSITIVEINFINITY(readBack.value.edmDouble.value) ? 1 : 0);
+                ASSERT_ARE_EQUAL(int, ISNEGATIVEINFINITY(values[i]) ? 1 : 0, ISNEGATIVEINFINITY(readBack.value.edmDouble.value) ? 1 : 0);
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&readBack);
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_014: [ EDM_DOUBLE and EDM_SINGLE shall accept NaN, INF and -INF both as written by AgentDataTypes_ToString and enclosed in quotes. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_SINGLE_bare_NaN_and_INF_succeed)
+        {
+            ///arrange
+            AGENT_DATA_TYPE nanValue;
+            AGENT_DATA_TYPE inf;
+            AGENT_DATA_TYPE minusInf;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("NaN", EDM_SINGLE_TYPE, &nanValue);
+            auto result2 = CreateAgentDataType_From_String("INF", EDM_SINGLE_TYPE, &inf);
+            auto result3 = CreateAgentDataType_From_String("-INF", EDM_SINGLE_TYPE, &minusInf);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result2);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result3);
+            ASSERT_IS_TRUE(ISNAN(nanValue.value.edmSingle.value) != 0);
+            ASSERT_IS_TRUE(ISPOSITIVEINFINITY(inf.value.edmSingle.value) != 0);
+            ASSERT_IS_TRUE(ISNEGATIVEINFINITY(minusInf.value.edmSingle.value) != 0);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&nanValue);
+            Destroy_AGENT_DATA_TYPE(&inf);
+            Destroy_AGENT_DATA_TYPE(&minusInf);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_009: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32 and EDM_INT64 shall be read from optional whitespace, an optional sign and decimal digits; values outside of the range of the type shall be rejected. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_INT64_matches_strtoll_on_random_decimal_strings)
+        {
+            ///arrange
+            uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                char source[32];
+                long long expected;
+
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                expected = (long long)(state >> (state % 64));
+                if (state & 0x40)
+                {
+                    expected = -expected - ((state & 0x80) ? 1 : 0);
+                }
+                (void)sprintf(source, "%lld", expected);
+
+                ///act
+                auto result = CreateAgentDataType_From_String(source, EDM_INT64_TYPE, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+                ASSERT_IS_TRUE(ag.value.edmInt64.value == strtoll(source, NULL, 10));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_009: [ EDM_SBYTE, EDM_BYTE, EDM_INT16, EDM_INT32 and EDM_INT64 shall be read from optional whitespace, an optional sign and decimal digits; values outside of the range of the type shall be rejected. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_INT32_out_of_range_fails)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("4294967296", EDM_INT32_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("-2147483649", EDM_INT32_TYPE, &ag);
+            auto result3 = CreateAgentDataType_From_String("4294967296", EDM_BYTE_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result3);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_012: [ EDM_DATE_TIME_OFFSET shall be read from "[-]YYYY-MM-DDThh:mm[:ss][.fraction](Z|+hh:mm|-hh:mm|hhh:mm)" and nothing else shall follow between the time zone and the closing quote. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_EDM_DATE_TIME_OFFSET_random_fields_round_trip)
+        {
+            ///arrange
+            uint64_t state = 0x2545F4914F6CDD1DULL;
+
+            for (size_t i = 0; i < 100000; i++)
+            {
+                AGENT_DATA_TYPE ag;
+                char source[64];
+                int year, month, day, hour, min, sec, hourOffset, minOffset;
+                unsigned long long fractionalSecond;
+                size_t pos;
+
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                year = (int)(state % 9999) + 1;
+                month = (int)((state >> 14) % 12) + 1;
+                day = (int)((state >> 18) % 28) + 1;
+                hour = (int)((state >> 23) % 24);
+                min = (int)((state >> 28) % 60);
+                sec = (int)((state >> 34) % 60);
+                fractionalSecond = (state >> 40) % 1000000;
+                hourOffset = (int)((state >> 60) % 12) * (((state >> 59) & 1) ? -1 : 1);
+                minOffset = (int)((state >> 50) % 60);
+
+                pos = sprintf(source, "\"%04d-%02d-%02dT%02d:%02d", year, month, day, hour, min);
+                if (state & 1)
+                {
+                    pos += sprintf(source + pos, ":%02d", sec);
+                }
+                if (state & 2)
+                {
+                    pos += sprintf(source + pos, ".%llu", fractionalSecond);
+                }
+                if (state & 4)
+                {
+                    pos += sprintf(source + pos, "Z\"");
+                }
+                else
+                {
+                    pos += sprintf(source + pos, "%c%02d:%02d\"", (hourOffset < 0) ? '-' : '+', abs(hourOffset), minOffset);
+                }
+
+                ///act
+                auto result = CreateAgentDataType_From_String(source, EDM_DATE_TIME_OFFSET_TYPE, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+                ASSERT_ARE_EQUAL(int, year - 1900, ag.value.edmDateTimeOffset.dateTime.tm_year);
+                ASSERT_ARE_EQUAL(int, month - 1, ag.value.edmDateTimeOffset.dateTime.tm_mon);
+                ASSERT_ARE_EQUAL(int, day, ag.value.edmDateTimeOffset.dateTime.tm_mday);
+                ASSERT_ARE_EQUAL(int, hour, ag.value.edmDateTimeOffset.dateTime.tm_hour);
+                ASSERT_ARE_EQUAL(int, min, ag.value.edmDateTimeOffset.dateTime.tm_min);
+                ASSERT_ARE_EQUAL(int, (state & 1) ? sec : 0, ag.value.edmDateTimeOffset.dateTime.tm_sec);
+                ASSERT_ARE_EQUAL(uint8_t, (uint8_t)((state & 2) ? 1 : 0), ag.value.edmDateTimeOffset.hasFractionalSecond);
+                ASSERT_ARE_EQUAL(uint64_t, (uint64_t)((state & 2) ? fractionalSecond : 0), ag.value.edmDateTimeOffset.fractionalSecond);
+                ASSERT_ARE_EQUAL(uint8_t, (uint8_t)((state & 4) ? 0 : 1), ag.value.edmDateTimeOffset.hasTimeZone);
+                ASSERT_ARE_EQUAL(int8_t, (int8_t)((state & 4) ? 0 : hourOffset), ag.value.edmDateTimeOffset.timeZoneHour);
+                ASSERT_ARE_EQUAL(uint8_t, (uint8_t)((state & 4) ? 0 : minOffset), ag.value.edmDateTimeOffset.timeZoneMinute);
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_02_012: [ EDM_DATE_TIME_OFFSET shall be read from "[-]YYYY-MM-DDThh:mm[:ss][.fraction](Z|+hh:mm|-hh:mm|hhh:mm)" and nothing else shall follow between the time zone and the closing quote. ]*/
+        TEST_FUNCTION(CreateAgentDataType_From_String_EDM_DATE_TIME_OFFSET_with_characters_after_time_zone_fails)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+
+            ///act
+            auto result1 = CreateAgentDataType_From_String("\"2014-01-02T03:04:05Z0\"", EDM_DATE_TIME_OFFSET_TYPE, &ag);
+            auto result2 = CreateAgentDataType_From_String("\"2014-01-02T03:04:05+01:000\"", EDM_DATE_TIME_OFFSET_TYPE, &ag);
+            auto result3 = CreateAgentDataType_From_String("\"2014-01-02T03:04:05+01:00 \"", EDM_DATE_TIME_OFFSET_TYPE, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result2);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, result3);
+        }
+
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_013:[ All the functions shall check their parameters for validity. When an invalid parameter is detected, the value AGENT_DATA_TYPES_INVALID_ARG shall be returned ].*/
         TEST_FUNCTION(Create_AGENT_DATA_TYPE_from_EDM_GUID_with_NULL_agent_data_type_fails)
         {
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "binarydecoder.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/*{"a":1, "b":{"c":-2}, "d":[true, null]} in both encodings*/
+static const unsigned char CBOR_DOCUMENT[] = { 0xA3, 0x61, 'a', 0x01, 0x61, 'b', 0xA1, 0x61, 'c', 0x21, 0x61, 'd', 0x82, 0xF5, 0xF6 };
+static const unsigned char MSGPACK_DOCUMENT[] = { 0x83, 0xA1, 'a', 0x01, 0xA1, 'b', 0x81, 0xA1, 'c', 0xFE, 0xA1, 'd', 0x92, 0xC3, 0xC0 };
+
+static void assertLeaf(MULTITREE_HANDLE tree, const char* path, const char* expectedJson)
+{
+    const void* value;
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetLeafValue(tree, path, &value));
+    ASSERT_ARE_EQUAL(char_ptr, expectedJson, (const char*)value);
+}
+
+static void assertDocument(DATA_ENCODING encoding, const unsigned char* source, size_t sourceSize)
+{
+    MULTITREE_HANDLE tree;
+
+    BINARY_DECODER_RESULT result = BinaryDecoder_To_MultiTree(encoding, source, sourceSize, &tree);
+
+    ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_OK, (int)result);
+    assertLeaf(tree, "a", "1");
+    assertLeaf(tree, "b/c", "-2");
+    assertLeaf(tree, "d/0", "true");
+    assertLeaf(tree, "d/1", "null");
+
+    MultiTree_Destroy(tree);
+}
+
+static void assertParseError(DATA_ENCODING encoding, const unsigned char* source, size_t sourceSize)
+{
+    MULTITREE_HANDLE tree = NULL;
+
+    BINARY_DECODER_RESULT result = BinaryDecoder_To_MultiTree(encoding, source, sourceSize, &tree);
+
+    ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_PARSE_ERROR, (int)result);
+    ASSERT_IS_NULL(tree);
+}
+
+BEGIN_TEST_SUITE(binarydecoder_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /*Tests_SRS_BINARY_DECODER_02_001: [ If source or multiTreeHandle is NULL, or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK, then BinaryDecoder_To_MultiTree shall fail and return BINARY_DECODER_INVALID_ARG. ]*/
+    TEST_FUNCTION(BinaryDecoder_To_MultiTree_with_invalid_arguments_fails)
+    {
+        ///arrange
+        MULTITREE_HANDLE tree;
+
+        ///act
+        BINARY_DECODER_RESULT nullSource = BinaryDecoder_To_MultiTree(DATA_ENCODING_CBOR, NULL, 1, &tree);
+        BINARY_DECODER_RESULT nullTree = BinaryDecoder_To_MultiTree(DATA_ENCODING_CBOR, CBOR_DOCUMENT, sizeof(CBOR_DOCUMENT), NULL);
+        BINARY_DECODER_RESULT json = BinaryDecoder_To_MultiTree(DATA_ENCODING_JSON, CBOR_DOCUMENT, sizeof(CBOR_DOCUMENT), &tree);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_INVALID_ARG, (int)nullSource);
+        ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_INVALID_ARG, (int)nullTree);
+        ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_INVALID_ARG, (int)json);
+    }
+
+    /*Tests_SRS_BINARY_DECODER_02_002: [ BinaryDecoder_To_MultiTree shall create a multi tree whose leaves own a copy of their JSON text. ]*/
+    /*Tests_SRS_BINARY_DECODER_02_003: [ Every (name, value) pair of a map shall become a child of the current node having that name, exactly as JSONDecoder_JSON_To_MultiTree adds a child for every member of an object. ]*/
+    /*Tests_SRS_BINARY_DECODER_02_004: [ For array elements the multi tree node name shall be the string representation of the array index. ]*/
+    TEST_FUNCTION(BinaryDecoder_To_MultiTree_CBOR_builds_the_same_tree_as_JSON)
+    {
+        assertDocument(DATA_ENCODING_CBOR, CBOR_DOCUMENT, sizeof(CBOR_DOCUMENT));
+    }
+
+    /*Tests_SRS_BINARY_DECODER_02_003: [ Every (name, value) pair of a map shall become a child of the current node having that name, exactly as JSONDecoder_JSON_To_MultiTree adds a child for every member of an object. ]*/
+    /*Tests_SRS_BINARY_DECODER_02_004: [ For array elements the multi tree node name shall be the string representation of the array index. ]*/
+    TEST_FUNCTION(BinaryDecoder_To_MultiTree_MSGPACK_builds_the_same_tree_as_JSON)
+    {
+        assertDocument(DATA_ENCODING_MSGPACK, MSGPACK_DOCUMENT, sizeof(MSGPACK_DOCUMENT));
+    }
+
+    /*Tests_SRS_BINARY_DECODER_02_005: [ Floating point numbers shall be written in the leaf as the text AgentDataTypes_ToCharBuffer produces for an EDM_SINGLE or EDM_DOUBLE having the same value. ]*/
+    /*Tests_SRS_BINARY_DECODER_02_006: [ Text strings shall be written in the leaf as quoted JSON strings, byte strings as the text AgentDataTypes_ToString produces for an EDM_BINARY and integers, booleans and null as their JSON literals. ]*/
+    TEST_FUNCTION(BinaryDecoder_To_MultiTree_writes_strings_bytes_and_floats_as_JSON_text)
+    {
+        ///arrange
+        const unsigned char source[] =
+        {
+            0xA4,
+            0x61, 's', 0x62, 'q', '"',
+            0x61, 'b', 0x42, 0x01, 0x02,
+            0x61, 'f', 0xFA, 0x3F, 0xC0, 0x00, 0x00,
+            0x61, 'd', 0xFB, 0x3F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        };
+        MULTITREE_HANDLE tree;
+
+        ///act
+        BINARY_DECODER_RESULT result = BinaryDecoder_To_MultiTree(DATA_ENCODING_CBOR, source, sizeof(source), &tree);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_OK, (int)result);
+        assertLeaf(tree, "s", "\"q\\\"\"");
+        assertLeaf(tree, "b", "\"AQI=\"");
+        assertLeaf(tree, "f", "1.5");
+        assertLeaf(tree, "d", "1.5");
+
+        ///cleanup
+        MultiTree_Destroy(tree);
+    }
+
+    /*Tests_SRS_BINARY_DECODER_02_007: [ Indefinite length items, reserved values, extension types and map keys that are not text strings shall be rejected with BINARY_DECODER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(BinaryDecoder_To_MultiTree_rejects_what_JSON_cannot_represent)
+    {
+        ///arrange
+        const unsigned char indefiniteMap[] = { 0xBF, 0xFF };
+        const unsigned char extension[] = { 0x81, 0xD4, 0x01, 0x00 };
+        const unsigned char integerKey[] = { 0xA1, 0x01, 0x02 };
+
+        ///act + assert
+        assertParseError(DATA_ENCODING_CBOR, indefiniteMap, sizeof(indefiniteMap));
+        assertParseError(DATA_ENCODING_MSGPACK, extension, sizeof(extension));
+        assertParseError(DATA_ENCODING_CBOR, integerKey, sizeof(integerKey));
+    }
+
+    /*Tests_SRS_BINARY_DECODER_02_009: [ The encoded document shall be a single map or array, otherwise BinaryDecoder_To_MultiTree shall return BINARY_DECODER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(BinaryDecoder_To_MultiTree_rejects_anything_but_a_single_map_or_array)
+    {
+        ///arrange
+        const unsigned char scalar[] = { 0x01 };
+        const unsigned char trailingBytes[] = { 0xA0, 0x00 };
+        const unsigned char truncated[] = { 0xA1, 0x61 };
+
+        ///act + assert
+        assertParseError(DATA_ENCODING_CBOR, scalar, sizeof(scalar));
+        assertParseError(DATA_ENCODING_CBOR, trailingBytes, sizeof(trailingBytes));
+        assertParseError(DATA_ENCODING_CBOR, truncated, sizeof(truncated));
+    }
+
+END_TEST_SUITE(binarydecoder_ut)
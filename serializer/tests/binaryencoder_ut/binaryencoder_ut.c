@@ -0,0 +1,512 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* s)
+{
+    free(s);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/strings.h"
+#include "agenttypesystem.h"
+#undef ENABLE_MOCKS
+
+#include "binaryencoder.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+#define TEST_STRING_HANDLE ((STRING_HANDLE)0x4242)
+
+/*everything the encoder writes ends up here*/
+static unsigned char g_written[256];
+static size_t g_writtenSize;
+static size_t g_writesUntilFailure;
+
+static int captureWrite(void* context, const unsigned char* bytes, size_t size)
+{
+    int result;
+    (void)context;
+    if (g_writesUntilFailure == 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        g_writesUntilFailure--;
+        ASSERT_IS_TRUE(g_writtenSize + size <= sizeof(g_written));
+        (void)memcpy(g_written + g_writtenSize, bytes, size);
+        g_writtenSize += size;
+        result = 0;
+    }
+    return result;
+}
+
+static void assertWritten(const unsigned char* expected, size_t expectedSize)
+{
+    ASSERT_ARE_EQUAL(size_t, expectedSize, g_writtenSize);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, g_written, expectedSize));
+}
+
+static const char* TEST_DATE_TIME_OFFSET_JSON = "\"2014-06-17T08:51:23Z\"";
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToCharBuffer(char* destination, size_t destinationSize, const AGENT_DATA_TYPE* value, size_t* length)
+{
+    (void)value;
+    ASSERT_IS_TRUE(strlen(TEST_DATE_TIME_OFFSET_JSON) < destinationSize);
+    (void)strcpy(destination, TEST_DATE_TIME_OFFSET_JSON);
+    *length = strlen(TEST_DATE_TIME_OFFSET_JSON);
+    return AGENT_DATA_TYPES_OK;
+}
+
+BEGIN_TEST_SUITE(binaryencoder_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+        (void)umocktypes_charptr_register_types();
+        (void)umocktypes_stdint_register_types();
+
+        REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(AGENT_DATA_TYPES_RESULT, int);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToCharBuffer, my_AgentDataTypes_ToCharBuffer);
+        REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, "123456789012345678901234567890.5");
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+        g_writtenSize = 0;
+        g_writesUntilFailure = (size_t)-1;
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_001: [ BinaryEncoder_GetContentType shall return "application/json" for DATA_ENCODING_JSON, "application/cbor" for DATA_ENCODING_CBOR and "application/x-msgpack" for DATA_ENCODING_MSGPACK. ]*/
+    TEST_FUNCTION(BinaryEncoder_GetContentType_returns_the_media_types)
+    {
+        ///arrange
+
+        ///act
+        const char* json = BinaryEncoder_GetContentType(DATA_ENCODING_JSON);
+        const char* cbor = BinaryEncoder_GetContentType(DATA_ENCODING_CBOR);
+        const char* msgpack = BinaryEncoder_GetContentType(DATA_ENCODING_MSGPACK);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, "application/json", json);
+        ASSERT_ARE_EQUAL(char_ptr, "application/cbor", cbor);
+        ASSERT_ARE_EQUAL(char_ptr, "application/x-msgpack", msgpack);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_002: [ For any other value BinaryEncoder_GetContentType shall return NULL. ]*/
+    TEST_FUNCTION(BinaryEncoder_GetContentType_with_unknown_encoding_returns_NULL)
+    {
+        ///arrange
+
+        ///act
+        const char* result = BinaryEncoder_GetContentType((DATA_ENCODING)42);
+
+        ///assert
+        ASSERT_IS_NULL(result);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_003: [ BinaryEncoder_GetContentEncoding shall return "utf-8" for DATA_ENCODING_JSON and NULL for any other encoding, since binary payloads have no character encoding. ]*/
+    TEST_FUNCTION(BinaryEncoder_GetContentEncoding_is_utf8_only_for_JSON)
+    {
+        ///arrange
+
+        ///act
+        const char* json = BinaryEncoder_GetContentEncoding(DATA_ENCODING_JSON);
+        const char* cbor = BinaryEncoder_GetContentEncoding(DATA_ENCODING_CBOR);
+        const char* msgpack = BinaryEncoder_GetContentEncoding(DATA_ENCODING_MSGPACK);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, "utf-8", json);
+        ASSERT_IS_NULL(cbor);
+        ASSERT_IS_NULL(msgpack);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_004: [ If write is NULL or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then the encoding functions shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeMapHeader_with_NULL_write_fails)
+    {
+        ///arrange
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeMapHeader(DATA_ENCODING_CBOR, 1, NULL, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_INVALID_ARG, (int)result);
+        ASSERT_ARE_EQUAL(size_t, 0, g_writtenSize);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_004: [ If write is NULL or encoding is not DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then the encoding functions shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeMapHeader_with_JSON_fails)
+    {
+        ///arrange
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeMapHeader(DATA_ENCODING_JSON, 1, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_INVALID_ARG, (int)result);
+        ASSERT_ARE_EQUAL(size_t, 0, g_writtenSize);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_005: [ BinaryEncoder_EncodeMapHeader shall write the header of a map of memberCount (name, value) pairs, using the shortest form the encoding allows. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeMapHeader_uses_the_shortest_form)
+    {
+        ///arrange
+        const unsigned char expected[] =
+        {
+            0xA3,                   /*CBOR map(3)*/
+            0xB8, 0x18,             /*CBOR map(24)*/
+            0xB9, 0x01, 0x00,       /*CBOR map(256)*/
+            0x83,                   /*MessagePack fixmap(3)*/
+            0xDE, 0x00, 0x10,       /*MessagePack map16(16)*/
+            0xDF, 0x00, 0x01, 0x00, 0x00 /*MessagePack map32(65536)*/
+        };
+
+        ///act
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(DATA_ENCODING_CBOR, 3, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(DATA_ENCODING_CBOR, 24, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(DATA_ENCODING_CBOR, 256, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(DATA_ENCODING_MSGPACK, 3, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(DATA_ENCODING_MSGPACK, 16, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(DATA_ENCODING_MSGPACK, 65536, captureWrite, NULL));
+
+        ///assert
+        assertWritten(expected, sizeof(expected));
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_006: [ If value is NULL and length is not 0 then BinaryEncoder_EncodeString shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeString_with_NULL_value_fails)
+    {
+        ///arrange
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeString(DATA_ENCODING_CBOR, NULL, 1, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_INVALID_ARG, (int)result);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_007: [ BinaryEncoder_EncodeString shall write the length bytes of value as a text string. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeString_writes_a_text_string)
+    {
+        ///arrange
+        const unsigned char expected[] =
+        {
+            0x63, 'a', 'b', 'c',    /*CBOR text(3)*/
+            0x60,                   /*CBOR text(0)*/
+            0xA3, 'a', 'b', 'c',    /*MessagePack fixstr(3)*/
+            0xD9, 0x20              /*MessagePack str8(32), followed by the characters*/
+        };
+        const char* thirtyTwo = "0123456789abcdef0123456789abcdef";
+
+        ///act
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(DATA_ENCODING_CBOR, "abcd", 3, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(DATA_ENCODING_CBOR, NULL, 0, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(DATA_ENCODING_MSGPACK, "abc", 3, captureWrite, NULL));
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(DATA_ENCODING_MSGPACK, thirtyTwo, 32, captureWrite, NULL));
+
+        ///assert
+        ASSERT_ARE_EQUAL(size_t, sizeof(expected) + 32, g_writtenSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expected, g_written, sizeof(expected)));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(thirtyTwo, g_written + sizeof(expected), 32));
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_014: [ If value is NULL then BinaryEncoder_EncodeValue shall fail and return BINARY_ENCODER_INVALID_ARG. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_with_NULL_value_fails)
+    {
+        ///arrange
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_MSGPACK, NULL, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_INVALID_ARG, (int)result);
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_008: [ BinaryEncoder_EncodeValue shall encode EDM_NULL_TYPE as null, EDM_BOOLEAN_TYPE as a boolean, EDM_BYTE_TYPE, EDM_SBYTE_TYPE, EDM_INT16_TYPE, EDM_INT32_TYPE and EDM_INT64_TYPE as the shortest integer, EDM_SINGLE_TYPE as a 32 bit float, EDM_DOUBLE_TYPE as a 64 bit float, EDM_STRING_TYPE and EDM_STRING_NO_QUOTES_TYPE as text strings and EDM_BINARY_TYPE as a byte string. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_CBOR_scalars)
+    {
+        ///arrange
+        AGENT_DATA_TYPE values[7];
+        unsigned char data[2] = { 0x01, 0x02 };
+        const unsigned char expected[] =
+        {
+            0xF6,                           /*null*/
+            0xF5,                           /*true*/
+            0x18, 0xC8,                     /*200*/
+            0x39, 0x01, 0xF3,               /*-500*/
+            0xFA, 0x3F, 0xC0, 0x00, 0x00,   /*1.5f*/
+            0x62, 'h', 'i',                 /*"hi"*/
+            0x42, 0x01, 0x02                /*h'0102'*/
+        };
+        size_t i;
+
+        (void)memset(values, 0, sizeof(values));
+        values[0].type = EDM_NULL_TYPE;
+        values[1].type = EDM_BOOLEAN_TYPE;
+        values[1].value.edmBoolean.value = EDM_TRUE;
+        values[2].type = EDM_INT32_TYPE;
+        values[2].value.edmInt32.value = 200;
+        values[3].type = EDM_INT16_TYPE;
+        values[3].value.edmInt16.value = -500;
+        values[4].type = EDM_SINGLE_TYPE;
+        values[4].value.edmSingle.value = 1.5f;
+        values[5].type = EDM_STRING_TYPE;
+        values[5].value.edmString.chars = (char*)"hi";
+        values[5].value.edmString.length = 2;
+        values[6].type = EDM_BINARY_TYPE;
+        values[6].value.edmBinary.data = data;
+        values[6].value.edmBinary.size = 2;
+
+        ///act
+        for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+        {
+            ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &values[i], captureWrite, NULL));
+        }
+
+        ///assert
+        assertWritten(expected, sizeof(expected));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_008: [ BinaryEncoder_EncodeValue shall encode EDM_NULL_TYPE as null, EDM_BOOLEAN_TYPE as a boolean, EDM_BYTE_TYPE, EDM_SBYTE_TYPE, EDM_INT16_TYPE, EDM_INT32_TYPE and EDM_INT64_TYPE as the shortest integer, EDM_SINGLE_TYPE as a 32 bit float, EDM_DOUBLE_TYPE as a 64 bit float, EDM_STRING_TYPE and EDM_STRING_NO_QUOTES_TYPE as text strings and EDM_BINARY_TYPE as a byte string. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_MSGPACK_scalars)
+    {
+        ///arrange
+        AGENT_DATA_TYPE values[8];
+        unsigned char data[2] = { 0x01, 0x02 };
+        const unsigned char expected[] =
+        {
+            0xC0,                           /*nil*/
+            0xC2,                           /*false*/
+            0x7F,                           /*127*/
+            0xE0,                           /*-32*/
+            0xD0, 0xDF,                     /*-33*/
+            0xCF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, /*INT64_MAX*/
+            0xCB, 0x3F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /*1.5*/
+            0xC4, 0x02, 0x01, 0x02          /*bin8(2)*/
+        };
+        size_t i;
+
+        (void)memset(values, 0, sizeof(values));
+        values[0].type = EDM_NULL_TYPE;
+        values[1].type = EDM_BOOLEAN_TYPE;
+        values[1].value.edmBoolean.value = EDM_FALSE;
+        values[2].type = EDM_BYTE_TYPE;
+        values[2].value.edmByte.value = 127;
+        values[3].type = EDM_SBYTE_TYPE;
+        values[3].value.edmSbyte.value = -32;
+        values[4].type = EDM_SBYTE_TYPE;
+        values[4].value.edmSbyte.value = -33;
+        values[5].type = EDM_INT64_TYPE;
+        values[5].value.edmInt64.value = INT64_MAX;
+        values[6].type = EDM_DOUBLE_TYPE;
+        values[6].value.edmDouble.value = 1.5;
+        values[7].type = EDM_BINARY_TYPE;
+        values[7].value.edmBinary.data = data;
+        values[7].value.edmBinary.size = 2;
+
+        ///act
+        for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+        {
+            ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeValue(DATA_ENCODING_MSGPACK, &values[i], captureWrite, NULL));
+        }
+
+        ///assert
+        assertWritten(expected, sizeof(expected));
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_009: [ EDM_DATE_TYPE, EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE shall be encoded as text strings holding the same characters as the JSON string produced by AgentDataTypes_ToCharBuffer, without the quotes. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_EDM_DATE_TIME_OFFSET_is_a_text_string)
+    {
+        ///arrange
+        AGENT_DATA_TYPE value;
+        const unsigned char expected[] = { 0x74, '2', '0', '1', '4', '-', '0', '6', '-', '1', '7', 'T', '0', '8', ':', '5', '1', ':', '2', '3', 'Z' };
+        (void)memset(&value, 0, sizeof(value));
+        value.type = EDM_DATE_TIME_OFFSET_TYPE;
+
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToCharBuffer(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &value, IGNORED_PTR_ARG))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_destinationSize()
+            .IgnoreArgument_length();
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &value, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)result);
+        assertWritten(expected, sizeof(expected));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_009: [ EDM_DATE_TYPE, EDM_DATE_TIME_OFFSET_TYPE and EDM_GUID_TYPE shall be encoded as text strings holding the same characters as the JSON string produced by AgentDataTypes_ToCharBuffer, without the quotes. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_when_AgentDataTypes_ToCharBuffer_fails_fails)
+    {
+        ///arrange
+        AGENT_DATA_TYPE value;
+        (void)memset(&value, 0, sizeof(value));
+        value.type = EDM_GUID_TYPE;
+
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToCharBuffer(IGNORED_PTR_ARG, IGNORED_NUM_ARG, &value, IGNORED_PTR_ARG))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_destinationSize()
+            .IgnoreArgument_length()
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_MSGPACK, &value, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_ERROR, (int)result);
+        ASSERT_ARE_EQUAL(size_t, 0, g_writtenSize);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_010: [ EDM_DECIMAL_TYPE shall be encoded as a text string holding its decimal digits, so no precision is lost. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_EDM_DECIMAL_is_a_text_string)
+    {
+        ///arrange
+        AGENT_DATA_TYPE value;
+        const unsigned char expected[] = { 0xD9, 0x20 };
+        const char* digits = "123456789012345678901234567890.5";
+        (void)memset(&value, 0, sizeof(value));
+        value.type = EDM_DECIMAL_TYPE;
+        value.value.edmDecimal.value = TEST_STRING_HANDLE;
+
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE));
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_MSGPACK, &value, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)result);
+        ASSERT_ARE_EQUAL(size_t, sizeof(expected) + strlen(digits), g_writtenSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expected, g_written, sizeof(expected)));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(digits, g_written + sizeof(expected), strlen(digits)));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_012: [ EDM_COMPLEX_TYPE_TYPE shall be encoded as a map having one (fieldName, value) pair for every field. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_EDM_COMPLEX_TYPE_is_a_map)
+    {
+        ///arrange
+        AGENT_DATA_TYPE x;
+        AGENT_DATA_TYPE y;
+        AGENT_DATA_TYPE point;
+        COMPLEX_TYPE_FIELD_TYPE fields[2];
+        const unsigned char expected[] = { 0xA2, 0x61, 'x', 0x01, 0x61, 'y', 0x20 };
+
+        (void)memset(&x, 0, sizeof(x));
+        x.type = EDM_INT32_TYPE;
+        x.value.edmInt32.value = 1;
+        (void)memset(&y, 0, sizeof(y));
+        y.type = EDM_INT32_TYPE;
+        y.value.edmInt32.value = -1;
+        fields[0].fieldName = "x";
+        fields[0].value = &x;
+        fields[1].fieldName = "y";
+        fields[1].value = &y;
+        (void)memset(&point, 0, sizeof(point));
+        point.type = EDM_COMPLEX_TYPE_TYPE;
+        point.value.edmComplexType.nMembers = 2;
+        point.value.edmComplexType.fields = fields;
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &point, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)result);
+        assertWritten(expected, sizeof(expected));
+    }
+
+    /*Tests_SRS_BINARY_ENCODER_02_013: [ For any other type BinaryEncoder_EncodeValue shall fail and return BINARY_ENCODER_NOT_SUPPORTED. ]*/
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_with_unsupported_type_fails)
+    {
+        ///arrange
+        AGENT_DATA_TYPE value;
+        (void)memset(&value, 0, sizeof(value));
+        value.type = EDM_DURATION_TYPE;
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &value, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_NOT_SUPPORTED, (int)result);
+        ASSERT_ARE_EQUAL(size_t, 0, g_writtenSize);
+    }
+
+    TEST_FUNCTION(BinaryEncoder_EncodeValue_when_write_fails_fails)
+    {
+        ///arrange
+        AGENT_DATA_TYPE value;
+        (void)memset(&value, 0, sizeof(value));
+        value.type = EDM_STRING_TYPE;
+        value.value.edmString.chars = (char*)"hi";
+        value.value.edmString.length = 2;
+        g_writesUntilFailure = 1; /*the header goes through, the characters do not*/
+
+        ///act
+        BINARY_ENCODER_RESULT result = BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &value, captureWrite, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_ERROR, (int)result);
+    }
+
+END_TEST_SUITE(binaryencoder_ut)
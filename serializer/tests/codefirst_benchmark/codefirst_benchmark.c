@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*creates many model instances and prints how long SERIALIZE takes for properties of the first, middle and last instance*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "serializer.h"
+
+#define MIN_MEASURE_SECONDS 1.0
+#define CLOCK_SAMPLING_ITERATIONS 16
+
+static const size_t instanceCounts[] = { 1, 100, 10000 };
+
+BEGIN_NAMESPACE(Benchmark);
+
+DECLARE_MODEL(Location,
+    WITH_DATA(double, latitude),
+    WITH_DATA(double, longitude)
+);
+
+DECLARE_MODEL(Sensor,
+    WITH_DATA(int, counter),
+    WITH_DATA(double, temperature),
+    WITH_DATA(Location, position)
+);
+
+END_NAMESPACE(Benchmark);
+
+/*returns the number of microseconds one SERIALIZE of a top level and a child model property takes*/
+static double measureSerialize(Sensor* sensor)
+{
+    double result;
+    unsigned long iterations = 0;
+    clock_t start = clock();
+    double seconds = 0.0;
+
+    do
+    {
+        unsigned char* destination;
+        size_t destinationSize;
+        if (SERIALIZE(&destination, &destinationSize, sensor->temperature, sensor->position.longitude) != CODEFIRST_OK)
+        {
+            break;
+        }
+        free(destination);
+        iterations++;
+        /*clock() is not free, look at it only every few messages*/
+        if ((iterations % CLOCK_SAMPLING_ITERATIONS) == 0)
+        {
+            seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        }
+    } while (seconds < MIN_MEASURE_SECONDS);
+
+    if (seconds < MIN_MEASURE_SECONDS)
+    {
+        (void)printf("failure serializing\n");
+        result = -1.0;
+    }
+    else
+    {
+        result = seconds * 1000000.0 / iterations;
+    }
+
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    if (serializer_init(NULL) != SERIALIZER_OK)
+    {
+        (void)printf("failure in serializer_init\n");
+        result = __LINE__;
+    }
+    else
+    {
+        size_t i;
+
+        (void)printf("%10s %12s %12s %12s\n", "instances", "us first", "us middle", "us last");
+
+        for (i = 0; (result == 0) && (i < sizeof(instanceCounts) / sizeof(instanceCounts[0])); i++)
+        {
+            Sensor** sensors = (Sensor**)malloc(instanceCounts[i] * sizeof(Sensor*));
+            size_t created = 0;
+
+            if (sensors == NULL)
+            {
+                (void)printf("failure allocating %lu instances\n", (unsigned long)instanceCounts[i]);
+                result = __LINE__;
+            }
+            else
+            {
+                while ((created < instanceCounts[i]) &&
+                    ((sensors[created] = CREATE_MODEL_INSTANCE(Benchmark, Sensor)) != NULL))
+                {
+                    created++;
+                }
+
+                if (created < instanceCounts[i])
+                {
+                    (void)printf("failure creating instance %lu\n", (unsigned long)created);
+                    result = __LINE__;
+                }
+                else
+                {
+                    double first = measureSerialize(sensors[0]);
+                    double middle = measureSerialize(sensors[created / 2]);
+                    double last = measureSerialize(sensors[created - 1]);
+
+                    if ((first < 0.0) || (middle < 0.0) || (last < 0.0))
+                    {
+                        result = __LINE__;
+                    }
+                    else
+                    {
+                        (void)printf("%10lu %12.2f %12.2f %12.2f\n", (unsigned long)created, first, middle, last);
+                    }
+                }
+
+                while (created > 0)
+                {
+                    created--;
+                    DESTROY_MODEL_INSTANCE(sensors[created]);
+                }
+                free(sensors);
+            }
+        }
+
+        serializer_deinit();
+    }
+
+    return result;
+}
@@ -427,6 +427,13 @@ static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_DOUBLE(AGENT_DATA_
     return AGENT_DATA_TYPES_OK;
 }
 
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    (void)real_STRING_concat(destination, "42");
+    return AGENT_DATA_TYPES_OK;
+}
+
 static DEVICE_RESULT my_Device_PublishTransacted(TRANSACTION_HANDLE transactionHandle, const char* propertyName, const AGENT_DATA_TYPE* data)
 {
     (void)transactionHandle;
@@ -574,6 +581,8 @@ DECLARE_MODEL(SimpleDevice_Model,
 
 END_NAMESPACE(testReflectedData)
 
+DECLARE_MODEL_SERIALIZE(SimpleDevice_Model)
+
 EXECUTE_COMMAND_RESULT reset_Action(truckType_Model* m)
 {
     (void)m;
@@ -717,6 +726,31 @@ static SCHEMA_RESULT my_Schema_GetModelModelCount(SCHEMA_MODEL_TYPE_HANDLE model
 
 #define TEST_SCHEMA_METADATA ((void*)(0x42))
 
+static void setup_serialize_field_expectations(const char* separator, const char* name)
+{
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, separator))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, name))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "\":"))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+}
+
+static void setup_serialize_end_expectations(void)
+{
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "}"))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+}
+
 BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
     TEST_SUITE_INITIALIZE(TestClassInitialize)
@@ -748,6 +782,8 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         REGISTER_UMOCK_ALIAS_TYPE(pfOnDesiredProperty, void*);
         REGISTER_UMOCK_ALIAS_TYPE(pfDeviceMethodCallback, void*);
         REGISTER_UMOCK_ALIAS_TYPE(METHODRETURN_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(DATA_ENCODING, int);
+        REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
 
 
         REGISTER_GLOBAL_MOCK_RETURN(Schema_GetModelName, TEST_MODEL_NAME);
@@ -770,6 +806,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         REGISTER_GLOBAL_MOCK_HOOK(Device_PublishTransacted, my_Device_PublishTransacted);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Device_PublishTransacted, DEVICE_ERROR);
         REGISTER_GLOBAL_MOCK_HOOK(Destroy_AGENT_DATA_TYPE, my_Destroy_AGENT_DATA_TYPE);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
 
         REGISTER_GLOBAL_MOCK_HOOK(Device_EndTransaction, my_Device_EndTransaction);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Device_EndTransaction, DEVICE_ERROR);
@@ -1819,6 +1856,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
@@ -1848,6 +1886,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_callbackUserContext();
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
@@ -1878,6 +1917,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_callbackUserContext();
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, true);
@@ -2005,6 +2045,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
     /* Tests_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
     /* Tests_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
     /* Tests_SRS_CODEFIRST_99_117:[On success, CodeFirst_SendAsync shall return CODEFIRST_OK.] */
+    /* Tests_SRS_CODEFIRST_02_066: [ When the device has a field table and a value is exactly one of the fields in the table, CodeFirst_SendAsync shall marshal and publish the value using the name and the Create_AGENT_DATA_TYPE_from_Ptr function from the field table, without searching the metadata. ]*/
     TEST_FUNCTION(CodeFirst_SendAsync_With_One_Property_Succeeds)
     {
         // arrange
@@ -2015,19 +2056,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2066,33 +2098,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2150,20 +2164,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3).SetReturn(DEVICE_ERROR);
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2191,34 +2196,16 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3).SetReturn(DEVICE_ERROR);
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2247,19 +2234,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2347,15 +2325,8 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2384,29 +2355,13 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
         device->this_is_double_Property = 42.0;
@@ -2435,19 +2390,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_CancelTransaction(IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle();
@@ -2488,20 +2434,11 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
 
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2543,33 +2480,15 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2594,6 +2513,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
     /* Tests_SRS_CODEFIRST_99_130:[If a pointer to the beginning of a device block is passed to CodeFirst_SendAsync instead of a pointer to a property, CodeFirst_SendAsync shall send all the properties that belong to that device.] */
     /* Tests_SRS_CODEFIRST_99_131:[The properties shall be given to Device as one transaction, as if they were all passed as individual arguments to Code_First.] */
+    /* Tests_SRS_CODEFIRST_02_067: [ When the device has a field table, CodeFirst_SendAsync shall send all the properties of the device from the field table, in the same order as the metadata lists them. ]*/
     TEST_FUNCTION(CodeFirst_SendAsync_The_Entire_Device_State)
     {
         // arrange
@@ -2602,7 +2522,6 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2644,7 +2563,6 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)))
             .SetReturn(AGENT_DATA_TYPES_ERROR);
@@ -2676,7 +2594,6 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
@@ -2712,7 +2629,6 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2748,7 +2664,6 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, (int32_t)(IGNORED_NUM_ARG)));
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -2931,19 +2846,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         unsigned char* destination;
         size_t destinationSize;
@@ -3381,6 +3287,154 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_02_079: [ If parameter device or command is NULL then CodeFirst_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteEncodedCommand_With_NULL_command_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        void* device = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteEncodedCommand(device, DATA_ENCODING_CBOR, NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_080: [ If finding the device fails, then CodeFirst_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteEncodedCommand_fails_when_it_does_not_find_the_device)
+    {
+        ///arrange
+        const unsigned char command[] = { 0xA0 };
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteEncodedCommand((unsigned char*)NULL + 1, DATA_ENCODING_CBOR, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_081: [ Otherwise CodeFirst_ExecuteEncodedCommand shall call Device_ExecuteEncodedCommand and return what Device_ExecuteEncodedCommand is returning. ]*/
+    TEST_FUNCTION(CodeFirst_ExecuteEncodedCommand_calls_Device_ExecuteEncodedCommand)
+    {
+        ///arrange
+        const unsigned char command[] = { 0x80 };
+        (void)CodeFirst_Init(NULL);
+        void* device = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_ExecuteEncodedCommand(IGNORED_PTR_ARG, DATA_ENCODING_MSGPACK, command, sizeof(command)))
+            .IgnoreArgument(1)
+            .SetReturn(EXECUTE_COMMAND_FAILED);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CodeFirst_ExecuteEncodedCommand(device, DATA_ENCODING_MSGPACK, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_082: [ If device is NULL then CodeFirst_SetEncoding shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SetEncoding_with_NULL_device_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SetEncoding(NULL, DATA_ENCODING_CBOR);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_083: [ If finding the device fails, then CodeFirst_SetEncoding shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SetEncoding_fails_when_it_does_not_find_the_device)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SetEncoding((unsigned char*)NULL + 1, DATA_ENCODING_CBOR);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_084: [ CodeFirst_SetEncoding shall call Device_SetEncoding. ]*/
+    /*Tests_SRS_CODEFIRST_02_086: [ Otherwise CodeFirst_SetEncoding shall succeed and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SetEncoding_calls_Device_SetEncoding)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        void* device = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_SetEncoding(IGNORED_PTR_ARG, DATA_ENCODING_CBOR))
+            .IgnoreArgument(1);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SetEncoding(device, DATA_ENCODING_CBOR);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_085: [ If Device_SetEncoding fails then CodeFirst_SetEncoding shall fail and return CODEFIRST_DEVICE_FAILED. ]*/
+    TEST_FUNCTION(CodeFirst_SetEncoding_fails_when_Device_SetEncoding_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        void* device = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, sizeof(TruckType), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_SetEncoding(IGNORED_PTR_ARG, DATA_ENCODING_MSGPACK))
+            .IgnoreArgument(1)
+            .SetReturn(DEVICE_DATA_PUBLISHER_FAILED);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SetEncoding(device, DATA_ENCODING_MSGPACK);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_DEVICE_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
     /*Tests_SRS_CODEFIRST_02_018: [ If parameter destination, destinationSize or any of the values passed through va_args is NULL then CodeFirst_SendAsyncReported shall fail and return CODEFIRST_INVALID_ARG. ]*/
     TEST_FUNCTION(CodeFirst_SendAsyncReported_with_NULL_destination_fails)
     {
@@ -4027,6 +4081,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
             .IgnoreArgument_callbackUserContext();
         STRICT_EXPECTED_CALL(Schema_AddDeviceRef(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
 
         // act
         void* result = CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &DummyDataProvider_allReflected, 1, false);
@@ -4076,19 +4131,10 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_new());
-        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
-        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_handle()
-            .IgnoreArgument_s2();
         EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
             .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
         EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_transactionHandle()
@@ -4441,4 +4487,301 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_02_065: [ CodeFirst_CreateDevice shall look up the model of the device in metadata by the name returned by Schema_GetModelName and, if the model has a field table, keep it with the device. ]*/
+    /*Tests_SRS_CODEFIRST_02_066: [ When the device has a field table and a value is exactly one of the fields in the table, CodeFirst_SendAsync shall marshal and publish the value using the name and the Create_AGENT_DATA_TYPE_from_Ptr function from the field table, without searching the metadata. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_with_a_property_of_a_model_without_field_table_searches_the_metadata)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        STRICT_EXPECTED_CALL(Schema_GetModelName(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn("ModelThatDoesNotExist");
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        device->this_is_double_Property = 42.0;
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->this_is_double_Property);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_068: [ If destination, destinationSize, model or fields is NULL, or numSelectedFields is greater than fieldCount, CodeFirst_SerializeModel shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SerializeModel_with_NULL_destination_fails)
+    {
+        ///arrange
+        SimpleDevice_Model model;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SerializeModel(NULL, &destinationSize, &model, ModelFields_SimpleDevice_Model, SimpleDevice_Model_FIELD_COUNT, 0);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CODEFIRST_02_068: [ If destination, destinationSize, model or fields is NULL, or numSelectedFields is greater than fieldCount, CodeFirst_SerializeModel shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SerializeModel_with_NULL_model_fails)
+    {
+        ///arrange
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SerializeModel(&destination, &destinationSize, NULL, ModelFields_SimpleDevice_Model, SimpleDevice_Model_FIELD_COUNT, 0);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_SERIALIZER_H_02_035: [ DECLARE_MODEL shall generate a static field table for the model containing, in declaration order, the name, offset, size and marshalling function of every WITH_DATA property, and an enumeration of field indexes named name_FIELD_propertyName terminated by name_FIELD_COUNT. ]*/
+    TEST_FUNCTION(DECLARE_MODEL_generates_a_field_table_with_the_WITH_DATA_properties)
+    {
+        ///arrange
+
+        ///act
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 2, SimpleDevice_Model_FIELD_COUNT);
+        ASSERT_ARE_EQUAL(int, 0, SimpleDevice_Model_FIELD_this_is_double_Property);
+        ASSERT_ARE_EQUAL(int, 1, SimpleDevice_Model_FIELD_this_is_int_Property);
+        ASSERT_ARE_EQUAL(char_ptr, "this_is_double_Property", ModelFields_SimpleDevice_Model[0].name);
+        ASSERT_ARE_EQUAL(size_t, offsetof(SimpleDevice_Model, this_is_double_Property), ModelFields_SimpleDevice_Model[0].offset);
+        ASSERT_ARE_EQUAL(size_t, sizeof(double), ModelFields_SimpleDevice_Model[0].size);
+        ASSERT_ARE_EQUAL(char_ptr, "this_is_int_Property", ModelFields_SimpleDevice_Model[1].name);
+        ASSERT_ARE_EQUAL(size_t, offsetof(SimpleDevice_Model, this_is_int_Property), ModelFields_SimpleDevice_Model[1].offset);
+        ASSERT_ARE_EQUAL(size_t, sizeof(int), ModelFields_SimpleDevice_Model[1].size);
+    }
+
+    /*Tests_SRS_CODEFIRST_02_071: [ For every serialized field CodeFirst_SerializeModel shall call the Create_AGENT_DATA_TYPE_from_Ptr function of the field and append "name":value to the JSON object, separating members with ", ". ]*/
+    /*Tests_SRS_CODEFIRST_02_073: [ If numSelectedFields is 0, CodeFirst_SerializeModel shall serialize all the fields, in declaration order. ]*/
+    /*Tests_SRS_CODEFIRST_02_075: [ On success CodeFirst_SerializeModel shall return in destination a newly allocated buffer holding the JSON (not zero terminated), in destinationSize its size, and return CODEFIRST_OK. ]*/
+    /*Tests_SRS_SERIALIZER_H_02_039: [ DECLARE_MODEL_SERIALIZE shall generate a function CODEFIRST_RESULT Model_Serialize_name(unsigned char** destination, size_t* destinationSize, const name* model) that serializes all the properties of the model by calling CodeFirst_SerializeModel. ]*/
+    TEST_FUNCTION(Model_Serialize_serializes_all_the_properties_in_declaration_order)
+    {
+        ///arrange
+        SimpleDevice_Model model;
+        unsigned char* destination;
+        size_t destinationSize;
+        const char* expectedJson = "{\"this_is_double_Property\":42, \"this_is_int_Property\":42}";
+        model.this_is_double_Property = 42.0;
+        model.this_is_int_Property = 42;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
+        setup_serialize_field_expectations("\"", "this_is_double_Property");
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+        setup_serialize_field_expectations(", \"", "this_is_int_Property");
+        setup_serialize_end_expectations();
+
+        ///act
+        CODEFIRST_RESULT result = Model_Serialize_SimpleDevice_Model(&destination, &destinationSize, &model);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expectedJson), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJson, destination, destinationSize));
+
+        ///cleanup
+        free(destination);
+    }
+
+    /*Tests_SRS_CODEFIRST_02_070: [ Otherwise CodeFirst_SerializeModel shall serialize only the fields whose indexes are passed as int arguments after numSelectedFields, in declaration order. ]*/
+    /*Tests_SRS_SERIALIZER_H_02_036: [ SERIALIZE_MODEL_FIELDS shall call CodeFirst_SerializeModel passing the field table generated by DECLARE_MODEL and the index of each listed property. ]*/
+    TEST_FUNCTION(SERIALIZE_MODEL_FIELDS_serializes_only_the_listed_properties)
+    {
+        ///arrange
+        SimpleDevice_Model model;
+        unsigned char* destination;
+        size_t destinationSize;
+        const char* expectedJson = "{\"this_is_int_Property\":42}";
+        model.this_is_double_Property = 42.0;
+        model.this_is_int_Property = 42;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+        setup_serialize_field_expectations("\"", "this_is_int_Property");
+        setup_serialize_end_expectations();
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL_FIELDS(&destination, &destinationSize, SimpleDevice_Model, &model, this_is_int_Property);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expectedJson), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJson, destination, destinationSize));
+
+        ///cleanup
+        free(destination);
+    }
+
+    /*Tests_SRS_CODEFIRST_02_069: [ If a field index is out of range or appears more than once, CodeFirst_SerializeModel shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(SERIALIZE_MODEL_FIELDS_with_a_repeated_property_fails)
+    {
+        ///arrange
+        SimpleDevice_Model model;
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL_FIELDS(&destination, &destinationSize, SimpleDevice_Model, &model, this_is_int_Property, this_is_int_Property);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CODEFIRST_02_072: [ If Create_AGENT_DATA_TYPE_from_Ptr or AgentDataTypes_ToString fails, CodeFirst_SerializeModel shall fail and return CODEFIRST_AGENT_DATA_TYPE_ERROR. ]*/
+    /*Tests_SRS_SERIALIZER_H_02_039: [ DECLARE_MODEL_SERIALIZE shall generate a function CODEFIRST_RESULT Model_Serialize_name(unsigned char** destination, size_t* destinationSize, const name* model) that serializes all the properties of the model by calling CodeFirst_SerializeModel. ]*/
+    TEST_FUNCTION(Model_Serialize_when_creating_the_agent_data_type_fails_it_fails)
+    {
+        ///arrange
+        SimpleDevice_Model model;
+        unsigned char* destination;
+        size_t destinationSize;
+        model.this_is_double_Property = 42.0;
+        model.this_is_int_Property = 42;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
+        setup_serialize_field_expectations("\"", "this_is_double_Property");
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0))
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+
+        ///act
+        CODEFIRST_RESULT result = Model_Serialize_SimpleDevice_Model(&destination, &destinationSize, &model);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_AGENT_DATA_TYPE_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CODEFIRST_02_077: [ When a value has been published before from the same device, CodeFirst_SendAsync shall reuse the property and the full path found the first time, without searching the metadata again. ]*/
+    /*Tests_SRS_CODEFIRST_02_078: [ After a value found by searching the metadata has been published, CodeFirst_SendAsync shall remember its property and full path for the device. Failing to remember them shall not fail CodeFirst_SendAsync. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_the_second_time_a_child_model_property_is_sent_does_not_search_the_metadata)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        device->Inner.this_is_double2 = 42.0;
+        (void)CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->Inner.this_is_double2);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_double2", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->Inner.this_is_double2);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_02_076: [ CodeFirst_CreateDevice shall keep the devices sorted by the address of their data, so that the device of a value is found by a binary search. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_finds_the_device_of_a_value_among_many_devices)
+    {
+        ///arrange
+        SimpleDevice_Model* devices[5];
+        size_t i;
+        (void)CodeFirst_Init(NULL);
+        for (i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        {
+            devices[i] = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        }
+        CodeFirst_DestroyDevice(devices[2]);
+        unsigned char* destination;
+        size_t destinationSize;
+
+        for (i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        {
+            if (i != 2)
+            {
+                umock_c_reset_all_calls();
+
+                STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+                EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+                STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
+                    .IgnoreArgument_transactionHandle()
+                    .IgnoreArgument(3);
+                EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+                STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                    .IgnoreArgument_transactionHandle()
+                    .IgnoreArgument(2)
+                    .IgnoreArgument(3);
+
+                ///act
+                CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &devices[i]->this_is_int_Property);
+
+                ///assert
+                ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+                ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+            }
+        }
+
+        ///cleanup
+        for (i = 0; i < sizeof(devices) / sizeof(devices[0]); i++)
+        {
+            if (i != 2)
+            {
+                CodeFirst_DestroyDevice(devices[i]);
+            }
+        }
+        CodeFirst_Deinit();
+    }
+
 END_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider);
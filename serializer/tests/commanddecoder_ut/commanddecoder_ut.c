@@ -57,10 +57,13 @@ MOCKABLE_FUNCTION(, void, onDesiredPropertyModelInModel, void*, v);
 #define ENABLE_MOCKS
 #include "codefirst.h"
 #include "jsondecoder.h"
+#include "binarydecoder.h"
 
 MOCKABLE_FUNCTION(, EXECUTE_COMMAND_RESULT, ActionCallbackMock, void*, actionCallbackContext, const char*, relativeActionPath, const char*, actionName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
 MOCKABLE_FUNCTION(, METHODRETURN_HANDLE, methodCallbackMock, void*, methodCallbackContext, const char*, relativeMethodPath, const char*, mthodName, size_t, parameterCount, const AGENT_DATA_TYPE*, parameterValues);
 MOCKABLE_FUNCTION(, int, int_pfDesiredPropertyFromAGENT_DATA_TYPE, const AGENT_DATA_TYPE*, source, void*, dest);
+MOCKABLE_FUNCTION(, void, int_pfDesiredPropertyInitialize, void*, destination);
+MOCKABLE_FUNCTION(, void, int_pfDesiredPropertyDeinitialize, void*, destination);
 #undef ENABLE_MOCKS
 
 #include "azure_c_shared_utility/lock.h"
@@ -154,9 +157,9 @@ static SCHEMA_METHOD_ARGUMENT_HANDLE TEST_METHOD_ARGUMENT_HANDLE_1 = (SCHEMA_MET
 
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES);
 
-static void SetupCommand(const char* quotedActionName, const char* actionName)
+/*the calls that dispatch a command once it is a multi tree, whatever encoding it came in*/
+static void SetupCommandDispatch(const char* quotedActionName, const char* actionName)
 {
-    STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(TestCommand, IGNORED_PTR_ARG)).IgnoreArgument(2);
     STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
     STRICT_EXPECTED_CALL(MultiTree_GetChildByName(TEST_COMMAND_ROOT_NODE, "Name", IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer(3, &TEST_COMMAND_NAME_NODE, sizeof(TEST_COMMAND_NAME_NODE));
@@ -170,6 +173,12 @@ static void SetupCommand(const char* quotedActionName, const char* actionName)
         .SetReturn(SetACStateActionHandle);
 }
 
+static void SetupCommand(const char* quotedActionName, const char* actionName)
+{
+    STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(TestCommand, IGNORED_PTR_ARG)).IgnoreArgument(2);
+    SetupCommandDispatch(quotedActionName, actionName);
+}
+
 void SetupArgumentCalls(SCHEMA_ACTION_HANDLE actionHandle, size_t index, SCHEMA_ACTION_ARGUMENT_HANDLE argHandle, const char* argName, const char* argType)
 {
 
@@ -322,11 +331,15 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_DESIRED_PROPERTY_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(pfDesiredPropertyFromAGENT_DATA_TYPE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(pfOnDesiredProperty, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(pfDesiredPropertyInitialize, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(pfDesiredPropertyDeinitialize, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_METHOD_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_METHOD_ARGUMENT_HANDLE, void*);
 
 
         REGISTER_UMOCK_ALIAS_TYPE(JSON_DECODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(BINARY_DECODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(DATA_ENCODING, int);
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(AGENT_DATA_TYPE_TYPE, int);
@@ -1047,6 +1060,108 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
+    /*Tests_SRS_COMMAND_DECODER_02_029: [ If handle or command is NULL then CommandDecoder_ExecuteEncodedCommand shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteEncodedCommand_with_NULL_handle_fails)
+    {
+        /// arrange
+        const unsigned char command[] = { 0xA0 };
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteEncodedCommand(NULL, DATA_ENCODING_CBOR, command, sizeof(command));
+
+        // assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_029: [ If handle or command is NULL then CommandDecoder_ExecuteEncodedCommand shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteEncodedCommand_with_NULL_command_fails)
+    {
+        /// arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteEncodedCommand(commandDecoderHandle, DATA_ENCODING_CBOR, NULL, 1);
+
+        // assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /// cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_031: [ Otherwise CommandDecoder_ExecuteEncodedCommand shall decode the command to a multi tree by calling BinaryDecoder_To_MultiTree. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_032: [ If BinaryDecoder_To_MultiTree fails then CommandDecoder_ExecuteEncodedCommand shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteEncodedCommand_when_BinaryDecoder_To_MultiTree_fails_fails)
+    {
+        /// arrange
+        const unsigned char command[] = { 0xBF }; /*indefinite length map*/
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BinaryDecoder_To_MultiTree(DATA_ENCODING_CBOR, command, sizeof(command), IGNORED_PTR_ARG))
+            .IgnoreArgument_multiTreeHandle()
+            .SetReturn(BINARY_DECODER_PARSE_ERROR);
+
+        /// act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteEncodedCommand(commandDecoderHandle, DATA_ENCODING_CBOR, command, sizeof(command));
+
+        // assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        /// cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_033: [ CommandDecoder_ExecuteEncodedCommand shall dispatch the command from the multi tree the same way CommandDecoder_ExecuteCommand does, free the multi tree and return the result of the dispatch. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteEncodedCommand_MSGPACK_With_1_Arg_Calls_The_ActionCallback)
+    {
+        // arrange
+        const unsigned char command[] = { 0x80 }; /*the content is what the mocked decoder says it is*/
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        size_t argCount = 1;
+        STRICT_EXPECTED_CALL(BinaryDecoder_To_MultiTree(DATA_ENCODING_MSGPACK, command, sizeof(command), IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_multiTreeHandle(&TEST_COMMAND_ROOT_NODE, sizeof(TEST_COMMAND_ROOT_NODE));
+        SetupCommandDispatch(quotedSetACStateName, setACStateName);
+        STRICT_EXPECTED_CALL(Schema_GetModelActionArgumentCount(SetACStateActionHandle, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &argCount, sizeof(argCount));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is allocating memory for the argument array*/
+            .IgnoreArgument(1);
+        SetupArgumentCalls(SetACStateActionHandle, 0, StateActionArgument, StateActionArgument_Name, StateActionArgument_Type);
+        const char* stateValue = "true";
+        STRICT_EXPECTED_CALL(MultiTree_GetChildByName(TEST_COMMAND_ARGS_NODE, "State", IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &TEST_ARG1_NODE, sizeof(TEST_ARG1_NODE));
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("bool"))
+            .SetReturn(EDM_BOOLEAN_TYPE);
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(TEST_ARG1_NODE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &stateValue, sizeof(stateValue));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(stateValue, EDM_BOOLEAN_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &StateAgentDataType, sizeof(StateAgentDataType));
+        STRICT_EXPECTED_CALL(ActionCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "SetACState", 1, IGNORED_PTR_ARG))
+            .IgnoreArgument(5);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(TEST_COMMAND_ROOT_NODE));
+
+        // act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_ExecuteEncodedCommand(commandDecoderHandle, DATA_ENCODING_MSGPACK, command, sizeof(command));
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        // cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
     /* Tests_SRS_COMMAND_DECODER_99_010:[ If any Schema API fails then the command shall not be dispatched and it shall return EXECUTE_COMMAND_ERROR.]*/
     TEST_FUNCTION(CommandDecoder_When_GetModelActionArgumentByIndex_Fails_ExecuteCommand_Fails)
     {
@@ -3030,6 +3145,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn("int");
 
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(childHandle, IGNORED_PTR_ARG)) /*is it null?*/
+            .IgnoreArgument_destination();
+
         STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
             .SetReturn(TEST_SCHEMA);
 
@@ -3134,15 +3252,16 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             7, /*STRING_c_str*/
 
             9, /*Schema_GetModelDesiredPropertyType*/
-            10, /*Schema_GetSchemaForModelType*/
-            11, /*CodeFirst_GetPrimitiveType*/
-            14, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            15, /*Schema_GetModelDesiredProperty_offset*/
-            17, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            18, /*Destroy_AGENT_DATA_TYPE*/
-            19, /*STRING_delete*/
-            20, /*MultiTree_Destroy*/
-            21 /*gballoc_free*/
+            10, /*MultiTree_GetValue (a value that cannot be read is not null)*/
+            11, /*Schema_GetSchemaForModelType*/
+            12, /*CodeFirst_GetPrimitiveType*/
+            15, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            16, /*Schema_GetModelDesiredProperty_offset*/
+            18, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            19, /*Destroy_AGENT_DATA_TYPE*/
+            20, /*STRING_delete*/
+            21, /*MultiTree_Destroy*/
+            22 /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3212,6 +3331,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*9*/
             .SetReturn(10);
 
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(childHandle, IGNORED_PTR_ARG)) /*is it null?*/
+            .IgnoreArgument_destination();
+
         /*here recursion happens*/
 
         {
@@ -3237,6 +3359,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*17*/
                 .SetReturn("int");
 
+            STRICT_EXPECTED_CALL(MultiTree_GetValue(childHandle, IGNORED_PTR_ARG)) /*is it null?*/
+                .IgnoreArgument_destination();
+
             STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL)) /*18*/
                 .SetReturn(TEST_SCHEMA);
 
@@ -3348,21 +3473,23 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             3, /*MultiTree_GetChildCount*/
             7, /*STRING_c_str*/
             9, /*Schema_GetModelModelByName_Offset*/
-            10, /*MultiTree_GetChildCount*/
-            13, /*MultiTree_GetName*/
-            14, /*STRING_c_str*/
-            16, /*Schema_GetModelDesiredPropertyType*/
-            17, /*Schema_GetSchemaForModelType*/
-            18, /*CodeFirst_GetPrimitiveType*/
-            21, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            22, /*Schema_GetModelDesiredProperty_offset*/
-            24, /*Destroy_AGENT_DATA_TYPE*/
-            25, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            26, /*STRING_delete*/
-            27, /*STRING_delete*/
-            28, /*Schema_GetModelModelByName_OnDesiredProperty*/
-            29, /*MultiTree_Destroy*/
-            30, /*gballoc_free*/
+            10, /*MultiTree_GetValue (a value that cannot be read is not null)*/
+            11, /*MultiTree_GetChildCount*/
+            14, /*MultiTree_GetName*/
+            15, /*STRING_c_str*/
+            17, /*Schema_GetModelDesiredPropertyType*/
+            18, /*MultiTree_GetValue (a value that cannot be read is not null)*/
+            19, /*Schema_GetSchemaForModelType*/
+            20, /*CodeFirst_GetPrimitiveType*/
+            23, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            24, /*Schema_GetModelDesiredProperty_offset*/
+            26, /*Destroy_AGENT_DATA_TYPE*/
+            27, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            28, /*STRING_delete*/
+            29, /*STRING_delete*/
+            30, /*Schema_GetModelModelByName_OnDesiredProperty*/
+            31, /*MultiTree_Destroy*/
+            32, /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3451,6 +3578,148 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
     }
 
+    /*Tests_SRS_COMMAND_DECODER_02_026: [ If parseDesiredNode is false and the value of a desired property is null then the desired property shall be reset to its default value by calling its pfDesiredPropertyDeinitialize and pfDesiredPropertyInitialize. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_027: [ After a desired property has been reset, its non-NULL pfOnDesiredProperty shall be called. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_a_null_desired_property_in_a_patch_resets_it)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":null}";
+        const char* nullValue = "null";
+        size_t one = 1;
+        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_json()
+            .IgnoreArgument_multiTreeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .IgnoreArgument_childName();
+        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .CopyOutArgumentBuffer_count(&one, sizeof(one));
+        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
+        STRICT_EXPECTED_CALL(STRING_new())
+            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME));
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME))
+            .SetReturn("int_field");
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
+            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn("int");
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(childHandle, IGNORED_PTR_ARG))
+            .IgnoreArgument_destination()
+            .CopyOutArgumentBuffer_destination(&nullValue, sizeof(nullValue));
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyDeinitialize(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(int_pfDesiredPropertyDeinitialize);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyInitialize(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(int_pfDesiredPropertyInitialize);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyDeinitialize(deviceMemoryArea + 2));
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyInitialize(deviceMemoryArea + 2));
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(onDesiredPropertySimpleProperty);
+        STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty(deviceMemoryArea));
+        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_028: [ If parseDesiredNode is false and the value of a model in model is null then all the desired properties of the model in model shall be reset to their default values. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_a_null_model_in_model_in_a_patch_resets_its_desired_properties)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"modelInModel\":null}";
+        const char* nullValue = "null";
+        size_t one = 1;
+        size_t zero = 0;
+        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_json()
+            .IgnoreArgument_multiTreeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .IgnoreArgument_childName();
+        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .CopyOutArgumentBuffer_count(&one, sizeof(one));
+        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
+        STRICT_EXPECTED_CALL(STRING_new())
+            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME));
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME))
+            .SetReturn("modelInModel");
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(Schema_GetModelElementByName_modelInModel);
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(10);
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(childHandle, IGNORED_PTR_ARG))
+            .IgnoreArgument_destination()
+            .CopyOutArgumentBuffer_destination(&nullValue, sizeof(nullValue));
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyCount(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, IGNORED_PTR_ARG))
+            .IgnoreArgument_desiredPropertyCount()
+            .CopyOutArgumentBuffer_desiredPropertyCount(&one, sizeof(one));
+        STRICT_EXPECTED_CALL(Schema_GetModelModelCount(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, IGNORED_PTR_ARG))
+            .IgnoreArgument_modelCount()
+            .CopyOutArgumentBuffer_modelCount(&zero, sizeof(zero));
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyByIndex(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, 0))
+            .SetReturn(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyDeinitialize(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(int_pfDesiredPropertyDeinitialize);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyInitialize(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(int_pfDesiredPropertyInitialize);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyDeinitialize(deviceMemoryArea + 12)); /*2 + 10*/
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyInitialize(deviceMemoryArea + 12));
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(onDesiredPropertyModelInModel);
+        STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(deviceMemoryArea));
+        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
     /*Tests_SRS_COMMAND_DECODER_02_014: [ If handle is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_handle_fails)
     {
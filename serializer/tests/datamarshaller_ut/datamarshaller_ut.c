@@ -14,6 +14,11 @@ static void* my_gballoc_malloc(size_t size)
     return malloc(size);
 }
 
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
 static void my_gballoc_free(void* s)
 {
     free(s);
@@ -29,14 +34,13 @@ static void my_gballoc_free(void* s)
 #include "umock_c_negative_tests.h"
 
 #define ENABLE_MOCKS
-#include "jsonencoder.h"
-#include "multitree.h"
 #include "schema.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/vector.h"
 #include "agenttypesystem.h"
+#include "binaryencoder.h"
 #include "parson.h"
 #include "azure_c_shared_utility/gballoc.h"
 #ifdef __cplusplus
@@ -126,25 +130,8 @@ static const SCHEMA_MODEL_TYPE_HANDLE TEST_MODEL_HANDLE = (SCHEMA_MODEL_TYPE_HAN
 TEST_DEFINE_ENUM_TYPE(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
 
-TEST_DEFINE_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
-IMPLEMENT_UMOCK_C_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
-
-TEST_DEFINE_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
-IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
-
 #define DEFAULT_PROPERTY_NAME_2 "blahBlah"
-
-static MULTITREE_HANDLE my_MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
-{
-    (void)cloneFunction;
-    (void)freeFunction;
-    return (MULTITREE_HANDLE)my_gballoc_malloc(1);
-}
-
-static void my_MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
-{
-    my_gballoc_free(treeHandle);
-}
+#define DEFAULT_PROPERTY_NAME_LONG "aPropertyNameThatIsLongerThanTheInitialOutputBufferOfOneValue"
 
 static STRING_HANDLE my_STRING_new(void)
 {
@@ -163,6 +150,14 @@ static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destinat
     return AGENT_DATA_TYPES_OK;
 }
 
+static void setupEncodeValueExpectations(const AGENT_DATA_TYPE* value)
+{
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, value));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_empty(IGNORED_PTR_ARG));
+}
+
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 {
     char temp_str[256];
@@ -195,20 +190,14 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         structTypeValue2Members.value.edmComplexType.nMembers = COUNT_OF(two_members);
         structTypeValue2Members.value.edmComplexType.fields = two_members;
 
-        REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_CLONE_FUNCTION, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_FREE_FUNCTION, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
-        REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_TOSTRING_FUNC, void*);
         REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(const VECTOR_HANDLE, void*);
 
-        REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_RESULT, int);
-        REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_RESULT, int);
-
-        REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Create, my_MultiTree_Create);
-        REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
+        REGISTER_UMOCK_ALIAS_TYPE(DATA_ENCODING, int);
+        REGISTER_UMOCK_ALIAS_TYPE(BINARY_ENCODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(BINARY_ENCODER_WRITE_FUNCTION, void*);
 
         REGISTER_STRING_GLOBAL_MOCK_HOOK;
 
@@ -247,6 +236,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
     }
 
@@ -550,8 +541,9 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_Create_Fails_Then_Fails)
+    /* Tests_SRS_DATA_MARSHALLER_02_022: [ DataMarshaller_SendData shall make one working copy of the (path, value) pairs so that they can be grouped by path prefix without building a MultiTree. ]*/
+    /* Tests_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+    TEST_FUNCTION(DataMarshaller_SendData_when_allocating_the_working_copy_fails_then_fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
@@ -561,86 +553,69 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
 
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .SetReturn((MULTITREE_HANDLE)NULL);
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .SetReturn(NULL);
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_AddLeaf_With_Property_Value_Fails_Then_Fails)
+    /* Tests_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+    TEST_FUNCTION(when_STRING_new_fails_SendData_Fails)
     {
         ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        STRICT_EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_cloneFunction()
-            .IgnoreArgument_freeFunction();
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new())
+            .SetReturn(NULL);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_AddLeaf_With_The_Second_Property_Value_Fails_Then_Fails)
+    /* Tests_SRS_DATA_MARSHALLER_02_023: [ DataMarshaller_SendData shall write the JSON directly into a single growable buffer. ]*/
+    /* Tests_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+    TEST_FUNCTION(DataMarshaller_SendData_when_allocating_the_output_buffer_fails_then_fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        AGENT_DATA_TYPE floatValid2;
-
-        DATA_MARSHALLER_VALUE values[2];
-        values[0].PropertyPath = DEFAULT_PROPERTY_NAME;
-        values[0].Value = &floatValid;
-
-        values[1].PropertyPath = DEFAULT_PROPERTY_NAME_2;
-        values[1].Value = &floatValid2;
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid2))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .SetReturn(NULL);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, sizeof(values) / sizeof(values[0]), values, &destination, &destinationSize);
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
@@ -648,7 +623,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
     }
 
     /* Tests_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_Encoding_The_Values_Tree_To_JSON_Fails_Then_Fails)
+    TEST_FUNCTION(DataMarshaller_SendData_When_Encoding_A_Value_To_JSON_Fails_Then_Fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
@@ -657,22 +632,14 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc()
-            .SetReturn(JSON_ENCODER_ERROR);
-
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, &floatValid))
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -681,7 +648,6 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_JSON_ENCODER_ERROR, result);
 
-
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
@@ -696,32 +662,15 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        const char* expected_json = "{\"" DEFAULT_PROPERTY_NAME "\":2.4, \"" DEFAULT_PROPERTY_NAME_2 "\":2.4}";
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        setupEncodeValueExpectations(&structTypeValue);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
@@ -729,57 +678,79 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
-        ASSERT_ARE_EQUAL(size_t, strlen(json_payload), destinationSize);
-        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, json_payload, destinationSize));
-
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
         ///cleanup
         free(destination);
         DataMarshaller_Destroy(handle);
     }
 
-    /*Tests_SRS_DATAMARSHALLER_02_006: [The complete JSON object shall be handed over to IoTHubClient by a call to IoTHubClient_LL_SendEventAsync if parameter transportType of _Create was TRANSPORT_LL.] */
-    TEST_FUNCTION(DataMarshaller_SendData_sends_to_LL_layer_succeeds)
+    /* Tests_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
+    TEST_FUNCTION(DataMarshaller_SendData_groups_values_sharing_a_path_prefix)
     {
         ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
-        char json_payload[] = "Test";
+        DATA_MARSHALLER_VALUE value[] = { { "a/b", &floatValid }, { "d", &intValid }, { "/a/c", &intValid } };
+        const char* expected_json = "{\"a\":{\"b\":2.4, \"c\":2.4}, \"d\":2.4}";
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        setupEncodeValueExpectations(&intValid);
+        setupEncodeValueExpectations(&intValid);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 3, value, &destination, &destinationSize);
 
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
 
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
+    /* Tests_SRS_DATA_MARSHALLER_02_022: [ DataMarshaller_SendData shall make one working copy of the (path, value) pairs and sort it once by path, so that they can be grouped by path prefix without building a MultiTree. ]*/
+    /* Tests_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
+    TEST_FUNCTION(DataMarshaller_SendData_keeps_the_order_of_first_appearance_at_every_level)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE value[] = { { "b/y", &floatValid }, { "a", &intValid }, { "b/x/2", &intValid }, { "c", &intValid }, { "b/x/1", &floatValid } };
+        const char* expected_json = "{\"b\":{\"y\":2.4, \"x\":{\"2\":2.4, \"1\":2.4}}, \"a\":2.4, \"c\":2.4}";
 
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        setupEncodeValueExpectations(&intValid);
+        setupEncodeValueExpectations(&floatValid);
+        setupEncodeValueExpectations(&intValid);
+        setupEncodeValueExpectations(&intValid);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 5, value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
         ///cleanup
         free(destination);
@@ -795,32 +766,15 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &floatValid } };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
+        const char* expected_json = "{\"" DEFAULT_PROPERTY_NAME "\":2.4, \"" DEFAULT_PROPERTY_NAME_2 "\":2.4}";
 
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        setupEncodeValueExpectations(&floatValid);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
@@ -828,6 +782,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
         ///cleanup
         free(destination);
@@ -843,30 +799,14 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
+        const char* expected_json = "{\"" DEFAULT_PROPERTY_NAME "\":2.4}";
 
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -874,6 +814,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
         ///cleanup
         free(destination);
@@ -890,31 +832,48 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
-        char json_payload[] = "Test";
+        const char* expected_json = "{\"x\":2.4, \"y\":2.4}";
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(structTypeValue2Members.value.edmComplexType.fields[0].value);
+        setupEncodeValueExpectations(structTypeValue2Members.value.edmComplexType.fields[1].value);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
+    /* Tests_SRS_DATA_MARSHALLER_02_023: [ DataMarshaller_SendData shall write the JSON directly into a single growable buffer. ]*/
+    TEST_FUNCTION(DataMarshaller_SendData_grows_the_output_buffer_when_needed)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME_LONG, &floatValid };
+        const char* expected_json = "{\"" DEFAULT_PROPERTY_NAME_LONG "\":2.4}";
 
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -922,6 +881,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
 
         ///cleanup
         free(destination);
@@ -929,26 +890,52 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
     }
 
     /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(when_adding_the_first_member_of_the_struct_fails_then_senddata_fails)
+    TEST_FUNCTION(DataMarshaller_SendData_with_the_same_property_path_twice_fails)
     {
         ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME, &intValid } };
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+    TEST_FUNCTION(DataMarshaller_SendData_with_a_value_on_a_path_already_used_as_object_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid }, { "a", &intValid } };
 
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
 
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
@@ -959,25 +946,54 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
     }
 
     /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(when_adding_the_second_member_of_the_struct_fails_then_senddata_fails)
+    TEST_FUNCTION(DataMarshaller_SendData_with_an_empty_path_segment_fails)
     {
         ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
+        DATA_MARSHALLER_VALUE value = { "a//b", &floatValid };
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+    TEST_FUNCTION(DataMarshaller_SendData_with_an_inner_path_segment_of_128_characters_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        char path[128 + 3];
+        (void)memset(path, 'a', 128);
+        path[128] = '/';
+        path[129] = 'b';
+        path[130] = '\0';
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE value = { path, &floatValid };
 
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -990,31 +1006,162 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATAMARSHALLER_01_003: [DATA_MARSHALLER_ERROR shall be returned for any errors when calling IoTHubMessage APIs.] */
-    TEST_FUNCTION(when_STRING_new_fails_SendData_Fails)
+    /* Tests_SRS_DATA_MARSHALLER_99_039:[  If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
+    TEST_FUNCTION(DataMarshaller_SendData_with_an_inner_path_segment_of_127_characters_succeeds)
     {
         ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
         unsigned char* destination;
         size_t destinationSize;
+        char path[127 + 3];
+        (void)memset(path, 'a', 127);
+        path[127] = '/';
+        path[128] = 'b';
+        path[129] = '\0';
+        char expected_json[127 + 16];
+        (void)sprintf(expected_json, "{\"%.127s\":{\"b\":2.4}}", path);
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DATA_MARSHALLER_VALUE value = { path, &floatValid };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setupEncodeValueExpectations(&floatValid);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new())
-            .SetReturn(NULL);
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expected_json), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expected_json, destinationSize));
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_02_027: [ If dataMarshallerHandle is NULL or encoding is not one of DATA_ENCODING_JSON, DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then DataMarshaller_SetEncoding shall fail and return DATA_MARSHALLER_INVALID_ARG. ]*/
+    TEST_FUNCTION(DataMarshaller_SetEncoding_with_NULL_handle_fails)
+    {
+        ///arrange
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SetEncoding(NULL, DATA_ENCODING_CBOR);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_02_027: [ If dataMarshallerHandle is NULL or encoding is not one of DATA_ENCODING_JSON, DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK then DataMarshaller_SetEncoding shall fail and return DATA_MARSHALLER_INVALID_ARG. ]*/
+    TEST_FUNCTION(DataMarshaller_SetEncoding_with_unknown_encoding_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        umock_c_reset_all_calls();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SetEncoding(handle, (DATA_ENCODING)42);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_02_028: [ Otherwise DataMarshaller_SetEncoding shall store encoding, all the following DataMarshaller_SendData and DataMarshaller_SendData_ReportedProperties calls shall produce that encoding, and return DATA_MARSHALLER_OK. ]*/
+    /*Tests_SRS_DATA_MARSHALLER_02_025: [ When the encoding is DATA_ENCODING_CBOR or DATA_ENCODING_MSGPACK, DataMarshaller_SendData shall produce the same document as a map written by BinaryEncoder_EncodeMapHeader, BinaryEncoder_EncodeString and BinaryEncoder_EncodeValue. ]*/
+    TEST_FUNCTION(DataMarshaller_SendData_after_SetEncoding_CBOR_uses_the_BinaryEncoder)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value[] = { { "a/b", &floatValid }, { "d", &intValid } };
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, DataMarshaller_SetEncoding(handle, DATA_ENCODING_CBOR));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeMapHeader(DATA_ENCODING_CBOR, 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeString(DATA_ENCODING_CBOR, IGNORED_PTR_ARG, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*a*/
+            .IgnoreArgument_value()
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeMapHeader(DATA_ENCODING_CBOR, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeString(DATA_ENCODING_CBOR, "b", 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &floatValid, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeString(DATA_ENCODING_CBOR, "d", 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeValue(DATA_ENCODING_CBOR, &intValid, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_02_026: [ If any BinaryEncoder API fails, DataMarshaller_SendData shall fail and return DATA_MARSHALLER_BINARY_ENCODER_ERROR. ]*/
+    TEST_FUNCTION(DataMarshaller_SendData_when_BinaryEncoder_EncodeValue_fails_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &intValid };
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, DataMarshaller_SetEncoding(handle, DATA_ENCODING_MSGPACK));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeMapHeader(DATA_ENCODING_MSGPACK, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeString(DATA_ENCODING_MSGPACK, DEFAULT_PROPERTY_NAME, strlen(DEFAULT_PROPERTY_NAME), IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(BinaryEncoder_EncodeValue(DATA_ENCODING_MSGPACK, &intValid, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_write()
+            .IgnoreArgument_context()
+            .SetReturn(BINARY_ENCODER_NOT_SUPPORTED);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_BINARY_ENCODER_ERROR, result);
 
         ///cleanup
         DataMarshaller_Destroy(handle);
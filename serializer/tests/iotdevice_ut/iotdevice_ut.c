@@ -159,6 +159,8 @@ BEGIN_TEST_SUITE(IoTDevice_ut)
 
         REGISTER_UMOCK_ALIAS_TYPE(EXECUTE_COMMAND_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_PUBLISHER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(DATA_ENCODING, int);
+        REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
 
         REGISTER_GLOBAL_MOCK_RETURN(DeviceActionCallback, EXECUTE_COMMAND_SUCCESS);
 
@@ -384,6 +386,67 @@ BEGIN_TEST_SUITE(IoTDevice_ut)
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     }
 
+    /* Device_SetEncoding */
+
+    /*Tests_SRS_DEVICE_02_041: [ If deviceHandle is NULL then Device_SetEncoding shall fail and return DEVICE_INVALID_ARG. ]*/
+    TEST_FUNCTION(Device_SetEncoding_with_NULL_handle_fails)
+    {
+        // arrange
+
+        // act
+        DEVICE_RESULT result = Device_SetEncoding(NULL, DATA_ENCODING_CBOR);
+
+        // assert
+        ASSERT_ARE_EQUAL(DEVICE_RESULT, DEVICE_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_DEVICE_02_042: [ Device_SetEncoding shall call DataPublisher_SetEncoding. ]*/
+    /*Tests_SRS_DEVICE_02_044: [ Otherwise Device_SetEncoding shall succeed and return DEVICE_OK. ]*/
+    TEST_FUNCTION(Device_SetEncoding_calls_DataPublisher_SetEncoding_and_succeeds)
+    {
+        // arrange
+        DEVICE_HANDLE deviceHandle;
+        (void)Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &deviceHandle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataPublisher_SetEncoding(IGNORED_PTR_ARG, DATA_ENCODING_CBOR))
+            .IgnoreArgument_dataPublisherHandle();
+
+        // act
+        DEVICE_RESULT result = Device_SetEncoding(deviceHandle, DATA_ENCODING_CBOR);
+
+        // assert
+        ASSERT_ARE_EQUAL(DEVICE_RESULT, DEVICE_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        Device_Destroy(deviceHandle);
+    }
+
+    /*Tests_SRS_DEVICE_02_043: [ If DataPublisher_SetEncoding fails then Device_SetEncoding shall fail and return DEVICE_DATA_PUBLISHER_FAILED. ]*/
+    TEST_FUNCTION(When_DataPublisher_SetEncoding_fails_then_Device_SetEncoding_fails)
+    {
+        // arrange
+        DEVICE_HANDLE deviceHandle;
+        (void)Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &deviceHandle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataPublisher_SetEncoding(IGNORED_PTR_ARG, DATA_ENCODING_MSGPACK))
+            .IgnoreArgument_dataPublisherHandle()
+            .SetReturn(DATA_PUBLISHER_MARSHALLER_ERROR);
+
+        // act
+        DEVICE_RESULT result = Device_SetEncoding(deviceHandle, DATA_ENCODING_MSGPACK);
+
+        // assert
+        ASSERT_ARE_EQUAL(DEVICE_RESULT, DEVICE_DATA_PUBLISHER_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        Device_Destroy(deviceHandle);
+    }
+
     /* Device_StartTransaction */
 
     /* Tests_SRS_DEVICE_01_034: [Device_StartTransaction shall invoke DataPublisher_StartTransaction for the DataPublisher handle associated with the deviceHandle argument.] */
@@ -927,6 +990,63 @@ BEGIN_TEST_SUITE(IoTDevice_ut)
         Device_Destroy(h);
     }
 
+    /*Tests_SRS_DEVICE_02_045: [ If deviceHandle or command is NULL then Device_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(Device_ExecuteEncodedCommand_with_NULL_handle_returns_EXECUTE_COMMAND_ERROR)
+    {
+        ///arrange
+        const unsigned char command[] = { 0xA0 };
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = Device_ExecuteEncodedCommand(NULL, DATA_ENCODING_CBOR, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_DEVICE_02_045: [ If deviceHandle or command is NULL then Device_ExecuteEncodedCommand shall return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(Device_ExecuteEncodedCommand_with_NULL_command_returns_EXECUTE_COMMAND_ERROR)
+    {
+        ///arrange
+        DEVICE_HANDLE h;
+        Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &h);
+        umock_c_reset_all_calls();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = Device_ExecuteEncodedCommand(h, DATA_ENCODING_CBOR, NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Device_Destroy(h);
+    }
+
+    /*Tests_SRS_DEVICE_02_046: [ Otherwise, Device_ExecuteEncodedCommand shall call CommandDecoder_ExecuteEncodedCommand and return what CommandDecoder_ExecuteEncodedCommand is returning. ]*/
+    TEST_FUNCTION(Device_ExecuteEncodedCommand_returns_what_CommandDecoder_ExecuteEncodedCommand_returns)
+    {
+        ///arrange
+        const unsigned char command[] = { 0x80 };
+        DEVICE_HANDLE h;
+        Device_Create(irrelevantModel, DeviceActionCallback, TEST_CALLBACK_CONTEXT, deviceMethodCallback, TEST_CALLBACK_CONTEXT, false, &h);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(CommandDecoder_ExecuteEncodedCommand(IGNORED_PTR_ARG, DATA_ENCODING_MSGPACK, command, sizeof(command)))
+            .IgnoreArgument(1)
+            .SetReturn(EXECUTE_COMMAND_FAILED);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = Device_ExecuteEncodedCommand(h, DATA_ENCODING_MSGPACK, command, sizeof(command));
+
+        ///assert
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Device_Destroy(h);
+    }
+
     /*Tests_SRS_DEVICE_02_014: [ If argument deviceHandle is NULL then Device_CreateTransaction_ReportedProperties shall fail and return NULL. ]*/
     TEST_FUNCTION(Device_CreateTransaction_ReportedProperties_with_NULL_deviceHandle_fails)
     {
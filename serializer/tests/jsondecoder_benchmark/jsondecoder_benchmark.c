@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*decodes synthetic device twin documents of several sizes with JSONDecoder_JSON_To_MultiTree and prints the throughput*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "jsondecoder.h"
+#include "multitree.h"
+
+#define MIN_MEASURE_SECONDS 1.0
+#define CLOCK_SAMPLING_ITERATIONS 16
+
+static const size_t documentSizes[] = { 1024, 16 * 1024, 128 * 1024 };
+
+static size_t appendText(char* destination, size_t position, size_t capacity, const char* text)
+{
+    size_t length = strlen(text);
+    if (position + length < capacity)
+    {
+        (void)memcpy(destination + position, text, length + 1);
+        position += length;
+    }
+    return position;
+}
+
+/*builds {"desired":{...},"reported":{...}} where each section holds a mix of strings, numbers, booleans, nested objects and arrays*/
+static char* createTwinDocument(size_t targetSize)
+{
+    size_t capacity = targetSize + 512;
+    char* result = (char*)malloc(capacity);
+    if (result != NULL)
+    {
+        char member[256];
+        size_t position = 0;
+        unsigned int i = 0;
+        const size_t sectionSize = targetSize / 2;
+
+        position = appendText(result, position, capacity, "{\"desired\":{\"$version\":42");
+        while (position < sectionSize)
+        {
+            (void)sprintf(member, ",\"setting%u\":{\"name\":\"telemetry interval for sensor %u\",\"value\":%u.%u,\"enabled\":%s,\"tags\":[\"building 4\",\"floor %u\",null]}",
+                i, i, i * 7, i % 10, (i % 2) ? "true" : "false", i % 30);
+            position = appendText(result, position, capacity, member);
+            i++;
+        }
+
+        position = appendText(result, position, capacity, "},\"reported\":{\"$version\":41");
+        while (position < targetSize)
+        {
+            (void)sprintf(member, ",\"sensor%u\":{\"firmware\":\"1.2.%u\",\"temperature\":%d.%u,\"lastSeen\":\"2017-11-%02uT10:%02u:00Z\",\"status\":\"ok\"}",
+                i, i % 100, (int)(i % 50) - 10, i % 10, 1 + (i % 28), i % 60);
+            position = appendText(result, position, capacity, member);
+            i++;
+        }
+        (void)appendText(result, position, capacity, "}}");
+    }
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+    size_t i;
+
+    (void)printf("%10s %12s %12s %12s\n", "size", "iterations", "us/document", "MB/s");
+
+    for (i = 0; i < sizeof(documentSizes) / sizeof(documentSizes[0]); i++)
+    {
+        char* document = createTwinDocument(documentSizes[i]);
+        size_t documentLength = (document == NULL) ? 0 : strlen(document);
+        char* scratch = (char*)malloc(documentLength + 1);
+
+        if ((document == NULL) || (scratch == NULL))
+        {
+            (void)printf("failure allocating a %lu bytes document\n", (unsigned long)documentSizes[i]);
+            result = __LINE__;
+        }
+        else
+        {
+            unsigned long iterations = 0;
+            clock_t start = clock();
+            double seconds = 0.0;
+
+            /*the decoder works in place, so every iteration decodes a fresh copy, the copy is part of the measurement as it is for the callers*/
+            do
+            {
+                MULTITREE_HANDLE multiTree;
+                (void)memcpy(scratch, document, documentLength + 1);
+                if (JSONDecoder_JSON_To_MultiTree(scratch, &multiTree) != JSON_DECODER_OK)
+                {
+                    (void)printf("failure decoding a %lu bytes document\n", (unsigned long)documentLength);
+                    result = __LINE__;
+                    break;
+                }
+                MultiTree_Destroy(multiTree);
+                iterations++;
+                /*clock() is not free, look at it only every few documents*/
+                if ((iterations % CLOCK_SAMPLING_ITERATIONS) == 0)
+                {
+                    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+                }
+            } while (seconds < MIN_MEASURE_SECONDS);
+
+            if (result == 0)
+            {
+                (void)printf("%10lu %12lu %12.1f %12.1f\n",
+                    (unsigned long)documentLength,
+                    iterations,
+                    seconds * 1000000.0 / iterations,
+                    ((double)documentLength * iterations) / (seconds * 1024.0 * 1024.0));
+            }
+        }
+
+        free(scratch);
+        free(document);
+    }
+
+    return result;
+}
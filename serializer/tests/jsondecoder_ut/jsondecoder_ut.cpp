@@ -2589,4 +2589,43 @@ TEST_FUNCTION(JSONDecoder_When_String_Has_Several_Escaped_Chars_Decoding_Succeed
     TestSpecialCharacter_Success(json);
 }
 
+/* Tests_SRS_JSON_DECODER_02_001: [ JSONDecoder_JSON_To_MultiTree shall first record the positions of the quotes that end the strings of the JSON in one pass over the input. ]*/
+/* Tests_SRS_JSON_DECODER_02_002: [ The end of a string shall be found from the index of the strings, without looking at the characters of the string. ]*/
+TEST_FUNCTION(JSONDecoder_When_An_Escaped_Quote_Is_The_First_Character_Of_An_Index_Block_Decoding_Succeeds)
+{
+    /*the backslash is the 64th character, the escaped quote the 65th*/
+    char json[] = "[\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\\"b\"]";
+    TestSpecialCharacter_Success(json);
+}
+
+/* Tests_SRS_JSON_DECODER_02_001: [ JSONDecoder_JSON_To_MultiTree shall first record the positions of the quotes that end the strings of the JSON in one pass over the input. ]*/
+/* Tests_SRS_JSON_DECODER_02_002: [ The end of a string shall be found from the index of the strings, without looking at the characters of the string. ]*/
+TEST_FUNCTION(JSONDecoder_When_An_Escaped_BackSlash_Ends_An_Index_Block_Decoding_Succeeds)
+{
+    /*the escaped backslash ends at the 64th character, the 65th character is the quote ending the string*/
+    char json[] = "[\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\\\\"]";
+    TestSpecialCharacter_Success(json);
+}
+
+/* Tests_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+/* Tests_SRS_JSON_DECODER_02_002: [ The end of a string shall be found from the index of the strings, without looking at the characters of the string. ]*/
+TEST_FUNCTION(JSONDecoder_When_A_String_Has_An_Invalid_Escape_After_The_First_Index_Block_Decoding_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    MULTITREE_HANDLE multiTree;
+    char json[] = "[\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\x\"]";
+
+    EXPECTED_CALL(mocks, MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_AddChild(TestMultiTreeHandle, "0", IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(3, &TestChildHandle1, sizeof(TestChildHandle1));
+    STRICT_EXPECTED_CALL(mocks, MultiTree_Destroy(TestMultiTreeHandle));
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_MultiTree(json, &multiTree);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+}
+
 END_TEST_SUITE(JSONDecoder_ut)
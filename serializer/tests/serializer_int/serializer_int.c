@@ -3,6 +3,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include "serializer.h"
+#include "binaryencoder.h"
+#include "binarydecoder.h"
 #include "macro_utils.h"
 #include "testrunnerswitcher.h"
 
@@ -854,6 +856,221 @@ static bool areTwoJsonsEqual(const unsigned char* left, size_t leftSize, const c
     return result;
 }
 
+/*rebuilds a JSON value from the tree that BinaryDecoder_To_MultiTree produced, the leaves of that tree are JSON texts*/
+static JSON_Value* multiTreeToJson(MULTITREE_HANDLE tree)
+{
+    JSON_Value* result;
+    size_t childCount;
+
+    ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetChildCount(tree, &childCount));
+    if (childCount == 0)
+    {
+        const void* value;
+        ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetValue(tree, &value));
+        result = json_parse_string((const char*)value);
+        ASSERT_IS_NOT_NULL(result);
+    }
+    else
+    {
+        size_t i;
+        STRING_HANDLE name = STRING_new();
+        ASSERT_IS_NOT_NULL(name);
+        result = json_value_init_object();
+        ASSERT_IS_NOT_NULL(result);
+        for (i = 0; i < childCount; i++)
+        {
+            MULTITREE_HANDLE child;
+            ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetChild(tree, i, &child));
+            ASSERT_ARE_EQUAL(int, (int)MULTITREE_OK, (int)MultiTree_GetName(child, name));
+            ASSERT_ARE_EQUAL(int, (int)JSONSuccess, (int)json_object_set_value(json_value_get_object(result), STRING_c_str(name), multiTreeToJson(child)));
+        }
+        STRING_delete(name);
+    }
+    return result;
+}
+
+static bool isBinaryEqualToJson(DATA_ENCODING encoding, const unsigned char* left, size_t leftSize, const char* right)
+{
+    bool result;
+    MULTITREE_HANDLE tree;
+
+    ASSERT_ARE_EQUAL(int, (int)BINARY_DECODER_OK, (int)BinaryDecoder_To_MultiTree(encoding, left, leftSize, &tree));
+
+    JSON_Value* actualJson = multiTreeToJson(tree);
+    JSON_Value* expectedJson = json_parse_string(right);
+    ASSERT_IS_NOT_NULL(expectedJson);
+
+    result = (json_value_equals(expectedJson, actualJson) != 0);
+
+    json_value_free(expectedJson);
+    json_value_free(actualJson);
+    MultiTree_Destroy(tree);
+
+    return result;
+}
+
+typedef struct ENCODED_BYTES_TAG
+{
+    unsigned char bytes[1024];
+    size_t size;
+} ENCODED_BYTES;
+
+static int appendEncodedBytes(void* context, const unsigned char* bytes, size_t size)
+{
+    int result;
+    ENCODED_BYTES* encoded = (ENCODED_BYTES*)context;
+    if (encoded->size + size > sizeof(encoded->bytes))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        (void)memcpy(encoded->bytes + encoded->size, bytes, size);
+        encoded->size += size;
+        result = 0;
+    }
+    return result;
+}
+
+static void encodeParameter(DATA_ENCODING encoding, ENCODED_BYTES* encoded, const char* name, AGENT_DATA_TYPE* value)
+{
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(encoding, name, strlen(name), appendEncodedBytes, encoded));
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeValue(encoding, value, appendEncodedBytes, encoded));
+    Destroy_AGENT_DATA_TYPE(value);
+}
+
+/*produces the same command as the JSON of WITH_ACTION_IN_ROOT_MODEL, in encoding*/
+static void encodeAction13Command(DATA_ENCODING encoding, ENCODED_BYTES* encoded)
+{
+    AGENT_DATA_TYPE ag;
+    EDM_DATE_TIME_OFFSET dateTimeOffset;
+    EDM_GUID guid;
+    EDM_BINARY binary;
+    unsigned char edmBinary[3] = { '3', '4', '5' };
+    size_t i;
+
+    encoded->size = 0;
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(encoding, 2, appendEncodedBytes, encoded));
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(encoding, "Name", 4, appendEncodedBytes, encoded));
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(encoding, "action13", 8, appendEncodedBytes, encoded));
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeString(encoding, "Parameters", 10, appendEncodedBytes, encoded));
+    ASSERT_ARE_EQUAL(int, (int)BINARY_ENCODER_OK, (int)BinaryEncoder_EncodeMapHeader(encoding, 15, appendEncodedBytes, encoded));
+
+    (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, 1.0);         encodeParameter(encoding, encoded, "double13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_SINT32(&ag, 2);           encodeParameter(encoding, encoded, "int13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, 3.0f);         encodeParameter(encoding, encoded, "float13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_SINT64(&ag, 4);           encodeParameter(encoding, encoded, "long13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_SINT8(&ag, 5);            encodeParameter(encoding, encoded, "sint8_t13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_UINT8(&ag, 6);            encodeParameter(encoding, encoded, "uint8_t13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_SINT16(&ag, 7);           encodeParameter(encoding, encoded, "int16_t13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_SINT32(&ag, 8);           encodeParameter(encoding, encoded, "int32_t13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_SINT64(&ag, 9);           encodeParameter(encoding, encoded, "int64_t13", &ag);
+    (void)Create_EDM_BOOLEAN_from_int(&ag, 1);                  encodeParameter(encoding, encoded, "bool13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_charz(&ag, "e/leven");    encodeParameter(encoding, encoded, "ascii_char_ptr13", &ag);
+    (void)Create_AGENT_DATA_TYPE_from_charz(&ag, "twelve");     encodeParameter(encoding, encoded, "ascii_char_ptr_no_quotes13", &ag);
+
+    (void)memset(&dateTimeOffset, 0, sizeof(dateTimeOffset));
+    dateTimeOffset.dateTime.tm_year = 114;
+    dateTimeOffset.dateTime.tm_mon = 6 - 1;
+    dateTimeOffset.dateTime.tm_mday = 17;
+    dateTimeOffset.dateTime.tm_hour = 8;
+    dateTimeOffset.dateTime.tm_min = 51;
+    dateTimeOffset.dateTime.tm_sec = 23;
+    dateTimeOffset.hasFractionalSecond = 1;
+    dateTimeOffset.fractionalSecond = 5;
+    dateTimeOffset.hasTimeZone = 1;
+    dateTimeOffset.timeZoneHour = -8;
+    dateTimeOffset.timeZoneMinute = 1;
+    (void)Create_AGENT_DATA_TYPE_from_EDM_DATE_TIME_OFFSET(&ag, dateTimeOffset);
+    encodeParameter(encoding, encoded, "EdmDateTimeOffset13", &ag);
+
+    for (i = 0; i < 16; i++)
+    {
+        guid.GUID[i] = (unsigned char)(i * 0x11);
+    }
+    (void)Create_AGENT_DATA_TYPE_from_EDM_GUID(&ag, guid);
+    encodeParameter(encoding, encoded, "EdmGuid13", &ag);
+
+    binary.data = edmBinary;
+    binary.size = 3;
+    (void)Create_AGENT_DATA_TYPE_from_EDM_BINARY(&ag, binary);
+    encodeParameter(encoding, encoded, "EdmBinary13", &ag);
+}
+
+/*the following tests serialize the model of WITH_DATA_IN_ROOT_MODEL as CBOR and MessagePack and compare what decodes back with the JSON*/
+static void WITH_DATA_IN_ROOT_MODEL_with_encoding(DATA_ENCODING encoding)
+{
+    ///arrange
+    basicModel_WithData1 *modelWithData = CREATE_MODEL_INSTANCE(basic1, basicModel_WithData1, true);
+    ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, SET_ENCODING(modelWithData, encoding));
+
+    modelWithData->with_data_double1 = 1.0;
+    modelWithData->with_data_int1 = 2;
+    modelWithData->with_data_float1 = 3.0;
+    modelWithData->with_data_long1 = 4;
+    modelWithData->with_data_sint8_t1 = 5;
+    modelWithData->with_data_uint8_t1 = 6;
+    modelWithData->with_data_int16_t1 = 7;
+    modelWithData->with_data_int32_t1 = 8;
+    modelWithData->with_data_int64_t1 = 9;
+    modelWithData->with_data_bool1 = true;
+    modelWithData->with_data_ascii_char_ptr1 = "e/leven";
+    modelWithData->with_data_ascii_char_ptr_no_quotes1 = "\"twelve\"";
+    modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_year = 114;
+    modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_mon = 6 - 1;
+    modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_mday = 17;
+    modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_hour = 8;
+    modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_min = 51;
+    modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_sec = 23;
+    modelWithData->with_data_EdmDateTimeOffset1.hasFractionalSecond = 1;
+    modelWithData->with_data_EdmDateTimeOffset1.fractionalSecond = 5;
+    modelWithData->with_data_EdmDateTimeOffset1.hasTimeZone = 1;
+    modelWithData->with_data_EdmDateTimeOffset1.timeZoneHour = -8;
+    modelWithData->with_data_EdmDateTimeOffset1.timeZoneMinute = 1;
+    for (size_t i = 0; i < 16; i++)
+    {
+        modelWithData->with_data_EdmGuid1.GUID[i] = (unsigned char)(i * 0x11);
+    }
+
+    unsigned char edmBinary[3] = { '3', '4', '5' };
+    modelWithData->with_data_EdmBinary1.data = edmBinary;
+    modelWithData->with_data_EdmBinary1.size = 3;
+
+    /*ascii_char_ptr_no_quotes is JSON text inserted as is, the binary encodings carry that text as a string*/
+    const char* expectedJsonAsString =
+        "{                                                                                   \
+        \"with_data_double1\" : 1.0,                                                          \
+        \"with_data_int1\" : 2,                                                               \
+        \"with_data_float1\" : 3.000000,                                                      \
+        \"with_data_long1\" : 4,                                                              \
+        \"with_data_sint8_t1\" : 5,                                                           \
+        \"with_data_uint8_t1\" : 6,                                                           \
+        \"with_data_int16_t1\" : 7,                                                           \
+        \"with_data_int32_t1\" : 8,                                                           \
+        \"with_data_int64_t1\" : 9,                                                           \
+        \"with_data_bool1\" : true,                                                           \
+        \"with_data_ascii_char_ptr1\" : \"e/leven\",                                          \
+        \"with_data_ascii_char_ptr_no_quotes1\" : \"\\\"twelve\\\"\",                         \
+        \"with_data_EdmDateTimeOffset1\" : \"2014-06-17T08:51:23.000000000005-08:01\",        \
+        \"with_data_EdmGuid1\" : \"00112233-4455-6677-8899-AABBCCDDEEFF\",                    \
+        \"with_data_EdmBinary1\": \"MzQ1\"                                                    \
+    }";
+
+    unsigned char* destination;
+    size_t destinationSize;
+
+    ///act
+    CODEFIRST_RESULT result = SERIALIZE(&destination, &destinationSize, *modelWithData);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+    ASSERT_IS_TRUE(isBinaryEqualToJson(encoding, destination, destinationSize, expectedJsonAsString));
+
+    ///clean
+    free(destination);
+    DESTROY_MODEL_INSTANCE(modelWithData);
+}
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 {
@@ -990,6 +1207,16 @@ BEGIN_TEST_SUITE(serializer_int)
         DESTROY_MODEL_INSTANCE(modelWithData);
     }
 
+    TEST_FUNCTION(WITH_DATA_IN_ROOT_MODEL_CBOR)
+    {
+        WITH_DATA_IN_ROOT_MODEL_with_encoding(DATA_ENCODING_CBOR);
+    }
+
+    TEST_FUNCTION(WITH_DATA_IN_ROOT_MODEL_MSGPACK)
+    {
+        WITH_DATA_IN_ROOT_MODEL_with_encoding(DATA_ENCODING_MSGPACK);
+    }
+
     /*the following test has a model that has a single WITH_DATA of structure type having fields of all types*/
     /*conceptually:
     MODEL
@@ -2024,6 +2251,40 @@ BEGIN_TEST_SUITE(serializer_int)
         DESTROY_MODEL_INSTANCE(modelWithData);
     }
 
+    TEST_FUNCTION(WITH_ACTION_IN_ROOT_MODEL_CBOR)
+    {
+        ///arrange
+        model_WithAction13 *modelWithData = CREATE_MODEL_INSTANCE(basic13, model_WithAction13, true);
+        ENCODED_BYTES command;
+        encodeAction13Command(DATA_ENCODING_CBOR, &command);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = EXECUTE_ENCODED_COMMAND(modelWithData, DATA_ENCODING_CBOR, command.bytes, command.size);
+
+        ///assert (rest of asserts are in the action)
+        ASSERT_ARE_EQUAL(int, (int)EXECUTE_COMMAND_SUCCESS, (int)result);
+
+        ///clean
+        DESTROY_MODEL_INSTANCE(modelWithData);
+    }
+
+    TEST_FUNCTION(WITH_ACTION_IN_ROOT_MODEL_MSGPACK)
+    {
+        ///arrange
+        model_WithAction13 *modelWithData = CREATE_MODEL_INSTANCE(basic13, model_WithAction13, true);
+        ENCODED_BYTES command;
+        encodeAction13Command(DATA_ENCODING_MSGPACK, &command);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = EXECUTE_ENCODED_COMMAND(modelWithData, DATA_ENCODING_MSGPACK, command.bytes, command.size);
+
+        ///assert (rest of asserts are in the action)
+        ASSERT_ARE_EQUAL(int, (int)EXECUTE_COMMAND_SUCCESS, (int)result);
+
+        ///clean
+        DESTROY_MODEL_INSTANCE(modelWithData);
+    }
+
     TEST_FUNCTION(WITH_ACTION_IN_MODEL_IN_MODEL)
     {
         ///arrange